@@ -0,0 +1,17 @@
+# cooks `model_name` (relative to CMAKE_SOURCE_DIR) into the same relative path
+# under NICKEL_COOKED_ASSET_DIR, see `Context::GetCookedAssetPath`
+macro(cook_model target_name model_name)
+    get_filename_component(COOKED_MODEL_DIR ${NICKEL_COOKED_ASSET_DIR}/${model_name} DIRECTORY)
+    get_filename_component(COOKED_MODEL_NAME ${CMAKE_SOURCE_DIR}/${model_name} NAME_WE)
+    set(COOKED_MODEL_OUTPUT ${COOKED_MODEL_DIR}/${COOKED_MODEL_NAME}.nkmodel)
+    add_custom_command(
+        OUTPUT ${COOKED_MODEL_OUTPUT}
+        COMMAND ${CMAKE_COMMAND} -E make_directory ${COOKED_MODEL_DIR}
+        COMMAND gltf_cooker ${CMAKE_SOURCE_DIR}/${model_name} ${COOKED_MODEL_OUTPUT}
+        COMMENT "cooking model ${model_name} -> ${COOKED_MODEL_OUTPUT}"
+        MAIN_DEPENDENCY ${CMAKE_SOURCE_DIR}/${model_name}
+        DEPENDS gltf_cooker
+        VERBATIM
+    )
+    target_sources(${target_name} PRIVATE ${COOKED_MODEL_OUTPUT})
+endmacro()
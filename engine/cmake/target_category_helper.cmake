@@ -32,6 +32,27 @@ macro(mark_as_cli_test target_name folder)
     set_tests_properties(${target_name} PROPERTIES LABELS "cli")
 endmacro()
 
+# test cases tagged [gpu] need a vulkan device. They run as ${target_name}_gpu
+# with the validation layer on, which is reported as skipped (exit code 4 of
+# Catch2) when every case skipped for lack of a device
+macro(mark_as_gpu_test target_name folder)
+    add_test(NAME ${target_name}
+            COMMAND ${target_name} "~[gpu]" --allow-running-no-tests
+            WORKING_DIRECTORY ${CMAKE_SOURCE_DIR})
+    add_test(NAME ${target_name}_gpu
+            COMMAND ${target_name} "[gpu]"
+            WORKING_DIRECTORY ${CMAKE_SOURCE_DIR})
+    set_target_properties(${target_name} PROPERTIES
+        FOLDER tests/${folder}
+        VS_DEBUGGER_WORKING_DIRECTORY ${CMAKE_SOURCE_DIR})
+    target_link_libraries(${target_name} PRIVATE Catch2WithMain ${NICKEL_ENGINE_NAME})
+    set_tests_properties(${target_name} PROPERTIES LABELS "cli")
+    set_tests_properties(${target_name}_gpu PROPERTIES
+        LABELS "cli;gpu"
+        SKIP_RETURN_CODE 4
+        ENVIRONMENT NICKEL_VULKAN_VALIDATION=1)
+endmacro()
+
 macro(mark_as_tool target_name)
     set_target_properties(${target_name} PROPERTIES
         FOLDER tools
@@ -39,3 +60,10 @@ macro(mark_as_tool target_name)
     target_link_libraries(${target_name} PRIVATE ${NICKEL_MAIN_ENTRY_NAME})
 endmacro()
 
+
+macro(mark_as_cli_tool target_name)
+    set_target_properties(${target_name} PROPERTIES
+        FOLDER tools
+        VS_DEBUGGER_WORKING_DIRECTORY ${CMAKE_SOURCE_DIR})
+    target_link_libraries(${target_name} PRIVATE ${NICKEL_ENGINE_NAME})
+endmacro()
@@ -452,6 +452,26 @@ public:
 	*/
 	virtual 	PxRigidDynamicGPUIndex	getGPUIndex() const = 0;
 
+	// nickel: raw access to the sleep filter of the simulation body (accumulated sleep velocities, freeze counter
+	// and acceleration scale). It survives setGlobalPose()/setLinearVelocity()/setWakeCounter(), so a scene snapshot
+	// has to carry it to restore a body exactly.
+	enum
+	{
+		eNB_SLEEP_STATE_VALUES = 8
+	};
+
+	/**
+	\brief Copy eNB_SLEEP_STATE_VALUES internal sleep state values to state. Zeros are written if the actor is not in a scene.
+	*/
+	virtual		void				getSleepState(PxReal* state) const = 0;
+
+	/**
+	\brief Overwrite the internal sleep state with eNB_SLEEP_STATE_VALUES values from getSleepState().
+
+	\note Ignored if the actor is not in a scene.
+	*/
+	virtual		void				setSleepState(const PxReal* state) = 0;
+
 	virtual		const char*			getConcreteTypeName() const	PX_OVERRIDE	PX_FINAL	{ return "PxRigidDynamic"; }
 
 protected:
@@ -734,6 +734,24 @@ public:
 	*/
 	void setTireContacts(const PxU32* nbHits, const PxPlane* contactPlanes, const PxReal* contactFrictions, const PxTireContactIntersectionMethod::Enum* intersectionMethods, const PxU32 nbWheels);
 
+	// nickel: raw access to the internal simulation state of a wheel (speeds, rotation angle, low speed timers, jounce
+	// and steer angle) so a scene snapshot can restore a vehicle exactly. Scene query results are not included, they
+	// are rebuilt by PxVehicleSuspensionRaycasts() before every update.
+	enum
+	{
+		eNB_WHEEL_STATE_VALUES = 7
+	};
+
+	/**
+	\brief Copy eNB_WHEEL_STATE_VALUES internal state values of the specified wheel to state.
+	*/
+	void getWheelState(const PxU32 wheelIdx, PxReal* state) const;
+
+	/**
+	\brief Overwrite the internal state of the specified wheel with eNB_WHEEL_STATE_VALUES values from getWheelState().
+	*/
+	void setWheelState(const PxU32 wheelIdx, const PxReal* state);
+
 private:
 
     /**
@@ -29,6 +29,7 @@
 #include "NpRigidDynamic.h"
 #include "NpRigidActorTemplateInternal.h"
 #include "omnipvd/NpOmniPvdSetData.h"
+#include "ScBodySim.h"
 
 using namespace physx;
 
@@ -651,3 +652,44 @@ PxRigidDynamicGPUIndex NpRigidDynamic::getGPUIndex() const
 	}
 	return PX_INVALID_NODE;
 }
+
+// nickel: see PxRigidDynamic::getSleepState
+void NpRigidDynamic::getSleepState(PxReal* state) const
+{
+	NP_READ_CHECK(getNpScene());
+	PX_CHECK_SCENE_API_READ_FORBIDDEN(getNpScene(), "PxRigidDynamic::getSleepState() not allowed while simulation is running.")
+
+	const Sc::BodySim* sim = mCore.getSim();
+	if(!sim)
+	{
+		for(PxU32 i = 0; i < eNB_SLEEP_STATE_VALUES; i++)
+			state[i] = 0.0f;
+		return;
+	}
+
+	const PxsRigidBody& body = sim->getLowLevelBody();
+	state[0] = body.mSleepLinVelAcc.x;
+	state[1] = body.mSleepLinVelAcc.y;
+	state[2] = body.mSleepLinVelAcc.z;
+	state[3] = body.mSleepAngVelAcc.x;
+	state[4] = body.mSleepAngVelAcc.y;
+	state[5] = body.mSleepAngVelAcc.z;
+	state[6] = body.mFreezeCount;
+	state[7] = body.mAccelScale;
+}
+
+void NpRigidDynamic::setSleepState(const PxReal* state)
+{
+	NP_WRITE_CHECK(getNpScene());
+	PX_CHECK_SCENE_API_WRITE_FORBIDDEN(getNpScene(), "PxRigidDynamic::setSleepState() not allowed while simulation is running. Call will be ignored.")
+
+	Sc::BodySim* sim = mCore.getSim();
+	if(!sim)
+		return;
+
+	PxsRigidBody& body = sim->getLowLevelBody();
+	body.mSleepLinVelAcc = PxVec3(state[0], state[1], state[2]);
+	body.mSleepAngVelAcc = PxVec3(state[3], state[4], state[5]);
+	body.mFreezeCount = state[6];
+	body.mAccelScale = state[7];
+}
@@ -119,6 +119,8 @@ public:
 	virtual		PxReal				getContactReportThreshold() const	PX_OVERRIDE PX_FINAL;
 	virtual		void				setContactReportThreshold(PxReal threshold)	PX_OVERRIDE PX_FINAL;
 	virtual		PxRigidDynamicGPUIndex getGPUIndex() const PX_OVERRIDE PX_FINAL;
+	virtual		void				getSleepState(PxReal* state) const	PX_OVERRIDE PX_FINAL;
+	virtual		void				setSleepState(const PxReal* state)	PX_OVERRIDE PX_FINAL;
 	//~PxRigidDynamic
 
 	// NpRigidActorTemplate
@@ -2381,10 +2381,10 @@ PxControllerCollisionFlags Controller::move(SweptVolume& volume, const PxVec3& o
 //	printf("standingOnMoving: %d\n", standingOnMoving);
 
 	///////////
-	PxArray<const void*>&		boxUserData		= mManager->mBoxUserData;
-	PxArray<PxExtendedBox>&		boxes			= mManager->mBoxes;
-	PxArray<const void*>&		capsuleUserData	= mManager->mCapsuleUserData;
-	PxArray<PxExtendedCapsule>&	capsules		= mManager->mCapsules;
+	PxArray<const void*>&		boxUserData		= mBoxUserData;
+	PxArray<PxExtendedBox>&		boxes			= mBoxes;
+	PxArray<const void*>&		capsuleUserData	= mCapsuleUserData;
+	PxArray<PxExtendedCapsule>&	capsules		= mCapsules;
 	PX_ASSERT(!boxUserData.size());
 	PX_ASSERT(!boxes.size());
 	PX_ASSERT(!capsuleUserData.size());
@@ -2394,11 +2394,15 @@ PxControllerCollisionFlags Controller::move(SweptVolume& volume, const PxVec3& o
 		PX_PROFILE_ZONE("CharacterController.filterCandidateControllers", getContextId());
 
 		// Experiment - to do better
-		const PxU32 nbControllers = mManager->getNbControllers();
+		// nickel: only visit the candidate list when the engine provides one
+		const PxU32* candidates = mCCTCandidates;
+		const PxU32 nbControllers = candidates ? mNbCCTCandidates : mManager->getNbControllers();
 		Controller** controllers = mManager->getControllers();
 
-		for(PxU32 i=0;i<nbControllers;i++)
+		for(PxU32 c=0;c<nbControllers;c++)
 		{
+			const PxU32 i = candidates ? candidates[c] : c;
+			PX_ASSERT(i<mManager->getNbControllers());
 			Controller* currentController = controllers[i];
 			if(currentController==this)
 				continue;
@@ -2533,6 +2537,9 @@ PxControllerCollisionFlags Controller::move(SweptVolume& volume, const PxVec3& o
 	findGeomData.scene				= mScene;
 	findGeomData.renderBuffer		= renderBuffer;
 	findGeomData.cctShapeHashSet	= &mManager->mCCTShapes;
+	findGeomData.sharedHits			= mSharedHits;
+	findGeomData.nbSharedHits		= mNbSharedHits;
+	findGeomData.sharedBounds		= mSharedBounds;
 
 	mCctModule.mFlags &= ~STF_WALK_EXPERIMENT;
 
@@ -2578,11 +2585,21 @@ PxControllerCollisionFlags Controller::move(SweptVolume& volume, const PxVec3& o
 			PxTransform targetPose = mKineActor->getGlobalPose();
 			targetPose.p = toVec3(mPosition);
 			targetPose.q = mUserParams.mQuatFromUp;
-			mKineActor->setKinematicTarget(targetPose);
+			// nickel: writing the target may wake the actor up, which touches scene data shared by all controllers
+			if(mDeferKinematicTarget)
+			{
+				mPendingKinematicTarget = targetPose;
+				mHasPendingKinematicTarget = true;
+			}
+			else
+				mKineActor->setKinematicTarget(targetPose);
 		}
 	}
 
-	mManager->resetObstaclesBuffers();
+	mBoxUserData.resetOrClear();
+	mBoxes.resetOrClear();
+	mCapsuleUserData.resetOrClear();
+	mCapsules.resetOrClear();
 
 	if (lockWrite)
 		mWriteLock.unlock();
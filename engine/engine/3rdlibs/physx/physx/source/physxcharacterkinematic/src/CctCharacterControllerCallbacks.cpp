@@ -35,6 +35,7 @@
 #include "geometry/PxHeightFieldGeometry.h"
 #include "geometry/PxConvexMesh.h"
 #include "geometry/PxMeshQuery.h"
+#include "geometry/PxGeometryQuery.h"
 #include "common/PxRenderBuffer.h"
 #include "common/PxRenderOutput.h"
 #include "foundation/PxMathUtils.h"
@@ -977,20 +978,41 @@ void Cct::findTouchedGeometry(
 
 	PxOverlapBuffer hitBuffer(hits, size);
 	sceneQueryFilterData.flags |= PxQueryFlag::eNO_BLOCK; // fix for DE8255
+
+	// nickel: hits shared by several controllers are a superset of this query when they cover its box. They were
+	// gathered with the same filter data and no filter callback, shapes outside this box are skipped below
+	const bool useSharedHits = internalData->sharedHits && !filter.mFilterCallback && tmpBounds.isInside(internalData->sharedBounds);
+
+	const PxOverlapHit* touchedHits = hits;
 	PxU32 numberHits = 0;
 	if (extents.x > 0.0f && extents.y > 0.0f && extents.z > 0.0f) 
 	{
-		scene->overlap(PxBoxGeometry(extents), PxTransform(center), hitBuffer, sceneQueryFilterData, filter.mFilterCallback);
-		numberHits = hitBuffer.getNbAnyHits();
+		if(useSharedHits)
+		{
+			touchedHits = internalData->sharedHits;
+			numberHits = internalData->nbSharedHits;
+		}
+		else
+		{
+			scene->overlap(PxBoxGeometry(extents), PxTransform(center), hitBuffer, sceneQueryFilterData, filter.mFilterCallback);
+			numberHits = hitBuffer.getNbTouches();
+		}
 	}
 	for(PxU32 i = 0; i < numberHits; i++)
 	{
-		const PxOverlapHit& hit = hitBuffer.getAnyHit(i);
+		const PxOverlapHit& hit = touchedHits[i];
 		PxShape* shape = hit.shape;
 		PxRigidActor* actor = hit.actor;
 		if(!shape || !actor)
 			continue;
 
+		if(useSharedHits)
+		{
+			const bool isStatic = actor->getConcreteType()==PxConcreteType::eRIGID_STATIC;
+			if(isStatic ? !filter.mStaticShapes : !filter.mDynamicShapes)
+				continue;
+		}
+
 		// Filtering
 
 		// Discard all CCT shapes, i.e. kinematic actors we created ourselves. We don't need to collide with them since they're surrounded
@@ -1007,6 +1029,9 @@ void Cct::findTouchedGeometry(
 		// Output shape to stream
 		const PxTransform globalPose = getShapeGlobalPose(*shape, *actor);
 
+		if(useSharedHits && !PxGeometryQuery::overlap(PxBoxGeometry(extents), PxTransform(center), shape->getGeometry(), globalPose))
+			continue;
+
 		const PxGeometryType::Enum type = shape->getGeometry().getType();	// ### VIRTUAL!
 		if(type==PxGeometryType::eSPHERE)				outputSphereToStream		(shape, actor, globalPose, geomStream, Origin);
 		else	if(type==PxGeometryType::eCAPSULE)		outputCapsuleToStream		(shape, actor, globalPose, geomStream, Origin);
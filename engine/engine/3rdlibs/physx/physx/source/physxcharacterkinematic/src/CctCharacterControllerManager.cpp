@@ -363,14 +363,6 @@ void CharacterControllerManager::onObstacleAdded(PxObstacleHandle index, const P
 	}
 }
 
-void CharacterControllerManager::resetObstaclesBuffers()
-{
-	mBoxUserData.resetOrClear();
-	mBoxes.resetOrClear();
-	mCapsuleUserData.resetOrClear();
-	mCapsules.resetOrClear();
-}
-
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void CharacterControllerManager::setTessellation(bool flag, float maxEdgeLength)
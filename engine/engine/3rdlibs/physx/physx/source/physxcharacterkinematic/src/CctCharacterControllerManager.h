@@ -107,19 +107,11 @@ namespace Cct
 						void							releaseController(PxController& controller);
 						Controller**					getControllers();
 						void							releaseObstacleContext(ObstacleContext& oc);
-						void							resetObstaclesBuffers();
 
 						PxScene&						mScene;
 
 						PxRenderBuffer*					mRenderBuffer;
 						PxControllerDebugRenderFlags	mDebugRenderingFlags;
-		// Shared buffers for obstacles
-						PxArray<const void*>			mBoxUserData;
-						PxArray<PxExtendedBox>			mBoxes;
-
-						PxArray<const void*>			mCapsuleUserData;
-						PxArray<PxExtendedCapsule>		mCapsules;
-
 						PxArray<Controller*>			mControllers;
 						PxHashSet<PxShape*>				mCCTShapes;
 
@@ -36,6 +36,7 @@
 
 #include "CctController.h"
 #include "CctBoxController.h"
+#include "CctCapsuleController.h"
 #include "CctCharacterControllerManager.h"
 #include "foundation/PxUtilities.h"
 
@@ -71,6 +72,14 @@ Controller::Controller(const PxControllerDesc& desc, PxScene* s) :
 	mUserData							= desc.userData;
 
 	mKineActor							= NULL;
+	mCCTCandidates						= NULL;
+	mNbCCTCandidates					= 0;
+	mDeferKinematicTarget				= false;
+	mHasPendingKinematicTarget			= false;
+	mPendingKinematicTarget				= PxTransform(PxIdentity);
+	mSharedHits							= NULL;
+	mNbSharedHits						= 0;
+	mSharedBounds						= PxBounds3::empty();
 	mPosition							= desc.position;
 	mProxyDensity						= desc.density;
 	mProxyScaleCoeff					= desc.scaleCoeff;
@@ -236,3 +245,56 @@ PxShape* Controller::getKineShape() const
 	PX_UNUSED(nb);
 	return shape;
 }
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// nickel: engine-side extensions, declared in nickel/physics/internal/cct_ext.hpp
+
+static Controller* toController(PxController& controller)
+{
+	if(controller.getType()==PxControllerShapeType::eBOX)
+		return static_cast<BoxController*>(&controller);
+	PX_ASSERT(controller.getType()==PxControllerShapeType::eCAPSULE);
+	return static_cast<CapsuleController*>(&controller);
+}
+
+namespace nickel
+{
+namespace physics
+{
+void SetCCTCandidates(PxController& controller, const PxU32* candidates, PxU32 count)
+{
+	Controller* ctrl = toController(controller);
+	ctrl->mCCTCandidates = candidates;
+	ctrl->mNbCCTCandidates = count;
+}
+
+void SetDeferKinematicTarget(PxController& controller, bool defer)
+{
+	toController(controller)->mDeferKinematicTarget = defer;
+}
+
+void SetCCTSharedOverlap(PxController& controller, const PxOverlapHit* hits, PxU32 count, const PxBounds3& bounds)
+{
+	Controller* ctrl = toController(controller);
+	ctrl->mSharedHits = hits;
+	ctrl->mNbSharedHits = count;
+	ctrl->mSharedBounds = bounds;
+}
+
+void SetCCTManagerLocking(PxControllerManager& manager, bool enable)
+{
+	static_cast<CharacterControllerManager&>(manager).mLockingEnabled = enable;
+}
+
+void CommitKinematicTarget(PxController& controller)
+{
+	Controller* ctrl = toController(controller);
+	if(ctrl->mHasPendingKinematicTarget)
+	{
+		ctrl->mKineActor->setKinematicTarget(ctrl->mPendingKinematicTarget);
+		ctrl->mHasPendingKinematicTarget = false;
+	}
+}
+}
+}
@@ -35,6 +35,7 @@
 #include "CctCharacterController.h"
 #include "foundation/PxUserAllocated.h"
 #include "foundation/PxMutex.h"
+#include "PxQueryReport.h"
 
 namespace physx
 {
@@ -100,6 +101,25 @@ namespace Cct
 					bool							mRegisterDeletionListener;
 		mutable		PxMutex							mWriteLock;			// Lock used for guarding touched pointers and cache data from overwriting 
 																			// during onRelease call.
+		// nickel: obstacle buffers are per controller (they used to be shared by the manager) so that
+		// independent controllers can be moved from several threads
+					PxArray<const void*>			mBoxUserData;
+					PxArray<PxExtendedBox>			mBoxes;
+					PxArray<const void*>			mCapsuleUserData;
+					PxArray<PxExtendedCapsule>		mCapsules;
+		// nickel: set by the engine through nickel/physics/internal/cct_ext.hpp, not part of the SDK API.
+		// Optional CCT-vs-CCT candidates (indices of the manager's controllers) visited instead of every controller,
+		// and kinematic target writes kept on the controller until the engine commits them from a single thread
+					const PxU32*					mCCTCandidates;
+					PxU32							mNbCCTCandidates;
+					bool							mDeferKinematicTarget;
+					bool							mHasPendingKinematicTarget;
+					PxTransform						mPendingKinematicTarget;
+		// nickel: optional hits of one scene overlap covering several controllers, used by findTouchedGeometry
+		// instead of its own scene query when they cover the query box
+					const PxOverlapHit*				mSharedHits;
+					PxU32							mNbSharedHits;
+					PxBounds3						mSharedBounds;
 	protected:
 		// Internal methods
 					void							setUpDirectionInternal(const PxVec3& up);
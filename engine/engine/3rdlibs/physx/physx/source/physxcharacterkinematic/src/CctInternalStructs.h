@@ -77,6 +77,11 @@ namespace Cct
 		PxRenderBuffer*			renderBuffer;	// Render buffer from controller manager, not the one from the scene
 
 		PxHashSet<PxShape*>*	cctShapeHashSet;
+
+		// nickel: see Controller::mSharedHits
+		const PxOverlapHit*		sharedHits;
+		PxU32					nbSharedHits;
+		PxBounds3				sharedBounds;
 	};
 }
 }
@@ -285,6 +285,19 @@ private:
 
 PxU32 PxVehicleDrivableSurfaceToTireFrictionPairs::getSurfaceType(const PxMaterial& surfaceMaterial) const
 {
+	//nickel: materials placed in the table by the engine store (entry index + 1) in userData.
+	//Verify the entry and return its type directly instead of rebuilding the hash table for
+	//every wheel in every update. Untagged materials are never in an engine table.
+	const uintptr_t tag = reinterpret_cast<uintptr_t>(surfaceMaterial.userData);
+	if (0 == tag)
+	{
+		return 0;
+	}
+	if (tag <= mNbSurfaceTypes && mDrivableSurfaceMaterials[tag - 1] == &surfaceMaterial)
+	{
+		return mDrivableSurfaceTypes[tag - 1].mType;
+	}
+	//Tagged by another table, fall back to the hash table.
 	const VehicleSurfaceTypeHashTable surfaceTypeHashTable(*this);
 	const PxU32 surfaceType = surfaceTypeHashTable.get(&surfaceMaterial);
 	return surfaceType;
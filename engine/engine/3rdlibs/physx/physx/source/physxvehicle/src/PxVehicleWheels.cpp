@@ -930,6 +930,37 @@ void PxVehicleWheelsDynData::copy(const PxVehicleWheelsDynData& src, const PxU32
 	}
 }
 
+//nickel: snapshot access to the internal wheel state.
+void PxVehicleWheelsDynData::getWheelState(const PxU32 wheelIdx, PxReal* state) const
+{
+	PX_CHECK_AND_RETURN(wheelIdx < mNbActiveWheels, "PxVehicleWheelsDynData::getWheelState - Illegal wheel");
+
+	const PxVehicleWheels4DynData& dyn4 = mWheels4DynData[(wheelIdx>>2)];
+	const PxU32 i = wheelIdx & 3;
+	state[0] = dyn4.mWheelSpeeds[i];
+	state[1] = dyn4.mCorrectedWheelSpeeds[i];
+	state[2] = dyn4.mWheelRotationAngles[i];
+	state[3] = dyn4.mTireLowForwardSpeedTimers[i];
+	state[4] = dyn4.mTireLowSideSpeedTimers[i];
+	state[5] = dyn4.mJounces[i];
+	state[6] = dyn4.mSteerAngles[i];
+}
+
+void PxVehicleWheelsDynData::setWheelState(const PxU32 wheelIdx, const PxReal* state)
+{
+	PX_CHECK_AND_RETURN(wheelIdx < mNbActiveWheels, "PxVehicleWheelsDynData::setWheelState - Illegal wheel");
+
+	PxVehicleWheels4DynData& dyn4 = mWheels4DynData[(wheelIdx>>2)];
+	const PxU32 i = wheelIdx & 3;
+	dyn4.mWheelSpeeds[i] = state[0];
+	dyn4.mCorrectedWheelSpeeds[i] = state[1];
+	dyn4.mWheelRotationAngles[i] = state[2];
+	dyn4.mTireLowForwardSpeedTimers[i] = state[3];
+	dyn4.mTireLowSideSpeedTimers[i] = state[4];
+	dyn4.mJounces[i] = state[5];
+	dyn4.mSteerAngles[i] = state[6];
+}
+
 PxU32 PxVehicleWheelsDynData::getConstraints(PxConstraint** userBuffer, PxU32 bufferSize, PxU32 startIndex) const
 {
 	const PxU32 remainder = PxU32(PxMax<PxI32>(PxI32(mNbWheels4 - startIndex), 0));
@@ -16,15 +16,19 @@ layout(binding = 0) uniform MyUniform {
     mat4 proj;
 } MVP;
 
-layout(push_constant) uniform PushConstant {
+// per-draw data in uniform ring, bound with dynamic offset
+layout(set = 2, binding = 0) uniform DrawData {
     mat4 model;
+} draw;
+
+layout(push_constant) uniform PushConstant {
     mat4 view;
 } pushConstant;
 
 void main() {
     vs_out.inPos = inPosition;
 
-    mat4 model = pushConstant.model;
+    mat4 model = draw.model;
     vec4 fragPos = model * vec4(inPosition, 1.0);
     gl_Position = MVP.proj * pushConstant.view * fragPos;
 
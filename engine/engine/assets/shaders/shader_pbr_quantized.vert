@@ -0,0 +1,55 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inUV;
+// octahedral encoded, see `GLTFQuantizedVertex`
+layout(location = 2) in vec2 inNormal;
+layout(location = 3) in vec4 inTangent;
+
+layout (location = 0) out VS_OUT{
+    vec2 fragUV;
+    vec3 inPos;
+    vec3 fragPos;
+    mat3 TBN;
+} vs_out;
+
+layout(binding = 0) uniform MyUniform {
+    mat4 proj;
+} MVP;
+
+// per-draw data in uniform ring, bound with dynamic offset
+layout(set = 2, binding = 0) uniform DrawData {
+    mat4 model;
+} draw;
+
+layout(push_constant) uniform PushConstant {
+    mat4 view;
+} pushConstant;
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+void main() {
+    vs_out.inPos = inPosition;
+
+    mat4 model = draw.model;
+    vec4 fragPos = model * vec4(inPosition, 1.0);
+    gl_Position = MVP.proj * pushConstant.view * fragPos;
+
+    vs_out.fragPos = vec3(fragPos);
+
+    mat3 normalMat = mat3(transpose(inverse(model)));
+
+    vs_out.fragUV = inUV;
+
+    vec3 T = normalize(normalMat * normalize(inTangent.xyz));
+    vec3 N = normalize(normalMat * decodeOctahedral(inNormal));
+    vec3 B = normalize(cross(N, T) * inTangent.w);
+
+    vs_out.TBN = mat3(T, B, N);
+}
\ No newline at end of file
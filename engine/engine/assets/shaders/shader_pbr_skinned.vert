@@ -0,0 +1,59 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) in vec3 inNormal;
+layout(location = 3) in vec4 inTangent;
+layout(location = 4) in uvec4 inJoints;
+layout(location = 5) in vec4 inWeights;
+
+layout (location = 0) out VS_OUT{
+    vec2 fragUV;
+    vec3 inPos;
+    vec3 fragPos;
+    mat3 TBN;
+} vs_out;
+
+layout(binding = 0) uniform MyUniform {
+    mat4 proj;
+} MVP;
+
+// palettes of all skinned draws, this draw's starts at first instance
+layout(set = 1, binding = 0) readonly buffer JointPalette {
+    mat4 joints[];
+} palette;
+
+// per-draw data in uniform ring, bound with dynamic offset
+layout(set = 2, binding = 0) uniform DrawData {
+    mat4 model;
+} draw;
+
+layout(push_constant) uniform PushConstant {
+    mat4 view;
+} pushConstant;
+
+void main() {
+    vs_out.inPos = inPosition;
+
+    uint base = gl_InstanceIndex;
+    mat4 skin = inWeights.x * palette.joints[base + inJoints.x] +
+                inWeights.y * palette.joints[base + inJoints.y] +
+                inWeights.z * palette.joints[base + inJoints.z] +
+                inWeights.w * palette.joints[base + inJoints.w];
+
+    mat4 model = draw.model * skin;
+    vec4 fragPos = model * vec4(inPosition, 1.0);
+    gl_Position = MVP.proj * pushConstant.view * fragPos;
+
+    vs_out.fragPos = vec3(fragPos);
+
+    mat3 normalMat = mat3(transpose(inverse(model)));
+
+    vs_out.fragUV = inUV;
+
+    vec3 T = normalize(normalMat * normalize(inTangent.xyz));
+    vec3 N = normalize(normalMat * normalize(inNormal));
+    vec3 B = normalize(cross(N, T) * inTangent.w);
+
+    vs_out.TBN = mat3(T, B, N);
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+
+namespace nickel {
+
+enum class AssetLoadState {
+    Pending,
+    Ready,
+    Failed,
+};
+
+/**
+ * @brief shared view of an asset being loaded in background
+ *
+ * The loading manager resolves the handle in its main thread update, so the
+ * state only changes between frames and is safe to poll without locking.
+ */
+template <typename T>
+class AsyncHandle {
+public:
+    AsyncHandle() = default;
+
+    static AsyncHandle CreatePending() {
+        AsyncHandle handle;
+        handle.m_state = std::make_shared<State>();
+        return handle;
+    }
+
+    static AsyncHandle CreateReady(const T& value) {
+        auto handle = CreatePending();
+        handle.Resolve(value);
+        return handle;
+    }
+
+    static AsyncHandle CreateFailed() {
+        auto handle = CreatePending();
+        handle.Fail();
+        return handle;
+    }
+
+    AssetLoadState GetState() const noexcept {
+        return m_state ? m_state->m_state : AssetLoadState::Failed;
+    }
+
+    bool IsPending() const noexcept {
+        return GetState() == AssetLoadState::Pending;
+    }
+
+    bool IsReady() const noexcept {
+        return GetState() == AssetLoadState::Ready;
+    }
+
+    bool IsFailed() const noexcept {
+        return GetState() == AssetLoadState::Failed;
+    }
+
+    /// @brief loaded value, default constructed unless `IsReady()`
+    const T& Get() const noexcept {
+        static const T empty{};
+        return IsReady() ? m_state->m_value : empty;
+    }
+
+    void Resolve(const T& value) {
+        m_state->m_value = value;
+        m_state->m_state = AssetLoadState::Ready;
+    }
+
+    void Fail() { m_state->m_state = AssetLoadState::Failed; }
+
+    /// @brief whether handle refers to a load request
+    explicit operator bool() const noexcept { return m_state != nullptr; }
+
+private:
+    struct State {
+        AssetLoadState m_state = AssetLoadState::Pending;
+        T m_value{};
+    };
+
+    std::shared_ptr<State> m_state;
+};
+
+}  // namespace nickel
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <span>
+
+namespace nickel {
+
+/**
+ * @brief 64-bit content hash of bytes, stable across runs & platforms
+ *
+ * FNV-1a over 8-byte words with a final avalanche, fast enough for whole
+ * image files. Not cryptographic, equal hashes only mean likely equal content.
+ */
+inline uint64_t HashBytes(std::span<const unsigned char> data,
+                          uint64_t seed = 0xcbf29ce484222325ull) {
+    constexpr uint64_t Prime = 0x100000001b3ull;
+    uint64_t hash = seed ^ data.size();
+    size_t i = 0;
+    for (; i + 8 <= data.size(); i += 8) {
+        uint64_t word;
+        memcpy(&word, data.data() + i, sizeof(word));
+        hash = (hash ^ word) * Prime;
+    }
+    for (; i < data.size(); i++) {
+        hash = (hash ^ data[i]) * Prime;
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/// @brief mix hash of `value` into `seed`, for hashing structs field by field
+template <typename T>
+void HashCombine(size_t& seed, const T& value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) +
+            (seed >> 2);
+}
+
+}  // namespace nickel
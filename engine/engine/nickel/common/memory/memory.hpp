@@ -51,9 +51,8 @@ public:
 
         while (block_node &&
                (std::uintptr_t(p) < std::uintptr_t(block_node->m_data.m_mem) ||
-                std::uintptr_t(p) >=
-                std::uintptr_t(block_node->m_data.m_mem +
-                               m_block_mem_count * sizeof(Mem)))) {
+                std::uintptr_t(p) >= std::uintptr_t(block_node->m_data.m_mem +
+                                                     m_block_mem_count))) {
             block_node = block_node->m_next;
         }
 
@@ -69,9 +68,8 @@ public:
 
         while (block_node &&
                (std::uintptr_t(p) < std::uintptr_t(block_node->m_data.m_mem) ||
-                std::uintptr_t(p) >=
-                std::uintptr_t(block_node->m_data.m_mem +
-                               m_block_mem_count * sizeof(Mem)))) {
+                std::uintptr_t(p) >= std::uintptr_t(block_node->m_data.m_mem +
+                                                     m_block_mem_count))) {
             block_node = block_node->m_next;
         }
 
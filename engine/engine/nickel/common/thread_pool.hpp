@@ -0,0 +1,52 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace nickel {
+
+/// @brief fixed size worker pool for CPU side jobs (asset parsing, decoding)
+class ThreadPool {
+public:
+    /// @param thread_num 0 means `hardware_concurrency() - 1`, at least 1
+    explicit ThreadPool(uint32_t thread_num = 0);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// @brief finish queued jobs then join workers
+    ~ThreadPool();
+
+    template <typename F>
+    auto Submit(F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using R = std::invoke_result_t<std::decay_t<F>>;
+        auto task =
+            std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        auto future = task->get_future();
+        {
+            std::lock_guard lock{m_mutex};
+            m_jobs.emplace_back([task] { (*task)(); });
+        }
+        m_cond.notify_one();
+        return future;
+    }
+
+    uint32_t GetThreadNum() const noexcept;
+
+private:
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    bool m_stop = false;
+
+    void workerLoop();
+};
+
+}  // namespace nickel
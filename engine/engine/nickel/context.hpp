@@ -1,6 +1,7 @@
 #pragma once
 #include "nickel/common/dllexport.hpp"
 #include "nickel/common/singleton.hpp"
+#include "nickel/common/thread_pool.hpp"
 #include "nickel/fs/dialog.hpp"
 #include "nickel/fs/storage.hpp"
 #include "nickel/graphics/camera.hpp"
@@ -46,6 +47,7 @@ public:
     const Application* GetApplication() const noexcept;
     StorageManager& GetStorageManager();
     const StorageManager& GetStorageManager() const;
+    ThreadPool& GetThreadPool();
     graphics::Context& GetGraphicsContext();
     graphics::TextureManager& GetTextureManager();
     const graphics::TextureManager& GetTextureManager() const;
@@ -69,6 +71,9 @@ public:
 
     const Path& GetEngineRelativePath() const;
 
+    /// @brief root of assets cooked at build time, mirrors the source tree
+    const Path& GetCookedAssetPath() const;
+
 private:
     bool m_should_exit = false;
     SVector<uint32_t, 2> m_old_window_size;
@@ -77,6 +82,7 @@ private:
     std::unique_ptr<Camera> m_camera;
     std::unique_ptr<graphics::Context> m_graphics_ctx;
     std::unique_ptr<StorageManager> m_storage_mgr;
+    std::unique_ptr<ThreadPool> m_thread_pool;
     std::unique_ptr<physics::Context> m_physics;
     std::unique_ptr<graphics::DebugDrawer> m_debug_drawer;
     Time m_time;
@@ -88,6 +94,7 @@ private:
     std::unique_ptr<Application> m_application;
 
     Path m_engine_relative_path;
+    Path m_cooked_asset_path;
 
     void initCamera() {
         auto window_size = m_window->GetSize();
@@ -97,7 +104,13 @@ private:
                                                0.01f, 10000.0f);
     }
 
-    Path parseEngineProjectPath() const;
+    void parseEngineProjectPath();
+
+    /// pipeline cache lives in user storage, see `PipelineCacheFilename`
+    void loadPipelineCache();
+    void savePipelineCache();
+    physics::InstrumentationConfig parsePhysicsInstrumentationConfig() const;
+    graphics::TextureStreamingConfig parseTextureStreamingConfig() const;
 };
 
 class NICKEL_API Application {
@@ -0,0 +1,40 @@
+#pragma once
+#include "nickel/fs/path.hpp"
+
+#include <span>
+
+namespace nickel {
+
+/**
+ * @brief read-only memory mapped file
+ * @note only works for files on the native file system (not in android apk
+ * assets), check `IsValid()` and fall back to `ReadWholeFile`
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const Path& filename);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) noexcept;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) noexcept;
+    ~MappedFile();
+
+    bool IsValid() const noexcept;
+    std::span<const unsigned char> GetData() const noexcept;
+
+    operator bool() const noexcept { return IsValid(); }
+
+private:
+    const unsigned char* m_data{};
+    size_t m_size{};
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#endif
+
+    void release();
+};
+
+}  // namespace nickel
@@ -36,6 +36,8 @@ class ReadOnlyStorageBehavior {
 public:
     void Initialize(StorageImpl*);
     uint64_t GetFileSize(const Path& filename) const;
+    /// @brief check a file without logging an error when it is missing
+    bool IsFileExists(const Path& filename) const;
     uint64_t GetRemainingSpacing() const;
     std::vector<char> ReadStorageFile(const Path& filename) const;
     bool ReadStorageFile(const Path& filename, void* buffer,
@@ -0,0 +1,153 @@
+#pragma once
+#include "nickel/common/math/math.hpp"
+#include "nickel/graphics/gltf.hpp"
+
+#include <span>
+#include <string>
+#include <vector>
+
+namespace nickel {
+class ThreadPool;
+}
+
+namespace nickel::graphics {
+
+/// local translation, rotation & scale of 4 joints, structure of arrays for
+/// SIMD sampling, see `SampleAnimation`
+struct alignas(16) JointTransform4 final {
+    float m_translation_x[4]{};
+    float m_translation_y[4]{};
+    float m_translation_z[4]{};
+    float m_rotation_x[4]{};
+    float m_rotation_y[4]{};
+    float m_rotation_z[4]{};
+    float m_rotation_w[4]{1, 1, 1, 1};
+    float m_scale_x[4]{1, 1, 1, 1};
+    float m_scale_y[4]{1, 1, 1, 1};
+    float m_scale_z[4]{1, 1, 1, 1};
+};
+
+/// @brief `JointTransform4` blocks holding `joint_count` joints
+inline uint32_t GetJointGroupCount(uint32_t joint_count) {
+    return (joint_count + 3) / 4;
+}
+
+void SetJointTransform(std::span<JointTransform4> pose, uint32_t joint,
+                       const Vec3& translation, const Quat& rotation,
+                       const Vec3& scale);
+void GetJointTransform(std::span<const JointTransform4> pose, uint32_t joint,
+                       Vec3& out_translation, Quat& out_rotation,
+                       Vec3& out_scale);
+
+/// joint hierarchy of a glTF skin, indices follow `skin.joints` so they
+/// match `JOINTS_0`
+struct Skeleton final {
+    std::vector<std::string> m_joint_names;
+
+    /// parent joint, -1 for roots
+    std::vector<int32_t> m_parents;
+
+    /// joints with parents before children
+    std::vector<uint32_t> m_order;
+
+    std::vector<Mat44> m_inverse_bind_matrices;
+
+    /// transform of non-joint ancestors, applied to roots
+    std::vector<Mat44> m_root_transforms;
+
+    /// node transforms, used where a clip has no channel
+    std::vector<JointTransform4> m_rest_pose;
+
+    uint32_t GetJointCount() const noexcept { return m_parents.size(); }
+};
+
+/// animation resampled at a fixed rate into local joint transforms of one
+/// skeleton
+struct AnimationClip final {
+    std::string m_name;
+    float m_duration{};
+
+    /// frames per second, frames cover `[0, m_duration]` evenly
+    float m_sample_rate{};
+    uint32_t m_joint_count{};
+
+    /// frame major, `GetJointGroupCount(m_joint_count)` blocks per frame
+    std::vector<JointTransform4> m_frames;
+
+    uint32_t GetFrameCount() const noexcept;
+};
+
+/// default rate animations are resampled at on load
+constexpr float AnimationSampleRate = 30.0f;
+
+/**
+ * @brief pose at `time` by interpolating the two nearest frames, rotations
+ * are normalized lerped along the shortest path
+ * @param loop wrap time into the clip, otherwise clamp
+ */
+void SampleAnimation(const AnimationClip& clip, float time, bool loop,
+                     std::span<JointTransform4> out_pose);
+
+/// @brief reference of `SampleAnimation` without SIMD
+void SampleAnimationScalar(const AnimationClip& clip, float time, bool loop,
+                           std::span<JointTransform4> out_pose);
+
+/// @brief skinning matrices in model space, global joint transform times
+/// inverse bind matrix
+void ComputeJointPalette(const Skeleton& skeleton,
+                         std::span<const JointTransform4> pose,
+                         std::span<Mat44> out_palette);
+
+/// skeleton & clips of a skinned node, shared by every instance of a model
+struct GLTFSkin final {
+    Skeleton m_skeleton;
+    std::vector<AnimationClip> m_clips;
+};
+
+/// @brief playback state and joint palette of one animated model instance
+class Animator final {
+public:
+    Animator() = default;
+
+    /// @brief animate the first skinned node of `model`
+    explicit Animator(const GLTFModel& model);
+
+    explicit operator bool() const noexcept;
+
+    std::vector<std::string> GetClipNames() const;
+
+    /// @return false if model has no clip of this name
+    bool Play(std::string_view clip_name, bool loop = true);
+    bool Play(uint32_t clip_index, bool loop = true);
+    void Stop();
+    void SetSpeed(float speed);
+    float GetTime() const noexcept;
+
+    /// @brief advance time, sample pose and compute joint palette
+    void Update(float delta_time);
+
+    /// @brief model space skinning matrices, bind pose until first update
+    std::span<const Mat44> GetJointPalette() const noexcept;
+
+    /// index into resource skins, -1 if model is not skinned
+    int32_t GetSkinIndex() const noexcept;
+
+private:
+    GLTFModel m_model;
+    const GLTFSkin* m_skin{};
+    int32_t m_skin_index = -1;
+    const AnimationClip* m_clip{};
+    float m_time{};
+    float m_speed = 1.0f;
+    bool m_loop = true;
+
+    std::vector<JointTransform4> m_pose;
+    std::vector<Mat44> m_palette;
+};
+
+/// @brief `Animator::Update` of all animators, split across `pool` workers
+/// and the calling thread
+void UpdateAnimators(std::span<Animator* const> animators, float delta_time,
+                     ThreadPool* pool = nullptr);
+
+}  // namespace nickel::graphics
@@ -10,22 +10,35 @@ public:
     ImageView GetDepthImageView(uint32_t idx);
     Framebuffer GetFramebuffer(uint32_t idx);
     Semaphore& GetImageAvaliableSemaphore(uint32_t idx);
-    Semaphore& GetRenderFinishSemaphore(uint32_t idx);
     Semaphore& GetImGuiRenderFinishSemaphore(uint32_t idx);
     Fence& GetFence(uint32_t idx);
     void InitFramebuffers(Device& devcie);
     void InitDepthImages(Device& device, const SVector<uint32_t, 2>& size);
 
-    void Begin();
+    /// @brief semaphores waited by present, one per swapchain image so one is
+    /// never signaled again while the presentation engine still holds it
+    void InitPresentSemaphores(Device& device);
+
+    /// camera & view uniforms of each frame in flight are this far apart in
+    /// their buffers, the largest `minUniformBufferOffsetAlignment` allowed
+    static constexpr uint32_t FrameUniformStride = 256;
+
+    /// @brief write camera & view uniforms of frame in flight `frame`
+    void Begin(uint32_t frame);
     void End();
 
+    /// @brief dynamic offset of camera & view uniforms written by `Begin`
+    uint32_t GetFrameUniformOffset() const;
+
     std::vector<Image> m_depth_images;
     std::vector<ImageView> m_depth_image_views;
     std::vector<Framebuffer> m_fbos;
     RenderPass m_render_pass;
+    // indexed by frame in flight
     std::vector<Fence> m_present_fences;
     std::vector<Semaphore> m_image_avaliable_sems;
-    std::vector<Semaphore> m_render_finish_sems;
+
+    // indexed by swapchain image
     std::vector<Semaphore> m_imgui_render_finish_sems;
 
     // some trivial images for default m_usage
@@ -34,10 +47,14 @@ public:
     ImageView m_black_image;
     ImageView m_default_normal_image;
     Sampler m_default_sampler;
+    // one `FrameUniformStride` slice per frame in flight, bound as dynamic
+    // uniforms
     Buffer m_camera_buffer;
     Buffer m_view_buffer;
 
 private:
+    uint32_t m_frame_uniform_offset{};
+
     void initRenderPass(Device& device);
     void initSyncObjects(Device& device);
     void initDefaultResources(Device& device);
@@ -1,6 +1,8 @@
 ﻿#pragma once
 #include "nickel/common/transform.hpp"
 #include "nickel/fs/storage.hpp"
+#include "nickel/graphics/animation.hpp"
+#include "nickel/graphics/frame_latency.hpp"
 #include "nickel/graphics/gltf.hpp"
 #include "nickel/graphics/lowlevel/adapter.hpp"
 #include "nickel/graphics/primitive_draw.hpp"
@@ -28,10 +30,28 @@ public:
     void SetClearColor(const Color& color);
     void SetDepthClearValue(float depth, uint32_t stencil);
 
-    void DrawModel(const Transform& transform, const GLTFModel& model);
+    /// @param lod_state LOD levels of this instance kept between frames,
+    /// must live until the frame ends
+    void DrawModel(const Transform& transform, const GLTFModel& model,
+                   LODState* lod_state = nullptr);
+    void DrawModel(const Transform& transform, const GLTFModel& model,
+                   const Animator& animator, LODState* lod_state = nullptr);
 
     void EnableWireFrame(bool enable) const;
 
+    /// @brief window with GPU times of the render passes, see `GPUProfiler`
+    void ShowGPUProfiler(bool show);
+
+    /// @brief window plotting physics step timings, needs instrumentation
+    /// mode `Profile`, see `physics::Context::GetStepTimings`
+    void ShowPhysicsProfiler(bool show);
+
+    /// @brief input event for latency measurement, in `SDL_GetTicksNS` time
+    void RecordInput(uint64_t timestamp_ns);
+
+    /// input-to-present latency of the last frames
+    const FrameLatencyTracker& GetLatency() const;
+
     void OnSwapchainRecreate(const video::Window& window, Adapter& adapter);
 
     const ContextImpl* GetImpl() const;
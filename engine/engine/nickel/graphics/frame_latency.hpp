@@ -0,0 +1,49 @@
+#pragma once
+#include "nickel/common/dllexport.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace nickel::graphics {
+
+struct FrameLatencyStats {
+    uint32_t m_samples{};
+    float m_last_ms{};
+    float m_average_ms{};
+    float m_p95_ms{};
+    float m_max_ms{};
+};
+
+/**
+ * @brief input-to-present latency of the last frames
+ *
+ * A frame's input time is its earliest input event, or when it began if no
+ * event arrived. It ends when the frame is handed to present, so scanout
+ * isn't included but waiting on frames in flight is. Times are nanoseconds
+ * of one monotonic clock, e.g. `SDL_GetTicksNS` & SDL event timestamps
+ */
+class NICKEL_API FrameLatencyTracker {
+public:
+    explicit FrameLatencyTracker(uint32_t capacity = 240);
+
+    /// input event for the next frame, keeps the earliest
+    void RecordInput(uint64_t timestamp_ns);
+    void BeginFrame(uint64_t now_ns);
+
+    /// ignored if no frame began
+    void Present(uint64_t now_ns);
+
+    /// milliseconds, oldest first
+    std::span<const float> GetHistory() const;
+    FrameLatencyStats GetStats() const;
+
+private:
+    uint32_t m_capacity{};
+    std::vector<float> m_history;
+    std::optional<uint64_t> m_pending_input;
+    std::optional<uint64_t> m_frame_input;
+};
+
+}  // namespace nickel::graphics
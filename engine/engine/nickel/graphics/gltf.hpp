@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include "nickel/common/async_handle.hpp"
 #include "nickel/common/impl_wrapper.hpp"
 #include "nickel/common/transform.hpp"
 #include "nickel/fs/path.hpp"
@@ -8,6 +9,8 @@
 #include "nickel/graphics/material.hpp"
 #include "nickel/graphics/texture.hpp"
 
+#include <set>
+
 namespace tinygltf {
 class Model;
 class Node;
@@ -15,10 +18,29 @@ class Node;
 
 namespace nickel::graphics {
 
+class CookedModelView;
+
+struct GLTFVertexData {
+    std::string m_name;
+    Transform m_transform;
+    std::vector<Vec3> m_points;
+    std::vector<uint32_t> m_indices;
+};
+
 struct GLTFCPUData {
     std::vector<PBRParameters> pbr_parameters;
     std::vector<unsigned char> vertex_buffer;
     std::vector<unsigned char> indices_buffer;
+
+    /// positions & indices of meshes in `GLTFLoadConfig::m_collision_meshes`,
+    /// survive `Release()`
+    std::vector<GLTFVertexData> collision_meshes;
+
+    /// @brief bytes held in system memory
+    uint64_t GetMemorySize() const;
+
+    /// @brief drop vertex, index & material copies
+    void Release();
 };
 
 struct GLTFModelResourceImpl;
@@ -34,10 +56,76 @@ public:
     using ImplWrapper::ImplWrapper;
 };
 
+/// @brief LOD levels selected last frame for one drawn instance of a model,
+/// kept by the instance owner for hysteresis. Models are shared between
+/// instances so they can't hold it
+struct LODState {
+    /// per primitive in preorder of the model tree
+    std::vector<uint32_t> m_levels;
+};
+
 class GLTFManagerImpl;
 
+/// what happens to CPU copies of vertex, index & material data after they
+/// are uploaded to GPU
+enum class GLTFCPUDataPolicy {
+    Keep,
+    Release,
+
+    /// release, `GLTFManager::AcquireCPUData()` re-reads them from the source
+    /// file
+    ReloadOnDemand,
+};
+
+/// import-time reorder & compression of primitive vertices
+struct MeshOptimizeConfig {
+    bool m_deduplicate = true;
+
+    /// triangle order for post-transform vertex cache reuse
+    bool m_optimize_vertex_cache = true;
+
+    /// draw outward facing triangle clusters first, needs
+    /// `m_optimize_vertex_cache`
+    bool m_optimize_overdraw = true;
+
+    /// vertex order by first use in index buffer
+    bool m_optimize_vertex_fetch = true;
+
+    /// half float uv, octahedral normal & snorm8 tangent, halves vertex size
+    bool m_quantize = false;
+
+    /// overdraw pass is dropped if it increases vertex shader invocations by
+    /// more than this ratio
+    float m_overdraw_threshold = 1.05f;
+
+    /// simplified levels of detail generated besides the full mesh, 0
+    /// disables
+    uint32_t m_lod_count = 3;
+
+    /// target index count of each level relative to the previous one
+    float m_lod_reduction = 0.5f;
+
+    /// max simplification error relative to the bounds diameter, coarser
+    /// levels are not generated
+    float m_lod_max_error = 0.05f;
+    /// split large primitives into meshlets for per cluster culling
+    bool m_build_meshlets = true;
+};
+
 struct GLTFLoadConfig {
     bool m_combine_mesh = true;
+    MeshOptimizeConfig m_mesh_optimize;
+    GLTFCPUDataPolicy m_cpu_data_policy = GLTFCPUDataPolicy::Keep;
+
+    /// names of meshes used by physics/collision, their positions & indices
+    /// stay on CPU under any policy
+    std::set<std::string> m_collision_meshes;
+};
+
+struct GLTFMemoryStats {
+    uint64_t m_cpu_size{};       // CPU copies held by loaded models
+    uint64_t m_released_size{};  // CPU copies dropped after GPU upload
+    uint64_t m_gpu_size{};       // vertex, index & material buffers
 };
 
 class CommonResource;
@@ -50,7 +138,40 @@ public:
     ~GLTFManager();
 
     bool Load(const Path&, const GLTFLoadConfig& = {});
+
+    /**
+     * @brief parse model and decode its images on worker threads, then
+     * create GPU resources in `Update()`
+     * @return handle of the combined model, when `m_combine_mesh` is false
+     * it resolves to an empty model and node models are found by name
+     */
+    AsyncHandle<GLTFModel> LoadAsync(const Path&, const GLTFLoadConfig& = {});
+
     GLTFModel Find(const std::string&);
+
+    /// @brief finalize models whose parse and textures are done, call on
+    /// main thread
+    void Update();
+
+    /// @brief whether some async loading is not finished
+    bool HasPendingLoad() const;
+
+    /**
+     * @brief CPU copies of vertex, index & material data of the model
+     *
+     * Released data of `GLTFCPUDataPolicy::ReloadOnDemand` models is re-read
+     * from the source file and kept until `ReleaseCPUData()`. Cooked models
+     * upload from the mapped package and never keep vertex & index copies,
+     * they are re-read unless the policy is `GLTFCPUDataPolicy::Release`.
+     * @return nullptr if released and can't be re-read
+     */
+    const GLTFCPUData* AcquireCPUData(const GLTFModel&);
+
+    /// @brief drop data re-read by `AcquireCPUData()`
+    void ReleaseCPUData(const GLTFModel&);
+
+    GLTFMemoryStats GetMemoryStats() const;
+
     void GC();
     void Clear();
     std::vector<std::string> GetAllGLTFModelNames() const;
@@ -59,26 +180,28 @@ private:
     std::unique_ptr<GLTFManagerImpl> m_impl;
 };
 
-struct GLTFVertexData {
-    std::string m_name;
-    Transform m_transform;
-    std::vector<Vec3> m_points;
-    std::vector<uint32_t> m_indices;
-};
-
 struct GLTFVertexDataLoadConfig {
     bool m_use_parent_coord = true; 
 };
 
 class GLTFVertexDataLoader {
 public:
+    /// @brief load from `.gltf` or cooked `.nkmodel`
     std::vector<GLTFVertexData> Load(const Path& path, bool apply_transform = false);
     std::vector<GLTFVertexData> Load(const tinygltf::Model&, bool apply_transform = false);
+    /// @note cooked nodes only keep matrices, `m_transform` stays identity,
+    /// use `apply_transform` to get world space points
+    std::vector<GLTFVertexData> Load(const CookedModelView&, bool apply_transform = false);
 
     void parseNode(const tinygltf::Model& model, const tinygltf::Node& node,
                    const Transform& parent_transform, bool apply_transform,
                    std::vector<GLTFVertexData>& result);
     Transform calcNodeTransform(const tinygltf::Node& node);
+
+private:
+    void parseCookedNode(const CookedModelView& view, uint32_t node_idx,
+                         const Mat44& parent_transform, bool apply_transform,
+                         std::vector<GLTFVertexData>& result);
 };
 
 }  // namespace nickel::graphics
@@ -1,18 +1,61 @@
 #pragma once
 #include "nickel/common/transform.hpp"
+#include "nickel/graphics/animation.hpp"
 #include "nickel/graphics/common_resource.hpp"
 #include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/internal/bindless.hpp"
+#include "nickel/graphics/internal/meshlet.hpp"
 #include "nickel/graphics/lowlevel/device.hpp"
 #include "nickel/graphics/lowlevel/graphics_pipeline.hpp"
 #include "nickel/graphics/mesh.hpp"
+#include "nickel/graphics/uniform_ring.hpp"
+
+#include <array>
+#include <memory>
+#include <optional>
 
 namespace nickel::graphics {
 
+struct LODSelectConfig {
+    bool m_enable = true;
+
+    /// tolerated simplification error in pixels
+    float m_pixel_error = 1.0f;
+
+    /// the error must pass `m_pixel_error` by this ratio before the level
+    /// changes, avoids popping when screen size oscillates around it
+    float m_hysteresis = 0.25f;
+};
+
+/// @brief projected diameter in pixels of primitive bounding sphere
+/// @param screen_scale pixels covered by unit length at unit distance
+float CalcProjectedSize(const Primitive&, const Mat44& model_mat,
+                        const Vec3& camera_position, float screen_scale);
+
+/// @brief coarsest level of `prim` whose error fits on screen
+/// @param current level selected last frame
+uint32_t SelectLODLevel(const Primitive& prim, float screen_size,
+                        uint32_t current, const LODSelectConfig&);
+
+/// @brief select level of primitive `index` of an instance from the level
+/// kept in `state`, and keep the result
+uint32_t SelectLODLevel(LODState& state, uint32_t index, const Primitive&,
+                        float screen_size, const LODSelectConfig&);
+
 class GLTFRenderPass {
 public:
-    GLTFRenderPass(Device device, CommonResource&);
+    GLTFRenderPass(const Adapter& adapter, CommonResource&);
+
+    /// @param lod_state LOD levels of this instance, must live until the
+    /// frame ends. LOD selection has no hysteresis without it
+    void RenderModel(const Transform&, const GLTFModel&,
+                     LODState* lod_state = nullptr);
 
-    void RenderModel(const Transform&, const GLTFModel&);
+    /// @brief draw skinned meshes of `model` with joint palette of `animator`
+    void RenderModel(const Transform&, const GLTFModel&, const Animator&,
+                     LODState* lod_state = nullptr);
+    void SetLODConfig(const LODSelectConfig&);
+    const LODSelectConfig& GetLODConfig() const;
     void ApplyDrawCall(RenderPassEncoder&, bool wireframe);
     bool NeedDraw() const noexcept;
 
@@ -20,30 +63,100 @@ public:
 
     BindGroupLayout GetBindGroupLayout();
 
+    /// @brief table materials register into, nullptr if device doesn't
+    /// support bindless and each material owns a bind group
+    BindlessTable* GetBindlessTable();
+
 private:
     struct GLTFModelData {
         Transform m_transform;
         GLTFModel m_model;
+
+        // skin animated by this draw, -1 draws every mesh in bind pose
+        int32_t m_skin = -1;
+        uint32_t m_joint_base{};
+        LODState* m_lod_state{};
+    };
+
+    // skinned pipeline follows the ones indexed by `VertexLayout`
+    static constexpr uint32_t SkinnedPipeline = 2;
+
+    // per-draw data in set 2, bound with dynamic offset into the ring
+    struct DrawData {
+        Mat44 m_model;
     };
-    GraphicsPipeline m_solid_pipeline;
-    GraphicsPipeline m_line_frame_pipeline;
+
+    Device m_device;
+    CommonResource& m_common_resource;
+    UniformRingBuffer m_draw_ring;
+    std::array<GraphicsPipeline, 3> m_solid_pipelines;
+    std::array<GraphicsPipeline, 3> m_line_frame_pipelines;
     PipelineLayout m_pipeline_layout;
     BindGroupLayout m_bind_group_layout;
     std::vector<GLTFModelData> m_models;
 
+    struct JointPalettes {
+        Buffer m_buffer;
+        BindGroup m_bind_group;
+    };
+
+    // joint palettes of all skinned draws in one storage buffer per frame in
+    // flight, shader finds its palette through `gl_InstanceIndex`
+    PipelineLayout m_skinned_pipeline_layout;
+    BindGroupLayout m_joint_bind_group_layout;
+    std::vector<JointPalettes> m_joint_palettes;
+    std::vector<Mat44> m_joint_matrices;
+
+    // bindless mode: camera & view buffers in set 0, bindless table in set 3,
+    // material chosen by push constant
+    std::unique_ptr<BindlessTable> m_bindless;
+    BindGroupLayout m_frame_bind_group_layout;
+    BindGroup m_frame_bind_group;
+
+    // for projected size of primitives, which drives LOD selection &
+    // texture streaming
+    Vec3 m_camera_position;
+    float m_screen_scale{};
+    LODSelectConfig m_lod_config;
+
+    // levels of draws without LOD state, reset for each of them
+    LODState m_scratch_lod_state;
+
+    // meshlet culling of level 0, scratch reused between primitives
+    Mat44 m_view_project;
+    std::vector<uint32_t> m_visible_meshlets;
+    std::vector<MeshletDrawRange> m_meshlet_ranges;
+
+    // pipeline is switched when vertex layout of primitives changes
+    bool m_wireframe = false;
+    std::optional<uint32_t> m_bound_pipeline;
+
     GraphicsPipeline::Descriptor getPipelineDescTmpl(
         ShaderModule& vertex_shader, ShaderModule& frag_shader,
-        RenderPass& render_pass, PipelineLayout& layout);
+        RenderPass& render_pass, PipelineLayout& layout,
+        VertexLayout vertex_layout, bool skinned);
     void initSolidPipeline(Device& device, ShaderModule& vertex_shader,
-                           ShaderModule& frag_shader, RenderPass& render_pass);
+                           ShaderModule& frag_shader, RenderPass& render_pass,
+                           VertexLayout vertex_layout, bool skinned = false);
     void initLineFramePipeline(Device& device, ShaderModule& vertex_shader,
                                ShaderModule& frag_shader,
-                               RenderPass& render_pass);
+                               RenderPass& render_pass,
+                               VertexLayout vertex_layout,
+                               bool skinned = false);
     void initPipelineLayout(Device& device);
+    void bindPipeline(RenderPassEncoder& encoder, uint32_t pipeline);
     void initBindGroupLayout(Device& device);
+    void initJointBindGroupLayout(Device& device);
+    void initFrameBindGroup(Device& device, CommonResource&);
+    void uploadJointMatrices();
+
+    // bindless mode: record streamed texture changes into material table
+    void updateMaterials(GLTFModelImpl& model);
 
+    /// @param prim_index index of first primitive of `model` in LOD state
     void visitGPUMesh(RenderPassEncoder& encoder, const Mat44& transform,
-                      GLTFModelImpl& model);
+                      const GLTFModelData& data, GLTFModelImpl& model,
+                      LODState& lod_state, uint32_t& prim_index);
 };
 
 }  // namespace nickel::graphics
\ No newline at end of file
@@ -11,8 +11,10 @@ public:
     ~ImGuiRenderPass();
 
     void Begin();
-    void End(Device device, CommonResource&,
-             uint32_t cur_swapchain_image_idx, uint32_t cur_frame);
+    /// @brief record imgui into `encoder`, backbuffer stays in
+    /// `ColorAttachmentOptimal`
+    void End(Device device, CommandEncoder& encoder,
+             uint32_t cur_swapchain_image_idx);
     void PrepareForRender();
     void InitFramebuffers(const Device&);
     void DestroyFramebuffers();
@@ -28,8 +30,8 @@ private:
     void initDescriptorPool(const Adapter& adapter);
     void initRenderPass(const Adapter& adapter);
     void initCmdPool(const Device& device);
-    void renderImGui(Device, CommonResource&, uint32_t cur_swapchain_image_idx,
-                     uint32_t cur_frame_idx);
+    void renderImGui(Device, CommandEncoder&,
+                     uint32_t cur_swapchain_image_idx);
 };
 
 }  // namespace nickel::graphics
\ No newline at end of file
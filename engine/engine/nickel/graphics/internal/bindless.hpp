@@ -0,0 +1,142 @@
+#pragma once
+#include "nickel/graphics/lowlevel/bind_group.hpp"
+#include "nickel/graphics/lowlevel/bind_group_layout.hpp"
+#include "nickel/graphics/lowlevel/cmd_encoder.hpp"
+#include "nickel/graphics/lowlevel/device.hpp"
+#include "nickel/graphics/material.hpp"
+
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace nickel::graphics {
+
+class Adapter;
+class ImageViewImpl;
+class SamplerImpl;
+
+/**
+ * @brief hands out indices of a fixed size descriptor array, no GPU work
+ *
+ * Freed slots may still be read by frames in flight, so they are reused
+ * only after `reuse_delay` calls of `EndFrame()`.
+ */
+class BindlessSlotAllocator {
+public:
+    BindlessSlotAllocator(uint32_t capacity, uint32_t reuse_delay);
+
+    /// @return nullopt if every slot is taken
+    std::optional<uint32_t> Allocate();
+    void Free(uint32_t slot);
+    void EndFrame();
+
+    uint32_t GetCapacity() const noexcept;
+    uint32_t GetAllocatedCount() const noexcept;
+
+private:
+    struct PendingSlot {
+        uint32_t m_slot{};
+        uint32_t m_frames_left{};
+    };
+
+    uint32_t m_capacity{};
+    uint32_t m_reuse_delay{};
+    uint32_t m_next{};
+    std::vector<uint32_t> m_free_slots;
+    std::vector<PendingSlot> m_pending_slots;
+    std::vector<bool> m_allocated;
+    uint32_t m_allocated_count{};
+};
+
+/// material record in the bindless storage buffer, layout matches
+/// `Material` of shader_pbr_bindless.frag (std430)
+struct BindlessMaterial {
+    Vec4 m_base_color;
+    float m_metallic = 1.0f;
+    float m_roughness = 1.0f;
+    float m_padding[2]{};
+
+    /// base color, normal, metallic roughness, occlusion
+    uint32_t m_images[4]{};
+    uint32_t m_samplers[4]{};
+};
+
+static_assert(sizeof(BindlessMaterial) == 64);
+
+/**
+ * @brief global arrays of images & samplers and a storage buffer of
+ * materials, bound once for all draws
+ *
+ * Draws select their material by a push constant index, so material count
+ * no longer costs descriptor sets. Equal image views & samplers share a slot.
+ */
+class BindlessTable {
+public:
+    static constexpr uint32_t MaxImages = 4096;
+    static constexpr uint32_t MaxSamplers = 256;
+    static constexpr uint32_t MaxMaterials = 16384;
+    static constexpr uint32_t InvalidSlot =
+        std::numeric_limits<uint32_t>::max();
+
+    // bindings of the bind group, see shader_pbr_bindless.frag
+    static constexpr uint32_t ImageBinding = 0;
+    static constexpr uint32_t SamplerBinding = 1;
+    static constexpr uint32_t MaterialBinding = 2;
+
+    /// fragment push constant offset of material index, after model & view
+    /// matrices of vertex stage
+    static constexpr uint32_t MaterialIndexOffset = sizeof(Mat44) * 2;
+
+    /// @brief device has descriptor indexing and room for the material
+    /// index push constant
+    static bool IsSupported(const Adapter&);
+
+    explicit BindlessTable(Device device);
+
+    BindGroupLayout GetBindGroupLayout() const;
+    BindGroup& GetBindGroup();
+
+    /// @return slot of `view`, `InvalidSlot` if table is full
+    uint32_t AcquireImage(const ImageView& view);
+    void ReleaseImage(uint32_t slot);
+    uint32_t AcquireSampler(const Sampler& sampler);
+    void ReleaseSampler(uint32_t slot);
+
+    /// @return index of material, `InvalidSlot` if table is full
+    uint32_t AddMaterial(const BindlessMaterial&);
+    void UpdateMaterial(uint32_t index, const BindlessMaterial&);
+    void RemoveMaterial(uint32_t index);
+
+    /// @brief transfer layout of all images in table for sampling
+    void UseImages(RenderPassEncoder&);
+
+    /// @brief let slots freed some frames ago be reused
+    void EndFrame();
+
+private:
+    template <typename T>
+    struct SharedSlot {
+        T m_resource;
+        uint32_t m_refcount{};
+    };
+
+    Device m_device;
+    BindGroupLayout m_layout;
+    BindGroup m_bind_group;
+    Buffer m_material_buffer;
+
+    BindlessSlotAllocator m_image_slots;
+    BindlessSlotAllocator m_sampler_slots;
+    BindlessSlotAllocator m_material_slots;
+
+    std::unordered_map<const ImageViewImpl*, uint32_t> m_image_indices;
+    std::unordered_map<const SamplerImpl*, uint32_t> m_sampler_indices;
+    std::vector<SharedSlot<ImageView>> m_images;
+    std::vector<SharedSlot<Sampler>> m_samplers;
+
+    void initLayout();
+    void initBindGroup();
+};
+
+}  // namespace nickel::graphics
@@ -1,10 +1,13 @@
 #pragma once
 #include "nickel/fs/storage.hpp"
 #include "nickel/graphics/common_resource.hpp"
+#include "nickel/graphics/frame_latency.hpp"
 #include "nickel/graphics/gltf_draw.hpp"
 #include "nickel/graphics/imgui_draw.hpp"
 #include "nickel/graphics/lowlevel/adapter.hpp"
 #include "nickel/graphics/primitive_draw.hpp"
+#include "nickel/graphics/render_graph.hpp"
+#include "nickel/physics/instrumentation.hpp"
 
 namespace nickel::graphics {
 
@@ -22,12 +25,17 @@ public:
     void DrawLineList(std::span<Vertex> vertices);
     void DrawTriangleList(std::span<Vertex> vertices,
                           std::span<uint32_t> indices, bool wireframe = true);
-    void DrawModel(const Transform& transform, const GLTFModel& model);
+    void DrawModel(const Transform& transform, const GLTFModel& model,
+                   LODState* lod_state);
+    void DrawModel(const Transform& transform, const GLTFModel& model,
+                   const Animator& animator, LODState* lod_state);
 
     void SetClearColor(const Color& color);
     void SetDepthClearValue(float depth, uint32_t stencil);
 
     void EnableWireFrame(bool enable);
+    void ShowGPUProfiler(bool show);
+    void ShowPhysicsProfiler(bool show);
 
     bool ShouldRender() const;
 
@@ -36,16 +44,36 @@ public:
 
     void OnSwapchainRecreate(const video::Window& window, Adapter&);
 
+    /// graph of the last rendered frame
+    const RenderGraph& GetRenderGraph() const;
+
+    void RecordInput(uint64_t timestamp_ns);
+    const FrameLatencyTracker& GetLatency() const;
+
 private:
     CommonResource m_common_resource;
     PrimitiveRenderPass m_primitive_draw;
     ImGuiRenderPass m_imgui_draw;
     GLTFRenderPass m_gltf_draw;
     uint32_t m_swapchain_image_index{};
+
+    // frame in flight, indexes fences & acquire semaphores
     uint32_t m_render_frame_index{};
     bool m_is_wireframe{};
     bool m_enable_render{true};
+    bool m_show_gpu_profiler{};
+    bool m_show_physics_profiler{};
+    std::vector<physics::PhysicsStepTiming> m_physics_timings;
     std::array<ClearValue, 2> m_clear_values;
+    RenderGraph m_render_graph;
+
+    // images of this frame indexed by render graph resource handle
+    std::vector<ImageView> m_graph_images;
+    FrameLatencyTracker m_latency;
+
+    void recordScenePass(Device& device, CommandEncoder&);
+    void drawGPUProfiler();
+    void drawPhysicsProfiler();
 };
 
 }  // namespace nickel::graphics
\ No newline at end of file
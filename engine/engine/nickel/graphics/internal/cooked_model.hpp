@@ -0,0 +1,200 @@
+#pragma once
+#include "nickel/fs/path.hpp"
+#include "nickel/graphics/gltf.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace tinygltf {
+class Model;
+}
+
+namespace nickel::graphics {
+
+/**
+ * @brief cooked model package (`.nkmodel`), produced offline from glTF by
+ * `gltf_cooker`
+ *
+ * The file is a header followed by sections of POD records. Vertex and index
+ * data are stored exactly as the glTF render pass binds them (normals and
+ * tangents generated, mesh optimized and interleaved), so loading is a single
+ * copy from the mapped file into GPU buffers. All offsets are relative to the
+ * file begin and little endian.
+ */
+constexpr uint32_t CookedModelMagic = 0x444D4B4E;  // "NKMD"
+constexpr uint32_t CookedModelVersion = 5;
+constexpr uint32_t CookedModelAlignment = 16;
+constexpr std::string_view CookedModelExtension = ".nkmodel";
+
+enum class CookedSection : uint32_t {
+    Nodes,
+    NodeChildren,  // uint32_t node indices
+    RootNodes,     // uint32_t node indices
+    Meshes,
+    Primitives,
+    PrimitiveLODs,
+    Meshlets,
+    Materials,
+    Images,
+    Samplers,
+    Strings,
+    VertexData,
+    IndexData,
+
+    SectionNum,
+};
+
+struct CookedSectionRange {
+    uint64_t m_offset{};
+    uint64_t m_size{};
+};
+
+struct CookedModelHeader {
+    uint32_t m_magic = CookedModelMagic;
+    uint32_t m_version = CookedModelVersion;
+    CookedSectionRange
+        m_sections[static_cast<uint32_t>(CookedSection::SectionNum)];
+};
+
+struct CookedString {
+    uint32_t m_offset{};
+    uint32_t m_size{};
+};
+
+struct CookedBounds {
+    float m_min[3]{};
+    float m_max[3]{};
+};
+
+struct CookedNode {
+    CookedString m_name;
+    float m_transform[16]{};  // same layout as `Mat44`
+    int32_t m_mesh = -1;
+    uint32_t m_first_child{};
+    uint32_t m_child_count{};
+};
+
+struct CookedMesh {
+    CookedString m_name;
+    uint32_t m_first_primitive{};
+    uint32_t m_primitive_count{};
+    CookedBounds m_bounds;
+};
+
+struct CookedBufferView {
+    uint64_t m_offset{};
+    uint64_t m_size{};
+    uint32_t m_count{};
+    uint32_t m_padding{};
+};
+
+struct CookedPrimitive {
+    CookedBufferView m_vertices;
+    uint32_t m_vertex_layout{};  // `VertexLayout`
+    uint32_t m_padding{};
+    CookedBufferView m_indices;  // empty for non-indexed primitive
+    uint32_t m_index_type{};     // `IndexType`
+    int32_t m_material = -1;
+    CookedBounds m_bounds;
+    uint32_t m_first_lod{};
+    uint32_t m_lod_count{};
+    uint32_t m_first_meshlet{};
+    uint32_t m_meshlet_count{};
+};
+
+struct CookedPrimitiveLOD {
+    CookedBufferView m_indices;  // same index type as the primitive
+    float m_error{};
+    uint32_t m_padding{};
+};
+
+/// same fields as `Meshlet`, index range is in level 0 indices
+struct CookedMeshlet {
+    uint32_t m_first_index{};
+    uint32_t m_index_count{};
+    float m_center[3]{};
+    float m_radius{};
+    float m_cone_axis[3]{};
+    float m_cone_cutoff = 1.0f;
+};
+
+struct CookedTextureRef {
+    int32_t m_image = -1;
+    int32_t m_sampler = -1;
+};
+
+struct CookedMaterial {
+    float m_base_color[4]{1, 1, 1, 1};
+    float m_metallic = 1.0f;
+    float m_roughness = 1.0f;
+    CookedTextureRef m_base_color_texture;
+    CookedTextureRef m_metallic_roughness_texture;
+    CookedTextureRef m_normal_texture;
+    CookedTextureRef m_occlusion_texture;
+};
+
+struct CookedImage {
+    CookedString m_uri;  // relative to the package directory
+    uint32_t m_is_color{};
+};
+
+struct CookedSampler {
+    uint32_t m_min_filter{};  // `Filter`
+    uint32_t m_mag_filter{};
+    uint32_t m_address_mode_u{};  // `SamplerAddressMode`
+    uint32_t m_address_mode_v{};
+    uint32_t m_mipmap_mode{};  // `SamplerMipmapMode`
+    float m_max_lod{};
+};
+
+/// @brief validated read-only view over cooked package bytes, no copy
+class CookedModelView {
+public:
+    CookedModelView() = default;
+
+    /// @param data must outlive the view
+    explicit CookedModelView(std::span<const unsigned char> data);
+
+    bool IsValid() const noexcept { return m_valid; }
+
+    std::span<const CookedNode> GetNodes() const;
+    std::span<const uint32_t> GetNodeChildren(const CookedNode&) const;
+    std::span<const uint32_t> GetRootNodes() const;
+    std::span<const CookedMesh> GetMeshes() const;
+    std::span<const CookedPrimitive> GetPrimitives(const CookedMesh&) const;
+    std::span<const CookedPrimitiveLOD> GetPrimitiveLODs(
+        const CookedPrimitive&) const;
+    std::span<const CookedMeshlet> GetMeshlets(const CookedPrimitive&) const;
+    std::span<const CookedMaterial> GetMaterials() const;
+    std::span<const CookedImage> GetImages() const;
+    std::span<const CookedSampler> GetSamplers() const;
+    std::string_view GetString(const CookedString&) const;
+    std::span<const unsigned char> GetVertexData() const;
+    std::span<const unsigned char> GetIndexData() const;
+
+private:
+    std::span<const unsigned char> m_data;
+    bool m_valid = false;
+
+    template <typename T>
+    std::span<const T> getSection(CookedSection) const;
+
+    bool validate() const;
+};
+
+/**
+ * @brief convert a loaded glTF model into cooked package bytes
+ * @param image_dir prefix of image uri, the glTF directory relative to the
+ * package directory
+ */
+std::vector<unsigned char> CookGLTFModel(
+    const tinygltf::Model& model, const Path& image_dir = {},
+    const MeshOptimizeConfig& optimize_config = {});
+
+/// @brief load glTF (`.gltf` or `.glb`) and write cooked package to `dst`
+bool CookGLTFFile(const Path& src, const Path& dst,
+                  const MeshOptimizeConfig& optimize_config = {});
+
+}  // namespace nickel::graphics
@@ -1,11 +1,18 @@
 #pragma once
+#include "nickel/fs/mapped_file.hpp"
+#include "nickel/graphics/animation.hpp"
 #include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/internal/cooked_model.hpp"
 #include "nickel/graphics/internal/material3d_impl.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+#include "nickel/graphics/internal/meshlet.hpp"
 #include "nickel/graphics/mesh.hpp"
 #include "nickel/graphics/texture_manager.hpp"
 #include "nickel/nickel.hpp"
 #include "tiny_gltf.h"
 
+#include <set>
+
 namespace nickel::graphics {
 class GLTFRenderPass;
 
@@ -118,12 +125,10 @@ BufferView RecordBufferView(const tinygltf::Model& model,
 inline Filter GLTFFilter2RHI(int type) {
     switch (type) {
         case TINYGLTF_TEXTURE_FILTER_LINEAR:
-        // TODO: support mipmap;
         case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_LINEAR:
         case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST:
             return Filter::Linear;
         case TINYGLTF_TEXTURE_FILTER_NEAREST:
-        // TODO: support mipmap;
         case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST:
         case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_LINEAR:
             return Filter::Nearest;
@@ -131,6 +136,26 @@ inline Filter GLTFFilter2RHI(int type) {
     return Filter::Linear;
 }
 
+inline SamplerMipmapMode GLTFMipmapMode2RHI(int min_filter) {
+    switch (min_filter) {
+        case TINYGLTF_TEXTURE_FILTER_LINEAR_MIPMAP_NEAREST:
+        case TINYGLTF_TEXTURE_FILTER_NEAREST_MIPMAP_NEAREST:
+            return SamplerMipmapMode::Nearest;
+    }
+    return SamplerMipmapMode::Linear;
+}
+
+/// @brief min filter without mipmap only samples level 0, undefined filter
+/// uses all levels
+inline float GLTFMaxLod(int min_filter) {
+    switch (min_filter) {
+        case TINYGLTF_TEXTURE_FILTER_LINEAR:
+        case TINYGLTF_TEXTURE_FILTER_NEAREST:
+            return 0;
+    }
+    return 1000.0f;  // VK_LOD_CLAMP_NONE
+}
+
 inline SamplerAddressMode GLTFWrapper2RHI(int type) {
     switch (type) {
         case TINYGLTF_TEXTURE_WRAP_REPEAT:
@@ -144,6 +169,18 @@ inline SamplerAddressMode GLTFWrapper2RHI(int type) {
     }
 }
 
+inline Sampler::Descriptor GLTFSampler2Descriptor(
+    const tinygltf::Sampler& sampler) {
+    Sampler::Descriptor desc;
+    desc.m_min_filter = GLTFFilter2RHI(sampler.minFilter);
+    desc.m_mag_filter = GLTFFilter2RHI(sampler.magFilter);
+    desc.m_mipmap_mode = GLTFMipmapMode2RHI(sampler.minFilter);
+    desc.m_max_lod = GLTFMaxLod(sampler.minFilter);
+    desc.m_address_mode_u = GLTFWrapper2RHI(sampler.wrapS);
+    desc.m_address_mode_v = GLTFWrapper2RHI(sampler.wrapT);
+    return desc;
+}
+
 inline std::string ParseURI2Path(std::string_view str) {
     std::string path;
     path.reserve(str.size());
@@ -197,19 +234,155 @@ inline Mat44 CalcNodeTransform(const tinygltf::Node& node) {
     return m;
 }
 
+/**
+ * @brief append uniform blocks of `params` to `out_data`, each at a multiple
+ * of `align`. Equal parameters share one block
+ * @return offset of each parameter in `out_data`
+ */
+std::vector<uint32_t> PackPBRParameters(std::span<const PBRParameters> params,
+                                        uint32_t align,
+                                        std::vector<unsigned char>& out_data);
+
+/// @brief widen index buffer data to uint32_t
+std::vector<uint32_t> ReadIndices(const unsigned char* data, uint32_t count,
+                                  IndexType type);
+
+/// @brief positions & indices of primitives merged into one triangle list,
+/// read from CPU copies of the buffers their views point into
+GLTFVertexData ExtractVertexData(const std::string& name,
+                                 std::span<const Primitive> prims,
+                                 std::span<const unsigned char> vertex_data,
+                                 std::span<const unsigned char> index_data);
+
+/// @brief flat normals of a triangle list, `indices` is empty for
+/// non-indexed primitive
+void GenerateNormals(std::span<const Vec3> positions,
+                     std::span<const uint32_t> indices,
+                     std::span<Vec3> out_normals);
+
+/// @brief per triangle tangents, `uvs` is empty if primitive has no uv
+void GenerateTangents(std::span<const Vec3> positions,
+                      std::span<const Vec2> uvs,
+                      std::span<const uint32_t> indices,
+                      std::span<Vec4> out_tangents);
+
+/// @brief optimized interleaved vertices & indices of one primitive
+struct GLTFPrimitiveGeometry {
+    VertexLayout m_layout = VertexLayout::Float;
+    std::vector<unsigned char> m_vertices;
+    uint32_t m_vertex_count{};
+    std::vector<uint32_t> m_indices;
+    std::vector<MeshLOD> m_lods;
+    std::vector<Meshlet> m_meshlets;  // of level 0
+
+    /// parallel to vertices, empty if primitive has no `JOINTS_0` &
+    /// `WEIGHTS_0`
+    std::vector<GLTFSkinVertex> m_skin_vertices;
+    Vec3 m_bounds_min;
+    Vec3 m_bounds_max;
+};
+
+/**
+ * @brief read attributes of a triangle list primitive into interleaved
+ * vertices, run mesh optimization, generate LODs and meshlets
+ *
+ * Missing tangents are generated. Missing normals are generated flat, so
+ * triangles get their own vertices before deduplication welds them again.
+ * Skinned primitives are neither deduplicated, quantized nor split into
+ * meshlets: equal vertices may have different weights, the skinning shader
+ * reads the float layout and animated clusters have no static bounds.
+ * @return false if primitive has no POSITION or is not a triangle list
+ */
+bool BuildPrimitiveGeometry(const tinygltf::Model& model,
+                            const tinygltf::Primitive& prim,
+                            const MeshOptimizeConfig& config,
+                            GLTFPrimitiveGeometry& out_geometry);
+
+/// @brief append geometry to vertex & index data and fill buffer views,
+/// layout, bounds, LODs & meshlets of `out_prim`. Skin vertices follow the
+/// vertices in `vertex_buffer`. Indices are narrowed to uint16 if possible
+void AppendPrimitiveGeometry(const GLTFPrimitiveGeometry& geometry,
+                             std::vector<unsigned char>& vertex_buffer,
+                             std::vector<unsigned char>& index_buffer,
+                             Primitive& out_prim);
+
+/**
+ * @brief joint hierarchy, inverse bind matrices & rest pose of a skin
+ *
+ * Non-joint ancestors of root joints are folded into
+ * `Skeleton::m_root_transforms`.
+ */
+Skeleton LoadSkeleton(const tinygltf::Model& model, const tinygltf::Skin& skin);
+
+/**
+ * @brief resample channels of `animation` targeting joints of `skin`
+ *
+ * Step, linear (slerp for rotations) and cubic spline samplers are evaluated
+ * at `sample_rate`, joints without channel keep the rest pose.
+ */
+AnimationClip LoadAnimationClip(const tinygltf::Model& model,
+                                const tinygltf::Animation& animation,
+                                const tinygltf::Skin& skin,
+                                const Skeleton& skeleton,
+                                float sample_rate = AnimationSampleRate);
+
+/// @brief skeletons of all skins with every animation resampled for each
+std::vector<GLTFSkin> LoadSkins(const tinygltf::Model& model);
+
 struct GLTFLoadData {
     GLTFModelResource m_resource;
     std::vector<Mesh> m_meshes;
 };
 
+struct GLTFImageLoadInfo {
+    Path m_filename;
+    Format m_format = Format::R8G8B8A8_UNORM;
+};
+
+/**
+ * @brief CPU side of model loading: file read, json parse and image list
+ *
+ * Touches no GPU or manager state, so it is safe to build on worker threads.
+ */
+struct GLTFParsedModel {
+    Path m_filename;
+    tinygltf::Model m_gltf_model;
+
+    // cooked package bytes, `m_cooked_view` points into one of them
+    MappedFile m_mapped_file;
+    std::vector<char> m_content;
+    CookedModelView m_cooked_view;
+
+    std::vector<GLTFImageLoadInfo> m_images;
+
+    bool IsCooked() const noexcept { return m_cooked_view.IsValid(); }
+};
+
+/// @brief parse `.gltf` or cooked `.nkmodel` content already read into memory
+/// @return nullptr if parse failed
+std::unique_ptr<GLTFParsedModel> ParseGLTFModel(const Path& filename,
+                                                std::vector<char>&& content);
+
+/// @brief read and parse model file, cooked packages are memory mapped
+std::unique_ptr<GLTFParsedModel> ParseGLTFFile(const Path& filename);
+
 class GLTFLoader {
 public:
-    explicit GLTFLoader(const tinygltf::Model& model);
+    explicit GLTFLoader(const tinygltf::Model& model,
+                        const MeshOptimizeConfig& optimize_config = {});
     GLTFLoadData Load(const Path& filename, const Adapter& adapter,
                       GLTFManagerImpl& mgr);
 
+    /// @brief images to load as textures, color textures are sRGB
+    std::vector<GLTFImageLoadInfo> CollectImages(const Path& root_dir) const;
+
+    /// @brief vertex, index & material data exactly as `Load` uploads them,
+    /// without GPU work
+    GLTFCPUData LoadCPUData() const;
+
 private:
     const tinygltf::Model& m_gltf_model;
+    MeshOptimizeConfig m_optimize_config;
 
     GLTFLoadData loadGLTF(const Path& filename, const Adapter& adapter,
                           GLTFManagerImpl& gltf_manager,
@@ -228,41 +401,32 @@ private:
     Mesh createMesh(const tinygltf::Mesh& gltf_mesh, GLTFManagerImpl* mgr,
                     std::vector<unsigned char>& vertex_buffer,
                     std::vector<unsigned char>& indices_buffer,
-                    const std::vector<BufferView>& accessors,
                     std::vector<Material3D>& materials,
                     Material3DImpl& default_material) const;
 
-    Primitive recordPrimInfo(std::vector<unsigned char>& vertex_buffer,
-                             std::vector<unsigned char>& indices_buffer,
-                             const std::vector<BufferView>& buffer_views,
-                             const tinygltf::Primitive& prim,
-                             std::vector<Material3D>& materials,
-                             Material3DImpl& default_material) const;
-
-    void analyzeAccessorUsage(std::set<uint32_t>& out_vertex_accessors,
-                              std::set<uint32_t>& out_index_accessors,
-                              size_t& out_vertex_buffer_size,
-                              size_t& out_index_buffer_size);
+    /// @brief optimized geometry appended to `vertex_buffer` &
+    /// `indices_buffer`, see `BuildPrimitiveGeometry`
+    bool recordPrimGeometry(std::vector<unsigned char>& vertex_buffer,
+                            std::vector<unsigned char>& indices_buffer,
+                            const tinygltf::Primitive& prim,
+                            Primitive& out_prim) const;
+
+    PBRParameters parsePBRParameters(const tinygltf::Material& mtl) const;
+
     void analyzeImageUsage(std::set<uint32_t>& out_color_texture,
                            std::set<uint32_t>& out_normal_texture,
                            std::set<uint32_t>& out_occlusion_texture,
                            std::set<uint32_t>& out_metallic_roughness_texture,
                            std::set<uint32_t>& out_emissive_texture) const;
 
-    std::vector<Texture> loadTextures(const Path& root_dir,
-                                      TextureManager& texture_mgr,
-                                      const std::set<uint32_t>& color_textures);
+    std::vector<Texture> loadTextures(std::span<const GLTFImageLoadInfo> images,
+                                      TextureManager& texture_mgr);
     std::vector<Sampler> loadSamplers(Device& device);
     std::vector<Material3D> loadMaterials(
         const Adapter& adapter, GLTFManagerImpl& gltf_mgr,
         GLTFRenderPass& render_pass, std::vector<PBRParameters>& pbr_parameters,
         std::vector<unsigned char>& data_buffer, std::vector<Texture>& textures,
         std::vector<Sampler>& samplers, CommonResource& common_res);
-    std::vector<BufferView> loadVertexBuffer(
-        std::vector<unsigned char>& out_vertex_buffer,
-        std::vector<unsigned char>& out_index_buffer,
-        const std::set<uint32_t>& vertex_accessor,
-        const std::set<uint32_t>& index_accessor) const;
 };
 
 }  // namespace nickel::graphics
\ No newline at end of file
@@ -1,13 +1,18 @@
 #pragma once
 #include "nickel/common/memory/memory.hpp"
 #include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/internal/cooked_model.hpp"
 #include "nickel/graphics/internal/gltf_model_impl.hpp"
 #include "nickel/graphics/internal/material3d_impl.hpp"
 #include "nickel/graphics/internal/mesh_impl.hpp"
 
+#include <future>
+#include <unordered_set>
+
 namespace nickel::graphics {
 class CommonResource;
 class GLTFRenderPass;
+struct GLTFParsedModel;
 
 class GLTFManagerImpl {
 public:
@@ -15,7 +20,14 @@ public:
     ~GLTFManagerImpl();
 
     bool Load(const Path&, const GLTFLoadConfig& load_config);
+    AsyncHandle<GLTFModel> LoadAsync(const Path&,
+                                     const GLTFLoadConfig& load_config);
     GLTFModel Find(const std::string&);
+    void Update();
+    bool HasPendingLoad() const;
+    const GLTFCPUData* AcquireCPUData(const GLTFModel&);
+    void ReleaseCPUData(const GLTFModel&);
+    GLTFMemoryStats GetMemoryStats() const;
     void GC();
     void Remove(GLTFModelImpl&);
     void Clear();
@@ -35,7 +47,32 @@ public:
 
     std::set<std::string> m_pending_delete;
 
+    // alive resources for memory accounting
+    std::unordered_set<GLTFModelResourceImpl*> m_resources;
+
 private:
+    struct PendingModel {
+        Path m_filename;
+        GLTFLoadConfig m_config;
+        std::future<std::shared_ptr<GLTFParsedModel>> m_parse_future;
+        std::shared_ptr<GLTFParsedModel> m_parsed;
+        std::vector<AsyncHandle<Texture>> m_textures;
+        AsyncHandle<GLTFModel> m_handle;
+    };
+
+    std::vector<PendingModel> m_pending_models;
+
+    bool loadParsed(const GLTFParsedModel&, const GLTFLoadConfig& load_config);
+    bool loadGLTF(const GLTFParsedModel&, const GLTFLoadConfig& load_config);
+    bool loadCooked(const GLTFParsedModel&, const GLTFLoadConfig& load_config);
+    void preorderCookedNode(const CookedModelView& view, uint32_t node_idx,
+                            const GLTFModelResource& resource,
+                            std::span<Mesh> meshes,
+                            GLTFModelImpl& parent_model);
+    static std::string getModelName(const Path& filename);
+    GLTFModelResourceImpl* findResource(const GLTFModelImpl& model);
+    bool reloadCPUData(GLTFModelResourceImpl& resource);
+
     void preorderNode(const tinygltf::Model& gltf_model,
                       const tinygltf::Node& node,
                       const GLTFModelResource& resource, std::span<Mesh> meshes,
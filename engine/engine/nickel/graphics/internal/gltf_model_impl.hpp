@@ -1,5 +1,6 @@
 #pragma once
 #include "nickel/common/memory/refcountable.hpp"
+#include "nickel/graphics/animation.hpp"
 #include "nickel/graphics/gltf.hpp"
 #include "nickel/graphics/mesh.hpp"
 
@@ -10,6 +11,28 @@ struct GLTFModelResourceImpl : public RefCountable {
 
     GLTFCPUData m_cpu_data;
 
+    // source file & policy for re-reading released CPU data
+    Path m_filename;
+    GLTFCPUDataPolicy m_cpu_data_policy = GLTFCPUDataPolicy::Keep;
+    MeshOptimizeConfig m_mesh_optimize;
+    bool m_cpu_data_released = false;
+
+    uint64_t m_gpu_size{};
+    uint64_t m_released_size{};
+
+    /// indexed like glTF skins, clips are resampled per skin
+    std::vector<GLTFSkin> m_skins;
+
+    /**
+     * @brief keep positions & indices of collision meshes, then release CPU
+     * copies if policy asks
+     * @param vertex_data, index_data where views of `meshes` point into
+     */
+    void ApplyCPUDataPolicy(const GLTFLoadConfig& config,
+                            std::span<const Mesh> meshes,
+                            std::span<const unsigned char> vertex_data,
+                            std::span<const unsigned char> index_data);
+
     void DecRefcount() override;
 
 private:
@@ -25,6 +48,11 @@ public:
     std::string m_name;
     Mat44 m_transform = Mat44::Identity();
     Mesh m_mesh;
+
+    /// index into `GLTFModelResourceImpl::m_skins`, -1 if mesh is not
+    /// skinned. Skinned meshes ignore `m_transform`, joints carry it
+    int32_t m_skin = -1;
+
     std::vector<GLTFModel> m_children;
     GLTFModelResource m_resource;
 
@@ -0,0 +1,81 @@
+#pragma once
+#include "nickel/fs/path.hpp"
+#include "nickel/graphics/internal/texture_codec.hpp"
+
+#include <string_view>
+
+namespace nickel::graphics {
+
+/**
+ * @brief KTX2 texture container (https://registry.khronos.org/KTX/specs/2.0)
+ *
+ * Only the subset the engine cooks is supported: single 2D image (no array,
+ * cubemap or 3D), no supercompression. `vkFormat` maps directly to `Format`
+ * since both share Vulkan values.
+ */
+constexpr std::string_view KTX2Extension = ".ktx2";
+
+struct KTX2Header {
+    unsigned char m_identifier[12];
+    uint32_t m_vk_format{};
+    uint32_t m_type_size{};
+    uint32_t m_pixel_width{};
+    uint32_t m_pixel_height{};
+    uint32_t m_pixel_depth{};
+    uint32_t m_layer_count{};
+    uint32_t m_face_count{};
+    uint32_t m_level_count{};
+    uint32_t m_supercompression_scheme{};
+
+    uint32_t m_dfd_byte_offset{};
+    uint32_t m_dfd_byte_length{};
+    uint32_t m_kvd_byte_offset{};
+    uint32_t m_kvd_byte_length{};
+    uint64_t m_sgd_byte_offset{};
+    uint64_t m_sgd_byte_length{};
+};
+
+struct KTX2LevelIndex {
+    uint64_t m_byte_offset{};
+    uint64_t m_byte_length{};
+    uint64_t m_uncompressed_byte_length{};
+};
+
+/// @brief validated read-only view over KTX2 file bytes, no copy
+class KTX2View {
+public:
+    KTX2View() = default;
+
+    /// @param data must outlive the view
+    explicit KTX2View(std::span<const unsigned char> data);
+
+    bool IsValid() const noexcept { return m_valid; }
+
+    Format GetFormat() const;
+    SVector<uint32_t, 2> GetExtent() const;
+    uint32_t GetLevelCount() const;
+    std::span<const unsigned char> GetLevelData(uint32_t level) const;
+
+    /// @brief copy all levels out of the file
+    TextureData ToTextureData() const;
+
+private:
+    std::span<const unsigned char> m_data;
+    KTX2Header m_header;
+    bool m_valid = false;
+
+    KTX2LevelIndex getLevelIndex(uint32_t level) const;
+    bool validate() const;
+};
+
+/// @brief serialize texture into KTX2 file bytes, with basic data format
+/// descriptor
+std::vector<unsigned char> WriteKTX2(const TextureData& texture);
+
+/**
+ * @brief offline cook image into `.ktx2` next to it, see `CookTexture`
+ * @param is_color whether image holds sRGB color
+ */
+bool CookTextureFile(const Path& filename, bool is_color);
+
+}  // namespace nickel::graphics
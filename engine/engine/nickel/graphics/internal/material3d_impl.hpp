@@ -3,6 +3,7 @@
 #include "nickel/graphics/lowlevel/bind_group_layout.hpp"
 #include "nickel/graphics/lowlevel/image.hpp"
 #include "nickel/graphics/lowlevel/sampler.hpp"
+#include "nickel/graphics/internal/bindless.hpp"
 #include "nickel/graphics/material.hpp"
 
 namespace nickel::graphics {
@@ -13,18 +14,58 @@ class Material3DImpl : public RefCountable {
 public:
     BindGroup m_bind_group;
 
+    /// @param bindless register in this table instead of owning a bind
+    /// group, nullptr for legacy path
     Material3DImpl(GLTFManagerImpl*, const Material3D::Descriptor&,
                    Buffer& camera_buffer, Buffer& view_buffer,
-                   BindGroupLayout layout);
+                   BindGroupLayout layout, BindlessTable* bindless);
     Material3DImpl(Material3D&&) = delete;
     Material3DImpl& operator=(Material3DImpl&&) = delete;
     Material3DImpl(const Material3DImpl&) = delete;
     Material3DImpl& operator=(const Material3DImpl&) = delete;
+    ~Material3DImpl();
 
     void DecRefcount() override;
 
+    /// @brief dynamic offsets of `m_bind_group` in slot order: camera, pbr
+    /// parameters & view
+    /// @param frame_offset `CommonResource::GetFrameUniformOffset()`
+    std::array<uint32_t, 3> GetDynamicOffsets(
+        uint32_t frame_offset) const noexcept;
+
+    /// index in bindless material table, only valid in bindless mode
+    uint32_t GetBindlessIndex() const noexcept;
+
+    /// @brief request stream-in of textures covering `screen_size` pixels
+    void RequestTextureLevels(float screen_size);
+
+    /// @brief rebuild `m_bind_group` or bindless record if some streaming
+    /// texture recreated its view
+    void UpdateBindGroup();
+
 private:
+    struct TextureBinding {
+        Texture m_texture;
+        uint32_t m_slot{};
+        uint32_t m_generation{};
+    };
+
     GLTFManagerImpl* m_mgr;
+    BindGroupLayout m_layout;
+    uint32_t m_pbr_offset{};
+    BindGroup::Descriptor m_desc;
+    std::vector<TextureBinding> m_textures;
+
+    BindlessTable* m_bindless{};
+    BindlessMaterial m_bindless_material;
+    uint32_t m_bindless_index{};
+
+    void initBindless(const Material3D::Descriptor&);
+
+    /// @brief image & sampler entry `i` of `BindlessMaterial` from binding
+    /// slots of `m_desc`
+    void acquireBindlessTexture(uint32_t i, uint32_t image_slot,
+                                uint32_t sampler_slot);
 
     void pushTextureInfoBinding(BindGroup::Descriptor& desc,
                                 const Material3D::TextureInfo& info,
@@ -0,0 +1,133 @@
+#pragma once
+#include "nickel/common/math/math.hpp"
+#include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/mesh.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace nickel::graphics {
+
+/// @brief vertex of `VertexLayout::Float`
+struct GLTFVertex {
+    Vec3 m_position;
+    Vec2 m_uv;
+    Vec3 m_normal;
+    Vec4 m_tangent;
+};
+
+/// @brief vertex of `VertexLayout::Quantized`, position keeps full precision
+struct GLTFQuantizedVertex {
+    Vec3 m_position;
+    uint16_t m_uv[2]{};      // half float
+    int16_t m_normal[2]{};   // octahedral, snorm
+    int8_t m_tangent[4]{};   // snorm, w is handedness
+};
+
+/// @brief joints & weights of a skinned vertex, separate stream next to the
+/// vertex layout, see `Primitive::m_skin_buf_view`
+struct GLTFSkinVertex {
+    uint16_t m_joints[4]{};
+    uint16_t m_weights[4]{};  // unorm, sum to 1
+};
+
+static_assert(sizeof(GLTFVertex) == 48 && sizeof(GLTFQuantizedVertex) == 24 &&
+              sizeof(GLTFSkinVertex) == 16);
+
+uint32_t GetVertexStride(VertexLayout);
+
+/// FIFO size used by optimization and analysis, like most desktop GPUs
+constexpr uint32_t VertexCacheSize = 16;
+
+struct VertexCacheStats {
+    uint32_t m_vertices_transformed{};  // vertex shader invocations
+
+    /// average cache miss ratio, invocations per triangle
+    float m_acmr{};
+
+    /// average transform to vertex ratio, 1 is optimal
+    float m_atvr{};
+};
+
+/// @brief simulate FIFO post-transform cache over a triangle list
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices,
+                                    uint32_t vertex_count,
+                                    uint32_t cache_size = VertexCacheSize);
+
+/// @brief merge bitwise equal vertices and remap indices
+void DeduplicateVertices(std::vector<GLTFVertex>& vertices,
+                         std::span<uint32_t> indices);
+
+/// @brief reorder triangles for vertex cache reuse (Tipsify, Sander et al.
+/// 2007), vertex order in each triangle is kept
+void OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertex_count,
+                         uint32_t cache_size = VertexCacheSize);
+
+/**
+ * @brief reorder clusters of cache optimized triangles, outward facing first,
+ * so they occlude the rest of the mesh
+ *
+ * Clusters start where every vertex of a triangle misses the cache, the
+ * order is dropped if it costs more than `threshold` times the vertex shader
+ * invocations.
+ */
+void OptimizeOverdraw(std::span<uint32_t> indices,
+                      std::span<const GLTFVertex> vertices, float threshold,
+                      uint32_t cache_size = VertexCacheSize);
+
+/// @brief reorder vertices by first use in `indices`, unused vertices are
+/// removed
+/// @param out_origin optional, previous index of each vertex
+void OptimizeVertexFetch(std::vector<GLTFVertex>& vertices,
+                         std::span<uint32_t> indices,
+                         std::vector<uint32_t>* out_origin = nullptr);
+
+/// @brief run enabled passes of `config` in order: deduplicate, vertex cache,
+/// overdraw, vertex fetch
+/// @param out_origin optional, input index of each output vertex, so
+/// streams besides `vertices` can follow
+void OptimizeMesh(std::vector<GLTFVertex>& vertices,
+                  std::vector<uint32_t>& indices,
+                  const MeshOptimizeConfig& config,
+                  std::vector<uint32_t>* out_origin = nullptr);
+
+/**
+ * @brief simplify by quadric error edge collapses, vertices are kept so the
+ * result shares the vertex buffer
+ *
+ * Wedges split by uv/normal seams move onto the wedge they share a triangle
+ * with, open borders only collapse along the border.
+ * @param target_error max absolute distance to the original surface
+ * @param out_error optional, reached error in model units
+ * @return indices of the simplified mesh
+ */
+std::vector<uint32_t> SimplifyMesh(std::span<const GLTFVertex> vertices,
+                                   std::span<const uint32_t> indices,
+                                   size_t target_index_count,
+                                   float target_error,
+                                   float* out_error = nullptr);
+
+struct MeshLOD {
+    std::vector<uint32_t> m_indices;
+
+    /// simplification error relative to the bounds diameter
+    float m_error{};
+};
+
+/// @brief simplified levels from fine to coarse, stops early when a level
+/// would exceed `m_lod_max_error` or barely reduces triangles
+std::vector<MeshLOD> GenerateLODs(std::span<const GLTFVertex> vertices,
+                                  std::span<const uint32_t> indices,
+                                  const MeshOptimizeConfig& config);
+
+uint16_t FloatToHalf(float);
+float HalfToFloat(uint16_t);
+
+/// @brief octahedral mapping of unit vector to [-1, 1]^2
+Vec2 EncodeOctahedral(const Vec3& n);
+Vec3 DecodeOctahedral(const Vec2& e);
+
+GLTFQuantizedVertex QuantizeVertex(const GLTFVertex&);
+
+}  // namespace nickel::graphics
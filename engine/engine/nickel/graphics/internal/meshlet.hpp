@@ -0,0 +1,82 @@
+#pragma once
+#include "nickel/common/math/math.hpp"
+#include "nickel/graphics/mesh.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace nickel::graphics {
+
+constexpr uint32_t MeshletMaxVertices = 64;
+constexpr uint32_t MeshletMaxTriangles = 124;
+
+/// primitives with fewer triangles are drawn whole
+constexpr uint32_t MeshletMinTriangles = MeshletMaxTriangles * 4;
+
+/// @brief cluster of consecutive triangles in an index list
+struct Meshlet {
+    uint32_t m_first_index{};
+    uint32_t m_index_count{};
+
+    /// bounding sphere
+    Vec3 m_center;
+    float m_radius{};
+
+    /// all triangles face away from a viewer in the cone
+    /// `dot(center - camera, axis) >= cutoff * length(center - camera) +
+    /// radius`
+    Vec3 m_cone_axis;
+    float m_cone_cutoff = 1.0f;
+};
+
+/**
+ * @brief split triangle list into meshlets of at most `MeshletMaxVertices`
+ * vertices & `MeshletMaxTriangles` triangles
+ *
+ * Triangles are scanned in order, so the vertex cache optimized order keeps
+ * meshlets compact and the index list unchanged.
+ */
+std::vector<Meshlet> BuildMeshlets(std::span<const Vec3> positions,
+                                   std::span<const uint32_t> indices);
+
+/// @brief fill meshlet offsets & packed bounds of `out_prim`
+void PackMeshlets(std::span<const Meshlet>, Primitive& out_prim);
+
+/// @brief primitive space culling input
+struct MeshletCullParams {
+    /// left, right, bottom & top frustum planes, inside is `dot >= 0`.
+    /// Depth is not culled, the projection has no conventional near plane
+    Vec4 m_planes[4];
+    Vec3 m_camera_position;
+
+    /// off for mirroring transforms, which flip the winding
+    bool m_cone_culling = true;
+};
+
+MeshletCullParams MakeMeshletCullParams(const Mat44& view_project,
+                                        const Mat44& model,
+                                        const Vec3& camera_position);
+
+/// @brief indices of meshlets intersecting the frustum and not backfacing
+/// @return visible count
+uint32_t CullMeshlets(const Primitive& prim, const MeshletCullParams& params,
+                      std::vector<uint32_t>& out_visible);
+
+/// @brief reference of `CullMeshlets` without SIMD
+uint32_t CullMeshletsScalar(const Primitive& prim,
+                            const MeshletCullParams& params,
+                            std::vector<uint32_t>& out_visible);
+
+/// @brief index range of consecutive visible meshlets, drawn at once
+struct MeshletDrawRange {
+    uint32_t m_first_index{};
+    uint32_t m_index_count{};
+};
+
+/// @brief merge adjacent visible meshlets into draw ranges
+void CompactMeshletRanges(const Primitive& prim,
+                          std::span<const uint32_t> visible,
+                          std::vector<MeshletDrawRange>& out_ranges);
+
+}  // namespace nickel::graphics
@@ -0,0 +1,87 @@
+#pragma once
+#include "nickel/common/math/smatrix.hpp"
+#include "nickel/graphics/lowlevel/enums.hpp"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace nickel::graphics {
+
+struct ImageRawData;
+
+struct TextureLevel {
+    uint64_t m_offset{};
+    uint64_t m_size{};
+    SVector<uint32_t, 2> m_extent;
+};
+
+/// @brief CPU side texture ready to upload: a full mip chain, level 0 first
+struct TextureData {
+    Format m_format = Format::UNDEFINED;
+    std::vector<TextureLevel> m_levels;
+    std::vector<unsigned char> m_data;
+
+    SVector<uint32_t, 2> GetExtent() const;
+    std::span<const unsigned char> GetLevelData(uint32_t level) const;
+    void AddLevel(SVector<uint32_t, 2> extent,
+                  std::span<const unsigned char> data);
+
+    /// @brief copy of levels from `first_level` to the smallest one
+    TextureData GetLevels(uint32_t first_level) const;
+
+    explicit operator bool() const noexcept { return !m_levels.empty(); }
+};
+
+struct FormatBlockInfo {
+    uint32_t m_block_width = 1;
+    uint32_t m_block_height = 1;
+    uint32_t m_block_size{};  // bytes per block
+
+    bool IsCompressed() const noexcept { return m_block_width > 1; }
+};
+
+/// @return zero block size if format is not a supported texture format
+FormatBlockInfo GetFormatBlockInfo(Format);
+
+/// @brief bytes of one mip level
+uint64_t CalcLevelSize(Format, uint32_t width, uint32_t height);
+
+/// @brief bytes of a mip chain with `level_count` levels
+uint64_t CalcTextureSize(Format, uint32_t width, uint32_t height,
+                         uint32_t level_count);
+
+uint32_t CalcMipLevelCount(uint32_t width, uint32_t height);
+
+bool IsSRGBFormat(Format);
+
+/**
+ * @brief build full RGBA8 mip chain by 2x2 box filter
+ * @param srgb average color channels in linear space
+ */
+TextureData GenerateMipChain(const unsigned char* rgba, uint32_t width,
+                             uint32_t height, bool srgb);
+
+/// @brief 16 RGBA8 texels of a 4x4 block -> 8 bytes BC1 (no alpha)
+void CompressBC1Block(const unsigned char* texels, unsigned char* out);
+/// @brief 16 RGBA8 texels of a 4x4 block -> 16 bytes BC3
+void CompressBC3Block(const unsigned char* texels, unsigned char* out);
+void DecompressBC1Block(const unsigned char* block, unsigned char* out_texels);
+void DecompressBC3Block(const unsigned char* block, unsigned char* out_texels);
+
+/**
+ * @brief block compress every level of an RGBA8 texture
+ * @param format BC1 (RGB) or BC3 format, sRGB-ness should match `texture`
+ */
+TextureData CompressTexture(const TextureData& texture, Format format);
+
+/// @brief decode BC1/BC3 texture into RGBA8, for devices without BC support
+TextureData DecompressTexture(const TextureData& texture);
+
+/**
+ * @brief offline texture cooking: mip chain then block compression, BC3 if
+ * image has alpha else BC1
+ */
+TextureData CookTexture(const ImageRawData& image, bool is_color);
+
+}  // namespace nickel::graphics
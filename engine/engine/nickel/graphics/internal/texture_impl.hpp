@@ -1,17 +1,60 @@
 ﻿#pragma once
+#include "nickel/common/hash.hpp"
 #include "nickel/fs/path.hpp"
+#include "nickel/graphics/internal/texture_codec.hpp"
+#include "nickel/graphics/internal/texture_streamer.hpp"
+#include "nickel/graphics/lowlevel/adapter.hpp"
+#include "nickel/graphics/lowlevel/common.hpp"
 #include "nickel/graphics/lowlevel/device.hpp"
 
 namespace nickel::graphics {
 
 class TextureManagerImpl;
 
+/// image file content & requested format, equal keys give equal textures
+struct TextureContentKey {
+    uint64_t m_hash{};
+    Format m_format = Format::UNDEFINED;
+
+    bool operator==(const TextureContentKey&) const = default;
+};
+
 class TextureImpl: public RefCountable {
 public:
-    TextureImpl(TextureManagerImpl* mgr, Device device, const Path& filename,
-         Format format);
+    /// @brief upload already decoded image, mipmaps are generated on CPU
+    TextureImpl(TextureManagerImpl* mgr, Device device,
+                const ImageRawData& raw_data, Format format);
+    /// @brief upload levels of `data` from `first_level`
+    TextureImpl(TextureManagerImpl* mgr, Device device,
+                const TextureData& data, uint32_t first_level = 0);
+
+    /// @brief extent of level 0, even if it's not resident
     SVector<uint32_t, 2> Extent() const;
 
+    /// @brief level count of the full mip chain
+    uint32_t GetLevelCount() const noexcept { return m_level_count; }
+
+    /// @brief most detailed level on GPU
+    uint32_t GetResidentLevel() const noexcept { return m_resident_level; }
+
+    /// @brief bytes of resident image data on GPU
+    uint64_t GetVRAMSize() const noexcept { return m_vram_size; }
+
+    /// @brief changes whenever `m_view` is recreated by streaming, bind
+    /// groups holding the old view must be rebuilt
+    uint32_t GetGeneration() const noexcept { return m_generation; }
+
+    /**
+     * @brief replace GPU image by `levels`, which start at `first_level` of
+     * the full mip chain
+     */
+    void UploadLevels(Device device, const TextureData& levels,
+                      uint32_t first_level);
+
+    /// @brief request the level worth sampling when texture covers
+    /// `screen_size` pixels this frame, no-op if not streaming
+    void RequestStreamLevel(float screen_size);
+
     TextureImpl(const TextureImpl&) = delete;
     TextureImpl(TextureImpl&&) = delete;
     TextureImpl& operator=(const TextureImpl&) = delete;
@@ -22,8 +65,48 @@ public:
     Image m_image;
     ImageView m_view;
 
+    // streaming only, mip tail is kept on CPU for eviction
+    TextureStreamer::ID m_stream_id = TextureStreamer::InvalidID;
+    TextureData m_mip_tail;
+
+    // keys of this texture in `TextureManagerImpl`, removed when released
+    std::vector<Path> m_filenames;
+    std::optional<TextureContentKey> m_content_key;
+
 private:
     TextureManagerImpl* m_mgr;
+    SVector<uint32_t, 2> m_extent;
+    uint32_t m_level_count{};
+    uint32_t m_resident_level{};
+    uint64_t m_vram_size{};
+    uint32_t m_generation{};
 };
 
-}
+/**
+ * @brief read texture levels for uploading, thread safe
+ *
+ * `.ktx2` files are read directly. For other images a cooked `.ktx2` next to
+ * the file is preferred, otherwise the image is decoded with mipmaps generated
+ * on CPU. Block compressed data the device can't sample is decompressed on
+ * CPU.
+ */
+TextureData LoadTextureData(const Path& filename, Format format,
+                            const Adapter::Features& features);
+
+/// @brief hash content of image file, empty if it can't be read, thread safe
+std::optional<TextureContentKey> ComputeTextureContentKey(const Path& filename,
+                                                          Format format);
+
+}  // namespace nickel::graphics
+
+namespace std {
+template <>
+struct hash<nickel::graphics::TextureContentKey> {
+    size_t operator()(
+        const nickel::graphics::TextureContentKey& key) const noexcept {
+        size_t seed = key.m_hash;
+        nickel::HashCombine(seed, key.m_format);
+        return seed;
+    }
+};
+}  // namespace std
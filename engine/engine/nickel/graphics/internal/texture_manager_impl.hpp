@@ -1,24 +1,77 @@
 ﻿#pragma once
+#include "nickel/common/async_handle.hpp"
 #include "nickel/common/memory/memory.hpp"
 #include "nickel/fs/path.hpp"
 #include "nickel/graphics/internal/texture_impl.hpp"
+#include "nickel/graphics/internal/texture_streamer.hpp"
 #include "nickel/graphics/lowlevel/enums.hpp"
 #include "nickel/graphics/texture.hpp"
 
+#include <future>
+
 namespace nickel::graphics {
 
 class TextureManagerImpl {
 public:
+    explicit TextureManagerImpl(const TextureStreamingConfig& config);
+
     Texture Load(const Path& filename, Format format);
+    AsyncHandle<Texture> LoadAsync(const Path& filename, Format format);
     Texture Find(const Path& filename);
+    void Update();
+    bool HasPendingLoad() const;
+    uint64_t GetVRAMUsage() const;
+    uint64_t GetStreamingUsage() const;
+    uint32_t GetDeduplicatedCount() const;
     void GC();
 
     void RemoveTexture(TextureImpl* texture);
+    void RequestStreamLevel(TextureStreamer::ID id, uint32_t level);
 
     BlockMemoryAllocator<TextureImpl> m_allocator;
 
 private:
+    struct DecodedTexture {
+        std::optional<TextureContentKey> m_key;
+        TextureData m_data;
+    };
+
+    struct PendingTexture {
+        std::future<DecodedTexture> m_data;
+        AsyncHandle<Texture> m_handle;
+        Format m_format;
+    };
+
+    struct StreamingTexture {
+        TextureImpl* m_texture{};
+        Path m_filename;
+        Format m_format;
+    };
+
+    struct PendingStreamIn {
+        TextureStreamer::ID m_id{};
+        uint32_t m_level{};
+        std::future<TextureData> m_data;
+    };
+
+    // files of equal content map to the same texture
     std::unordered_map<Path, TextureImpl*> m_textures;
+    std::unordered_map<TextureContentKey, TextureImpl*> m_content_textures;
+    uint32_t m_deduplicated_count{};
+    std::unordered_map<Path, PendingTexture> m_pending;
+    TextureStreamer m_streamer;
+    std::unordered_map<TextureStreamer::ID, StreamingTexture>
+        m_streaming_textures;
+    std::vector<PendingStreamIn> m_stream_ins;
+
+    TextureImpl* createTexture(const Path& filename, Format format,
+                               const TextureData& data);
+    void registerTexture(const Path& filename,
+                         const std::optional<TextureContentKey>& key,
+                         TextureImpl* texture);
+    Texture findByContent(const Path& filename,
+                          const std::optional<TextureContentKey>& key);
+    void updateStreaming();
 };
 
 }  // namespace nickel::graphics
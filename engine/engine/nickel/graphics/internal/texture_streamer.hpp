@@ -0,0 +1,102 @@
+#pragma once
+#include "nickel/common/math/smatrix.hpp"
+#include "nickel/graphics/lowlevel/enums.hpp"
+#include "nickel/graphics/texture_streaming.hpp"
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace nickel::graphics {
+
+/**
+ * @brief most detailed mip level worth sampling when the texture covers
+ * `screen_size` pixels on screen
+ */
+uint32_t CalcDesiredMipLevel(SVector<uint32_t, 2> extent, float screen_size,
+                             uint32_t level_count);
+
+/**
+ * @brief residency policy of streaming textures, no GPU work
+ *
+ * Every texture keeps its mip tail resident. The renderer requests the level
+ * it wants each frame, `Update()` then grants stream-in of more detailed
+ * levels within the budget and evicts least recently used textures back to
+ * their tail to make room. Bytes of a stream-in are reserved when it is
+ * granted, so resident plus in-flight memory never exceeds the budget.
+ */
+class TextureStreamer {
+public:
+    using ID = uint32_t;
+    static constexpr ID InvalidID = std::numeric_limits<ID>::max();
+
+    using Config = TextureStreamingConfig;
+
+    struct Action {
+        enum class Type {
+            StreamIn,
+            Evict,
+        } m_type;
+
+        ID m_id{};
+
+        /// most detailed resident level after the action
+        uint32_t m_level{};
+    };
+
+    explicit TextureStreamer(const Config& config = {});
+
+    void SetConfig(const Config& config);
+    const Config& GetConfig() const noexcept;
+
+    /// @brief register texture with only its mip tail resident
+    ID Register(Format format, SVector<uint32_t, 2> extent,
+                uint32_t level_count);
+    void Unregister(ID id);
+
+    uint32_t GetTailLevel(ID id) const;
+    uint32_t GetResidentLevel(ID id) const;
+
+    /// @brief record the level wanted in current frame, the most detailed
+    /// request wins
+    void RequestLevel(ID id, uint32_t level);
+
+    /// @brief decide stream-in & eviction for requests since last update
+    std::vector<Action> Update();
+
+    /// @brief stream-in is uploaded, its reserved bytes become resident
+    void FinishStreamIn(ID id);
+
+    /// @brief stream-in failed, release its reservation
+    void CancelStreamIn(ID id);
+
+    /// @brief resident and reserved bytes, never larger than budget unless
+    /// mip tails alone are
+    uint64_t GetUsedSize() const noexcept;
+
+    uint64_t GetLevelsSize(ID id, uint32_t first_level) const;
+
+private:
+    struct Entry {
+        Format m_format;
+        SVector<uint32_t, 2> m_extent;
+        uint32_t m_level_count{};
+        uint32_t m_tail_level{};
+        uint32_t m_resident_level{};
+        uint32_t m_desired_level{};
+        uint32_t m_pending_level{};
+        bool m_pending = false;
+        uint64_t m_last_request_frame{};
+    };
+
+    Config m_config;
+    std::unordered_map<ID, Entry> m_entries;
+    ID m_next_id{};
+    uint64_t m_frame = 1;
+    uint64_t m_used_size{};
+
+    uint64_t levelsSize(const Entry&, uint32_t first_level) const;
+    bool makeRoom(uint64_t size, ID requester, std::vector<Action>& actions);
+};
+
+}  // namespace nickel::graphics
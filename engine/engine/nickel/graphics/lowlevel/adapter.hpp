@@ -13,20 +13,79 @@ class NICKEL_API Adapter {
 public:
     struct Limits {
         uint64_t min_uniform_buffer_offset_alignment{};
+        uint64_t min_storage_buffer_offset_alignment{};
+        uint32_t max_uniform_buffer_range{};
+        uint32_t max_push_constants_size{};
     };
-    
-    Adapter(const video::Window::Impl& window);
+
+    struct Features {
+        bool texture_compression_bc = false;
+        bool texture_compression_etc2 = false;
+        bool texture_compression_astc_ldr = false;
+
+        /// descriptor indexing: partially bound, update-after-bind arrays of
+        /// images & samplers indexed non-uniformly, see
+        /// `BindGroupLayout::Entry::m_bindless`
+        bool bindless = false;
+
+        /// reset queries from CPU, needed by `GPUProfiler`
+        bool host_query_reset = false;
+
+        /// more than one draw per `DrawIndirect`, otherwise the encoder
+        /// issues one indirect draw per command
+        bool multi_draw_indirect = false;
+
+        /// draw count read from a buffer, see `DrawIndirectCount`
+        bool draw_indirect_count = false;
+    };
+
+    /// offscreen targets replacing the swapchain when there is no window
+    struct HeadlessDescriptor {
+        SVector<uint32_t, 2> m_size{1024, 720};
+
+        /// raised to `m_frames_in_flight`, images are reused round-robin
+        uint32_t m_image_count = 2;
+        uint32_t m_frames_in_flight = DefaultFramesInFlight;
+
+        /// enable `VK_LAYER_KHRONOS_validation` in release builds too, e.g.
+        /// in GPU tests. Debug builds and `NICKEL_VULKAN_VALIDATION=1` in
+        /// the environment always enable it
+        bool m_validation = false;
+    };
+
+    explicit Adapter(const video::Window::Impl& window,
+                     uint32_t frames_in_flight = DefaultFramesInFlight);
+
+    /// @brief render without window & surface, e.g. in CI or asset bakers.
+    /// Swapchain images become RGBA8 offscreen images which can be read back
+    /// by `Device::Readback`
+    /// @note only the adapter & device are headless, `nickel::Context` still
+    /// creates a window
+    explicit Adapter(const HeadlessDescriptor&);
     ~Adapter();
 
     Adapter(const Adapter&) = delete;
     Adapter(Adapter&&) = delete;
     Adapter& operator=(const Adapter&) = delete;
     Adapter& operator=(Adapter&&) = delete;
+
+    /// @brief whether a vulkan loader and device exist, e.g. to skip GPU
+    /// tests on machines without any
+    static bool IsSupported();
+
     Device GetDevice() const;
 
     const AdapterImpl& GetImpl() const;
     AdapterImpl& GetImpl();
     const Limits& GetLimits() const;
+    const Features& GetFeatures() const;
+    bool IsHeadless() const;
+
+    /// @brief whether the validation layer was requested and found
+    bool IsValidationEnabled() const;
+
+    /// @brief error messages reported by the validation layer so far
+    uint32_t GetValidationErrorCount() const;
 
 private:
     std::unique_ptr<AdapterImpl> m_impl;
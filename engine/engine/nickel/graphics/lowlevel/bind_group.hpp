@@ -67,6 +67,11 @@ public:
     };
 
     const Descriptor& GetDescriptor() const;
+
+    /// @brief write one element of array at `slot`, the group may be in use
+    /// if the layout entry is `m_bindless`
+    void UpdateArrayElement(uint32_t slot, uint32_t index,
+                            const BindingPoint& binding);
 };
 
 }  // namespace nickel::graphics
\ No newline at end of file
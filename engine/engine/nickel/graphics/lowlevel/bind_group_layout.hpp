@@ -14,6 +14,11 @@ public:
         BindGroupEntryType m_type;
         Flags<ShaderStage> m_shader_stage;
         uint32_t m_array_size = 1;
+
+        /// array elements may stay unwritten and be written while the group
+        /// is in use, needs `Adapter::Features::bindless`. See
+        /// `BindGroup::UpdateArrayElement`
+        bool m_bindless = false;
     };
 
     struct Descriptor final {
@@ -6,6 +6,7 @@
 #include "nickel/graphics/lowlevel/bind_group.hpp"
 #include "nickel/graphics/lowlevel/buffer.hpp"
 #include "nickel/graphics/lowlevel/cmd.hpp"
+#include "nickel/graphics/lowlevel/compute_pipeline.hpp"
 #include "nickel/graphics/lowlevel/framebuffer.hpp"
 #include "nickel/graphics/lowlevel/graphics_pipeline.hpp"
 #include "nickel/graphics/lowlevel/image.hpp"
@@ -32,6 +33,31 @@ struct ClearValue {
         m_value;
 };
 
+/// `VkDrawIndirectCommand`, written by shaders for `DrawIndirect`
+struct DrawIndirectCommand {
+    uint32_t m_vertex_count{};
+    uint32_t m_instance_count{};
+    uint32_t m_first_vertex{};
+    uint32_t m_first_instance{};
+};
+
+/// `VkDrawIndexedIndirectCommand`, written by shaders for
+/// `DrawIndexedIndirect`
+struct DrawIndexedIndirectCommand {
+    uint32_t m_index_count{};
+    uint32_t m_instance_count{};
+    uint32_t m_first_index{};
+    int32_t m_vertex_offset{};
+    uint32_t m_first_instance{};
+};
+
+/// `VkDispatchIndirectCommand`, written by shaders for `DispatchIndirect`
+struct DispatchIndirectCommand {
+    uint32_t m_x{};
+    uint32_t m_y{};
+    uint32_t m_z{};
+};
+
 class NICKEL_API RenderPassEncoder final {
 public:
     RenderPassEncoder(CommandEncoderImpl& cmd, const RenderPass& render_pass,
@@ -43,9 +69,44 @@ public:
     void DrawIndexed(uint32_t index_count, uint32_t instance_count,
                      uint32_t first_index, uint32_t vertex_offset,
                      uint32_t first_instance);
+
+    /**
+     * @brief `draw_count` `DrawIndirectCommand`s read from `buffer`, e.g.
+     * written by a compute pass. Issued one by one if the adapter doesn't
+     * support `multi_draw_indirect`
+     */
+    void DrawIndirect(const Buffer& buffer, uint64_t offset,
+                      uint32_t draw_count,
+                      uint32_t stride = sizeof(DrawIndirectCommand));
+    void DrawIndexedIndirect(
+        const Buffer& buffer, uint64_t offset, uint32_t draw_count,
+        uint32_t stride = sizeof(DrawIndexedIndirectCommand));
+
+    /**
+     * @brief like `DrawIndirect`, but draw count is the `uint32_t` at
+     * `count_offset` of `count_buffer`, clamped to `max_draw_count`.
+     * Needs `Adapter::Features::draw_indirect_count`, skipped otherwise
+     */
+    void DrawIndirectCount(const Buffer& buffer, uint64_t offset,
+                           const Buffer& count_buffer, uint64_t count_offset,
+                           uint32_t max_draw_count,
+                           uint32_t stride = sizeof(DrawIndirectCommand));
+    void DrawIndexedIndirectCount(
+        const Buffer& buffer, uint64_t offset, const Buffer& count_buffer,
+        uint64_t count_offset, uint32_t max_draw_count,
+        uint32_t stride = sizeof(DrawIndexedIndirectCommand));
     void BindVertexBuffer(uint32_t slot, Buffer buffer, uint64_t offset);
     void BindIndexBuffer(Buffer buffer, IndexType, uint64_t offset);
     void SetBindGroup(uint32_t set, BindGroup&);
+
+    /// @param dynamic_offsets one per dynamic buffer binding in slot order,
+    /// instead of `m_offset` of the bindings
+    void SetBindGroup(uint32_t set, const BindGroup&,
+                      std::span<const uint32_t> dynamic_offsets);
+
+    /// @brief make `view` readable by shaders which reach it through a
+    /// bindless array instead of a bound group entry
+    void UseImage(const ImageView&);
     void SetPushConstant(Flags<ShaderStage> stage, const void* value,
                          uint32_t offset, uint32_t size);
     void SetViewport(float x, float y, float width, float height,
@@ -54,6 +115,11 @@ public:
     void BindGraphicsPipeline(const GraphicsPipeline&);
     void NextSubpass(SubpassContent);
 
+    /// @brief GPU timing of draws recorded until `EndProfileScope`, see
+    /// `CommandEncoder::BeginProfileScope`
+    void BeginProfileScope(std::string_view name);
+    void EndProfileScope();
+
     void End();
 
 private:
@@ -64,15 +130,26 @@ private:
         std::vector<ClearValue> m_clear_values;
     };
 
+    static constexpr uint32_t MaxDynamicOffsets = 8;
+
     struct SetBindGroupCmd {
         uint32_t m_set = 0;
         const BindGroup* m_bind_group{};
+        std::array<uint32_t, MaxDynamicOffsets> m_dynamic_offsets{};
+        uint32_t m_dynamic_offset_count{};
+        bool m_has_dynamic_offsets = false;
     };
 
     struct NextSubpassCmd {
         SubpassContent m_content;
     };
 
+    struct BeginProfileScopeCmd {
+        std::string m_name;
+    };
+
+    struct EndProfileScopeCmd {};
+
     struct BindPipelineCmd {
         const GraphicsPipeline* m_pipeline{};
     };
@@ -114,8 +191,6 @@ private:
             Unknown,
             Vertices,
             Indexed,
-
-            // Indirect
         } m_type = Type::Unknown;
 
         uint32_t m_elem_count;
@@ -125,6 +200,19 @@ private:
         uint32_t m_first_instance;
     };
 
+    struct DrawIndirectCmd {
+        bool m_indexed = false;
+        Buffer m_buffer;
+        uint64_t m_offset{};
+
+        // draw count is read from here if it is set
+        Buffer m_count_buffer;
+        uint64_t m_count_offset{};
+
+        uint32_t m_draw_count{};
+        uint32_t m_stride{};
+    };
+
     struct SetViewportCmd {
         float m_x, m_y, m_w, m_h, m_min_depth, m_max_depth;
     };
@@ -137,18 +225,91 @@ private:
     using Cmd =
         std::variant<BindGraphicsPipelineCmd, BindIndexBufferCmd,
                      BindVertexBufferCmd, SetPushConstantCmd, SetBindGroupCmd,
-                     DrawCmd, SetViewportCmd, SetScissorCmd, NextSubpassCmd>;
+                     DrawCmd, DrawIndirectCmd, SetViewportCmd, SetScissorCmd,
+                     NextSubpassCmd, BeginProfileScopeCmd, EndProfileScopeCmd>;
     struct ApplyRenderCmd;
 
     CommandEncoderImpl& m_cmd;
     std::vector<Cmd> m_record_cmds;
     RenderPassInfo m_render_pass_info;
 
-    void transferImageLayoutInBindGroup(BindGroup&) const;
+    void transferImageLayoutInBindGroup(const BindGroup&) const;
     void transferImageLayout2ShaderReadOnlyOptimal(ImageImpl& impl) const;
     void beginRenderPass();
 };
 
+/**
+ * @brief records dispatches, applied to the command buffer by `End`
+ *
+ * Like render passes, bound storage images are moved to `General` and
+ * sampled ones to `ShaderReadOnlyOptimal`. Each dispatch waits for the
+ * writes of earlier commands, and `End` makes shader writes visible to
+ * indirect draws, vertex input, shaders, copies & host reads.
+ */
+class NICKEL_API ComputePassEncoder final {
+public:
+    explicit ComputePassEncoder(CommandEncoderImpl& cmd);
+
+    void BindComputePipeline(const ComputePipeline&);
+    void SetBindGroup(uint32_t set, const BindGroup&);
+
+    /// @param dynamic_offsets one per dynamic buffer binding in slot order
+    void SetBindGroup(uint32_t set, const BindGroup&,
+                      std::span<const uint32_t> dynamic_offsets);
+    void SetPushConstant(const void* value, uint32_t offset, uint32_t size);
+    void Dispatch(uint32_t x, uint32_t y, uint32_t z);
+
+    /// @brief workgroup count is the `DispatchIndirectCommand` at `offset`
+    void DispatchIndirect(const Buffer& buffer, uint64_t offset);
+
+    /// @brief see `CommandEncoder::BeginProfileScope`
+    void BeginProfileScope(std::string_view name);
+    void EndProfileScope();
+
+    void End();
+
+private:
+    struct BindPipelineCmd {
+        ComputePipeline m_pipeline;
+    };
+
+    struct SetBindGroupCmd {
+        uint32_t m_set = 0;
+        const BindGroup* m_bind_group{};
+        std::vector<uint32_t> m_dynamic_offsets;
+    };
+
+    struct SetPushConstantCmd {
+        char m_data[128]{};
+        uint32_t m_offset{};
+        uint32_t m_size{};
+    };
+
+    struct DispatchCmd {
+        uint32_t m_x{}, m_y{}, m_z{};
+    };
+
+    struct DispatchIndirectCmd {
+        Buffer m_buffer;
+        uint64_t m_offset{};
+    };
+
+    struct BeginProfileScopeCmd {
+        std::string m_name;
+    };
+
+    struct EndProfileScopeCmd {};
+
+    using Cmd = std::variant<BindPipelineCmd, SetBindGroupCmd,
+                             SetPushConstantCmd, DispatchCmd,
+                             DispatchIndirectCmd, BeginProfileScopeCmd,
+                             EndProfileScopeCmd>;
+    struct ApplyComputeCmd;
+
+    CommandEncoderImpl& m_cmd;
+    std::vector<Cmd> m_record_cmds;
+};
+
 class NICKEL_API CopyEncoder final {
 public:
     friend class BufferImpl;
@@ -177,6 +338,10 @@ public:
     void CopyBufferToTexture(const Buffer& src, Image& dst,
                              const BufferImageCopy&);
 
+    /// @brief copy image into buffer, image is left in `TransferSrcOptimal`
+    void CopyTextureToBuffer(const Image& src, const Buffer& dst,
+                             const BufferImageCopy&);
+
     void End();
 
 private:
@@ -194,15 +359,33 @@ private:
         BufferImageCopy m_copy;
     };
 
+    struct ImageCopyBuf {
+        Image m_src;
+        Buffer m_dst;
+        BufferImageCopy m_copy;
+    };
+
     CommandEncoderImpl& m_cmd;
     std::vector<BufCopyBuf> m_buffer_copies;
     std::vector<BufCopyImage> m_image_copies;
+    std::vector<ImageCopyBuf> m_buffer_readbacks;
 
     void copyBufferToBuffer(const BufferImpl& src, uint64_t srcOffset,
                             const BufferImpl& dst, uint64_t dstOffset,
                             uint64_t size);
 };
 
+/// layout transition of every subresource of `m_view`
+struct ImageBarrier {
+    ImageView m_view;
+    ImageLayout m_old_layout = ImageLayout::Undefined;
+    ImageLayout m_new_layout = ImageLayout::Undefined;
+    Flags<PipelineStage> m_src_stage = PipelineStage::TopOfPipe;
+    Flags<Access> m_src_access = Access::None;
+    Flags<PipelineStage> m_dst_stage = PipelineStage::BottomOfPipe;
+    Flags<Access> m_dst_access = Access::None;
+};
+
 class CommandEncoderImpl;
 
 class NICKEL_API CommandEncoder {
@@ -210,10 +393,23 @@ public:
     explicit CommandEncoder(CommandEncoderImpl& cmd);
 
     CopyEncoder BeginCopy();
+    ComputePassEncoder BeginComputePass();
     RenderPassEncoder BeginRenderPass(const RenderPass&, const Framebuffer& fbo,
                                       const Rect& render_area,
                                       std::span<ClearValue> clear_values);
 
+    /// @brief record image barriers, only valid outside of passes
+    void PipelineBarrier(std::span<const ImageBarrier>);
+
+    /**
+     * @brief time GPU work recorded until `EndProfileScope`, results appear
+     * in `Device::GetGPUProfiler()` a few frames later
+     *
+     * Scopes nest and must end in the command buffer they began in.
+     */
+    void BeginProfileScope(std::string_view name);
+    void EndProfileScope();
+
     Command Finish();
 
     CommandEncoderImpl& GetImpl();
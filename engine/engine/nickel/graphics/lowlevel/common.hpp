@@ -9,6 +9,8 @@ struct ImageRawData {
     const SVector<uint32_t, 2> GetExtent() const;
 
     explicit ImageRawData(const Path& filename);
+    /// @brief decode from encoded file content (png, jpg...)
+    ImageRawData(const void* content, size_t size);
     ImageRawData(ImageRawData&&) noexcept;
     ImageRawData& operator=(ImageRawData&&) noexcept;
     ImageRawData(const ImageRawData&) = delete;
@@ -17,8 +19,10 @@ struct ImageRawData {
     operator bool() const noexcept;
 
 private:
-    void* m_data;
+    void* m_data = nullptr;
     SVector<uint32_t, 2> m_extent;
+
+    void decode(const void* content, size_t size);
 };
 
 }
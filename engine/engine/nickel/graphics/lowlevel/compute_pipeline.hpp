@@ -0,0 +1,28 @@
+#pragma once
+#include "nickel/common/dllexport.hpp"
+#include "nickel/graphics/lowlevel/pipeline_layout.hpp"
+#include "nickel/graphics/lowlevel/shader_module.hpp"
+
+#include <string>
+
+namespace nickel::graphics {
+
+class ComputePipelineImpl;
+
+class NICKEL_API ComputePipeline : public ImplWrapper<ComputePipelineImpl> {
+public:
+    struct Descriptor {
+        ShaderModule m_module;
+        std::string m_entry_name = "main";
+        PipelineLayout m_layout;
+    };
+
+    using ImplWrapper::ImplWrapper;
+};
+
+/// @brief workgroups covering `count` invocations of `local_size` each
+inline uint32_t CalcWorkgroupCount(uint32_t count, uint32_t local_size) {
+    return local_size == 0 ? 0 : (count + local_size - 1) / local_size;
+}
+
+}  // namespace nickel::graphics
@@ -6,14 +6,21 @@
 #include "nickel/graphics/lowlevel/buffer.hpp"
 #include "nickel/graphics/lowlevel/cmd.hpp"
 #include "nickel/graphics/lowlevel/cmd_encoder.hpp"
+#include "nickel/graphics/lowlevel/compute_pipeline.hpp"
 #include "nickel/graphics/lowlevel/fence.hpp"
 #include "nickel/graphics/lowlevel/framebuffer.hpp"
+#include "nickel/graphics/lowlevel/gpu_profiler.hpp"
 #include "nickel/graphics/lowlevel/graphics_pipeline.hpp"
 #include "nickel/graphics/lowlevel/image.hpp"
 #include "nickel/graphics/lowlevel/pipeline_layout.hpp"
+#include "nickel/graphics/lowlevel/readback.hpp"
 #include "nickel/graphics/lowlevel/sampler.hpp"
 #include "nickel/graphics/lowlevel/semaphore.hpp"
 
+namespace nickel {
+class ThreadPool;
+}
+
 namespace nickel::graphics {
 
 class DeviceImpl;
@@ -24,6 +31,17 @@ struct SurfaceFormatKHR {
     ImageColorSpace colorSpace;
 };
 
+struct PipelineCacheStats {
+    /// pipelines the driver took from the pipeline cache
+    uint32_t m_hits{};
+
+    /// pipelines compiled from SPIR-V
+    uint32_t m_misses{};
+};
+
+/// frames CPU may record ahead of GPU, independent of swapchain image count
+constexpr uint32_t DefaultFramesInFlight = 2;
+
 struct SwapchainImageInfo {
     SVector<uint32_t, 2> m_extent;
     uint32_t m_image_count;
@@ -45,6 +63,30 @@ public:
     Framebuffer CreateFramebuffer(const Framebuffer::Descriptor&);
     RenderPass CreateRenderPass(const RenderPass::Descriptor&);
     GraphicsPipeline CreateGraphicPipeline(const GraphicsPipeline::Descriptor&);
+    ComputePipeline CreateComputePipeline(const ComputePipeline::Descriptor&);
+
+    /**
+     * @brief compile pipelines into the pipeline cache ahead of first use,
+     * so later `CreateGraphicPipeline` of equal descriptors is a cache hit
+     * @param pool compile on its workers too, nullptr for calling thread only
+     */
+    void WarmupPipelines(std::span<const GraphicsPipeline::Descriptor>,
+                         ThreadPool* pool = nullptr);
+
+    /// @brief replace pipeline cache with data of `GetPipelineCacheData`
+    /// @return false if data is corrupted or of another GPU/driver
+    bool LoadPipelineCache(std::span<const char> data);
+    std::vector<char> GetPipelineCacheData() const;
+
+    /// @brief cache hits of pipeline creation, all misses if driver can't
+    /// report
+    PipelineCacheStats GetPipelineCacheStats() const;
+    /**
+     * @brief equal descriptors return the same sampler. Thread safe, the
+     * last reference may be dropped on any thread: the sampler leaves the
+     * dedupe map at once and its `VkSampler` is destroyed after the frames
+     * in flight finished, a later call creates a new one
+     */
     Sampler CreateSampler(const Sampler::Descriptor&);
     ShaderModule CreateShaderModule(const uint32_t* data, size_t size);
     CommandEncoder CreateCommandEncoder();
@@ -52,6 +94,14 @@ public:
     Fence CreateFence(bool signaled);
     const SwapchainImageInfo& GetSwapchainImageInfo() const;
     std::vector<ImageView> GetSwapchainImageViews() const;
+
+    /// @brief per-frame resources (fences, command pools, uniforms) are
+    /// indexed by frame in flight, swapchain images are only render targets
+    uint32_t GetFramesInFlight() const;
+
+    /// frame in flight being recorded, advanced by `Present`
+    uint32_t GetCurrentFrameIndex() const;
+
     uint32_t WaitAndAcquireSwapchainImageIndex(Semaphore sem,
                                                std::span<Fence> fences);
 
@@ -60,6 +110,16 @@ public:
 
     void WaitIdle();
 
+    /**
+     * @brief copy a color image to CPU memory, waits until GPU is idle.
+     * Meant for tests & tools, e.g. `GetSwapchainImageViews()[i].GetImage()`
+     * after the frame of a headless device was submitted
+     * @return empty image if the format isn't 8-bit RGBA/BGRA
+     */
+    ReadbackImage Readback(const Image&);
+
+    GPUProfiler GetGPUProfiler() const;
+
     void Submit(Command& cmd, std::span<Semaphore> wait_sems,
                 std::span<Semaphore> signal_sems, Fence fence);
 
@@ -0,0 +1,109 @@
+#pragma once
+#include "nickel/common/dllexport.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace nickel::graphics {
+
+class GPUProfilerImpl;
+
+struct PipelineStatistics {
+    uint64_t m_input_assembly_primitives{};
+    uint64_t m_vertex_invocations{};
+    uint64_t m_clipping_primitives{};
+    uint64_t m_fragment_invocations{};
+};
+
+struct GPUScopeResult {
+    std::string m_name;
+
+    /// nesting level, 0 for outermost scopes
+    uint32_t m_depth{};
+    double m_time_ms{};
+
+    /// only for outermost statistics scope, queries of one type can't nest
+    std::optional<PipelineStatistics> m_statistics;
+};
+
+struct GPUFrameProfile {
+    /// frame the scopes were recorded in, results lag frames-in-flight behind
+    uint64_t m_frame{};
+    std::vector<GPUScopeResult> m_scopes;
+
+    /// sum of outermost scopes
+    double GetTotalTime() const;
+
+    /// first scope with this name, nullptr if it didn't run
+    const GPUScopeResult* Find(std::string_view name) const;
+};
+
+/// @brief milliseconds between two raw timestamps
+/// @param valid_bits counter width, narrower counters wrap around
+double TimestampsToMilliseconds(uint64_t begin, uint64_t end, float period_ns,
+                                uint32_t valid_bits);
+
+/// per scope time series of the last frames, for plotting
+class NICKEL_API GPUProfileHistory {
+public:
+    explicit GPUProfileHistory(uint32_t capacity = 240);
+
+    void Push(const GPUFrameProfile&);
+
+    /// @brief times of outermost scope `name`, oldest first. 0 for frames
+    /// it didn't run
+    std::span<const float> GetTimes(std::string_view name) const;
+
+    /// total times of all outermost scopes, oldest first
+    std::span<const float> GetFrameTimes() const;
+
+    /// outermost scope names in order of first appearance
+    std::span<const std::string> GetScopeNames() const;
+
+private:
+    uint32_t m_capacity{};
+    std::vector<float> m_frame_times;
+    std::vector<std::string> m_names;
+    std::vector<std::vector<float>> m_times;
+    std::unordered_map<std::string, size_t> m_name_indices;
+
+    static void push(std::vector<float>&, float value, uint32_t capacity);
+};
+
+/**
+ * @brief query pool based GPU timing of named scopes, see
+ * `CommandEncoder::BeginProfileScope`
+ *
+ * Results are read when a frame slot is reused, so they never stall the CPU.
+ * Without timestamp support scopes are no-ops and profiles stay empty.
+ */
+class NICKEL_API GPUProfiler {
+public:
+    explicit GPUProfiler(GPUProfilerImpl*);
+
+    bool IsSupported() const;
+    bool IsPipelineStatisticsSupported() const;
+
+    void Enable(bool);
+    bool IsEnabled() const;
+
+    /// @brief also count primitives & shader invocations, off by default
+    void EnablePipelineStatistics(bool);
+    bool IsPipelineStatisticsEnabled() const;
+
+    /// latest frame whose results are available
+    const GPUFrameProfile& GetLastProfile() const;
+    const GPUProfileHistory& GetHistory() const;
+
+    GPUProfilerImpl& GetImpl();
+
+private:
+    GPUProfilerImpl* m_impl{};
+};
+
+}  // namespace nickel::graphics
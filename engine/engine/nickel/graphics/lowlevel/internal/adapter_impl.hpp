@@ -11,7 +11,8 @@ class DeviceImpl;
 
 class AdapterImpl {
 public:
-    AdapterImpl(const video::Window::Impl& window);
+    AdapterImpl(const video::Window::Impl& window, uint32_t frames_in_flight);
+    explicit AdapterImpl(const Adapter::HeadlessDescriptor&);
     AdapterImpl(const AdapterImpl&) = delete;
     AdapterImpl(AdapterImpl&&) = delete;
     AdapterImpl& operator=(const AdapterImpl&) = delete;
@@ -21,21 +22,33 @@ public:
     Device GetDevice() const;
 
     const Adapter::Limits& GetLimits() const { return m_limits; }
+    const Adapter::Features& GetFeatures() const { return m_features; }
+    bool IsHeadless() const { return m_headless.has_value(); }
 
     VkInstance m_instance = VK_NULL_HANDLE;
     VkPhysicalDevice m_phy_device = VK_NULL_HANDLE;
     VkSurfaceKHR m_surface = VK_NULL_HANDLE;
     DeviceImpl* m_device{};
     Adapter::Limits m_limits;
+    Adapter::Features m_features;
     VkDebugUtilsMessengerEXT m_debug_utils_messenger = VK_NULL_HANDLE;
-    
+    std::optional<Adapter::HeadlessDescriptor> m_headless;
+    uint32_t m_frames_in_flight = DefaultFramesInFlight;
+    bool m_validation_enabled = false;
+
+    // counted in the debug callback, which may run on any thread
+    std::atomic<uint32_t> m_validation_errors{};
+
     void CreateSurface(const video::Window::Impl& impl);
 
 private:
+    void initVulkan();
+    bool shouldEnableValidation() const;
     void createInstance();
     void pickupPhysicalDevice();
     void createDevice(const SVector<uint32_t, 2>& window_size);
     void queryLimits();
+    void queryFeatures();
 };
 
 }  // namespace nickel::graphics
\ No newline at end of file
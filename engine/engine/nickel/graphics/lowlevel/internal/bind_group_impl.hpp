@@ -44,6 +44,8 @@ public:
     BindGroupImpl& operator=(BindGroupImpl&&) = delete;
 
     const BindGroup::Descriptor& GetDescriptor() const;
+    void UpdateArrayElement(uint32_t slot, uint32_t index,
+                            const BindGroup::BindingPoint&);
     void DecRefcount() override;
 
     BindGroupLayout m_layout{};
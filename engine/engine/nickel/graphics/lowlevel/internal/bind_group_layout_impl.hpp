@@ -26,6 +26,9 @@ public:
 
     BindGroup RequireBindGroup(const BindGroup::Descriptor& desc);
 
+    /// @brief whether some entry is `m_bindless`
+    static bool IsBindless(const BindGroupLayout::Descriptor&);
+
     void DecRefcount() override;
     void GC();
     void RecycleBindGroup(const BindGroupImpl&);
@@ -37,6 +40,9 @@ private:
     DeviceImpl& m_device;
     std::vector<uint32_t> m_unused_descriptor_set;
 
+    // own pool of bindless layouts, null otherwise
+    VkDescriptorPool m_bindless_pool = VK_NULL_HANDLE;
+
     VkDescriptorSetLayoutBinding getBinding(uint32_t slot,
                                             const BindGroupLayout::Entry&);
 
@@ -44,6 +50,9 @@ private:
                                        const BindGroupLayout::Descriptor&);
     void createSets(DeviceImpl&, VkDescriptorPool,
                     uint32_t descriptor_set_count);
+    VkDescriptorPool createBindlessPool(DeviceImpl&,
+                                        const BindGroupLayout::Descriptor&,
+                                        uint32_t descriptor_set_count);
 };
 
 }  // namespace nickel::graphics
\ No newline at end of file
@@ -12,6 +12,7 @@ public:
         Unknown = 0,
         Render = 0x01,
         Transfer = 0x02,
+        Compute = 0x04,
     };
 
     explicit CommandEncoderImpl(DeviceImpl& device, CommandPoolImpl& pool,
@@ -32,6 +33,7 @@ public:
     void ApplyLayoutTransitions();
 
     void PendingDelete();
+    DeviceImpl& GetDevice() const;
 
 private:
     DeviceImpl& m_device;
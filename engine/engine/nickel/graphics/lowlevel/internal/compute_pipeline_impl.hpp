@@ -0,0 +1,29 @@
+#pragma once
+#include "nickel/common/memory/refcountable.hpp"
+#include "nickel/graphics/lowlevel/compute_pipeline.hpp"
+#include "nickel/graphics/lowlevel/pipeline_layout.hpp"
+
+namespace nickel::graphics {
+
+class DeviceImpl;
+
+class ComputePipelineImpl : public RefCountable {
+public:
+    ComputePipelineImpl(DeviceImpl&, const ComputePipeline::Descriptor&);
+    ComputePipelineImpl(const ComputePipelineImpl&) = delete;
+    ComputePipelineImpl(ComputePipelineImpl&&) = delete;
+    ComputePipelineImpl& operator=(const ComputePipelineImpl&) = delete;
+    ComputePipelineImpl& operator=(ComputePipelineImpl&&) = delete;
+
+    ~ComputePipelineImpl();
+
+    void DecRefcount() override;
+
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    PipelineLayout m_layout;
+
+private:
+    DeviceImpl& m_device;
+};
+
+}  // namespace nickel::graphics
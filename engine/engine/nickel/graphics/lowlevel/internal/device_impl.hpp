@@ -7,11 +7,14 @@
 #include "nickel/graphics/lowlevel/internal/bind_group_layout_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/buffer_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/cmd_pool_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/compute_pipeline_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/fence_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/framebuffer_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/gpu_profiler_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/graphics_pipeline_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/image_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/image_view_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/pipeline_cache.hpp"
 #include "nickel/graphics/lowlevel/internal/pipeline_layout_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/render_pass_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/sampler_impl.hpp"
@@ -21,9 +24,13 @@
 #include "nickel/graphics/lowlevel/semaphore.hpp"
 #include "nickel/internal/pch.hpp"
 
+#include <functional>
+#include <mutex>
+
 namespace nickel::graphics {
 
 constexpr uint32_t MaxDescriptorSetPerTypePerFrame = 512;
+constexpr uint32_t BindlessDescriptorSetCount = 1;
 
 class DeviceImpl {
 public:
@@ -81,6 +88,11 @@ public:
     std::vector<ImageView> m_swapchain_image_views;
     QueueFamilyIndices m_queue_indices;
     std::unique_ptr<BindGroupPool> m_bind_group_pool;
+    std::unique_ptr<GPUProfilerImpl> m_gpu_profiler;
+
+    // shared by all pipeline creation, vulkan synchronizes it internally
+    VkPipelineCache m_pipeline_cache = VK_NULL_HANDLE;
+    bool m_creation_feedback_supported = false;
 
     Buffer CreateBuffer(const Buffer::Descriptor&);
     Image CreateImage(const Image::Descriptor&);
@@ -90,6 +102,13 @@ public:
     Framebuffer CreateFramebuffer(const Framebuffer::Descriptor&);
     RenderPass CreateRenderPass(const RenderPass::Descriptor&);
     GraphicsPipeline CreateGraphicPipeline(const GraphicsPipeline::Descriptor&);
+    ComputePipeline CreateComputePipeline(const ComputePipeline::Descriptor&);
+    void WarmupPipelines(std::span<const GraphicsPipeline::Descriptor>,
+                         ThreadPool*);
+    bool LoadPipelineCache(std::span<const char> data);
+    std::vector<char> GetPipelineCacheData() const;
+    PipelineCacheStats GetPipelineCacheStats() const;
+    void RecordPipelineCreation(const VkPipelineCreationFeedback&);
     Sampler CreateSampler(const Sampler::Descriptor&);
     ShaderModule CreateShaderModule(const uint32_t* data, size_t size);
     Semaphore CreateSemaphore();
@@ -97,6 +116,9 @@ public:
     CommandEncoder CreateCommandEncoder();
     uint32_t WaitAndAcquireSwapchainImageIndex(Semaphore signal_sem, std::span<Fence>);
     std::vector<ImageView> GetSwapchainImageViews() const;
+    uint32_t GetFramesInFlight() const;
+    uint32_t GetCurrentFrameIndex() const;
+    ReadbackImage Readback(const Image&);
 
     const AdapterImpl& GetAdapter() const;
 
@@ -106,6 +128,23 @@ public:
 
     void EndFrame();
 
+    /**
+     * @brief run `release` once GPU finished every frame submitted so far
+     *
+     * Handles dropping to refcount 0 come here instead of being destroyed,
+     * the list of a frame in flight is flushed after waiting its fence in
+     * `WaitAndAcquireSwapchainImageIndex`. Thread safe.
+     */
+    void DeferRelease(std::function<void()> release);
+
+    template <typename T>
+    void DeferRelease(BlockMemoryAllocator<T>& allocator, T* elem) {
+        DeferRelease([&allocator, elem] { allocator.MarkAsGarbage(elem); });
+    }
+
+    /// @brief release every deferred handle now, only when GPU is idle
+    void ReleaseAllGarbage();
+
     void Present(std::span<Semaphore> semaphores);
 
     void RecreateSwapchain(VkPhysicalDevice,
@@ -118,8 +157,15 @@ public:
     BlockMemoryAllocator<BindGroupLayoutImpl> m_bind_group_layout_allocator;
     BlockMemoryAllocator<FramebufferImpl> m_framebuffer_allocator;
     BlockMemoryAllocator<GraphicsPipelineImpl> m_graphics_pipeline_allocator;
+    BlockMemoryAllocator<ComputePipelineImpl> m_compute_pipeline_allocator;
     BlockMemoryAllocator<RenderPassImpl> m_render_pass_allocator;
     BlockMemoryAllocator<SamplerImpl> m_sampler_allocator;
+
+    // samplers are immutable, equal descriptors share one. Samplers may be
+    // created and dropped from any thread, `m_sampler_mutex` guards the map,
+    // `m_sampler_allocator` and sampler refcounts
+    std::unordered_map<Sampler::Descriptor, SamplerImpl*> m_samplers;
+    std::mutex m_sampler_mutex;
     BlockMemoryAllocator<ShaderModuleImpl> m_shader_module_allocator;
     BlockMemoryAllocator<PipelineLayoutImpl> m_pipeline_layout_allocator;
     BlockMemoryAllocator<SemaphoreImpl> m_semaphore_allocator;
@@ -129,9 +175,22 @@ private:
     SwapchainImageInfo m_image_info;
     const AdapterImpl& m_adapter;
     uint32_t m_cur_swapchain_image_index = 0;
+    uint32_t m_frames_in_flight{};
     uint32_t m_cur_frame = 0;
+
+    // one per frame in flight
     std::vector<CommandPoolImpl*> m_cmd_pools;
 
+    // deferred releases indexed by the frame in flight recording when they
+    // were dropped, frame index moves on at acquire instead of present so
+    // releases after present still wait the frame they may be used in
+    std::vector<std::vector<std::function<void()>>> m_garbage;
+    uint32_t m_garbage_frame = 0;
+    std::mutex m_garbage_mutex;
+    PipelineCacheDeviceInfo m_pipeline_cache_device;
+    std::atomic<uint32_t> m_pipeline_cache_hits{};
+    std::atomic<uint32_t> m_pipeline_cache_misses{};
+
     QueueFamilyIndices chooseQueue(VkPhysicalDevice phyDevice,
                                    VkSurfaceKHR surface);
 
@@ -142,9 +201,15 @@ private:
     VkPresentModeKHR queryPresentMode(VkPhysicalDevice, VkSurfaceKHR);
     void createCmdPools();
     void createBindGroupPool();
+    VkPipelineCache createPipelineCache(std::span<const char> data);
 
     void getAndCreateSwapchainImageViews();
+    void createOffscreenImages();
+    void signalSemaphore(Semaphore);
     void cleanUpOneFrame();
+
+    /// @return whether anything was released
+    bool releaseGarbage(uint32_t frame);
 };
 
 
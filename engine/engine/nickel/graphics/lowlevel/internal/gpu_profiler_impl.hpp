@@ -0,0 +1,69 @@
+#pragma once
+#include "nickel/graphics/lowlevel/gpu_profiler.hpp"
+#include "nickel/internal/pch.hpp"
+
+namespace nickel::graphics {
+
+class DeviceImpl;
+
+class GPUProfilerImpl {
+public:
+    static constexpr uint32_t MaxScopesPerFrame = 128;
+
+    /// @param host_query_reset pools are reset from CPU, profiler is
+    /// unsupported without it
+    GPUProfilerImpl(DeviceImpl&, VkPhysicalDevice, uint32_t queue_family,
+                    uint32_t frame_count, bool host_query_reset);
+    GPUProfilerImpl(const GPUProfilerImpl&) = delete;
+    GPUProfilerImpl(GPUProfilerImpl&&) = delete;
+    GPUProfilerImpl& operator=(const GPUProfilerImpl&) = delete;
+    GPUProfilerImpl& operator=(GPUProfilerImpl&&) = delete;
+    ~GPUProfilerImpl();
+
+    /// @brief collect results of the frame which last used `slot`, then
+    /// reuse its queries. Call after waiting the slot's fence
+    void BeginFrame(uint32_t slot);
+
+    void BeginScope(VkCommandBuffer, std::string_view name);
+    void EndScope(VkCommandBuffer);
+
+    bool m_supported = false;
+    bool m_statistics_supported = false;
+    bool m_enabled = true;
+    bool m_statistics_enabled = false;
+    GPUFrameProfile m_last_profile;
+    GPUProfileHistory m_history;
+
+private:
+    struct Scope {
+        std::string m_name;
+        uint32_t m_depth{};
+        uint32_t m_timestamp_query{};
+        std::optional<uint32_t> m_statistics_query;
+    };
+
+    struct Frame {
+        VkQueryPool m_timestamps = VK_NULL_HANDLE;
+        VkQueryPool m_statistics = VK_NULL_HANDLE;
+        std::vector<Scope> m_scopes;
+        uint32_t m_statistics_count{};
+        uint64_t m_frame{};
+        bool m_overflowed = false;
+    };
+
+    DeviceImpl& m_device;
+    std::vector<Frame> m_frames;
+    uint32_t m_cur_slot{};
+    uint64_t m_frame_number{};
+    float m_timestamp_period{};
+    uint32_t m_timestamp_valid_bits{};
+
+    // nullopt for scopes begun while disabled or out of queries
+    std::vector<std::optional<uint32_t>> m_open_scopes;
+    bool m_statistics_active = false;
+
+    void collect(Frame&);
+    void reset(Frame&);
+};
+
+}  // namespace nickel::graphics
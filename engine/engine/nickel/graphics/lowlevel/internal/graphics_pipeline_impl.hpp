@@ -27,5 +27,10 @@ private:
     RenderPass m_render_pass;
 };
 
+/// @brief create pipeline through `DeviceImpl::m_pipeline_cache`, safe to
+/// call from worker threads
+VkPipeline CreateVkGraphicsPipeline(DeviceImpl&,
+                                    const GraphicsPipeline::Descriptor&);
+
 
 }
\ No newline at end of file
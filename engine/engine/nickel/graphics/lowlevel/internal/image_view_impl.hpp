@@ -12,7 +12,7 @@ public:
     ImageViewImpl(DeviceImpl&, const Image& image, const ImageView::Descriptor&);
 
     // only for swapchain image m_view hack
-    ImageViewImpl(DeviceImpl&, VkImageView);
+    ImageViewImpl(DeviceImpl&, VkImage, VkImageView);
     ImageViewImpl(const ImageViewImpl&) = delete;
     ImageViewImpl(ImageViewImpl&&) = delete;
     ImageViewImpl& operator=(const ImageViewImpl&) = delete;
@@ -27,6 +27,10 @@ public:
     VkImageView m_view = VK_NULL_HANDLE;
     Image m_image;
 
+    /// swapchain image the view was created from, it has no `ImageImpl`
+    VkImage m_swapchain_image = VK_NULL_HANDLE;
+    ImageView::Descriptor::ImageSubresourceRange m_subresource_range;
+
 private:
     DeviceImpl& m_device;
 };
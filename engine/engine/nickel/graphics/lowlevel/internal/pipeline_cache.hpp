@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace nickel::graphics {
+
+/// file name of the pipeline cache in user storage
+constexpr std::string_view PipelineCacheFilename = "pipeline_cache.bin";
+
+/// identity of the device & driver a pipeline cache is valid for, from
+/// `VkPhysicalDeviceProperties`
+struct PipelineCacheDeviceInfo {
+    uint32_t m_vendor_id{};
+    uint32_t m_device_id{};
+    uint32_t m_driver_version{};
+    std::array<uint8_t, 16> m_uuid{};
+};
+
+/**
+ * @brief header written before `vkGetPipelineCacheData` output
+ *
+ * Some drivers crash on cache data of another GPU or on a torn write instead
+ * of rejecting it, so the data is only handed over if this header and the
+ * driver's own header match the running device.
+ */
+struct PipelineCacheFileHeader {
+    static constexpr uint32_t Magic = 0x434c504e;  // "NPLC"
+    static constexpr uint32_t Version = 1;
+
+    uint32_t m_magic = Magic;
+    uint32_t m_version = Version;
+    PipelineCacheDeviceInfo m_device;
+    uint64_t m_data_size{};
+    uint64_t m_data_hash{};
+};
+
+/// @brief prepend `PipelineCacheFileHeader` of `device` to driver cache data
+std::vector<char> PackPipelineCacheData(const PipelineCacheDeviceInfo& device,
+                                        std::span<const char> data);
+
+/// @brief driver cache data in `file` if it was written by this device &
+/// driver and is intact
+/// @return empty if `file` can't be used
+std::span<const char> UnpackPipelineCacheData(
+    const PipelineCacheDeviceInfo& device, std::span<const char> file);
+
+}  // namespace nickel::graphics
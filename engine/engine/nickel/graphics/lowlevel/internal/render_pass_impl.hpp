@@ -20,6 +20,9 @@ public:
 
     VkRenderPass m_render_pass = VK_NULL_HANDLE;
 
+    /// layout of each attachment after the render pass ends
+    std::vector<ImageLayout> m_final_layouts;
+
 private:
     DeviceImpl& m_dev;
 };
@@ -17,9 +17,14 @@ public:
 
     ~SamplerImpl();
 
+    /// thread safe, see `DeviceImpl::m_sampler_mutex`
+    void IncRefcount() override;
     void DecRefcount() override;
     VkSampler m_sampler = VK_NULL_HANDLE;
 
+    // key in `DeviceImpl::m_samplers`, removed when released
+    Sampler::Descriptor m_desc;
+
 private:
     DeviceImpl& m_dev;
 };
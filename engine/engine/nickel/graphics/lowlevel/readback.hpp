@@ -0,0 +1,51 @@
+#pragma once
+#include "nickel/common/math/smatrix.hpp"
+#include "nickel/fs/path.hpp"
+
+#include <vector>
+
+namespace nickel::graphics {
+
+/// CPU copy of a color image, tightly packed RGBA8 rows from top to bottom
+struct ReadbackImage {
+    SVector<uint32_t, 2> m_extent;
+    std::vector<unsigned char> m_pixels;
+
+    explicit operator bool() const noexcept {
+        return m_extent.w > 0 && m_extent.h > 0 &&
+               m_pixels.size() == uint64_t(m_extent.w) * m_extent.h * 4;
+    }
+};
+
+struct ImageDiff {
+    bool m_same_extent = false;
+
+    /// largest difference of a single channel
+    uint32_t m_max_channel_diff{};
+
+    /// pixels with any channel differing more than the tolerance
+    uint64_t m_mismatched_pixels{};
+
+    bool Passed() const noexcept {
+        return m_same_extent && m_mismatched_pixels == 0;
+    }
+};
+
+/// @brief golden image comparison
+/// @param tolerance per channel difference still treated as equal, absorbs
+/// rounding differences between drivers
+ImageDiff CompareImages(const ReadbackImage& image,
+                        const ReadbackImage& golden, uint32_t tolerance = 0);
+
+/// @brief per channel absolute difference with opaque alpha, for inspecting
+/// failed comparisons. Empty if extents differ
+ReadbackImage MakeDiffImage(const ReadbackImage&, const ReadbackImage&);
+
+/// @return false if image is empty or file can't be written
+bool SaveImagePNG(const ReadbackImage&, const Path& filename);
+
+/// @brief load any image stb_image decodes, without storage manager
+/// @return empty image if file can't be read or decoded
+ReadbackImage LoadImagePNG(const Path& filename);
+
+}  // namespace nickel::graphics
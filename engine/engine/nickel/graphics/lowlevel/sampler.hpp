@@ -1,5 +1,6 @@
 #pragma once
 #include "nickel/common/dllexport.hpp"
+#include "nickel/common/hash.hpp"
 #include "nickel/common/impl_wrapper.hpp"
 #include "nickel/graphics/lowlevel/enums.hpp"
 
@@ -25,9 +26,37 @@ public:
         float m_max_lod = 0;
         BorderColor m_border_color = BorderColor::IntOpaqueWhite;
         bool m_unnormalized_coordinates = false;
+
+        bool operator==(const Descriptor&) const = default;
     };
 
     using ImplWrapper::ImplWrapper;
 };
 
-}  // namespace nickel::graphics
\ No newline at end of file
+}  // namespace nickel::graphics
+
+namespace std {
+template <>
+struct hash<nickel::graphics::Sampler::Descriptor> {
+    size_t operator()(
+        const nickel::graphics::Sampler::Descriptor& desc) const noexcept {
+        size_t seed = 0;
+        nickel::HashCombine(seed, desc.m_mag_filter);
+        nickel::HashCombine(seed, desc.m_min_filter);
+        nickel::HashCombine(seed, desc.m_mipmap_mode);
+        nickel::HashCombine(seed, desc.m_address_mode_u);
+        nickel::HashCombine(seed, desc.m_address_mode_v);
+        nickel::HashCombine(seed, desc.m_address_mode_w);
+        nickel::HashCombine(seed, desc.m_mip_lod_bias);
+        nickel::HashCombine(seed, desc.m_anisotropy_enable);
+        nickel::HashCombine(seed, desc.m_max_anisotropy);
+        nickel::HashCombine(seed, desc.m_compare_enable);
+        nickel::HashCombine(seed, desc.m_compare_op);
+        nickel::HashCombine(seed, desc.m_min_lod);
+        nickel::HashCombine(seed, desc.m_max_lod);
+        nickel::HashCombine(seed, desc.m_border_color);
+        nickel::HashCombine(seed, desc.m_unnormalized_coordinates);
+        return seed;
+    }
+};
+}  // namespace std
@@ -1,6 +1,8 @@
 ﻿#pragma once
+#include "nickel/common/hash.hpp"
 #include "nickel/common/math/math.hpp"
 #include "nickel/graphics/lowlevel/bind_group.hpp"
+#include "nickel/graphics/texture.hpp"
 
 namespace nickel::graphics {
 struct BufferView {
@@ -18,6 +20,8 @@ struct PBRParameters {
     Vec4 m_base_color;
     float m_metallic = 1.0f;
     float m_roughness = 1.0f;
+
+    bool operator==(const PBRParameters&) const = default;
 };
 
 class Material3DImpl;
@@ -29,12 +33,20 @@ struct Material3D final : public ImplWrapper<Material3DImpl> {
         ImageView image;
         Sampler sampler;
 
+        /// owner of `image`, empty for default images. Streaming textures
+        /// recreate their view, see `Material3DImpl::UpdateBindGroup()`
+        Texture texture;
+
         operator bool() const { return image && sampler; }
     };
 
     struct Descriptor {
         BufferView pbrParameters;
         Buffer pbr_param_buffer;
+
+        /// copy of the parameters in `pbr_param_buffer`, for bindless
+        /// material table
+        PBRParameters pbrParameterValues;
         TextureInfo basicTexture;
         TextureInfo normalTexture;
         TextureInfo metalicRoughnessTexture;
@@ -42,3 +54,19 @@ struct Material3D final : public ImplWrapper<Material3DImpl> {
     };
 };
 }  // namespace nickel::graphics
+
+namespace std {
+template <>
+struct hash<nickel::graphics::PBRParameters> {
+    size_t operator()(
+        const nickel::graphics::PBRParameters& param) const noexcept {
+        size_t seed = 0;
+        for (int i = 0; i < 4; i++) {
+            nickel::HashCombine(seed, param.m_base_color[i]);
+        }
+        nickel::HashCombine(seed, param.m_metallic);
+        nickel::HashCombine(seed, param.m_roughness);
+        return seed;
+    }
+};
+}  // namespace std
@@ -2,14 +2,58 @@
 #include "nickel/graphics/material.hpp"
 
 namespace nickel::graphics {
+
+/// vertex format of `Primitive::m_vertex_buf_view`, see `GLTFVertex` &
+/// `GLTFQuantizedVertex`
+enum class VertexLayout : uint32_t {
+    Float,
+    Quantized,
+};
+
+/// simplified index list sharing the vertices of its primitive
+struct PrimitiveLOD final {
+    BufferView m_indices_buf_view;
+
+    /// simplification error relative to the bounds diameter
+    float m_error{};
+};
+
+/// bounding spheres & normal cones of 4 meshlets, structure of arrays for
+/// SIMD culling, see `CullMeshlets`
+struct alignas(16) MeshletBounds4 final {
+    float m_center_x[4]{};
+    float m_center_y[4]{};
+    float m_center_z[4]{};
+    float m_radius[4]{};
+    float m_cone_axis_x[4]{};
+    float m_cone_axis_y[4]{};
+    float m_cone_axis_z[4]{};
+    float m_cone_cutoff[4]{1, 1, 1, 1};  // 1 never culls by cone
+};
+
 struct Primitive final {
-    BufferView m_pos_buf_view;
-    BufferView m_norm_buf_view;
-    BufferView m_tan_buf_view;
-    BufferView m_uv_buf_view;
+    /// interleaved position, uv, normal & tangent
+    BufferView m_vertex_buf_view;
+    VertexLayout m_vertex_layout = VertexLayout::Float;
+
+    /// joints & weights per vertex, see `GLTFSkinVertex`, empty if not
+    /// skinned
+    BufferView m_skin_buf_view;
     BufferView m_indices_buf_view;
     IndexType m_index_type;
     Material3D m_material;
+
+    /// local space AABB of positions
+    Vec3 m_bounds_min;
+    Vec3 m_bounds_max;
+
+    /// levels of detail from fine to coarse, `m_indices_buf_view` is level 0
+    std::vector<PrimitiveLOD> m_lods;
+
+    /// clusters of consecutive level 0 triangles: first index of each
+    /// meshlet followed by the index count, empty if primitive is not split
+    std::vector<uint32_t> m_meshlet_offsets;
+    std::vector<MeshletBounds4> m_meshlet_bounds;
 };
 
 struct MeshImpl;
@@ -0,0 +1,98 @@
+#pragma once
+#include "nickel/common/math/math.hpp"
+#include "nickel/common/thread_pool.hpp"
+
+#include <span>
+#include <vector>
+
+namespace nickel::graphics {
+
+/// @brief simplified geometry of a large object (wall, building) in local
+/// space, rasterized as occluder. Winding doesn't matter
+struct OccluderMesh {
+    std::vector<Vec3> m_points;
+    std::vector<uint32_t> m_indices;
+};
+
+/// @brief local space bounding box tested as occludee
+struct OccludeeBounds {
+    Vec3 m_min;
+    Vec3 m_max;
+};
+
+struct OcclusionCullStats {
+    uint32_t m_occluder_triangles{};
+
+    /// triangles crossing the camera plane are dropped, which only makes
+    /// culling less aggressive
+    uint32_t m_skipped_triangles{};
+    uint32_t m_tested{};
+    uint32_t m_rejected{};
+};
+
+/**
+ * @brief CPU occlusion culling against a low resolution software depth
+ * buffer
+ *
+ * Occluders added after `BeginFrame` are rasterized by
+ * `RasterizeOccluders` in bands of rows, 4 pixels at a time with SSE when
+ * available. Depth is NDC depth and greater is nearer (reversed z), empty
+ * pixels are farther than anything.
+ *
+ * `IsOccluded` projects the box and reports it occluded when every pixel
+ * of its screen rect has an occluder nearer than the nearest box corner.
+ * Boxes crossing the camera plane or outside the screen are never occluded,
+ * frustum culling is left to the caller. Results don't depend on thread
+ * count or scheduling.
+ */
+class OcclusionCuller {
+public:
+    struct Descriptor {
+        /// depth buffer size, width is rounded up to a multiple of 4
+        uint32_t m_width = 256;
+        uint32_t m_height = 128;
+
+        /// rows rasterized by one job of `RasterizeOccluders`
+        uint32_t m_band_height = 16;
+    };
+
+    OcclusionCuller();
+    explicit OcclusionCuller(const Descriptor&);
+
+    /// @brief clear depth buffer, occluders & stats
+    void BeginFrame(const Mat44& view_project);
+
+    void AddOccluder(const OccluderMesh&, const Mat44& model);
+
+    /// @param pool rasterize bands on it if not null
+    void RasterizeOccluders(ThreadPool* pool = nullptr);
+
+    /// @brief only valid after `RasterizeOccluders`, not thread safe
+    bool IsOccluded(const OccludeeBounds&, const Mat44& model);
+
+    const OcclusionCullStats& GetStats() const;
+
+    /// @brief row major depth of `GetWidth() * GetHeight()` pixels
+    std::span<const float> GetDepthBuffer() const;
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+
+private:
+    /// screen space x, y & NDC depth of each vertex
+    struct ScreenTriangle {
+        float m_x[3];
+        float m_y[3];
+        float m_z[3];
+    };
+
+    Descriptor m_desc;
+    Mat44 m_view_project;
+    std::vector<float> m_depth;
+    std::vector<ScreenTriangle> m_triangles;
+    OcclusionCullStats m_stats;
+
+    void rasterizeBand(uint32_t row_begin, uint32_t row_end);
+    void rasterizeTriangle(const ScreenTriangle&, int row_begin, int row_end);
+};
+
+}  // namespace nickel::graphics
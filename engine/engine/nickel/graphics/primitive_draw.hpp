@@ -39,6 +39,7 @@ private:
         uint32_t m_elem_count{};
     };
 
+    CommonResource& m_common_resource;
     BindGroupLayout m_bind_group_layout;
     BindGroup m_bind_group;
     PipelineLayout m_pipeline_layout;
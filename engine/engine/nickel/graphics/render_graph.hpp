@@ -0,0 +1,198 @@
+#pragma once
+#include "nickel/common/flags.hpp"
+#include "nickel/graphics/lowlevel/enums.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace nickel::graphics {
+
+/// how a pass uses a resource, decides layout & whether barriers are needed
+enum class RenderGraphAccess {
+    ColorAttachment,
+    DepthStencilAttachment,
+    ShaderRead,
+    TransferSrc,
+    TransferDst,
+    Present,
+};
+
+ImageLayout GetRenderGraphAccessLayout(RenderGraphAccess);
+const char* GetRenderGraphAccessName(RenderGraphAccess);
+
+/// pipeline stages & memory accesses a barrier waits for or blocks
+Flags<PipelineStage> GetRenderGraphAccessStage(RenderGraphAccess);
+Flags<Access> GetRenderGraphAccessMask(RenderGraphAccess);
+
+class CommandEncoder;
+class ImageView;
+
+/// layout transition or memory dependency recorded before a pass
+struct RenderGraphBarrier {
+    uint32_t m_resource{};
+    ImageLayout m_old_layout = ImageLayout::Undefined;
+    ImageLayout m_new_layout = ImageLayout::Undefined;
+
+    /// last access before this pass, nullopt if resource had no content
+    std::optional<RenderGraphAccess> m_src_access;
+    RenderGraphAccess m_dst_access{};
+};
+
+/**
+ * @brief frame graph: passes declare reads & writes, `Compile()` culls
+ * passes whose results are never used, schedules barriers and lets
+ * transient resources with disjoint lifetimes share memory
+ *
+ * Pure bookkeeping, no GPU work. Barriers are handed to the executor which
+ * records them with whatever API it owns, passes must not transition the
+ * resources themselves.
+ */
+class RenderGraph {
+public:
+    using ResourceHandle = uint32_t;
+    using PassHandle = uint32_t;
+    using ExecuteFn = std::function<void()>;
+
+    /// @brief apply barriers of one pass, called right before it executes
+    using BarrierFn =
+        std::function<void(PassHandle, std::span<const RenderGraphBarrier>)>;
+
+    static constexpr uint32_t NoMemoryBlock =
+        std::numeric_limits<uint32_t>::max();
+
+    /// pass handle given to `BarrierFn` with the final barriers
+    static constexpr PassHandle NoPass = std::numeric_limits<uint32_t>::max();
+
+    /// memory needed by a transient resource, from its image requirements
+    struct TransientDesc {
+        uint64_t m_size{};
+        uint64_t m_alignment = 1;
+    };
+
+    class PassBuilder {
+    public:
+        PassBuilder& Read(ResourceHandle, RenderGraphAccess);
+        PassBuilder& Write(ResourceHandle, RenderGraphAccess);
+
+        /// keep the pass even if nothing reads its output, e.g. present or
+        /// readback
+        PassBuilder& SideEffect();
+
+    private:
+        friend class RenderGraph;
+
+        PassBuilder(RenderGraph& graph, PassHandle pass)
+            : m_graph{graph}, m_pass{pass} {}
+
+        RenderGraph& m_graph;
+        PassHandle m_pass;
+    };
+
+    /// @brief resource living outside the graph, e.g. swapchain image. It
+    /// is never culled and ends in `final_layout`
+    /// @param final_layout `Undefined` keeps layout of last access
+    ResourceHandle ImportImage(
+        std::string name, ImageLayout initial_layout,
+        ImageLayout final_layout = ImageLayout::Undefined);
+
+    /// @brief resource only alive inside this frame, may alias others
+    ResourceHandle CreateTransient(std::string name, const TransientDesc&);
+
+    PassBuilder AddPass(std::string name, ExecuteFn execute = {});
+
+    /// @brief cull passes, compute barriers & transient memory layout.
+    /// Declarations must be in execution order
+    void Compile();
+
+    /// @brief run callbacks of passes that survived `Compile()`, then hand
+    /// `GetFinalBarriers()` to `barrier_fn` with `NoPass`
+    void Execute(const BarrierFn& barrier_fn = {}) const;
+
+    /// @brief drop passes & resources, keeps capacity for next frame
+    void Clear();
+
+    bool IsPassCulled(PassHandle) const;
+    std::span<const PassHandle> GetExecutionOrder() const noexcept;
+    std::span<const RenderGraphBarrier> GetBarriers(PassHandle) const;
+
+    /// barriers bringing imported resources to their final layouts
+    std::span<const RenderGraphBarrier> GetFinalBarriers() const noexcept;
+
+    /// offset of transient resource in shared memory, 0 for imported ones
+    uint64_t GetMemoryOffset(ResourceHandle) const;
+
+    /// memory block shared by aliased resources, `NoMemoryBlock` if the
+    /// resource isn't a live transient
+    uint32_t GetMemoryBlock(ResourceHandle) const;
+
+    /// total transient memory after aliasing
+    uint64_t GetTransientMemorySize() const noexcept;
+
+    /// transient memory if every resource had its own allocation
+    uint64_t GetUnaliasedMemorySize() const noexcept;
+
+    /// @brief human readable compiled graph, stable for tests
+    std::string Dump() const;
+
+    /// @brief compiled graph in graphviz dot format
+    std::string DumpGraphviz() const;
+
+private:
+    struct Access {
+        ResourceHandle m_resource{};
+        RenderGraphAccess m_access{};
+        bool m_write = false;
+    };
+
+    struct Pass {
+        std::string m_name;
+        ExecuteFn m_execute;
+        std::vector<Access> m_accesses;
+        std::vector<RenderGraphBarrier> m_barriers;
+        bool m_side_effect = false;
+        bool m_culled = false;
+        uint32_t m_refcount{};
+    };
+
+    struct Resource {
+        std::string m_name;
+        bool m_imported = false;
+        ImageLayout m_initial_layout = ImageLayout::Undefined;
+        ImageLayout m_final_layout = ImageLayout::Undefined;
+        TransientDesc m_desc;
+
+        // filled by `Compile()`
+        uint32_t m_refcount{};
+        std::optional<PassHandle> m_first_use;
+        std::optional<PassHandle> m_last_use;
+        uint32_t m_memory_block = NoMemoryBlock;
+        uint64_t m_memory_offset{};
+    };
+
+    std::vector<Pass> m_passes;
+    std::vector<Resource> m_resources;
+    std::vector<PassHandle> m_execution_order;
+    std::vector<RenderGraphBarrier> m_final_barriers;
+    uint64_t m_transient_size{};
+    uint64_t m_unaliased_size{};
+
+    void cullPasses();
+    void computeLifetimes();
+    void allocateTransients();
+    void scheduleBarriers();
+};
+
+/**
+ * @brief executor side of `RenderGraph::BarrierFn` for `CommandEncoder`
+ * @param images views indexed by resource handle
+ */
+void RecordRenderGraphBarriers(CommandEncoder&,
+                               std::span<const RenderGraphBarrier>,
+                               std::span<const ImageView> images);
+
+}  // namespace nickel::graphics
@@ -1,9 +1,11 @@
 ﻿#pragma once
+#include "nickel/common/async_handle.hpp"
 #include "nickel/fs/path.hpp"
 
 #include <memory>
 
 #include "nickel/graphics/texture.hpp"
+#include "nickel/graphics/texture_streaming.hpp"
 #include "nickel/graphics/lowlevel/enums.hpp"
 
 namespace nickel::graphics {
@@ -12,10 +14,36 @@ class TextureManagerImpl;
 
 class TextureManager {
 public:
-    TextureManager();
+    explicit TextureManager(const TextureStreamingConfig& config = {});
     ~TextureManager();
+    /// @note files with equal content & format share one texture
     Texture Load(const Path& filename, Format format);
+
+    /**
+     * @brief read & decode image on worker thread, GPU upload happens in
+     * `Update()`
+     * @note loading a file already loaded or pending returns the same texture
+     */
+    AsyncHandle<Texture> LoadAsync(const Path& filename, Format format);
+
     Texture Find(const Path& filename);
+
+    /// @brief upload decoded images and resolve handles, call on main thread
+    void Update();
+
+    /// @brief whether some async loading is not finished
+    bool HasPendingLoad() const;
+
+    /// @brief GPU memory of all loaded textures in bytes
+    uint64_t GetVRAMUsage() const;
+
+    /// @brief resident & in-flight bytes of streaming textures, never larger
+    /// than `TextureStreamingConfig::m_budget` unless mip tails alone are
+    uint64_t GetStreamingUsage() const;
+
+    /// @brief loads served by an already loaded texture of equal content
+    uint32_t GetDeduplicatedCount() const;
+
     void GC();
     
 private:
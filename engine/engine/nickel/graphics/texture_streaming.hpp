@@ -0,0 +1,32 @@
+#pragma once
+#include "nickel/fs/path.hpp"
+
+#include <cstdint>
+
+namespace nickel::graphics {
+
+struct TextureStreamingConfig {
+    /// when disabled textures are loaded with all levels
+    bool m_enable = false;
+
+    uint64_t m_budget = 256ull * 1024 * 1024;  // bytes of VRAM
+
+    /// levels not larger than this (in texels) are always resident
+    uint32_t m_mip_tail_size = 64;
+
+    uint32_t m_max_stream_in_per_frame = 4;
+
+    /**
+     * @brief read config from toml file, missing fields keep default value
+     *
+     * @code{.toml}
+     * enable = true
+     * budget_mb = 256
+     * mip_tail_size = 64
+     * max_stream_in_per_frame = 4
+     * @endcode
+     */
+    static TextureStreamingConfig LoadFromFile(const Path& filename);
+};
+
+}  // namespace nickel::graphics
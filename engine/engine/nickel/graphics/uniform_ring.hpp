@@ -0,0 +1,129 @@
+#pragma once
+#include "nickel/graphics/lowlevel/bind_group.hpp"
+#include "nickel/graphics/lowlevel/bind_group_layout.hpp"
+#include "nickel/graphics/lowlevel/buffer.hpp"
+#include "nickel/graphics/lowlevel/device.hpp"
+
+#include <cstring>
+#include <deque>
+#include <optional>
+#include <vector>
+
+namespace nickel::graphics {
+
+class Adapter;
+
+/**
+ * @brief linear suballocation from fixed size pages, no GPU work
+ *
+ * Each frame in flight bumps through its own chain of pages and takes
+ * another one when the current page is full. Pages of a frame are recycled
+ * by the next `BeginFrame` of the same frame index, after its fence.
+ */
+class RingPageAllocator {
+public:
+    struct Allocation {
+        uint32_t m_page{};
+        uint64_t m_offset{};
+    };
+
+    /// @param alignment of every allocation offset
+    RingPageAllocator(uint64_t page_size, uint64_t alignment,
+                      uint32_t frame_count);
+
+    void BeginFrame(uint32_t frame);
+
+    /// @return nullopt if `size` is larger than a page
+    std::optional<Allocation> Allocate(uint64_t size);
+
+    /// pages created so far, page indices are below it
+    uint32_t GetPageCount() const noexcept;
+
+    /// pages chained by the current frame
+    uint32_t GetFramePageCount() const noexcept;
+    uint64_t GetPageSize() const noexcept;
+
+private:
+    uint64_t m_page_size{};
+    uint64_t m_alignment{};
+    uint32_t m_page_count{};
+    uint32_t m_cur_frame{};
+    uint64_t m_cur_offset{};
+    std::vector<std::vector<uint32_t>> m_frame_pages;
+    std::vector<uint32_t> m_free_pages;
+};
+
+/**
+ * @brief per-frame data too large for push constants, e.g. per-draw
+ * matrices. Pages are persistently mapped buffers, each with a bind group of
+ * one dynamic buffer binding, so a draw binds `m_bind_group` with
+ * `m_offset` as dynamic offset
+ */
+class UniformRingBuffer {
+public:
+    struct Descriptor {
+        uint64_t m_page_size = 64 * 1024;
+
+        /// size the shader sees from each offset, allocations are at least
+        /// this large
+        uint32_t m_binding_range{};
+        uint32_t m_binding = 0;
+        Flags<ShaderStage> m_shader_stage;
+
+        /// `DynamicUniform` or `DynamicStorage`
+        BindGroup::BufferBinding::Type m_type =
+            BindGroup::BufferBinding::Type::DynamicUniform;
+    };
+
+    struct Allocation {
+        void* m_data{};
+        uint32_t m_offset{};
+
+        /// stays valid until the ring is destroyed
+        const BindGroup* m_bind_group{};
+
+        explicit operator bool() const noexcept { return m_data; }
+    };
+
+    UniformRingBuffer(const Adapter&, const Descriptor&);
+    ~UniformRingBuffer();
+
+    BindGroupLayout GetBindGroupLayout() const;
+
+    /// @brief recycle pages of `Device::GetCurrentFrameIndex()`, call after
+    /// waiting its fence
+    void BeginFrame();
+
+    /// @return empty allocation if `size` is larger than a page
+    Allocation Allocate(uint64_t size);
+
+    template <typename T>
+    Allocation Push(const T& value) {
+        Allocation allocation = Allocate(sizeof(T));
+        if (allocation) {
+            memcpy(allocation.m_data, &value, sizeof(T));
+        }
+        return allocation;
+    }
+
+    const RingPageAllocator& GetAllocator() const;
+
+private:
+    struct Page {
+        Buffer m_buffer;
+        BindGroup m_bind_group;
+        void* m_data{};
+    };
+
+    Device m_device;
+    Descriptor m_desc;
+    RingPageAllocator m_allocator;
+    BindGroupLayout m_layout;
+
+    // deque keeps bind groups in place, recorded commands point to them
+    std::deque<Page> m_pages;
+
+    void createPage();
+};
+
+}  // namespace nickel::graphics
@@ -9,10 +9,23 @@ public:
 
     void Update();
 
+    /// @brief skip models hidden behind occluders, on by default
+    void EnableOcclusionCulling(bool enable) { m_occlusion_culling = enable; }
+
+    const graphics::OcclusionCuller& GetOcclusionCuller() const {
+        return m_occlusion_culler;
+    }
+
 private:
     GameObject m_root_go;
+    graphics::OcclusionCuller m_occlusion_culler;
+    bool m_occlusion_culling = true;
+
+    // models of the frame, drawn after occluders are rasterized
+    std::vector<GameObject*> m_models;
 
     void preorderGO(GameObject* parent, GameObject& go);
+    void drawModels();
 };
 
 }  // namespace nickel
\ No newline at end of file
@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "nickel/common/transform.hpp"
 #include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/occlusion_culling.hpp"
 #include "nickel/physics/cct.hpp"
 #include "nickel/physics/rigidbody.hpp"
 #include "nickel/physics/vehicle.hpp"
@@ -22,9 +23,23 @@ public:
 
     physics::RigidActor m_rigid_actor;
     graphics::GLTFModel m_model;
+    /// model from `GLTFManager::LoadAsync`, moved into `m_model` when ready,
+    /// a placeholder box is drawn while pending
+    AsyncHandle<graphics::GLTFModel> m_pending_model;
     physics::CapsuleController m_controller;
     physics::Vehicle m_vehicle;
 
+    /// rasterized into the occlusion buffer of the level, e.g. a simplified
+    /// wall. Shared between instances
+    std::shared_ptr<const graphics::OccluderMesh> m_occluder;
+
+    /// local bounds of `m_model` tested against occluders, models without
+    /// bounds are always drawn
+    std::optional<graphics::OccludeeBounds> m_bounds;
+
+    /// LOD levels of this instance, `m_model` may be shared
+    graphics::LODState m_lod_state;
+
     const Transform& GetGlobalTransform() const { return m_transform; }
 
     void UpdateGlobalTransform(const Transform& parent_transform) {
@@ -117,4 +117,12 @@ public:
     void SetClimbingMode(Descriptor::ClimbingMode);
 };
 
+/// @brief one `MoveAndSlide` in `Scene::MoveControllers`
+struct CCTMoveCommand {
+    CapsuleController m_controller;
+    Vec3 m_disp;
+    float m_elapsed_time{};
+    float m_min_dist = 0.001f;
+};
+
 }  // namespace nickel::physics
\ No newline at end of file
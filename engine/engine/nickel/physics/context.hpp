@@ -1,5 +1,6 @@
 #pragma once
 #include "nickel/common/math/math.hpp"
+#include "nickel/physics/instrumentation.hpp"
 #include "nickel/physics/material.hpp"
 #include "nickel/physics/rigidbody.hpp"
 #include "nickel/physics/scene.hpp"
@@ -12,6 +13,7 @@ class ContextImpl;
 class Context {
 public:
     Context();
+    explicit Context(const InstrumentationConfig& config);
     ~Context();
 
     Scene CreateScene(const std::string& name, const Vec3& gravity);
@@ -45,6 +47,11 @@ public:
     void Update(float delta_time);
     void GC();
 
+    const InstrumentationConfig& GetInstrumentationConfig() const;
+
+    /// @brief recorded steps, oldest first. Empty unless mode is `Profile`
+    void GetStepTimings(std::vector<PhysicsStepTiming>& out) const;
+
     const ContextImpl* GetImpl() const;
     ContextImpl* GetImpl();
 
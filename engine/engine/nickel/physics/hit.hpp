@@ -4,6 +4,8 @@
 #include "nickel/physics/rigidbody.hpp"
 #include "nickel/physics/shape.hpp"
 
+#include <span>
+
 namespace nickel::physics {
 
 struct BasicHitInfo {
@@ -0,0 +1,63 @@
+#pragma once
+#include "nickel/fs/path.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace nickel::physics {
+
+enum class InstrumentationMode {
+    Off,
+    PVDSocket,  // stream to a running PhysX Visual Debugger
+    PVDFile,    // stream a PVD capture into a file
+    Profile,    // built-in per-step timings, see `Context::GetStepTimings`
+};
+
+struct InstrumentationConfig {
+    InstrumentationMode m_mode = InstrumentationMode::Off;
+
+    std::string m_pvd_host = "localhost";
+    uint32_t m_pvd_port = 5425;
+    uint32_t m_pvd_timeout = 10;  // ms
+
+    // relative to the working directory
+    Path m_pvd_file = "physics_capture.pxd2";
+    // capture data beyond this is dropped
+    uint32_t m_pvd_file_max_size = 256 * 1024 * 1024;
+
+    // number of steps kept by the profile ring buffer
+    uint32_t m_profile_capacity = 512;
+
+    /**
+     * @brief read config from toml file, missing fields keep default value
+     *
+     * @code{.toml}
+     * mode = "profile"  # off, pvd_socket, pvd_file, profile
+     * pvd_host = "localhost"
+     * pvd_port = 5425
+     * pvd_file = "physics_capture.pxd2"
+     * profile_capacity = 512
+     * @endcode
+     */
+    static InstrumentationConfig LoadFromFile(const Path& filename);
+
+    /// @brief same as `LoadFromFile` for content read elsewhere, e.g. by
+    /// `StorageManager`
+    static InstrumentationConfig Parse(std::string_view content);
+};
+
+/**
+ * @brief cpu time of one scene step, phases are summed over all threads
+ * @note phases need PhysX profile zones (debug builds or
+ * `NICKEL_PHYSX_PROFILE`, on by default), without them `Profile` mode is
+ * refused
+ */
+struct PhysicsStepTiming {
+    uint64_t m_step{};
+    float m_total{};  // ms, wall time of simulate and fetch results
+    float m_broadphase{};
+    float m_narrowphase{};
+    float m_solver{};
+};
+
+}  // namespace nickel::physics
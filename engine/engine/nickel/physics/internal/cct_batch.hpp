@@ -0,0 +1,103 @@
+#pragma once
+#include "nickel/physics/cct.hpp"
+#include "nickel/physics/internal/pch.hpp"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+
+namespace nickel::physics {
+
+/**
+ * @brief moves many controllers at once.
+ *
+ * All controllers of the manager are bucketed into a XZ grid once per batch,
+ * cells are large enough that a controller can only touch controllers in its
+ * 3x3 neighbor cells. Each move only tests these neighbors (shared by all
+ * controllers in the cell) instead of every controller in the scene.
+ * Cells are split into 9 phases by (x % 3, z % 3), cells in the same phase
+ * never share neighbors so they are moved in parallel on the scene's cpu
+ * dispatcher.
+ *
+ * Controllers of a cell also share one overlap query of the static and
+ * dynamic shapes around them, each move keeps the shapes its own query box
+ * touches.
+ *
+ * During a phase moves only query the scene, the kinematic actor targets
+ * they compute are committed on the calling thread after the phase. Moves
+ * use default filters, so no query filter, hit report or behavior callback
+ * runs on the workers
+ */
+class CharacterControllerBatch {
+public:
+    CharacterControllerBatch(physx::PxScene&, physx::PxControllerManager&);
+    ~CharacterControllerBatch();
+
+    void Move(std::span<const CCTMoveCommand>,
+              std::span<Flags<CCTCollisionFlag>> out_flags);
+
+    /// @brief commands of the last `Move` in the order they were moved.
+    /// Groups of one phase run in parallel, they never touch each other
+    std::span<const uint32_t> GetMoveOrder() const { return m_order; }
+
+private:
+    class MoveTask;
+
+    static constexpr uint32_t PhaseNum = 9;
+    // a cell touching more shapes falls back to a query per move
+    static constexpr uint32_t SharedHitCapacity = 256;
+
+    struct Cell {
+        int32_t m_x{};
+        int32_t m_z{};
+        uint32_t m_member_begin{};  // range in m_members
+        uint32_t m_member_end{};
+        uint32_t m_candidate_begin{};  // range in m_candidates
+        uint32_t m_candidate_end{};
+    };
+
+    // commands in one cell, moved sequentially
+    struct Group {
+        uint32_t m_cell{};
+        uint32_t m_begin{};  // range in m_order
+        uint32_t m_end{};
+    };
+
+    physx::PxScene& m_scene;
+    physx::PxControllerManager& m_mgr;
+
+    std::span<const CCTMoveCommand> m_commands;
+    std::span<Flags<CCTCollisionFlag>> m_out_flags;
+    float m_cell_size{};
+
+    std::unordered_map<uint64_t, uint32_t> m_cell_map;
+    std::vector<Cell> m_cells;
+    std::vector<uint32_t> m_controller_cells;  // manager index -> cell
+    std::vector<uint32_t> m_members;           // manager indices sorted by cell
+    std::vector<uint32_t> m_candidates;
+    std::vector<uint32_t> m_command_cells;  // command -> cell
+    std::vector<uint32_t> m_order;          // commands sorted by phase & cell
+    std::vector<Group> m_groups;            // sorted by phase
+    std::array<uint32_t, PhaseNum + 1> m_phase_offsets{};
+
+    std::atomic<uint32_t> m_next_group{};
+    uint32_t m_group_end{};
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    uint32_t m_running_tasks{};
+    std::vector<std::unique_ptr<MoveTask>> m_tasks;
+
+    bool buildGrid();
+    uint32_t getCell(const physx::PxExtendedVec3&);
+    void buildCandidates(uint32_t cell);
+    void buildGroups();
+    void runPhase(uint32_t phase);
+    void moveGroups();
+    void moveGroup(const Group&);
+    void onTaskFinished();
+};
+
+}  // namespace nickel::physics
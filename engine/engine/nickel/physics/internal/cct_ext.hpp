@@ -0,0 +1,33 @@
+#pragma once
+#include "nickel/physics/internal/pch.hpp"
+
+// engine-only hooks into the vendored character controller, defined in
+// physxcharacterkinematic/src/CctController.cpp. Not part of the PhysX API
+namespace nickel::physics {
+
+/// @brief CCT-vs-CCT tests of the next moves only visit these controllers
+/// (indices of `PxControllerManager::getController`), nullptr visits all.
+/// The array must outlive the moves
+void SetCCTCandidates(physx::PxController&, const physx::PxU32* candidates,
+                      physx::PxU32 count);
+
+/// @brief hits of one overlap of `bounds` (static and dynamic shapes, no
+/// blocking hits, the move's filter data) used by the next moves instead of
+/// their own scene query whenever `bounds` covers it. nullptr queries the
+/// scene. The array must outlive the moves
+void SetCCTSharedOverlap(physx::PxController&, const physx::PxOverlapHit* hits,
+                         physx::PxU32 count, const physx::PxBounds3& bounds);
+
+/// @brief toggle the manager's locking, needed while controllers are moved
+/// from several threads. Must not be called during a move
+void SetCCTManagerLocking(physx::PxControllerManager&, bool enable);
+
+/// @brief keep the kinematic actor target computed by `move` on the
+/// controller instead of writing it to the scene
+void SetDeferKinematicTarget(physx::PxController&, bool defer);
+
+/// @brief write the target kept by a deferred `move`, if any. Must not run
+/// concurrently with scene queries or other scene writes
+void CommitKinematicTarget(physx::PxController&);
+
+}  // namespace nickel::physics
@@ -4,6 +4,8 @@
 #include "nickel/common/math/math.hpp"
 #include "nickel/common/memory/memory.hpp"
 #include "nickel/physics/geometry.hpp"
+#include "nickel/physics/instrumentation.hpp"
+#include "nickel/physics/internal/instrumentation_impl.hpp"
 #include "nickel/physics/internal/joint_impl.hpp"
 #include "nickel/physics/internal/material_impl.hpp"
 #include "nickel/physics/internal/pch.hpp"
@@ -68,7 +70,7 @@ struct QueryFilterCallback: public physx::PxQueryFilterCallback {
 
 class ContextImpl {
 public:
-    ContextImpl();
+    explicit ContextImpl(const InstrumentationConfig& config);
     ~ContextImpl();
 
     Scene CreateScene(const std::string& name, const Vec3& gravity);
@@ -99,6 +101,18 @@ public:
 
     void GC();
 
+    const InstrumentationConfig& GetInstrumentationConfig() const;
+
+    /// @brief nullptr unless instrumentation mode is `Profile`
+    PhysicsProfiler* GetProfiler();
+
+    /**
+     * @brief id of a new actor, joint or controller, kept in its `userData`.
+     * Ids follow creation order, so a world built in the same order gets the
+     * same ids in any context. Scene snapshots match records by them
+     */
+    uint32_t GenerateStableID();
+
     physx::PxTolerancesScale m_tolerances_scale;
     physx::PxPhysics* m_physics;
     QueryFilterCallback m_query_filter_callback;
@@ -119,6 +133,12 @@ private:
     std::unique_ptr<VehicleManager> m_vehicle_manager;
     physx::PxPvd* m_pvd;
     physx::PxPvdTransport* m_pvd_transport;
+    InstrumentationConfig m_instrumentation_config;
+    std::unique_ptr<PhysicsProfiler> m_profiler;
+    uint32_t m_last_stable_id{};
+
+    void initInstrumentation();
+    void initProfiler();
 
     static physx::PxFilterFlags SimulateFilterShader(
         physx::PxFilterObjectAttributes attributes0,
@@ -0,0 +1,83 @@
+#pragma once
+#include "nickel/fs/path.hpp"
+#include "nickel/physics/instrumentation.hpp"
+#include "nickel/physics/internal/pch.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace nickel::physics {
+
+/// @brief collects PhysX profile zones into a per-step ring buffer
+class PhysicsProfiler : public physx::PxProfilerCallback {
+public:
+    explicit PhysicsProfiler(uint32_t capacity);
+
+    void* zoneStart(const char* event_name, bool detached,
+                    uint64_t context_id) override;
+    void zoneEnd(void* profiler_data, const char* event_name, bool detached,
+                 uint64_t context_id) override;
+
+    void BeginStep();
+    void EndStep();
+
+    /// @brief copy recorded steps into `out`, oldest first
+    void GetStepTimings(std::vector<PhysicsStepTiming>& out) const;
+
+private:
+    enum Phase {
+        Broadphase,
+        Narrowphase,
+        Solver,
+        PhaseNum,
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // zones of the same phase nest (e.g. Dynamics.solver runs
+    // Dynamics.solveGroup), only the outermost one on each thread is timed
+    static thread_local std::array<uint32_t, PhaseNum> s_zone_depth;
+
+    static std::optional<Phase> classifyZone(const char* name);
+    static uint64_t now();
+
+    std::array<std::atomic<uint64_t>, PhaseNum> m_phase_time{};  // ns
+    uint64_t m_step_begin{};
+    uint64_t m_step{};
+
+    mutable std::mutex m_mutex;
+    std::vector<PhysicsStepTiming> m_records;
+    uint32_t m_head{};
+    uint32_t m_count{};
+};
+
+/// @brief PVD transport streaming the capture into a file, opened on connect
+class PvdFileTransport : public physx::PxPvdTransport {
+public:
+    PvdFileTransport(const Path& filename, uint32_t max_size);
+
+    bool connect() override;
+    void disconnect() override;
+    bool isConnected() override;
+    bool write(const uint8_t* bytes, uint32_t length) override;
+    physx::PxPvdTransport& lock() override;
+    void unlock() override;
+    void flush() override;
+    uint64_t getWrittenDataSize() override;
+    void release() override;
+
+private:
+    Path m_filename;
+    uint32_t m_max_size;
+    std::ofstream m_file;
+    uint64_t m_written_size{};
+    bool m_overflow_reported{};
+    std::mutex m_mutex;
+};
+
+}  // namespace nickel::physics
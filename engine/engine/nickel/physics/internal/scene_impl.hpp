@@ -2,6 +2,7 @@
 #include "nickel/common/bit_manipulate.hpp"
 #include "nickel/common/memory/memory.hpp"
 #include "nickel/common/memory/refcountable.hpp"
+#include "nickel/physics/internal/cct_batch.hpp"
 #include "nickel/physics/internal/cct_impl.hpp"
 #include "nickel/physics/internal/enum_convert.hpp"
 #include "nickel/physics/internal/pch.hpp"
@@ -104,13 +105,21 @@ public:
 
     CapsuleController CreateCapsuleController(
         const CapsuleController::Descriptor&);
+    void MoveControllers(std::span<const CCTMoveCommand>,
+                         std::span<Flags<CCTCollisionFlag>> out_flags);
+    void TakeSnapshot(SceneSnapshot&) const;
+    bool RestoreSnapshot(const SceneSnapshot&);
 
     physx::PxScene* m_scene{};
     physx::PxControllerManager* m_cct_manager{};
     BlockMemoryAllocator<CapsuleControllerImpl> m_capsule_controller_allocator;
+    std::unique_ptr<CharacterControllerBatch> m_cct_batch;
 
 private:
     ContextImpl* m_ctx;
+    std::string m_name;
+
+    bool readSnapshot(const SceneSnapshot&, bool apply);
 };
 
 }  // namespace nickel::physics
\ No newline at end of file
@@ -49,4 +49,14 @@ inline Transform TransformFromPhysX(const physx::PxTransform& t) {
     };
 }
 
+/// @brief stable id kept in `userData`, see `ContextImpl::GenerateStableID`
+inline void* StableIDToUserData(uint32_t id) {
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(id));
+}
+
+/// @return 0 for objects not created by the engine
+inline uint32_t StableIDFromUserData(const void* user_data) {
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(user_data));
+}
+
 }  // namespace nickel::physics
\ No newline at end of file
@@ -41,11 +41,17 @@ public:
 
 class VehicleDriveImpl : public RefCountable {
 public:
+    static constexpr uint32_t InvalidIndex =
+        std::numeric_limits<uint32_t>::max();
+
     Vehicle::Type GetType() const { return m_type; }
     virtual void Update(float) = 0;
 
     physx::PxVehicleWheels* m_drive{};
 
+    // slot in VehicleManagerImpl::m_vehicles, InvalidIndex if not registered
+    uint32_t m_index = InvalidIndex;
+
 protected:
     VehicleDriveImpl(Vehicle::Type type) : m_type{type} {}
 
@@ -216,16 +222,35 @@ public:
     void GC();
 
     std::vector<VehicleDriveImpl*> m_pending_delete;
+
+    // SoA vehicle registry, m_wheels[i] is m_vehicles[i]->m_drive. Kept
+    // persistently so it can be passed to PhysX without rebuilding per frame
     std::vector<VehicleDriveImpl*> m_vehicles;
+    std::vector<physx::PxVehicleWheels*> m_wheels;
     BlockMemoryAllocator<Vehicle4WDriveImpl> m_4w_allocator;
     BlockMemoryAllocator<VehicleNWDriveImpl> m_nw_allocator;
     BlockMemoryAllocator<VehicleTankDriveImpl> m_tank_allocator;
     BlockMemoryAllocator<VehicleNoDriveImpl> m_no_drive_allocator;
-    physx::PxVehicleDrivableSurfaceToTireFrictionPairs* m_friction_pairs;
+    physx::PxVehicleDrivableSurfaceToTireFrictionPairs* m_friction_pairs{};
+
+    uint32_t GetBatchQueryCapacity() const { return m_batch_result_num; }
+
+    void SetTireFrictionTable(const VehicleTireFrictionTable&);
+    bool LoadTireFrictionTable(const Path&);
+    const VehicleTireFrictionTable& GetTireFrictionTable() const;
+    bool SetSurfaceMaterial(const Material&, const std::string& surface);
+    std::optional<uint32_t> GetSurfaceType(const std::string& surface) const;
+    std::optional<uint32_t> GetTireType(const std::string& tire) const;
+    void SetTypePairFriction(uint32_t surface_type, uint32_t tire_type,
+                             float friction);
+    float GetTypePairFriction(uint32_t surface_type, uint32_t tire_type) const;
 
 private:
-    static constexpr uint32_t BatchTouchExpandStep = PX_MAX_NB_WHEELS * 4;
-    static constexpr uint32_t BatchResultExpandStep = PX_MAX_NB_WHEELS;
+    struct SurfaceMaterialBinding {
+        Material m_material;
+        std::string m_surface;
+    };
+    static constexpr uint32_t BatchResultInitCapacity = PX_MAX_NB_WHEELS;
 
     physx::PxBatchQueryExt* m_batch_query{};
     SceneImpl& m_scene;
@@ -235,11 +260,20 @@ private:
     uint32_t m_batch_touch_num{};
     VehicleQueryFilterShader m_filter_shader;
 
+    VehicleTireFrictionTable m_friction_table;
+    std::vector<float> m_frictions;  // [surface][tire]
+    std::vector<SurfaceMaterialBinding> m_surface_materials;
+
+    template <typename T>
+    T* registerVehicle(T* vehicle);
+    void unregisterVehicle(VehicleDriveImpl*);
     void deletePendingVehicles();
     void tryRecreateBatchQuery();
     void recreateBatchQuery(uint32_t batch_result_num,
                             uint32_t batch_touch_num);
     void setupFrictionPairs();
+    void applyFrictionPairs();
+    void clampTireTypes(physx::PxVehicleWheels&) const;
 };
 
 }  // namespace nickel::physics
\ No newline at end of file
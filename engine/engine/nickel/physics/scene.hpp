@@ -6,11 +6,19 @@
 #include "nickel/physics/rigidbody.hpp"
 #include "nickel/physics/filter.hpp"
 
+#include <span>
+#include <vector>
+
 namespace nickel::physics {
 
 class ContextImpl;
 class SceneImpl;
 
+/// @brief binary state of a scene, see `Scene::TakeSnapshot`
+struct SceneSnapshot {
+    std::vector<uint8_t> m_data;
+};
+
 class Scene: public ImplWrapper<SceneImpl> {
 public:
     using ImplWrapper::ImplWrapper;
@@ -36,6 +44,37 @@ public:
     CapsuleController CreateCapsuleController(
         const CapsuleController::Descriptor&);
 
+    /**
+     * @brief move many controllers as one batch, independent controllers are
+     * moved in parallel on the scene's cpu dispatcher workers. The scene must
+     * not be used from other threads until it returns
+     * @param out_flags collision flags of each command, at least
+     * `commands.size()` elements
+     */
+    void MoveControllers(std::span<const CCTMoveCommand> commands,
+                         std::span<Flags<CCTCollisionFlag>> out_flags);
+
+    /**
+     * @brief save state of actors, shapes, joints, controllers and vehicles in
+     * scene into `snapshot`, reusing its memory
+     */
+    void TakeSnapshot(SceneSnapshot& snapshot) const;
+
+    /**
+     * @brief restore state saved by `TakeSnapshot` into this scene
+     * @note objects are not created or destroyed. Records are matched to
+     * objects by the id the context gives them in creation order, so the
+     * scene must contain the same objects, built in the same order, as when
+     * the snapshot was taken
+     * @note the whole snapshot is checked before anything is applied, the
+     * scene is left untouched when it doesn't match
+     * @note pairs of restored dynamic actors are refiltered, which drops their
+     * contact caches. Running the same input after a restore gives the same
+     * bits, in place or in a freshly built scene, but a run that reached the
+     * snapshot state by simulation still holds its contacts and differs
+     */
+    bool RestoreSnapshot(const SceneSnapshot& snapshot);
+
     void GC();
 };
 
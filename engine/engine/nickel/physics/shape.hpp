@@ -5,6 +5,8 @@
 #include "nickel/physics/geometry.hpp"
 #include "nickel/physics/material.hpp"
 
+#include <span>
+
 namespace nickel::physics {
 class ShapeImpl;
 class ShapeConstImpl;
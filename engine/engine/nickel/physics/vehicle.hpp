@@ -1,10 +1,14 @@
 #pragma once
 #include "nickel/common/impl_wrapper.hpp"
 #include "nickel/common/math/math.hpp"
+#include "nickel/fs/path.hpp"
 #include "nickel/physics/filter.hpp"
+#include "nickel/physics/material.hpp"
 
 #include <optional>
 #include <span>
+#include <string>
+#include <vector>
 
 namespace nickel::physics {
 
@@ -340,6 +344,25 @@ std::vector<float> ComputeVehicleSprungMass(
     std::span<const Vec3> sprung_mass_coord, const Vec3& center_of_mass,
     float totle_mass);
 
+/**
+ * @brief surface/tire friction description, index in `m_surfaces` is the
+ * surface type and index in `m_tires` is `Tire::m_type`.
+ * Surface 0 is used for materials not bound by
+ * `VehicleManager::SetSurfaceMaterial`
+ */
+struct VehicleTireFrictionTable {
+    struct Pair {
+        std::string m_surface;
+        std::string m_tire;
+        float m_friction = 1.0f;
+    };
+
+    std::vector<std::string> m_surfaces;
+    std::vector<std::string> m_tires;
+    std::vector<Pair> m_pairs;
+    float m_default_friction = 1.0f;  // for pairs not listed in m_pairs
+};
+
 class VehicleManager {
 public:
     VehicleManager(ContextImpl&, SceneImpl&);
@@ -360,7 +383,36 @@ public:
     void Update(float delta_time);
     void GC();
 
+    /**
+     * @brief replace surface/tire friction table. Vehicles are kept, material
+     * bindings are re-resolved by surface name
+     */
+    void SetTireFrictionTable(const VehicleTireFrictionTable&);
+
+    /**
+     * @brief load friction table from toml, keys are `surfaces`, `tires`,
+     * `default_friction` and `[[pairs]]` with `surface`, `tire`, `friction`
+     */
+    bool LoadTireFrictionTable(const Path&);
+
+    const VehicleTireFrictionTable& GetTireFrictionTable() const;
+
+    /// @brief wheels touching shapes with this material use `surface` friction
+    bool SetSurfaceMaterial(const Material&, const std::string& surface);
+
+    std::optional<uint32_t> GetSurfaceType(const std::string& surface) const;
+    std::optional<uint32_t> GetTireType(const std::string& tire) const;
+
+    /// @brief change one friction value in place
+    void SetTypePairFriction(uint32_t surface_type, uint32_t tire_type,
+                             float friction);
+    float GetTypePairFriction(uint32_t surface_type, uint32_t tire_type) const;
+
 private:
+    // snapshots save vehicle state, tests check registry internals
+    friend class SceneImpl;
+    friend struct VehicleManagerTestAccess;
+
     std::unique_ptr<VehicleManagerImpl> m_impl;
 };
 
@@ -0,0 +1,48 @@
+#include "nickel/common/thread_pool.hpp"
+
+#include <algorithm>
+
+namespace nickel {
+
+ThreadPool::ThreadPool(uint32_t thread_num) {
+    if (thread_num == 0) {
+        thread_num = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+    m_threads.reserve(thread_num);
+    for (uint32_t i = 0; i < thread_num; i++) {
+        m_threads.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock{m_mutex};
+        m_stop = true;
+    }
+    m_cond.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+uint32_t ThreadPool::GetThreadNum() const noexcept {
+    return m_threads.size();
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock{m_mutex};
+            m_cond.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+            if (m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+}  // namespace nickel
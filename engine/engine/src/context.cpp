@@ -5,6 +5,7 @@
 #include "nickel/graphics/lowlevel/internal/adapter_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/device_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/enum_convert.hpp"
+#include "nickel/graphics/lowlevel/internal/pipeline_cache.hpp"
 #include "nickel/graphics/lowlevel/internal/vk_call.hpp"
 #include "nickel/internal/pch.hpp"
 
@@ -18,6 +19,10 @@ Context::~Context() {
 
     m_level.reset();
 
+    // pending loading jobs still read files through storage manager
+    LOGI("stop worker threads");
+    m_thread_pool.reset();
+
     LOGI("release debug drawer");
     m_debug_drawer.reset();
 
@@ -31,6 +36,9 @@ Context::~Context() {
     LOGI("release graphics context");
     m_graphics_ctx.reset();
 
+    LOGI("save pipeline cache");
+    savePipelineCache();
+
     LOGI("shutdown graphics system");
     m_graphics_adapter.reset();
 
@@ -55,8 +63,15 @@ void Context::Initialize() {
         std::make_unique<StorageManager>("visualgmq", "nickelengine");
     
     LOGI("read project path config");
-    m_engine_relative_path = parseEngineProjectPath();
+    parseEngineProjectPath();
     LOGI("engine project path: ", m_engine_relative_path);
+    LOGI("cooked asset path: ", m_cooked_asset_path);
+
+    LOGI("init worker threads");
+    m_thread_pool = std::make_unique<ThreadPool>();
+
+    LOGI("load pipeline cache");
+    loadPipelineCache();
 
     LOGI("init graphics context");
     m_graphics_ctx = std::make_unique<graphics::Context>(
@@ -67,10 +82,12 @@ void Context::Initialize() {
         m_graphics_adapter->GetDevice(),
         m_graphics_ctx->GetImpl()->GetCommonResource(),
         m_graphics_ctx->GetImpl()->GetGLTFRenderPass());
-    m_texture_mgr = std::make_unique<graphics::TextureManager>();
+    m_texture_mgr = std::make_unique<graphics::TextureManager>(
+        parseTextureStreamingConfig());
 
     LOGI("init physics context");
-    m_physics = std::make_unique<physics::Context>();
+    m_physics = std::make_unique<physics::Context>(
+        parsePhysicsInstrumentationConfig());
 
     LOGI("init debug drawer");
     m_debug_drawer = std::make_unique<graphics::DebugDrawer>();
@@ -87,6 +104,11 @@ void Context::HandleEvent(const SDL_Event& event) {
     if (event.type == SDL_EVENT_WINDOW_RESIZED) {
         OnWindowResize();
     }
+    // keyboard, mouse, joystick, gamepad & touch events
+    if (event.type >= SDL_EVENT_KEY_DOWN &&
+        event.type < SDL_EVENT_CLIPBOARD_UPDATE && m_graphics_ctx) {
+        m_graphics_ctx->RecordInput(event.common.timestamp);
+    }
 
     m_device_mgr.HandleEvent(event);
 }
@@ -135,6 +157,10 @@ const StorageManager& Context::GetStorageManager() const {
     return *m_storage_mgr;
 }
 
+ThreadPool& Context::GetThreadPool() {
+    return *m_thread_pool;
+}
+
 graphics::Context& Context::GetGraphicsContext() {
     return *m_graphics_ctx;
 }
@@ -213,6 +239,10 @@ void Context::Update() {
     m_time.Update();
     m_graphics_ctx->BeginFrame();
 
+    // finalize async loaded assets before game logic sees them
+    m_gltf_mgr->Update();
+    m_texture_mgr->Update();
+
     auto app = GetApplication();
     if (app) {
         app->OnUpdate(m_time.DeltaTime());
@@ -246,18 +276,75 @@ const Path& Context::GetEngineRelativePath() const {
     return m_engine_relative_path;
 }
 
-Path Context::parseEngineProjectPath() const {
+const Path& Context::GetCookedAssetPath() const {
+    return m_cooked_asset_path;
+}
+
+void Context::parseEngineProjectPath() {
     auto parser = toml::parse_file("nickel_engine_project_path.toml");
-    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(
-        {}, !parser.failed(),
+    NICKEL_RETURN_IF_FALSE_LOGW(
+        !parser.failed(),
         "can't parse nickel_engine_project_path.toml, use default project path "
         "'.'");
     auto& tbl = parser.table();
+    if (auto path = tbl.get_as<std::string>("cooked_asset_path")) {
+        m_cooked_asset_path = path->get();
+    } else {
+        LOGW("no 'cooked_asset_path' in nickel_engine_project_path.toml, "
+             "cooked assets are not used");
+    }
+
     auto path = tbl.get_as<std::string>("project_path");
-    NICKEL_RETURN_VALUE_IF_FALSE_LOGW({}, path,
-                                      "parse nickel_engine_project_path.toml "
-                                      "failed: no 'project_path' field");
-    return path->get();
+    NICKEL_RETURN_IF_FALSE_LOGW(path,
+                                "parse nickel_engine_project_path.toml "
+                                "failed: no 'project_path' field");
+    m_engine_relative_path = path->get();
+}
+
+void Context::loadPipelineCache() {
+    auto& storage = m_storage_mgr->GetUserStorage();
+    storage.WaitStorageReady();
+    auto data = storage.ReadStorageFile(
+        std::string{graphics::PipelineCacheFilename});
+    if (data.empty()) {
+        LOGI("no pipeline cache, pipelines compile from SPIR-V");
+        return;
+    }
+    m_graphics_adapter->GetDevice().LoadPipelineCache(data);
+}
+
+void Context::savePipelineCache() {
+    auto data = m_graphics_adapter->GetDevice().GetPipelineCacheData();
+    auto stats = m_graphics_adapter->GetDevice().GetPipelineCacheStats();
+    LOGI("pipeline cache: {} hits, {} misses", stats.m_hits, stats.m_misses);
+
+    auto& storage = m_storage_mgr->GetUserStorage();
+    storage.WaitStorageReady();
+    if (!storage.WriteStorageFile(std::string{graphics::PipelineCacheFilename},
+                                  data.data(), data.size())) {
+        LOGW("save pipeline cache failed");
+    }
+}
+
+physics::InstrumentationConfig Context::parsePhysicsInstrumentationConfig()
+    const {
+    constexpr const char* filename = "nickel_physics_instrumentation.toml";
+    auto storage = m_storage_mgr->AcquireLocalStorage();
+    storage->WaitStorageReady();
+    if (!storage->IsFileExists(filename)) {
+        return {};
+    }
+    auto content = storage->ReadStorageFile(filename);
+    return physics::InstrumentationConfig::Parse(
+        {content.data(), content.size()});
+}
+
+graphics::TextureStreamingConfig Context::parseTextureStreamingConfig() const {
+    constexpr const char* filename = "nickel_texture_streaming.toml";
+    if (!std::filesystem::exists(filename)) {
+        return {};
+    }
+    return graphics::TextureStreamingConfig::LoadFromFile(filename);
 }
 
 }  // namespace nickel
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "nickel/fs/mapped_file.hpp"
+#include "nickel/common/log.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nickel {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const Path& filename) {
+    HANDLE file = CreateFileW(filename.GetUnderlyingPath().c_str(),
+                              GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        LOGE("map file {} failed: can't open", filename);
+        return;
+    }
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        LOGE("map file {} failed: file is empty", filename);
+        release();
+        return;
+    }
+
+    m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        LOGE("map file {} failed: CreateFileMapping error {}", filename,
+             GetLastError());
+        release();
+        return;
+    }
+
+    m_data = static_cast<const unsigned char*>(
+        MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data) {
+        LOGE("map file {} failed: MapViewOfFile error {}", filename,
+             GetLastError());
+        release();
+        return;
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+}
+
+void MappedFile::release() {
+    if (m_data) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file) {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_mapping = nullptr;
+    m_file = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const Path& filename) {
+    int fd = open(filename.ToString().c_str(), O_RDONLY);
+    if (fd == -1) {
+        LOGE("map file {} failed: can't open", filename);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        LOGE("map file {} failed: file is empty", filename);
+        close(fd);
+        return;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping keeps the file alive
+    close(fd);
+    if (data == MAP_FAILED) {
+        LOGE("map file {} failed: mmap error {}", filename, errno);
+        return;
+    }
+
+    m_data = static_cast<const unsigned char*>(data);
+    m_size = st.st_size;
+}
+
+void MappedFile::release() {
+    if (m_data) {
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& o) noexcept {
+    *this = std::move(o);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& o) noexcept {
+    if (&o != this) {
+        release();
+        m_data = std::exchange(o.m_data, nullptr);
+        m_size = std::exchange(o.m_size, 0);
+#ifdef _WIN32
+        m_file = std::exchange(o.m_file, nullptr);
+        m_mapping = std::exchange(o.m_mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+bool MappedFile::IsValid() const noexcept {
+    return m_data != nullptr;
+}
+
+std::span<const unsigned char> MappedFile::GetData() const noexcept {
+    return {m_data, m_size};
+}
+
+}  // namespace nickel
@@ -22,6 +22,7 @@ public:
     ~StorageImpl();
 
     uint64_t GetFileSize(const Path& filename) const;
+    bool IsFileExists(const Path& filename) const;
     uint64_t GetRemainingSpacing() const;
     std::vector<char> ReadStorageFile(const Path& filename) const;
     bool ReadStorageFile(const Path& filename, void* buffer,
@@ -82,6 +83,13 @@ uint64_t StorageImpl::GetFileSize(const Path& filename) const {
     return static_cast<uint64_t>(length);
 }
 
+bool StorageImpl::IsFileExists(const Path& filename) const {
+    SDL_PathInfo info;
+    return SDL_GetStoragePathInfo(m_storage, filename.ToString().c_str(),
+                                  &info) &&
+           info.type == SDL_PATHTYPE_FILE;
+}
+
 uint64_t StorageImpl::GetRemainingSpacing() const {
     return static_cast<uint64_t>(SDL_GetStorageSpaceRemaining(m_storage));
 }
@@ -213,6 +221,10 @@ uint64_t ReadOnlyStorageBehavior::GetFileSize(
     return m_impl->GetFileSize(filename);
 }
 
+bool ReadOnlyStorageBehavior::IsFileExists(const Path& filename) const {
+    return m_impl->IsFileExists(filename);
+}
+
 uint64_t ReadOnlyStorageBehavior::GetRemainingSpacing() const {
     return m_impl->GetRemainingSpacing();
 }
@@ -0,0 +1,354 @@
+#include "nickel/graphics/animation.hpp"
+
+#include "nickel/common/macro.hpp"
+#include "nickel/common/thread_pool.hpp"
+#include "nickel/graphics/internal/gltf_model_impl.hpp"
+
+#include <cmath>
+#include <future>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define NICKEL_ANIMATION_SSE
+#endif
+
+namespace nickel::graphics {
+
+void SetJointTransform(std::span<JointTransform4> pose, uint32_t joint,
+                       const Vec3& translation, const Quat& rotation,
+                       const Vec3& scale) {
+    auto& block = pose[joint / 4];
+    uint32_t lane = joint % 4;
+    block.m_translation_x[lane] = translation.x;
+    block.m_translation_y[lane] = translation.y;
+    block.m_translation_z[lane] = translation.z;
+    block.m_rotation_x[lane] = rotation.v.x;
+    block.m_rotation_y[lane] = rotation.v.y;
+    block.m_rotation_z[lane] = rotation.v.z;
+    block.m_rotation_w[lane] = rotation.w;
+    block.m_scale_x[lane] = scale.x;
+    block.m_scale_y[lane] = scale.y;
+    block.m_scale_z[lane] = scale.z;
+}
+
+void GetJointTransform(std::span<const JointTransform4> pose, uint32_t joint,
+                       Vec3& out_translation, Quat& out_rotation,
+                       Vec3& out_scale) {
+    auto& block = pose[joint / 4];
+    uint32_t lane = joint % 4;
+    out_translation =
+        Vec3{block.m_translation_x[lane], block.m_translation_y[lane],
+             block.m_translation_z[lane]};
+    out_rotation = Quat{block.m_rotation_x[lane], block.m_rotation_y[lane],
+                        block.m_rotation_z[lane], block.m_rotation_w[lane]};
+    out_scale = Vec3{block.m_scale_x[lane], block.m_scale_y[lane],
+                     block.m_scale_z[lane]};
+}
+
+uint32_t AnimationClip::GetFrameCount() const noexcept {
+    uint32_t groups = GetJointGroupCount(m_joint_count);
+    return groups == 0 ? 0 : m_frames.size() / groups;
+}
+
+// frames around `time` and the blend factor between them
+static void findFrames(const AnimationClip& clip, float time, bool loop,
+                       uint32_t& out_frame0, uint32_t& out_frame1,
+                       float& out_t) {
+    uint32_t count = clip.GetFrameCount();
+    out_frame0 = out_frame1 = 0;
+    out_t = 0;
+    if (count < 2 || clip.m_duration <= 0) {
+        return;
+    }
+
+    if (loop) {
+        time = std::fmod(time, clip.m_duration);
+        if (time < 0) {
+            time += clip.m_duration;
+        }
+    } else {
+        time = std::clamp(time, 0.0f, clip.m_duration);
+    }
+    float position = time * clip.m_sample_rate;
+    out_frame0 = std::min<uint32_t>(position, count - 2);
+    out_frame1 = out_frame0 + 1;
+    out_t = std::clamp(position - out_frame0, 0.0f, 1.0f);
+}
+
+void SampleAnimationScalar(const AnimationClip& clip, float time, bool loop,
+                           std::span<JointTransform4> out_pose) {
+    uint32_t frame0, frame1;
+    float t;
+    findFrames(clip, time, loop, frame0, frame1, t);
+    uint32_t groups = GetJointGroupCount(clip.m_joint_count);
+    if (clip.m_frames.empty()) {
+        return;
+    }
+
+    auto lerp = [t](const float (&a)[4], const float (&b)[4],
+                    float (&dst)[4], size_t lane) {
+        dst[lane] = a[lane] + (b[lane] - a[lane]) * t;
+    };
+    for (uint32_t group = 0; group < groups; group++) {
+        auto& a = clip.m_frames[frame0 * groups + group];
+        auto& b = clip.m_frames[frame1 * groups + group];
+        auto& dst = out_pose[group];
+        for (size_t lane = 0; lane < 4; lane++) {
+            lerp(a.m_translation_x, b.m_translation_x, dst.m_translation_x,
+                 lane);
+            lerp(a.m_translation_y, b.m_translation_y, dst.m_translation_y,
+                 lane);
+            lerp(a.m_translation_z, b.m_translation_z, dst.m_translation_z,
+                 lane);
+            lerp(a.m_scale_x, b.m_scale_x, dst.m_scale_x, lane);
+            lerp(a.m_scale_y, b.m_scale_y, dst.m_scale_y, lane);
+            lerp(a.m_scale_z, b.m_scale_z, dst.m_scale_z, lane);
+
+            float dot = a.m_rotation_x[lane] * b.m_rotation_x[lane] +
+                        a.m_rotation_y[lane] * b.m_rotation_y[lane] +
+                        a.m_rotation_z[lane] * b.m_rotation_z[lane] +
+                        a.m_rotation_w[lane] * b.m_rotation_w[lane];
+            float sign = std::signbit(dot) ? -1.0f : 1.0f;
+            float q[4] = {a.m_rotation_x[lane], a.m_rotation_y[lane],
+                          a.m_rotation_z[lane], a.m_rotation_w[lane]};
+            float r[4] = {b.m_rotation_x[lane] * sign,
+                          b.m_rotation_y[lane] * sign,
+                          b.m_rotation_z[lane] * sign,
+                          b.m_rotation_w[lane] * sign};
+            float length = 0;
+            for (int i = 0; i < 4; i++) {
+                q[i] += (r[i] - q[i]) * t;
+                length += q[i] * q[i];
+            }
+            length = std::sqrt(length);
+            dst.m_rotation_x[lane] = q[0] / length;
+            dst.m_rotation_y[lane] = q[1] / length;
+            dst.m_rotation_z[lane] = q[2] / length;
+            dst.m_rotation_w[lane] = q[3] / length;
+        }
+    }
+}
+
+void SampleAnimation(const AnimationClip& clip, float time, bool loop,
+                     std::span<JointTransform4> out_pose) {
+#ifdef NICKEL_ANIMATION_SSE
+    uint32_t frame0, frame1;
+    float t;
+    findFrames(clip, time, loop, frame0, frame1, t);
+    uint32_t groups = GetJointGroupCount(clip.m_joint_count);
+    if (clip.m_frames.empty()) {
+        return;
+    }
+
+    __m128 factor = _mm_set1_ps(t);
+    auto lerp = [factor](const float* a, const float* b, float* dst) {
+        __m128 va = _mm_load_ps(a);
+        __m128 vb = _mm_load_ps(b);
+        _mm_store_ps(dst,
+                     _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), factor)));
+    };
+    __m128 sign_bit = _mm_set1_ps(-0.0f);
+
+    for (uint32_t group = 0; group < groups; group++) {
+        auto& a = clip.m_frames[frame0 * groups + group];
+        auto& b = clip.m_frames[frame1 * groups + group];
+        auto& dst = out_pose[group];
+        lerp(a.m_translation_x, b.m_translation_x, dst.m_translation_x);
+        lerp(a.m_translation_y, b.m_translation_y, dst.m_translation_y);
+        lerp(a.m_translation_z, b.m_translation_z, dst.m_translation_z);
+        lerp(a.m_scale_x, b.m_scale_x, dst.m_scale_x);
+        lerp(a.m_scale_y, b.m_scale_y, dst.m_scale_y);
+        lerp(a.m_scale_z, b.m_scale_z, dst.m_scale_z);
+
+        __m128 ax = _mm_load_ps(a.m_rotation_x);
+        __m128 ay = _mm_load_ps(a.m_rotation_y);
+        __m128 az = _mm_load_ps(a.m_rotation_z);
+        __m128 aw = _mm_load_ps(a.m_rotation_w);
+        __m128 bx = _mm_load_ps(b.m_rotation_x);
+        __m128 by = _mm_load_ps(b.m_rotation_y);
+        __m128 bz = _mm_load_ps(b.m_rotation_z);
+        __m128 bw = _mm_load_ps(b.m_rotation_w);
+
+        // flip b into the hemisphere of a for the shortest path
+        __m128 dot = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+            _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+        __m128 flip = _mm_and_ps(dot, sign_bit);
+        bx = _mm_xor_ps(bx, flip);
+        by = _mm_xor_ps(by, flip);
+        bz = _mm_xor_ps(bz, flip);
+        bw = _mm_xor_ps(bw, flip);
+
+        __m128 x = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), factor));
+        __m128 y = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), factor));
+        __m128 z = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), factor));
+        __m128 w = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), factor));
+        __m128 length = _mm_sqrt_ps(
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+                       _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(w, w))));
+        _mm_store_ps(dst.m_rotation_x, _mm_div_ps(x, length));
+        _mm_store_ps(dst.m_rotation_y, _mm_div_ps(y, length));
+        _mm_store_ps(dst.m_rotation_z, _mm_div_ps(z, length));
+        _mm_store_ps(dst.m_rotation_w, _mm_div_ps(w, length));
+    }
+#else
+    SampleAnimationScalar(clip, time, loop, out_pose);
+#endif
+}
+
+// translation * rotation * scale without full matrix products
+static Mat44 composeTRS(std::span<const JointTransform4> pose,
+                        uint32_t joint) {
+    Vec3 t, s;
+    Quat r;
+    GetJointTransform(pose, joint, t, r, s);
+    Mat44 m = r.ToMat();
+    for (int row = 0; row < 3; row++) {
+        m[0][row] *= s.x;
+        m[1][row] *= s.y;
+        m[2][row] *= s.z;
+    }
+    m[3] = Vec4{t.x, t.y, t.z, 1};
+    return m;
+}
+
+void ComputeJointPalette(const Skeleton& skeleton,
+                         std::span<const JointTransform4> pose,
+                         std::span<Mat44> out_palette) {
+    // global transforms first, children read the finished parent
+    for (auto joint : skeleton.m_order) {
+        int32_t parent = skeleton.m_parents[joint];
+        Mat44 local = composeTRS(pose, joint);
+        out_palette[joint] =
+            parent == -1 ? skeleton.m_root_transforms[joint] * local
+                         : out_palette[parent] * local;
+    }
+    for (uint32_t i = 0; i < skeleton.GetJointCount(); i++) {
+        out_palette[i] = out_palette[i] * skeleton.m_inverse_bind_matrices[i];
+    }
+}
+
+static const GLTFModelImpl* findSkinnedNode(const GLTFModelImpl& model) {
+    if (model.m_skin != -1 && model.m_resource) {
+        return &model;
+    }
+    for (auto& child : model.m_children) {
+        if (auto node = findSkinnedNode(*child.GetImpl())) {
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+Animator::Animator(const GLTFModel& model) : m_model{model} {
+    NICKEL_RETURN_IF_FALSE(model);
+    auto node = findSkinnedNode(*model.GetImpl());
+    NICKEL_RETURN_IF_FALSE_LOGW(node, "model {} has no skinned node",
+                                model.GetImpl()->m_name);
+    auto& skins = node->m_resource.GetImpl()->m_skins;
+    NICKEL_RETURN_IF_FALSE_LOGE(node->m_skin < (int32_t)skins.size(),
+                                "skin {} of {} out of range", node->m_skin,
+                                node->m_name);
+
+    m_skin_index = node->m_skin;
+    m_skin = &skins[m_skin_index];
+    auto& skeleton = m_skin->m_skeleton;
+    m_pose = skeleton.m_rest_pose;
+    m_palette.resize(skeleton.GetJointCount());
+    ComputeJointPalette(skeleton, m_pose, m_palette);
+}
+
+Animator::operator bool() const noexcept {
+    return m_skin;
+}
+
+std::vector<std::string> Animator::GetClipNames() const {
+    std::vector<std::string> names;
+    if (m_skin) {
+        for (auto& clip : m_skin->m_clips) {
+            names.push_back(clip.m_name);
+        }
+    }
+    return names;
+}
+
+bool Animator::Play(std::string_view clip_name, bool loop) {
+    if (!m_skin) {
+        return false;
+    }
+    for (uint32_t i = 0; i < m_skin->m_clips.size(); i++) {
+        if (m_skin->m_clips[i].m_name == clip_name) {
+            return Play(i, loop);
+        }
+    }
+    LOGW("animation clip {} not found", clip_name);
+    return false;
+}
+
+bool Animator::Play(uint32_t clip_index, bool loop) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(
+        false, m_skin && clip_index < m_skin->m_clips.size(),
+        "animation clip {} out of range", clip_index);
+    m_clip = &m_skin->m_clips[clip_index];
+    m_loop = loop;
+    m_time = 0;
+    return true;
+}
+
+void Animator::Stop() {
+    m_clip = nullptr;
+    m_time = 0;
+}
+
+void Animator::SetSpeed(float speed) {
+    m_speed = speed;
+}
+
+float Animator::GetTime() const noexcept {
+    return m_time;
+}
+
+void Animator::Update(float delta_time) {
+    if (!m_clip) {
+        return;
+    }
+    m_time += delta_time * m_speed;
+    SampleAnimation(*m_clip, m_time, m_loop, m_pose);
+    ComputeJointPalette(m_skin->m_skeleton, m_pose, m_palette);
+}
+
+std::span<const Mat44> Animator::GetJointPalette() const noexcept {
+    return m_palette;
+}
+
+int32_t Animator::GetSkinIndex() const noexcept {
+    return m_skin_index;
+}
+
+void UpdateAnimators(std::span<Animator* const> animators, float delta_time,
+                     ThreadPool* pool) {
+    uint32_t workers = pool ? pool->GetThreadNum() + 1 : 1;
+    size_t chunk = (animators.size() + workers - 1) / workers;
+    auto updateRange = [=](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            animators[i]->Update(delta_time);
+        }
+    };
+    if (workers == 1 || chunk == animators.size()) {
+        updateRange(0, animators.size());
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    for (size_t begin = chunk; begin < animators.size(); begin += chunk) {
+        futures.push_back(pool->Submit([=] {
+            updateRange(begin, std::min(begin + chunk, animators.size()));
+        }));
+    }
+    updateRange(0, std::min(chunk, animators.size()));
+    for (auto& future : futures) {
+        future.wait();
+    }
+}
+
+}  // namespace nickel::graphics
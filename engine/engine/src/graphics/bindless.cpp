@@ -0,0 +1,237 @@
+#include "nickel/graphics/internal/bindless.hpp"
+#include "nickel/common/log.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/lowlevel/adapter.hpp"
+
+namespace nickel::graphics {
+
+BindlessSlotAllocator::BindlessSlotAllocator(uint32_t capacity,
+                                             uint32_t reuse_delay)
+    : m_capacity{capacity}, m_reuse_delay{reuse_delay}, m_allocated(capacity) {}
+
+std::optional<uint32_t> BindlessSlotAllocator::Allocate() {
+    uint32_t slot;
+    if (!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+    } else if (m_next < m_capacity) {
+        slot = m_next++;
+    } else {
+        return std::nullopt;
+    }
+
+    m_allocated[slot] = true;
+    m_allocated_count++;
+    return slot;
+}
+
+void BindlessSlotAllocator::Free(uint32_t slot) {
+    NICKEL_RETURN_IF_FALSE_LOGW(slot < m_capacity && m_allocated[slot],
+                                "free unallocated bindless slot {}", slot);
+    m_allocated[slot] = false;
+    m_allocated_count--;
+    if (m_reuse_delay == 0) {
+        m_free_slots.push_back(slot);
+    } else {
+        m_pending_slots.push_back({slot, m_reuse_delay});
+    }
+}
+
+void BindlessSlotAllocator::EndFrame() {
+    for (size_t i = 0; i < m_pending_slots.size();) {
+        auto& pending = m_pending_slots[i];
+        if (--pending.m_frames_left == 0) {
+            m_free_slots.push_back(pending.m_slot);
+            pending = m_pending_slots.back();
+            m_pending_slots.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
+
+uint32_t BindlessSlotAllocator::GetCapacity() const noexcept {
+    return m_capacity;
+}
+
+uint32_t BindlessSlotAllocator::GetAllocatedCount() const noexcept {
+    return m_allocated_count;
+}
+
+bool BindlessTable::IsSupported(const Adapter& adapter) {
+    return adapter.GetFeatures().bindless &&
+           adapter.GetLimits().max_push_constants_size >=
+               MaterialIndexOffset + sizeof(uint32_t);
+}
+
+BindlessTable::BindlessTable(Device device)
+    : m_device{device},
+      m_image_slots{MaxImages, device.GetFramesInFlight()},
+      m_sampler_slots{MaxSamplers, device.GetFramesInFlight()},
+      m_material_slots{MaxMaterials, device.GetFramesInFlight()},
+      m_images(MaxImages),
+      m_samplers(MaxSamplers) {
+    initLayout();
+    initBindGroup();
+}
+
+void BindlessTable::initLayout() {
+    BindGroupLayout::Descriptor desc;
+
+    {
+        BindGroupLayout::Entry entry;
+        entry.m_shader_stage = ShaderStage::Fragment;
+        entry.m_array_size = MaxImages;
+        entry.m_type = BindGroupEntryType::SampledImage;
+        entry.m_bindless = true;
+        desc.m_entries[ImageBinding] = entry;
+    }
+
+    {
+        BindGroupLayout::Entry entry;
+        entry.m_shader_stage = ShaderStage::Fragment;
+        entry.m_array_size = MaxSamplers;
+        entry.m_type = BindGroupEntryType::Sampler;
+        entry.m_bindless = true;
+        desc.m_entries[SamplerBinding] = entry;
+    }
+
+    {
+        BindGroupLayout::Entry entry;
+        entry.m_shader_stage = ShaderStage::Fragment;
+        entry.m_array_size = 1;
+        entry.m_type = BindGroupEntryType::StorageBuffer;
+        desc.m_entries[MaterialBinding] = entry;
+    }
+
+    m_layout = m_device.CreateBindGroupLayout(desc);
+}
+
+void BindlessTable::initBindGroup() {
+    Buffer::Descriptor buffer_desc;
+    buffer_desc.m_memory_type = MemoryType::Coherence;
+    buffer_desc.m_size = sizeof(BindlessMaterial) * MaxMaterials;
+    buffer_desc.m_usage = BufferUsage::Storage;
+    m_material_buffer = m_device.CreateBuffer(buffer_desc);
+
+    // image & sampler arrays are partially bound, written on acquire
+    BindGroup::Descriptor desc;
+    BindGroup::Entry entry;
+    BindGroup::BufferBinding binding;
+    binding.m_buffer = m_material_buffer;
+    binding.m_type = BindGroup::BufferBinding::Type::Storage;
+    entry.m_binding.m_entry = binding;
+    entry.m_shader_stage = ShaderStage::Fragment;
+    entry.m_array_size = 1;
+    desc.m_entries[MaterialBinding] = entry;
+    m_bind_group = m_layout.RequireBindGroup(desc);
+}
+
+BindGroupLayout BindlessTable::GetBindGroupLayout() const {
+    return m_layout;
+}
+
+BindGroup& BindlessTable::GetBindGroup() {
+    return m_bind_group;
+}
+
+uint32_t BindlessTable::AcquireImage(const ImageView& view) {
+    if (auto it = m_image_indices.find(view.GetImpl());
+        it != m_image_indices.end()) {
+        m_images[it->second].m_refcount++;
+        return it->second;
+    }
+
+    auto slot = m_image_slots.Allocate();
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(InvalidSlot, slot,
+                                      "bindless image table is full ({})",
+                                      MaxImages);
+    m_image_indices.emplace(view.GetImpl(), *slot);
+    m_images[*slot] = {view, 1};
+
+    BindGroup::ImageBinding binding;
+    binding.m_type = BindGroup::ImageBinding::Type::Image;
+    binding.m_view = view;
+    m_bind_group.UpdateArrayElement(ImageBinding, *slot, {binding});
+    return *slot;
+}
+
+void BindlessTable::ReleaseImage(uint32_t slot) {
+    NICKEL_RETURN_IF_FALSE(slot != InvalidSlot);
+    auto& image = m_images[slot];
+    if (--image.m_refcount == 0) {
+        m_image_indices.erase(image.m_resource.GetImpl());
+        image.m_resource = {};
+        m_image_slots.Free(slot);
+    }
+}
+
+uint32_t BindlessTable::AcquireSampler(const Sampler& sampler) {
+    if (auto it = m_sampler_indices.find(sampler.GetImpl());
+        it != m_sampler_indices.end()) {
+        m_samplers[it->second].m_refcount++;
+        return it->second;
+    }
+
+    auto slot = m_sampler_slots.Allocate();
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(InvalidSlot, slot,
+                                      "bindless sampler table is full ({})",
+                                      MaxSamplers);
+    m_sampler_indices.emplace(sampler.GetImpl(), *slot);
+    m_samplers[*slot] = {sampler, 1};
+
+    BindGroup::SamplerBinding binding;
+    binding.m_sampler = sampler;
+    m_bind_group.UpdateArrayElement(SamplerBinding, *slot, {binding});
+    return *slot;
+}
+
+void BindlessTable::ReleaseSampler(uint32_t slot) {
+    NICKEL_RETURN_IF_FALSE(slot != InvalidSlot);
+    auto& sampler = m_samplers[slot];
+    if (--sampler.m_refcount == 0) {
+        m_sampler_indices.erase(sampler.m_resource.GetImpl());
+        sampler.m_resource = {};
+        m_sampler_slots.Free(slot);
+    }
+}
+
+uint32_t BindlessTable::AddMaterial(const BindlessMaterial& material) {
+    auto index = m_material_slots.Allocate();
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(InvalidSlot, index,
+                                      "bindless material table is full ({})",
+                                      MaxMaterials);
+    UpdateMaterial(*index, material);
+    return *index;
+}
+
+void BindlessTable::UpdateMaterial(uint32_t index,
+                                   const BindlessMaterial& material) {
+    NICKEL_RETURN_IF_FALSE(index != InvalidSlot);
+    uint64_t offset = index * sizeof(BindlessMaterial);
+    m_material_buffer.MapAsync();
+    memcpy(m_material_buffer.GetMappedRange(offset), &material,
+           sizeof(material));
+    m_material_buffer.Unmap();
+}
+
+void BindlessTable::RemoveMaterial(uint32_t index) {
+    NICKEL_RETURN_IF_FALSE(index != InvalidSlot);
+    m_material_slots.Free(index);
+}
+
+void BindlessTable::UseImages(RenderPassEncoder& encoder) {
+    for (auto& image : m_images) {
+        if (image.m_resource) {
+            encoder.UseImage(image.m_resource);
+        }
+    }
+}
+
+void BindlessTable::EndFrame() {
+    m_image_slots.EndFrame();
+    m_sampler_slots.EndFrame();
+    m_material_slots.EndFrame();
+}
+
+}  // namespace nickel::graphics
@@ -9,6 +9,7 @@ CommonResource::CommonResource(Device device, const video::Window& window) {
     initRenderPass(device);
     InitFramebuffers(device);
     initSyncObjects(device);
+    InitPresentSemaphores(device);
     initCameraBuffer(device);
     initDefaultResources(device);
 }
@@ -25,10 +26,6 @@ Semaphore& CommonResource::GetImageAvaliableSemaphore(uint32_t idx) {
     return m_image_avaliable_sems[idx];
 }
 
-Semaphore& CommonResource::GetRenderFinishSemaphore(uint32_t idx) {
-    return m_render_finish_sems[idx];
-}
-
 Semaphore& CommonResource::GetImGuiRenderFinishSemaphore(uint32_t idx) {
     return m_imgui_render_finish_sems[idx];
 }
@@ -37,15 +34,23 @@ Fence& CommonResource::GetFence(uint32_t idx) {
     return m_present_fences[idx];
 }
 
-void CommonResource::Begin() {
+void CommonResource::Begin(uint32_t frame) {
+    // slices of other frames in flight may still be read by GPU
+    m_frame_uniform_offset = frame * FrameUniformStride;
+
     m_camera_buffer.MapAsync();
     auto& camera = nickel::Context::GetInst().GetCamera();
-    memcpy(m_camera_buffer.GetMappedRange(), camera.GetProject().Ptr(),
-           sizeof(Mat44));
+    memcpy((char*)m_camera_buffer.GetMappedRange() + m_frame_uniform_offset,
+           camera.GetProject().Ptr(), sizeof(Mat44));
 
     m_view_buffer.MapAsync();
     Vec3 pos = camera.GetPosition();
-    memcpy(m_view_buffer.GetMappedRange(), pos.Ptr(), sizeof(Vec3));
+    memcpy((char*)m_view_buffer.GetMappedRange() + m_frame_uniform_offset,
+           pos.Ptr(), sizeof(Vec3));
+}
+
+uint32_t CommonResource::GetFrameUniformOffset() const {
+    return m_frame_uniform_offset;
 }
 
 void CommonResource::End() {
@@ -102,7 +107,8 @@ void CommonResource::initRenderPass(Device& device) {
     {
         RenderPass::Descriptor::AttachmentDescription attachment;
         attachment.m_samples = SampleCount::Count1;
-        attachment.m_initial_layout = ImageLayout::Undefined;
+        // render graph transitions attachments before & after the pass
+        attachment.m_initial_layout = ImageLayout::ColorAttachmentOptimal;
         attachment.m_final_layout = ImageLayout::ColorAttachmentOptimal;
         attachment.m_load_op = AttachmentLoadOp::Clear;
         attachment.m_store_op = AttachmentStoreOp::Store;
@@ -116,7 +122,8 @@ void CommonResource::initRenderPass(Device& device) {
     {
         RenderPass::Descriptor::AttachmentDescription attachment;
         attachment.m_samples = SampleCount::Count1;
-        attachment.m_initial_layout = ImageLayout::Undefined;
+        attachment.m_initial_layout =
+            ImageLayout::DepthStencilAttachmentOptimal;
         attachment.m_final_layout = ImageLayout::DepthStencilAttachmentOptimal;
         attachment.m_load_op = AttachmentLoadOp::Clear;
         attachment.m_store_op = AttachmentStoreOp::Store;
@@ -157,12 +164,18 @@ void CommonResource::initRenderPass(Device& device) {
 }
 
 void CommonResource::initSyncObjects(Device& device) {
-    uint32_t swapchain_image_count =
-        device.GetSwapchainImageInfo().m_image_count;
-    for (uint32_t i = 0; i < swapchain_image_count; i++) {
+    for (uint32_t i = 0; i < device.GetFramesInFlight(); i++) {
         m_present_fences.push_back(device.CreateFence(true));
         m_image_avaliable_sems.push_back(device.CreateSemaphore());
-        m_render_finish_sems.push_back(device.CreateSemaphore());
+    }
+}
+
+void CommonResource::InitPresentSemaphores(Device& device) {
+    // only grows, old semaphores may still be pending in present
+    uint32_t swapchain_image_count =
+        device.GetSwapchainImageInfo().m_image_count;
+    for (uint32_t i = m_imgui_render_finish_sems.size();
+         i < swapchain_image_count; i++) {
         m_imgui_render_finish_sems.push_back(device.CreateSemaphore());
     }
 }
@@ -172,6 +185,8 @@ void CommonResource::initDefaultResources(Device& device) {
         Sampler::Descriptor desc;
         desc.m_min_filter = Filter::Linear;
         desc.m_mag_filter = Filter::Linear;
+        desc.m_mipmap_mode = SamplerMipmapMode::Linear;
+        desc.m_max_lod = 1000.0f;  // VK_LOD_CLAMP_NONE, sample all mip levels
         desc.m_address_mode_w = SamplerAddressMode::Repeat;
         desc.m_address_mode_u = SamplerAddressMode::Repeat;
         desc.m_address_mode_v = SamplerAddressMode::Repeat;
@@ -188,17 +203,15 @@ void CommonResource::initCameraBuffer(Device& device) {
     {
         Buffer::Descriptor desc;
         desc.m_memory_type = MemoryType::Coherence;
-        desc.m_size = sizeof(Mat44);
+        desc.m_size = FrameUniformStride * device.GetFramesInFlight();
         desc.m_usage = BufferUsage::Uniform;
-        Buffer buffer = device.CreateBuffer(desc);
         m_camera_buffer = device.CreateBuffer(desc);
-        Buffer buffer2 = device.CreateBuffer(desc);
     }
 
     {
         Buffer::Descriptor desc;
         desc.m_memory_type = MemoryType::Coherence;
-        desc.m_size = sizeof(Vec3);
+        desc.m_size = FrameUniformStride * device.GetFramesInFlight();
         desc.m_usage = BufferUsage::Uniform;
         m_view_buffer = device.CreateBuffer(desc);
     }
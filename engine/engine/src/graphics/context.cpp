@@ -46,14 +46,36 @@ void Context::SetDepthClearValue(float depth, uint32_t stencil) {
     m_impl->SetDepthClearValue(depth, stencil);
 }
 
-void Context::DrawModel(const Transform& transform, const GLTFModel& model) {
-    m_impl->DrawModel(transform, model);
+void Context::DrawModel(const Transform& transform, const GLTFModel& model,
+                        LODState* lod_state) {
+    m_impl->DrawModel(transform, model, lod_state);
+}
+
+void Context::DrawModel(const Transform& transform, const GLTFModel& model,
+                        const Animator& animator, LODState* lod_state) {
+    m_impl->DrawModel(transform, model, animator, lod_state);
 }
 
 void Context::EnableWireFrame(bool enable) const {
     m_impl->EnableWireFrame(enable);
 }
 
+void Context::ShowGPUProfiler(bool show) {
+    m_impl->ShowGPUProfiler(show);
+}
+
+void Context::ShowPhysicsProfiler(bool show) {
+    m_impl->ShowPhysicsProfiler(show);
+}
+
+void Context::RecordInput(uint64_t timestamp_ns) {
+    m_impl->RecordInput(timestamp_ns);
+}
+
+const FrameLatencyTracker& Context::GetLatency() const {
+    return m_impl->GetLatency();
+}
+
 void Context::OnSwapchainRecreate(const video::Window& window,
                                   Adapter& adapter) {
     m_impl->OnSwapchainRecreate(window, adapter);
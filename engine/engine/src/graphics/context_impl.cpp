@@ -13,7 +13,7 @@ ContextImpl::ContextImpl(const Adapter& adapter, const video::Window& window,
       m_primitive_draw{adapter.GetDevice(), storage_mgr,
                        m_common_resource.m_render_pass, m_common_resource},
       m_imgui_draw{window, adapter},
-      m_gltf_draw{adapter.GetDevice(), m_common_resource} {}
+      m_gltf_draw{adapter, m_common_resource} {}
 
 void ContextImpl::EnableRender(bool enable) {
     m_enable_render = enable;
@@ -33,18 +33,23 @@ void ContextImpl::BeginFrame() {
 
     NICKEL_RETURN_IF_FALSE(ShouldRender());
 
-    Fence fence = m_common_resource.GetFence(m_render_frame_index);
+    // input is sampled before waiting the frame in flight, so the wait counts
+    m_latency.BeginFrame(SDL_GetTicksNS());
 
     auto device = nickel::Context::GetInst().GetGPUAdapter().GetDevice();
+    m_render_frame_index = device.GetCurrentFrameIndex();
+    Fence fence = m_common_resource.GetFence(m_render_frame_index);
     m_swapchain_image_index = device.WaitAndAcquireSwapchainImageIndex(
         m_common_resource.GetImageAvaliableSemaphore(m_render_frame_index),
         std::span{&fence, 1});
 
-    m_common_resource.Begin();
+    m_common_resource.Begin(m_render_frame_index);
     m_primitive_draw.Begin();
 }
 
 void ContextImpl::EndFrame() {
+    drawGPUProfiler();
+    drawPhysicsProfiler();
     m_imgui_draw.PrepareForRender();
 
     NICKEL_RETURN_IF_FALSE(ShouldRender());
@@ -52,7 +57,71 @@ void ContextImpl::EndFrame() {
     auto& ctx = nickel::Context::GetInst();
     Device device = ctx.GetGPUAdapter().GetDevice();
 
+    // render passes keep attachments in the layouts the graph moved them to,
+    // every transition is a barrier recorded from the graph
     CommandEncoder encoder = device.CreateCommandEncoder();
+    m_render_graph.Clear();
+    m_graph_images.clear();
+    auto backbuffer = m_render_graph.ImportImage(
+        "backbuffer", ImageLayout::Undefined, ImageLayout::PresentSrcKHR);
+    m_graph_images.push_back(
+        device.GetSwapchainImageViews()[m_swapchain_image_index]);
+    auto depth = m_render_graph.ImportImage("depth", ImageLayout::Undefined);
+    m_graph_images.push_back(
+        m_common_resource.GetDepthImageView(m_swapchain_image_index));
+    m_render_graph.AddPass("scene", [&] { recordScenePass(device, encoder); })
+        .Write(backbuffer, RenderGraphAccess::ColorAttachment)
+        .Write(depth, RenderGraphAccess::DepthStencilAttachment);
+    m_render_graph
+        .AddPass("imgui",
+                 [&] {
+                     m_imgui_draw.End(device, encoder,
+                                      m_swapchain_image_index);
+                 })
+        .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+    m_render_graph.Compile();
+    m_render_graph.Execute(
+        [&](RenderGraph::PassHandle,
+            std::span<const RenderGraphBarrier> barriers) {
+            RecordRenderGraphBarriers(encoder, barriers, m_graph_images);
+        });
+
+    auto cmd = encoder.Finish();
+    device.Submit(
+        cmd,
+        std::span{
+            &m_common_resource.GetImageAvaliableSemaphore(m_render_frame_index),
+            1},
+        std::span{&m_common_resource.GetImGuiRenderFinishSemaphore(
+                      m_swapchain_image_index),
+                  1},
+        m_common_resource.GetFence(m_render_frame_index));
+
+    device.Present(std::span{&m_common_resource.GetImGuiRenderFinishSemaphore(
+                                 m_swapchain_image_index),
+                             1});
+    m_latency.Present(SDL_GetTicksNS());
+    device.EndFrame();
+
+    m_gltf_draw.End();
+    m_common_resource.End();
+}
+
+void ContextImpl::RecordInput(uint64_t timestamp_ns) {
+    m_latency.RecordInput(timestamp_ns);
+}
+
+const FrameLatencyTracker& ContextImpl::GetLatency() const {
+    return m_latency;
+}
+
+const RenderGraph& ContextImpl::GetRenderGraph() const {
+    return m_render_graph;
+}
+
+void ContextImpl::recordScenePass(Device& device, CommandEncoder& encoder) {
+    auto& ctx = nickel::Context::GetInst();
+    encoder.BeginProfileScope("scene");
 
     if (m_primitive_draw.NeedDraw()) {
         m_primitive_draw.UploadData2GPU(device);
@@ -70,39 +139,19 @@ void ContextImpl::EndFrame() {
     render_pass_encoder.SetScissor(0, 0, rect.size.w, rect.size.h);
 
     if (m_primitive_draw.NeedDraw()) {
+        render_pass_encoder.BeginProfileScope("primitive");
         m_primitive_draw.ApplyDrawCall(render_pass_encoder);
+        render_pass_encoder.EndProfileScope();
     }
 
     if (m_gltf_draw.NeedDraw()) {
+        render_pass_encoder.BeginProfileScope("gltf");
         m_gltf_draw.ApplyDrawCall(render_pass_encoder, m_is_wireframe);
+        render_pass_encoder.EndProfileScope();
     }
 
     render_pass_encoder.End();
-
-    auto cmd = encoder.Finish();
-    device.Submit(
-        cmd,
-        std::span{
-            &m_common_resource.GetImageAvaliableSemaphore(m_render_frame_index),
-            1},
-        std::span{
-            &m_common_resource.GetRenderFinishSemaphore(m_render_frame_index),
-            1},
-        {});
-
-    m_imgui_draw.End(device, m_common_resource, m_swapchain_image_index,
-                     m_render_frame_index);
-
-    device.Present(std::span{
-        &m_common_resource.GetImGuiRenderFinishSemaphore(m_render_frame_index),
-        1});
-    device.EndFrame();
-
-    m_gltf_draw.End();
-    m_common_resource.End();
-
-    m_render_frame_index = (m_render_frame_index + 1) %
-                           device.GetSwapchainImageInfo().m_image_count;
+    encoder.EndProfileScope();
 }
 
 void ContextImpl::DrawLineList(std::span<Vertex> vertices) {
@@ -119,11 +168,18 @@ void ContextImpl::DrawTriangleList(std::span<Vertex> vertices,
     m_primitive_draw.DrawTriangleList(vertices, indices, wireframe);
 }
 
-void ContextImpl::DrawModel(const Transform& transform,
-                            const GLTFModel& model) {
+void ContextImpl::DrawModel(const Transform& transform, const GLTFModel& model,
+                            LODState* lod_state) {
     NICKEL_RETURN_IF_FALSE(ShouldRender());
 
-    m_gltf_draw.RenderModel(transform, model);
+    m_gltf_draw.RenderModel(transform, model, lod_state);
+}
+
+void ContextImpl::DrawModel(const Transform& transform, const GLTFModel& model,
+                            const Animator& animator, LODState* lod_state) {
+    NICKEL_RETURN_IF_FALSE(ShouldRender());
+
+    m_gltf_draw.RenderModel(transform, model, animator, lod_state);
 }
 
 void ContextImpl::SetClearColor(const Color& color) {
@@ -138,6 +194,118 @@ void ContextImpl::EnableWireFrame(bool enable) {
     m_is_wireframe = enable;
 }
 
+void ContextImpl::ShowGPUProfiler(bool show) {
+    m_show_gpu_profiler = show;
+}
+
+void ContextImpl::ShowPhysicsProfiler(bool show) {
+    m_show_physics_profiler = show;
+}
+
+void ContextImpl::drawPhysicsProfiler() {
+    NICKEL_RETURN_IF_FALSE(m_show_physics_profiler);
+
+    if (!ImGui::Begin("Physics Profiler", &m_show_physics_profiler)) {
+        ImGui::End();
+        return;
+    }
+
+    auto& physics = nickel::Context::GetInst().GetPhysicsContext();
+    if (physics.GetInstrumentationConfig().m_mode !=
+        physics::InstrumentationMode::Profile) {
+        ImGui::TextUnformatted(
+            "set mode = \"profile\" in nickel_physics_instrumentation.toml");
+        ImGui::End();
+        return;
+    }
+
+    physics.GetStepTimings(m_physics_timings);
+    if (m_physics_timings.empty()) {
+        ImGui::TextUnformatted("no physics step yet");
+        ImGui::End();
+        return;
+    }
+
+    auto& first = m_physics_timings.front();
+    int count = m_physics_timings.size();
+    double first_step = first.m_step;
+    constexpr int stride = sizeof(physics::PhysicsStepTiming);
+    if (ImPlot::BeginPlot("##physics times", ImVec2(-1, 200))) {
+        ImPlot::SetupAxes("step", "ms", ImPlotAxisFlags_AutoFit,
+                          ImPlotAxisFlags_AutoFit);
+        ImPlot::PlotLine("total", &first.m_total, count, 1, first_step, 0, 0,
+                         stride);
+        ImPlot::PlotLine("broadphase", &first.m_broadphase, count, 1,
+                         first_step, 0, 0, stride);
+        ImPlot::PlotLine("narrowphase", &first.m_narrowphase, count, 1,
+                         first_step, 0, 0, stride);
+        ImPlot::PlotLine("solver", &first.m_solver, count, 1, first_step, 0,
+                         0, stride);
+        ImPlot::EndPlot();
+    }
+
+    auto& last = m_physics_timings.back();
+    ImGui::Text(
+        "step %llu: total %.3f ms, broadphase %.3f, narrowphase %.3f, "
+        "solver %.3f",
+        (unsigned long long)last.m_step, last.m_total, last.m_broadphase,
+        last.m_narrowphase, last.m_solver);
+    ImGui::End();
+}
+
+void ContextImpl::drawGPUProfiler() {
+    NICKEL_RETURN_IF_FALSE(m_show_gpu_profiler);
+
+    GPUProfiler profiler =
+        nickel::Context::GetInst().GetGPUAdapter().GetDevice().GetGPUProfiler();
+    if (!ImGui::Begin("GPU Profiler", &m_show_gpu_profiler)) {
+        ImGui::End();
+        return;
+    }
+
+    auto latency = m_latency.GetStats();
+    ImGui::Text("input to present: %.2f ms, avg %.2f, p95 %.2f, max %.2f",
+                latency.m_last_ms, latency.m_average_ms, latency.m_p95_ms,
+                latency.m_max_ms);
+
+    if (!profiler.IsSupported()) {
+        ImGui::TextUnformatted("timestamp queries not supported");
+        ImGui::End();
+        return;
+    }
+
+    bool statistics = profiler.IsPipelineStatisticsEnabled();
+    if (profiler.IsPipelineStatisticsSupported() &&
+        ImGui::Checkbox("pipeline statistics", &statistics)) {
+        profiler.EnablePipelineStatistics(statistics);
+    }
+
+    auto& history = profiler.GetHistory();
+    if (ImPlot::BeginPlot("##gpu times", ImVec2(-1, 200))) {
+        ImPlot::SetupAxes("frame", "ms", ImPlotAxisFlags_AutoFit,
+                          ImPlotAxisFlags_AutoFit);
+        for (auto& name : history.GetScopeNames()) {
+            auto times = history.GetTimes(name);
+            ImPlot::PlotLine(name.c_str(), times.data(), times.size());
+        }
+        ImPlot::EndPlot();
+    }
+
+    for (auto& scope : profiler.GetLastProfile().m_scopes) {
+        int indent = scope.m_depth * 2;
+        ImGui::Text("%*s%s: %.3f ms", indent, "", scope.m_name.c_str(),
+                    scope.m_time_ms);
+        if (auto& s = scope.m_statistics) {
+            ImGui::Text("%*s  primitives %llu/%llu, vs %llu, fs %llu", indent,
+                        "", (unsigned long long)s->m_clipping_primitives,
+                        (unsigned long long)s->m_input_assembly_primitives,
+                        (unsigned long long)s->m_vertex_invocations,
+                        (unsigned long long)s->m_fragment_invocations);
+        }
+    }
+    ImGui::End();
+}
+
 GLTFRenderPass& ContextImpl::GetGLTFRenderPass() {
     return m_gltf_draw;
 }
@@ -157,10 +325,9 @@ void ContextImpl::OnSwapchainRecreate(const video::Window& window,
     m_imgui_draw.DestroyFramebuffers();
     m_common_resource.m_depth_image_views.clear();
     m_common_resource.m_depth_images.clear();
-    device_impl.m_framebuffer_allocator.GC();
     device_impl.m_swapchain_image_views.clear();
-    device_impl.m_image_view_allocator.GC();
-    device_impl.m_image_allocator.GC();
+    // GPU is idle, views must be gone before their swapchain
+    device_impl.ReleaseAllGarbage();
     vkDestroySwapchainKHR(device_impl.m_device, device_impl.m_swapchain,
                           nullptr);
     vkDestroySurfaceKHR(adapter_impl.m_instance, adapter_impl.m_surface,
@@ -170,6 +337,7 @@ void ContextImpl::OnSwapchainRecreate(const video::Window& window,
     adapter.GetImpl().CreateSurface(window.GetImpl());
     device_impl.RecreateSwapchain(adapter.GetImpl().m_phy_device, window_size,
                                   adapter.GetImpl().m_surface);
+    m_common_resource.InitPresentSemaphores(device);
     m_common_resource.InitDepthImages(device, window_size);
     m_common_resource.InitFramebuffers(device);
     m_imgui_draw.InitFramebuffers(device);
@@ -0,0 +1,617 @@
+#include "nickel/graphics/internal/cooked_model.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+#include "nickel/graphics/internal/ktx2.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+
+#include <fstream>
+
+namespace nickel::graphics {
+
+static_assert(std::is_trivially_copyable_v<CookedModelHeader> &&
+              std::is_trivially_copyable_v<CookedNode> &&
+              std::is_trivially_copyable_v<CookedMesh> &&
+              std::is_trivially_copyable_v<CookedPrimitive> &&
+              std::is_trivially_copyable_v<CookedPrimitiveLOD> &&
+              std::is_trivially_copyable_v<CookedMeshlet> &&
+              std::is_trivially_copyable_v<CookedMaterial> &&
+              std::is_trivially_copyable_v<CookedImage> &&
+              std::is_trivially_copyable_v<CookedSampler>);
+static_assert(sizeof(Mat44) == sizeof(CookedNode::m_transform));
+
+CookedModelView::CookedModelView(std::span<const unsigned char> data)
+    : m_data{data} {
+    m_valid = validate();
+}
+
+template <typename T>
+std::span<const T> CookedModelView::getSection(CookedSection section) const {
+    auto& header = *reinterpret_cast<const CookedModelHeader*>(m_data.data());
+    auto& range = header.m_sections[static_cast<uint32_t>(section)];
+    return {reinterpret_cast<const T*>(m_data.data() + range.m_offset),
+            range.m_size / sizeof(T)};
+}
+
+bool CookedModelView::validate() const {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false, m_data.size() >= sizeof(CookedModelHeader),
+        "cooked model too small");
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false,
+        reinterpret_cast<uintptr_t>(m_data.data()) % alignof(CookedModelHeader) == 0,
+        "cooked model data is not aligned");
+
+    auto& header = *reinterpret_cast<const CookedModelHeader*>(m_data.data());
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false,
+                                      header.m_magic == CookedModelMagic,
+                                      "not a cooked model");
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false, header.m_version == CookedModelVersion,
+        "cooked model version {} mismatch, expect {}, re-cook the model",
+        header.m_version, CookedModelVersion);
+
+    for (auto& range : header.m_sections) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false,
+            range.m_offset % CookedModelAlignment == 0 &&
+                range.m_offset <= m_data.size() &&
+                range.m_size <= m_data.size() - range.m_offset,
+            "cooked model section out of range");
+    }
+
+    auto sectionFits = [&](CookedSection section, size_t elem_size) {
+        return header.m_sections[static_cast<uint32_t>(section)].m_size %
+                   elem_size ==
+               0;
+    };
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false,
+        sectionFits(CookedSection::Nodes, sizeof(CookedNode)) &&
+            sectionFits(CookedSection::NodeChildren, sizeof(uint32_t)) &&
+            sectionFits(CookedSection::RootNodes, sizeof(uint32_t)) &&
+            sectionFits(CookedSection::Meshes, sizeof(CookedMesh)) &&
+            sectionFits(CookedSection::Primitives, sizeof(CookedPrimitive)) &&
+            sectionFits(CookedSection::PrimitiveLODs,
+                        sizeof(CookedPrimitiveLOD)) &&
+            sectionFits(CookedSection::Meshlets, sizeof(CookedMeshlet)) &&
+            sectionFits(CookedSection::Materials, sizeof(CookedMaterial)) &&
+            sectionFits(CookedSection::Images, sizeof(CookedImage)) &&
+            sectionFits(CookedSection::Samplers, sizeof(CookedSampler)),
+        "cooked model section size mismatch");
+
+    auto strings = getSection<char>(CookedSection::Strings);
+    auto stringFits = [&](const CookedString& str) {
+        return str.m_offset <= strings.size() &&
+               str.m_size <= strings.size() - str.m_offset;
+    };
+
+    auto nodes = getSection<CookedNode>(CookedSection::Nodes);
+    auto children = getSection<uint32_t>(CookedSection::NodeChildren);
+    auto meshes = getSection<CookedMesh>(CookedSection::Meshes);
+    auto primitives = getSection<CookedPrimitive>(CookedSection::Primitives);
+    auto lods = getSection<CookedPrimitiveLOD>(CookedSection::PrimitiveLODs);
+    auto meshlets = getSection<CookedMeshlet>(CookedSection::Meshlets);
+    auto materials = getSection<CookedMaterial>(CookedSection::Materials);
+    auto images = getSection<CookedImage>(CookedSection::Images);
+    auto samplers = getSection<CookedSampler>(CookedSection::Samplers);
+    uint64_t vertex_size =
+        header.m_sections[static_cast<uint32_t>(CookedSection::VertexData)]
+            .m_size;
+    uint64_t index_size =
+        header.m_sections[static_cast<uint32_t>(CookedSection::IndexData)]
+            .m_size;
+
+    for (auto& node : nodes) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false,
+            stringFits(node.m_name) && node.m_mesh >= -1 &&
+                node.m_mesh < (int32_t)meshes.size() &&
+                node.m_first_child <= children.size() &&
+                node.m_child_count <= children.size() - node.m_first_child,
+            "cooked model has broken node");
+    }
+    // node walks recurse from the roots, so every node may be referenced at
+    // most once (as a root or a child). A walk then can't meet a cycle
+    std::vector<bool> node_referenced(nodes.size());
+    auto referenceNode = [&](uint32_t node) {
+        if (node >= nodes.size() || node_referenced[node]) {
+            return false;
+        }
+        node_referenced[node] = true;
+        return true;
+    };
+    for (auto child : children) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, referenceNode(child),
+                                          "cooked model has broken node");
+    }
+    for (auto root : getSection<uint32_t>(CookedSection::RootNodes)) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, referenceNode(root),
+                                          "cooked model has broken node");
+    }
+    for (auto& mesh : meshes) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false,
+            stringFits(mesh.m_name) &&
+                mesh.m_first_primitive <= primitives.size() &&
+                mesh.m_primitive_count <=
+                    primitives.size() - mesh.m_first_primitive,
+            "cooked model has broken mesh");
+    }
+
+    auto viewFits = [](const CookedBufferView& view, uint64_t size) {
+        return view.m_offset <= size && view.m_size <= size - view.m_offset;
+    };
+    // index values are used to address vertices on the GPU, check them all
+    auto index_data = GetIndexData();
+    auto indicesFit = [&](const CookedPrimitive& prim,
+                          const CookedBufferView& view) {
+        if (!viewFits(view, index_size)) {
+            return false;
+        }
+        uint32_t stride =
+            prim.m_index_type == static_cast<uint32_t>(IndexType::Uint16) ? 2
+                                                                          : 4;
+        if (view.m_size < uint64_t(view.m_count) * stride) {
+            return false;
+        }
+        auto data = index_data.data() + view.m_offset;
+        for (uint32_t i = 0; i < view.m_count; i++) {
+            uint32_t index = 0;
+            memcpy(&index, data + i * stride, stride);
+            if (index >= prim.m_vertices.m_count) {
+                return false;
+            }
+        }
+        return true;
+    };
+    for (auto& prim : primitives) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false,
+            viewFits(prim.m_vertices, vertex_size) &&
+                prim.m_vertex_layout <=
+                    static_cast<uint32_t>(VertexLayout::Quantized) &&
+                prim.m_vertices.m_size >=
+                    uint64_t(prim.m_vertices.m_count) *
+                        GetVertexStride(
+                            static_cast<VertexLayout>(prim.m_vertex_layout)) &&
+                viewFits(prim.m_indices, index_size) &&
+                prim.m_index_type <= static_cast<uint32_t>(IndexType::Uint32) &&
+                indicesFit(prim, prim.m_indices) && prim.m_material >= -1 &&
+                prim.m_material < (int32_t)materials.size() &&
+                prim.m_first_lod <= lods.size() &&
+                prim.m_lod_count <= lods.size() - prim.m_first_lod &&
+                prim.m_first_meshlet <= meshlets.size() &&
+                prim.m_meshlet_count <= meshlets.size() - prim.m_first_meshlet,
+            "cooked model has broken primitive");
+        for (auto& meshlet : GetMeshlets(prim)) {
+            NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+                false,
+                meshlet.m_first_index <= prim.m_indices.m_count &&
+                    meshlet.m_index_count <=
+                        prim.m_indices.m_count - meshlet.m_first_index,
+                "cooked model has broken meshlet");
+        }
+    }
+    for (auto& lod : lods) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false,
+                                          viewFits(lod.m_indices, index_size),
+                                          "cooked model has broken LOD");
+    }
+    for (auto& prim : primitives) {
+        for (auto& lod : GetPrimitiveLODs(prim)) {
+            NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+                false, indicesFit(prim, lod.m_indices),
+                "cooked model has broken LOD");
+        }
+    }
+
+    auto textureFits = [&](const CookedTextureRef& ref) {
+        return ref.m_image >= -1 && ref.m_image < (int32_t)images.size() &&
+               ref.m_sampler >= -1 && ref.m_sampler < (int32_t)samplers.size();
+    };
+    for (auto& mtl : materials) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false,
+            textureFits(mtl.m_base_color_texture) &&
+                textureFits(mtl.m_metallic_roughness_texture) &&
+                textureFits(mtl.m_normal_texture) &&
+                textureFits(mtl.m_occlusion_texture),
+            "cooked model has broken material");
+    }
+    for (auto& image : images) {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, stringFits(image.m_uri),
+                                          "cooked model has broken image");
+    }
+
+    return true;
+}
+
+std::span<const CookedNode> CookedModelView::GetNodes() const {
+    return getSection<CookedNode>(CookedSection::Nodes);
+}
+
+std::span<const uint32_t> CookedModelView::GetNodeChildren(
+    const CookedNode& node) const {
+    return getSection<uint32_t>(CookedSection::NodeChildren)
+        .subspan(node.m_first_child, node.m_child_count);
+}
+
+std::span<const uint32_t> CookedModelView::GetRootNodes() const {
+    return getSection<uint32_t>(CookedSection::RootNodes);
+}
+
+std::span<const CookedMesh> CookedModelView::GetMeshes() const {
+    return getSection<CookedMesh>(CookedSection::Meshes);
+}
+
+std::span<const CookedPrimitive> CookedModelView::GetPrimitives(
+    const CookedMesh& mesh) const {
+    return getSection<CookedPrimitive>(CookedSection::Primitives)
+        .subspan(mesh.m_first_primitive, mesh.m_primitive_count);
+}
+
+std::span<const CookedPrimitiveLOD> CookedModelView::GetPrimitiveLODs(
+    const CookedPrimitive& prim) const {
+    return getSection<CookedPrimitiveLOD>(CookedSection::PrimitiveLODs)
+        .subspan(prim.m_first_lod, prim.m_lod_count);
+}
+
+std::span<const CookedMeshlet> CookedModelView::GetMeshlets(
+    const CookedPrimitive& prim) const {
+    return getSection<CookedMeshlet>(CookedSection::Meshlets)
+        .subspan(prim.m_first_meshlet, prim.m_meshlet_count);
+}
+
+std::span<const CookedMaterial> CookedModelView::GetMaterials() const {
+    return getSection<CookedMaterial>(CookedSection::Materials);
+}
+
+std::span<const CookedImage> CookedModelView::GetImages() const {
+    return getSection<CookedImage>(CookedSection::Images);
+}
+
+std::span<const CookedSampler> CookedModelView::GetSamplers() const {
+    return getSection<CookedSampler>(CookedSection::Samplers);
+}
+
+std::string_view CookedModelView::GetString(const CookedString& str) const {
+    auto strings = getSection<char>(CookedSection::Strings);
+    return {strings.data() + str.m_offset, str.m_size};
+}
+
+std::span<const unsigned char> CookedModelView::GetVertexData() const {
+    return getSection<unsigned char>(CookedSection::VertexData);
+}
+
+std::span<const unsigned char> CookedModelView::GetIndexData() const {
+    return getSection<unsigned char>(CookedSection::IndexData);
+}
+
+class GLTFCooker {
+public:
+    GLTFCooker(const tinygltf::Model& model, const Path& image_dir,
+               const MeshOptimizeConfig& optimize_config)
+        : m_model{model},
+          m_image_dir{image_dir},
+          m_optimize_config{optimize_config} {}
+
+    std::vector<unsigned char> Cook() {
+        cookImages();
+        cookSamplers();
+        cookMaterials();
+        cookMeshes();
+        cookNodes();
+        return serialize();
+    }
+
+private:
+    const tinygltf::Model& m_model;
+    Path m_image_dir;
+    MeshOptimizeConfig m_optimize_config;
+
+    std::vector<CookedNode> m_nodes;
+    std::vector<uint32_t> m_node_children;
+    std::vector<uint32_t> m_root_nodes;
+    std::vector<CookedMesh> m_meshes;
+    std::vector<CookedPrimitive> m_primitives;
+    std::vector<CookedPrimitiveLOD> m_primitive_lods;
+    std::vector<CookedMeshlet> m_meshlets;
+    std::vector<CookedMaterial> m_materials;
+    std::vector<CookedImage> m_images;
+    std::vector<CookedSampler> m_samplers;
+    std::vector<char> m_strings;
+    std::vector<unsigned char> m_vertex_data;
+    std::vector<unsigned char> m_index_data;
+
+    CookedString addString(std::string_view str) {
+        CookedString result;
+        result.m_offset = m_strings.size();
+        result.m_size = str.size();
+        m_strings.insert(m_strings.end(), str.begin(), str.end());
+        return result;
+    }
+
+    void cookImages() {
+        for (auto& image : m_model.images) {
+            CookedImage cooked;
+            if (image.uri.empty() || image.uri.starts_with("data:")) {
+                LOGW("embedded image {} is not supported, use default texture",
+                     image.name);
+            } else {
+                cooked.m_uri = addString(
+                    (m_image_dir / Path{ParseURI2Path(image.uri)}).ToString());
+            }
+            m_images.push_back(cooked);
+        }
+
+        // same as `GLTFLoader::loadTextures`, only base color is sRGB
+        for (auto& mtl : m_model.materials) {
+            int texture = mtl.pbrMetallicRoughness.baseColorTexture.index;
+            if (texture != -1 && m_model.textures[texture].source != -1) {
+                m_images[m_model.textures[texture].source].m_is_color = true;
+            }
+        }
+    }
+
+    void cookSamplers() {
+        for (auto& sampler : m_model.samplers) {
+            CookedSampler cooked;
+            cooked.m_min_filter =
+                static_cast<uint32_t>(GLTFFilter2RHI(sampler.minFilter));
+            cooked.m_mag_filter =
+                static_cast<uint32_t>(GLTFFilter2RHI(sampler.magFilter));
+            cooked.m_mipmap_mode =
+                static_cast<uint32_t>(GLTFMipmapMode2RHI(sampler.minFilter));
+            cooked.m_max_lod = GLTFMaxLod(sampler.minFilter);
+            cooked.m_address_mode_u =
+                static_cast<uint32_t>(GLTFWrapper2RHI(sampler.wrapS));
+            cooked.m_address_mode_v =
+                static_cast<uint32_t>(GLTFWrapper2RHI(sampler.wrapT));
+            m_samplers.push_back(cooked);
+        }
+    }
+
+    CookedTextureRef cookTextureRef(int texture_idx) const {
+        CookedTextureRef ref;
+        if (texture_idx != -1) {
+            auto& texture = m_model.textures[texture_idx];
+            ref.m_image = texture.source;
+            ref.m_sampler = texture.sampler;
+        }
+        return ref;
+    }
+
+    void cookMaterials() {
+        for (auto& mtl : m_model.materials) {
+            CookedMaterial cooked;
+            auto& pbr = mtl.pbrMetallicRoughness;
+            for (int i = 0; i < 4; i++) {
+                cooked.m_base_color[i] = pbr.baseColorFactor[i];
+            }
+            cooked.m_metallic = pbr.metallicFactor;
+            cooked.m_roughness = pbr.roughnessFactor;
+            cooked.m_base_color_texture =
+                cookTextureRef(pbr.baseColorTexture.index);
+            cooked.m_metallic_roughness_texture =
+                cookTextureRef(pbr.metallicRoughnessTexture.index);
+            cooked.m_normal_texture = cookTextureRef(mtl.normalTexture.index);
+            cooked.m_occlusion_texture =
+                cookTextureRef(mtl.occlusionTexture.index);
+            m_materials.push_back(cooked);
+        }
+    }
+
+    static void mergeBounds(CookedBounds& dst, const CookedBounds& src) {
+        for (int i = 0; i < 3; i++) {
+            dst.m_min[i] = std::min(dst.m_min[i], src.m_min[i]);
+            dst.m_max[i] = std::max(dst.m_max[i], src.m_max[i]);
+        }
+    }
+
+    static CookedBounds calcBounds(std::span<const Vec3> positions) {
+        CookedBounds bounds;
+        for (int i = 0; i < 3; i++) {
+            bounds.m_min[i] = std::numeric_limits<float>::max();
+            bounds.m_max[i] = std::numeric_limits<float>::lowest();
+        }
+        for (auto& p : positions) {
+            for (int i = 0; i < 3; i++) {
+                bounds.m_min[i] = std::min(bounds.m_min[i], p[i]);
+                bounds.m_max[i] = std::max(bounds.m_max[i], p[i]);
+            }
+        }
+        return bounds;
+    }
+
+    static CookedBufferView cookBufferView(const BufferView& view) {
+        CookedBufferView cooked;
+        cooked.m_offset = view.m_offset;
+        cooked.m_size = view.m_size;
+        cooked.m_count = view.m_count;
+        return cooked;
+    }
+
+    bool cookPrimitive(const tinygltf::Primitive& prim,
+                       CookedPrimitive& cooked) {
+        GLTFPrimitiveGeometry geometry;
+        if (!BuildPrimitiveGeometry(m_model, prim, m_optimize_config,
+                                    geometry)) {
+            return false;
+        }
+        // packages carry no skeletons, skinned meshes are cooked in bind pose
+        geometry.m_skin_vertices.clear();
+
+        // same data as `GLTFLoader` uploads
+        Primitive primitive;
+        AppendPrimitiveGeometry(geometry, m_vertex_data, m_index_data,
+                                primitive);
+        cooked.m_vertices = cookBufferView(primitive.m_vertex_buf_view);
+        cooked.m_vertex_layout =
+            static_cast<uint32_t>(primitive.m_vertex_layout);
+        cooked.m_indices = cookBufferView(primitive.m_indices_buf_view);
+        cooked.m_index_type = static_cast<uint32_t>(primitive.m_index_type);
+        cooked.m_material = prim.material;
+        cooked.m_first_lod = m_primitive_lods.size();
+        cooked.m_lod_count = primitive.m_lods.size();
+        for (auto& lod : primitive.m_lods) {
+            CookedPrimitiveLOD cooked_lod;
+            cooked_lod.m_indices = cookBufferView(lod.m_indices_buf_view);
+            cooked_lod.m_error = lod.m_error;
+            m_primitive_lods.push_back(cooked_lod);
+        }
+        cooked.m_first_meshlet = m_meshlets.size();
+        cooked.m_meshlet_count = geometry.m_meshlets.size();
+        for (auto& meshlet : geometry.m_meshlets) {
+            CookedMeshlet cooked_meshlet;
+            cooked_meshlet.m_first_index = meshlet.m_first_index;
+            cooked_meshlet.m_index_count = meshlet.m_index_count;
+            cooked_meshlet.m_radius = meshlet.m_radius;
+            cooked_meshlet.m_cone_cutoff = meshlet.m_cone_cutoff;
+            for (int i = 0; i < 3; i++) {
+                cooked_meshlet.m_center[i] = meshlet.m_center[i];
+                cooked_meshlet.m_cone_axis[i] = meshlet.m_cone_axis[i];
+            }
+            m_meshlets.push_back(cooked_meshlet);
+        }
+        for (int i = 0; i < 3; i++) {
+            cooked.m_bounds.m_min[i] = primitive.m_bounds_min[i];
+            cooked.m_bounds.m_max[i] = primitive.m_bounds_max[i];
+        }
+        return true;
+    }
+
+    void cookMeshes() {
+        for (auto& mesh : m_model.meshes) {
+            CookedMesh cooked;
+            cooked.m_name = addString(mesh.name);
+            cooked.m_first_primitive = m_primitives.size();
+            cooked.m_bounds = calcBounds({});
+            for (auto& prim : mesh.primitives) {
+                CookedPrimitive cooked_prim;
+                if (cookPrimitive(prim, cooked_prim)) {
+                    mergeBounds(cooked.m_bounds, cooked_prim.m_bounds);
+                    m_primitives.push_back(cooked_prim);
+                }
+            }
+            cooked.m_primitive_count =
+                m_primitives.size() - cooked.m_first_primitive;
+            m_meshes.push_back(cooked);
+        }
+    }
+
+    void cookNodes() {
+        for (auto& node : m_model.nodes) {
+            CookedNode cooked;
+            cooked.m_name = addString(node.name);
+            Mat44 transform = CalcNodeTransform(node);
+            memcpy(cooked.m_transform, transform.Ptr(), sizeof(Mat44));
+            cooked.m_mesh = node.mesh;
+            cooked.m_first_child = m_node_children.size();
+            cooked.m_child_count = node.children.size();
+            m_node_children.insert(m_node_children.end(), node.children.begin(),
+                                   node.children.end());
+            m_nodes.push_back(cooked);
+        }
+
+        // NOTE: only one scene is loaded, same as `GLTFManagerImpl::Load`
+        if (!m_model.scenes.empty()) {
+            int scene = m_model.defaultScene == -1 ? 0 : m_model.defaultScene;
+            m_root_nodes.insert(m_root_nodes.end(),
+                                m_model.scenes[scene].nodes.begin(),
+                                m_model.scenes[scene].nodes.end());
+        }
+    }
+
+    std::vector<unsigned char> serialize() const {
+        CookedModelHeader header;
+        std::vector<unsigned char> data(sizeof(header));
+
+        auto write = [&](CookedSection section, const void* src, size_t size) {
+            data.resize((data.size() + CookedModelAlignment - 1) /
+                        CookedModelAlignment * CookedModelAlignment);
+            auto& range = header.m_sections[static_cast<uint32_t>(section)];
+            range.m_offset = data.size();
+            range.m_size = size;
+            data.insert(data.end(), (const unsigned char*)src,
+                        (const unsigned char*)src + size);
+        };
+        auto writeArray = [&](CookedSection section, const auto& elems) {
+            write(section, elems.data(),
+                  elems.size() * sizeof(typename std::decay_t<
+                                        decltype(elems)>::value_type));
+        };
+
+        writeArray(CookedSection::Nodes, m_nodes);
+        writeArray(CookedSection::NodeChildren, m_node_children);
+        writeArray(CookedSection::RootNodes, m_root_nodes);
+        writeArray(CookedSection::Meshes, m_meshes);
+        writeArray(CookedSection::Primitives, m_primitives);
+        writeArray(CookedSection::PrimitiveLODs, m_primitive_lods);
+        writeArray(CookedSection::Meshlets, m_meshlets);
+        writeArray(CookedSection::Materials, m_materials);
+        writeArray(CookedSection::Images, m_images);
+        writeArray(CookedSection::Samplers, m_samplers);
+        writeArray(CookedSection::Strings, m_strings);
+        writeArray(CookedSection::VertexData, m_vertex_data);
+        writeArray(CookedSection::IndexData, m_index_data);
+
+        memcpy(data.data(), &header, sizeof(header));
+        return data;
+    }
+};
+
+std::vector<unsigned char> CookGLTFModel(
+    const tinygltf::Model& model, const Path& image_dir,
+    const MeshOptimizeConfig& optimize_config) {
+    return GLTFCooker{model, image_dir, optimize_config}.Cook();
+}
+
+bool CookGLTFFile(const Path& src, const Path& dst,
+                  const MeshOptimizeConfig& optimize_config) {
+    tinygltf::TinyGLTF loader;
+    tinygltf::Model model;
+    std::string err, warn;
+    bool ok = src.Extension() == ".glb"
+                  ? loader.LoadBinaryFromFile(&model, &err, &warn,
+                                              src.ToString())
+                  : loader.LoadASCIIFromFile(&model, &err, &warn,
+                                             src.ToString());
+    if (!ok) {
+        LOGE("load model from {} failed: \n\terr: {}\n\twarn: {}", src, err,
+             warn);
+        return false;
+    }
+
+    std::error_code ec;
+    auto src_dir = std::filesystem::absolute(
+        src.ParentPath().GetUnderlyingPath(), ec);
+    auto dst_dir = std::filesystem::absolute(
+        dst.ParentPath().GetUnderlyingPath(), ec);
+    auto relative_dir = std::filesystem::relative(src_dir, dst_dir, ec);
+    Path image_dir;
+    if (!ec && !relative_dir.empty() && relative_dir != ".") {
+        image_dir = relative_dir.generic_string();
+    }
+
+    auto data = CookGLTFModel(model, image_dir, optimize_config);
+
+    std::ofstream file{dst.GetUnderlyingPath(), std::ios::binary};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, file.is_open(), "can't write {}",
+                                      dst);
+    file.write((const char*)data.data(), data.size());
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, file.good(), "write {} failed",
+                                      dst);
+
+    // runtime prefers the cooked texture next to each image, failure only
+    // falls back to decoding the image at load time
+    CookedModelView view{data};
+    for (auto& image : view.GetImages()) {
+        auto uri = view.GetString(image.m_uri);
+        if (!uri.empty()) {
+            CookTextureFile(dst.ParentPath() / Path{uri}, image.m_is_color);
+        }
+    }
+    return true;
+}
+
+}  // namespace nickel::graphics
@@ -1,29 +1,48 @@
 ﻿#include "nickel/graphics/debug_draw.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/internal/cooked_model.hpp"
 #include "nickel/nickel.hpp"
 
 namespace nickel::graphics {
 
-DebugDrawer::DebugDrawer() {
-    auto engine_relative_path =
-        nickel::Context::GetInst().GetEngineRelativePath();
-    {
-        GLTFVertexDataLoader loader;
-        m_sphere_data =
-            loader.Load(engine_relative_path /
-                        "engine/assets/models/unit_sphere/unit_sphere.gltf")[0];
-    }
-    {
-        GLTFVertexDataLoader loader;
-        m_semi_sphere_data = loader.Load(
-            engine_relative_path /
-            "engine/assets/models/unit_semi_sphere/semi_sphere.gltf")[0];
+// prefer the package cooked at build time, see `cook_model.cmake`. Read
+// through storage, assets may live in an APK
+static GLTFVertexData loadUnitMesh(const Path& filename) {
+    auto& ctx = nickel::Context::GetInst();
+    auto engine_relative_path = ctx.GetEngineRelativePath();
+    Path cooked_filename =
+        ctx.GetCookedAssetPath() / engine_relative_path / filename;
+    cooked_filename.ReplaceExtension(Path{CookedModelExtension});
+
+    GLTFVertexDataLoader loader;
+    std::vector<GLTFVertexData> data;
+    auto storage = ctx.GetStorageManager().AcquireLocalStorage();
+    if (!ctx.GetCookedAssetPath().IsEmpty() &&
+        storage->IsFileExists(cooked_filename)) {
+        storage->WaitStorageReady();
+        auto content = storage->ReadStorageFile(cooked_filename);
+        CookedModelView view{std::span{
+            reinterpret_cast<const unsigned char*>(content.data()),
+            content.size()}};
+        if (view.IsValid()) {
+            data = loader.Load(view);
+        }
     }
-    {
-        GLTFVertexDataLoader loader;
-        m_cylinder_data =
-            loader.Load(engine_relative_path /
-                        "engine/assets/models/unit_cylinder/cylinder.gltf")[0];
+    if (data.empty()) {
+        data = loader.Load(engine_relative_path / filename);
     }
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, !data.empty(),
+                                      "load debug mesh {} failed", filename);
+    return data[0];
+}
+
+DebugDrawer::DebugDrawer() {
+    m_sphere_data =
+        loadUnitMesh("engine/assets/models/unit_sphere/unit_sphere.gltf");
+    m_semi_sphere_data =
+        loadUnitMesh("engine/assets/models/unit_semi_sphere/semi_sphere.gltf");
+    m_cylinder_data =
+        loadUnitMesh("engine/assets/models/unit_cylinder/cylinder.gltf");
 }
 
 void DebugDrawer::DrawSphere(const Vec3& center, float radius, const Quat& quat,
@@ -0,0 +1,59 @@
+#include "nickel/graphics/frame_latency.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace nickel::graphics {
+
+FrameLatencyTracker::FrameLatencyTracker(uint32_t capacity)
+    : m_capacity{std::max(capacity, 1u)} {}
+
+void FrameLatencyTracker::RecordInput(uint64_t timestamp_ns) {
+    m_pending_input =
+        std::min(m_pending_input.value_or(timestamp_ns), timestamp_ns);
+}
+
+void FrameLatencyTracker::BeginFrame(uint64_t now_ns) {
+    m_frame_input = std::min(m_pending_input.value_or(now_ns), now_ns);
+    m_pending_input.reset();
+}
+
+void FrameLatencyTracker::Present(uint64_t now_ns) {
+    if (!m_frame_input) {
+        return;
+    }
+
+    uint64_t input = std::min(*m_frame_input, now_ns);
+    m_history.push_back((now_ns - input) / 1e6f);
+    if (m_history.size() > m_capacity) {
+        m_history.erase(m_history.begin(), m_history.end() - m_capacity);
+    }
+    m_frame_input.reset();
+}
+
+std::span<const float> FrameLatencyTracker::GetHistory() const {
+    return m_history;
+}
+
+FrameLatencyStats FrameLatencyTracker::GetStats() const {
+    FrameLatencyStats stats;
+    if (m_history.empty()) {
+        return stats;
+    }
+
+    stats.m_samples = m_history.size();
+    stats.m_last_ms = m_history.back();
+    stats.m_average_ms =
+        std::accumulate(m_history.begin(), m_history.end(), 0.0f) /
+        m_history.size();
+
+    std::vector<float> sorted = m_history;
+    std::sort(sorted.begin(), sorted.end());
+    stats.m_max_ms = sorted.back();
+    size_t p95 = std::ceil(sorted.size() * 0.95) - 1;
+    stats.m_p95_ms = sorted[p95];
+    return stats;
+}
+
+}  // namespace nickel::graphics
@@ -1,21 +1,67 @@
 ﻿#include "nickel/graphics/gltf.hpp"
 
+#include "nickel/common/macro.hpp"
+#include "nickel/fs/mapped_file.hpp"
+#include "nickel/graphics/internal/cooked_model.hpp"
 #include "nickel/graphics/internal/gltf_loader.hpp"
 #include "nickel/graphics/internal/gltf_manager_impl.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
 #include "nickel/graphics/texture_manager.hpp"
 #include "tiny_gltf.h"
 
 namespace nickel::graphics {
 
+uint64_t GLTFCPUData::GetMemorySize() const {
+    uint64_t size = pbr_parameters.capacity() * sizeof(PBRParameters) +
+                    vertex_buffer.capacity() + indices_buffer.capacity();
+    for (auto& mesh : collision_meshes) {
+        size += mesh.m_points.capacity() * sizeof(Vec3) +
+                mesh.m_indices.capacity() * sizeof(uint32_t);
+    }
+    return size;
+}
+
+void GLTFCPUData::Release() {
+    // swap with empty vectors, `clear()` keeps the capacity
+    std::vector<PBRParameters>{}.swap(pbr_parameters);
+    std::vector<unsigned char>{}.swap(vertex_buffer);
+    std::vector<unsigned char>{}.swap(indices_buffer);
+}
+
 bool GLTFManager::Load(const Path& filename,
                        const GLTFLoadConfig& load_config) {
     return m_impl->Load(filename, load_config);
 }
 
+AsyncHandle<GLTFModel> GLTFManager::LoadAsync(
+    const Path& filename, const GLTFLoadConfig& load_config) {
+    return m_impl->LoadAsync(filename, load_config);
+}
+
 GLTFModel GLTFManager::Find(const std::string& name) {
     return m_impl->Find(name);
 }
 
+void GLTFManager::Update() {
+    m_impl->Update();
+}
+
+bool GLTFManager::HasPendingLoad() const {
+    return m_impl->HasPendingLoad();
+}
+
+const GLTFCPUData* GLTFManager::AcquireCPUData(const GLTFModel& model) {
+    return m_impl->AcquireCPUData(model);
+}
+
+void GLTFManager::ReleaseCPUData(const GLTFModel& model) {
+    m_impl->ReleaseCPUData(model);
+}
+
+GLTFMemoryStats GLTFManager::GetMemoryStats() const {
+    return m_impl->GetMemoryStats();
+}
+
 void GLTFManager::GC() {
     m_impl->GC();
 }
@@ -36,6 +82,15 @@ GLTFManager::~GLTFManager() {}
 
 std::vector<GLTFVertexData> GLTFVertexDataLoader::Load(const Path& filename,
                                                        bool apply_transform) {
+    if (filename.Extension() == Path{CookedModelExtension}) {
+        MappedFile file{filename};
+        CookedModelView view{file.GetData()};
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, view.IsValid(),
+                                          "load cooked model {} failed",
+                                          filename);
+        return Load(view, apply_transform);
+    }
+
     tinygltf::TinyGLTF tiny_gltf_loader;
     std::string err, warn;
     tinygltf::Model gltf_model;
@@ -154,6 +209,71 @@ void GLTFVertexDataLoader::parseNode(const tinygltf::Model& model,
     }
 }
 
+std::vector<GLTFVertexData> GLTFVertexDataLoader::Load(
+    const CookedModelView& view, bool apply_transform) {
+    std::vector<GLTFVertexData> result;
+    for (auto node : view.GetRootNodes()) {
+        parseCookedNode(view, node, Mat44::Identity(), apply_transform, result);
+    }
+    return result;
+}
+
+void GLTFVertexDataLoader::parseCookedNode(const CookedModelView& view,
+                                           uint32_t node_idx,
+                                           const Mat44& parent_transform,
+                                           bool apply_transform,
+                                           std::vector<GLTFVertexData>& result) {
+    auto& node = view.GetNodes()[node_idx];
+    Mat44 local;
+    memcpy(local.Ptr(), node.m_transform, sizeof(Mat44));
+    Mat44 global_pose = parent_transform * local;
+
+    if (node.m_mesh != -1) {
+        GLTFVertexData vertex_data;
+        vertex_data.m_name = view.GetString(node.m_name);
+
+        auto vertex_blob = view.GetVertexData();
+        auto index_blob = view.GetIndexData();
+        for (auto& prim : view.GetPrimitives(view.GetMeshes()[node.m_mesh])) {
+            size_t old_size = vertex_data.m_points.size();
+            uint32_t stride = GetVertexStride(
+                static_cast<VertexLayout>(prim.m_vertex_layout));
+            for (uint32_t i = 0; i < prim.m_vertices.m_count; i++) {
+                // position is the first member of every layout
+                Vec3 point;
+                memcpy(&point,
+                       vertex_blob.data() + prim.m_vertices.m_offset +
+                           i * stride,
+                       sizeof(Vec3));
+                if (apply_transform) {
+                    Vec4 p = global_pose * Vec4{point.x, point.y, point.z, 1};
+                    vertex_data.m_points.push_back(Vec3{p.x, p.y, p.z});
+                } else {
+                    vertex_data.m_points.push_back(point);
+                }
+            }
+
+            if (prim.m_indices.m_count > 0) {
+                auto indices = ReadIndices(
+                    index_blob.data() + prim.m_indices.m_offset,
+                    prim.m_indices.m_count,
+                    static_cast<IndexType>(prim.m_index_type));
+                for (auto index : indices) {
+                    vertex_data.m_indices.push_back(index + old_size);
+                }
+            }
+        }
+
+        if (!vertex_data.m_points.empty()) {
+            result.push_back(std::move(vertex_data));
+        }
+    }
+
+    for (auto child : view.GetNodeChildren(node)) {
+        parseCookedNode(view, child, global_pose, apply_transform, result);
+    }
+}
+
 Transform GLTFVertexDataLoader::calcNodeTransform(const tinygltf::Node& node) {
     if (!node.matrix.empty()) {
         // TODO: decompose SRT matrix
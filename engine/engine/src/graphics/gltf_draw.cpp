@@ -5,74 +5,219 @@
 #include "nickel/graphics/internal/gltf_model_impl.hpp"
 #include "nickel/graphics/internal/material3d_impl.hpp"
 #include "nickel/graphics/internal/mesh_impl.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+#include "nickel/common/math/algorithm.hpp"
 #include "nickel/nickel.hpp"
 
 namespace nickel::graphics {
 
-GLTFRenderPass::GLTFRenderPass(Device device, CommonResource& res) {
-    initBindGroupLayout(device);
-    initPipelineLayout(device);
+float CalcProjectedSize(const Primitive& prim, const Mat44& model_mat,
+                        const Vec3& camera_position, float screen_scale) {
+    Vec3 local_center = (prim.m_bounds_min + prim.m_bounds_max) * 0.5f;
+    Vec4 center = model_mat *
+                  Vec4{local_center.x, local_center.y, local_center.z, 1.0f};
+    float scale = std::max(
+        {Length(Vec3{model_mat[0].x, model_mat[0].y, model_mat[0].z}),
+         Length(Vec3{model_mat[1].x, model_mat[1].y, model_mat[1].z}),
+         Length(Vec3{model_mat[2].x, model_mat[2].y, model_mat[2].z})});
+    float radius = Length(prim.m_bounds_max - prim.m_bounds_min) * 0.5f * scale;
+    float distance =
+        Length(Vec3{center.x, center.y, center.z} - camera_position);
+    return distance <= radius ? std::numeric_limits<float>::max()
+                              : 2.0f * radius * screen_scale / distance;
+}
 
-    auto engine_relative_path = nickel::Context::GetInst().GetEngineRelativePath();
-    ShaderModule vertex_shader, frag_shader;
-    {
-        auto content = ReadWholeFile(engine_relative_path /
-                                     "engine/assets/shaders/shader_pbr.vert.spv");
-        vertex_shader = device.CreateShaderModule((uint32_t*)content.data(),
-                                                  content.size());
+uint32_t SelectLODLevel(const Primitive& prim, float screen_size,
+                        uint32_t current, const LODSelectConfig& config) {
+    uint32_t count = prim.m_lods.size();
+    if (!config.m_enable || count == 0) {
+        return 0;
     }
-    {
-        auto content = ReadWholeFile(engine_relative_path /
-                                     "engine/assets/shaders/shader_pbr.frag.spv");
-        frag_shader = device.CreateShaderModule((uint32_t*)content.data(),
-                                                content.size());
+    current = std::min(current, count);
+
+    // errors are relative to the bounds diameter, as is the screen size
+    auto pixelError = [&](uint32_t level) {
+        return level == 0 ? 0.0f : prim.m_lods[level - 1].m_error * screen_size;
+    };
+
+    uint32_t level = count;
+    while (level > 0 && pixelError(level) > config.m_pixel_error) {
+        level--;
+    }
+
+    if (level > current) {
+        // coarser level has to fit with margin
+        while (level > current &&
+               pixelError(level) >
+                   config.m_pixel_error * (1.0f - config.m_hysteresis)) {
+            level--;
+        }
+    } else if (level < current &&
+               pixelError(current) <=
+                   config.m_pixel_error * (1.0f + config.m_hysteresis)) {
+        // finer level only once current one is clearly too coarse
+        level = current;
+    }
+    return level;
+}
+
+uint32_t SelectLODLevel(LODState& state, uint32_t index,
+                        const Primitive& prim, float screen_size,
+                        const LODSelectConfig& config) {
+    if (state.m_levels.size() <= index) {
+        state.m_levels.resize(index + 1);
+    }
+    uint32_t& level = state.m_levels[index];
+    level = SelectLODLevel(prim, screen_size, level, config);
+    return level;
+}
+
+GLTFRenderPass::GLTFRenderPass(const Adapter& adapter, CommonResource& res)
+    : m_device{adapter.GetDevice()},
+      m_common_resource{res},
+      m_draw_ring{adapter,
+                  {.m_binding_range = sizeof(DrawData),
+                   .m_shader_stage = ShaderStage::Vertex}} {
+    Device device = m_device;
+    if (BindlessTable::IsSupported(adapter)) {
+        m_bindless = std::make_unique<BindlessTable>(device);
+        initFrameBindGroup(device, res);
     }
+    initBindGroupLayout(device);
+    initJointBindGroupLayout(device);
+    initPipelineLayout(device);
 
-    initSolidPipeline(device, vertex_shader, frag_shader, res.m_render_pass);
+    auto engine_relative_path = nickel::Context::GetInst().GetEngineRelativePath();
+    auto createShader = [&](const char* filename) {
+        auto content = ReadWholeFile(engine_relative_path / filename);
+        return device.CreateShaderModule((uint32_t*)content.data(),
+                                         content.size());
+    };
+    ShaderModule vertex_shader =
+        createShader("engine/assets/shaders/shader_pbr.vert.spv");
+    ShaderModule quantized_vertex_shader =
+        createShader("engine/assets/shaders/shader_pbr_quantized.vert.spv");
+    ShaderModule skinned_vertex_shader =
+        createShader("engine/assets/shaders/shader_pbr_skinned.vert.spv");
+    ShaderModule frag_shader =
+        createShader(m_bindless
+                         ? "engine/assets/shaders/shader_pbr_bindless.frag.spv"
+                         : "engine/assets/shaders/shader_pbr.frag.spv");
+
+    initSolidPipeline(device, vertex_shader, frag_shader, res.m_render_pass,
+                      VertexLayout::Float);
     initLineFramePipeline(device, vertex_shader, frag_shader,
-                          res.m_render_pass);
+                          res.m_render_pass, VertexLayout::Float);
+    initSolidPipeline(device, quantized_vertex_shader, frag_shader,
+                      res.m_render_pass, VertexLayout::Quantized);
+    initLineFramePipeline(device, quantized_vertex_shader, frag_shader,
+                          res.m_render_pass, VertexLayout::Quantized);
+    initSolidPipeline(device, skinned_vertex_shader, frag_shader,
+                      res.m_render_pass, VertexLayout::Float, true);
+    initLineFramePipeline(device, skinned_vertex_shader, frag_shader,
+                          res.m_render_pass, VertexLayout::Float, true);
 }
 
 void GLTFRenderPass::RenderModel(const Transform& transform,
-                                 const GLTFModel& model) {
+                                 const GLTFModel& model, LODState* lod_state) {
     NICKEL_RETURN_IF_FALSE(model);
 
-    m_models.push_back({transform, model});
+    m_models.push_back({transform, model, -1, 0, lod_state});
 }
 
-void GLTFRenderPass::ApplyDrawCall(RenderPassEncoder& encoder, bool wireframe) {
-    auto& camera = nickel::Context::GetInst().GetCamera();
+void GLTFRenderPass::RenderModel(const Transform& transform,
+                                 const GLTFModel& model,
+                                 const Animator& animator,
+                                 LODState* lod_state) {
+    NICKEL_RETURN_IF_FALSE(model);
 
-    if (wireframe) {
-        encoder.BindGraphicsPipeline(m_line_frame_pipeline);
-    } else {
-        encoder.BindGraphicsPipeline(m_solid_pipeline);
+    auto palette = animator.GetJointPalette();
+    if (!animator || palette.empty()) {
+        m_models.push_back({transform, model, -1, 0, lod_state});
+        return;
     }
+    m_models.push_back({transform, model, animator.GetSkinIndex(),
+                        static_cast<uint32_t>(m_joint_matrices.size()),
+                        lod_state});
+    m_joint_matrices.insert(m_joint_matrices.end(), palette.begin(),
+                            palette.end());
+}
 
-    encoder.SetPushConstant(ShaderStage::Vertex, camera.GetView().Ptr(),
-                            sizeof(Mat44), sizeof(Mat44));
+void GLTFRenderPass::ApplyDrawCall(RenderPassEncoder& encoder, bool wireframe) {
+    auto& ctx = nickel::Context::GetInst();
+    auto& camera = ctx.GetCamera();
+    m_camera_position = camera.GetPosition();
+    // pixels covered by unit length at unit distance
+    m_screen_scale = std::abs(camera.GetProject()[1][1]) *
+                     ctx.GetWindow().GetSize().h * 0.5f;
+    m_view_project = camera.GetProject() * camera.GetView();
+
+    uploadJointMatrices();
+
+    m_wireframe = wireframe;
+    m_bound_pipeline.reset();
+    m_draw_ring.BeginFrame();
+    bindPipeline(encoder, static_cast<uint32_t>(VertexLayout::Float));
+
+    encoder.SetPushConstant(ShaderStage::Vertex, camera.GetView().Ptr(), 0,
+                            sizeof(Mat44));
+
+    if (m_bindless) {
+        // update streamed textures before any draw samples the table
+        for (auto& data : m_models) {
+            updateMaterials(*data.m_model.GetImpl());
+        }
+        m_bindless->UseImages(encoder);
+        uint32_t frame_offset = m_common_resource.GetFrameUniformOffset();
+        std::array<uint32_t, 2> offsets{frame_offset, frame_offset};
+        encoder.SetBindGroup(0, m_frame_bind_group, offsets);
+        encoder.SetBindGroup(3, m_bindless->GetBindGroup());
+    }
 
-    for (auto& [transform, model] : m_models) {
-        GLTFModelImpl* impl = model.GetImpl();
-        visitGPUMesh(encoder, transform.ToMat(), *impl);
+    for (auto& data : m_models) {
+        LODState* lod_state = data.m_lod_state;
+        if (!lod_state) {
+            m_scratch_lod_state.m_levels.clear();
+            lod_state = &m_scratch_lod_state;
+        }
+        uint32_t prim_index = 0;
+        visitGPUMesh(encoder, data.m_transform.ToMat(), data,
+                     *data.m_model.GetImpl(), *lod_state, prim_index);
     }
 }
 
+void GLTFRenderPass::SetLODConfig(const LODSelectConfig& config) {
+    m_lod_config = config;
+}
+
+const LODSelectConfig& GLTFRenderPass::GetLODConfig() const {
+    return m_lod_config;
+}
+
 bool GLTFRenderPass::NeedDraw() const noexcept {
     return !m_models.empty();
 }
 
 void GLTFRenderPass::End() {
     m_models.clear();
+    m_joint_matrices.clear();
+    if (m_bindless) {
+        m_bindless->EndFrame();
+    }
 }
 
 BindGroupLayout GLTFRenderPass::GetBindGroupLayout() {
     return m_bind_group_layout;
 }
 
+BindlessTable* GLTFRenderPass::GetBindlessTable() {
+    return m_bindless.get();
+}
+
 GraphicsPipeline::Descriptor GLTFRenderPass::getPipelineDescTmpl(
     ShaderModule& vertex_shader, ShaderModule& frag_shader,
-    RenderPass& render_pass, PipelineLayout& layout) {
+    RenderPass& render_pass, PipelineLayout& layout,
+    VertexLayout vertex_layout, bool skinned) {
     GraphicsPipeline::Descriptor desc;
 
     GraphicsPipeline::Descriptor::ShaderStage vertex_stage{vertex_shader,
@@ -88,64 +233,64 @@ GraphicsPipeline::Descriptor GLTFRenderPass::getPipelineDescTmpl(
     desc.m_primitive.m_unclipped_depth = false;
     desc.m_primitive.m_strip_index_format = StripIndexFormat::Uint32;
 
-    // input vertex state
-    // Position
-    {
-        GraphicsPipeline::Descriptor::BufferState buffer_state;
-        GraphicsPipeline::Descriptor::BufferState::Attribute attr;
-        attr.m_format = VertexFormat::Float32x3;
-        attr.m_offset = 0;
-        attr.m_shader_location = 0;
-        buffer_state.m_attributes.push_back(attr);
-
-        buffer_state.m_array_stride = sizeof(float) * 3;
-        buffer_state.m_step_mode =
-            GraphicsPipeline::Descriptor::BufferState::StepMode::Vertex;
-        desc.m_vertex.m_buffers.push_back(buffer_state);
-    }
-
-    // UV
-    {
-        GraphicsPipeline::Descriptor::BufferState buffer_state;
-        GraphicsPipeline::Descriptor::BufferState::Attribute attr;
-        attr.m_format = VertexFormat::Float32x2;
-        attr.m_offset = 0;
-        attr.m_shader_location = 1;
-        buffer_state.m_attributes.push_back(attr);
-
-        buffer_state.m_array_stride = sizeof(float) * 2;
-        buffer_state.m_step_mode =
-            GraphicsPipeline::Descriptor::BufferState::StepMode::Vertex;
-        desc.m_vertex.m_buffers.push_back(buffer_state);
-    }
-
-    // normal
+    // input vertex state, one interleaved buffer, see `GLTFVertex` &
+    // `GLTFQuantizedVertex`
     {
+        using Attribute = GraphicsPipeline::Descriptor::BufferState::Attribute;
         GraphicsPipeline::Descriptor::BufferState buffer_state;
-        GraphicsPipeline::Descriptor::BufferState::Attribute attr;
-        attr.m_format = VertexFormat::Float32x3;
-        attr.m_offset = 0;
-        attr.m_shader_location = 2;
-        buffer_state.m_attributes.push_back(attr);
+        auto addAttribute = [&](VertexFormat format, uint32_t offset,
+                                uint32_t location) {
+            Attribute attr;
+            attr.m_format = format;
+            attr.m_offset = offset;
+            attr.m_shader_location = location;
+            buffer_state.m_attributes.push_back(attr);
+        };
+
+        if (vertex_layout == VertexLayout::Quantized) {
+            addAttribute(VertexFormat::Float32x3,
+                         offsetof(GLTFQuantizedVertex, m_position), 0);
+            addAttribute(VertexFormat::Float16x2,
+                         offsetof(GLTFQuantizedVertex, m_uv), 1);
+            addAttribute(VertexFormat::Snorm16x2,
+                         offsetof(GLTFQuantizedVertex, m_normal), 2);
+            addAttribute(VertexFormat::Snorm8x4,
+                         offsetof(GLTFQuantizedVertex, m_tangent), 3);
+        } else {
+            addAttribute(VertexFormat::Float32x3,
+                         offsetof(GLTFVertex, m_position), 0);
+            addAttribute(VertexFormat::Float32x2, offsetof(GLTFVertex, m_uv),
+                         1);
+            addAttribute(VertexFormat::Float32x3,
+                         offsetof(GLTFVertex, m_normal), 2);
+            addAttribute(VertexFormat::Float32x4,
+                         offsetof(GLTFVertex, m_tangent), 3);
+        }
 
-        buffer_state.m_array_stride = sizeof(float) * 3;
+        buffer_state.m_array_stride = GetVertexStride(vertex_layout);
         buffer_state.m_step_mode =
             GraphicsPipeline::Descriptor::BufferState::StepMode::Vertex;
         desc.m_vertex.m_buffers.push_back(buffer_state);
     }
 
-    // tangent
-    {
-        GraphicsPipeline::Descriptor::BufferState buffer_state;
-        GraphicsPipeline::Descriptor::BufferState::Attribute attr;
-        attr.m_format = VertexFormat::Float32x4;
-        attr.m_offset = 0;
-        attr.m_shader_location = 3;
-        buffer_state.m_attributes.push_back(attr);
-
-        buffer_state.m_array_stride = sizeof(float) * 4;
-        buffer_state.m_step_mode =
-            GraphicsPipeline::Descriptor::BufferState::StepMode::Vertex;
+    // skinned: joints & weights in a second buffer, see `GLTFSkinVertex`
+    if (skinned) {
+        using BufferState = GraphicsPipeline::Descriptor::BufferState;
+        BufferState buffer_state;
+        BufferState::Attribute joints;
+        joints.m_format = VertexFormat::Uint16x4;
+        joints.m_offset = offsetof(GLTFSkinVertex, m_joints);
+        joints.m_shader_location = 4;
+        buffer_state.m_attributes.push_back(joints);
+
+        BufferState::Attribute weights;
+        weights.m_format = VertexFormat::Unorm16x4;
+        weights.m_offset = offsetof(GLTFSkinVertex, m_weights);
+        weights.m_shader_location = 5;
+        buffer_state.m_attributes.push_back(weights);
+
+        buffer_state.m_array_stride = sizeof(GLTFSkinVertex);
+        buffer_state.m_step_mode = BufferState::StepMode::Vertex;
         desc.m_vertex.m_buffers.push_back(buffer_state);
     }
 
@@ -168,28 +313,50 @@ GraphicsPipeline::Descriptor GLTFRenderPass::getPipelineDescTmpl(
 void GLTFRenderPass::initSolidPipeline(Device& device,
                                        ShaderModule& vertex_shader,
                                        ShaderModule& frag_shader,
-                                       RenderPass& render_pass) {
+                                       RenderPass& render_pass,
+                                       VertexLayout vertex_layout,
+                                       bool skinned) {
     GraphicsPipeline::Descriptor desc = getPipelineDescTmpl(
-        vertex_shader, frag_shader, render_pass, m_pipeline_layout);
+        vertex_shader, frag_shader, render_pass,
+        skinned ? m_skinned_pipeline_layout : m_pipeline_layout, vertex_layout,
+        skinned);
     desc.m_subpass = 0;
     desc.m_primitive.m_topology = Topology::TriangleList;
     desc.m_primitive.m_cull_mode = CullMode::Back;
     desc.m_primitive.m_front_face = FrontFace::CCW;
     desc.m_primitive.m_polygon_mode = PolygonMode::Fill;
-    m_solid_pipeline = device.CreateGraphicPipeline(desc);
+    m_solid_pipelines[skinned ? SkinnedPipeline
+                              : static_cast<uint32_t>(vertex_layout)] =
+        device.CreateGraphicPipeline(desc);
 }
 
 void GLTFRenderPass::initLineFramePipeline(Device& device,
                                            ShaderModule& vertex_shader,
                                            ShaderModule& frag_shader,
-                                           RenderPass& render_pass) {
+                                           RenderPass& render_pass,
+                                           VertexLayout vertex_layout,
+                                           bool skinned) {
     GraphicsPipeline::Descriptor desc = getPipelineDescTmpl(
-        vertex_shader, frag_shader, render_pass, m_pipeline_layout);
+        vertex_shader, frag_shader, render_pass,
+        skinned ? m_skinned_pipeline_layout : m_pipeline_layout, vertex_layout,
+        skinned);
     desc.m_primitive.m_topology = Topology::TriangleList;
     desc.m_primitive.m_cull_mode = CullMode::None;
     desc.m_primitive.m_front_face = FrontFace::CCW;
     desc.m_primitive.m_polygon_mode = PolygonMode::Line;
-    m_line_frame_pipeline = device.CreateGraphicPipeline(desc);
+    m_line_frame_pipelines[skinned ? SkinnedPipeline
+                                   : static_cast<uint32_t>(vertex_layout)] =
+        device.CreateGraphicPipeline(desc);
+}
+
+void GLTFRenderPass::bindPipeline(RenderPassEncoder& encoder,
+                                  uint32_t pipeline) {
+    if (m_bound_pipeline == pipeline) {
+        return;
+    }
+    encoder.BindGraphicsPipeline(m_wireframe ? m_line_frame_pipelines[pipeline]
+                                             : m_solid_pipelines[pipeline]);
+    m_bound_pipeline = pipeline;
 }
 
 void GLTFRenderPass::initPipelineLayout(Device& device) {
@@ -199,12 +366,32 @@ void GLTFRenderPass::initPipelineLayout(Device& device) {
         PipelineLayout::Descriptor::PushConstantRange range;
         range.m_offset = 0;
         range.m_shader_stage = ShaderStage::Vertex;
-        range.m_size = sizeof(Mat44) * 2;
+        range.m_size = sizeof(Mat44);
         desc.m_push_contants.push_back(range);
     }
 
-    desc.m_layouts.push_back(m_bind_group_layout);
+    if (m_bindless) {
+        PipelineLayout::Descriptor::PushConstantRange range;
+        range.m_offset = BindlessTable::MaterialIndexOffset;
+        range.m_shader_stage = ShaderStage::Fragment;
+        range.m_size = sizeof(uint32_t);
+        desc.m_push_contants.push_back(range);
+
+        // one layout for all pipelines, so table stays bound across them
+        desc.m_layouts = {m_frame_bind_group_layout,
+                          m_joint_bind_group_layout,
+                          m_draw_ring.GetBindGroupLayout(),
+                          m_bindless->GetBindGroupLayout()};
+        m_pipeline_layout = device.CreatePipelineLayout(desc);
+        m_skinned_pipeline_layout = m_pipeline_layout;
+        return;
+    }
+
+    // draw data is set 2, so static meshes keep the joint set as well
+    desc.m_layouts = {m_bind_group_layout, m_joint_bind_group_layout,
+                      m_draw_ring.GetBindGroupLayout()};
     m_pipeline_layout = device.CreatePipelineLayout(desc);
+    m_skinned_pipeline_layout = m_pipeline_layout;
 }
 
 void GLTFRenderPass::initBindGroupLayout(Device& device) {
@@ -214,7 +401,7 @@ void GLTFRenderPass::initBindGroupLayout(Device& device) {
         BindGroupLayout::Entry entry;
         entry.m_shader_stage = ShaderStage::Vertex;
         entry.m_array_size = 1;
-        entry.m_type = BindGroupEntryType::UniformBuffer;
+        entry.m_type = BindGroupEntryType::UniformBufferDynamic;
         desc.m_entries[0] = entry;
     }
 
@@ -295,60 +482,193 @@ void GLTFRenderPass::initBindGroupLayout(Device& device) {
         BindGroupLayout::Entry entry;
         entry.m_shader_stage = ShaderStage::Fragment;
         entry.m_array_size = 1;
-        entry.m_type = BindGroupEntryType::UniformBuffer;
+        entry.m_type = BindGroupEntryType::UniformBufferDynamic;
         desc.m_entries[10] = entry;
     }
 
     m_bind_group_layout = device.CreateBindGroupLayout(desc);
 }
 
-void GLTFRenderPass::visitGPUMesh(RenderPassEncoder& encoder,
-                                  const Mat44& transform,
-                                  GLTFModelImpl& model) {
-    Mat44 model_mat = transform * model.m_transform;
-    if (model.m_mesh) {
-        for (auto& prim : model.m_mesh.GetImpl()->m_primitives) {
-            auto& mtl = prim.m_material;
+void GLTFRenderPass::initJointBindGroupLayout(Device& device) {
+    BindGroupLayout::Descriptor desc;
+    BindGroupLayout::Entry entry;
+    entry.m_shader_stage = ShaderStage::Vertex;
+    entry.m_array_size = 1;
+    entry.m_type = BindGroupEntryType::StorageBuffer;
+    desc.m_entries[0] = entry;
+
+    m_joint_bind_group_layout = device.CreateBindGroupLayout(desc);
+    m_joint_palettes.resize(device.GetFramesInFlight());
+}
 
-            encoder.SetPushConstant(ShaderStage::Vertex, model_mat.Ptr(), 0,
-                                    sizeof(Mat44));
+void GLTFRenderPass::initFrameBindGroup(Device& device,
+                                        CommonResource& res) {
+    BindGroupLayout::Descriptor layout_desc;
+    BindGroup::Descriptor desc;
+    auto addUniform = [&](uint32_t slot, ShaderStage stage, Buffer& buffer,
+                          uint64_t size) {
+        BindGroupLayout::Entry layout_entry;
+        layout_entry.m_shader_stage = stage;
+        layout_entry.m_array_size = 1;
+        layout_entry.m_type = BindGroupEntryType::UniformBufferDynamic;
+        layout_desc.m_entries[slot] = layout_entry;
+
+        BindGroup::Entry entry;
+        entry.m_shader_stage = stage;
+        entry.m_array_size = 1;
+        BindGroup::BufferBinding binding;
+        binding.m_buffer = buffer;
+        binding.m_type = BindGroup::BufferBinding::Type::DynamicUniform;
+        binding.m_size = size;
+        entry.m_binding.m_entry = binding;
+        desc.m_entries[slot] = entry;
+    };
+
+    // same slots as material bind group of legacy path
+    addUniform(0, ShaderStage::Vertex, res.m_camera_buffer, sizeof(Mat44));
+    addUniform(10, ShaderStage::Fragment, res.m_view_buffer, sizeof(Vec3));
+
+    m_frame_bind_group_layout = device.CreateBindGroupLayout(layout_desc);
+    m_frame_bind_group = m_frame_bind_group_layout.RequireBindGroup(desc);
+}
 
-            encoder.SetBindGroup(0, mtl.GetImpl()->m_bind_group);
+void GLTFRenderPass::uploadJointMatrices() {
+    NICKEL_RETURN_IF_FALSE(!m_joint_matrices.empty());
+
+    // other frames in flight may still read their palettes
+    auto& palette = m_joint_palettes[m_device.GetCurrentFrameIndex()];
+    uint64_t size = m_joint_matrices.size() * sizeof(Mat44);
+    if (!palette.m_buffer || palette.m_buffer.Size() < size) {
+        // old buffer & bind group are released after the frame's fence
+        Buffer::Descriptor desc;
+        desc.m_memory_type = MemoryType::Coherence;
+        desc.m_size = std::max<uint64_t>(
+            size, palette.m_buffer ? palette.m_buffer.Size() * 2 : 0);
+        desc.m_usage = BufferUsage::Storage;
+        palette.m_buffer = m_device.CreateBuffer(desc);
+
+        BindGroup::Descriptor group_desc;
+        BindGroup::Entry entry;
+        BindGroup::BufferBinding binding;
+        binding.m_buffer = palette.m_buffer;
+        binding.m_type = BindGroup::BufferBinding::Type::Storage;
+        entry.m_binding.m_entry = binding;
+        entry.m_shader_stage = ShaderStage::Vertex;
+        entry.m_array_size = 1;
+        group_desc.m_entries[0] = entry;
+        palette.m_bind_group =
+            m_joint_bind_group_layout.RequireBindGroup(group_desc);
+    }
 
-            // position
-            auto& pos_buffer_view = prim.m_pos_buf_view;
-            encoder.BindVertexBuffer(0, pos_buffer_view.m_buffer,
-                                     pos_buffer_view.m_offset);
+    palette.m_buffer.MapAsync();
+    memcpy(palette.m_buffer.GetMappedRange(), m_joint_matrices.data(), size);
+    palette.m_buffer.Unmap();
+}
 
-            // uv
-            auto& uv_buffer_view = prim.m_uv_buf_view;
-            encoder.BindVertexBuffer(1, uv_buffer_view.m_buffer,
-                                     uv_buffer_view.m_offset);
+void GLTFRenderPass::updateMaterials(GLTFModelImpl& model) {
+    if (model.m_mesh) {
+        for (auto& prim : model.m_mesh.GetImpl()->m_primitives) {
+            prim.m_material.GetImpl()->UpdateBindGroup();
+        }
+    }
+    for (auto& child : model.m_children) {
+        updateMaterials(*child.GetImpl());
+    }
+}
 
-            // normal
-            auto& normal_buffer_view = prim.m_norm_buf_view;
-            encoder.BindVertexBuffer(2, normal_buffer_view.m_buffer,
-                                     normal_buffer_view.m_offset);
+void GLTFRenderPass::visitGPUMesh(RenderPassEncoder& encoder,
+                                  const Mat44& transform,
+                                  const GLTFModelData& data,
+                                  GLTFModelImpl& model, LODState& lod_state,
+                                  uint32_t& prim_index) {
+    Mat44 model_mat = transform * model.m_transform;
+    if (model.m_mesh) {
+        auto& prims = model.m_mesh.GetImpl()->m_primitives;
+        for (size_t i = 0; i < prims.size(); i++) {
+            auto& prim = prims[i];
+            auto& mtl = prim.m_material;
+            uint32_t lod_index = prim_index++;
+
+            // joints are in model space, node transform of skinned mesh is
+            // ignored as glTF requires
+            bool skinned = data.m_skin != -1 && model.m_skin == data.m_skin &&
+                           prim.m_skin_buf_view;
+            Mat44 prim_mat = skinned ? data.m_transform.ToMat() : model_mat;
+            bindPipeline(encoder,
+                         skinned ? SkinnedPipeline
+                                 : static_cast<uint32_t>(prim.m_vertex_layout));
+            auto draw = m_draw_ring.Push(DrawData{prim_mat});
+            NICKEL_CONTINUE_IF_FALSE(draw);
+            encoder.SetBindGroup(2, *draw.m_bind_group,
+                                 std::span{&draw.m_offset, 1});
+
+            float screen_size = CalcProjectedSize(
+                prim, prim_mat, m_camera_position, m_screen_scale);
+            uint32_t lod = SelectLODLevel(lod_state, lod_index, prim,
+                                          screen_size, m_lod_config);
+
+            Material3DImpl* mtl_impl = mtl.GetImpl();
+            mtl_impl->RequestTextureLevels(screen_size);
+            if (m_bindless) {
+                uint32_t index = mtl_impl->GetBindlessIndex();
+                if (index == BindlessTable::InvalidSlot) {
+                    continue;
+                }
+                encoder.SetPushConstant(ShaderStage::Fragment, &index,
+                                        BindlessTable::MaterialIndexOffset,
+                                        sizeof(index));
+            } else {
+                mtl_impl->UpdateBindGroup();
+                auto offsets = mtl_impl->GetDynamicOffsets(
+                    m_common_resource.GetFrameUniformOffset());
+                encoder.SetBindGroup(0, mtl_impl->m_bind_group, offsets);
+            }
 
-            // tangent
-            auto& tangent_buffer_view = prim.m_tan_buf_view;
-            encoder.BindVertexBuffer(3, tangent_buffer_view.m_buffer,
-                                     tangent_buffer_view.m_offset);
+            auto& vertex_buffer_view = prim.m_vertex_buf_view;
+            encoder.BindVertexBuffer(0, vertex_buffer_view.m_buffer,
+                                     vertex_buffer_view.m_offset);
+            uint32_t first_instance = 0;
+            if (skinned) {
+                encoder.SetBindGroup(
+                    1, m_joint_palettes[m_device.GetCurrentFrameIndex()]
+                           .m_bind_group);
+                encoder.BindVertexBuffer(1, prim.m_skin_buf_view.m_buffer,
+                                         prim.m_skin_buf_view.m_offset);
+                first_instance = data.m_joint_base;
+            }
 
             if (prim.m_indices_buf_view) {
-                auto& indices_buffer_view = prim.m_indices_buf_view;
+                auto& indices_buffer_view =
+                    lod == 0 ? prim.m_indices_buf_view
+                             : prim.m_lods[lod - 1].m_indices_buf_view;
                 encoder.BindIndexBuffer(indices_buffer_view.m_buffer,
                                         prim.m_index_type,
                                         indices_buffer_view.m_offset);
-                encoder.DrawIndexed(indices_buffer_view.m_count, 1, 0, 0, 0);
+                if (lod == 0 && !prim.m_meshlet_offsets.empty()) {
+                    CullMeshlets(prim,
+                                 MakeMeshletCullParams(m_view_project,
+                                                       model_mat,
+                                                       m_camera_position),
+                                 m_visible_meshlets);
+                    CompactMeshletRanges(prim, m_visible_meshlets,
+                                         m_meshlet_ranges);
+                    for (auto& range : m_meshlet_ranges) {
+                        encoder.DrawIndexed(range.m_index_count, 1,
+                                            range.m_first_index, 0, 0);
+                    }
+                } else {
+                    encoder.DrawIndexed(indices_buffer_view.m_count, 1, 0, 0,
+                                        first_instance);
+                }
             } else {
-                encoder.Draw(pos_buffer_view.m_count, 1, 0, 0);
+                encoder.Draw(vertex_buffer_view.m_count, 1, 0, first_instance);
             }
         }
     }
 
     for (auto& child : model.m_children) {
-        visitGPUMesh(encoder, model_mat, *child.GetImpl());
+        visitGPUMesh(encoder, model_mat, data, *child.GetImpl(), lod_state,
+                     prim_index);
     }
 }
 
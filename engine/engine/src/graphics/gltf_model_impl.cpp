@@ -1,17 +1,42 @@
 #include "nickel/graphics/internal/gltf_model_impl.hpp"
 
+#include "nickel/graphics/internal/gltf_loader.hpp"
 #include "nickel/graphics/internal/gltf_manager_impl.hpp"
 #include "nickel/graphics/internal/material3d_impl.hpp"
 
 namespace nickel::graphics {
 
 GLTFModelResourceImpl::GLTFModelResourceImpl(GLTFManagerImpl* mgr)
-    : m_mgr{mgr} {}
+    : m_mgr{mgr} {
+    m_mgr->m_resources.insert(this);
+}
+
+void GLTFModelResourceImpl::ApplyCPUDataPolicy(
+    const GLTFLoadConfig& config, std::span<const Mesh> meshes,
+    std::span<const unsigned char> vertex_data,
+    std::span<const unsigned char> index_data) {
+    m_cpu_data_policy = config.m_cpu_data_policy;
+    for (auto& mesh : meshes) {
+        auto impl = mesh.GetImpl();
+        if (config.m_collision_meshes.contains(impl->m_name)) {
+            m_cpu_data.collision_meshes.push_back(ExtractVertexData(
+                impl->m_name, impl->m_primitives, vertex_data, index_data));
+        }
+    }
+
+    if (m_cpu_data_policy != GLTFCPUDataPolicy::Keep) {
+        uint64_t size = m_cpu_data.GetMemorySize();
+        m_cpu_data.Release();
+        m_released_size = size - m_cpu_data.GetMemorySize();
+        m_cpu_data_released = true;
+    }
+}
 
 void GLTFModelResourceImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
+        m_mgr->m_resources.erase(this);
         m_mgr->m_model_resource_allocator.MarkAsGarbage(this);
     }
 }
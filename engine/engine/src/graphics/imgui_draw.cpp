@@ -48,12 +48,15 @@ ImGuiRenderPass::ImGuiRenderPass(const video::Window& window,
     init_info.Device = impl.m_device;
     init_info.QueueFamily = impl.m_queue_indices.m_graphics_index.value();
     init_info.Queue = impl.m_graphics_queue;
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = impl.m_pipeline_cache;
     init_info.DescriptorPool = m_descriptor_pool;
     init_info.RenderPass = m_render_pass;
     init_info.Subpass = 0;
     init_info.MinImageCount = impl.GetSwapchainImageInfo().m_image_count;
-    init_info.ImageCount = impl.GetSwapchainImageInfo().m_image_count;
+    // imgui cycles its vertex buffers by this, they must outlive the frames
+    // in flight
+    init_info.ImageCount = std::max(impl.GetSwapchainImageInfo().m_image_count,
+                                    impl.GetFramesInFlight());
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
     init_info.Allocator = nullptr;
     init_info.CheckVkResultFn = [](VkResult result) {
@@ -85,10 +88,9 @@ void ImGuiRenderPass::Begin() {
     ImGui::NewFrame();
 }
 
-void ImGuiRenderPass::End(Device device, CommonResource& res,
-                          uint32_t cur_swapchain_image_idx,
-                          uint32_t cur_frame) {
-    renderImGui(device, res, cur_swapchain_image_idx, cur_frame);
+void ImGuiRenderPass::End(Device device, CommandEncoder& encoder,
+                          uint32_t cur_swapchain_image_idx) {
+    renderImGui(device, encoder, cur_swapchain_image_idx);
 }
 
 void ImGuiRenderPass::PrepareForRender() {
@@ -127,7 +129,7 @@ void ImGuiRenderPass::initRenderPass(const Adapter& adapter) {
     attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-    attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
     VkAttachmentReference color_attachment = {};
     color_attachment.attachment = 0;
     color_attachment.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
@@ -189,16 +191,15 @@ void ImGuiRenderPass::DestroyFramebuffers() {
     m_fbos.clear();
 }
 
-void ImGuiRenderPass::renderImGui(Device device, CommonResource& res,
-                                  uint32_t cur_swapchain_image_idx,
-                                  uint32_t cur_frame_idx) {
+void ImGuiRenderPass::renderImGui(Device device, CommandEncoder& encoder,
+                                  uint32_t cur_swapchain_image_idx) {
     auto draw_data = ImGui::GetDrawData();
 
     NICKEL_RETURN_IF_FALSE(draw_data->DisplaySize.x > 0 &&
                            draw_data->DisplaySize.y > 0);
 
-    auto encoder = device.CreateCommandEncoder();
     VkCommandBuffer cmd = encoder.GetImpl().m_cmd;
+    encoder.BeginProfileScope("imgui");
 
     {
         VkRenderPassBeginInfo info = {};
@@ -216,32 +217,8 @@ void ImGuiRenderPass::renderImGui(Device device, CommonResource& res,
     // Record dear imgui primitives into command m_buffer
     ImGui_ImplVulkan_RenderDrawData(draw_data, cmd);
 
-
-    // Submit command buffer
     vkCmdEndRenderPass(cmd);
-    {
-        VkPipelineStageFlags wait_stage =
-            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-        VkSubmitInfo info = {};
-        info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        info.waitSemaphoreCount = 1;
-        info.pWaitSemaphores =
-            &res.GetRenderFinishSemaphore(cur_frame_idx).GetImpl()->m_semaphore;
-        info.pWaitDstStageMask = &wait_stage;
-        info.commandBufferCount = 1;
-        info.pCommandBuffers = &cmd;
-        info.signalSemaphoreCount = 1;
-        info.pSignalSemaphores =
-            &res.GetImGuiRenderFinishSemaphore(cur_frame_idx)
-                 .GetImpl()
-                 ->m_semaphore;
-
-        VK_CALL(vkEndCommandBuffer(cmd));
-        VK_CALL(vkQueueSubmit(device.Impl().m_graphics_queue, 1, &info,
-                              res.GetFence(cur_frame_idx).GetImpl()->m_fence));
-    }
-
-    encoder.GetImpl().PendingDelete();
+    encoder.EndProfileScope();
 }
 
 }  // namespace nickel::graphics
\ No newline at end of file
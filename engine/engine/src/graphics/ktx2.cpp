@@ -0,0 +1,281 @@
+#include "nickel/graphics/internal/ktx2.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/lowlevel/common.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+namespace nickel::graphics {
+
+static_assert(sizeof(KTX2Header) == 80);
+static_assert(sizeof(KTX2LevelIndex) == 24);
+
+namespace {
+
+constexpr unsigned char KTX2Identifier[12] = {0xAB, 0x4B, 0x54, 0x58,
+                                              0x20, 0x32, 0x30, 0xBB,
+                                              0x0D, 0x0A, 0x1A, 0x0A};
+
+// Khronos data format descriptor values
+constexpr uint32_t KDFModelRGBSDA = 1;
+constexpr uint32_t KDFModelBC1A = 128;
+constexpr uint32_t KDFModelBC3 = 130;
+constexpr uint32_t KDFPrimariesBT709 = 1;
+constexpr uint32_t KDFTransferLinear = 1;
+constexpr uint32_t KDFTransferSRGB = 2;
+constexpr uint32_t KDFChannelAlpha = 15;
+constexpr uint32_t KDFQualifierLinear = 1;
+
+// total size, basic descriptor block and at most one sample per channel
+constexpr size_t MaxDFDSize = 4 + 24 + 16 * 4;
+
+struct DFDSample {
+    uint32_t m_bit_offset{};
+    uint32_t m_bit_length{};
+    uint32_t m_channel{};
+    uint32_t m_qualifiers{};
+    uint32_t m_upper{};
+};
+
+void Append32(std::vector<unsigned char>& data, uint32_t value) {
+    unsigned char bytes[4];
+    memcpy(bytes, &value, 4);
+    data.insert(data.end(), bytes, bytes + 4);
+}
+
+std::vector<unsigned char> BuildDFD(const TextureData& texture) {
+    auto format = texture.m_format;
+    auto block = GetFormatBlockInfo(format);
+    bool srgb = IsSRGBFormat(format);
+
+    uint32_t model = KDFModelRGBSDA;
+    std::vector<DFDSample> samples;
+    if (format == Format::BC1_RGB_UNORM_BLOCK ||
+        format == Format::BC1_RGB_SRGB_BLOCK ||
+        format == Format::BC1_RGBA_UNORM_BLOCK ||
+        format == Format::BC1_RGBA_SRGB_BLOCK) {
+        model = KDFModelBC1A;
+        samples.push_back({0, 64, 0, 0, 0xFFFFFFFF});
+    } else if (format == Format::BC3_UNORM_BLOCK ||
+               format == Format::BC3_SRGB_BLOCK) {
+        model = KDFModelBC3;
+        samples.push_back({0, 64, KDFChannelAlpha,
+                           srgb ? KDFQualifierLinear : 0, 0xFFFFFFFF});
+        samples.push_back({64, 64, 0, 0, 0xFFFFFFFF});
+    } else {
+        for (uint32_t i = 0; i < 4; i++) {
+            uint32_t channel = i == 3 ? KDFChannelAlpha : i;
+            uint32_t qualifiers = i == 3 && srgb ? KDFQualifierLinear : 0;
+            samples.push_back({i * 8, 8, channel, qualifiers, 255});
+        }
+    }
+
+    std::vector<unsigned char> dfd;
+    uint32_t block_size = 24 + 16 * samples.size();
+    Append32(dfd, 4 + block_size);  // dfdTotalSize
+    Append32(dfd, 0);               // vendor & descriptor type: khronos basic
+    Append32(dfd, 2 | (block_size << 16));  // version 1.3
+    Append32(dfd, model | (KDFPrimariesBT709 << 8) |
+                      ((srgb ? KDFTransferSRGB : KDFTransferLinear) << 16));
+    Append32(dfd, (block.m_block_width - 1) | ((block.m_block_height - 1) << 8));
+    Append32(dfd, block.m_block_size);  // bytesPlane0
+    Append32(dfd, 0);
+    for (auto& sample : samples) {
+        Append32(dfd, sample.m_bit_offset | ((sample.m_bit_length - 1) << 16) |
+                          (sample.m_channel << 24) |
+                          (sample.m_qualifiers << 28));
+        Append32(dfd, 0);  // sample position
+        Append32(dfd, 0);  // lower
+        Append32(dfd, sample.m_upper);
+    }
+    return dfd;
+}
+
+}  // namespace
+
+KTX2View::KTX2View(std::span<const unsigned char> data) : m_data{data} {
+    if (m_data.size() >= sizeof(KTX2Header)) {
+        memcpy(&m_header, m_data.data(), sizeof(KTX2Header));
+    }
+    m_valid = validate();
+}
+
+Format KTX2View::GetFormat() const {
+    return static_cast<Format>(m_header.m_vk_format);
+}
+
+SVector<uint32_t, 2> KTX2View::GetExtent() const {
+    return {m_header.m_pixel_width, m_header.m_pixel_height};
+}
+
+uint32_t KTX2View::GetLevelCount() const {
+    return std::max(m_header.m_level_count, 1u);
+}
+
+KTX2LevelIndex KTX2View::getLevelIndex(uint32_t level) const {
+    KTX2LevelIndex index;
+    memcpy(&index,
+           m_data.data() + sizeof(KTX2Header) + level * sizeof(KTX2LevelIndex),
+           sizeof(KTX2LevelIndex));
+    return index;
+}
+
+std::span<const unsigned char> KTX2View::GetLevelData(uint32_t level) const {
+    auto index = getLevelIndex(level);
+    return m_data.subspan(index.m_byte_offset, index.m_byte_length);
+}
+
+TextureData KTX2View::ToTextureData() const {
+    TextureData texture;
+    texture.m_format = GetFormat();
+    texture.m_data.reserve(CalcTextureSize(texture.m_format,
+                                           m_header.m_pixel_width,
+                                           m_header.m_pixel_height,
+                                           GetLevelCount()));
+    for (uint32_t i = 0; i < GetLevelCount(); i++) {
+        texture.AddLevel({std::max(m_header.m_pixel_width >> i, 1u),
+                          std::max(m_header.m_pixel_height >> i, 1u)},
+                         GetLevelData(i));
+    }
+    return texture;
+}
+
+bool KTX2View::validate() const {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false,
+                                      m_data.size() >= sizeof(KTX2Header),
+                                      "ktx2 file too small");
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false,
+        memcmp(m_header.m_identifier, KTX2Identifier, sizeof(KTX2Identifier)) ==
+            0,
+        "not a ktx2 file");
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false, m_header.m_supercompression_scheme == 0,
+        "ktx2 supercompression scheme {} not supported",
+        m_header.m_supercompression_scheme);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false,
+        m_header.m_pixel_depth == 0 && m_header.m_layer_count == 0 &&
+            m_header.m_face_count == 1,
+        "only 2D ktx2 texture is supported");
+
+    auto block = GetFormatBlockInfo(GetFormat());
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, block.m_block_size != 0,
+                                      "ktx2 vkFormat {} not supported",
+                                      m_header.m_vk_format);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false,
+        m_header.m_pixel_width > 0 && m_header.m_pixel_height > 0 &&
+            GetLevelCount() <= CalcMipLevelCount(m_header.m_pixel_width,
+                                                 m_header.m_pixel_height),
+        "invalid ktx2 extent or level count");
+
+    uint64_t index_end =
+        sizeof(KTX2Header) + GetLevelCount() * sizeof(KTX2LevelIndex);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, m_data.size() >= index_end,
+                                      "ktx2 level index out of range");
+
+    for (uint32_t i = 0; i < GetLevelCount(); i++) {
+        auto index = getLevelIndex(i);
+        uint64_t expect_size =
+            CalcLevelSize(GetFormat(), std::max(m_header.m_pixel_width >> i, 1u),
+                          std::max(m_header.m_pixel_height >> i, 1u));
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false,
+            index.m_byte_offset <= m_data.size() &&
+                index.m_byte_length <= m_data.size() - index.m_byte_offset,
+            "ktx2 level {} out of range", i);
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false, index.m_byte_length == expect_size,
+            "ktx2 level {} size {} mismatch, expect {}", i,
+            index.m_byte_length, expect_size);
+    }
+    return true;
+}
+
+std::vector<unsigned char> WriteKTX2(const TextureData& texture) {
+    auto block = GetFormatBlockInfo(texture.m_format);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, texture && block.m_block_size != 0,
+                                      "can't write invalid texture to ktx2");
+
+    uint32_t level_count = texture.m_levels.size();
+    auto extent = texture.GetExtent();
+    auto dfd = BuildDFD(texture);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, dfd.size() <= MaxDFDSize,
+                                      "ktx2 DFD of {} bytes is too large",
+                                      dfd.size());
+
+    KTX2Header header;
+    memcpy(header.m_identifier, KTX2Identifier, sizeof(KTX2Identifier));
+    header.m_vk_format = static_cast<uint32_t>(texture.m_format);
+    header.m_type_size = 1;
+    header.m_pixel_width = extent.w;
+    header.m_pixel_height = extent.h;
+    header.m_face_count = 1;
+    header.m_level_count = level_count;
+    header.m_dfd_byte_offset =
+        sizeof(KTX2Header) + level_count * sizeof(KTX2LevelIndex);
+    header.m_dfd_byte_length = dfd.size();
+
+    // levels are stored smallest first, each aligned to lcm(block size, 4)
+    uint64_t alignment = std::lcm<uint64_t>(block.m_block_size, 4);
+    std::vector<KTX2LevelIndex> indices(level_count);
+    uint64_t offset = header.m_dfd_byte_offset + dfd.size();
+    for (uint32_t i = level_count; i > 0; i--) {
+        auto& level = texture.m_levels[i - 1];
+        offset = (offset + alignment - 1) / alignment * alignment;
+        indices[i - 1].m_byte_offset = offset;
+        indices[i - 1].m_byte_length = level.m_size;
+        indices[i - 1].m_uncompressed_byte_length = level.m_size;
+        offset += level.m_size;
+    }
+
+    std::vector<unsigned char> data(offset);
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), indices.data(),
+           indices.size() * sizeof(KTX2LevelIndex));
+    memcpy(data.data() + header.m_dfd_byte_offset, dfd.data(), dfd.size());
+    for (uint32_t i = 0; i < level_count; i++) {
+        auto level_data = texture.GetLevelData(i);
+        memcpy(data.data() + indices[i].m_byte_offset, level_data.data(),
+               level_data.size());
+    }
+    return data;
+}
+
+bool CookTextureFile(const Path& filename, bool is_color) {
+    std::ifstream src{filename.GetUnderlyingPath(), std::ios::binary};
+    std::vector<char> content{std::istreambuf_iterator<char>{src},
+                              std::istreambuf_iterator<char>{}};
+    ImageRawData image{content.data(), content.size()};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(false, image, "can't decode image {}",
+                                      filename);
+
+    auto texture = CookTexture(image, is_color);
+    auto data = WriteKTX2(texture);
+    if (data.empty()) {
+        return false;
+    }
+
+    Path dst = filename;
+    dst.ReplaceExtension(Path{KTX2Extension});
+    std::ofstream file{dst.GetUnderlyingPath(), std::ios::binary};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, file.is_open(), "can't write {}",
+                                      dst);
+    file.write((const char*)data.data(), data.size());
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, file.good(), "write {} failed",
+                                      dst);
+
+    // VRAM the runtime used before cooking: single level RGBA8
+    auto extent = image.GetExtent();
+    uint64_t raw_size =
+        CalcLevelSize(Format::R8G8B8A8_UNORM, extent.w, extent.h);
+    LOGI("cooked {} ({}x{}, {} levels, vkFormat {}): VRAM {} KiB -> {} KiB",
+         filename, extent.w, extent.h, texture.m_levels.size(),
+         static_cast<uint32_t>(texture.m_format), raw_size / 1024,
+         texture.m_data.size() / 1024);
+    return true;
+}
+
+}  // namespace nickel::graphics
@@ -1,13 +1,48 @@
 ﻿#include "nickel/graphics/lowlevel//adapter.hpp"
+#include "nickel/common/macro.hpp"
 #include "nickel/graphics/lowlevel/internal/adapter_impl.hpp"
 #include "nickel/internal/pch.hpp"
 
 namespace nickel::graphics {
 
-Adapter::Adapter(const video::Window::Impl& window) : m_impl{std::make_unique<AdapterImpl>(window)} {}
+Adapter::Adapter(const video::Window::Impl& window, uint32_t frames_in_flight)
+    : m_impl{std::make_unique<AdapterImpl>(window, frames_in_flight)} {}
+
+Adapter::Adapter(const HeadlessDescriptor& desc)
+    : m_impl{std::make_unique<AdapterImpl>(desc)} {}
 
 Adapter::~Adapter() {}
 
+bool Adapter::IsSupported() {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(false, volkInitialize() == VK_SUCCESS,
+                                      "vulkan loader not found");
+
+    VkApplicationInfo app_info{};
+    app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app_info.apiVersion = VK_API_VERSION_1_3;
+    VkInstanceCreateInfo ci{};
+    ci.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    ci.pApplicationInfo = &app_info;
+
+    VkInstance instance = VK_NULL_HANDLE;
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(
+        false, vkCreateInstance(&ci, nullptr, &instance) == VK_SUCCESS,
+        "create vulkan instance failed");
+
+    // local function pointers, loading them into volk would replace those
+    // of adapters already alive
+    auto enumerate_devices =
+        (PFN_vkEnumeratePhysicalDevices)vkGetInstanceProcAddr(
+            instance, "vkEnumeratePhysicalDevices");
+    auto destroy_instance = (PFN_vkDestroyInstance)vkGetInstanceProcAddr(
+        instance, "vkDestroyInstance");
+
+    uint32_t count = 0;
+    enumerate_devices(instance, &count, nullptr);
+    destroy_instance(instance, nullptr);
+    return count > 0;
+}
+
 Device Adapter::GetDevice() const {
     return m_impl->GetDevice();
 }
@@ -25,4 +60,20 @@ const Adapter::Limits& Adapter::GetLimits() const {
     return m_impl->GetLimits();
 }
 
+const Adapter::Features& Adapter::GetFeatures() const {
+    return m_impl->GetFeatures();
+}
+
+bool Adapter::IsHeadless() const {
+    return m_impl->IsHeadless();
+}
+
+bool Adapter::IsValidationEnabled() const {
+    return m_impl->m_validation_enabled;
+}
+
+uint32_t Adapter::GetValidationErrorCount() const {
+    return m_impl->m_validation_errors;
+}
+
 }  // namespace nickel::graphics
\ No newline at end of file
@@ -41,6 +41,7 @@ VulkanDebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT level,
             return false;
         case VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT:
             LOGE("[Vulkan][{}]: {}", type_name, callback_data->pMessage);
+            static_cast<AdapterImpl*>(user_data)->m_validation_errors++;
             return true;
     }
 
@@ -48,7 +49,29 @@ VulkanDebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT level,
     return false;
 }
 
-AdapterImpl::AdapterImpl(const video::Window::Impl& window) {
+AdapterImpl::AdapterImpl(const video::Window::Impl& window,
+                         uint32_t frames_in_flight)
+    : m_frames_in_flight{frames_in_flight} {
+    initVulkan();
+
+    LOGI("creating surface");
+    CreateSurface(window);
+
+    LOGI("creating render device");
+    createDevice(window.GetSize());
+}
+
+AdapterImpl::AdapterImpl(const Adapter::HeadlessDescriptor& desc)
+    : m_headless{desc},
+      m_frames_in_flight{std::max(desc.m_frames_in_flight, 1u)} {
+    initVulkan();
+
+    LOGI("creating headless render device, {}x{}", desc.m_size.w,
+         desc.m_size.h);
+    createDevice(desc.m_size);
+}
+
+void AdapterImpl::initVulkan() {
     if (volkInitialize() != VK_SUCCESS) {
         LOGE("volk init failed");
     }
@@ -63,12 +86,19 @@ AdapterImpl::AdapterImpl(const video::Window::Impl& window) {
     LOGI("pick {}", props.deviceName);
 
     queryLimits();
+    queryFeatures();
+}
 
-    LOGI("creating surface");
-    CreateSurface(window);
-
-    LOGI("creating render device");
-    createDevice(window.GetSize());
+bool AdapterImpl::shouldEnableValidation() const {
+#ifdef NICKEL_DEBUG
+    return true;
+#else
+    if (m_headless && m_headless->m_validation) {
+        return true;
+    }
+    const char* env = std::getenv("NICKEL_VULKAN_VALIDATION");
+    return env && std::strcmp(env, "0") != 0;
+#endif
 }
 
 void AdapterImpl::createInstance() {
@@ -83,11 +113,14 @@ void AdapterImpl::createInstance() {
     ci.pApplicationInfo = &appInfo;
 
     std::vector<const char*> require_extensions;
-    unsigned int count;
-    auto sdl_required_extensions = SDL_Vulkan_GetInstanceExtensions(&count);
-
-    for (int i = 0; i < count; i++) {
-        require_extensions.push_back(sdl_required_extensions[i]);
+    if (!m_headless) {
+        unsigned int count;
+        auto sdl_required_extensions =
+            SDL_Vulkan_GetInstanceExtensions(&count);
+
+        for (int i = 0; i < count; i++) {
+            require_extensions.push_back(sdl_required_extensions[i]);
+        }
     }
     require_extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 
@@ -117,25 +150,27 @@ void AdapterImpl::createInstance() {
                                                support_layers.data()));
 
     std::vector<const char*> require_layers;
-#ifdef NICKEL_DEBUG
-    require_layers.push_back("VK_LAYER_KHRONOS_validation");
-    LOGI("Vulkan enable validation layer");
-
+    bool validation = shouldEnableValidation();
     VkDebugUtilsMessengerCreateInfoEXT debug_ci{};
-    debug_ci.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
-    debug_ci.messageSeverity = VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
-                               VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
-                               VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
-                               VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
-    debug_ci.messageType =
-        VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
-        VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
-        VK_DEBUG_UTILS_MESSAGE_TYPE_DEVICE_ADDRESS_BINDING_BIT_EXT |
-        VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
-    debug_ci.pfnUserCallback = VulkanDebugCallback;
-    debug_ci.pUserData = nullptr;  // Optional
-    ci.pNext = &debug_ci;
-#endif
+    if (validation) {
+        require_layers.push_back("VK_LAYER_KHRONOS_validation");
+
+        debug_ci.sType =
+            VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+        debug_ci.messageSeverity =
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+        debug_ci.messageType =
+            VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_TYPE_DEVICE_ADDRESS_BINDING_BIT_EXT |
+            VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+        debug_ci.pfnUserCallback = VulkanDebugCallback;
+        debug_ci.pUserData = this;
+        ci.pNext = &debug_ci;
+    }
 
     RemoveUnexistsElems<const char*, VkLayerProperties>(
         require_layers, support_layers,
@@ -143,20 +178,29 @@ void AdapterImpl::createInstance() {
             return std::strcmp(prop.layerName, require) == 0;
         });
 
+    m_validation_enabled = !require_layers.empty();
+    if (validation) {
+        if (m_validation_enabled) {
+            LOGI("Vulkan enable validation layer");
+        } else {
+            LOGW("Vulkan validation layer requested but not found");
+        }
+    }
+
     ci.enabledLayerCount = require_layers.size();
     ci.ppEnabledLayerNames = require_layers.data();
     VK_CALL(vkCreateInstance(&ci, nullptr, &m_instance));
     volkLoadInstance(m_instance);
 
-#ifdef NICKEL_DEBUG
-    auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
-        m_instance, "vkCreateDebugUtilsMessengerEXT");
-    if (func != nullptr) {
-        func(m_instance, &debug_ci, nullptr, &m_debug_utils_messenger);
-    } else {
-        LOGE("vkCreateDebugUtilsMessengerEXT function not exists");
+    if (validation) {
+        auto func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
+            m_instance, "vkCreateDebugUtilsMessengerEXT");
+        if (func != nullptr) {
+            func(m_instance, &debug_ci, nullptr, &m_debug_utils_messenger);
+        } else {
+            LOGE("vkCreateDebugUtilsMessengerEXT function not exists");
+        }
     }
-#endif
 }
 
 void AdapterImpl::pickupPhysicalDevice() {
@@ -191,11 +235,52 @@ void AdapterImpl::queryLimits() {
 
     m_limits.min_uniform_buffer_offset_alignment =
         props.limits.minUniformBufferOffsetAlignment;
+    m_limits.min_storage_buffer_offset_alignment =
+        props.limits.minStorageBufferOffsetAlignment;
+    m_limits.max_uniform_buffer_range = props.limits.maxUniformBufferRange;
+    m_limits.max_push_constants_size = props.limits.maxPushConstantsSize;
+}
+
+void AdapterImpl::queryFeatures() {
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(m_phy_device, &features);
+
+    m_features.texture_compression_bc = features.textureCompressionBC;
+    m_features.texture_compression_etc2 = features.textureCompressionETC2;
+    m_features.texture_compression_astc_ldr =
+        features.textureCompressionASTC_LDR;
+    m_features.multi_draw_indirect = features.multiDrawIndirect;
+    LOGI("texture compression support: BC {}, ETC2 {}, ASTC LDR {}",
+         m_features.texture_compression_bc,
+         m_features.texture_compression_etc2,
+         m_features.texture_compression_astc_ldr);
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(m_phy_device, &props);
+    if (props.apiVersion >= VK_API_VERSION_1_2) {
+        VkPhysicalDeviceVulkan12Features features12{};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 features2{};
+        features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features2.pNext = &features12;
+        vkGetPhysicalDeviceFeatures2(m_phy_device, &features2);
+
+        m_features.bindless =
+            features12.runtimeDescriptorArray &&
+            features12.descriptorBindingPartiallyBound &&
+            features12.shaderSampledImageArrayNonUniformIndexing &&
+            features12.descriptorBindingSampledImageUpdateAfterBind;
+        m_features.host_query_reset = features12.hostQueryReset;
+        m_features.draw_indirect_count = features12.drawIndirectCount;
+    }
+    LOGI("bindless support: {}", m_features.bindless);
 }
 
 AdapterImpl::~AdapterImpl() {
     delete m_device;
-    vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+    if (m_surface) {
+        vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+    }
 
     auto vkDestroyDebugUtilsMessengerExTFuc =
         (PFN_vkDestroyDebugUtilsMessengerEXT)vkGetInstanceProcAddr(
@@ -7,4 +7,9 @@ const BindGroup::Descriptor& BindGroup::GetDescriptor() const {
     return m_impl->GetDescriptor();
 }
 
+void BindGroup::UpdateArrayElement(uint32_t slot, uint32_t index,
+                                   const BindingPoint& binding) {
+    m_impl->UpdateArrayElement(slot, index, binding);
+}
+
 }  // namespace nickel::graphics
\ No newline at end of file
@@ -23,8 +23,14 @@ void BindGroupImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_layout.GetImpl()->RecycleBindGroup(*this);
-        m_layout.GetImpl()->m_bind_group_allocator.MarkAsGarbage(this);
+        // frames in flight may still bind the set, it is rewritten only
+        // after their fences
+        BindGroupLayoutImpl* layout = m_layout.GetImpl();
+        m_device.DeferRelease([layout, this] {
+            layout->RecycleBindGroup(*this);
+            layout->m_bind_group_allocator.MarkAsGarbage(this);
+            layout->GC();
+        });
     }
 }
 
@@ -60,8 +66,12 @@ VkDescriptorType cvtImageType2DescriptorType(
 
 struct WriteDescriptorHelper final {
     explicit WriteDescriptorHelper(DeviceImpl& device, uint32_t slot,
-                                   VkDescriptorSet descriptor_set)
-        : m_device{device}, m_slot{slot}, m_descriptor_set{descriptor_set} {}
+                                   VkDescriptorSet descriptor_set,
+                                   uint32_t array_index = 0)
+        : m_device{device},
+          m_descriptor_set{descriptor_set},
+          m_slot{slot},
+          m_array_index{array_index} {}
 
     void operator()(const BindGroup::BufferBinding& binding) const {
         if (binding.m_buffer.GetImpl()->Size() == 0) {
@@ -86,7 +96,7 @@ struct WriteDescriptorHelper final {
         write_info.descriptorCount = 1;
         write_info.descriptorType =
             cvtBufferType2DescriptorType(binding.m_type);
-        write_info.dstArrayElement = 0;
+        write_info.dstArrayElement = m_array_index;
         write_info.pBufferInfo = &buffer_info;
         write_info.dstBinding = m_slot;
         write_info.dstSet = m_descriptor_set;
@@ -103,7 +113,7 @@ struct WriteDescriptorHelper final {
 
         write_info.descriptorCount = 1;
         write_info.pImageInfo = &image_info;
-        write_info.dstArrayElement = 0;
+        write_info.dstArrayElement = m_array_index;
         write_info.dstBinding = m_slot;
         write_info.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
         write_info.dstSet = m_descriptor_set;
@@ -121,7 +131,7 @@ struct WriteDescriptorHelper final {
 
         write_info.descriptorCount = 1;
         write_info.pImageInfo = &image_info;
-        write_info.dstArrayElement = 0;
+        write_info.dstArrayElement = m_array_index;
         write_info.dstSet = m_descriptor_set;
         write_info.dstBinding = m_slot;
         write_info.descriptorType = cvtImageType2DescriptorType(binding.m_type);
@@ -140,7 +150,7 @@ struct WriteDescriptorHelper final {
 
         write_info.descriptorCount = 1;
         write_info.pImageInfo = &image_info;
-        write_info.dstArrayElement = 0;
+        write_info.dstArrayElement = m_array_index;
         write_info.dstSet = m_descriptor_set;
         write_info.dstBinding = m_slot;
         write_info.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -152,6 +162,7 @@ private:
     DeviceImpl& m_device;
     VkDescriptorSet m_descriptor_set;
     uint32_t m_slot{};
+    uint32_t m_array_index{};
 };
 
 void BindGroupImpl::writeDescriptors(const BindGroup::Descriptor& desc) const {
@@ -161,6 +172,12 @@ void BindGroupImpl::writeDescriptors(const BindGroup::Descriptor& desc) const {
     }
 }
 
+void BindGroupImpl::UpdateArrayElement(uint32_t slot, uint32_t index,
+                                       const BindGroup::BindingPoint& binding) {
+    WriteDescriptorHelper helper{m_device, slot, m_descriptor_set, index};
+    std::visit(helper, binding.m_entry);
+}
+
 const BindGroup::Descriptor& BindGroupImpl::GetDescriptor() const {
     return m_desc;
 }
@@ -58,14 +58,55 @@ BindGroupLayoutImpl::BindGroupLayoutImpl(
     BindGroupPool& pool, uint32_t descriptor_set_count)
     : m_device{dev} {
     m_layout = createLayout(dev, desc);
-    createSets(dev, pool.m_pool, descriptor_set_count);
+    if (IsBindless(desc)) {
+        // update-after-bind sets need a pool created for them
+        m_bindless_pool = createBindlessPool(dev, desc, descriptor_set_count);
+        createSets(dev, m_bindless_pool, descriptor_set_count);
+    } else {
+        createSets(dev, pool.m_pool, descriptor_set_count);
+    }
+}
+
+bool BindGroupLayoutImpl::IsBindless(const BindGroupLayout::Descriptor& desc) {
+    return std::ranges::any_of(desc.m_entries, [](auto& pair) {
+        return pair.second.m_bindless;
+    });
+}
+
+VkDescriptorPool BindGroupLayoutImpl::createBindlessPool(
+    DeviceImpl& dev, const BindGroupLayout::Descriptor& desc,
+    uint32_t descriptor_set_count) {
+    std::vector<VkDescriptorPoolSize> pool_sizes;
+    for (auto&& [_, entry] : desc.m_entries) {
+        VkDescriptorPoolSize size;
+        size.type = BindGroupEntryType2Vk(entry.m_type);
+        size.descriptorCount = entry.m_array_size * descriptor_set_count;
+        pool_sizes.push_back(size);
+    }
+
+    VkDescriptorPoolCreateInfo ci{};
+    ci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    ci.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    ci.maxSets = descriptor_set_count;
+    ci.poolSizeCount = pool_sizes.size();
+    ci.pPoolSizes = pool_sizes.data();
+
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VK_CALL(vkCreateDescriptorPool(dev.m_device, &ci, nullptr, &pool));
+    return pool;
 }
 
 VkDescriptorSetLayout BindGroupLayoutImpl::createLayout(
     DeviceImpl& dev, const BindGroupLayout::Descriptor& desc) {
     std::vector<VkDescriptorSetLayoutBinding> bindings;
+    std::vector<VkDescriptorBindingFlags> binding_flags;
     for (auto&& [slot, entry] : desc.m_entries) {
         bindings.emplace_back(getBinding(slot, entry));
+        binding_flags.push_back(
+            entry.m_bindless
+                ? VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                      VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+                : 0);
     }
 
     VkDescriptorSetLayoutCreateInfo ci{};
@@ -73,6 +114,16 @@ VkDescriptorSetLayout BindGroupLayoutImpl::createLayout(
     ci.bindingCount = bindings.size();
     ci.pBindings = bindings.data();
 
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flags_ci{};
+    flags_ci.sType =
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    flags_ci.bindingCount = binding_flags.size();
+    flags_ci.pBindingFlags = binding_flags.data();
+    if (IsBindless(desc)) {
+        ci.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        ci.pNext = &flags_ci;
+    }
+
     VkDescriptorSetLayout layout = VK_NULL_HANDLE;
 
     VK_CALL(vkCreateDescriptorSetLayout(dev.m_device, &ci, nullptr, &layout));
@@ -128,6 +179,9 @@ VkDescriptorSetLayoutBinding BindGroupLayoutImpl::getBinding(
 
 BindGroupLayoutImpl::~BindGroupLayoutImpl() {
     m_bind_group_allocator.FreeAll();
+    if (m_bindless_pool) {
+        vkDestroyDescriptorPool(m_device.m_device, m_bindless_pool, nullptr);
+    }
     vkDestroyDescriptorSetLayout(m_device.m_device, m_layout, nullptr);
 }
 
@@ -135,7 +189,7 @@ void BindGroupLayoutImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_bind_group_layout_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_bind_group_layout_allocator, this);
     }
 }
 
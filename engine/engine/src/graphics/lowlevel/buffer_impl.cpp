@@ -177,7 +177,7 @@ void BufferImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_buffer_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_buffer_allocator, this);
     }
 }
 
@@ -2,19 +2,137 @@
 
 #include "nickel/common/macro.hpp"
 #include "nickel/graphics/lowlevel/framebuffer.hpp"
+#include "nickel/graphics/lowlevel/internal/adapter_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/bind_group_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/buffer_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/cmd_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/compute_pipeline_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/device_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/enum_convert.hpp"
 #include "nickel/graphics/lowlevel/internal/framebuffer_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/graphics_pipeline_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/image_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/image_view_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/pipeline_layout_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/render_pass_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/vk_call.hpp"
 
 namespace nickel::graphics {
 
+namespace {
+
+VkImageAspectFlags GetImageAspect(VkFormat format) {
+    if (format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT) {
+        return VK_IMAGE_ASPECT_DEPTH_BIT;
+    }
+    if (format == VK_FORMAT_S8_UINT) {
+        return VK_IMAGE_ASPECT_STENCIL_BIT;
+    }
+    if (format == VK_FORMAT_D16_UNORM_S8_UINT ||
+        format == VK_FORMAT_D24_UNORM_S8_UINT ||
+        format == VK_FORMAT_D32_SFLOAT_S8_UINT) {
+        return VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT;
+    }
+    return VK_IMAGE_ASPECT_COLOR_BIT;
+}
+
+/// move layers of `impl` which aren't in `layout` yet to it
+void TransferImageLayout(CommandEncoderImpl& cmd, ImageImpl& impl,
+                         ImageLayout layout, VkPipelineStageFlags dst_stage,
+                         VkAccessFlags dst_access) {
+    VkImageLayout vk_layout = ImageLayout2Vk(layout);
+    for (size_t i = 0; i < impl.m_layouts.size(); i++) {
+        auto old_layout = cmd.QueryImageLayout(&impl, i);
+        if (!old_layout) {
+            old_layout = ImageLayout2Vk(impl.m_layouts[i]);
+        }
+        if (old_layout == vk_layout) {
+            continue;
+        }
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.image = impl.m_image;
+        barrier.oldLayout = old_layout.value();
+        barrier.newLayout = vk_layout;
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dst_access;
+        barrier.subresourceRange.aspectMask = GetImageAspect(impl.Format());
+        barrier.subresourceRange.layerCount = 1;
+        barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+        barrier.subresourceRange.baseArrayLayer = i;
+        barrier.subresourceRange.baseMipLevel = 0;
+        vkCmdPipelineBarrier(cmd.m_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                             dst_stage, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+        cmd.AddLayoutTransition(&impl, layout, i);
+    }
+}
+
+/// storage images are moved to `General`, sampled ones to
+/// `ShaderReadOnlyOptimal`
+void TransferImageLayoutInBindGroup(CommandEncoderImpl& cmd,
+                                    const BindGroup& bind_group,
+                                    VkPipelineStageFlags dst_stage) {
+    auto& desc = bind_group.GetImpl()->GetDescriptor();
+    for (auto& [_, entry] : desc.m_entries) {
+        auto& bind_entry = entry.m_binding.m_entry;
+        if (auto binding = std::get_if<BindGroup::ImageBinding>(&bind_entry)) {
+            ImageImpl* image = binding->m_view.GetImage().GetImpl();
+            NICKEL_CONTINUE_IF_FALSE(image);
+            if (binding->m_type == BindGroup::ImageBinding::Type::StorageImage) {
+                TransferImageLayout(
+                    cmd, *image, ImageLayout::General, dst_stage,
+                    VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+            } else {
+                TransferImageLayout(cmd, *image,
+                                    ImageLayout::ShaderReadOnlyOptimal,
+                                    dst_stage, VK_ACCESS_SHADER_READ_BIT);
+            }
+        }
+        if (auto binding =
+                std::get_if<BindGroup::CombinedSamplerBinding>(&bind_entry)) {
+            ImageImpl* image = binding->m_view.GetImage().GetImpl();
+            NICKEL_CONTINUE_IF_FALSE(image);
+            TransferImageLayout(cmd, *image, ImageLayout::ShaderReadOnlyOptimal,
+                                dst_stage, VK_ACCESS_SHADER_READ_BIT);
+        }
+    }
+}
+
+/// @brief offsets of dynamic buffer bindings in slot order, taken from
+/// `m_offset` of the bindings
+std::vector<uint32_t> GetDynamicOffsets(const BindGroup& bind_group) {
+    std::vector<uint32_t> dynamic_offsets;
+    auto& desc = bind_group.GetDescriptor();
+    for (auto& [slot, entry] : desc.m_entries) {
+        auto buffer_binding =
+            std::get_if<BindGroup::BufferBinding>(&entry.m_binding.m_entry);
+        NICKEL_CONTINUE_IF_FALSE(buffer_binding);
+
+        if (buffer_binding->m_type ==
+                BindGroup::BufferBinding::Type::DynamicUniform ||
+            buffer_binding->m_type ==
+                BindGroup::BufferBinding::Type::DynamicStorage) {
+            dynamic_offsets.push_back(buffer_binding->m_offset.value_or(0));
+        }
+    }
+    return dynamic_offsets;
+}
+
+void InsertMemoryBarrier(CommandEncoderImpl& cmd, VkPipelineStageFlags src_stage,
+                   VkAccessFlags src_access, VkPipelineStageFlags dst_stage,
+                   VkAccessFlags dst_access) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = src_access;
+    barrier.dstAccessMask = dst_access;
+    vkCmdPipelineBarrier(cmd.m_cmd, src_stage, dst_stage, 0, 1, &barrier, 0,
+                         nullptr, 0, nullptr);
+}
+
+}  // namespace
+
 struct RenderPassEncoder::ApplyRenderCmd {
     explicit ApplyRenderCmd(CommandEncoderImpl& cmd) : m_cmd{cmd} {}
 
@@ -59,10 +177,54 @@ struct RenderPassEncoder::ApplyRenderCmd {
         }
     }
 
+    void operator()(const DrawIndirectCmd& cmd) {
+        VkBuffer buffer = cmd.m_buffer.GetImpl()->m_buffer;
+        auto& features = m_cmd.GetDevice().GetAdapter().GetFeatures();
+
+        if (cmd.m_count_buffer) {
+            NICKEL_RETURN_IF_FALSE_LOGE(features.draw_indirect_count,
+                                        "draw indirect count not supported");
+            VkBuffer count_buffer = cmd.m_count_buffer.GetImpl()->m_buffer;
+            if (cmd.m_indexed) {
+                vkCmdDrawIndexedIndirectCount(
+                    m_cmd.m_cmd, buffer, cmd.m_offset, count_buffer,
+                    cmd.m_count_offset, cmd.m_draw_count, cmd.m_stride);
+            } else {
+                vkCmdDrawIndirectCount(m_cmd.m_cmd, buffer, cmd.m_offset,
+                                       count_buffer, cmd.m_count_offset,
+                                       cmd.m_draw_count, cmd.m_stride);
+            }
+            return;
+        }
+
+        // without multi draw indirect a draw count above 1 is invalid
+        uint32_t batch = features.multi_draw_indirect
+                             ? cmd.m_draw_count
+                             : std::min(cmd.m_draw_count, 1u);
+        for (uint32_t i = 0; i < cmd.m_draw_count; i += batch) {
+            uint64_t offset = cmd.m_offset + uint64_t(i) * cmd.m_stride;
+            if (cmd.m_indexed) {
+                vkCmdDrawIndexedIndirect(m_cmd.m_cmd, buffer, offset, batch,
+                                         cmd.m_stride);
+            } else {
+                vkCmdDrawIndirect(m_cmd.m_cmd, buffer, offset, batch,
+                                  cmd.m_stride);
+            }
+        }
+    }
+
     void operator()(const NextSubpassCmd& cmd) {
         vkCmdNextSubpass(m_cmd.m_cmd, SubpassContent2Vk(cmd.m_content));
     }
 
+    void operator()(const BeginProfileScopeCmd& cmd) {
+        m_cmd.GetDevice().m_gpu_profiler->BeginScope(m_cmd.m_cmd, cmd.m_name);
+    }
+
+    void operator()(const EndProfileScopeCmd&) {
+        m_cmd.GetDevice().m_gpu_profiler->EndScope(m_cmd.m_cmd);
+    }
+
     void operator()(const SetViewportCmd& cmd) {
         VkViewport viewport;
         viewport.x = cmd.m_x;
@@ -84,35 +246,26 @@ struct RenderPassEncoder::ApplyRenderCmd {
     }
 
     void operator()(const SetBindGroupCmd& cmd) {
-        auto& desc = cmd.m_bind_group->GetDescriptor();
-        std::vector<uint32_t> dynamic_offsets;
-        std::vector<uint32_t> slots;
-        for (auto& [slot, entry] : desc.m_entries) {
-            slots.push_back(slot);
+        if (cmd.m_has_dynamic_offsets) {
+            bindDescriptorSet(cmd, std::span{cmd.m_dynamic_offsets.data(),
+                                             cmd.m_dynamic_offset_count});
+            return;
         }
+        bindDescriptorSet(cmd, GetDynamicOffsets(*cmd.m_bind_group));
+    }
 
-        std::ranges::sort(slots);
-
-        for (auto& slot : slots) {
-            auto& entry = desc.m_entries.at(slot).m_binding.m_entry;
-            auto buffer_binding = std::get_if<BindGroup::BufferBinding>(&entry);
-            NICKEL_CONTINUE_IF_FALSE(buffer_binding);
-
-            if (buffer_binding->m_offset) {
-                dynamic_offsets.push_back(buffer_binding->m_offset.value());
-            }
-        }
+private:
+    CommandEncoderImpl& m_cmd;
+    const GraphicsPipeline* m_pipeline{};
 
+    void bindDescriptorSet(const SetBindGroupCmd& cmd,
+                           std::span<const uint32_t> dynamic_offsets) {
         vkCmdBindDescriptorSets(
             m_cmd.m_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS,
             m_pipeline->GetImpl()->m_layout.GetImpl()->m_pipeline_layout,
             cmd.m_set, 1, &cmd.m_bind_group->GetImpl()->m_descriptor_set,
             dynamic_offsets.size(), dynamic_offsets.data());
     }
-
-private:
-    CommandEncoderImpl& m_cmd;
-    const GraphicsPipeline* m_pipeline{};
 };
 
 ClearValue::ClearValue(float r, float g, float b, float a) {
@@ -166,6 +319,62 @@ void RenderPassEncoder::DrawIndexed(uint32_t index_count,
     m_record_cmds.push_back(cmd);
 }
 
+void RenderPassEncoder::DrawIndirect(const Buffer& buffer, uint64_t offset,
+                                     uint32_t draw_count, uint32_t stride) {
+    DrawIndirectCmd cmd;
+    cmd.m_buffer = buffer;
+    cmd.m_offset = offset;
+    cmd.m_draw_count = draw_count;
+    cmd.m_stride = stride;
+    m_record_cmds.push_back(cmd);
+}
+
+void RenderPassEncoder::DrawIndexedIndirect(const Buffer& buffer,
+                                            uint64_t offset,
+                                            uint32_t draw_count,
+                                            uint32_t stride) {
+    DrawIndirectCmd cmd;
+    cmd.m_indexed = true;
+    cmd.m_buffer = buffer;
+    cmd.m_offset = offset;
+    cmd.m_draw_count = draw_count;
+    cmd.m_stride = stride;
+    m_record_cmds.push_back(cmd);
+}
+
+void RenderPassEncoder::DrawIndirectCount(const Buffer& buffer,
+                                          uint64_t offset,
+                                          const Buffer& count_buffer,
+                                          uint64_t count_offset,
+                                          uint32_t max_draw_count,
+                                          uint32_t stride) {
+    DrawIndirectCmd cmd;
+    cmd.m_buffer = buffer;
+    cmd.m_offset = offset;
+    cmd.m_count_buffer = count_buffer;
+    cmd.m_count_offset = count_offset;
+    cmd.m_draw_count = max_draw_count;
+    cmd.m_stride = stride;
+    m_record_cmds.push_back(cmd);
+}
+
+void RenderPassEncoder::DrawIndexedIndirectCount(const Buffer& buffer,
+                                                 uint64_t offset,
+                                                 const Buffer& count_buffer,
+                                                 uint64_t count_offset,
+                                                 uint32_t max_draw_count,
+                                                 uint32_t stride) {
+    DrawIndirectCmd cmd;
+    cmd.m_indexed = true;
+    cmd.m_buffer = buffer;
+    cmd.m_offset = offset;
+    cmd.m_count_buffer = count_buffer;
+    cmd.m_count_offset = count_offset;
+    cmd.m_draw_count = max_draw_count;
+    cmd.m_stride = stride;
+    m_record_cmds.push_back(cmd);
+}
+
 void RenderPassEncoder::BindVertexBuffer(uint32_t slot, Buffer buffer,
                                          uint64_t offset) {
     BindVertexBufferCmd cmd;
@@ -193,6 +402,28 @@ void RenderPassEncoder::SetBindGroup(uint32_t set, BindGroup& bind_group) {
     transferImageLayoutInBindGroup(bind_group);
 }
 
+void RenderPassEncoder::SetBindGroup(
+    uint32_t set, const BindGroup& bind_group,
+    std::span<const uint32_t> dynamic_offsets) {
+    NICKEL_RETURN_IF_FALSE_LOGE(dynamic_offsets.size() <= MaxDynamicOffsets,
+                                "at most {} dynamic offsets in one bind group",
+                                MaxDynamicOffsets);
+
+    SetBindGroupCmd cmd;
+    cmd.m_bind_group = &bind_group;
+    cmd.m_set = set;
+    std::ranges::copy(dynamic_offsets, cmd.m_dynamic_offsets.begin());
+    cmd.m_dynamic_offset_count = dynamic_offsets.size();
+    cmd.m_has_dynamic_offsets = true;
+    m_record_cmds.push_back(cmd);
+
+    transferImageLayoutInBindGroup(bind_group);
+}
+
+void RenderPassEncoder::UseImage(const ImageView& view) {
+    transferImageLayout2ShaderReadOnlyOptimal(*view.GetImage().GetImpl());
+}
+
 void RenderPassEncoder::SetPushConstant(Flags<ShaderStage> stage,
                                         const void* value, uint32_t offset,
                                         uint32_t size) {
@@ -237,6 +468,14 @@ void RenderPassEncoder::NextSubpass(SubpassContent content) {
     m_record_cmds.push_back(NextSubpassCmd{content});
 }
 
+void RenderPassEncoder::BeginProfileScope(std::string_view name) {
+    m_record_cmds.push_back(BeginProfileScopeCmd{std::string{name}});
+}
+
+void RenderPassEncoder::EndProfileScope() {
+    m_record_cmds.push_back(EndProfileScopeCmd{});
+}
+
 void RenderPassEncoder::End() {
     beginRenderPass();
 
@@ -246,71 +485,38 @@ void RenderPassEncoder::End() {
     }
     m_record_cmds.clear();
     vkCmdEndRenderPass(m_cmd.m_cmd);
-}
-
-void RenderPassEncoder::transferImageLayoutInBindGroup(
-    BindGroup& bind_group) const {
-    auto& desc = bind_group.GetImpl()->GetDescriptor();
-    for (auto& [_, entry] : desc.m_entries) {
-        auto& bind_entry = entry.m_binding.m_entry;
-        ImageImpl* image_impl{};
-        if (auto binding = std::get_if<BindGroup::ImageBinding>(&bind_entry)) {
-            image_impl = binding->m_view.GetImage().GetImpl();
-        }
-        if (auto binding =
-                std::get_if<BindGroup::CombinedSamplerBinding>(&bind_entry)) {
-            image_impl = binding->m_view.GetImage().GetImpl();
-        }
 
-        if (!image_impl) {
+    // attachments are left in the final layouts of the render pass, later
+    // barriers (e.g. readback copies) must start from them
+    auto& final_layouts =
+        m_render_pass_info.m_render_pass.GetImpl()->m_final_layouts;
+    auto& views = m_render_pass_info.m_fbo.GetImpl()->m_views;
+    for (size_t i = 0; i < views.size() && i < final_layouts.size(); i++) {
+        auto view = views[i].GetImpl();
+        // swapchain images have no ImageImpl and aren't tracked
+        ImageImpl* image = view->m_image.GetImpl();
+        if (!image) {
             continue;
         }
-
-        transferImageLayout2ShaderReadOnlyOptimal(*image_impl);
+        auto& range = view->m_subresource_range;
+        for (uint32_t layer = range.m_base_array_layer;
+             layer < range.m_base_array_layer + range.m_layer_count; layer++) {
+            m_cmd.AddLayoutTransition(image, final_layouts[i], layer);
+        }
     }
 }
 
+void RenderPassEncoder::transferImageLayoutInBindGroup(
+    const BindGroup& bind_group) const {
+    TransferImageLayoutInBindGroup(m_cmd, bind_group,
+                                   VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+}
+
 void RenderPassEncoder::transferImageLayout2ShaderReadOnlyOptimal(
     ImageImpl& impl) const {
-    VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
-    auto format = impl.Format();
-    if (format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_D32_SFLOAT) {
-        aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
-    }
-    if (format == VK_FORMAT_S8_UINT) {
-        aspect = VK_IMAGE_ASPECT_STENCIL_BIT;
-    }
-    if (format == VK_FORMAT_D16_UNORM_S8_UINT ||
-        format == VK_FORMAT_D24_UNORM_S8_UINT ||
-        format == VK_FORMAT_D32_SFLOAT_S8_UINT) {
-        aspect = VK_IMAGE_ASPECT_STENCIL_BIT | VK_IMAGE_ASPECT_DEPTH_BIT;
-    }
-
-    for (size_t i = 0; i < impl.m_layouts.size(); i++) {
-        auto layout = m_cmd.QueryImageLayout(&impl, i);
-        if (!layout) {
-            layout = ImageLayout2Vk(impl.m_layouts[i]);
-        }
-        if (layout != VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            VkImageMemoryBarrier barrier{};
-            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            barrier.image = impl.m_image;
-            barrier.oldLayout = layout.value();
-            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-            barrier.subresourceRange.aspectMask = aspect;
-            barrier.subresourceRange.layerCount = 1;
-            barrier.subresourceRange.levelCount = 1;
-            barrier.subresourceRange.baseArrayLayer = i;
-            barrier.subresourceRange.baseMipLevel = 0;
-            vkCmdPipelineBarrier(m_cmd.m_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0,
-                                 nullptr, 0, nullptr, 1, &barrier);
-            m_cmd.AddLayoutTransition(&impl, ImageLayout::ShaderReadOnlyOptimal,
-                                      i);
-        }
-    }
+    TransferImageLayout(m_cmd, impl, ImageLayout::ShaderReadOnlyOptimal,
+                        VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                        VK_ACCESS_SHADER_READ_BIT);
 }
 
 void RenderPassEncoder::beginRenderPass() {
@@ -364,6 +570,155 @@ void RenderPassEncoder::beginRenderPass() {
     m_cmd.m_flags |= CommandEncoderImpl::Flag::Render;
 }
 
+struct ComputePassEncoder::ApplyComputeCmd {
+    explicit ApplyComputeCmd(CommandEncoderImpl& cmd) : m_cmd{cmd} {}
+
+    void operator()(const BindPipelineCmd& cmd) {
+        vkCmdBindPipeline(m_cmd.m_cmd, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          cmd.m_pipeline.GetImpl()->m_pipeline);
+        m_pipeline = &cmd.m_pipeline;
+    }
+
+    void operator()(const SetBindGroupCmd& cmd) {
+        // barriers can't be recorded between bind & dispatch of a render
+        // pass, but compute passes have no such limit
+        TransferImageLayoutInBindGroup(m_cmd, *cmd.m_bind_group,
+                                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+        vkCmdBindDescriptorSets(
+            m_cmd.m_cmd, VK_PIPELINE_BIND_POINT_COMPUTE, getPipelineLayout(),
+            cmd.m_set, 1, &cmd.m_bind_group->GetImpl()->m_descriptor_set,
+            cmd.m_dynamic_offsets.size(), cmd.m_dynamic_offsets.data());
+    }
+
+    void operator()(const SetPushConstantCmd& cmd) {
+        vkCmdPushConstants(m_cmd.m_cmd, getPipelineLayout(),
+                           VK_SHADER_STAGE_COMPUTE_BIT, cmd.m_offset,
+                           cmd.m_size, cmd.m_data);
+    }
+
+    void operator()(const DispatchCmd& cmd) {
+        waitPreviousWrites();
+        vkCmdDispatch(m_cmd.m_cmd, cmd.m_x, cmd.m_y, cmd.m_z);
+    }
+
+    void operator()(const DispatchIndirectCmd& cmd) {
+        waitPreviousWrites();
+        vkCmdDispatchIndirect(m_cmd.m_cmd, cmd.m_buffer.GetImpl()->m_buffer,
+                              cmd.m_offset);
+    }
+
+    void operator()(const BeginProfileScopeCmd& cmd) {
+        m_cmd.GetDevice().m_gpu_profiler->BeginScope(m_cmd.m_cmd, cmd.m_name);
+    }
+
+    void operator()(const EndProfileScopeCmd&) {
+        m_cmd.GetDevice().m_gpu_profiler->EndScope(m_cmd.m_cmd);
+    }
+
+private:
+    CommandEncoderImpl& m_cmd;
+    const ComputePipeline* m_pipeline{};
+    bool m_dispatched = false;
+
+    VkPipelineLayout getPipelineLayout() const {
+        return m_pipeline->GetImpl()->m_layout.GetImpl()->m_pipeline_layout;
+    }
+
+    // first dispatch waits for anything recorded before the pass (e.g.
+    // uploads), later ones for the dispatches before them
+    void waitPreviousWrites() {
+        constexpr VkAccessFlags dst_access = VK_ACCESS_SHADER_READ_BIT |
+                                             VK_ACCESS_SHADER_WRITE_BIT |
+                                             VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        constexpr VkPipelineStageFlags dst_stage =
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+            VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+        if (m_dispatched) {
+            InsertMemoryBarrier(m_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                          VK_ACCESS_SHADER_WRITE_BIT, dst_stage, dst_access);
+        } else {
+            InsertMemoryBarrier(m_cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                          VK_ACCESS_MEMORY_WRITE_BIT, dst_stage, dst_access);
+        }
+        m_dispatched = true;
+    }
+};
+
+ComputePassEncoder::ComputePassEncoder(CommandEncoderImpl& cmd) : m_cmd{cmd} {}
+
+void ComputePassEncoder::BindComputePipeline(const ComputePipeline& pipeline) {
+    m_record_cmds.push_back(BindPipelineCmd{pipeline});
+}
+
+void ComputePassEncoder::SetBindGroup(uint32_t set,
+                                      const BindGroup& bind_group) {
+    m_record_cmds.push_back(
+        SetBindGroupCmd{set, &bind_group, GetDynamicOffsets(bind_group)});
+}
+
+void ComputePassEncoder::SetBindGroup(
+    uint32_t set, const BindGroup& bind_group,
+    std::span<const uint32_t> dynamic_offsets) {
+    m_record_cmds.push_back(SetBindGroupCmd{
+        set, &bind_group,
+        std::vector<uint32_t>{dynamic_offsets.begin(), dynamic_offsets.end()}});
+}
+
+void ComputePassEncoder::SetPushConstant(const void* value, uint32_t offset,
+                                         uint32_t size) {
+    NICKEL_ASSERT(size <= 128,
+                  "currently we don't support > 128 bytes in push constants");
+
+    SetPushConstantCmd cmd;
+    memcpy(cmd.m_data, value, size);
+    cmd.m_offset = offset;
+    cmd.m_size = size;
+    m_record_cmds.push_back(cmd);
+}
+
+void ComputePassEncoder::Dispatch(uint32_t x, uint32_t y, uint32_t z) {
+    m_record_cmds.push_back(DispatchCmd{x, y, z});
+}
+
+void ComputePassEncoder::DispatchIndirect(const Buffer& buffer,
+                                          uint64_t offset) {
+    m_record_cmds.push_back(DispatchIndirectCmd{buffer, offset});
+}
+
+void ComputePassEncoder::BeginProfileScope(std::string_view name) {
+    m_record_cmds.push_back(BeginProfileScopeCmd{std::string{name}});
+}
+
+void ComputePassEncoder::EndProfileScope() {
+    m_record_cmds.push_back(EndProfileScopeCmd{});
+}
+
+void ComputePassEncoder::End() {
+    ApplyComputeCmd applier(m_cmd);
+    for (auto& cmd : m_record_cmds) {
+        std::visit(applier, cmd);
+    }
+    m_record_cmds.clear();
+
+    InsertMemoryBarrier(m_cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_ACCESS_SHADER_WRITE_BIT,
+                  VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                      VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+                      VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT |
+                      VK_PIPELINE_STAGE_TRANSFER_BIT |
+                      VK_PIPELINE_STAGE_HOST_BIT,
+                  VK_ACCESS_INDIRECT_COMMAND_READ_BIT |
+                      VK_ACCESS_INDEX_READ_BIT |
+                      VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT |
+                      VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+                      VK_ACCESS_SHADER_WRITE_BIT |
+                      VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_HOST_READ_BIT);
+
+    m_cmd.m_flags |= CommandEncoderImpl::Flag::Compute;
+}
+
 CopyEncoder::CopyEncoder(CommandEncoderImpl& cmd) : m_cmd{cmd} {}
 
 CommandEncoder::CommandEncoder(CommandEncoderImpl& cmd) : m_cmd{cmd} {
@@ -376,6 +731,10 @@ CopyEncoder CommandEncoder::BeginCopy() {
     return CopyEncoder{m_cmd};
 }
 
+ComputePassEncoder CommandEncoder::BeginComputePass() {
+    return ComputePassEncoder{m_cmd};
+}
+
 void CopyEncoder::CopyBufferToBuffer(const Buffer& src, uint64_t src_offset,
                                      const Buffer& dst, uint64_t dst_offset,
                                      uint64_t size) {
@@ -396,6 +755,32 @@ void CopyEncoder::CopyBufferToTexture(const Buffer& src, Image& dst,
     m_image_copies.emplace_back(std::move(copy_cmd));
 }
 
+void CopyEncoder::CopyTextureToBuffer(const Image& src, const Buffer& dst,
+                                      const BufferImageCopy& copy) {
+    m_buffer_readbacks.push_back({src, dst, copy});
+}
+
+static VkBufferImageCopy BufferImageCopy2Vk(
+    const CopyEncoder::BufferImageCopy& info) {
+    VkBufferImageCopy copy{};
+    copy.bufferRowLength = info.m_buffer_row_length;
+    copy.bufferOffset = info.m_buffer_offset;
+    copy.bufferImageHeight = info.m_buffer_image_height;
+    copy.imageSubresource.aspectMask =
+        ImageAspect2Vk(info.m_image_subresource.m_aspect_mask);
+    copy.imageSubresource.layerCount = info.m_image_subresource.m_layer_count;
+    copy.imageSubresource.mipLevel = info.m_image_subresource.m_base_mip_level;
+    copy.imageSubresource.baseArrayLayer =
+        info.m_image_subresource.m_base_array_layer;
+    copy.imageOffset.x = info.m_image_offset.x;
+    copy.imageOffset.y = info.m_image_offset.y;
+    copy.imageOffset.z = info.m_image_offset.z;
+    copy.imageExtent.width = info.m_image_extent.w;
+    copy.imageExtent.height = info.m_image_extent.h;
+    copy.imageExtent.depth = info.m_image_extent.l;
+    return copy;
+}
+
 void CopyEncoder::End() {
     for (auto& copy_cmd : m_buffer_copies) {
         VkBufferCopy region;
@@ -418,6 +803,11 @@ void CopyEncoder::End() {
             if (!layout) {
                 layout = ImageLayout2Vk(copy_cmd.m_dst.GetImpl()->m_layouts[i]);
             }
+            // layout is tracked per layer, so the whole mip chain transfers
+            // at once and later copies into other levels need no barrier
+            if (layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+                continue;
+            }
             VkImageMemoryBarrier barrier{};
             barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
             barrier.image = copy_cmd.m_dst.GetImpl()->m_image;
@@ -427,12 +817,10 @@ void CopyEncoder::End() {
             barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
             barrier.subresourceRange.aspectMask =
                 ImageAspect2Vk(subresource.m_aspect_mask);
-            barrier.subresourceRange.layerCount = subresource.m_layer_count;
-            barrier.subresourceRange.levelCount = subresource.m_mip_level_count;
-            barrier.subresourceRange.baseArrayLayer =
-                subresource.m_base_array_layer;
-            barrier.subresourceRange.baseMipLevel =
-                subresource.m_base_mip_level;
+            barrier.subresourceRange.layerCount = 1;
+            barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            barrier.subresourceRange.baseArrayLayer = i;
+            barrier.subresourceRange.baseMipLevel = 0;
             vkCmdPipelineBarrier(m_cmd.m_cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
                                  VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
                                  0, nullptr, 1, &barrier);
@@ -440,25 +828,7 @@ void CopyEncoder::End() {
                                       ImageLayout::TransferDstOptimal, i);
         }
 
-        VkBufferImageCopy copy{};
-        copy.bufferRowLength = copy_cmd.m_copy.m_buffer_row_length;
-        copy.bufferOffset = copy_cmd.m_copy.m_buffer_offset;
-        copy.bufferImageHeight = copy_cmd.m_copy.m_buffer_image_height;
-        copy.imageSubresource.aspectMask =
-            ImageAspect2Vk(copy_cmd.m_copy.m_image_subresource.m_aspect_mask);
-        copy.imageSubresource.layerCount =
-            copy_cmd.m_copy.m_image_subresource.m_layer_count;
-        copy.imageSubresource.mipLevel =
-            copy_cmd.m_copy.m_image_subresource.m_base_mip_level;
-        copy.imageSubresource.baseArrayLayer =
-            copy_cmd.m_copy.m_image_subresource.m_base_array_layer;
-        copy.imageOffset.x = copy_cmd.m_copy.m_image_offset.x;
-        copy.imageOffset.y = copy_cmd.m_copy.m_image_offset.y;
-        copy.imageOffset.z = copy_cmd.m_copy.m_image_offset.z;
-        copy.imageExtent.width = copy_cmd.m_copy.m_image_extent.w;
-        copy.imageExtent.height = copy_cmd.m_copy.m_image_extent.h;
-        copy.imageExtent.depth = copy_cmd.m_copy.m_image_extent.l;
-
+        VkBufferImageCopy copy = BufferImageCopy2Vk(copy_cmd.m_copy);
         vkCmdCopyBufferToImage(m_cmd.m_cmd, copy_cmd.m_src.GetImpl()->m_buffer,
                                copy_cmd.m_dst.GetImpl()->m_image,
                                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
@@ -466,8 +836,67 @@ void CopyEncoder::End() {
         m_cmd.m_flags |= CommandEncoderImpl::Flag::Transfer;
     }
 
+    for (auto& copy_cmd : m_buffer_readbacks) {
+        auto& subresource = copy_cmd.m_copy.m_image_subresource;
+        ImageImpl* image = copy_cmd.m_src.GetImpl();
+        for (size_t i = subresource.m_base_array_layer;
+             i < subresource.m_base_array_layer + subresource.m_layer_count;
+             i++) {
+            auto layout = m_cmd.QueryImageLayout(image, i);
+            if (!layout) {
+                layout = ImageLayout2Vk(image->m_layouts[i]);
+            }
+            if (layout == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) {
+                continue;
+            }
+            // image was most likely rendered to, wait for any earlier write
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.image = image->m_image;
+            barrier.oldLayout = layout.value();
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.subresourceRange.aspectMask =
+                ImageAspect2Vk(subresource.m_aspect_mask);
+            barrier.subresourceRange.layerCount = 1;
+            barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+            barrier.subresourceRange.baseArrayLayer = i;
+            barrier.subresourceRange.baseMipLevel = 0;
+            vkCmdPipelineBarrier(m_cmd.m_cmd,
+                                 VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+                                 VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+                                 0, nullptr, 1, &barrier);
+            m_cmd.AddLayoutTransition(image, ImageLayout::TransferSrcOptimal,
+                                      i);
+        }
+
+        VkBufferImageCopy copy = BufferImageCopy2Vk(copy_cmd.m_copy);
+        vkCmdCopyImageToBuffer(m_cmd.m_cmd, image->m_image,
+                               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               copy_cmd.m_dst.GetImpl()->m_buffer, 1, &copy);
+
+        // make the copy visible to mapped memory
+        VkBufferMemoryBarrier buffer_barrier{};
+        buffer_barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        buffer_barrier.buffer = copy_cmd.m_dst.GetImpl()->m_buffer;
+        buffer_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        buffer_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        buffer_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        buffer_barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(m_cmd.m_cmd, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1,
+                             &buffer_barrier, 0, nullptr);
+
+        m_cmd.m_flags |= CommandEncoderImpl::Flag::Transfer;
+    }
+
     m_buffer_copies.clear();
     m_image_copies.clear();
+    m_buffer_readbacks.clear();
 }
 
 RenderPassEncoder CommandEncoder::BeginRenderPass(
@@ -477,6 +906,58 @@ RenderPassEncoder CommandEncoder::BeginRenderPass(
                              clear_values};
 }
 
+void CommandEncoder::PipelineBarrier(std::span<const ImageBarrier> barriers) {
+    std::vector<VkImageMemoryBarrier> vk_barriers;
+    VkPipelineStageFlags src_stage = 0, dst_stage = 0;
+    for (auto& barrier : barriers) {
+        auto view = barrier.m_view.GetImpl();
+        NICKEL_CONTINUE_IF_FALSE(view);
+        Image image_handle = view->GetImage();
+        ImageImpl* image = image_handle.GetImpl();
+        auto& range = view->m_subresource_range;
+
+        VkImageMemoryBarrier vk_barrier{};
+        vk_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        vk_barrier.image = image ? image->m_image : view->m_swapchain_image;
+        vk_barrier.oldLayout = ImageLayout2Vk(barrier.m_old_layout);
+        vk_barrier.newLayout = ImageLayout2Vk(barrier.m_new_layout);
+        vk_barrier.srcAccessMask = Access2Vk(barrier.m_src_access);
+        vk_barrier.dstAccessMask = Access2Vk(barrier.m_dst_access);
+        vk_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        vk_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        // depth & stencil of one image change layout together
+        vk_barrier.subresourceRange.aspectMask =
+            image ? GetImageAspect(image->Format())
+                  : ImageAspect2Vk(range.m_aspect_mask);
+        vk_barrier.subresourceRange.baseMipLevel = range.m_base_mipLevel;
+        vk_barrier.subresourceRange.levelCount = range.m_level_count;
+        vk_barrier.subresourceRange.baseArrayLayer = range.m_base_array_layer;
+        vk_barrier.subresourceRange.layerCount = range.m_layer_count;
+        vk_barriers.push_back(vk_barrier);
+
+        src_stage |= PipelineStage2Vk(barrier.m_src_stage);
+        dst_stage |= PipelineStage2Vk(barrier.m_dst_stage);
+
+        NICKEL_CONTINUE_IF_FALSE(image);
+        for (uint32_t layer = range.m_base_array_layer;
+             layer < range.m_base_array_layer + range.m_layer_count; layer++) {
+            m_cmd.AddLayoutTransition(image, barrier.m_new_layout, layer);
+        }
+    }
+
+    NICKEL_RETURN_IF_FALSE(!vk_barriers.empty());
+    vkCmdPipelineBarrier(m_cmd.m_cmd, src_stage, dst_stage, 0, 0, nullptr, 0,
+                         nullptr, vk_barriers.size(), vk_barriers.data());
+}
+
+void CommandEncoder::BeginProfileScope(std::string_view name) {
+    m_cmd.GetDevice().m_gpu_profiler->BeginScope(m_cmd.m_cmd, name);
+}
+
+void CommandEncoder::EndProfileScope() {
+    m_cmd.GetDevice().m_gpu_profiler->EndScope(m_cmd.m_cmd);
+}
+
 Command CommandEncoder::Finish() {
     VK_CALL(vkEndCommandBuffer(m_cmd.m_cmd));
     return Command{m_cmd};
@@ -52,4 +52,8 @@ void CommandEncoderImpl::PendingDelete() {
     m_pool.m_pending_delete_cmds.push_back(this);
 }
 
+DeviceImpl& CommandEncoderImpl::GetDevice() const {
+    return m_device;
+}
+
 }  // namespace nickel::graphics
\ No newline at end of file
@@ -15,15 +15,22 @@ const SVector<uint32_t, 2> ImageRawData::GetExtent() const {
 }
 
 ImageRawData::ImageRawData(const Path& filename) {
-    int w, h;
-
     auto content = ReadWholeFile(filename);
-    m_data =
-        stbi_load_from_memory((const stbi_uc*)content.data(), content.size(),
-                              &w, &h, nullptr, STBI_rgb_alpha);
+    decode(content.data(), content.size());
     if (!m_data) {
         LOGW("load image {} failed", filename);
-    } else {
+    }
+}
+
+ImageRawData::ImageRawData(const void* content, size_t size) {
+    decode(content, size);
+}
+
+void ImageRawData::decode(const void* content, size_t size) {
+    int w, h;
+    m_data = stbi_load_from_memory((const stbi_uc*)content, size, &w, &h,
+                                   nullptr, STBI_rgb_alpha);
+    if (m_data) {
         m_extent.w = w;
         m_extent.h = h;
     }
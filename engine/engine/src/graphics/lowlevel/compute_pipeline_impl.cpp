@@ -0,0 +1,45 @@
+#include "nickel/graphics/lowlevel/internal/compute_pipeline_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/device_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/pipeline_layout_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/shader_module_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/vk_call.hpp"
+
+namespace nickel::graphics {
+
+ComputePipelineImpl::ComputePipelineImpl(
+    DeviceImpl& dev, const ComputePipeline::Descriptor& desc)
+    : m_layout{desc.m_layout}, m_device{dev} {
+    VkComputePipelineCreateInfo ci{};
+    ci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    ci.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    ci.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    ci.stage.module = desc.m_module.GetImpl()->m_module;
+    ci.stage.pName = desc.m_entry_name.c_str();
+    ci.layout = desc.m_layout.GetImpl()->m_pipeline_layout;
+
+    VkPipelineCreationFeedback feedback{};
+    VkPipelineCreationFeedbackCreateInfo feedback_ci{};
+    feedback_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+    feedback_ci.pPipelineCreationFeedback = &feedback;
+    if (dev.m_creation_feedback_supported) {
+        ci.pNext = &feedback_ci;
+    }
+
+    VK_CALL(vkCreateComputePipelines(dev.m_device, dev.m_pipeline_cache, 1,
+                                     &ci, nullptr, &m_pipeline));
+    dev.RecordPipelineCreation(feedback);
+}
+
+ComputePipelineImpl::~ComputePipelineImpl() {
+    vkDestroyPipeline(m_device.m_device, m_pipeline, nullptr);
+}
+
+void ComputePipelineImpl::DecRefcount() {
+    RefCountable::DecRefcount();
+
+    if (Refcount() == 0) {
+        m_device.DeferRelease(m_device.m_compute_pipeline_allocator, this);
+    }
+}
+
+}  // namespace nickel::graphics
@@ -46,6 +46,28 @@ GraphicsPipeline Device::CreateGraphicPipeline(
     return m_impl->CreateGraphicPipeline(desc);
 }
 
+ComputePipeline Device::CreateComputePipeline(
+    const ComputePipeline::Descriptor& desc) {
+    return m_impl->CreateComputePipeline(desc);
+}
+
+void Device::WarmupPipelines(
+    std::span<const GraphicsPipeline::Descriptor> descs, ThreadPool* pool) {
+    m_impl->WarmupPipelines(descs, pool);
+}
+
+bool Device::LoadPipelineCache(std::span<const char> data) {
+    return m_impl->LoadPipelineCache(data);
+}
+
+std::vector<char> Device::GetPipelineCacheData() const {
+    return m_impl->GetPipelineCacheData();
+}
+
+PipelineCacheStats Device::GetPipelineCacheStats() const {
+    return m_impl->GetPipelineCacheStats();
+}
+
 Sampler Device::CreateSampler(const Sampler::Descriptor& desc) {
     return m_impl->CreateSampler(desc);
 }
@@ -74,6 +96,14 @@ std::vector<ImageView> Device::GetSwapchainImageViews() const {
     return m_impl->GetSwapchainImageViews();
 }
 
+uint32_t Device::GetFramesInFlight() const {
+    return m_impl->GetFramesInFlight();
+}
+
+uint32_t Device::GetCurrentFrameIndex() const {
+    return m_impl->GetCurrentFrameIndex();
+}
+
 uint32_t Device::WaitAndAcquireSwapchainImageIndex(Semaphore sem,
                                                    std::span<Fence> fences) {
     return m_impl->WaitAndAcquireSwapchainImageIndex(sem, fences);
@@ -91,6 +121,14 @@ void Device::WaitIdle() {
     m_impl->WaitIdle();
 }
 
+ReadbackImage Device::Readback(const Image& image) {
+    return m_impl->Readback(image);
+}
+
+GPUProfiler Device::GetGPUProfiler() const {
+    return GPUProfiler{m_impl->m_gpu_profiler.get()};
+}
+
 void Device::Submit(Command& cmd, std::span<Semaphore> wait_sems,
                     std::span<Semaphore> signal_sems, Fence fence) {
     return m_impl->Submit(cmd, wait_sems, signal_sems, fence);
@@ -1,6 +1,7 @@
 ﻿#include "nickel/graphics/lowlevel/internal/device_impl.hpp"
 #include "nickel/common/log.hpp"
 #include "nickel/common/macro.hpp"
+#include "nickel/common/thread_pool.hpp"
 #include "nickel/graphics/lowlevel/fence.hpp"
 #include "nickel/graphics/lowlevel/internal/adapter_impl.hpp"
 #include "nickel/graphics/lowlevel/internal/bind_group_pool.hpp"
@@ -14,7 +15,9 @@ namespace nickel::graphics {
 
 DeviceImpl::DeviceImpl(const AdapterImpl& impl,
                        const SVector<uint32_t, 2>& window_size)
-    : m_adapter{impl} {
+    : m_adapter{impl},
+      m_frames_in_flight{std::max(impl.m_frames_in_flight, 1u)},
+      m_garbage(m_frames_in_flight) {
     m_queue_indices = chooseQueue(impl.m_phy_device, impl.m_surface);
 
     if (!m_queue_indices) {
@@ -41,8 +44,11 @@ DeviceImpl::DeviceImpl(const AdapterImpl& impl,
     device_ci.queueCreateInfoCount = queueCreateInfos.size();
     device_ci.pQueueCreateInfos = queueCreateInfos.data();
 
-    std::vector<const char*> requireExtensions = {
-        VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    // headless devices present nothing, swapchain extension is optional
+    std::vector<const char*> requireExtensions;
+    if (!impl.IsHeadless()) {
+        requireExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
     std::vector<VkExtensionProperties> extension_props;
     uint32_t extensionCount = 0;
     VK_CALL(vkEnumerateDeviceExtensionProperties(impl.m_phy_device, nullptr,
@@ -52,27 +58,25 @@ DeviceImpl::DeviceImpl(const AdapterImpl& impl,
     VK_CALL(vkEnumerateDeviceExtensionProperties(
         impl.m_phy_device, nullptr, &extensionCount, extension_props.data()));
 
-    size_t required_extensions_size = requireExtensions.size();
-
-    RemoveUnexistsElems<const char*, VkExtensionProperties>(
-        requireExtensions, extension_props,
-        [](const auto& e1, const VkExtensionProperties& e2) {
-            return std::strcmp(e1, e2.extensionName) == 0;
-        });
-
+    // filter into a new list, erasing from a list that may be empty trips
+    // -Wstringop-overread in release builds
+    std::vector<const char*> extension_names;
     for (auto ext : requireExtensions) {
-        LOGI("enable vulkan device extension: {}", ext);
+        bool supported = std::any_of(
+            extension_props.begin(), extension_props.end(),
+            [=](const VkExtensionProperties& prop) {
+                return std::strcmp(ext, prop.extensionName) == 0;
+            });
+        if (supported) {
+            LOGI("enable vulkan device extension: {}", ext);
+            extension_names.push_back(ext);
+        }
     }
 
-    if (requireExtensions.size() != required_extensions_size) {
+    if (extension_names.size() != requireExtensions.size()) {
         LOGC("some vulkan extension not support");
     }
 
-    std::vector<const char*> extension_names;
-    for (auto ext : requireExtensions) {
-        extension_names.push_back(ext);
-    }
-
     device_ci.ppEnabledExtensionNames = extension_names.data();
     device_ci.enabledExtensionCount = extension_names.size();
 
@@ -82,6 +86,24 @@ DeviceImpl::DeviceImpl(const AdapterImpl& impl,
     // features.geometryShader = true;
     device_ci.pEnabledFeatures = &features;
 
+    VkPhysicalDeviceVulkan12Features features12{};
+    features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    if (impl.GetFeatures().bindless) {
+        features12.runtimeDescriptorArray = VK_TRUE;
+        features12.descriptorBindingPartiallyBound = VK_TRUE;
+        features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        device_ci.pNext = &features12;
+    }
+    if (impl.GetFeatures().host_query_reset) {
+        features12.hostQueryReset = VK_TRUE;
+        device_ci.pNext = &features12;
+    }
+    if (impl.GetFeatures().draw_indirect_count) {
+        features12.drawIndirectCount = VK_TRUE;
+        device_ci.pNext = &features12;
+    }
+
     VK_CALL(vkCreateDevice(impl.m_phy_device, &device_ci, nullptr, &m_device));
 
     if (!m_device) {
@@ -94,11 +116,37 @@ DeviceImpl::DeviceImpl(const AdapterImpl& impl,
     vkGetDeviceQueue(m_device, m_queue_indices.m_present_index.value(), 0,
                      &m_present_queue);
 
-    m_image_info =
-        queryImageInfo(impl.m_phy_device, window_size, impl.m_surface);
-    createCmdPools();
-    createBindGroupPool();
-    createSwapchain(impl.m_phy_device, impl.m_surface);
+    if (impl.IsHeadless()) {
+        // an image is reused only after the fence of its last frame
+        m_image_info = {
+            window_size,
+            std::max(impl.m_headless->m_image_count, m_frames_in_flight),
+            SurfaceFormatKHR{Format::R8G8B8A8_UNORM,
+                             ImageColorSpace::SrgbNonlinearKHR}
+        };
+        createCmdPools();
+        createBindGroupPool();
+        createOffscreenImages();
+    } else {
+        m_image_info =
+            queryImageInfo(impl.m_phy_device, window_size, impl.m_surface);
+        createCmdPools();
+        createBindGroupPool();
+        createSwapchain(impl.m_phy_device, impl.m_surface);
+    }
+    m_gpu_profiler = std::make_unique<GPUProfilerImpl>(
+        *this, impl.m_phy_device, m_queue_indices.m_graphics_index.value(),
+        m_frames_in_flight, impl.GetFeatures().host_query_reset);
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(impl.m_phy_device, &props);
+    m_creation_feedback_supported = props.apiVersion >= VK_API_VERSION_1_3;
+    m_pipeline_cache_device.m_vendor_id = props.vendorID;
+    m_pipeline_cache_device.m_device_id = props.deviceID;
+    m_pipeline_cache_device.m_driver_version = props.driverVersion;
+    memcpy(m_pipeline_cache_device.m_uuid.data(), props.pipelineCacheUUID,
+           VK_UUID_SIZE);
+    m_pipeline_cache = createPipelineCache({});
 }
 
 DeviceImpl::QueueFamilyIndices DeviceImpl::chooseQueue(
@@ -117,6 +165,13 @@ DeviceImpl::QueueFamilyIndices DeviceImpl::chooseQueue(
         if (prop.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
             indices.m_graphics_index = i;
         }
+        if (!surface) {
+            indices.m_present_index = indices.m_graphics_index;
+            if (indices) {
+                break;
+            }
+            continue;
+        }
         VkBool32 supportSurface = false;
         VK_CALL(vkGetPhysicalDeviceSurfaceSupportKHR(phyDevice, i, surface,
                                                      &supportSurface));
@@ -242,7 +297,7 @@ VkPresentModeKHR DeviceImpl::queryPresentMode(VkPhysicalDevice dev,
 }
 
 void DeviceImpl::createCmdPools() {
-    for (int i = 0; i < m_image_info.m_image_count; i++) {
+    for (uint32_t i = 0; i < m_frames_in_flight; i++) {
         m_cmd_pools.push_back(new CommandPoolImpl(*this, 0));
     }
 }
@@ -281,56 +336,45 @@ void DeviceImpl::getAndCreateSwapchainImageViews() {
         VkImageView view;
         VK_CALL(vkCreateImageView(m_device, &ci, nullptr, &view));
         if (view) {
-            m_swapchain_image_views.push_back(
-                ImageView{m_image_view_allocator.Allocate(*this, view)});
+            // no initial transition, users start from `Undefined`
+            m_swapchain_image_views.push_back(ImageView{
+                m_image_view_allocator.Allocate(*this, image, view)});
         } else {
             LOGC("create image m_view from swapchain image failed");
         }
     }
+}
 
-    // layout transition
-    VkCommandBufferAllocateInfo info{};
-    info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    info.commandBufferCount = 1;
-    info.commandPool = m_cmd_pools[0]->m_pool;
-    VkCommandBuffer cmd;
-    VK_CALL(vkAllocateCommandBuffers(m_device, &info, &cmd));
-
-    std::vector<VkImageMemoryBarrier> barriers;
-    VkCommandBufferBeginInfo begin_info{};
-    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    VK_CALL(vkBeginCommandBuffer(cmd, &begin_info));
-    for (auto image : images) {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.image = image;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        barrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        barrier.srcAccessMask = VK_ACCESS_NONE;
-        barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barriers.push_back(barrier);
-    }
-    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-                         VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, 0, 0, nullptr, 0,
-                         nullptr, barriers.size(), barriers.data());
-    VK_CALL(vkEndCommandBuffer(cmd));
-
-    VkSubmitInfo submit{};
-    submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit.commandBufferCount = 1;
-    submit.pCommandBuffers = &cmd;
-    VK_CALL(vkQueueSubmit(m_graphics_queue, 1, &submit, VK_NULL_HANDLE));
-    WaitIdle();
+void DeviceImpl::createOffscreenImages() {
+    for (uint32_t i = 0; i < m_image_info.m_image_count; i++) {
+        Image::Descriptor desc;
+        desc.m_image_type = ImageType::Dim2;
+        desc.m_extent.w = m_image_info.m_extent.w;
+        desc.m_extent.h = m_image_info.m_extent.h;
+        desc.m_extent.l = 1;
+        desc.m_format = m_image_info.m_surface_format.format;
+        desc.m_usage = Flags{ImageUsage::ColorAttachment} |
+                       ImageUsage::CopySrc | ImageUsage::Sampled;
+        desc.m_tiling = ImageTiling::Optimal;
+        Image image = CreateImage(desc);
+
+        ImageView::Descriptor view_desc;
+        view_desc.m_format = desc.m_format;
+        view_desc.m_components = ComponentMapping::SwizzleIdentity;
+        view_desc.m_subresource_range.m_aspect_mask = ImageAspect::Color;
+        view_desc.m_view_type = ImageViewType::Dim2;
+        m_swapchain_image_views.push_back(image.CreateView(view_desc));
+    }
+}
 
-    VK_CALL(vkResetCommandPool(m_device, m_cmd_pools[0]->m_pool, 0));
+void DeviceImpl::signalSemaphore(Semaphore sem) {
+    NICKEL_RETURN_IF_FALSE(sem);
+
+    VkSubmitInfo info{};
+    info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    info.signalSemaphoreCount = 1;
+    info.pSignalSemaphores = &sem.GetImpl()->m_semaphore;
+    VK_CALL(vkQueueSubmit(m_graphics_queue, 1, &info, VK_NULL_HANDLE));
 }
 
 DeviceImpl::~DeviceImpl() {
@@ -347,17 +391,23 @@ DeviceImpl::~DeviceImpl() {
     m_shader_module_allocator.FreeAll();
 
     m_buffer_allocator.FreeAll();
+    m_samplers.clear();
     m_sampler_allocator.FreeAll();
     m_graphics_pipeline_allocator.FreeAll();
+    m_compute_pipeline_allocator.FreeAll();
+    vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
     m_pipeline_layout_allocator.FreeAll();
     m_render_pass_allocator.FreeAll();
 
     m_semaphore_allocator.FreeAll();
     m_fence_allocator.FreeAll();
+    m_gpu_profiler.reset();
     for (auto pool : m_cmd_pools) {
         delete pool;
     }
-    vkDestroySwapchainKHR(m_device, m_swapchain, nullptr);
+    if (m_swapchain) {
+        vkDestroySwapchainKHR(m_device, m_swapchain, nullptr);
+    }
     vkDestroyDevice(m_device, nullptr);
 }
 
@@ -368,10 +418,14 @@ void DeviceImpl::cleanUpOneFrame() {
     m_image_view_allocator.GC();
     m_image_allocator.GC();
     m_render_pass_allocator.GC();
-    m_sampler_allocator.GC();
+    {
+        std::lock_guard lock{m_sampler_mutex};
+        m_sampler_allocator.GC();
+    }
     m_buffer_allocator.GC();
     m_pipeline_layout_allocator.GC();
     m_graphics_pipeline_allocator.GC();
+    m_compute_pipeline_allocator.GC();
     m_semaphore_allocator.GC();
     m_fence_allocator.GC();
 }
@@ -396,8 +450,12 @@ ImageView DeviceImpl::CreateImageView(const Image& image,
 
 BindGroupLayout DeviceImpl::CreateBindGroupLayout(
     const BindGroupLayout::Descriptor& desc) {
+    // bindless groups are global tables, one set serves all draws
     return m_bind_group_layout_allocator.Allocate(
-        *this, desc, *m_bind_group_pool, MaxDescriptorSetPerTypePerFrame);
+        *this, desc, *m_bind_group_pool,
+        BindGroupLayoutImpl::IsBindless(desc)
+            ? BindlessDescriptorSetCount
+            : MaxDescriptorSetPerTypePerFrame);
 }
 
 PipelineLayout DeviceImpl::CreatePipelineLayout(
@@ -419,8 +477,99 @@ GraphicsPipeline DeviceImpl::CreateGraphicPipeline(
         m_graphics_pipeline_allocator.Allocate(*this, desc)};
 }
 
+ComputePipeline DeviceImpl::CreateComputePipeline(
+    const ComputePipeline::Descriptor& desc) {
+    return ComputePipeline{
+        m_compute_pipeline_allocator.Allocate(*this, desc)};
+}
+
+void DeviceImpl::WarmupPipelines(
+    std::span<const GraphicsPipeline::Descriptor> descs, ThreadPool* pool) {
+    // pipelines are only compiled for their cache entries
+    auto compile = [this, descs](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            VkPipeline pipeline = CreateVkGraphicsPipeline(*this, descs[i]);
+            vkDestroyPipeline(m_device, pipeline, nullptr);
+        }
+    };
+
+    size_t worker_count = pool ? pool->GetThreadNum() : 0;
+    size_t chunk = (descs.size() + worker_count) / (worker_count + 1);
+    std::vector<std::future<void>> jobs;
+    size_t begin = 0;
+    for (size_t i = 0; i < worker_count && begin + chunk < descs.size(); i++) {
+        jobs.push_back(pool->Submit([=] { compile(begin, begin + chunk); }));
+        begin += chunk;
+    }
+    compile(begin, descs.size());
+    for (auto& job : jobs) {
+        job.wait();
+    }
+}
+
+VkPipelineCache DeviceImpl::createPipelineCache(std::span<const char> data) {
+    VkPipelineCacheCreateInfo ci{};
+    ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    ci.initialDataSize = data.size();
+    ci.pInitialData = data.data();
+
+    VkPipelineCache cache = VK_NULL_HANDLE;
+    VK_CALL(vkCreatePipelineCache(m_device, &ci, nullptr, &cache));
+    return cache;
+}
+
+bool DeviceImpl::LoadPipelineCache(std::span<const char> data) {
+    auto cache_data = UnpackPipelineCacheData(m_pipeline_cache_device, data);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(false, !cache_data.empty(),
+                                      "pipeline cache not loaded");
+    VkPipelineCache cache = createPipelineCache(cache_data);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(false, cache,
+                                      "driver rejected pipeline cache");
+
+    // keep pipelines compiled before loading
+    VK_CALL(vkMergePipelineCaches(m_device, cache, 1, &m_pipeline_cache));
+    vkDestroyPipelineCache(m_device, m_pipeline_cache, nullptr);
+    m_pipeline_cache = cache;
+    LOGI("pipeline cache loaded, {} bytes", cache_data.size());
+    return true;
+}
+
+std::vector<char> DeviceImpl::GetPipelineCacheData() const {
+    size_t size = 0;
+    VK_CALL(vkGetPipelineCacheData(m_device, m_pipeline_cache, &size, nullptr));
+    std::vector<char> data(size);
+    VK_CALL(vkGetPipelineCacheData(m_device, m_pipeline_cache, &size,
+                                   data.data()));
+    data.resize(size);
+    return PackPipelineCacheData(m_pipeline_cache_device, data);
+}
+
+PipelineCacheStats DeviceImpl::GetPipelineCacheStats() const {
+    return {m_pipeline_cache_hits.load(), m_pipeline_cache_misses.load()};
+}
+
+void DeviceImpl::RecordPipelineCreation(
+    const VkPipelineCreationFeedback& feedback) {
+    if ((feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) &&
+        (feedback.flags &
+         VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT)) {
+        m_pipeline_cache_hits++;
+    } else {
+        m_pipeline_cache_misses++;
+    }
+}
+
 Sampler DeviceImpl::CreateSampler(const Sampler::Descriptor& desc) {
-    return Sampler{m_sampler_allocator.Allocate(*this, desc)};
+    std::lock_guard lock{m_sampler_mutex};
+    if (auto it = m_samplers.find(desc); it != m_samplers.end()) {
+        // an entry in the map always has refcount > 0, dropping the last
+        // reference erases it under the same lock
+        it->second->RefCountable::IncRefcount();
+        return Sampler{it->second};
+    }
+    SamplerImpl* sampler = m_sampler_allocator.Allocate(*this, desc);
+    m_samplers.emplace(desc, sampler);
+    return Sampler{sampler};
 }
 
 ShaderModule DeviceImpl::CreateShaderModule(const uint32_t* data, size_t size) {
@@ -490,6 +639,18 @@ uint32_t DeviceImpl::WaitAndAcquireSwapchainImageIndex(
                             UINT64_MAX));
     VK_CALL(vkResetFences(m_device, vk_fences.size(), vk_fences.data()));
     m_cmd_pools[m_cur_frame]->Reset();
+    releaseGarbage(m_cur_frame);
+    m_garbage_frame = m_cur_frame;
+    m_gpu_profiler->BeginFrame(m_cur_frame);
+
+    // offscreen images are used round-robin, there are at least as many as
+    // frames in flight so the fence of their last frame is signaled
+    if (m_adapter.IsHeadless()) {
+        m_cur_swapchain_image_index =
+            (m_cur_swapchain_image_index + 1) % m_image_info.m_image_count;
+        signalSemaphore(sem);
+        return m_cur_swapchain_image_index;
+    }
 
     vkAcquireNextImageKHR(m_device, m_swapchain, UINT64_MAX,
                           sem ? sem.GetImpl()->m_semaphore : VK_NULL_HANDLE,
@@ -498,10 +659,66 @@ uint32_t DeviceImpl::WaitAndAcquireSwapchainImageIndex(
     return m_cur_swapchain_image_index;
 }
 
+uint32_t DeviceImpl::GetFramesInFlight() const {
+    return m_frames_in_flight;
+}
+
+uint32_t DeviceImpl::GetCurrentFrameIndex() const {
+    return m_cur_frame;
+}
+
 std::vector<ImageView> DeviceImpl::GetSwapchainImageViews() const {
     return m_swapchain_image_views;
 }
 
+ReadbackImage DeviceImpl::Readback(const Image& image) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, image, "readback invalid image");
+
+    VkFormat format = image.GetImpl()->Format();
+    bool is_bgra = format == VK_FORMAT_B8G8R8A8_UNORM ||
+                   format == VK_FORMAT_B8G8R8A8_SRGB;
+    bool is_rgba = format == VK_FORMAT_R8G8B8A8_UNORM ||
+                   format == VK_FORMAT_R8G8B8A8_SRGB;
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, is_bgra || is_rgba,
+                                      "readback of format {} not support",
+                                      static_cast<int>(format));
+
+    auto extent = image.Extent();
+    Buffer::Descriptor buffer_desc;
+    buffer_desc.m_size = uint64_t(extent.w) * extent.h * 4;
+    buffer_desc.m_usage = BufferUsage::CopyDst;
+    buffer_desc.m_memory_type = MemoryType::Coherence;
+    Buffer buffer = CreateBuffer(buffer_desc);
+
+    CommandEncoder encoder = CreateCommandEncoder();
+    CopyEncoder copy = encoder.BeginCopy();
+    CopyEncoder::BufferImageCopy copy_info;
+    copy_info.m_image_subresource.m_aspect_mask = ImageAspect::Color;
+    copy_info.m_image_extent.w = extent.w;
+    copy_info.m_image_extent.h = extent.h;
+    copy_info.m_image_extent.l = 1;
+    copy.CopyTextureToBuffer(image, buffer, copy_info);
+    copy.End();
+    Command cmd = encoder.Finish();
+    Submit(cmd, {}, {}, {});
+    WaitIdle();
+
+    ReadbackImage result;
+    result.m_extent = {extent.w, extent.h};
+    result.m_pixels.resize(buffer_desc.m_size);
+    buffer.MapAsync();
+    memcpy(result.m_pixels.data(), buffer.GetMappedRange(),
+           buffer_desc.m_size);
+    buffer.Unmap();
+
+    if (is_bgra) {
+        for (size_t i = 0; i < result.m_pixels.size(); i += 4) {
+            std::swap(result.m_pixels[i], result.m_pixels[i + 2]);
+        }
+    }
+    return result;
+}
+
 const AdapterImpl& DeviceImpl::GetAdapter() const {
     return m_adapter;
 }
@@ -510,6 +727,35 @@ void DeviceImpl::EndFrame() {
     cleanUpOneFrame();
 }
 
+void DeviceImpl::DeferRelease(std::function<void()> release) {
+    std::lock_guard lock{m_garbage_mutex};
+    m_garbage[m_garbage_frame].push_back(std::move(release));
+}
+
+void DeviceImpl::ReleaseAllGarbage() {
+    // releasing a handle may drop the last reference of another one
+    bool released = true;
+    while (released) {
+        released = false;
+        for (uint32_t i = 0; i < m_garbage.size(); i++) {
+            released = releaseGarbage(i) || released;
+        }
+    }
+}
+
+bool DeviceImpl::releaseGarbage(uint32_t frame) {
+    std::vector<std::function<void()>> garbage;
+    {
+        std::lock_guard lock{m_garbage_mutex};
+        garbage.swap(m_garbage[frame]);
+    }
+    for (auto& release : garbage) {
+        release();
+    }
+    cleanUpOneFrame();
+    return !garbage.empty();
+}
+
 void DeviceImpl::Present(std::span<Semaphore> semaphores) {
     std::vector<VkSemaphore> vk_sems;
     vk_sems.reserve(semaphores.size());
@@ -517,6 +763,20 @@ void DeviceImpl::Present(std::span<Semaphore> semaphores) {
         vk_sems.push_back(semaphore.GetImpl()->m_semaphore);
     }
 
+    if (m_adapter.IsHeadless()) {
+        // consume the semaphores so they can be signaled again next frame
+        std::vector<VkPipelineStageFlags> stages(
+            vk_sems.size(), VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        VkSubmitInfo submit{};
+        submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit.waitSemaphoreCount = vk_sems.size();
+        submit.pWaitSemaphores = vk_sems.data();
+        submit.pWaitDstStageMask = stages.data();
+        VK_CALL(vkQueueSubmit(m_graphics_queue, 1, &submit, VK_NULL_HANDLE));
+        m_cur_frame = (m_cur_frame + 1) % m_frames_in_flight;
+        return;
+    }
+
     VkPresentInfoKHR info{};
     info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
     info.pImageIndices = &m_cur_swapchain_image_index;
@@ -526,7 +786,7 @@ void DeviceImpl::Present(std::span<Semaphore> semaphores) {
     info.pSwapchains = &m_swapchain;
 
     VK_CALL(vkQueuePresentKHR(m_present_queue, &info));
-    m_cur_frame = (m_cur_frame + 1) % m_image_info.m_image_count;
+    m_cur_frame = (m_cur_frame + 1) % m_frames_in_flight;
 }
 
 void DeviceImpl::RecreateSwapchain(VkPhysicalDevice phy_device,
@@ -21,7 +21,7 @@ void FenceImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_fence_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_fence_allocator, this);
     }
 }
 
@@ -40,7 +40,7 @@ void FramebufferImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_framebuffer_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_framebuffer_allocator, this);
     }
 }
 
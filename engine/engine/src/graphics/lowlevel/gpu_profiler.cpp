@@ -0,0 +1,329 @@
+#include "nickel/graphics/lowlevel/gpu_profiler.hpp"
+#include "nickel/common/log.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/lowlevel/internal/device_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/gpu_profiler_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/vk_call.hpp"
+
+namespace nickel::graphics {
+
+constexpr uint32_t PipelineStatisticsCount = 4;
+
+double GPUFrameProfile::GetTotalTime() const {
+    double total = 0;
+    for (auto& scope : m_scopes) {
+        if (scope.m_depth == 0) {
+            total += scope.m_time_ms;
+        }
+    }
+    return total;
+}
+
+const GPUScopeResult* GPUFrameProfile::Find(std::string_view name) const {
+    for (auto& scope : m_scopes) {
+        if (scope.m_name == name) {
+            return &scope;
+        }
+    }
+    return nullptr;
+}
+
+double TimestampsToMilliseconds(uint64_t begin, uint64_t end, float period_ns,
+                                uint32_t valid_bits) {
+    uint64_t mask =
+        valid_bits >= 64 ? ~uint64_t{0} : (uint64_t{1} << valid_bits) - 1;
+    uint64_t ticks = (end - begin) & mask;
+    return ticks * double(period_ns) / 1e6;
+}
+
+GPUProfileHistory::GPUProfileHistory(uint32_t capacity)
+    : m_capacity{capacity} {}
+
+void GPUProfileHistory::Push(const GPUFrameProfile& profile) {
+    std::vector<float> values(m_names.size());
+    for (auto& scope : profile.m_scopes) {
+        if (scope.m_depth != 0) {
+            continue;
+        }
+
+        auto [it, inserted] =
+            m_name_indices.try_emplace(scope.m_name, m_names.size());
+        if (inserted) {
+            m_names.push_back(scope.m_name);
+            m_times.emplace_back(m_frame_times.size(), 0.0f);
+            values.push_back(0);
+        }
+        values[it->second] += scope.m_time_ms;
+    }
+
+    for (size_t i = 0; i < m_times.size(); i++) {
+        push(m_times[i], values[i], m_capacity);
+    }
+    push(m_frame_times, profile.GetTotalTime(), m_capacity);
+}
+
+std::span<const float> GPUProfileHistory::GetTimes(
+    std::string_view name) const {
+    auto it = m_name_indices.find(std::string{name});
+    if (it == m_name_indices.end()) {
+        return {};
+    }
+    return m_times[it->second];
+}
+
+std::span<const float> GPUProfileHistory::GetFrameTimes() const {
+    return m_frame_times;
+}
+
+std::span<const std::string> GPUProfileHistory::GetScopeNames() const {
+    return m_names;
+}
+
+void GPUProfileHistory::push(std::vector<float>& times, float value,
+                             uint32_t capacity) {
+    times.push_back(value);
+    if (times.size() > capacity) {
+        times.erase(times.begin(), times.end() - capacity);
+    }
+}
+
+GPUProfilerImpl::GPUProfilerImpl(DeviceImpl& device, VkPhysicalDevice phy,
+                                 uint32_t queue_family, uint32_t frame_count,
+                                 bool host_query_reset)
+    : m_device{device} {
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(phy, &props);
+    VkPhysicalDeviceFeatures features;
+    vkGetPhysicalDeviceFeatures(phy, &features);
+
+    uint32_t count = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(phy, &count, nullptr);
+    std::vector<VkQueueFamilyProperties> queue_families(count);
+    vkGetPhysicalDeviceQueueFamilyProperties(phy, &count,
+                                             queue_families.data());
+
+    m_timestamp_period = props.limits.timestampPeriod;
+    m_timestamp_valid_bits = queue_families[queue_family].timestampValidBits;
+    m_supported = host_query_reset && m_timestamp_period > 0 &&
+                  m_timestamp_valid_bits > 0;
+    m_statistics_supported = m_supported && features.pipelineStatisticsQuery;
+    LOGI("gpu profiler support: timestamps {}, pipeline statistics {}",
+         m_supported, m_statistics_supported);
+    NICKEL_RETURN_IF_FALSE(m_supported);
+
+    m_frames.resize(frame_count);
+    for (auto& frame : m_frames) {
+        VkQueryPoolCreateInfo ci{};
+        ci.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        ci.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        ci.queryCount = MaxScopesPerFrame * 2;
+        VK_CALL(vkCreateQueryPool(m_device.m_device, &ci, nullptr,
+                                  &frame.m_timestamps));
+
+        if (m_statistics_supported) {
+            ci.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            ci.queryCount = MaxScopesPerFrame;
+            ci.pipelineStatistics =
+                VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+            VK_CALL(vkCreateQueryPool(m_device.m_device, &ci, nullptr,
+                                      &frame.m_statistics));
+        }
+        reset(frame);
+    }
+}
+
+GPUProfilerImpl::~GPUProfilerImpl() {
+    for (auto& frame : m_frames) {
+        vkDestroyQueryPool(m_device.m_device, frame.m_timestamps, nullptr);
+        vkDestroyQueryPool(m_device.m_device, frame.m_statistics, nullptr);
+    }
+}
+
+void GPUProfilerImpl::BeginFrame(uint32_t slot) {
+    NICKEL_RETURN_IF_FALSE(m_supported);
+
+    if (!m_open_scopes.empty()) {
+        LOGW("{} gpu profile scopes not ended last frame",
+             m_open_scopes.size());
+        m_open_scopes.clear();
+        m_statistics_active = false;
+    }
+
+    m_cur_slot = slot;
+    auto& frame = m_frames[slot];
+    collect(frame);
+    reset(frame);
+    frame.m_frame = m_frame_number++;
+}
+
+void GPUProfilerImpl::BeginScope(VkCommandBuffer cmd, std::string_view name) {
+    if (!m_supported || !m_enabled) {
+        m_open_scopes.push_back(std::nullopt);
+        return;
+    }
+
+    auto& frame = m_frames[m_cur_slot];
+    if (frame.m_scopes.size() >= MaxScopesPerFrame) {
+        if (!frame.m_overflowed) {
+            LOGW("more than {} gpu profile scopes in one frame",
+                 MaxScopesPerFrame);
+            frame.m_overflowed = true;
+        }
+        m_open_scopes.push_back(std::nullopt);
+        return;
+    }
+
+    Scope scope;
+    scope.m_name = name;
+    scope.m_depth = m_open_scopes.size();
+    scope.m_timestamp_query = frame.m_scopes.size() * 2;
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        frame.m_timestamps, scope.m_timestamp_query);
+
+    if (m_statistics_enabled && m_statistics_supported &&
+        !m_statistics_active) {
+        scope.m_statistics_query = frame.m_statistics_count++;
+        vkCmdBeginQuery(cmd, frame.m_statistics,
+                        scope.m_statistics_query.value(), 0);
+        m_statistics_active = true;
+    }
+
+    m_open_scopes.push_back(frame.m_scopes.size());
+    frame.m_scopes.push_back(std::move(scope));
+}
+
+void GPUProfilerImpl::EndScope(VkCommandBuffer cmd) {
+    NICKEL_RETURN_IF_FALSE_LOGE(!m_open_scopes.empty(),
+                                "end gpu profile scope which isn't begun");
+
+    auto index = m_open_scopes.back();
+    m_open_scopes.pop_back();
+    NICKEL_RETURN_IF_FALSE(index);
+
+    auto& frame = m_frames[m_cur_slot];
+    auto& scope = frame.m_scopes[index.value()];
+    if (scope.m_statistics_query) {
+        vkCmdEndQuery(cmd, frame.m_statistics,
+                      scope.m_statistics_query.value());
+        m_statistics_active = false;
+    }
+    vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        frame.m_timestamps, scope.m_timestamp_query + 1);
+}
+
+void GPUProfilerImpl::collect(Frame& frame) {
+    NICKEL_RETURN_IF_FALSE(!frame.m_scopes.empty());
+
+    // value & availability pairs, unfinished queries are skipped instead of
+    // waited for
+    constexpr VkQueryResultFlags flags =
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+    uint32_t query_count = frame.m_scopes.size() * 2;
+    std::vector<uint64_t> timestamps(query_count * 2);
+    VkResult result = vkGetQueryPoolResults(
+        m_device.m_device, frame.m_timestamps, 0, query_count,
+        timestamps.size() * sizeof(uint64_t), timestamps.data(),
+        sizeof(uint64_t) * 2, flags);
+    NICKEL_RETURN_IF_FALSE_LOGW(
+        result == VK_SUCCESS || result == VK_NOT_READY,
+        "read gpu timestamps failed: {}", VkError2String(result));
+
+    constexpr uint32_t statistics_stride = PipelineStatisticsCount + 1;
+    std::vector<uint64_t> statistics(frame.m_statistics_count *
+                                     statistics_stride);
+    if (frame.m_statistics_count > 0) {
+        result = vkGetQueryPoolResults(
+            m_device.m_device, frame.m_statistics, 0,
+            frame.m_statistics_count, statistics.size() * sizeof(uint64_t),
+            statistics.data(), sizeof(uint64_t) * statistics_stride, flags);
+        if (result != VK_SUCCESS && result != VK_NOT_READY) {
+            statistics.clear();
+        }
+    }
+
+    GPUFrameProfile profile;
+    profile.m_frame = frame.m_frame;
+    for (auto& scope : frame.m_scopes) {
+        const uint64_t* begin = &timestamps[scope.m_timestamp_query * 2];
+        const uint64_t* end = begin + 2;
+        if (!begin[1] || !end[1]) {
+            continue;
+        }
+
+        GPUScopeResult scope_result;
+        scope_result.m_name = scope.m_name;
+        scope_result.m_depth = scope.m_depth;
+        scope_result.m_time_ms = TimestampsToMilliseconds(
+            begin[0], end[0], m_timestamp_period, m_timestamp_valid_bits);
+
+        if (scope.m_statistics_query && !statistics.empty()) {
+            const uint64_t* values =
+                &statistics[scope.m_statistics_query.value() *
+                            statistics_stride];
+            if (values[PipelineStatisticsCount]) {
+                // results are ordered by bit position of the statistic
+                scope_result.m_statistics = PipelineStatistics{
+                    values[0], values[1], values[2], values[3]};
+            }
+        }
+        profile.m_scopes.push_back(std::move(scope_result));
+    }
+
+    m_history.Push(profile);
+    m_last_profile = std::move(profile);
+}
+
+void GPUProfilerImpl::reset(Frame& frame) {
+    vkResetQueryPool(m_device.m_device, frame.m_timestamps, 0,
+                     MaxScopesPerFrame * 2);
+    if (frame.m_statistics) {
+        vkResetQueryPool(m_device.m_device, frame.m_statistics, 0,
+                         MaxScopesPerFrame);
+    }
+    frame.m_scopes.clear();
+    frame.m_statistics_count = 0;
+    frame.m_overflowed = false;
+}
+
+GPUProfiler::GPUProfiler(GPUProfilerImpl* impl) : m_impl{impl} {}
+
+bool GPUProfiler::IsSupported() const {
+    return m_impl->m_supported;
+}
+
+bool GPUProfiler::IsPipelineStatisticsSupported() const {
+    return m_impl->m_statistics_supported;
+}
+
+void GPUProfiler::Enable(bool enable) {
+    m_impl->m_enabled = enable;
+}
+
+bool GPUProfiler::IsEnabled() const {
+    return m_impl->m_enabled;
+}
+
+void GPUProfiler::EnablePipelineStatistics(bool enable) {
+    m_impl->m_statistics_enabled = enable;
+}
+
+bool GPUProfiler::IsPipelineStatisticsEnabled() const {
+    return m_impl->m_statistics_enabled;
+}
+
+const GPUFrameProfile& GPUProfiler::GetLastProfile() const {
+    return m_impl->m_last_profile;
+}
+
+const GPUProfileHistory& GPUProfiler::GetHistory() const {
+    return m_impl->m_history;
+}
+
+GPUProfilerImpl& GPUProfiler::GetImpl() {
+    return *m_impl;
+}
+
+}  // namespace nickel::graphics
@@ -9,6 +9,11 @@ namespace nickel::graphics {
 GraphicsPipelineImpl::GraphicsPipelineImpl(
     DeviceImpl& dev, const GraphicsPipeline::Descriptor& desc)
     : m_layout{desc.m_layout}, m_device{dev}, m_render_pass{desc.m_render_pass} {
+    m_pipeline = CreateVkGraphicsPipeline(dev, desc);
+}
+
+VkPipeline CreateVkGraphicsPipeline(DeviceImpl& dev,
+                                    const GraphicsPipeline::Descriptor& desc) {
     VkGraphicsPipelineCreateInfo ci{};
     ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     ci.subpass = desc.m_subpass;
@@ -210,8 +215,20 @@ GraphicsPipelineImpl::GraphicsPipelineImpl(
     ci.pDynamicState = &dynState;
     ci.layout = desc.m_layout.GetImpl()->m_pipeline_layout;
 
-    VK_CALL(vkCreateGraphicsPipelines(dev.m_device, VK_NULL_HANDLE, 1, &ci,
-                                      nullptr, &m_pipeline));
+    // tells whether the pipeline came from `m_pipeline_cache`
+    VkPipelineCreationFeedback feedback{};
+    VkPipelineCreationFeedbackCreateInfo feedback_ci{};
+    feedback_ci.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+    feedback_ci.pPipelineCreationFeedback = &feedback;
+    if (dev.m_creation_feedback_supported) {
+        ci.pNext = &feedback_ci;
+    }
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    VK_CALL(vkCreateGraphicsPipelines(dev.m_device, dev.m_pipeline_cache, 1,
+                                      &ci, nullptr, &pipeline));
+    dev.RecordPipelineCreation(feedback);
+    return pipeline;
 }
 
 GraphicsPipelineImpl::~GraphicsPipelineImpl() {
@@ -222,7 +239,7 @@ void GraphicsPipelineImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_graphics_pipeline_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_graphics_pipeline_allocator, this);
     }
 }
 }
\ No newline at end of file
@@ -148,7 +148,7 @@ void ImageImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_image_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_image_allocator, this);
     }
 }
 
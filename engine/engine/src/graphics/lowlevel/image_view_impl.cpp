@@ -25,10 +25,14 @@ ImageViewImpl::ImageViewImpl(DeviceImpl& dev, const Image& image,
     VK_CALL(vkCreateImageView(dev.m_device, &ci, nullptr, &m_view));
 
     m_image = image;
+    m_subresource_range = desc.m_subresource_range;
 }
 
-ImageViewImpl::ImageViewImpl(DeviceImpl& device, VkImageView view)
-    : m_device{device}, m_view{view} {}
+ImageViewImpl::ImageViewImpl(DeviceImpl& device, VkImage image,
+                             VkImageView view)
+    : m_view{view}, m_swapchain_image{image}, m_device{device} {
+    m_subresource_range.m_aspect_mask = ImageAspect::Color;
+}
 
 ImageViewImpl::~ImageViewImpl() {
     vkDestroyImageView(m_device.m_device, m_view, nullptr);
@@ -38,7 +42,7 @@ void ImageViewImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_image_view_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_image_view_allocator, this);
     }
 }
 
@@ -0,0 +1,92 @@
+#include "nickel/graphics/lowlevel/internal/pipeline_cache.hpp"
+#include "nickel/common/hash.hpp"
+#include "nickel/common/log.hpp"
+#include "nickel/common/macro.hpp"
+
+namespace nickel::graphics {
+
+namespace {
+
+// `VkPipelineCacheHeaderVersionOne`, layout is fixed by vulkan spec
+struct DriverCacheHeader {
+    uint32_t m_header_size{};
+    uint32_t m_header_version{};
+    uint32_t m_vendor_id{};
+    uint32_t m_device_id{};
+    std::array<uint8_t, 16> m_uuid{};
+};
+
+constexpr uint32_t DriverCacheHeaderVersionOne = 1;
+
+std::span<const unsigned char> asBytes(std::span<const char> data) {
+    return {reinterpret_cast<const unsigned char*>(data.data()), data.size()};
+}
+
+bool isSameDevice(const PipelineCacheDeviceInfo& a,
+                  const PipelineCacheDeviceInfo& b) {
+    return a.m_vendor_id == b.m_vendor_id && a.m_device_id == b.m_device_id &&
+           a.m_driver_version == b.m_driver_version && a.m_uuid == b.m_uuid;
+}
+
+bool isDriverHeaderValid(const PipelineCacheDeviceInfo& device,
+                         std::span<const char> data) {
+    DriverCacheHeader header;
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(false, data.size() >= sizeof(header),
+                                      "pipeline cache data too small");
+    memcpy(&header, data.data(), sizeof(header));
+    return header.m_header_size >= sizeof(header) &&
+           header.m_header_size <= data.size() &&
+           header.m_header_version == DriverCacheHeaderVersionOne &&
+           header.m_vendor_id == device.m_vendor_id &&
+           header.m_device_id == device.m_device_id &&
+           header.m_uuid == device.m_uuid;
+}
+
+}  // namespace
+
+std::vector<char> PackPipelineCacheData(const PipelineCacheDeviceInfo& device,
+                                        std::span<const char> data) {
+    PipelineCacheFileHeader header;
+    header.m_device = device;
+    header.m_data_size = data.size();
+    header.m_data_hash = HashBytes(asBytes(data));
+
+    std::vector<char> file(sizeof(header) + data.size());
+    memcpy(file.data(), &header, sizeof(header));
+    if (!data.empty()) {
+        memcpy(file.data() + sizeof(header), data.data(), data.size());
+    }
+    return file;
+}
+
+std::span<const char> UnpackPipelineCacheData(
+    const PipelineCacheDeviceInfo& device, std::span<const char> file) {
+    PipelineCacheFileHeader header;
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW({}, file.size() >= sizeof(header),
+                                      "pipeline cache file too small");
+    memcpy(&header, file.data(), sizeof(header));
+
+    if (header.m_magic != PipelineCacheFileHeader::Magic ||
+        header.m_version != PipelineCacheFileHeader::Version) {
+        LOGW("not a pipeline cache file, discarded");
+        return {};
+    }
+    if (!isSameDevice(header.m_device, device)) {
+        LOGI("pipeline cache of another GPU or driver, discarded");
+        return {};
+    }
+
+    auto data = file.subspan(sizeof(header));
+    if (header.m_data_size != data.size() ||
+        header.m_data_hash != HashBytes(asBytes(data))) {
+        LOGW("pipeline cache file corrupted, discarded");
+        return {};
+    }
+    if (!isDriverHeaderValid(device, data)) {
+        LOGW("pipeline cache data header mismatch, discarded");
+        return {};
+    }
+    return data;
+}
+
+}  // namespace nickel::graphics
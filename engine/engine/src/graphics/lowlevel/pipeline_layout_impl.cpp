@@ -45,7 +45,7 @@ void PipelineLayoutImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_pipeline_layout_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_pipeline_layout_allocator, this);
     }
 }
 
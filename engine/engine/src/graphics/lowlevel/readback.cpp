@@ -0,0 +1,102 @@
+#include "nickel/graphics/lowlevel/readback.hpp"
+#include "nickel/common/log.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/lowlevel/common.hpp"
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+namespace nickel::graphics {
+
+ImageDiff CompareImages(const ReadbackImage& image,
+                        const ReadbackImage& golden, uint32_t tolerance) {
+    ImageDiff diff;
+    diff.m_same_extent = image.m_extent == golden.m_extent &&
+                         image.m_pixels.size() == golden.m_pixels.size();
+    if (!diff.m_same_extent) {
+        diff.m_max_channel_diff = 255;
+        diff.m_mismatched_pixels =
+            std::max(image.m_pixels.size(), golden.m_pixels.size()) / 4;
+        return diff;
+    }
+
+    for (size_t i = 0; i + 4 <= image.m_pixels.size(); i += 4) {
+        uint32_t pixel_diff = 0;
+        for (size_t c = 0; c < 4; c++) {
+            int d = int(image.m_pixels[i + c]) - int(golden.m_pixels[i + c]);
+            pixel_diff = std::max<uint32_t>(pixel_diff, std::abs(d));
+        }
+        diff.m_max_channel_diff =
+            std::max(diff.m_max_channel_diff, pixel_diff);
+        if (pixel_diff > tolerance) {
+            diff.m_mismatched_pixels++;
+        }
+    }
+    return diff;
+}
+
+ReadbackImage MakeDiffImage(const ReadbackImage& a, const ReadbackImage& b) {
+    if (a.m_extent != b.m_extent || a.m_pixels.size() != b.m_pixels.size()) {
+        return {};
+    }
+
+    ReadbackImage diff;
+    diff.m_extent = a.m_extent;
+    diff.m_pixels.resize(a.m_pixels.size());
+    for (size_t i = 0; i + 4 <= a.m_pixels.size(); i += 4) {
+        for (size_t c = 0; c < 3; c++) {
+            diff.m_pixels[i + c] = std::abs(int(a.m_pixels[i + c]) -
+                                            int(b.m_pixels[i + c]));
+        }
+        diff.m_pixels[i + 3] = 255;
+    }
+    return diff;
+}
+
+bool SaveImagePNG(const ReadbackImage& image, const Path& filename) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, image, "save empty image to {}",
+                                      filename);
+
+    std::vector<unsigned char> data;
+    auto write = [](void* context, void* bytes, int size) {
+        auto& data = *static_cast<std::vector<unsigned char>*>(context);
+        auto begin = static_cast<unsigned char*>(bytes);
+        data.insert(data.end(), begin, begin + size);
+    };
+    int ok = stbi_write_png_to_func(write, &data, image.m_extent.w,
+                                    image.m_extent.h, 4, image.m_pixels.data(),
+                                    image.m_extent.w * 4);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, ok, "encode png {} failed",
+                                      filename);
+
+    std::ofstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, file.is_open(), "can't write {}",
+                                      filename);
+    file.write((const char*)data.data(), data.size());
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, file.good(), "write {} failed",
+                                      filename);
+    return true;
+}
+
+ReadbackImage LoadImagePNG(const Path& filename) {
+    std::ifstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW({}, file.is_open(), "can't read {}",
+                                      filename);
+    std::vector<char> content{std::istreambuf_iterator<char>{file},
+                              std::istreambuf_iterator<char>{}};
+
+    ImageRawData raw{content.data(), content.size()};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW({}, raw, "can't decode image {}",
+                                      filename);
+
+    ReadbackImage image;
+    image.m_extent = raw.GetExtent();
+    auto pixels = static_cast<const unsigned char*>(raw.GetData());
+    image.m_pixels.assign(
+        pixels, pixels + uint64_t(image.m_extent.w) * image.m_extent.h * 4);
+    return image;
+}
+
+}  // namespace nickel::graphics
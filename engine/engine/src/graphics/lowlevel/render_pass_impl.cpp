@@ -25,6 +25,7 @@ RenderPassImpl::RenderPassImpl(DeviceImpl& device,
         desc.stencilLoadOp = AttachmentLoadOp2Vk(attachment.m_stencil_load_op);
         desc.stencilStoreOp = AttachmentStoreOp2Vk(attachment.m_store_op);
         attachments.emplace_back(desc);
+        m_final_layouts.push_back(attachment.m_final_layout);
     }
 
     std::vector<VkSubpassDependency> dependencies;
@@ -139,7 +140,7 @@ void RenderPassImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_dev.m_render_pass_allocator.MarkAsGarbage(this);
+        m_dev.DeferRelease(m_dev.m_render_pass_allocator, this);
     }
 }
 
@@ -7,7 +7,7 @@
 namespace nickel::graphics {
 
 SamplerImpl::SamplerImpl(DeviceImpl& dev, const Sampler::Descriptor& desc)
-    : m_dev{dev} {
+    : m_desc{desc}, m_dev{dev} {
     VkSamplerCreateInfo ci{};
     ci.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     ci.magFilter = Filter2Vk(desc.m_mag_filter);
@@ -33,11 +33,23 @@ SamplerImpl::~SamplerImpl() {
     vkDestroySampler(m_dev.m_device, m_sampler, nullptr);
 }
 
+void SamplerImpl::IncRefcount() {
+    std::lock_guard lock{m_dev.m_sampler_mutex};
+    RefCountable::IncRefcount();
+}
+
 void SamplerImpl::DecRefcount() {
+    std::lock_guard lock{m_dev.m_sampler_mutex};
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_dev.m_sampler_allocator.MarkAsGarbage(this);
+        // unreachable from `CreateSampler` from now on, the handle itself is
+        // destroyed once GPU finished the frames that may use it
+        m_dev.m_samplers.erase(m_desc);
+        m_dev.DeferRelease([&dev = m_dev, sampler = this] {
+            std::lock_guard lock{dev.m_sampler_mutex};
+            dev.m_sampler_allocator.MarkAsGarbage(sampler);
+        });
     }
 }
 
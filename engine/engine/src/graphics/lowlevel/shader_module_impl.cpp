@@ -24,7 +24,7 @@ void ShaderModuleImpl::DecRefcount() {
     RefCountable::DecRefcount();
 
     if (Refcount() == 0) {
-        m_device.m_shader_module_allocator.MarkAsGarbage(this);
+        m_device.DeferRelease(m_device.m_shader_module_allocator, this);
     }
 }
 
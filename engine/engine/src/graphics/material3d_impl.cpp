@@ -1,15 +1,20 @@
 #include "nickel/graphics/internal/material3d_impl.hpp"
 
 #include "nickel/graphics/internal/gltf_manager_impl.hpp"
+#include "nickel/graphics/internal/texture_impl.hpp"
+#include "nickel/common/macro.hpp"
 
 namespace nickel::graphics {
 
 Material3DImpl::Material3DImpl(GLTFManagerImpl* mgr,
                                const Material3D::Descriptor& mtl_desc,
                                Buffer& camera_buffer, Buffer& view_buffer,
-                               BindGroupLayout layout)
-    : m_mgr{mgr} {
-    BindGroup::Descriptor desc;
+                               BindGroupLayout layout, BindlessTable* bindless)
+    : m_mgr{mgr},
+      m_layout{layout},
+      m_pbr_offset{mtl_desc.pbrParameters.m_offset},
+      m_bindless{bindless} {
+    BindGroup::Descriptor& desc = m_desc;
 
     // camera buffer
     {
@@ -18,7 +23,8 @@ Material3DImpl::Material3DImpl(GLTFManagerImpl* mgr,
         entry.m_array_size = 1;
         BindGroup::BufferBinding binding;
         binding.m_buffer = camera_buffer;
-        binding.m_type = BindGroup::BufferBinding::Type::Uniform;
+        binding.m_type = BindGroup::BufferBinding::Type::DynamicUniform;
+        binding.m_size = sizeof(Mat44);
         entry.m_binding.m_entry = binding;
 
         desc.m_entries[0] = entry;
@@ -31,7 +37,8 @@ Material3DImpl::Material3DImpl(GLTFManagerImpl* mgr,
         entry.m_array_size = 1;
         BindGroup::BufferBinding binding;
         binding.m_buffer = view_buffer;
-        binding.m_type = BindGroup::BufferBinding::Type::Uniform;
+        binding.m_type = BindGroup::BufferBinding::Type::DynamicUniform;
+        binding.m_size = sizeof(Vec3);
         entry.m_binding.m_entry = binding;
 
         desc.m_entries[10] = entry;
@@ -57,7 +64,59 @@ Material3DImpl::Material3DImpl(GLTFManagerImpl* mgr,
     pushTextureInfoBinding(desc, mtl_desc.metalicRoughnessTexture, 4, 8);
     pushTextureInfoBinding(desc, mtl_desc.occlusionTexture, 5, 9);
 
-    m_bind_group = layout.RequireBindGroup(desc);
+    if (m_bindless) {
+        initBindless(mtl_desc);
+    } else {
+        m_bind_group = layout.RequireBindGroup(desc);
+    }
+}
+
+Material3DImpl::~Material3DImpl() {
+    NICKEL_RETURN_IF_FALSE(m_bindless);
+    for (uint32_t i = 0; i < 4; i++) {
+        m_bindless->ReleaseImage(m_bindless_material.m_images[i]);
+        m_bindless->ReleaseSampler(m_bindless_material.m_samplers[i]);
+    }
+    m_bindless->RemoveMaterial(m_bindless_index);
+}
+
+void Material3DImpl::initBindless(const Material3D::Descriptor& mtl_desc) {
+    auto& params = mtl_desc.pbrParameterValues;
+    m_bindless_material.m_base_color = params.m_base_color;
+    m_bindless_material.m_metallic = params.m_metallic;
+    m_bindless_material.m_roughness = params.m_roughness;
+
+    // same order as slots of `pushTextureInfoBinding` calls
+    bool full = false;
+    for (uint32_t i = 0; i < 4; i++) {
+        acquireBindlessTexture(i, 2 + i, 6 + i);
+        full |= m_bindless_material.m_images[i] == BindlessTable::InvalidSlot ||
+                m_bindless_material.m_samplers[i] == BindlessTable::InvalidSlot;
+    }
+
+    // never let shader index out of the tables, material is skipped instead
+    m_bindless_index = full ? BindlessTable::InvalidSlot
+                            : m_bindless->AddMaterial(m_bindless_material);
+}
+
+void Material3DImpl::acquireBindlessTexture(uint32_t i, uint32_t image_slot,
+                                            uint32_t sampler_slot) {
+    auto& image = std::get<BindGroup::ImageBinding>(
+        m_desc.m_entries.at(image_slot).m_binding.m_entry);
+    auto& sampler = std::get<BindGroup::SamplerBinding>(
+        m_desc.m_entries.at(sampler_slot).m_binding.m_entry);
+    m_bindless_material.m_images[i] = m_bindless->AcquireImage(image.m_view);
+    m_bindless_material.m_samplers[i] =
+        m_bindless->AcquireSampler(sampler.m_sampler);
+}
+
+std::array<uint32_t, 3> Material3DImpl::GetDynamicOffsets(
+    uint32_t frame_offset) const noexcept {
+    return {frame_offset, m_pbr_offset, frame_offset};
+}
+
+uint32_t Material3DImpl::GetBindlessIndex() const noexcept {
+    return m_bindless_index;
 }
 
 void Material3DImpl::pushTextureInfoBinding(BindGroup::Descriptor& desc,
@@ -66,6 +125,47 @@ void Material3DImpl::pushTextureInfoBinding(BindGroup::Descriptor& desc,
                                             uint32_t sampler_slot) {
     pushTextureBindingPoint(desc, info.image, image_slot);
     pushSamplerBindingPoint(desc, info.sampler, sampler_slot);
+    if (info.texture) {
+        m_textures.push_back({info.texture, image_slot,
+                              info.texture.GetImpl()->GetGeneration()});
+    }
+}
+
+void Material3DImpl::RequestTextureLevels(float screen_size) {
+    for (auto& binding : m_textures) {
+        binding.m_texture.GetImpl()->RequestStreamLevel(screen_size);
+    }
+}
+
+void Material3DImpl::UpdateBindGroup() {
+    bool changed = false;
+    for (auto& binding : m_textures) {
+        auto texture = binding.m_texture.GetImpl();
+        if (texture->GetGeneration() != binding.m_generation) {
+            binding.m_generation = texture->GetGeneration();
+            pushTextureBindingPoint(m_desc, texture->m_view, binding.m_slot);
+            changed = true;
+
+            if (m_bindless) {
+                uint32_t& image =
+                    m_bindless_material.m_images[binding.m_slot - 2];
+                m_bindless->ReleaseImage(image);
+                image = m_bindless->AcquireImage(texture->m_view);
+            }
+        }
+    }
+
+    if (!changed) {
+        return;
+    }
+
+    if (m_bindless) {
+        m_bindless->UpdateMaterial(m_bindless_index, m_bindless_material);
+    } else {
+        // write a new set, frames in flight may still bind the old one. It
+        // and the old texture view are released after their fences
+        m_bind_group = m_layout.RequireBindGroup(m_desc);
+    }
 }
 
 void Material3DImpl::pushTextureBindingPoint(BindGroup::Descriptor& desc,
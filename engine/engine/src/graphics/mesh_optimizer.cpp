@@ -0,0 +1,844 @@
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+#include "nickel/common/macro.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace nickel::graphics {
+
+uint32_t GetVertexStride(VertexLayout layout) {
+    switch (layout) {
+        case VertexLayout::Float:
+            return sizeof(GLTFVertex);
+        case VertexLayout::Quantized:
+            return sizeof(GLTFQuantizedVertex);
+    }
+    NICKEL_CANT_REACH();
+    return 0;
+}
+
+VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices,
+                                    uint32_t vertex_count,
+                                    uint32_t cache_size) {
+    VertexCacheStats stats;
+    // vertex is in cache while less than `cache_size` misses happened after
+    // it was loaded
+    std::vector<uint32_t> timestamps(vertex_count, 0);
+    uint32_t time = cache_size + 1;
+    uint32_t unique_count = 0;
+    for (uint32_t index : indices) {
+        if (timestamps[index] == 0) {
+            unique_count++;
+        }
+        if (time - timestamps[index] > cache_size) {
+            timestamps[index] = time++;
+            stats.m_vertices_transformed++;
+        }
+    }
+
+    if (indices.size() >= 3) {
+        stats.m_acmr = stats.m_vertices_transformed / (indices.size() / 3.0f);
+    }
+    if (unique_count > 0) {
+        stats.m_atvr = stats.m_vertices_transformed / float(unique_count);
+    }
+    return stats;
+}
+
+namespace {
+
+struct VertexHasher {
+    size_t operator()(const GLTFVertex& vertex) const {
+        // FNV-1a over the bytes, same bytes are the same vertex
+        auto bytes = reinterpret_cast<const unsigned char*>(&vertex);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < sizeof(GLTFVertex); i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+struct VertexEqual {
+    bool operator()(const GLTFVertex& a, const GLTFVertex& b) const {
+        return memcmp(&a, &b, sizeof(GLTFVertex)) == 0;
+    }
+};
+
+}  // namespace
+
+void DeduplicateVertices(std::vector<GLTFVertex>& vertices,
+                         std::span<uint32_t> indices) {
+    std::unordered_map<GLTFVertex, uint32_t, VertexHasher, VertexEqual>
+        unique_indices;
+    unique_indices.reserve(vertices.size());
+
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<GLTFVertex> unique_vertices;
+    unique_vertices.reserve(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        auto [it, inserted] =
+            unique_indices.emplace(vertices[i], unique_vertices.size());
+        if (inserted) {
+            unique_vertices.push_back(vertices[i]);
+        }
+        remap[i] = it->second;
+    }
+
+    for (auto& index : indices) {
+        index = remap[index];
+    }
+    vertices = std::move(unique_vertices);
+}
+
+void OptimizeVertexCache(std::span<uint32_t> indices, uint32_t vertex_count,
+                         uint32_t cache_size) {
+    size_t face_count = indices.size() / 3;
+    if (face_count == 0) {
+        return;
+    }
+
+    // triangles adjacent to each vertex
+    std::vector<uint32_t> live_count(vertex_count, 0);
+    for (uint32_t index : indices) {
+        NICKEL_ASSERT(index < vertex_count, "index out of range");
+        live_count[index]++;
+    }
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    std::partial_sum(live_count.begin(), live_count.end(),
+                     adjacency_offsets.begin() + 1);
+    std::vector<uint32_t> adjacency(face_count * 3);
+    {
+        std::vector<uint32_t> fill(adjacency_offsets.begin(),
+                                   adjacency_offsets.end() - 1);
+        for (size_t i = 0; i < face_count * 3; i++) {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+    }
+
+    std::vector<uint32_t> cache_time(vertex_count, 0);
+    std::vector<bool> emitted(face_count, false);
+    std::vector<uint32_t> dead_end_stack;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> result;
+    result.reserve(face_count * 3);
+    uint32_t time = cache_size + 1;
+    uint32_t cursor = 0;
+
+    // recently used vertex with live triangles, else the next one in order
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!dead_end_stack.empty()) {
+            uint32_t vertex = dead_end_stack.back();
+            dead_end_stack.pop_back();
+            if (live_count[vertex] > 0) {
+                return vertex;
+            }
+        }
+        while (cursor < vertex_count) {
+            if (live_count[cursor] > 0) {
+                return cursor;
+            }
+            cursor++;
+        }
+        return -1;
+    };
+
+    int64_t fanning = skipDeadEnd();
+    while (fanning != -1) {
+        candidates.clear();
+        for (uint32_t i = adjacency_offsets[fanning];
+             i < adjacency_offsets[fanning + 1]; i++) {
+            uint32_t face = adjacency[i];
+            if (emitted[face]) {
+                continue;
+            }
+            for (int k = 0; k < 3; k++) {
+                uint32_t vertex = indices[face * 3 + k];
+                result.push_back(vertex);
+                dead_end_stack.push_back(vertex);
+                candidates.push_back(vertex);
+                live_count[vertex]--;
+                if (time - cache_time[vertex] > cache_size) {
+                    cache_time[vertex] = time++;
+                }
+            }
+            emitted[face] = true;
+        }
+
+        // prefer the oldest candidate that stays in cache while its
+        // remaining triangles are emitted
+        int64_t next = -1;
+        int64_t best_priority = -1;
+        for (uint32_t vertex : candidates) {
+            NICKEL_CONTINUE_IF_FALSE(live_count[vertex] > 0);
+            int64_t priority = 0;
+            if (time - cache_time[vertex] + 2 * live_count[vertex] <=
+                cache_size) {
+                priority = time - cache_time[vertex];
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                next = vertex;
+            }
+        }
+        fanning = next != -1 ? next : skipDeadEnd();
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void OptimizeOverdraw(std::span<uint32_t> indices,
+                      std::span<const GLTFVertex> vertices, float threshold,
+                      uint32_t cache_size) {
+    size_t face_count = indices.size() / 3;
+    if (face_count < 2) {
+        return;
+    }
+
+    std::vector<uint32_t> cluster_begins{0};
+    {
+        std::vector<uint32_t> timestamps(vertices.size(), 0);
+        uint32_t time = cache_size + 1;
+        for (size_t face = 0; face < face_count; face++) {
+            uint32_t misses = 0;
+            for (int k = 0; k < 3; k++) {
+                uint32_t index = indices[face * 3 + k];
+                if (time - timestamps[index] > cache_size) {
+                    timestamps[index] = time++;
+                    misses++;
+                }
+            }
+            if (misses == 3 && face > 0) {
+                cluster_begins.push_back(face);
+            }
+        }
+    }
+    if (cluster_begins.size() < 2) {
+        return;
+    }
+    cluster_begins.push_back(face_count);
+
+    struct Cluster {
+        uint32_t m_begin{};
+        uint32_t m_end{};
+        Vec3 m_centroid;
+        Vec3 m_normal;  // area weighted
+        float m_area{};
+        float m_sort_key{};
+    };
+
+    std::vector<Cluster> clusters;
+    Vec3 mesh_centroid;
+    float mesh_area = 0;
+    for (size_t i = 0; i + 1 < cluster_begins.size(); i++) {
+        Cluster cluster;
+        cluster.m_begin = cluster_begins[i];
+        cluster.m_end = cluster_begins[i + 1];
+        for (uint32_t face = cluster.m_begin; face < cluster.m_end; face++) {
+            auto& p0 = vertices[indices[face * 3]].m_position;
+            auto& p1 = vertices[indices[face * 3 + 1]].m_position;
+            auto& p2 = vertices[indices[face * 3 + 2]].m_position;
+            Vec3 normal = Cross(p1 - p0, p2 - p0);
+            float area = Length(normal);
+            cluster.m_normal += normal;
+            cluster.m_centroid += (p0 + p1 + p2) * (area / 3.0f);
+            cluster.m_area += area;
+        }
+        mesh_centroid += cluster.m_centroid;
+        mesh_area += cluster.m_area;
+        if (cluster.m_area > 0) {
+            cluster.m_centroid /= cluster.m_area;
+        }
+        clusters.push_back(cluster);
+    }
+    if (mesh_area > 0) {
+        mesh_centroid /= mesh_area;
+    }
+
+    // clusters on the outside facing away from center are drawn first
+    for (auto& cluster : clusters) {
+        float length = Length(cluster.m_normal);
+        if (length > 0) {
+            cluster.m_sort_key =
+                Dot(cluster.m_centroid - mesh_centroid, cluster.m_normal) /
+                length;
+        }
+    }
+    std::stable_sort(clusters.begin(), clusters.end(),
+                     [](const Cluster& a, const Cluster& b) {
+                         return a.m_sort_key > b.m_sort_key;
+                     });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (auto& cluster : clusters) {
+        result.insert(result.end(), indices.begin() + cluster.m_begin * 3,
+                      indices.begin() + cluster.m_end * 3);
+    }
+
+    auto before = AnalyzeVertexCache(indices, vertices.size(), cache_size);
+    auto after = AnalyzeVertexCache(result, vertices.size(), cache_size);
+    if (after.m_vertices_transformed <=
+        before.m_vertices_transformed * threshold) {
+        std::copy(result.begin(), result.end(), indices.begin());
+    }
+}
+
+void OptimizeVertexFetch(std::vector<GLTFVertex>& vertices,
+                         std::span<uint32_t> indices,
+                         std::vector<uint32_t>* out_origin) {
+    constexpr uint32_t Unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertices.size(), Unused);
+    std::vector<GLTFVertex> result;
+    std::vector<uint32_t> origin;
+    result.reserve(vertices.size());
+    for (auto& index : indices) {
+        if (remap[index] == Unused) {
+            remap[index] = result.size();
+            result.push_back(vertices[index]);
+            origin.push_back(index);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(result);
+    if (out_origin) {
+        *out_origin = std::move(origin);
+    }
+}
+
+void OptimizeMesh(std::vector<GLTFVertex>& vertices,
+                  std::vector<uint32_t>& indices,
+                  const MeshOptimizeConfig& config,
+                  std::vector<uint32_t>* out_origin) {
+    // bitwise equal vertices may differ in streams the caller follows
+    NICKEL_ASSERT(!out_origin || !config.m_deduplicate,
+                  "deduplication can't be followed by other streams");
+    if (out_origin) {
+        out_origin->resize(vertices.size());
+        std::iota(out_origin->begin(), out_origin->end(), 0);
+    }
+    if (config.m_deduplicate) {
+        DeduplicateVertices(vertices, indices);
+    }
+    if (config.m_optimize_vertex_cache) {
+        OptimizeVertexCache(indices, vertices.size());
+        // clusters come from the cache optimized order
+        if (config.m_optimize_overdraw) {
+            OptimizeOverdraw(indices, vertices, config.m_overdraw_threshold);
+        }
+    }
+    if (config.m_optimize_vertex_fetch) {
+        OptimizeVertexFetch(vertices, indices, out_origin);
+    }
+}
+
+namespace {
+
+/// symmetric plane quadric, sum of area weighted squared plane distances
+struct Quadric {
+    double m_a00{}, m_a01{}, m_a02{}, m_a11{}, m_a12{}, m_a22{};
+    double m_b0{}, m_b1{}, m_b2{}, m_c{};
+    double m_weight{};
+
+    static Quadric FromPlane(const Vec3& n, const Vec3& p, double weight) {
+        double d = -Dot(n, p);
+        Quadric q;
+        q.m_a00 = weight * n.x * n.x;
+        q.m_a01 = weight * n.x * n.y;
+        q.m_a02 = weight * n.x * n.z;
+        q.m_a11 = weight * n.y * n.y;
+        q.m_a12 = weight * n.y * n.z;
+        q.m_a22 = weight * n.z * n.z;
+        q.m_b0 = weight * n.x * d;
+        q.m_b1 = weight * n.y * d;
+        q.m_b2 = weight * n.z * d;
+        q.m_c = weight * d * d;
+        q.m_weight = weight;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& o) {
+        m_a00 += o.m_a00;
+        m_a01 += o.m_a01;
+        m_a02 += o.m_a02;
+        m_a11 += o.m_a11;
+        m_a12 += o.m_a12;
+        m_a22 += o.m_a22;
+        m_b0 += o.m_b0;
+        m_b1 += o.m_b1;
+        m_b2 += o.m_b2;
+        m_c += o.m_c;
+        m_weight += o.m_weight;
+        return *this;
+    }
+
+    /// mean squared distance of `p` to the planes
+    double Error(const Vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        double r = m_a00 * x * x + m_a11 * y * y + m_a22 * z * z +
+                   2 * (m_a01 * x * y + m_a02 * x * z + m_a12 * y * z) +
+                   2 * (m_b0 * x + m_b1 * y + m_b2 * z) + m_c;
+        return m_weight > 0 ? std::max(r, 0.0) / m_weight : 0;
+    }
+};
+
+struct PositionHasher {
+    size_t operator()(const Vec3& p) const {
+        uint32_t bits[3];
+        memcpy(bits, &p, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^
+               (bits[2] * 83492791u);
+    }
+};
+
+struct PositionEqual {
+    bool operator()(const Vec3& a, const Vec3& b) const {
+        return memcmp(&a, &b, sizeof(Vec3)) == 0;
+    }
+};
+
+enum class VertexKind : uint8_t {
+    Manifold,  // collapses to any neighbor
+    Border,    // collapses along open border only
+};
+
+uint64_t EdgeKey(uint32_t a, uint32_t b) {
+    return (uint64_t(a) << 32) | b;
+}
+
+/// collapse of position `m_from` onto position `m_to`
+struct Collapse {
+    uint32_t m_from;
+    uint32_t m_to;
+    double m_error;
+};
+
+}  // namespace
+
+std::vector<uint32_t> SimplifyMesh(std::span<const GLTFVertex> vertices,
+                                   std::span<const uint32_t> indices,
+                                   size_t target_index_count,
+                                   float target_error, float* out_error) {
+    std::vector<uint32_t> result{indices.begin(),
+                                 indices.begin() + indices.size() / 3 * 3};
+    uint32_t vertex_count = vertices.size();
+
+    // collapses work on positions, vertices sharing a position are wedges
+    // split by uv or normal seams
+    std::vector<uint32_t> position_ids(vertex_count);
+    {
+        std::unordered_map<Vec3, uint32_t, PositionHasher, PositionEqual> ids;
+        ids.reserve(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; i++) {
+            position_ids[i] =
+                ids.emplace(vertices[i].m_position, i).first->second;
+        }
+    }
+    std::vector<uint32_t> wedge_offsets(vertex_count + 1, 0);
+    std::vector<uint32_t> wedges(vertex_count);
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        wedge_offsets[position_ids[i] + 1]++;
+    }
+    for (uint32_t i = 0; i < vertex_count; i++) {
+        wedge_offsets[i + 1] += wedge_offsets[i];
+    }
+    {
+        std::vector<uint32_t> fill{wedge_offsets.begin(),
+                                   wedge_offsets.end() - 1};
+        for (uint32_t i = 0; i < vertex_count; i++) {
+            wedges[fill[position_ids[i]]++] = i;
+        }
+    }
+
+    // edge without opposite half edge is an open border, rebuilt each pass
+    // as collapses create new edges
+    std::unordered_set<uint64_t> half_edges;
+    auto collectHalfEdges = [&] {
+        half_edges.clear();
+        half_edges.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                half_edges.insert(
+                    EdgeKey(position_ids[result[i + e]],
+                            position_ids[result[i + (e + 1) % 3]]));
+            }
+        }
+    };
+    collectHalfEdges();
+    auto isBorderEdge = [&](uint32_t a, uint32_t b) {
+        return half_edges.contains(EdgeKey(a, b)) !=
+               half_edges.contains(EdgeKey(b, a));
+    };
+
+    std::vector<VertexKind> kinds(vertex_count, VertexKind::Manifold);
+    std::vector<Quadric> quadrics(vertex_count);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        uint32_t tri[3] = {position_ids[result[i]], position_ids[result[i + 1]],
+                           position_ids[result[i + 2]]};
+        Vec3 p0 = vertices[tri[0]].m_position,
+             p1 = vertices[tri[1]].m_position,
+             p2 = vertices[tri[2]].m_position;
+        Vec3 normal = Cross(p1 - p0, p2 - p0);
+        float length = Length(normal);
+        if (length <= 0) {
+            continue;
+        }
+        normal = normal / length;
+        auto plane = Quadric::FromPlane(normal, p0, length * 0.5);
+        for (auto id : tri) {
+            quadrics[id] += plane;
+        }
+
+        // plane through border edge perpendicular to the triangle keeps the
+        // outline in place
+        for (int e = 0; e < 3; e++) {
+            uint32_t a = tri[e], b = tri[(e + 1) % 3];
+            if (!isBorderEdge(a, b)) {
+                continue;
+            }
+            Vec3 edge = vertices[b].m_position - vertices[a].m_position;
+            float edge_length = Length(edge);
+            if (edge_length <= 0) {
+                continue;
+            }
+            Vec3 border_normal = Normalize(Cross(edge, normal));
+            auto border = Quadric::FromPlane(border_normal,
+                                             vertices[a].m_position,
+                                             edge_length * edge_length * 10.0);
+            quadrics[a] += border;
+            quadrics[b] += border;
+            kinds[a] = kinds[b] = VertexKind::Border;
+        }
+    }
+
+    double max_error = 0;
+    double limit = double(target_error) * target_error;
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<bool> touched(vertex_count);
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> collapses;
+
+    // each wedge of `from` has to move onto the wedge of `to` it shares a
+    // triangle with, else attributes would tear along the seam
+    auto mapWedges = [&](uint32_t from, uint32_t to, bool apply) {
+        for (uint32_t w = wedge_offsets[from]; w < wedge_offsets[from + 1];
+             w++) {
+            uint32_t wedge = wedges[w];
+            uint32_t target = std::numeric_limits<uint32_t>::max();
+            for (uint32_t k = adjacency_offsets[wedge];
+                 k < adjacency_offsets[wedge + 1]; k++) {
+                uint32_t tri = adjacency[k] * 3;
+                for (int j = 0; j < 3; j++) {
+                    uint32_t v = remap[result[tri + j]];
+                    if (position_ids[v] != to) {
+                        continue;
+                    }
+                    if (target != std::numeric_limits<uint32_t>::max() &&
+                        target != v) {
+                        return false;
+                    }
+                    target = v;
+                }
+            }
+            if (target == std::numeric_limits<uint32_t>::max()) {
+                // unused wedge has nothing to tear
+                if (adjacency_offsets[wedge] == adjacency_offsets[wedge + 1]) {
+                    continue;
+                }
+                return false;
+            }
+            if (apply) {
+                remap[wedge] = target;
+            }
+        }
+        return true;
+    };
+
+    // a triangle around `from` must not flip or degenerate when it moves
+    auto flips = [&](uint32_t from, uint32_t to) {
+        const Vec3& target = vertices[to].m_position;
+        for (uint32_t w = wedge_offsets[from]; w < wedge_offsets[from + 1];
+             w++) {
+            uint32_t wedge = wedges[w];
+            for (uint32_t k = adjacency_offsets[wedge];
+                 k < adjacency_offsets[wedge + 1]; k++) {
+                uint32_t tri = adjacency[k] * 3;
+                uint32_t ids[3];
+                for (int j = 0; j < 3; j++) {
+                    ids[j] = position_ids[remap[result[tri + j]]];
+                }
+                if (ids[0] == to || ids[1] == to || ids[2] == to) {
+                    continue;
+                }
+                Vec3 p[3], q[3];
+                for (int j = 0; j < 3; j++) {
+                    p[j] = vertices[ids[j]].m_position;
+                    q[j] = ids[j] == from ? target : p[j];
+                }
+                Vec3 old_normal = Cross(p[1] - p[0], p[2] - p[0]);
+                Vec3 new_normal = Cross(q[1] - q[0], q[2] - q[0]);
+                if (Dot(old_normal, new_normal) <=
+                    1e-2f * Length(old_normal) * Length(new_normal)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    for (bool first = true; result.size() > target_index_count;
+         first = false) {
+        if (!first) {
+            collectHalfEdges();
+        }
+
+        // triangles around each vertex
+        std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0);
+        for (auto index : result) {
+            adjacency_offsets[index + 1]++;
+        }
+        for (size_t i = 0; i < vertex_count; i++) {
+            adjacency_offsets[i + 1] += adjacency_offsets[i];
+        }
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> fill{adjacency_offsets.begin(),
+                                       adjacency_offsets.end() - 1};
+            for (size_t i = 0; i < result.size(); i++) {
+                adjacency[fill[result[i]]++] = i / 3;
+            }
+        }
+
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                uint32_t a = position_ids[result[i + e]],
+                         b = position_ids[result[i + (e + 1) % 3]];
+                for (auto [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+                    // border vertex only slides along the border
+                    if (kinds[from] == VertexKind::Border &&
+                        (kinds[to] != VertexKind::Border ||
+                         !isBorderEdge(from, to))) {
+                        continue;
+                    }
+                    Quadric q = quadrics[from];
+                    q += quadrics[to];
+                    collapses.push_back(
+                        {from, to, q.Error(vertices[to].m_position)});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+                  [](const Collapse& a, const Collapse& b) {
+                      return a.m_error < b.m_error;
+                  });
+
+        std::iota(remap.begin(), remap.end(), 0);
+        std::fill(touched.begin(), touched.end(), false);
+
+        // about two triangles are removed per collapse, one on borders
+        size_t triangles = result.size() / 3;
+        size_t target_triangles = target_index_count / 3;
+        size_t removed = 0;
+        for (auto& collapse : collapses) {
+            if (collapse.m_error > limit ||
+                triangles - removed <= target_triangles) {
+                break;
+            }
+            uint32_t from = collapse.m_from, to = collapse.m_to;
+            if (touched[from] || touched[to] || !mapWedges(from, to, false) ||
+                flips(from, to)) {
+                continue;
+            }
+            mapWedges(from, to, true);
+            quadrics[to] += quadrics[from];
+            touched[from] = touched[to] = true;
+            max_error = std::max(max_error, collapse.m_error);
+            removed += kinds[from] == VertexKind::Border ? 1 : 2;
+        }
+        if (removed == 0) {
+            break;
+        }
+
+        size_t write = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = remap[result[i]], b = remap[result[i + 1]],
+                     c = remap[result[i + 2]];
+            if (position_ids[a] != position_ids[b] &&
+                position_ids[b] != position_ids[c] &&
+                position_ids[a] != position_ids[c]) {
+                result[write++] = a;
+                result[write++] = b;
+                result[write++] = c;
+            }
+        }
+        result.resize(write);
+    }
+
+    if (out_error) {
+        *out_error = std::sqrt(max_error);
+    }
+    return result;
+}
+
+std::vector<MeshLOD> GenerateLODs(std::span<const GLTFVertex> vertices,
+                                  std::span<const uint32_t> indices,
+                                  const MeshOptimizeConfig& config) {
+    std::vector<MeshLOD> lods;
+    if (vertices.empty() || indices.empty()) {
+        return lods;
+    }
+
+    Vec3 bounds_min = vertices[0].m_position, bounds_max = bounds_min;
+    for (auto& vertex : vertices) {
+        for (int i = 0; i < 3; i++) {
+            bounds_min[i] = std::min(bounds_min[i], vertex.m_position[i]);
+            bounds_max[i] = std::max(bounds_max[i], vertex.m_position[i]);
+        }
+    }
+    float diameter = Length(bounds_max - bounds_min);
+    if (diameter <= 0) {
+        return lods;
+    }
+
+    // each level simplifies the full mesh, so errors are against the
+    // original surface
+    size_t index_count = indices.size();
+    for (uint32_t i = 0; i < config.m_lod_count; i++) {
+        size_t target = size_t(index_count * config.m_lod_reduction) / 3 * 3;
+        float error = 0;
+        auto lod = SimplifyMesh(vertices, indices, target,
+                                config.m_lod_max_error * diameter, &error);
+        // not worth another draw path if it is almost as expensive
+        if (lod.empty() || lod.size() * 10 > index_count * 9) {
+            break;
+        }
+        if (config.m_optimize_vertex_cache) {
+            OptimizeVertexCache(lod, vertices.size());
+        }
+        index_count = lod.size();
+        float relative_error = error / diameter;
+        if (!lods.empty()) {
+            relative_error = std::max(relative_error, lods.back().m_error);
+        }
+        lods.push_back({std::move(lod), relative_error});
+    }
+    return lods;
+}
+
+uint16_t FloatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (bits >> 16) & 0x8000;
+    uint32_t float_exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (float_exponent == 0xFF) {
+        // inf & nan
+        return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+    }
+
+    int32_t exponent = int32_t(float_exponent) - 127 + 15;
+    if (exponent >= 31) {
+        return sign | 0x7C00;
+    }
+
+    // round to nearest even, carry into exponent is the right result
+    auto round = [](uint32_t value, uint32_t shift) {
+        uint32_t result = value >> shift;
+        uint32_t rest = value & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (result & 1))) {
+            result++;
+        }
+        return result;
+    };
+
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        // subnormal
+        return sign | round(mantissa | 0x800000, 14 - exponent);
+    }
+    return sign | round((uint32_t(exponent) << 23) | mantissa, 13);
+}
+
+float HalfToFloat(uint16_t value) {
+    uint32_t sign = uint32_t(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    uint32_t bits;
+    if (exponent == 0) {
+        float result = std::ldexp(float(mantissa), -24);
+        return sign ? -result : result;
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+static float signNotZero(float value) {
+    return value >= 0 ? 1.0f : -1.0f;
+}
+
+Vec2 EncodeOctahedral(const Vec3& n) {
+    float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    if (l1 == 0) {
+        return {};
+    }
+    Vec2 p{n.x / l1, n.y / l1};
+    if (n.z < 0) {
+        return {(1 - std::abs(p.y)) * signNotZero(p.x),
+                (1 - std::abs(p.x)) * signNotZero(p.y)};
+    }
+    return p;
+}
+
+Vec3 DecodeOctahedral(const Vec2& e) {
+    Vec3 n{e.x, e.y, 1 - std::abs(e.x) - std::abs(e.y)};
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0 ? -t : t;
+    n.y += n.y >= 0 ? -t : t;
+    return Normalize(n);
+}
+
+template <typename T>
+static T quantizeSnorm(float value) {
+    constexpr float Max = std::numeric_limits<T>::max();
+    return static_cast<T>(std::round(std::clamp(value, -1.0f, 1.0f) * Max));
+}
+
+GLTFQuantizedVertex QuantizeVertex(const GLTFVertex& vertex) {
+    GLTFQuantizedVertex result;
+    result.m_position = vertex.m_position;
+    result.m_uv[0] = FloatToHalf(vertex.m_uv.x);
+    result.m_uv[1] = FloatToHalf(vertex.m_uv.y);
+
+    Vec2 normal = EncodeOctahedral(vertex.m_normal);
+    result.m_normal[0] = quantizeSnorm<int16_t>(normal.x);
+    result.m_normal[1] = quantizeSnorm<int16_t>(normal.y);
+
+    Vec3 tangent{vertex.m_tangent.x, vertex.m_tangent.y, vertex.m_tangent.z};
+    float length = Length(tangent);
+    if (length > 0) {
+        tangent /= length;
+    }
+    result.m_tangent[0] = quantizeSnorm<int8_t>(tangent.x);
+    result.m_tangent[1] = quantizeSnorm<int8_t>(tangent.y);
+    result.m_tangent[2] = quantizeSnorm<int8_t>(tangent.z);
+    result.m_tangent[3] = vertex.m_tangent.w < 0 ? -127 : 127;
+    return result;
+}
+
+}  // namespace nickel::graphics
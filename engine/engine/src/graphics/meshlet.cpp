@@ -0,0 +1,291 @@
+#include "nickel/graphics/internal/meshlet.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define NICKEL_MESHLET_SSE
+#endif
+
+namespace nickel::graphics {
+
+static void calcMeshletBounds(std::span<const Vec3> positions,
+                              std::span<const uint32_t> indices,
+                              Meshlet& meshlet) {
+    auto triangles = indices.subspan(meshlet.m_first_index,
+                                     meshlet.m_index_count);
+
+    constexpr float Max = std::numeric_limits<float>::max();
+    constexpr float Lowest = std::numeric_limits<float>::lowest();
+    Vec3 bounds_min{Max, Max, Max}, bounds_max{Lowest, Lowest, Lowest};
+    for (auto index : triangles) {
+        for (int i = 0; i < 3; i++) {
+            bounds_min[i] = std::min(bounds_min[i], positions[index][i]);
+            bounds_max[i] = std::max(bounds_max[i], positions[index][i]);
+        }
+    }
+    meshlet.m_center = (bounds_min + bounds_max) * 0.5f;
+    meshlet.m_radius = 0;
+    for (auto index : triangles) {
+        meshlet.m_radius = std::max(
+            meshlet.m_radius, Length(positions[index] - meshlet.m_center));
+    }
+
+    // cone around the average normal, half angle from the widest normal
+    std::vector<Vec3> normals;
+    normals.reserve(triangles.size() / 3);
+    Vec3 axis;
+    for (size_t i = 0; i + 2 < triangles.size(); i += 3) {
+        const Vec3& p0 = positions[triangles[i]];
+        Vec3 normal = Cross(positions[triangles[i + 1]] - p0,
+                            positions[triangles[i + 2]] - p0);
+        float length = Length(normal);
+        if (length > 0) {
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+    }
+
+    meshlet.m_cone_axis = Vec3{};
+    meshlet.m_cone_cutoff = 1.0f;
+    float axis_length = Length(axis);
+    if (normals.empty() || axis_length <= 0) {
+        return;
+    }
+    axis = axis / axis_length;
+    float min_dot = 1.0f;
+    for (auto& normal : normals) {
+        min_dot = std::min(min_dot, Dot(normal, axis));
+    }
+    // cone wider than ~84 degrees half angle rarely culls anything
+    if (min_dot > 0.1f) {
+        meshlet.m_cone_axis = axis;
+        meshlet.m_cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+    }
+}
+
+std::vector<Meshlet> BuildMeshlets(std::span<const Vec3> positions,
+                                   std::span<const uint32_t> indices) {
+    std::vector<Meshlet> meshlets;
+    // meshlet each vertex was last counted in, +1 so 0 is none
+    std::vector<uint32_t> used(positions.size(), 0);
+
+    Meshlet current;
+    uint32_t vertex_count = 0;
+    for (uint32_t i = 0; i + 2 < indices.size(); i += 3) {
+        uint32_t stamp = meshlets.size() + 1;
+        uint32_t new_vertices = 0;
+        for (int j = 0; j < 3; j++) {
+            new_vertices += used[indices[i + j]] != stamp;
+        }
+        if (vertex_count + new_vertices > MeshletMaxVertices ||
+            current.m_index_count / 3 == MeshletMaxTriangles) {
+            calcMeshletBounds(positions, indices, current);
+            meshlets.push_back(current);
+            current = {};
+            current.m_first_index = i;
+            vertex_count = 0;
+            stamp++;
+        }
+        for (int j = 0; j < 3; j++) {
+            if (used[indices[i + j]] != stamp) {
+                used[indices[i + j]] = stamp;
+                vertex_count++;
+            }
+        }
+        current.m_index_count += 3;
+    }
+    if (current.m_index_count > 0) {
+        calcMeshletBounds(positions, indices, current);
+        meshlets.push_back(current);
+    }
+    return meshlets;
+}
+
+void PackMeshlets(std::span<const Meshlet> meshlets, Primitive& out_prim) {
+    out_prim.m_meshlet_offsets.clear();
+    out_prim.m_meshlet_bounds.clear();
+    if (meshlets.empty()) {
+        return;
+    }
+
+    out_prim.m_meshlet_bounds.resize((meshlets.size() + 3) / 4);
+    for (size_t i = 0; i < meshlets.size(); i++) {
+        auto& meshlet = meshlets[i];
+        auto& bounds = out_prim.m_meshlet_bounds[i / 4];
+        size_t lane = i % 4;
+        bounds.m_center_x[lane] = meshlet.m_center.x;
+        bounds.m_center_y[lane] = meshlet.m_center.y;
+        bounds.m_center_z[lane] = meshlet.m_center.z;
+        bounds.m_radius[lane] = meshlet.m_radius;
+        bounds.m_cone_axis_x[lane] = meshlet.m_cone_axis.x;
+        bounds.m_cone_axis_y[lane] = meshlet.m_cone_axis.y;
+        bounds.m_cone_axis_z[lane] = meshlet.m_cone_axis.z;
+        bounds.m_cone_cutoff[lane] = meshlet.m_cone_cutoff;
+        out_prim.m_meshlet_offsets.push_back(meshlet.m_first_index);
+    }
+    out_prim.m_meshlet_offsets.push_back(meshlets.back().m_first_index +
+                                         meshlets.back().m_index_count);
+}
+
+MeshletCullParams MakeMeshletCullParams(const Mat44& view_project,
+                                        const Mat44& model,
+                                        const Vec3& camera_position) {
+    MeshletCullParams params;
+
+    // planes of model-view-projection are in primitive space
+    Mat44 mvp = view_project * model;
+    auto row = [&](int r) {
+        return Vec4{mvp[0][r], mvp[1][r], mvp[2][r], mvp[3][r]};
+    };
+    Vec4 planes[4] = {row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                      row(3) - row(1)};
+    for (int i = 0; i < 4; i++) {
+        float length = Length(Vec3{planes[i].x, planes[i].y, planes[i].z});
+        params.m_planes[i] = length > 0 ? planes[i] / length : planes[i];
+    }
+
+    // affine inverse by cofactors of the upper 3x3
+    Vec3 c0{model[0].x, model[0].y, model[0].z},
+        c1{model[1].x, model[1].y, model[1].z},
+        c2{model[2].x, model[2].y, model[2].z};
+    Vec3 r0 = Cross(c1, c2), r1 = Cross(c2, c0), r2 = Cross(c0, c1);
+    float det = Dot(c0, r0);
+    Vec3 offset = camera_position - Vec3{model[3].x, model[3].y, model[3].z};
+    if (det != 0) {
+        params.m_camera_position =
+            Vec3{Dot(r0, offset), Dot(r1, offset), Dot(r2, offset)} / det;
+    }
+    params.m_cone_culling = det > 0;
+    return params;
+}
+
+static bool isMeshletVisible(const MeshletBounds4& bounds, size_t lane,
+                             const MeshletCullParams& params) {
+    Vec3 center{bounds.m_center_x[lane], bounds.m_center_y[lane],
+                bounds.m_center_z[lane]};
+    float radius = bounds.m_radius[lane];
+    for (auto& plane : params.m_planes) {
+        if (plane.x * center.x + plane.y * center.y + plane.z * center.z +
+                plane.w <
+            -radius) {
+            return false;
+        }
+    }
+
+    if (params.m_cone_culling) {
+        Vec3 axis{bounds.m_cone_axis_x[lane], bounds.m_cone_axis_y[lane],
+                  bounds.m_cone_axis_z[lane]};
+        Vec3 view = center - params.m_camera_position;
+        if (Dot(view, axis) >=
+            bounds.m_cone_cutoff[lane] * Length(view) + radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t CullMeshletsScalar(const Primitive& prim,
+                            const MeshletCullParams& params,
+                            std::vector<uint32_t>& out_visible) {
+    out_visible.clear();
+    size_t count = prim.m_meshlet_offsets.empty()
+                       ? 0
+                       : prim.m_meshlet_offsets.size() - 1;
+    for (size_t i = 0; i < count; i++) {
+        if (isMeshletVisible(prim.m_meshlet_bounds[i / 4], i % 4, params)) {
+            out_visible.push_back(i);
+        }
+    }
+    return out_visible.size();
+}
+
+uint32_t CullMeshlets(const Primitive& prim, const MeshletCullParams& params,
+                      std::vector<uint32_t>& out_visible) {
+#ifdef NICKEL_MESHLET_SSE
+    out_visible.clear();
+    size_t count = prim.m_meshlet_offsets.empty()
+                       ? 0
+                       : prim.m_meshlet_offsets.size() - 1;
+
+    __m128 plane_x[4], plane_y[4], plane_z[4], plane_w[4];
+    for (int i = 0; i < 4; i++) {
+        plane_x[i] = _mm_set1_ps(params.m_planes[i].x);
+        plane_y[i] = _mm_set1_ps(params.m_planes[i].y);
+        plane_z[i] = _mm_set1_ps(params.m_planes[i].z);
+        plane_w[i] = _mm_set1_ps(params.m_planes[i].w);
+    }
+    __m128 camera_x = _mm_set1_ps(params.m_camera_position.x);
+    __m128 camera_y = _mm_set1_ps(params.m_camera_position.y);
+    __m128 camera_z = _mm_set1_ps(params.m_camera_position.z);
+    __m128 zero = _mm_setzero_ps();
+
+    for (size_t group = 0; group * 4 < count; group++) {
+        auto& bounds = prim.m_meshlet_bounds[group];
+        __m128 x = _mm_load_ps(bounds.m_center_x);
+        __m128 y = _mm_load_ps(bounds.m_center_y);
+        __m128 z = _mm_load_ps(bounds.m_center_z);
+        __m128 radius = _mm_load_ps(bounds.m_radius);
+        __m128 neg_radius = _mm_sub_ps(zero, radius);
+
+        __m128 visible = _mm_cmpeq_ps(zero, zero);
+        for (int i = 0; i < 4; i++) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(plane_x[i], x), _mm_mul_ps(plane_y[i], y)),
+                _mm_add_ps(_mm_mul_ps(plane_z[i], z), plane_w[i]));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, neg_radius));
+        }
+
+        if (params.m_cone_culling) {
+            __m128 view_x = _mm_sub_ps(x, camera_x);
+            __m128 view_y = _mm_sub_ps(y, camera_y);
+            __m128 view_z = _mm_sub_ps(z, camera_z);
+            __m128 view_dot_axis = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(view_x, _mm_load_ps(bounds.m_cone_axis_x)),
+                    _mm_mul_ps(view_y, _mm_load_ps(bounds.m_cone_axis_y))),
+                _mm_mul_ps(view_z, _mm_load_ps(bounds.m_cone_axis_z)));
+            __m128 view_length = _mm_sqrt_ps(_mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(view_x, view_x),
+                           _mm_mul_ps(view_y, view_y)),
+                _mm_mul_ps(view_z, view_z)));
+            __m128 limit = _mm_add_ps(
+                _mm_mul_ps(_mm_load_ps(bounds.m_cone_cutoff), view_length),
+                radius);
+            visible = _mm_andnot_ps(_mm_cmpge_ps(view_dot_axis, limit),
+                                    visible);
+        }
+
+        int mask = _mm_movemask_ps(visible);
+        for (size_t lane = 0; lane < 4 && group * 4 + lane < count; lane++) {
+            if (mask & (1 << lane)) {
+                out_visible.push_back(group * 4 + lane);
+            }
+        }
+    }
+    return out_visible.size();
+#else
+    return CullMeshletsScalar(prim, params, out_visible);
+#endif
+}
+
+void CompactMeshletRanges(const Primitive& prim,
+                          std::span<const uint32_t> visible,
+                          std::vector<MeshletDrawRange>& out_ranges) {
+    out_ranges.clear();
+    auto& offsets = prim.m_meshlet_offsets;
+    for (auto meshlet : visible) {
+        uint32_t first = offsets[meshlet];
+        uint32_t count = offsets[meshlet + 1] - first;
+        if (!out_ranges.empty() &&
+            out_ranges.back().m_first_index + out_ranges.back().m_index_count ==
+                first) {
+            out_ranges.back().m_index_count += count;
+        } else {
+            out_ranges.push_back({first, count});
+        }
+    }
+}
+
+}  // namespace nickel::graphics
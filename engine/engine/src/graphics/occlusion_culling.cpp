@@ -0,0 +1,285 @@
+#include "nickel/graphics/occlusion_culling.hpp"
+#include "nickel/common/log.hpp"
+#include "nickel/common/macro.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <limits>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define NICKEL_OCCLUSION_SSE
+#endif
+
+namespace nickel::graphics {
+
+namespace {
+
+constexpr float EmptyDepth = std::numeric_limits<float>::lowest();
+
+/// `a * x + b * y + c`
+struct LinearFunc {
+    float a{}, b{}, c{};
+};
+
+/// positive on the inner side of edge `from -> to` of a triangle with
+/// positive signed area
+LinearFunc MakeEdge(float from_x, float from_y, float to_x, float to_y) {
+    LinearFunc edge;
+    edge.a = from_y - to_y;
+    edge.b = to_x - from_x;
+    edge.c = -(edge.a * from_x + edge.b * from_y);
+    return edge;
+}
+
+/// clamp before converting, projected coordinates may be huge
+int ClampToInt(float value, int min, int max) {
+    return static_cast<int>(std::clamp<float>(value, min, max));
+}
+
+}  // namespace
+
+OcclusionCuller::OcclusionCuller() : OcclusionCuller{Descriptor{}} {}
+
+OcclusionCuller::OcclusionCuller(const Descriptor& desc) : m_desc{desc} {
+    m_desc.m_width = std::max((m_desc.m_width + 3) / 4 * 4, 4u);
+    m_desc.m_height = std::max(m_desc.m_height, 1u);
+    m_desc.m_band_height = std::max(m_desc.m_band_height, 1u);
+    m_depth.resize(m_desc.m_width * m_desc.m_height, EmptyDepth);
+}
+
+void OcclusionCuller::BeginFrame(const Mat44& view_project) {
+    m_view_project = view_project;
+    std::fill(m_depth.begin(), m_depth.end(), EmptyDepth);
+    m_triangles.clear();
+    m_stats = {};
+}
+
+void OcclusionCuller::AddOccluder(const OccluderMesh& mesh,
+                                  const Mat44& model) {
+    for (auto index : mesh.m_indices) {
+        NICKEL_RETURN_IF_FALSE_LOGE(index < mesh.m_points.size(),
+                                    "occluder index {} out of range", index);
+    }
+
+    Mat44 mvp = m_view_project * model;
+    float width = m_desc.m_width;
+    float height = m_desc.m_height;
+    for (size_t i = 0; i + 2 < mesh.m_indices.size(); i += 3) {
+        m_stats.m_occluder_triangles++;
+
+        ScreenTriangle triangle;
+        bool crossing = false;
+        for (int v = 0; v < 3; v++) {
+            auto& p = mesh.m_points[mesh.m_indices[i + v]];
+            Vec4 clip = mvp * Vec4{p.x, p.y, p.z, 1};
+            if (clip.w <= 0) {
+                crossing = true;
+                break;
+            }
+            triangle.m_x[v] = (clip.x / clip.w * 0.5f + 0.5f) * width;
+            triangle.m_y[v] = (clip.y / clip.w * 0.5f + 0.5f) * height;
+            triangle.m_z[v] = clip.z / clip.w;
+        }
+
+        if (crossing) {
+            m_stats.m_skipped_triangles++;
+            continue;
+        }
+        m_triangles.push_back(triangle);
+    }
+}
+
+void OcclusionCuller::RasterizeOccluders(ThreadPool* pool) {
+    uint32_t band = m_desc.m_band_height;
+    if (!pool) {
+        for (uint32_t row = 0; row < m_desc.m_height; row += band) {
+            rasterizeBand(row, std::min(row + band, m_desc.m_height));
+        }
+        return;
+    }
+
+    // bands own disjoint rows, no synchronization inside
+    std::vector<std::future<void>> jobs;
+    for (uint32_t row = 0; row < m_desc.m_height; row += band) {
+        uint32_t row_end = std::min(row + band, m_desc.m_height);
+        jobs.push_back(pool->Submit(
+            [this, row, row_end] { rasterizeBand(row, row_end); }));
+    }
+    for (auto& job : jobs) {
+        job.wait();
+    }
+}
+
+bool OcclusionCuller::IsOccluded(const OccludeeBounds& bounds,
+                                 const Mat44& model) {
+    m_stats.m_tested++;
+
+    Mat44 mvp = m_view_project * model;
+    float min_x = std::numeric_limits<float>::max(), min_y = min_x;
+    float max_x = std::numeric_limits<float>::lowest(), max_y = max_x;
+    float nearest = max_x;
+    for (int i = 0; i < 8; i++) {
+        Vec4 corner{i & 1 ? bounds.m_max.x : bounds.m_min.x,
+                    i & 2 ? bounds.m_max.y : bounds.m_min.y,
+                    i & 4 ? bounds.m_max.z : bounds.m_min.z, 1};
+        Vec4 clip = mvp * corner;
+        if (clip.w <= 0) {
+            return false;
+        }
+        float x = (clip.x / clip.w * 0.5f + 0.5f) * m_desc.m_width;
+        float y = (clip.y / clip.w * 0.5f + 0.5f) * m_desc.m_height;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+        nearest = std::max(nearest, clip.z / clip.w);
+    }
+
+    if (max_x < 0 || max_y < 0 || min_x >= m_desc.m_width ||
+        min_y >= m_desc.m_height) {
+        return false;
+    }
+
+    int x_begin = ClampToInt(std::floor(min_x), 0, m_desc.m_width - 1);
+    int x_end = ClampToInt(std::floor(max_x), 0, m_desc.m_width - 1) + 1;
+    int y_begin = ClampToInt(std::floor(min_y), 0, m_desc.m_height - 1);
+    int y_end = ClampToInt(std::floor(max_y), 0, m_desc.m_height - 1) + 1;
+
+    for (int y = y_begin; y < y_end; y++) {
+        const float* row = m_depth.data() + y * m_desc.m_width;
+        int x = x_begin;
+#ifdef NICKEL_OCCLUSION_SSE
+        __m128 box_depth = _mm_set1_ps(nearest);
+        for (; x + 4 <= x_end; x += 4) {
+            __m128 depth = _mm_loadu_ps(row + x);
+            if (_mm_movemask_ps(_mm_cmple_ps(depth, box_depth))) {
+                return false;
+            }
+        }
+#endif
+        for (; x < x_end; x++) {
+            if (row[x] <= nearest) {
+                return false;
+            }
+        }
+    }
+
+    m_stats.m_rejected++;
+    return true;
+}
+
+const OcclusionCullStats& OcclusionCuller::GetStats() const {
+    return m_stats;
+}
+
+std::span<const float> OcclusionCuller::GetDepthBuffer() const {
+    return m_depth;
+}
+
+uint32_t OcclusionCuller::GetWidth() const {
+    return m_desc.m_width;
+}
+
+uint32_t OcclusionCuller::GetHeight() const {
+    return m_desc.m_height;
+}
+
+void OcclusionCuller::rasterizeBand(uint32_t row_begin, uint32_t row_end) {
+    for (auto& triangle : m_triangles) {
+        rasterizeTriangle(triangle, row_begin, row_end);
+    }
+}
+
+void OcclusionCuller::rasterizeTriangle(const ScreenTriangle& triangle,
+                                        int row_begin, int row_end) {
+    const float* x = triangle.m_x;
+    const float* y = triangle.m_y;
+    const float* z = triangle.m_z;
+
+    int y_begin = ClampToInt(std::floor(std::min({y[0], y[1], y[2]})),
+                             row_begin, row_end);
+    int y_end = ClampToInt(std::ceil(std::max({y[0], y[1], y[2]})), row_begin,
+                           row_end);
+    int x_begin =
+        ClampToInt(std::floor(std::min({x[0], x[1], x[2]})), 0, m_desc.m_width);
+    int x_end =
+        ClampToInt(std::ceil(std::max({x[0], x[1], x[2]})), 0, m_desc.m_width);
+    if (y_begin >= y_end || x_begin >= x_end) {
+        return;
+    }
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (area == 0) {
+        return;
+    }
+
+    // swap to positive area instead of culling back faces
+    int v1 = 1, v2 = 2;
+    if (area < 0) {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    LinearFunc edges[3] = {MakeEdge(x[v1], y[v1], x[v2], y[v2]),
+                           MakeEdge(x[v2], y[v2], x[0], y[0]),
+                           MakeEdge(x[0], y[0], x[v1], y[v1])};
+
+    // barycentric interpolation, each edge weights its opposite vertex
+    LinearFunc depth;
+    float weights[3] = {z[0] / area, z[v1] / area, z[v2] / area};
+    for (int i = 0; i < 3; i++) {
+        depth.a += edges[i].a * weights[i];
+        depth.b += edges[i].b * weights[i];
+        depth.c += edges[i].c * weights[i];
+    }
+
+    // 4 aligned pixels a step, width is a multiple of 4
+    x_begin &= ~3;
+    for (int row = y_begin; row < y_end; row++) {
+        float* pixels = m_depth.data() + row * m_desc.m_width;
+        float py = row + 0.5f;
+#ifdef NICKEL_OCCLUSION_SSE
+        __m128 zero = _mm_setzero_ps();
+        __m128 lane_offset = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        __m128 edge_row[3];
+        __m128 edge_a[3];
+        for (int i = 0; i < 3; i++) {
+            edge_row[i] = _mm_set1_ps(edges[i].b * py + edges[i].c);
+            edge_a[i] = _mm_set1_ps(edges[i].a);
+        }
+        __m128 depth_row = _mm_set1_ps(depth.b * py + depth.c);
+        __m128 depth_a = _mm_set1_ps(depth.a);
+        for (int col = x_begin; col < x_end; col += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps(col), lane_offset);
+            __m128 inside = _mm_cmpeq_ps(zero, zero);
+            for (int i = 0; i < 3; i++) {
+                __m128 e = _mm_add_ps(_mm_mul_ps(edge_a[i], px), edge_row[i]);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(e, zero));
+            }
+            if (!_mm_movemask_ps(inside)) {
+                continue;
+            }
+            __m128 d = _mm_add_ps(_mm_mul_ps(depth_a, px), depth_row);
+            __m128 old = _mm_loadu_ps(pixels + col);
+            __m128 nearer = _mm_and_ps(inside, _mm_cmpgt_ps(d, old));
+            _mm_storeu_ps(pixels + col, _mm_or_ps(_mm_and_ps(nearer, d),
+                                                 _mm_andnot_ps(nearer, old)));
+        }
+#else
+        for (int col = x_begin; col < x_end; col++) {
+            float px = col + 0.5f;
+            bool inside = true;
+            for (auto& edge : edges) {
+                inside = inside && edge.a * px + (edge.b * py + edge.c) >= 0;
+            }
+            if (inside) {
+                float d = depth.a * px + (depth.b * py + depth.c);
+                pixels[col] = std::max(pixels[col], d);
+            }
+        }
+#endif
+    }
+}
+
+}  // namespace nickel::graphics
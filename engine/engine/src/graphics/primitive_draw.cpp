@@ -9,7 +9,8 @@ namespace nickel::graphics {
 PrimitiveRenderPass::PrimitiveRenderPass(Device device,
                                          StorageManager& storage_mgr,
                                          RenderPass& render_pass,
-                                         CommonResource& res) {
+                                         CommonResource& res)
+    : m_common_resource{res} {
     initVertexBuffer(device);
     initIndicesBuffer(device);
     initBindGroupLayout(device);
@@ -134,19 +135,20 @@ void PrimitiveRenderPass::ApplyDrawCall(RenderPassEncoder& encoder) {
         Mat44::Identity(),
         camera.GetView(),
     };
+    uint32_t frame_offsets[] = {m_common_resource.GetFrameUniformOffset()};
 
     if (m_line_vertex_buffer.m_elem_count > 0) {
         encoder.BindGraphicsPipeline(m_line_pipeline);
         encoder.SetPushConstant(ShaderStage::Vertex, &model_view, 0,
                                 sizeof(model_view));
-        encoder.SetBindGroup(0, m_bind_group);
+        encoder.SetBindGroup(0, m_bind_group, frame_offsets);
         encoder.BindVertexBuffer(0, m_line_vertex_buffer.m_gpu, 0);
         encoder.Draw(m_line_vertex_buffer.m_elem_count, 1, 0, 0);
     }
 
     if (m_triangle_vertex_buffer.m_elem_count > 0) {
         encoder.BindGraphicsPipeline(m_triangle_solid_pipeline);
-        encoder.SetBindGroup(0, m_bind_group);
+        encoder.SetBindGroup(0, m_bind_group, frame_offsets);
         encoder.SetPushConstant(ShaderStage::Vertex, &model_view, 0,
                                 sizeof(model_view));
         encoder.BindVertexBuffer(0, m_triangle_vertex_buffer.m_gpu, 0);
@@ -157,7 +159,7 @@ void PrimitiveRenderPass::ApplyDrawCall(RenderPassEncoder& encoder) {
 
     if (m_triangle_wireframe_vertex_buffer.m_elem_count > 0) {
         encoder.BindGraphicsPipeline(m_triangle_wire_pipeline);
-        encoder.SetBindGroup(0, m_bind_group);
+        encoder.SetBindGroup(0, m_bind_group, frame_offsets);
         encoder.SetPushConstant(ShaderStage::Vertex, &model_view, 0,
                                 sizeof(model_view));
         encoder.BindVertexBuffer(0, m_triangle_wireframe_vertex_buffer.m_gpu,
@@ -209,7 +211,7 @@ void PrimitiveRenderPass::initBindGroupLayout(Device& device) {
     BindGroupLayout::Descriptor desc;
     BindGroupLayout::Entry entry;
     entry.m_shader_stage = ShaderStage::Vertex;
-    entry.m_type = BindGroupEntryType::UniformBuffer;
+    entry.m_type = BindGroupEntryType::UniformBufferDynamic;
     entry.m_array_size = 1;
     desc.m_entries[0] = entry;
 
@@ -221,7 +223,8 @@ void PrimitiveRenderPass::initBindGroup(CommonResource& res) {
     BindGroup::Entry entry;
     BindGroup::BufferBinding binding;
     binding.m_buffer = res.m_camera_buffer;
-    binding.m_type = BindGroup::BufferBinding::Type::Uniform;
+    binding.m_type = BindGroup::BufferBinding::Type::DynamicUniform;
+    binding.m_size = sizeof(Mat44);
     entry.m_binding.m_entry = binding;
     entry.m_shader_stage = ShaderStage::Vertex;
     entry.m_array_size = 1;
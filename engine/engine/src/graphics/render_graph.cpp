@@ -0,0 +1,597 @@
+#include "nickel/graphics/render_graph.hpp"
+
+#include "nickel/common/assert.hpp"
+#include "nickel/graphics/lowlevel/cmd_encoder.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace nickel::graphics {
+
+namespace {
+
+const char* GetImageLayoutName(ImageLayout layout) {
+    switch (layout) {
+        case ImageLayout::Undefined:
+            return "undefined";
+        case ImageLayout::General:
+            return "general";
+        case ImageLayout::PresentSrcKHR:
+            return "present_src";
+        case ImageLayout::ColorAttachmentOptimal:
+            return "color_attachment";
+        case ImageLayout::DepthStencilAttachmentOptimal:
+            return "depth_stencil_attachment";
+        case ImageLayout::ShaderReadOnlyOptimal:
+            return "shader_read_only";
+        case ImageLayout::TransferSrcOptimal:
+            return "transfer_src";
+        case ImageLayout::TransferDstOptimal:
+            return "transfer_dst";
+        default:
+            return "other";
+    }
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+ImageLayout GetRenderGraphAccessLayout(RenderGraphAccess access) {
+    switch (access) {
+        case RenderGraphAccess::ColorAttachment:
+            return ImageLayout::ColorAttachmentOptimal;
+        case RenderGraphAccess::DepthStencilAttachment:
+            return ImageLayout::DepthStencilAttachmentOptimal;
+        case RenderGraphAccess::ShaderRead:
+            return ImageLayout::ShaderReadOnlyOptimal;
+        case RenderGraphAccess::TransferSrc:
+            return ImageLayout::TransferSrcOptimal;
+        case RenderGraphAccess::TransferDst:
+            return ImageLayout::TransferDstOptimal;
+        case RenderGraphAccess::Present:
+            return ImageLayout::PresentSrcKHR;
+    }
+    return ImageLayout::Undefined;
+}
+
+const char* GetRenderGraphAccessName(RenderGraphAccess access) {
+    switch (access) {
+        case RenderGraphAccess::ColorAttachment:
+            return "color_attachment";
+        case RenderGraphAccess::DepthStencilAttachment:
+            return "depth_stencil_attachment";
+        case RenderGraphAccess::ShaderRead:
+            return "shader_read";
+        case RenderGraphAccess::TransferSrc:
+            return "transfer_src";
+        case RenderGraphAccess::TransferDst:
+            return "transfer_dst";
+        case RenderGraphAccess::Present:
+            return "present";
+    }
+    return "unknown";
+}
+
+Flags<PipelineStage> GetRenderGraphAccessStage(RenderGraphAccess access) {
+    switch (access) {
+        case RenderGraphAccess::ColorAttachment:
+            return PipelineStage::ColorAttachmentOutput;
+        case RenderGraphAccess::DepthStencilAttachment:
+            return Flags{PipelineStage::EarlyFragmentTests} |
+                   PipelineStage::LateFragmentTests;
+        case RenderGraphAccess::ShaderRead:
+            return Flags{PipelineStage::FragmentShader} |
+                   PipelineStage::ComputeShader;
+        case RenderGraphAccess::TransferSrc:
+        case RenderGraphAccess::TransferDst:
+            return PipelineStage::Transfer;
+        case RenderGraphAccess::Present:
+            return PipelineStage::BottomOfPipe;
+    }
+    return PipelineStage::AllCommands;
+}
+
+Flags<Access> GetRenderGraphAccessMask(RenderGraphAccess access) {
+    switch (access) {
+        case RenderGraphAccess::ColorAttachment:
+            return Flags{Access::ColorAttachmentRead} |
+                   Access::ColorAttachmentWrite;
+        case RenderGraphAccess::DepthStencilAttachment:
+            return Flags{Access::DepthStencilAttachmentRead} |
+                   Access::DepthStencilAttachmentWrite;
+        case RenderGraphAccess::ShaderRead:
+            return Access::ShaderRead;
+        case RenderGraphAccess::TransferSrc:
+            return Access::TransferRead;
+        case RenderGraphAccess::TransferDst:
+            return Access::TransferWrite;
+        case RenderGraphAccess::Present:
+            return Access::None;
+    }
+    return Flags{Access::MemoryRead} | Access::MemoryWrite;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(
+    ResourceHandle resource, RenderGraphAccess access) {
+    NICKEL_ASSERT(resource < m_graph.m_resources.size());
+    m_graph.m_passes[m_pass].m_accesses.push_back({resource, access, false});
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(
+    ResourceHandle resource, RenderGraphAccess access) {
+    NICKEL_ASSERT(resource < m_graph.m_resources.size());
+    m_graph.m_passes[m_pass].m_accesses.push_back({resource, access, true});
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SideEffect() {
+    m_graph.m_passes[m_pass].m_side_effect = true;
+    return *this;
+}
+
+RenderGraph::ResourceHandle RenderGraph::ImportImage(
+    std::string name, ImageLayout initial_layout, ImageLayout final_layout) {
+    Resource resource;
+    resource.m_name = std::move(name);
+    resource.m_imported = true;
+    resource.m_initial_layout = initial_layout;
+    resource.m_final_layout = final_layout;
+    m_resources.push_back(std::move(resource));
+    return m_resources.size() - 1;
+}
+
+RenderGraph::ResourceHandle RenderGraph::CreateTransient(
+    std::string name, const TransientDesc& desc) {
+    Resource resource;
+    resource.m_name = std::move(name);
+    resource.m_desc = desc;
+    m_resources.push_back(std::move(resource));
+    return m_resources.size() - 1;
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(std::string name,
+                                              ExecuteFn execute) {
+    Pass pass;
+    pass.m_name = std::move(name);
+    pass.m_execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+    return PassBuilder{*this, static_cast<PassHandle>(m_passes.size() - 1)};
+}
+
+void RenderGraph::Compile() {
+    cullPasses();
+    computeLifetimes();
+    allocateTransients();
+    scheduleBarriers();
+}
+
+void RenderGraph::cullPasses() {
+    // a read of a resource the same pass writes doesn't keep it alive
+    auto isPureRead = [](const Pass& pass, const Access& access) {
+        if (access.m_write) {
+            return false;
+        }
+        for (auto& other : pass.m_accesses) {
+            if (other.m_write && other.m_resource == access.m_resource) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    for (auto& resource : m_resources) {
+        // imported resources are consumed outside the graph
+        resource.m_refcount = resource.m_imported ? 1 : 0;
+    }
+    for (auto& pass : m_passes) {
+        pass.m_culled = false;
+        pass.m_refcount = pass.m_side_effect ? 1 : 0;
+        for (size_t i = 0; i < pass.m_accesses.size(); i++) {
+            auto& access = pass.m_accesses[i];
+            if (access.m_write) {
+                // count each written resource once
+                bool counted = false;
+                for (size_t j = 0; j < i; j++) {
+                    counted |= pass.m_accesses[j].m_write &&
+                               pass.m_accesses[j].m_resource ==
+                                   access.m_resource;
+                }
+                pass.m_refcount += counted ? 0 : 1;
+            } else if (isPureRead(pass, access)) {
+                m_resources[access.m_resource].m_refcount++;
+            }
+        }
+    }
+
+    auto cullPass = [&](Pass& pass, std::vector<ResourceHandle>* unused) {
+        pass.m_culled = true;
+        for (auto& access : pass.m_accesses) {
+            if (isPureRead(pass, access) &&
+                --m_resources[access.m_resource].m_refcount == 0 && unused) {
+                unused->push_back(access.m_resource);
+            }
+        }
+    };
+
+    // passes writing nothing & without side effect are never needed
+    for (auto& pass : m_passes) {
+        if (pass.m_refcount == 0) {
+            cullPass(pass, nullptr);
+        }
+    }
+
+    std::vector<ResourceHandle> unused;
+    for (ResourceHandle i = 0; i < m_resources.size(); i++) {
+        if (m_resources[i].m_refcount == 0) {
+            unused.push_back(i);
+        }
+    }
+
+    while (!unused.empty()) {
+        ResourceHandle resource = unused.back();
+        unused.pop_back();
+
+        for (auto& pass : m_passes) {
+            if (pass.m_culled) {
+                continue;
+            }
+            bool writes = false;
+            for (auto& access : pass.m_accesses) {
+                writes |= access.m_write && access.m_resource == resource;
+            }
+            if (writes && --pass.m_refcount == 0) {
+                cullPass(pass, &unused);
+            }
+        }
+    }
+
+    m_execution_order.clear();
+    for (PassHandle i = 0; i < m_passes.size(); i++) {
+        if (!m_passes[i].m_culled) {
+            m_execution_order.push_back(i);
+        }
+    }
+}
+
+void RenderGraph::computeLifetimes() {
+    for (auto& resource : m_resources) {
+        resource.m_first_use.reset();
+        resource.m_last_use.reset();
+    }
+    for (auto pass : m_execution_order) {
+        for (auto& access : m_passes[pass].m_accesses) {
+            auto& resource = m_resources[access.m_resource];
+            if (!resource.m_first_use) {
+                resource.m_first_use = pass;
+            }
+            resource.m_last_use = pass;
+        }
+    }
+}
+
+void RenderGraph::allocateTransients() {
+    struct MemoryBlock {
+        uint64_t m_size{};
+        uint64_t m_alignment = 1;
+        PassHandle m_busy_until{};
+    };
+
+    // transients in order of first use, so a block is free once the last
+    // user of its previous resource has executed
+    std::vector<ResourceHandle> transients;
+    for (ResourceHandle i = 0; i < m_resources.size(); i++) {
+        auto& resource = m_resources[i];
+        resource.m_memory_block = NoMemoryBlock;
+        resource.m_memory_offset = 0;
+        if (!resource.m_imported && resource.m_first_use) {
+            transients.push_back(i);
+        }
+    }
+    std::ranges::stable_sort(transients, {}, [&](ResourceHandle handle) {
+        return *m_resources[handle].m_first_use;
+    });
+
+    std::vector<MemoryBlock> blocks;
+    m_unaliased_size = 0;
+    for (auto handle : transients) {
+        auto& resource = m_resources[handle];
+        m_unaliased_size += resource.m_desc.m_size;
+
+        // best fit among free blocks, growing the largest if none fits
+        std::optional<uint32_t> best;
+        for (uint32_t i = 0; i < blocks.size(); i++) {
+            auto& block = blocks[i];
+            if (block.m_busy_until >= *resource.m_first_use) {
+                continue;
+            }
+            if (!best) {
+                best = i;
+                continue;
+            }
+            auto& best_block = blocks[*best];
+            bool fits = block.m_size >= resource.m_desc.m_size;
+            bool best_fits = best_block.m_size >= resource.m_desc.m_size;
+            if ((fits && (!best_fits || block.m_size < best_block.m_size)) ||
+                (!fits && !best_fits && block.m_size > best_block.m_size)) {
+                best = i;
+            }
+        }
+        if (!best) {
+            best = blocks.size();
+            blocks.emplace_back();
+        }
+
+        auto& block = blocks[*best];
+        block.m_size = std::max(block.m_size, resource.m_desc.m_size);
+        block.m_alignment =
+            std::max(block.m_alignment, resource.m_desc.m_alignment);
+        block.m_busy_until = *resource.m_last_use;
+        resource.m_memory_block = *best;
+    }
+
+    std::vector<uint64_t> block_offsets;
+    m_transient_size = 0;
+    for (auto& block : blocks) {
+        m_transient_size = AlignUp(m_transient_size, block.m_alignment);
+        block_offsets.push_back(m_transient_size);
+        m_transient_size += block.m_size;
+    }
+    for (auto handle : transients) {
+        auto& resource = m_resources[handle];
+        resource.m_memory_offset = block_offsets[resource.m_memory_block];
+    }
+}
+
+void RenderGraph::scheduleBarriers() {
+    struct State {
+        ImageLayout m_layout = ImageLayout::Undefined;
+        std::optional<RenderGraphAccess> m_access;
+        bool m_written = false;
+    };
+
+    std::vector<State> states(m_resources.size());
+    for (size_t i = 0; i < m_resources.size(); i++) {
+        if (m_resources[i].m_imported) {
+            states[i].m_layout = m_resources[i].m_initial_layout;
+        }
+    }
+
+    for (auto& pass : m_passes) {
+        pass.m_barriers.clear();
+    }
+
+    for (auto pass_handle : m_execution_order) {
+        auto& pass = m_passes[pass_handle];
+        for (size_t i = 0; i < pass.m_accesses.size(); i++) {
+            auto& access = pass.m_accesses[i];
+
+            // a resource read & written by one pass gets one barrier, its
+            // layout is decided by the write
+            bool skip = false;
+            for (size_t j = 0; j < pass.m_accesses.size(); j++) {
+                auto& other = pass.m_accesses[j];
+                if (i != j && other.m_resource == access.m_resource &&
+                    (other.m_write > access.m_write ||
+                     (other.m_write == access.m_write && j < i))) {
+                    skip = true;
+                }
+            }
+            if (skip) {
+                continue;
+            }
+
+            auto& state = states[access.m_resource];
+            ImageLayout layout = GetRenderGraphAccessLayout(access.m_access);
+
+            // content of aliased memory is undefined at first use
+            if (!m_resources[access.m_resource].m_imported &&
+                m_resources[access.m_resource].m_first_use == pass_handle) {
+                state = {};
+            }
+
+            // only read after read in the same layout needs nothing
+            bool need_barrier = layout != state.m_layout || access.m_write ||
+                                state.m_written;
+            if (need_barrier) {
+                RenderGraphBarrier barrier;
+                barrier.m_resource = access.m_resource;
+                barrier.m_old_layout = state.m_layout;
+                barrier.m_new_layout = layout;
+                barrier.m_src_access = state.m_access;
+                barrier.m_dst_access = access.m_access;
+                pass.m_barriers.push_back(barrier);
+            }
+
+            state.m_layout = layout;
+            state.m_access = access.m_access;
+            state.m_written = access.m_write;
+        }
+    }
+
+    m_final_barriers.clear();
+    for (ResourceHandle i = 0; i < m_resources.size(); i++) {
+        auto& resource = m_resources[i];
+        auto& state = states[i];
+        if (!resource.m_imported ||
+            resource.m_final_layout == ImageLayout::Undefined ||
+            resource.m_final_layout == state.m_layout) {
+            continue;
+        }
+        RenderGraphBarrier barrier;
+        barrier.m_resource = i;
+        barrier.m_old_layout = state.m_layout;
+        barrier.m_new_layout = resource.m_final_layout;
+        barrier.m_src_access = state.m_access;
+        barrier.m_dst_access = RenderGraphAccess::Present;
+        m_final_barriers.push_back(barrier);
+    }
+}
+
+void RenderGraph::Execute(const BarrierFn& barrier_fn) const {
+    for (auto handle : m_execution_order) {
+        auto& pass = m_passes[handle];
+        if (barrier_fn && !pass.m_barriers.empty()) {
+            barrier_fn(handle, pass.m_barriers);
+        }
+        if (pass.m_execute) {
+            pass.m_execute();
+        }
+    }
+    if (barrier_fn && !m_final_barriers.empty()) {
+        barrier_fn(NoPass, m_final_barriers);
+    }
+}
+
+void RenderGraph::Clear() {
+    m_passes.clear();
+    m_resources.clear();
+    m_execution_order.clear();
+    m_final_barriers.clear();
+    m_transient_size = 0;
+    m_unaliased_size = 0;
+}
+
+bool RenderGraph::IsPassCulled(PassHandle pass) const {
+    return m_passes.at(pass).m_culled;
+}
+
+std::span<const RenderGraph::PassHandle> RenderGraph::GetExecutionOrder()
+    const noexcept {
+    return m_execution_order;
+}
+
+std::span<const RenderGraphBarrier> RenderGraph::GetBarriers(
+    PassHandle pass) const {
+    return m_passes.at(pass).m_barriers;
+}
+
+std::span<const RenderGraphBarrier> RenderGraph::GetFinalBarriers()
+    const noexcept {
+    return m_final_barriers;
+}
+
+uint64_t RenderGraph::GetMemoryOffset(ResourceHandle resource) const {
+    return m_resources.at(resource).m_memory_offset;
+}
+
+uint32_t RenderGraph::GetMemoryBlock(ResourceHandle resource) const {
+    return m_resources.at(resource).m_memory_block;
+}
+
+uint64_t RenderGraph::GetTransientMemorySize() const noexcept {
+    return m_transient_size;
+}
+
+uint64_t RenderGraph::GetUnaliasedMemorySize() const noexcept {
+    return m_unaliased_size;
+}
+
+std::string RenderGraph::Dump() const {
+    std::ostringstream out;
+    auto dumpBarrier = [&](const RenderGraphBarrier& barrier) {
+        out << "  barrier " << m_resources[barrier.m_resource].m_name << " "
+            << GetImageLayoutName(barrier.m_old_layout) << " -> "
+            << GetImageLayoutName(barrier.m_new_layout) << "\n";
+    };
+
+    for (PassHandle i = 0; i < m_passes.size(); i++) {
+        auto& pass = m_passes[i];
+        out << "pass " << pass.m_name << (pass.m_culled ? " (culled)" : "")
+            << "\n";
+        for (auto& access : pass.m_accesses) {
+            out << "  " << (access.m_write ? "write " : "read ")
+                << m_resources[access.m_resource].m_name << " "
+                << GetRenderGraphAccessName(access.m_access) << "\n";
+        }
+        for (auto& barrier : pass.m_barriers) {
+            dumpBarrier(barrier);
+        }
+    }
+    if (!m_final_barriers.empty()) {
+        out << "final\n";
+        for (auto& barrier : m_final_barriers) {
+            dumpBarrier(barrier);
+        }
+    }
+    for (auto& resource : m_resources) {
+        if (resource.m_imported) {
+            out << "resource " << resource.m_name << " imported\n";
+        } else if (resource.m_memory_block == NoMemoryBlock) {
+            out << "resource " << resource.m_name << " unused\n";
+        } else {
+            out << "resource " << resource.m_name << " block "
+                << resource.m_memory_block << " offset "
+                << resource.m_memory_offset << " size "
+                << resource.m_desc.m_size << "\n";
+        }
+    }
+    out << "transient memory " << m_transient_size << " / "
+        << m_unaliased_size << "\n";
+    return out.str();
+}
+
+std::string RenderGraph::DumpGraphviz() const {
+    std::ostringstream out;
+    out << "digraph RenderGraph {\n";
+    for (PassHandle i = 0; i < m_passes.size(); i++) {
+        auto& pass = m_passes[i];
+        out << "  pass" << i << " [label=\"" << pass.m_name
+            << "\", shape=box" << (pass.m_culled ? ", style=dashed" : "")
+            << "];\n";
+    }
+    for (ResourceHandle i = 0; i < m_resources.size(); i++) {
+        auto& resource = m_resources[i];
+        out << "  res" << i << " [label=\"" << resource.m_name
+            << "\", shape=ellipse"
+            << (resource.m_imported ? ", style=bold" : "") << "];\n";
+    }
+    for (PassHandle i = 0; i < m_passes.size(); i++) {
+        for (auto& access : m_passes[i].m_accesses) {
+            if (access.m_write) {
+                out << "  pass" << i << " -> res" << access.m_resource;
+            } else {
+                out << "  res" << access.m_resource << " -> pass" << i;
+            }
+            out << " [label=\"" << GetRenderGraphAccessName(access.m_access)
+                << "\"];\n";
+        }
+    }
+    out << "}\n";
+    return out.str();
+}
+
+void RecordRenderGraphBarriers(CommandEncoder& encoder,
+                               std::span<const RenderGraphBarrier> barriers,
+                               std::span<const ImageView> images) {
+    std::vector<ImageBarrier> image_barriers;
+    for (auto& barrier : barriers) {
+        ImageBarrier image_barrier;
+        NICKEL_ASSERT(barrier.m_resource < images.size(),
+                      "no image of render graph resource");
+        image_barrier.m_view = images[barrier.m_resource];
+        image_barrier.m_old_layout = barrier.m_old_layout;
+        image_barrier.m_new_layout = barrier.m_new_layout;
+        image_barrier.m_dst_stage =
+            GetRenderGraphAccessStage(barrier.m_dst_access);
+        image_barrier.m_dst_access =
+            GetRenderGraphAccessMask(barrier.m_dst_access);
+        if (barrier.m_src_access) {
+            image_barrier.m_src_stage =
+                GetRenderGraphAccessStage(*barrier.m_src_access);
+            image_barrier.m_src_access =
+                GetRenderGraphAccessMask(*barrier.m_src_access);
+        } else {
+            // no content to keep, only chain to the acquire semaphore wait
+            // and to earlier frames using the same image
+            image_barrier.m_src_stage = image_barrier.m_dst_stage;
+        }
+        image_barriers.push_back(image_barrier);
+    }
+    encoder.PipelineBarrier(image_barriers);
+}
+
+}  // namespace nickel::graphics
@@ -0,0 +1,578 @@
+#include "nickel/graphics/internal/texture_codec.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/lowlevel/common.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace nickel::graphics {
+
+SVector<uint32_t, 2> TextureData::GetExtent() const {
+    return m_levels.empty() ? SVector<uint32_t, 2>{} : m_levels[0].m_extent;
+}
+
+std::span<const unsigned char> TextureData::GetLevelData(uint32_t level) const {
+    auto& info = m_levels[level];
+    return std::span{m_data}.subspan(info.m_offset, info.m_size);
+}
+
+void TextureData::AddLevel(SVector<uint32_t, 2> extent,
+                           std::span<const unsigned char> data) {
+    TextureLevel level;
+    level.m_offset = m_data.size();
+    level.m_size = data.size();
+    level.m_extent = extent;
+    m_levels.push_back(level);
+    m_data.insert(m_data.end(), data.begin(), data.end());
+}
+
+TextureData TextureData::GetLevels(uint32_t first_level) const {
+    TextureData data;
+    data.m_format = m_format;
+    for (uint32_t i = first_level; i < m_levels.size(); i++) {
+        data.AddLevel(m_levels[i].m_extent, GetLevelData(i));
+    }
+    return data;
+}
+
+FormatBlockInfo GetFormatBlockInfo(Format format) {
+    auto value = static_cast<uint32_t>(format);
+    switch (format) {
+        case Format::R8G8B8A8_UNORM:
+        case Format::R8G8B8A8_SRGB:
+        case Format::B8G8R8A8_UNORM:
+        case Format::B8G8R8A8_SRGB:
+            return {1, 1, 4};
+        default:
+            break;
+    }
+
+    // BC1 ~ BC7
+    if (value >= static_cast<uint32_t>(Format::BC1_RGB_UNORM_BLOCK) &&
+        value <= static_cast<uint32_t>(Format::BC7_SRGB_BLOCK)) {
+        bool is_8_bytes =
+            value <= static_cast<uint32_t>(Format::BC1_RGBA_SRGB_BLOCK) ||
+            format == Format::BC4_UNORM_BLOCK ||
+            format == Format::BC4_SNORM_BLOCK;
+        return {4, 4, is_8_bytes ? 8u : 16u};
+    }
+
+    // ETC2 & EAC
+    if (value >= static_cast<uint32_t>(Format::ETC2_R8G8B8_UNORM_BLOCK) &&
+        value <= static_cast<uint32_t>(Format::EAC_R11G11_SNORM_BLOCK)) {
+        bool is_16_bytes =
+            format == Format::ETC2_R8G8B8A8_UNORM_BLOCK ||
+            format == Format::ETC2_R8G8B8A8_SRGB_BLOCK ||
+            format == Format::EAC_R11G11_UNORM_BLOCK ||
+            format == Format::EAC_R11G11_SNORM_BLOCK;
+        return {4, 4, is_16_bytes ? 16u : 8u};
+    }
+
+    // ASTC LDR, every block is 16 bytes, UNORM and SRGB are adjacent
+    constexpr std::array<std::pair<uint32_t, uint32_t>, 14> astc_blocks{
+        {{4, 4},
+         {5, 4},
+         {5, 5},
+         {6, 5},
+         {6, 6},
+         {8, 5},
+         {8, 6},
+         {8, 8},
+         {10, 5},
+         {10, 6},
+         {10, 8},
+         {10, 10},
+         {12, 10},
+         {12, 12}}
+    };
+    uint32_t astc_begin = static_cast<uint32_t>(Format::ASTC_4x4_UNORM_BLOCK);
+    if (value >= astc_begin && value < astc_begin + astc_blocks.size() * 2) {
+        auto& block = astc_blocks[(value - astc_begin) / 2];
+        return {block.first, block.second, 16};
+    }
+
+    return {1, 1, 0};
+}
+
+uint64_t CalcLevelSize(Format format, uint32_t width, uint32_t height) {
+    auto info = GetFormatBlockInfo(format);
+    uint64_t block_x = (width + info.m_block_width - 1) / info.m_block_width;
+    uint64_t block_y = (height + info.m_block_height - 1) / info.m_block_height;
+    return block_x * block_y * info.m_block_size;
+}
+
+uint64_t CalcTextureSize(Format format, uint32_t width, uint32_t height,
+                         uint32_t level_count) {
+    uint64_t size = 0;
+    for (uint32_t i = 0; i < level_count; i++) {
+        size += CalcLevelSize(format, std::max(width >> i, 1u),
+                              std::max(height >> i, 1u));
+    }
+    return size;
+}
+
+uint32_t CalcMipLevelCount(uint32_t width, uint32_t height) {
+    uint32_t count = 1;
+    uint32_t size = std::max(width, height);
+    while (size > 1) {
+        size >>= 1;
+        count++;
+    }
+    return count;
+}
+
+bool IsSRGBFormat(Format format) {
+    switch (format) {
+        case Format::R8G8B8A8_SRGB:
+        case Format::B8G8R8A8_SRGB:
+        case Format::BC1_RGB_SRGB_BLOCK:
+        case Format::BC1_RGBA_SRGB_BLOCK:
+        case Format::BC2_SRGB_BLOCK:
+        case Format::BC3_SRGB_BLOCK:
+        case Format::BC7_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8A1_SRGB_BLOCK:
+        case Format::ETC2_R8G8B8A8_SRGB_BLOCK:
+            return true;
+        default:
+            break;
+    }
+    auto value = static_cast<uint32_t>(format);
+    uint32_t astc_begin = static_cast<uint32_t>(Format::ASTC_4x4_UNORM_BLOCK);
+    uint32_t astc_end = static_cast<uint32_t>(Format::ASTC_12x12_SRGB_BLOCK);
+    return value >= astc_begin && value <= astc_end &&
+           (value - astc_begin) % 2 == 1;
+}
+
+namespace {
+
+struct SRGBTable {
+    std::array<float, 256> m_to_linear;
+
+    SRGBTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            m_to_linear[i] = c <= 0.04045f
+                                 ? c / 12.92f
+                                 : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+    }
+
+    static unsigned char ToSRGB(float linear) {
+        float c = linear <= 0.0031308f
+                      ? linear * 12.92f
+                      : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+        return static_cast<unsigned char>(
+            std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+};
+
+const SRGBTable& GetSRGBTable() {
+    static SRGBTable table;
+    return table;
+}
+
+}  // namespace
+
+TextureData GenerateMipChain(const unsigned char* rgba, uint32_t width,
+                             uint32_t height, bool srgb) {
+    TextureData texture;
+    texture.m_format = srgb ? Format::R8G8B8A8_SRGB : Format::R8G8B8A8_UNORM;
+    texture.m_data.reserve(CalcTextureSize(texture.m_format, width, height,
+                                           CalcMipLevelCount(width, height)));
+    texture.AddLevel({width, height}, std::span{rgba, width * height * 4ull});
+
+    auto& table = GetSRGBTable();
+    std::vector<unsigned char> prev{rgba, rgba + width * height * 4ull};
+    std::vector<unsigned char> next;
+    while (width > 1 || height > 1) {
+        uint32_t new_width = std::max(width / 2, 1u);
+        uint32_t new_height = std::max(height / 2, 1u);
+        next.resize(new_width * new_height * 4ull);
+        for (uint32_t y = 0; y < new_height; y++) {
+            for (uint32_t x = 0; x < new_width; x++) {
+                // odd source size: the last row/column is reused
+                uint32_t x0 = std::min(x * 2, width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, width - 1);
+                uint32_t y0 = std::min(y * 2, height - 1);
+                uint32_t y1 = std::min(y * 2 + 1, height - 1);
+                const unsigned char* texels[4] = {
+                    &prev[(y0 * width + x0) * 4], &prev[(y0 * width + x1) * 4],
+                    &prev[(y1 * width + x0) * 4], &prev[(y1 * width + x1) * 4]};
+                unsigned char* dst = &next[(y * new_width + x) * 4];
+                for (uint32_t c = 0; c < 4; c++) {
+                    if (srgb && c < 3) {
+                        float sum = 0;
+                        for (auto texel : texels) {
+                            sum += table.m_to_linear[texel[c]];
+                        }
+                        dst[c] = SRGBTable::ToSRGB(sum * 0.25f);
+                    } else {
+                        uint32_t sum = 0;
+                        for (auto texel : texels) {
+                            sum += texel[c];
+                        }
+                        dst[c] = static_cast<unsigned char>((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+        width = new_width;
+        height = new_height;
+        texture.AddLevel({width, height}, next);
+        prev.swap(next);
+    }
+    return texture;
+}
+
+namespace {
+
+uint16_t PackRGB565(const float* color) {
+    auto r = static_cast<uint16_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f /
+                                       255.0f +
+                                   0.5f);
+    auto g = static_cast<uint16_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f /
+                                       255.0f +
+                                   0.5f);
+    auto b = static_cast<uint16_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f /
+                                       255.0f +
+                                   0.5f);
+    return (r << 11) | (g << 5) | b;
+}
+
+void UnpackRGB565(uint16_t color, unsigned char* out) {
+    uint32_t r = (color >> 11) & 0x1F;
+    uint32_t g = (color >> 5) & 0x3F;
+    uint32_t b = color & 0x1F;
+    out[0] = static_cast<unsigned char>((r << 3) | (r >> 2));
+    out[1] = static_cast<unsigned char>((g << 2) | (g >> 4));
+    out[2] = static_cast<unsigned char>((b << 3) | (b >> 2));
+}
+
+void Write16(unsigned char* dst, uint16_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+}
+
+uint16_t Read16(const unsigned char* src) {
+    return src[0] | (src[1] << 8);
+}
+
+// BC1 color part in 4 color mode, endpoints from the principal axis of the
+// block colors
+void CompressColorBlock(const unsigned char* texels, unsigned char* out) {
+    float mean[3]{};
+    for (uint32_t i = 0; i < 16; i++) {
+        for (uint32_t c = 0; c < 3; c++) {
+            mean[c] += texels[i * 4 + c];
+        }
+    }
+    for (auto& m : mean) {
+        m /= 16.0f;
+    }
+
+    float cov[6]{};  // xx xy xz yy yz zz
+    for (uint32_t i = 0; i < 16; i++) {
+        float d[3];
+        for (uint32_t c = 0; c < 3; c++) {
+            d[c] = texels[i * 4 + c] - mean[c];
+        }
+        cov[0] += d[0] * d[0];
+        cov[1] += d[0] * d[1];
+        cov[2] += d[0] * d[2];
+        cov[3] += d[1] * d[1];
+        cov[4] += d[1] * d[2];
+        cov[5] += d[2] * d[2];
+    }
+
+    float axis[3] = {1, 1, 1};
+    for (uint32_t iter = 0; iter < 8; iter++) {
+        float next[3] = {
+            cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+            cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+            cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]};
+        float len = std::sqrt(next[0] * next[0] + next[1] * next[1] +
+                              next[2] * next[2]);
+        if (len < 1e-6f) {
+            break;
+        }
+        for (uint32_t c = 0; c < 3; c++) {
+            axis[c] = next[c] / len;
+        }
+    }
+
+    float min_proj = std::numeric_limits<float>::max();
+    float max_proj = std::numeric_limits<float>::lowest();
+    for (uint32_t i = 0; i < 16; i++) {
+        float proj = 0;
+        for (uint32_t c = 0; c < 3; c++) {
+            proj += (texels[i * 4 + c] - mean[c]) * axis[c];
+        }
+        min_proj = std::min(min_proj, proj);
+        max_proj = std::max(max_proj, proj);
+    }
+
+    float max_color[3], min_color[3];
+    for (uint32_t c = 0; c < 3; c++) {
+        max_color[c] = mean[c] + axis[c] * max_proj;
+        min_color[c] = mean[c] + axis[c] * min_proj;
+    }
+    uint16_t c0 = PackRGB565(max_color);
+    uint16_t c1 = PackRGB565(min_color);
+
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        if (c0 < c1) {
+            std::swap(c0, c1);
+        }
+        unsigned char palette[4][3];
+        UnpackRGB565(c0, palette[0]);
+        UnpackRGB565(c1, palette[1]);
+        for (uint32_t c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t best = 0;
+            int best_dist = std::numeric_limits<int>::max();
+            for (uint32_t p = 0; p < 4; p++) {
+                int dist = 0;
+                for (uint32_t c = 0; c < 3; c++) {
+                    int d = texels[i * 4 + c] - palette[p][c];
+                    dist += d * d;
+                }
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    Write16(out, c0);
+    Write16(out + 2, c1);
+    for (uint32_t i = 0; i < 4; i++) {
+        out[4 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+}
+
+void DecompressColorBlock(const unsigned char* block,
+                          unsigned char* out_texels, bool allow_3_colors) {
+    uint16_t c0 = Read16(block);
+    uint16_t c1 = Read16(block + 2);
+    unsigned char palette[4][4];
+    UnpackRGB565(c0, palette[0]);
+    UnpackRGB565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    if (c0 > c1 || !allow_3_colors) {
+        for (uint32_t c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+    } else {
+        for (uint32_t c = 0; c < 3; c++) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        palette[3][3] = 0;
+    }
+
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) |
+                       (uint32_t(block[7]) << 24);
+    for (uint32_t i = 0; i < 16; i++) {
+        memcpy(out_texels + i * 4, palette[(indices >> (i * 2)) & 0x3], 4);
+    }
+}
+
+}  // namespace
+
+void CompressBC1Block(const unsigned char* texels, unsigned char* out) {
+    CompressColorBlock(texels, out);
+}
+
+void CompressBC3Block(const unsigned char* texels, unsigned char* out) {
+    unsigned char a0 = 0, a1 = 255;
+    for (uint32_t i = 0; i < 16; i++) {
+        a0 = std::max(a0, texels[i * 4 + 3]);
+        a1 = std::min(a1, texels[i * 4 + 3]);
+    }
+
+    uint64_t indices = 0;
+    if (a0 != a1) {
+        // 8 alpha mode: a0 > a1, index 0/1 are endpoints, 2~7 interpolated
+        unsigned char palette[8];
+        palette[0] = a0;
+        palette[1] = a1;
+        for (uint32_t i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+        }
+        for (uint32_t i = 0; i < 16; i++) {
+            uint64_t best = 0;
+            int best_dist = 256;
+            for (uint32_t p = 0; p < 8; p++) {
+                int dist = std::abs(texels[i * 4 + 3] - palette[p]);
+                if (dist < best_dist) {
+                    best_dist = dist;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 3);
+        }
+    }
+
+    out[0] = a0;
+    out[1] = a1;
+    for (uint32_t i = 0; i < 6; i++) {
+        out[2 + i] = (indices >> (i * 8)) & 0xFF;
+    }
+    CompressColorBlock(texels, out + 8);
+}
+
+void DecompressBC1Block(const unsigned char* block, unsigned char* out_texels) {
+    DecompressColorBlock(block, out_texels, true);
+}
+
+void DecompressBC3Block(const unsigned char* block, unsigned char* out_texels) {
+    DecompressColorBlock(block + 8, out_texels, false);
+
+    unsigned char palette[8];
+    palette[0] = block[0];
+    palette[1] = block[1];
+    if (palette[0] > palette[1]) {
+        for (uint32_t i = 2; i < 8; i++) {
+            palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1] + 3) / 7;
+        }
+    } else {
+        for (uint32_t i = 2; i < 6; i++) {
+            palette[i] = ((6 - i) * palette[0] + (i - 1) * palette[1] + 2) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64_t indices = 0;
+    for (uint32_t i = 0; i < 6; i++) {
+        indices |= uint64_t(block[2 + i]) << (i * 8);
+    }
+    for (uint32_t i = 0; i < 16; i++) {
+        out_texels[i * 4 + 3] = palette[(indices >> (i * 3)) & 0x7];
+    }
+}
+
+TextureData CompressTexture(const TextureData& texture, Format format) {
+    bool is_bc3 =
+        format == Format::BC3_UNORM_BLOCK || format == Format::BC3_SRGB_BLOCK;
+    uint32_t block_size = is_bc3 ? 16 : 8;
+
+    TextureData result;
+    result.m_format = format;
+    std::vector<unsigned char> blocks;
+    for (uint32_t level = 0; level < texture.m_levels.size(); level++) {
+        auto extent = texture.m_levels[level].m_extent;
+        auto src = texture.GetLevelData(level);
+        uint32_t block_x = (extent.w + 3) / 4;
+        uint32_t block_y = (extent.h + 3) / 4;
+        blocks.resize(block_x * block_y * block_size);
+
+        unsigned char texels[16 * 4];
+        for (uint32_t by = 0; by < block_y; by++) {
+            for (uint32_t bx = 0; bx < block_x; bx++) {
+                // clamp to edge for levels smaller than a block
+                for (uint32_t i = 0; i < 16; i++) {
+                    uint32_t x = std::min(bx * 4 + i % 4, extent.w - 1);
+                    uint32_t y = std::min(by * 4 + i / 4, extent.h - 1);
+                    memcpy(texels + i * 4, &src[(y * extent.w + x) * 4], 4);
+                }
+                unsigned char* out =
+                    &blocks[(by * block_x + bx) * block_size];
+                if (is_bc3) {
+                    CompressBC3Block(texels, out);
+                } else {
+                    CompressBC1Block(texels, out);
+                }
+            }
+        }
+        result.AddLevel(extent, blocks);
+    }
+    return result;
+}
+
+TextureData DecompressTexture(const TextureData& texture) {
+    auto format = texture.m_format;
+    bool is_bc3 =
+        format == Format::BC3_UNORM_BLOCK || format == Format::BC3_SRGB_BLOCK;
+    bool is_bc1 = format >= Format::BC1_RGB_UNORM_BLOCK &&
+                  format <= Format::BC1_RGBA_SRGB_BLOCK;
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        {}, is_bc1 || is_bc3, "can't decompress texture format {} on CPU",
+        static_cast<uint32_t>(format));
+    uint32_t block_size = is_bc3 ? 16 : 8;
+
+    TextureData result;
+    result.m_format = IsSRGBFormat(format) ? Format::R8G8B8A8_SRGB
+                                           : Format::R8G8B8A8_UNORM;
+    std::vector<unsigned char> pixels;
+    for (uint32_t level = 0; level < texture.m_levels.size(); level++) {
+        auto extent = texture.m_levels[level].m_extent;
+        auto src = texture.GetLevelData(level);
+        uint32_t block_x = (extent.w + 3) / 4;
+        uint32_t block_y = (extent.h + 3) / 4;
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            {}, src.size() >= block_x * block_y * block_size,
+            "texture level {} data is too small", level);
+        pixels.resize(extent.w * extent.h * 4ull);
+
+        unsigned char texels[16 * 4];
+        for (uint32_t by = 0; by < block_y; by++) {
+            for (uint32_t bx = 0; bx < block_x; bx++) {
+                const unsigned char* block =
+                    &src[(by * block_x + bx) * block_size];
+                if (is_bc3) {
+                    DecompressBC3Block(block, texels);
+                } else {
+                    DecompressBC1Block(block, texels);
+                }
+                for (uint32_t i = 0; i < 16; i++) {
+                    uint32_t x = bx * 4 + i % 4;
+                    uint32_t y = by * 4 + i / 4;
+                    if (x < extent.w && y < extent.h) {
+                        memcpy(&pixels[(y * extent.w + x) * 4], texels + i * 4,
+                               4);
+                    }
+                }
+            }
+        }
+        result.AddLevel(extent, pixels);
+    }
+    return result;
+}
+
+TextureData CookTexture(const ImageRawData& image, bool is_color) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, image, "can't cook invalid image");
+
+    auto extent = image.GetExtent();
+    auto rgba = static_cast<const unsigned char*>(image.GetData());
+    bool has_alpha = false;
+    for (uint64_t i = 0; i < extent.w * extent.h; i++) {
+        if (rgba[i * 4 + 3] != 255) {
+            has_alpha = true;
+            break;
+        }
+    }
+
+    auto mips = GenerateMipChain(rgba, extent.w, extent.h, is_color);
+    Format format;
+    if (has_alpha) {
+        format = is_color ? Format::BC3_SRGB_BLOCK : Format::BC3_UNORM_BLOCK;
+    } else {
+        format =
+            is_color ? Format::BC1_RGB_SRGB_BLOCK : Format::BC1_RGB_UNORM_BLOCK;
+    }
+    return CompressTexture(mips, format);
+}
+
+}  // namespace nickel::graphics
@@ -1,53 +1,94 @@
 ﻿#include "nickel/graphics/internal/texture_impl.hpp"
 
+#include "nickel/common/common.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/fs/mapped_file.hpp"
+#include "nickel/graphics/internal/ktx2.hpp"
 #include "nickel/graphics/internal/texture_manager_impl.hpp"
 #include "nickel/graphics/lowlevel/common.hpp"
 #include "nickel/graphics/lowlevel/internal/image_impl.hpp"
 
 namespace nickel::graphics {
+
+static TextureData generateTextureData(const ImageRawData& raw_data,
+                                       Format format) {
+    if (!raw_data) {
+        return {};
+    }
+
+    auto extent = raw_data.GetExtent();
+    auto data = GenerateMipChain(
+        static_cast<const unsigned char*>(raw_data.GetData()), extent.w,
+        extent.h, IsSRGBFormat(format));
+    data.m_format = format;
+    return data;
+}
+
+TextureImpl::TextureImpl(TextureManagerImpl* mgr, Device device,
+                         const ImageRawData& raw_data, Format format)
+    : TextureImpl{mgr, device, generateTextureData(raw_data, format)} {}
+
 TextureImpl::TextureImpl(TextureManagerImpl* mgr, Device device,
-                         const Path& filename, Format format)
+                         const TextureData& data, uint32_t first_level)
     : m_mgr{mgr} {
-    ImageRawData raw_data{filename};
-    if (!raw_data) {
+    if (!data) {
         return;
     }
 
+    m_extent = data.GetExtent();
+    m_level_count = data.m_levels.size();
+    UploadLevels(device,
+                 first_level == 0 ? data : data.GetLevels(first_level),
+                 first_level);
+}
+
+void TextureImpl::UploadLevels(Device device, const TextureData& levels,
+                               uint32_t first_level) {
+    auto extent = levels.GetExtent();
+    uint32_t level_count = levels.m_levels.size();
     {
         Image::Descriptor desc;
         desc.m_image_type = ImageType::Dim2;
-        desc.m_extent.w = raw_data.GetExtent().w;
-        desc.m_extent.h = raw_data.GetExtent().h;
+        desc.m_extent.w = extent.w;
+        desc.m_extent.h = extent.h;
         desc.m_extent.l = 1;
-        desc.m_format = format;
+        desc.m_format = levels.m_format;
+        desc.m_mip_levels = level_count;
+        desc.m_tiling = ImageTiling::Optimal;
         desc.m_usage = Flags{ImageUsage::CopyDst} | ImageUsage::Sampled;
+        // old image & view stay alive until frames in flight sampling them
+        // finish, device defers their release
         m_image = device.CreateImage(desc);
     }
 
-    // m_buffer data to image
+    // m_buffer data to image, all levels share one staging buffer
     // TODO: optimize this: don't create m_buffer per image
     {
         Buffer::Descriptor desc;
         desc.m_memory_type = MemoryType::CPULocal;
-        desc.m_size = 4 * raw_data.GetExtent().w * raw_data.GetExtent().h;
+        desc.m_size = levels.m_data.size();
         desc.m_usage = BufferUsage::CopySrc;
         Buffer buffer = device.CreateBuffer(desc);
         buffer.MapAsync();
-        void* data = buffer.GetMappedRange();
-        memcpy(data, raw_data.GetData(), desc.m_size);
+        void* mapped = buffer.GetMappedRange();
+        memcpy(mapped, levels.m_data.data(), desc.m_size);
         buffer.Unmap();
 
         CommandEncoder encoder = device.CreateCommandEncoder();
         CopyEncoder copy = encoder.BeginCopy();
-        CopyEncoder::BufferImageCopy copy_info;
-        copy_info.m_buffer_offset = 0;
-        copy_info.m_image_extent.w = raw_data.GetExtent().w;
-        copy_info.m_image_extent.h = raw_data.GetExtent().h;
-        copy_info.m_image_extent.l = 1;
-        copy_info.m_buffer_image_height = 0;
-        copy_info.m_buffer_row_length = 0;
-        copy_info.m_image_subresource.m_aspect_mask = ImageAspect::Color;
-        copy.CopyBufferToTexture(buffer, m_image, copy_info);
+        for (uint32_t i = 0; i < level_count; i++) {
+            auto& level = levels.m_levels[i];
+            CopyEncoder::BufferImageCopy copy_info;
+            copy_info.m_buffer_offset = level.m_offset;
+            copy_info.m_image_extent.w = level.m_extent.w;
+            copy_info.m_image_extent.h = level.m_extent.h;
+            copy_info.m_image_extent.l = 1;
+            copy_info.m_buffer_image_height = 0;
+            copy_info.m_buffer_row_length = 0;
+            copy_info.m_image_subresource.m_aspect_mask = ImageAspect::Color;
+            copy_info.m_image_subresource.m_base_mip_level = i;
+            copy.CopyBufferToTexture(buffer, m_image, copy_info);
+        }
         copy.End();
         Command cmd = encoder.Finish();
         device.Submit(cmd, {}, {}, {});
@@ -57,17 +98,29 @@ TextureImpl::TextureImpl(TextureManagerImpl* mgr, Device device,
     // create m_view
     {
         ImageView::Descriptor view_desc;
-        view_desc.m_format = format;
+        view_desc.m_format = levels.m_format;
         view_desc.m_components = ComponentMapping::SwizzleIdentity;
         view_desc.m_subresource_range.m_aspect_mask = ImageAspect::Color;
+        view_desc.m_subresource_range.m_level_count = level_count;
         view_desc.m_view_type = ImageViewType::Dim2;
         m_view = m_image.CreateView(view_desc);
     }
+
+    m_resident_level = first_level;
+    m_vram_size = levels.m_data.size();
+    m_generation++;
 }
 
 SVector<uint32_t, 2> TextureImpl::Extent() const {
-    auto extent = m_image.Extent();
-    return {extent.w, extent.h};
+    return m_extent;
+}
+
+void TextureImpl::RequestStreamLevel(float screen_size) {
+    if (m_stream_id != TextureStreamer::InvalidID) {
+        m_mgr->RequestStreamLevel(
+            m_stream_id,
+            CalcDesiredMipLevel(m_extent, screen_size, m_level_count));
+    }
 }
 
 void TextureImpl::DecRefcount() {
@@ -77,4 +130,77 @@ void TextureImpl::DecRefcount() {
         m_mgr->RemoveTexture(this);
     }
 }
+
+static bool isFormatSupported(Format format,
+                              const Adapter::Features& features) {
+    auto value = static_cast<uint32_t>(format);
+    if (value >= static_cast<uint32_t>(Format::BC1_RGB_UNORM_BLOCK) &&
+        value <= static_cast<uint32_t>(Format::BC7_SRGB_BLOCK)) {
+        return features.texture_compression_bc;
+    }
+    if (value >= static_cast<uint32_t>(Format::ETC2_R8G8B8_UNORM_BLOCK) &&
+        value <= static_cast<uint32_t>(Format::EAC_R11G11_SNORM_BLOCK)) {
+        return features.texture_compression_etc2;
+    }
+    if (value >= static_cast<uint32_t>(Format::ASTC_4x4_UNORM_BLOCK) &&
+        value <= static_cast<uint32_t>(Format::ASTC_12x12_SRGB_BLOCK)) {
+        return features.texture_compression_astc_ldr;
+    }
+    return true;
+}
+
+static TextureData loadKTX2(const Path& filename,
+                            const Adapter::Features& features) {
+    MappedFile file{filename};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, file, "can't open {}", filename);
+    KTX2View view{file.GetData()};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE({}, view.IsValid(), "invalid ktx2 file {}",
+                                      filename);
+
+    auto data = view.ToTextureData();
+    if (!isFormatSupported(data.m_format, features)) {
+        LOGW("device can't sample format {} of {}, decompress on CPU",
+             static_cast<uint32_t>(data.m_format), filename);
+        data = DecompressTexture(data);
+    }
+    return data;
+}
+
+TextureData LoadTextureData(const Path& filename, Format format,
+                            const Adapter::Features& features) {
+    if (filename.Extension() == Path{KTX2Extension}) {
+        return loadKTX2(filename, features);
+    }
+
+    // prefer the cooked texture next to the image, see `gltf_cooker`
+    Path cooked_filename = filename;
+    cooked_filename.ReplaceExtension(Path{KTX2Extension});
+    if (std::filesystem::exists(cooked_filename.GetUnderlyingPath())) {
+        if (auto data = loadKTX2(cooked_filename, features)) {
+            return data;
+        }
+    }
+
+    return generateTextureData(ImageRawData{filename}, format);
+}
+
+std::optional<TextureContentKey> ComputeTextureContentKey(const Path& filename,
+                                                          Format format) {
+    TextureContentKey key;
+    key.m_format = format;
+    if (MappedFile file{filename}) {
+        key.m_hash = HashBytes(file.GetData());
+        return key;
+    }
+
+    auto content = ReadWholeFile(filename);
+    if (content.empty()) {
+        return std::nullopt;
+    }
+    key.m_hash = HashBytes(std::span{
+        reinterpret_cast<const unsigned char*>(content.data()),
+        content.size()});
+    return key;
+}
+
 }  // namespace nickel::graphics
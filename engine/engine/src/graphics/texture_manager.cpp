@@ -4,8 +4,8 @@
 
 namespace nickel::graphics {
 
-TextureManager::TextureManager()
-    : m_impl{std::make_unique<TextureManagerImpl>()} {}
+TextureManager::TextureManager(const TextureStreamingConfig& config)
+    : m_impl{std::make_unique<TextureManagerImpl>(config)} {}
 
 TextureManager::~TextureManager() {}
 
@@ -13,10 +13,35 @@ Texture TextureManager::Load(const Path& filename, Format format) {
     return m_impl->Load(filename, format);
 }
 
+AsyncHandle<Texture> TextureManager::LoadAsync(const Path& filename,
+                                               Format format) {
+    return m_impl->LoadAsync(filename, format);
+}
+
 Texture TextureManager::Find(const Path& filename) {
     return m_impl->Find(filename);
 }
 
+void TextureManager::Update() {
+    m_impl->Update();
+}
+
+bool TextureManager::HasPendingLoad() const {
+    return m_impl->HasPendingLoad();
+}
+
+uint64_t TextureManager::GetVRAMUsage() const {
+    return m_impl->GetVRAMUsage();
+}
+
+uint64_t TextureManager::GetStreamingUsage() const {
+    return m_impl->GetStreamingUsage();
+}
+
+uint32_t TextureManager::GetDeduplicatedCount() const {
+    return m_impl->GetDeduplicatedCount();
+}
+
 void TextureManager::GC() {
     m_impl->GC();
 }
@@ -1,43 +1,236 @@
 ﻿#include "nickel/graphics/internal/texture_manager_impl.hpp"
+#include "nickel/common/macro.hpp"
 #include "nickel/nickel.hpp"
 
 namespace nickel::graphics {
+
+TextureManagerImpl::TextureManagerImpl(const TextureStreamingConfig& config)
+    : m_streamer{config} {}
+
+TextureImpl* TextureManagerImpl::createTexture(const Path& filename,
+                                               Format format,
+                                               const TextureData& data) {
+    auto device = nickel::Context::GetInst().GetGPUAdapter().GetDevice();
+    if (!m_streamer.GetConfig().m_enable || data.m_levels.size() <= 1) {
+        return m_allocator.Allocate(this, device, data);
+    }
+
+    // only the mip tail is uploaded, detailed levels are streamed in on demand
+    auto id = m_streamer.Register(data.m_format, data.GetExtent(),
+                                  data.m_levels.size());
+    uint32_t tail = m_streamer.GetTailLevel(id);
+    TextureImpl* texture = m_allocator.Allocate(this, device, data, tail);
+    texture->m_stream_id = id;
+    texture->m_mip_tail = data.GetLevels(tail);
+    m_streaming_textures.emplace(id,
+                                 StreamingTexture{texture, filename, format});
+    return texture;
+}
+
+void TextureManagerImpl::registerTexture(
+    const Path& filename, const std::optional<TextureContentKey>& key,
+    TextureImpl* texture) {
+    texture->m_filenames.push_back(filename);
+    texture->m_content_key = key;
+    m_textures.emplace(filename, texture);
+    if (key) {
+        m_content_textures.emplace(*key, texture);
+    }
+}
+
+Texture TextureManagerImpl::findByContent(
+    const Path& filename, const std::optional<TextureContentKey>& key) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW({}, key, "can't hash {}, not shared",
+                                      filename);
+    auto it = m_content_textures.find(*key);
+    if (it == m_content_textures.end()) {
+        return {};
+    }
+
+    TextureImpl* texture = it->second;
+    texture->m_filenames.push_back(filename);
+    m_textures.emplace(filename, texture);
+    m_deduplicated_count++;
+    texture->IncRefcount();
+    return texture;
+}
+
 Texture TextureManagerImpl::Load(const Path& filename, Format format) {
     if (auto it = m_textures.find(filename); it != m_textures.end()) {
         LOGE("texture {} already loaded", filename);
         return {};
     }
 
-    auto result = m_textures.emplace(
-        filename,
-        m_allocator.Allocate(
-            this, nickel::Context::GetInst().GetGPUAdapter().GetDevice(),
-            filename, format));
-    if (!result.second) {
-        LOGE("texture emplace construct failed");
-        return {};
+    auto key = ComputeTextureContentKey(filename, format);
+    if (auto texture = findByContent(filename, key)) {
+        return texture;
     }
 
-    return result.first->second;
+    auto& adapter = nickel::Context::GetInst().GetGPUAdapter();
+    TextureImpl* texture = createTexture(
+        filename, format,
+        LoadTextureData(filename, format, adapter.GetFeatures()));
+    registerTexture(filename, key, texture);
+    return texture;
+}
+
+AsyncHandle<Texture> TextureManagerImpl::LoadAsync(const Path& filename,
+                                                   Format format) {
+    if (auto texture = Find(filename)) {
+        return AsyncHandle<Texture>::CreateReady(texture);
+    }
+    if (auto it = m_pending.find(filename); it != m_pending.end()) {
+        return it->second.m_handle;
+    }
+
+    PendingTexture pending;
+    pending.m_handle = AsyncHandle<Texture>::CreatePending();
+    pending.m_format = format;
+    pending.m_data = nickel::Context::GetInst().GetThreadPool().Submit(
+        [filename, format,
+         features = nickel::Context::GetInst().GetGPUAdapter().GetFeatures()] {
+            return DecodedTexture{
+                ComputeTextureContentKey(filename, format),
+                LoadTextureData(filename, format, features)};
+        });
+    auto handle = pending.m_handle;
+    m_pending.emplace(filename, std::move(pending));
+    return handle;
 }
 
 Texture TextureManagerImpl::Find(const Path& filename) {
     if (auto it = m_textures.find(filename); it != m_textures.end()) {
+        // `Texture` adopts one reference, the map doesn't own any
+        it->second->IncRefcount();
         return it->second;
     }
     return {};
 }
 
+void TextureManagerImpl::Update() {
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        auto& pending = it->second;
+        if (pending.m_data.wait_for(std::chrono::seconds{0}) !=
+            std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        DecodedTexture decoded = pending.m_data.get();
+        if (!decoded.m_data) {
+            pending.m_handle.Fail();
+        } else if (auto loaded = Find(it->first)) {
+            // loaded synchronously while decoding
+            pending.m_handle.Resolve(loaded);
+        } else if (auto shared = findByContent(it->first, decoded.m_key)) {
+            pending.m_handle.Resolve(shared);
+        } else {
+            TextureImpl* texture =
+                createTexture(it->first, pending.m_format, decoded.m_data);
+            registerTexture(it->first, decoded.m_key, texture);
+            pending.m_handle.Resolve(Texture{texture});
+        }
+        it = m_pending.erase(it);
+    }
+
+    if (m_streamer.GetConfig().m_enable) {
+        updateStreaming();
+    }
+}
+
+void TextureManagerImpl::updateStreaming() {
+    auto& adapter = nickel::Context::GetInst().GetGPUAdapter();
+    auto device = adapter.GetDevice();
+
+    for (auto it = m_stream_ins.begin(); it != m_stream_ins.end();) {
+        if (it->m_data.wait_for(std::chrono::seconds{0}) !=
+            std::future_status::ready) {
+            ++it;
+            continue;
+        }
+
+        TextureData data = it->m_data.get();
+        auto streaming = m_streaming_textures.find(it->m_id);
+        if (streaming == m_streaming_textures.end()) {
+            // texture released while reading
+        } else if (!data ||
+                   data.m_format != streaming->second.m_texture->m_mip_tail
+                                        .m_format ||
+                   data.m_levels.size() !=
+                       streaming->second.m_texture->GetLevelCount()) {
+            LOGW("stream in {} failed, keep resident levels",
+                 streaming->second.m_filename);
+            m_streamer.CancelStreamIn(it->m_id);
+        } else {
+            streaming->second.m_texture->UploadLevels(
+                device, data.GetLevels(it->m_level), it->m_level);
+            m_streamer.FinishStreamIn(it->m_id);
+        }
+        it = m_stream_ins.erase(it);
+    }
+
+    for (auto& action : m_streamer.Update()) {
+        auto& streaming = m_streaming_textures.at(action.m_id);
+        TextureImpl* texture = streaming.m_texture;
+        if (action.m_type == TextureStreamer::Action::Type::Evict) {
+            texture->UploadLevels(device, texture->m_mip_tail, action.m_level);
+            continue;
+        }
+
+        PendingStreamIn stream_in;
+        stream_in.m_id = action.m_id;
+        stream_in.m_level = action.m_level;
+        stream_in.m_data = nickel::Context::GetInst().GetThreadPool().Submit(
+            [filename = streaming.m_filename, format = streaming.m_format,
+             features = adapter.GetFeatures()] {
+                return LoadTextureData(filename, format, features);
+            });
+        m_stream_ins.push_back(std::move(stream_in));
+    }
+}
+
+void TextureManagerImpl::RequestStreamLevel(TextureStreamer::ID id,
+                                            uint32_t level) {
+    m_streamer.RequestLevel(id, level);
+}
+
+uint64_t TextureManagerImpl::GetStreamingUsage() const {
+    return m_streamer.GetUsedSize();
+}
+
+bool TextureManagerImpl::HasPendingLoad() const {
+    return !m_pending.empty();
+}
+
+uint64_t TextureManagerImpl::GetVRAMUsage() const {
+    uint64_t size = 0;
+    for (auto& [filename, texture] : m_textures) {
+        // count shared textures once
+        if (texture->m_filenames.front() == filename) {
+            size += texture->GetVRAMSize();
+        }
+    }
+    return size;
+}
+
+uint32_t TextureManagerImpl::GetDeduplicatedCount() const {
+    return m_deduplicated_count;
+}
+
 void TextureManagerImpl::GC() {
     m_allocator.GC();
 }
 
 void TextureManagerImpl::RemoveTexture(TextureImpl* texture) {
-    for (auto it = m_textures.begin(); it != m_textures.end(); ++it) {
-        if (it->second == texture) {
-            m_textures.erase(it);
-            return;
-        }
+    if (texture->m_stream_id != TextureStreamer::InvalidID) {
+        m_streamer.Unregister(texture->m_stream_id);
+        m_streaming_textures.erase(texture->m_stream_id);
+    }
+    for (auto& filename : texture->m_filenames) {
+        m_textures.erase(filename);
+    }
+    if (texture->m_content_key) {
+        m_content_textures.erase(*texture->m_content_key);
     }
 }
 
@@ -0,0 +1,233 @@
+#include "nickel/graphics/internal/texture_streamer.hpp"
+#include "nickel/common/log.hpp"
+#include "nickel/graphics/internal/texture_codec.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nickel::graphics {
+
+uint32_t CalcDesiredMipLevel(SVector<uint32_t, 2> extent, float screen_size,
+                             uint32_t level_count) {
+    if (level_count == 0) {
+        return 0;
+    }
+    float ratio = std::max(extent.w, extent.h) / std::max(screen_size, 1.0f);
+    uint32_t level =
+        ratio <= 1.0f ? 0 : static_cast<uint32_t>(std::floor(std::log2(ratio)));
+    return std::min(level, level_count - 1);
+}
+
+TextureStreamer::TextureStreamer(const Config& config) : m_config{config} {}
+
+void TextureStreamer::SetConfig(const Config& config) {
+    m_config = config;
+}
+
+const TextureStreamer::Config& TextureStreamer::GetConfig() const noexcept {
+    return m_config;
+}
+
+uint64_t TextureStreamer::levelsSize(const Entry& entry,
+                                     uint32_t first_level) const {
+    return CalcTextureSize(entry.m_format,
+                           std::max(entry.m_extent.w >> first_level, 1u),
+                           std::max(entry.m_extent.h >> first_level, 1u),
+                           entry.m_level_count - first_level);
+}
+
+TextureStreamer::ID TextureStreamer::Register(Format format,
+                                              SVector<uint32_t, 2> extent,
+                                              uint32_t level_count) {
+    Entry entry;
+    entry.m_format = format;
+    entry.m_extent = extent;
+    entry.m_level_count = std::max(level_count, 1u);
+    while (entry.m_tail_level + 1 < entry.m_level_count &&
+           std::max(extent.w >> entry.m_tail_level,
+                    extent.h >> entry.m_tail_level) > m_config.m_mip_tail_size) {
+        entry.m_tail_level++;
+    }
+    entry.m_resident_level = entry.m_tail_level;
+    entry.m_desired_level = entry.m_tail_level;
+
+    m_used_size += levelsSize(entry, entry.m_tail_level);
+    if (m_used_size > m_config.m_budget) {
+        LOGW("mip tails of streaming textures exceed budget: {} > {}",
+             m_used_size, m_config.m_budget);
+    }
+
+    ID id = m_next_id++;
+    m_entries.emplace(id, entry);
+    return id;
+}
+
+void TextureStreamer::Unregister(ID id) {
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+        return;
+    }
+    auto& entry = it->second;
+    m_used_size -= levelsSize(entry, entry.m_pending ? entry.m_pending_level
+                                                     : entry.m_resident_level);
+    m_entries.erase(it);
+}
+
+uint32_t TextureStreamer::GetTailLevel(ID id) const {
+    return m_entries.at(id).m_tail_level;
+}
+
+uint32_t TextureStreamer::GetResidentLevel(ID id) const {
+    return m_entries.at(id).m_resident_level;
+}
+
+uint64_t TextureStreamer::GetLevelsSize(ID id, uint32_t first_level) const {
+    return levelsSize(m_entries.at(id), first_level);
+}
+
+void TextureStreamer::RequestLevel(ID id, uint32_t level) {
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+        return;
+    }
+    auto& entry = it->second;
+    level = std::min(level, entry.m_tail_level);
+    if (entry.m_last_request_frame != m_frame) {
+        entry.m_desired_level = level;
+        entry.m_last_request_frame = m_frame;
+    } else {
+        entry.m_desired_level = std::min(entry.m_desired_level, level);
+    }
+}
+
+bool TextureStreamer::makeRoom(uint64_t size, ID requester,
+                               std::vector<Action>& actions) {
+    if (m_used_size + size <= m_config.m_budget) {
+        return true;
+    }
+
+    struct Victim {
+        bool m_in_use;
+        uint64_t m_last_request_frame;
+        ID m_id;
+        uint32_t m_level;
+        uint64_t m_freed;
+    };
+
+    // textures unused this frame go back to the tail first (LRU order), then
+    // textures in use but more detailed than they need. Only the tail is kept
+    // on CPU, so eviction always drops to the tail and the texture may
+    // stream in its desired level again later
+    std::vector<Victim> victims;
+    uint64_t evictable = 0;
+    for (auto& [id, entry] : m_entries) {
+        if (id == requester || entry.m_pending ||
+            entry.m_resident_level == entry.m_tail_level) {
+            continue;
+        }
+        bool in_use = entry.m_last_request_frame == m_frame;
+        if (in_use && entry.m_desired_level <= entry.m_resident_level) {
+            continue;
+        }
+        uint64_t freed = levelsSize(entry, entry.m_resident_level) -
+                         levelsSize(entry, entry.m_tail_level);
+        victims.push_back({in_use, entry.m_last_request_frame, id,
+                           entry.m_tail_level, freed});
+        evictable += freed;
+    }
+    if (m_used_size + size > m_config.m_budget + evictable) {
+        return false;
+    }
+
+    std::sort(victims.begin(), victims.end(),
+              [](const Victim& a, const Victim& b) {
+                  if (a.m_in_use != b.m_in_use) {
+                      return !a.m_in_use;
+                  }
+                  if (a.m_last_request_frame != b.m_last_request_frame) {
+                      return a.m_last_request_frame < b.m_last_request_frame;
+                  }
+                  return a.m_id < b.m_id;
+              });
+    for (auto& victim : victims) {
+        if (m_used_size + size <= m_config.m_budget) {
+            break;
+        }
+        m_entries[victim.m_id].m_resident_level = victim.m_level;
+        m_used_size -= victim.m_freed;
+        actions.push_back({Action::Type::Evict, victim.m_id, victim.m_level});
+    }
+    return true;
+}
+
+std::vector<TextureStreamer::Action> TextureStreamer::Update() {
+    std::vector<Action> actions;
+
+    std::vector<ID> candidates;
+    for (auto& [id, entry] : m_entries) {
+        if (entry.m_last_request_frame == m_frame && !entry.m_pending &&
+            entry.m_desired_level < entry.m_resident_level) {
+            candidates.push_back(id);
+        }
+    }
+    // biggest quality gain first
+    std::sort(candidates.begin(), candidates.end(), [&](ID a, ID b) {
+        auto& entry_a = m_entries[a];
+        auto& entry_b = m_entries[b];
+        uint32_t gap_a = entry_a.m_resident_level - entry_a.m_desired_level;
+        uint32_t gap_b = entry_b.m_resident_level - entry_b.m_desired_level;
+        return gap_a != gap_b ? gap_a > gap_b : a < b;
+    });
+
+    uint32_t granted = 0;
+    for (ID id : candidates) {
+        if (granted >= m_config.m_max_stream_in_per_frame) {
+            break;
+        }
+
+        auto& entry = m_entries[id];
+        uint64_t resident_size = levelsSize(entry, entry.m_resident_level);
+        // fall back to less detailed levels when the desired one doesn't fit
+        for (uint32_t level = entry.m_desired_level;
+             level < entry.m_resident_level; level++) {
+            uint64_t extra = levelsSize(entry, level) - resident_size;
+            if (makeRoom(extra, id, actions)) {
+                m_used_size += extra;
+                entry.m_pending = true;
+                entry.m_pending_level = level;
+                actions.push_back({Action::Type::StreamIn, id, level});
+                granted++;
+                break;
+            }
+        }
+    }
+
+    m_frame++;
+    return actions;
+}
+
+void TextureStreamer::FinishStreamIn(ID id) {
+    auto it = m_entries.find(id);
+    if (it == m_entries.end() || !it->second.m_pending) {
+        return;
+    }
+    it->second.m_resident_level = it->second.m_pending_level;
+    it->second.m_pending = false;
+}
+
+void TextureStreamer::CancelStreamIn(ID id) {
+    auto it = m_entries.find(id);
+    if (it == m_entries.end() || !it->second.m_pending) {
+        return;
+    }
+    auto& entry = it->second;
+    m_used_size -= levelsSize(entry, entry.m_pending_level) -
+                   levelsSize(entry, entry.m_resident_level);
+    entry.m_pending = false;
+}
+
+uint64_t TextureStreamer::GetUsedSize() const noexcept {
+    return m_used_size;
+}
+
+}  // namespace nickel::graphics
@@ -0,0 +1,37 @@
+#include "nickel/graphics/texture_streaming.hpp"
+#include "nickel/common/macro.hpp"
+
+#include "toml++/toml.hpp"
+
+namespace nickel::graphics {
+
+TextureStreamingConfig TextureStreamingConfig::LoadFromFile(
+    const Path& filename) {
+    TextureStreamingConfig config;
+
+    auto parser = toml::parse_file(filename.ToString());
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(
+        config, !parser.failed(),
+        "can't parse texture streaming config {}, streaming off", filename);
+    auto& tbl = parser.table();
+
+    if (auto enable = tbl.get_as<bool>("enable")) {
+        config.m_enable = enable->get();
+    }
+    if (auto budget = tbl.get_as<int64_t>("budget_mb")) {
+        config.m_budget =
+            static_cast<uint64_t>(std::max<int64_t>(budget->get(), 0)) * 1024 *
+            1024;
+    }
+    if (auto tail_size = tbl.get_as<int64_t>("mip_tail_size")) {
+        config.m_mip_tail_size =
+            std::max<uint32_t>(static_cast<uint32_t>(tail_size->get()), 1);
+    }
+    if (auto count = tbl.get_as<int64_t>("max_stream_in_per_frame")) {
+        config.m_max_stream_in_per_frame =
+            std::max<uint32_t>(static_cast<uint32_t>(count->get()), 1);
+    }
+    return config;
+}
+
+}  // namespace nickel::graphics
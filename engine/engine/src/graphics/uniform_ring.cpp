@@ -0,0 +1,154 @@
+#include "nickel/graphics/uniform_ring.hpp"
+#include "nickel/common/log.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/graphics/lowlevel/adapter.hpp"
+
+namespace nickel::graphics {
+
+RingPageAllocator::RingPageAllocator(uint64_t page_size, uint64_t alignment,
+                                     uint32_t frame_count)
+    : m_page_size{page_size},
+      m_alignment{std::max<uint64_t>(alignment, 1)},
+      m_frame_pages(std::max(frame_count, 1u)) {}
+
+void RingPageAllocator::BeginFrame(uint32_t frame) {
+    m_cur_frame = frame % m_frame_pages.size();
+    auto& pages = m_frame_pages[m_cur_frame];
+    m_free_pages.insert(m_free_pages.end(), pages.rbegin(), pages.rend());
+    pages.clear();
+    m_cur_offset = 0;
+}
+
+std::optional<RingPageAllocator::Allocation> RingPageAllocator::Allocate(
+    uint64_t size) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(std::nullopt, size <= m_page_size,
+                                      "ring allocation of {} bytes is larger "
+                                      "than page size {}",
+                                      size, m_page_size);
+
+    auto& pages = m_frame_pages[m_cur_frame];
+    uint64_t offset =
+        (m_cur_offset + m_alignment - 1) / m_alignment * m_alignment;
+    if (pages.empty() || offset + size > m_page_size) {
+        if (m_free_pages.empty()) {
+            pages.push_back(m_page_count++);
+        } else {
+            pages.push_back(m_free_pages.back());
+            m_free_pages.pop_back();
+        }
+        offset = 0;
+    }
+
+    m_cur_offset = offset + size;
+    return Allocation{pages.back(), offset};
+}
+
+uint32_t RingPageAllocator::GetPageCount() const noexcept {
+    return m_page_count;
+}
+
+uint32_t RingPageAllocator::GetFramePageCount() const noexcept {
+    return m_frame_pages[m_cur_frame].size();
+}
+
+uint64_t RingPageAllocator::GetPageSize() const noexcept {
+    return m_page_size;
+}
+
+namespace {
+
+bool IsStorage(BindGroup::BufferBinding::Type type) {
+    return type == BindGroup::BufferBinding::Type::DynamicStorage;
+}
+
+}  // namespace
+
+UniformRingBuffer::UniformRingBuffer(const Adapter& adapter,
+                                     const Descriptor& desc)
+    : m_device{adapter.GetDevice()},
+      m_desc{desc},
+      m_allocator{std::max<uint64_t>(desc.m_page_size, desc.m_binding_range),
+                  IsStorage(desc.m_type)
+                      ? adapter.GetLimits().min_storage_buffer_offset_alignment
+                      : adapter.GetLimits().min_uniform_buffer_offset_alignment,
+                  m_device.GetFramesInFlight()} {
+    if (!IsStorage(desc.m_type) &&
+        desc.m_binding_range > adapter.GetLimits().max_uniform_buffer_range) {
+        LOGE("uniform ring binding range {} exceeds device limit {}",
+             desc.m_binding_range,
+             adapter.GetLimits().max_uniform_buffer_range);
+    }
+
+    BindGroupLayout::Descriptor layout_desc;
+    BindGroupLayout::Entry entry;
+    entry.m_shader_stage = desc.m_shader_stage;
+    entry.m_array_size = 1;
+    entry.m_type = IsStorage(desc.m_type)
+                       ? BindGroupEntryType::StoragesBufferDynamic
+                       : BindGroupEntryType::UniformBufferDynamic;
+    layout_desc.m_entries[desc.m_binding] = entry;
+    m_layout = m_device.CreateBindGroupLayout(layout_desc);
+}
+
+UniformRingBuffer::~UniformRingBuffer() {
+    for (auto& page : m_pages) {
+        page.m_buffer.Unmap();
+    }
+}
+
+BindGroupLayout UniformRingBuffer::GetBindGroupLayout() const {
+    return m_layout;
+}
+
+void UniformRingBuffer::BeginFrame() {
+    m_allocator.BeginFrame(m_device.GetCurrentFrameIndex());
+}
+
+UniformRingBuffer::Allocation UniformRingBuffer::Allocate(uint64_t size) {
+    auto allocation = m_allocator.Allocate(
+        std::max<uint64_t>(size, m_desc.m_binding_range));
+    if (!allocation) {
+        return {};
+    }
+
+    while (m_pages.size() < m_allocator.GetPageCount()) {
+        createPage();
+    }
+
+    auto& page = m_pages[allocation->m_page];
+    return {static_cast<char*>(page.m_data) + allocation->m_offset,
+            static_cast<uint32_t>(allocation->m_offset), &page.m_bind_group};
+}
+
+const RingPageAllocator& UniformRingBuffer::GetAllocator() const {
+    return m_allocator;
+}
+
+void UniformRingBuffer::createPage() {
+    Page page;
+
+    Buffer::Descriptor buffer_desc;
+    buffer_desc.m_size = m_allocator.GetPageSize();
+    buffer_desc.m_usage = IsStorage(m_desc.m_type) ? BufferUsage::Storage
+                                                   : BufferUsage::Uniform;
+    buffer_desc.m_memory_type = MemoryType::Coherence;
+    page.m_buffer = m_device.CreateBuffer(buffer_desc);
+    page.m_buffer.MapAsync();
+    page.m_data = page.m_buffer.GetMappedRange();
+
+    BindGroup::Descriptor group_desc;
+    BindGroup::Entry entry;
+    BindGroup::BufferBinding binding;
+    binding.m_buffer = page.m_buffer;
+    binding.m_type = m_desc.m_type;
+    binding.m_size = m_desc.m_binding_range;
+    entry.m_binding.m_entry = binding;
+    entry.m_shader_stage = m_desc.m_shader_stage;
+    entry.m_array_size = 1;
+    group_desc.m_entries[m_desc.m_binding] = entry;
+    page.m_bind_group = m_layout.RequireBindGroup(group_desc);
+
+    m_pages.push_back(std::move(page));
+}
+
+}  // namespace nickel::graphics
@@ -157,7 +157,12 @@ void debugDrawRigidActor(const physx::PxActor* actor) {
 }
 
 void Level::Update() {
+    Camera& camera = Context::GetInst().GetCamera();
+    m_occlusion_culler.BeginFrame(camera.GetProject() * camera.GetView());
+    m_models.clear();
+
     preorderGO(nullptr, m_root_go);
+    drawModels();
 
     auto& physics_ctx = Context::GetInst().GetPhysicsContext();
     auto scene = physics_ctx.GetMainScene().GetImpl()->m_scene;
@@ -196,9 +201,25 @@ void Level::preorderGO(GameObject* parent, GameObject& go) {
                 : go.m_global_transform;
     }
 
+    if (go.m_pending_model.IsReady()) {
+        go.m_model = go.m_pending_model.Get();
+        go.m_pending_model = {};
+    } else if (go.m_pending_model && go.m_pending_model.IsFailed()) {
+        LOGW("game object {} model load failed", go.m_name);
+        go.m_pending_model = {};
+    }
+
+    if (go.m_occluder && m_occlusion_culling) {
+        m_occlusion_culler.AddOccluder(*go.m_occluder,
+                                       go.m_global_transform.ToMat());
+    }
+
     if (go.m_model) {
-        Context::GetInst().GetGraphicsContext().DrawModel(go.m_global_transform,
-                                                          go.m_model);
+        m_models.push_back(&go);
+    } else if (go.m_pending_model.IsPending()) {
+        Context::GetInst().GetDebugDrawer().DrawBox(
+            go.m_global_transform.p, go.m_global_transform.scale * 0.5f,
+            go.m_global_transform.q, Color{0.5, 0.5, 0.5, 1});
     }
 
     for (auto& child : go.m_children) {
@@ -206,4 +227,23 @@ void Level::preorderGO(GameObject* parent, GameObject& go) {
     }
 }
 
+void Level::drawModels() {
+    if (m_occlusion_culling) {
+        m_occlusion_culler.RasterizeOccluders(
+            &Context::GetInst().GetThreadPool());
+    }
+
+    auto& graphics_ctx = Context::GetInst().GetGraphicsContext();
+    for (auto go : m_models) {
+        // occluders aren't tested against themselves
+        if (m_occlusion_culling && go->m_bounds && !go->m_occluder &&
+            m_occlusion_culler.IsOccluded(*go->m_bounds,
+                                          go->m_global_transform.ToMat())) {
+            continue;
+        }
+        graphics_ctx.DrawModel(go->m_global_transform, go->m_model,
+                               &go->m_lod_state);
+    }
+}
+
 }  // namespace nickel
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "nickel/physics/internal/cct_batch.hpp"
+
+#include "nickel/common/macro.hpp"
+#include "nickel/physics/internal/cct_ext.hpp"
+#include "nickel/physics/internal/cct_impl.hpp"
+#include "nickel/physics/internal/util.hpp"
+
+namespace nickel::physics {
+
+class CharacterControllerBatch::MoveTask : public physx::PxBaseTask {
+public:
+    explicit MoveTask(CharacterControllerBatch& batch) : m_batch{batch} {}
+
+    void run() override { m_batch.moveGroups(); }
+
+    void release() override { m_batch.onTaskFinished(); }
+
+    const char* getName() const override { return "nickel.MoveControllers"; }
+
+    // submitted directly to the dispatcher, no task manager references
+    void addReference() override {}
+
+    void removeReference() override {}
+
+    int32_t getReference() const override { return 1; }
+
+private:
+    CharacterControllerBatch& m_batch;
+};
+
+// max distance from controller position to its surface, including every
+// offset the controller may sweep with
+static float getControllerExtent(physx::PxController& cct) {
+    float extent = cct.getContactOffset() + cct.getStepOffset();
+    switch (cct.getType()) {
+        case physx::PxControllerShapeType::eCAPSULE: {
+            auto& capsule = static_cast<physx::PxCapsuleController&>(cct);
+            extent += capsule.getRadius() + capsule.getHeight() * 0.5f;
+        } break;
+        case physx::PxControllerShapeType::eBOX: {
+            auto& box = static_cast<physx::PxBoxController&>(cct);
+            extent += box.getHalfHeight() + box.getHalfSideExtent() +
+                      box.getHalfForwardExtent();
+        } break;
+        default:
+            break;
+    }
+    return extent;
+}
+
+static uint64_t getCellKey(int32_t x, int32_t z) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+           static_cast<uint32_t>(z);
+}
+
+static uint32_t getCellPhase(int32_t x, int32_t z) {
+    return static_cast<uint32_t>(((x % 3) + 3) % 3 * 3 + ((z % 3) + 3) % 3);
+}
+
+CharacterControllerBatch::CharacterControllerBatch(
+    physx::PxScene& scene, physx::PxControllerManager& mgr)
+    : m_scene{scene}, m_mgr{mgr} {}
+
+CharacterControllerBatch::~CharacterControllerBatch() = default;
+
+void CharacterControllerBatch::Move(
+    std::span<const CCTMoveCommand> commands,
+    std::span<Flags<CCTCollisionFlag>> out_flags) {
+    NICKEL_RETURN_IF_FALSE_LOGE(
+        out_flags.size() >= commands.size(),
+        "MoveControllers: {} commands but only {} flags", commands.size(),
+        out_flags.size());
+    if (commands.empty()) {
+        return;
+    }
+
+    m_commands = commands;
+    m_out_flags = out_flags;
+
+    if (buildGrid()) {
+        buildGroups();
+
+        // queries lazily commit pending scene changes under a write lock,
+        // do it once here instead of stalling the parallel moves
+        m_scene.flushQueryUpdates();
+
+        SetCCTManagerLocking(m_mgr, true);
+        for (uint32_t phase = 0; phase < PhaseNum; phase++) {
+            runPhase(phase);
+        }
+        SetCCTManagerLocking(m_mgr, false);
+    }
+
+    m_commands = {};
+    m_out_flags = {};
+}
+
+bool CharacterControllerBatch::buildGrid() {
+    const uint32_t controller_num = m_mgr.getNbControllers();
+    if (controller_num == 0) {
+        return false;
+    }
+
+    float max_extent = 0;
+    for (uint32_t i = 0; i < controller_num; i++) {
+        max_extent =
+            std::max(max_extent, getControllerExtent(*m_mgr.getController(i)));
+    }
+    float max_disp = 0;
+    for (auto& command : m_commands) {
+        max_disp = std::max(max_disp, Length(command.m_disp));
+    }
+
+    // controllers in non-adjacent cells are at least one cell apart, which is
+    // farther than two of them can reach in this batch
+    m_cell_size = 2.0f * (max_extent + max_disp) + 0.01f;
+
+    m_cell_map.clear();
+    m_cells.clear();
+    m_controller_cells.resize(controller_num);
+    for (uint32_t i = 0; i < controller_num; i++) {
+        uint32_t cell = getCell(m_mgr.getController(i)->getPosition());
+        m_controller_cells[i] = cell;
+        m_cells[cell].m_member_end++;
+    }
+
+    // counting sort controllers by cell
+    uint32_t offset = 0;
+    for (auto& cell : m_cells) {
+        uint32_t count = cell.m_member_end;
+        cell.m_member_begin = offset;
+        cell.m_member_end = offset;
+        offset += count;
+    }
+    m_members.resize(controller_num);
+    for (uint32_t i = 0; i < controller_num; i++) {
+        m_members[m_cells[m_controller_cells[i]].m_member_end++] = i;
+    }
+    return true;
+}
+
+uint32_t CharacterControllerBatch::getCell(const physx::PxExtendedVec3& p) {
+    auto x = static_cast<int32_t>(std::floor(p.x / m_cell_size));
+    auto z = static_cast<int32_t>(std::floor(p.z / m_cell_size));
+    auto [it, inserted] = m_cell_map.try_emplace(
+        getCellKey(x, z), static_cast<uint32_t>(m_cells.size()));
+    if (inserted) {
+        Cell cell;
+        cell.m_x = x;
+        cell.m_z = z;
+        m_cells.push_back(cell);
+    }
+    return it->second;
+}
+
+void CharacterControllerBatch::buildCandidates(uint32_t cell_idx) {
+    auto& cell = m_cells[cell_idx];
+    cell.m_candidate_begin = static_cast<uint32_t>(m_candidates.size());
+    for (int32_t dx = -1; dx <= 1; dx++) {
+        for (int32_t dz = -1; dz <= 1; dz++) {
+            auto it = m_cell_map.find(getCellKey(cell.m_x + dx, cell.m_z + dz));
+            if (it == m_cell_map.end()) {
+                continue;
+            }
+            auto& neighbor = m_cells[it->second];
+            m_candidates.insert(m_candidates.end(),
+                                m_members.begin() + neighbor.m_member_begin,
+                                m_members.begin() + neighbor.m_member_end);
+        }
+    }
+    cell.m_candidate_end = static_cast<uint32_t>(m_candidates.size());
+}
+
+void CharacterControllerBatch::buildGroups() {
+    m_order.clear();
+    m_command_cells.resize(m_commands.size());
+    for (uint32_t i = 0; i < m_commands.size(); i++) {
+        auto impl = m_commands[i].m_controller.GetImpl();
+        if (!impl || !impl->m_cct) {
+            m_out_flags[i] = {};
+            continue;
+        }
+        m_command_cells[i] = getCell(impl->m_cct->getPosition());
+        m_order.push_back(i);
+    }
+
+    std::stable_sort(m_order.begin(), m_order.end(),
+                     [&](uint32_t lhs, uint32_t rhs) {
+                         auto& c1 = m_cells[m_command_cells[lhs]];
+                         auto& c2 = m_cells[m_command_cells[rhs]];
+                         uint32_t p1 = getCellPhase(c1.m_x, c1.m_z);
+                         uint32_t p2 = getCellPhase(c2.m_x, c2.m_z);
+                         if (p1 != p2) {
+                             return p1 < p2;
+                         }
+                         return m_command_cells[lhs] < m_command_cells[rhs];
+                     });
+
+    m_groups.clear();
+    m_candidates.clear();
+    m_phase_offsets.fill(0);
+    for (uint32_t i = 0; i < m_order.size(); i++) {
+        uint32_t cell = m_command_cells[m_order[i]];
+        if (m_groups.empty() || m_groups.back().m_cell != cell) {
+            Group group;
+            group.m_cell = cell;
+            group.m_begin = i;
+            m_groups.push_back(group);
+            buildCandidates(cell);
+            m_phase_offsets[getCellPhase(m_cells[cell].m_x,
+                                         m_cells[cell].m_z) +
+                            1]++;
+        }
+        m_groups.back().m_end = i + 1;
+    }
+    for (uint32_t i = 1; i < m_phase_offsets.size(); i++) {
+        m_phase_offsets[i] += m_phase_offsets[i - 1];
+    }
+}
+
+void CharacterControllerBatch::runPhase(uint32_t phase) {
+    const uint32_t begin = m_phase_offsets[phase];
+    const uint32_t end = m_phase_offsets[phase + 1];
+    if (begin == end) {
+        return;
+    }
+
+    m_next_group = begin;
+    m_group_end = end;
+
+    // the calling thread takes groups too, so one task less than groups
+    auto dispatcher = m_scene.getCpuDispatcher();
+    uint32_t task_num =
+        dispatcher ? std::min(dispatcher->getWorkerCount(), end - begin - 1)
+                   : 0;
+    while (m_tasks.size() < task_num) {
+        m_tasks.push_back(std::make_unique<MoveTask>(*this));
+    }
+
+    m_running_tasks = task_num;
+    for (uint32_t i = 0; i < task_num; i++) {
+        dispatcher->submitTask(*m_tasks[i]);
+    }
+
+    moveGroups();
+
+    {
+        std::unique_lock lock{m_mutex};
+        m_cond.wait(lock, [this] { return m_running_tasks == 0; });
+    }
+
+    // moves only read the scene, their kinematic actor writes are committed
+    // here once no query runs
+    for (uint32_t group = begin; group < end; group++) {
+        for (uint32_t i = m_groups[group].m_begin; i < m_groups[group].m_end;
+             i++) {
+            CommitKinematicTarget(
+                *m_commands[m_order[i]].m_controller.GetImpl()->m_cct);
+        }
+    }
+}
+
+void CharacterControllerBatch::moveGroups() {
+    uint32_t group;
+    while ((group = m_next_group.fetch_add(1)) < m_group_end) {
+        moveGroup(m_groups[group]);
+    }
+}
+
+void CharacterControllerBatch::moveGroup(const Group& group) {
+    auto& cell = m_cells[group.m_cell];
+
+    const uint32_t* candidates = m_candidates.data() + cell.m_candidate_begin;
+    uint32_t candidate_num = cell.m_candidate_end - cell.m_candidate_begin;
+
+    // generous bounds of every query box of the group, a move whose box
+    // still sticks out queries the scene itself
+    auto bounds = physx::PxBounds3::empty();
+    for (uint32_t i = group.m_begin; i < group.m_end; i++) {
+        auto& command = m_commands[m_order[i]];
+        auto cct = command.m_controller.GetImpl()->m_cct;
+        float reach =
+            2.0f * (getControllerExtent(*cct) + Length(command.m_disp));
+        bounds.include(physx::PxBounds3::centerExtents(
+            physx::toVec3(cct->getPosition()), physx::PxVec3{reach}));
+    }
+
+    physx::PxControllerFilters filters;
+    std::array<physx::PxOverlapHit, SharedHitCapacity> hits;
+    physx::PxOverlapBuffer hit_buffer{hits.data(), SharedHitCapacity};
+    physx::PxQueryFilterData filter_data{physx::PxQueryFlag::eSTATIC |
+                                         physx::PxQueryFlag::eDYNAMIC |
+                                         physx::PxQueryFlag::eNO_BLOCK};
+    m_scene.overlap(physx::PxBoxGeometry{bounds.getExtents()},
+                    physx::PxTransform{bounds.getCenter()}, hit_buffer,
+                    filter_data);
+    const physx::PxOverlapHit* shared_hits =
+        hit_buffer.getNbTouches() < SharedHitCapacity ? hits.data() : nullptr;
+
+    for (uint32_t i = group.m_begin; i < group.m_end; i++) {
+        uint32_t idx = m_order[i];
+        auto& command = m_commands[idx];
+        auto cct = command.m_controller.GetImpl()->m_cct;
+        SetCCTCandidates(*cct, candidates, candidate_num);
+        SetCCTSharedOverlap(*cct, shared_hits, hit_buffer.getNbTouches(),
+                            bounds);
+        SetDeferKinematicTarget(*cct, true);
+        m_out_flags[idx] = CCTCollisionFlagFromPhysX(
+            cct->move(Vec3ToPhysX(command.m_disp), command.m_min_dist,
+                      command.m_elapsed_time, filters));
+        SetCCTCandidates(*cct, nullptr, 0);
+        SetCCTSharedOverlap(*cct, nullptr, 0, physx::PxBounds3::empty());
+        SetDeferKinematicTarget(*cct, false);
+    }
+}
+
+void CharacterControllerBatch::onTaskFinished() {
+    std::lock_guard lock{m_mutex};
+    if (--m_running_tasks == 0) {
+        m_cond.notify_one();
+    }
+}
+
+}  // namespace nickel::physics
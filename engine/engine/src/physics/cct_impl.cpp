@@ -36,7 +36,13 @@ CapsuleControllerImpl::CapsuleControllerImpl(
 
     if (!m_cct) {
         LOGE("capsule controller create failed");
+        return;
     }
+
+    // the kinematic actor is restored through the controller, both share id
+    void* id = StableIDToUserData(ctx.GenerateStableID());
+    m_cct->setUserData(id);
+    m_cct->getActor()->userData = id;
 }
 
 CapsuleControllerImpl::CapsuleControllerImpl(
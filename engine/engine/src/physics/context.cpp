@@ -3,7 +3,10 @@
 
 namespace nickel::physics {
 
-Context::Context() : m_impl{std::make_unique<ContextImpl>()} {}
+Context::Context() : Context{InstrumentationConfig{}} {}
+
+Context::Context(const InstrumentationConfig& config)
+    : m_impl{std::make_unique<ContextImpl>(config)} {}
 
 Context::~Context() {}
 
@@ -91,4 +94,15 @@ ContextImpl* Context::GetImpl() {
     return m_impl.get();
 }
 
-}  // namespace nickel::physics
\ No newline at end of file
+const InstrumentationConfig& Context::GetInstrumentationConfig() const {
+    return m_impl->GetInstrumentationConfig();
+}
+
+void Context::GetStepTimings(std::vector<PhysicsStepTiming>& out) const {
+    out.clear();
+    if (auto profiler = m_impl->GetProfiler()) {
+        profiler->GetStepTimings(out);
+    }
+}
+
+}  // namespace nickel::physics
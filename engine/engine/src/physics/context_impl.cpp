@@ -29,21 +29,15 @@ physx::PxQueryHitType::Enum QueryFilterCallback::postFilter(
     return physx::PxQueryHitType::eTOUCH;
 }
 
-ContextImpl::ContextImpl() {
+ContextImpl::ContextImpl(const InstrumentationConfig& config)
+    : m_pvd{}, m_pvd_transport{}, m_instrumentation_config{config} {
     m_foundation =
         PxCreateFoundation(PX_PHYSICS_VERSION, m_allocator, m_error_callback);
     if (!m_foundation) {
         LOGC("Failed to init PhysX");
     }
 
-    m_pvd = physx::PxCreatePvd(*m_foundation);
-    if (!m_pvd) {
-        LOGE("create PhysX PVD failed");
-    } else {
-        m_pvd_transport =
-            physx::PxDefaultPvdSocketTransportCreate("localhost", 5425, 10);
-        m_pvd->connect(*m_pvd_transport, physx::PxPvdInstrumentationFlag::eALL);
-    }
+    initInstrumentation();
 
     m_physics = PxCreatePhysics(PX_PHYSICS_VERSION, *m_foundation,
                                 m_tolerances_scale, false, m_pvd);
@@ -88,9 +82,72 @@ ContextImpl::~ContextImpl() {
     if (m_pvd_transport) {
         m_pvd_transport->release();
     }
+    if (m_profiler) {
+        if (PxGetProfilerCallback() == m_profiler.get()) {
+            PxSetProfilerCallback(nullptr);
+        }
+        m_profiler.reset();
+    }
     m_foundation->release();
 }
 
+void ContextImpl::initInstrumentation() {
+    auto& config = m_instrumentation_config;
+    switch (config.m_mode) {
+        case InstrumentationMode::Off:
+            return;
+        case InstrumentationMode::PVDSocket:
+            m_pvd_transport = physx::PxDefaultPvdSocketTransportCreate(
+                config.m_pvd_host.c_str(), config.m_pvd_port,
+                config.m_pvd_timeout);
+            break;
+        case InstrumentationMode::PVDFile:
+            m_pvd_transport = new PvdFileTransport(config.m_pvd_file,
+                                                   config.m_pvd_file_max_size);
+            break;
+        case InstrumentationMode::Profile:
+            initProfiler();
+            return;
+    }
+
+    m_pvd = physx::PxCreatePvd(*m_foundation);
+    if (!m_pvd) {
+        LOGE("create PhysX PVD failed");
+        return;
+    }
+    if (!m_pvd->connect(*m_pvd_transport,
+                        physx::PxPvdInstrumentationFlag::eALL)) {
+        LOGW("PhysX PVD connect failed");
+    }
+}
+
+void ContextImpl::initProfiler() {
+    auto& config = m_instrumentation_config;
+#if defined(NICKEL_DEBUG) || defined(NICKEL_PHYSX_PROFILE)
+    // profiler callback is process global, the first context keeps it
+    if (PxGetProfilerCallback()) {
+        LOGE("PhysX profiler callback is in use by another physics context, "
+             "instrumentation off");
+        config.m_mode = InstrumentationMode::Off;
+        return;
+    }
+    m_profiler = std::make_unique<PhysicsProfiler>(config.m_profile_capacity);
+    PxSetProfilerCallback(m_profiler.get());
+#else
+    LOGE("PhysX is built without profile zones, reconfigure with "
+         "NICKEL_PHYSX_PROFILE=ON for profile mode. Instrumentation off");
+    config.m_mode = InstrumentationMode::Off;
+#endif
+}
+
+const InstrumentationConfig& ContextImpl::GetInstrumentationConfig() const {
+    return m_instrumentation_config;
+}
+
+PhysicsProfiler* ContextImpl::GetProfiler() {
+    return m_profiler.get();
+}
+
 physx::PxFilterFlags ContextImpl::SimulateFilterShader(
     physx::PxFilterObjectAttributes attributes0,
     physx::PxFilterData filterData0,
@@ -167,6 +224,12 @@ Scene ContextImpl::CreateScene(const std::string& name, const Vec3& gravity) {
     desc.solverType = physx::PxSolverType::eTGS;
     desc.filterShader = SimulateFilterShader;
     desc.flags |= physx::PxSceneFlag::eENABLE_CCD;
+    // pair and solver order must not depend on the scene's history, or an
+    // in-place snapshot restore doesn't replay the recorded run. Box pruning
+    // broad phases report refiltered pairs in an order left by past motion,
+    // sweep and prune doesn't
+    desc.flags |= physx::PxSceneFlag::eENABLE_ENHANCED_DETERMINISM;
+    desc.broadPhaseType = physx::PxBroadPhaseType::eSAP;
 
     m_cpu_dispatcher = physx::PxDefaultCpuDispatcherCreate(4);
     desc.cpuDispatcher = m_cpu_dispatcher;
@@ -190,6 +253,7 @@ RigidStatic ContextImpl::CreateRigidStatic(const Vec3& p, const Quat& q) {
     if (!rigid) {
         return {};
     }
+    rigid->userData = StableIDToUserData(GenerateStableID());
     return m_rigid_actor_allocator.Allocate(
         this, static_cast<physx::PxRigidActor*>(rigid));
 }
@@ -200,6 +264,7 @@ RigidDynamic ContextImpl::CreateRigidDynamic(const Vec3& p, const Quat& q) {
     if (!rigid) {
         return {};
     }
+    rigid->userData = StableIDToUserData(GenerateStableID());
     return m_rigid_actor_allocator.Allocate(
         this, static_cast<physx::PxRigidActor*>(rigid));
 }
@@ -348,6 +413,7 @@ D6Joint ContextImpl::CreateD6Joint(const RigidActor& actor0, const Vec3& p0,
                         actor1.GetImpl()->m_actor,
                         physx::PxTransform{Vec3ToPhysX(p1), QuatToPhysX(q1)});
     if (joint) {
+        joint->userData = StableIDToUserData(GenerateStableID());
         return m_joint_allocator.Allocate(this, joint);
     }
     return {};
@@ -358,6 +424,10 @@ void ContextImpl::Update(float delta_time) {
     m_main_scene.Simulate(delta_time);
 }
 
+uint32_t ContextImpl::GenerateStableID() {
+    return ++m_last_stable_id;
+}
+
 Scene ContextImpl::GetMainScene() {
     return m_main_scene;
 }
@@ -1,12 +1,16 @@
 #include "nickel/graphics/internal/gltf_loader.hpp"
 
+#include "nickel/common/common.hpp"
+#include "nickel/common/macro.hpp"
 #include "nickel/graphics/internal/context_impl.hpp"
 #include "nickel/graphics/internal/gltf_manager_impl.hpp"
 #include "nickel/graphics/internal/material3d_impl.hpp"
 #include "nickel/graphics/internal/mesh_impl.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
 #include "nickel/graphics/internal/texture_impl.hpp"
 
 #include <numeric>
+#include <unordered_map>
 
 namespace nickel::graphics {
 
@@ -22,7 +26,828 @@ static Buffer copyBuffer2GPU(Device device, std::span<T> src,
     return buffer;
 }
 
-GLTFLoader::GLTFLoader(const tinygltf::Model& model) : m_gltf_model{model} {}
+std::vector<uint32_t> PackPBRParameters(std::span<const PBRParameters> params,
+                                        uint32_t align,
+                                        std::vector<unsigned char>& out_data) {
+    std::unordered_map<PBRParameters, uint32_t> blocks;
+    std::vector<uint32_t> offsets;
+    offsets.reserve(params.size());
+    for (auto& param : params) {
+        auto [it, inserted] = blocks.emplace(
+            param, (out_data.size() + align - 1) / align * align);
+        if (inserted) {
+            out_data.resize(it->second + sizeof(PBRParameters));
+            memcpy(out_data.data() + it->second, &param, sizeof(param));
+        }
+        offsets.push_back(it->second);
+    }
+    return offsets;
+}
+
+std::vector<uint32_t> ReadIndices(const unsigned char* data, uint32_t count,
+                                  IndexType type) {
+    std::vector<uint32_t> indices(count);
+    switch (type) {
+        case IndexType::Uint16:
+            ConvertRangeData<uint16_t>(data, indices.data(), count, 1,
+                                       sizeof(uint16_t));
+            break;
+        case IndexType::Uint32:
+            memcpy(indices.data(), data, count * sizeof(uint32_t));
+            break;
+    }
+    return indices;
+}
+
+GLTFVertexData ExtractVertexData(const std::string& name,
+                                 std::span<const Primitive> prims,
+                                 std::span<const unsigned char> vertex_data,
+                                 std::span<const unsigned char> index_data) {
+    GLTFVertexData data;
+    data.m_name = name;
+    for (auto& prim : prims) {
+        auto& vertex_view = prim.m_vertex_buf_view;
+        uint32_t stride = GetVertexStride(prim.m_vertex_layout);
+        NICKEL_CONTINUE_IF_FALSE(vertex_view.m_count > 0 &&
+                                 vertex_view.m_size >=
+                                     vertex_view.m_count * stride &&
+                                 vertex_view.m_offset + vertex_view.m_size <=
+                                     vertex_data.size());
+
+        // position is the first member of every layout
+        uint32_t base = data.m_points.size();
+        for (uint32_t i = 0; i < vertex_view.m_count; i++) {
+            Vec3 point;
+            memcpy(&point,
+                   vertex_data.data() + vertex_view.m_offset + i * stride,
+                   sizeof(Vec3));
+            data.m_points.push_back(point);
+        }
+
+        auto& index_view = prim.m_indices_buf_view;
+        if (index_view.m_count > 0 &&
+            index_view.m_offset + index_view.m_size <= index_data.size()) {
+            for (uint32_t index :
+                 ReadIndices(index_data.data() + index_view.m_offset,
+                             index_view.m_count, prim.m_index_type)) {
+                data.m_indices.push_back(base + index);
+            }
+        } else {
+            for (uint32_t i = 0; i < vertex_view.m_count; i++) {
+                data.m_indices.push_back(base + i);
+            }
+        }
+    }
+    return data;
+}
+
+template <typename F>
+static void visitTriangles(std::span<const uint32_t> indices,
+                           uint32_t vertex_count, F f) {
+    if (!indices.empty()) {
+        NICKEL_ASSERT(indices.size() % 3 == 0, "indices must be triangle list");
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            f(indices[i], indices[i + 1], indices[i + 2]);
+        }
+    } else {
+        NICKEL_ASSERT(vertex_count % 3 == 0, "vertices must be triangle list");
+        for (uint32_t i = 0; i + 2 < vertex_count; i += 3) {
+            f(i, i + 1, i + 2);
+        }
+    }
+}
+
+void GenerateNormals(std::span<const Vec3> positions,
+                     std::span<const uint32_t> indices,
+                     std::span<Vec3> out_normals) {
+    visitTriangles(indices, positions.size(),
+                   [&](uint32_t idx1, uint32_t idx2, uint32_t idx3) {
+                       auto& pos1 = positions[idx1];
+                       auto& pos2 = positions[idx2];
+                       auto& pos3 = positions[idx3];
+                       auto normal =
+                           Cross(Normalize(pos2 - pos1), pos3 - pos1);
+                       out_normals[idx1] = normal;
+                       out_normals[idx2] = normal;
+                       out_normals[idx3] = normal;
+                   });
+}
+
+void GenerateTangents(std::span<const Vec3> positions,
+                      std::span<const Vec2> uvs,
+                      std::span<const uint32_t> indices,
+                      std::span<Vec4> out_tangents) {
+    visitTriangles(
+        indices, positions.size(),
+        [&](uint32_t idx1, uint32_t idx2, uint32_t idx3) {
+            auto& pos1 = positions[idx1];
+            auto& pos2 = positions[idx2];
+            auto& pos3 = positions[idx3];
+
+            Vec4 tangent;
+            if (uvs.empty() || (uvs[idx1] == Vec2{} && uvs[idx2] == Vec2{} &&
+                                uvs[idx3] == Vec2{})) {
+                auto t = Normalize(pos2 - pos1);
+                tangent = Vec4{t.x, t.y, t.z, 1};
+            } else {
+                auto [tan, _] = GetNormalMapTB(pos1, pos2, pos3, uvs[idx1],
+                                               uvs[idx2], uvs[idx3]);
+                tangent = Vec4{tan.x, tan.y, tan.z, 1};
+            }
+            out_tangents[idx1] = tangent;
+            out_tangents[idx2] = tangent;
+            out_tangents[idx3] = tangent;
+        });
+}
+
+// read float vector attribute, normalized integer data is mapped to [0, 1]
+template <typename T>
+static std::vector<T> readAccessor(const tinygltf::Model& model,
+                                   int accessor_idx, int type) {
+    auto& accessor = model.accessors[accessor_idx];
+    std::vector<T> result(accessor.count);
+    if (accessor.bufferView == -1) {
+        LOGW("accessor {} has no buffer view, filled with zero", accessor_idx);
+        return result;
+    }
+
+    std::vector<unsigned char> buffer;
+    CopyBufferFromGLTF<float>(buffer, type, accessor, model);
+    NICKEL_ASSERT(buffer.size() == result.size() * sizeof(T));
+    memcpy(result.data(), buffer.data(), buffer.size());
+
+    if (accessor.normalized) {
+        float scale = 1.0f;
+        switch (accessor.componentType) {
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                scale = 1.0f / std::numeric_limits<uint8_t>::max();
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                scale = 1.0f / std::numeric_limits<uint16_t>::max();
+                break;
+            case TINYGLTF_COMPONENT_TYPE_BYTE:
+                scale = 1.0f / std::numeric_limits<int8_t>::max();
+                break;
+            case TINYGLTF_COMPONENT_TYPE_SHORT:
+                scale = 1.0f / std::numeric_limits<int16_t>::max();
+                break;
+        }
+        for (auto& elem : result) {
+            elem = elem * scale;
+        }
+    }
+    return result;
+}
+
+static std::vector<uint32_t> readIndexAccessor(const tinygltf::Model& model,
+                                               int accessor_idx) {
+    auto& accessor = model.accessors[accessor_idx];
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW({}, accessor.bufferView != -1,
+                                      "index accessor {} has no buffer view",
+                                      accessor_idx);
+    std::vector<unsigned char> buffer;
+    CopyBufferFromGLTF<uint32_t>(buffer, TINYGLTF_TYPE_SCALAR, accessor,
+                                 model);
+    std::vector<uint32_t> indices(accessor.count);
+    memcpy(indices.data(), buffer.data(), buffer.size());
+    return indices;
+}
+
+// attributes not matching vertex count are ignored like missing ones
+template <typename T>
+static std::vector<T> readVertexAttribute(const tinygltf::Model& model,
+                                          const tinygltf::Primitive& prim,
+                                          const std::string& name, int type,
+                                          size_t vertex_count) {
+    auto it = prim.attributes.find(name);
+    if (it == prim.attributes.end()) {
+        return {};
+    }
+    auto result = readAccessor<T>(model, it->second, type);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW({}, result.size() == vertex_count,
+                                      "ignore {} of primitive, {} elements "
+                                      "but {} vertices",
+                                      name, result.size(), vertex_count);
+    return result;
+}
+
+template <typename T>
+static std::vector<T> unweld(const std::vector<T>& attribute,
+                             std::span<const uint32_t> indices) {
+    if (attribute.empty()) {
+        return {};
+    }
+    std::vector<T> result;
+    result.reserve(indices.size());
+    for (uint32_t index : indices) {
+        result.push_back(attribute[index]);
+    }
+    return result;
+}
+
+// weights renormalized to unorm16, rounding error goes to the largest
+static GLTFSkinVertex packSkinVertex(const Vec4& joints, const Vec4& weights) {
+    GLTFSkinVertex vertex;
+    float sum = 0;
+    for (int i = 0; i < 4; i++) {
+        sum += std::max(weights[i], 0.0f);
+    }
+    if (sum <= 0) {
+        vertex.m_joints[0] = joints[0];
+        vertex.m_weights[0] = std::numeric_limits<uint16_t>::max();
+        return vertex;
+    }
+
+    int32_t total = 0, largest = 0;
+    for (int i = 0; i < 4; i++) {
+        vertex.m_joints[i] = joints[i];
+        vertex.m_weights[i] = std::lround(std::max(weights[i], 0.0f) / sum *
+                                          std::numeric_limits<uint16_t>::max());
+        total += vertex.m_weights[i];
+        if (vertex.m_weights[i] > vertex.m_weights[largest]) {
+            largest = i;
+        }
+    }
+    vertex.m_weights[largest] +=
+        std::numeric_limits<uint16_t>::max() - total;
+    return vertex;
+}
+
+bool BuildPrimitiveGeometry(const tinygltf::Model& model,
+                            const tinygltf::Primitive& prim,
+                            const MeshOptimizeConfig& config,
+                            GLTFPrimitiveGeometry& out_geometry) {
+    auto& attrs = prim.attributes;
+    auto pos_it = attrs.find("POSITION");
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(false, pos_it != attrs.end(),
+                                      "skip primitive without POSITION");
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(
+        false, prim.mode == TINYGLTF_MODE_TRIANGLES || prim.mode == -1,
+        "skip primitive of mode {}, only triangle list supported", prim.mode);
+
+    auto positions =
+        readAccessor<Vec3>(model, pos_it->second, TINYGLTF_TYPE_VEC3);
+    std::vector<uint32_t> indices;
+    if (prim.indices != -1) {
+        indices = readIndexAccessor(model, prim.indices);
+    } else {
+        indices.resize(positions.size());
+        std::iota(indices.begin(), indices.end(), 0);
+    }
+    indices.resize(indices.size() / 3 * 3);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(
+        false,
+        std::all_of(indices.begin(), indices.end(),
+                    [&](uint32_t index) { return index < positions.size(); }),
+        "skip primitive with index out of range");
+
+    auto uvs = readVertexAttribute<Vec2>(model, prim, "TEXCOORD_0",
+                                         TINYGLTF_TYPE_VEC2, positions.size());
+    auto normals = readVertexAttribute<Vec3>(
+        model, prim, "NORMAL", TINYGLTF_TYPE_VEC3, positions.size());
+    auto tangents = readVertexAttribute<Vec4>(
+        model, prim, "TANGENT", TINYGLTF_TYPE_VEC4, positions.size());
+    auto joints = readVertexAttribute<Vec4>(
+        model, prim, "JOINTS_0", TINYGLTF_TYPE_VEC4, positions.size());
+    auto weights = readVertexAttribute<Vec4>(
+        model, prim, "WEIGHTS_0", TINYGLTF_TYPE_VEC4, positions.size());
+    bool skinned = !joints.empty() && !weights.empty();
+
+    if (normals.empty()) {
+        // flat normals: shared vertices would take the normal of whichever
+        // triangle comes last
+        positions = unweld(positions, indices);
+        uvs = unweld(uvs, indices);
+        tangents = unweld(tangents, indices);
+        joints = unweld(joints, indices);
+        weights = unweld(weights, indices);
+        std::iota(indices.begin(), indices.end(), 0);
+
+        normals.resize(positions.size());
+        GenerateNormals(positions, {}, normals);
+        for (auto& normal : normals) {
+            float length = Length(normal);
+            normal = length > 0 ? normal / length : Vec3{0, 0, 1};
+        }
+    }
+    if (tangents.empty()) {
+        tangents.resize(positions.size());
+        GenerateTangents(positions, uvs, indices, tangents);
+    }
+
+    std::vector<GLTFVertex> vertices(positions.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        auto& vertex = vertices[i];
+        vertex.m_position = positions[i];
+        if (!uvs.empty()) {
+            vertex.m_uv = uvs[i];
+        }
+        vertex.m_normal = normals[i];
+        vertex.m_tangent = tangents[i];
+    }
+    std::vector<uint32_t> origin;
+    if (skinned) {
+        MeshOptimizeConfig skinned_config = config;
+        skinned_config.m_deduplicate = false;
+        OptimizeMesh(vertices, indices, skinned_config, &origin);
+    } else {
+        OptimizeMesh(vertices, indices, config);
+    }
+    out_geometry.m_lods = GenerateLODs(vertices, indices, config);
+    if (config.m_build_meshlets && !skinned &&
+        indices.size() / 3 >= MeshletMinTriangles) {
+        std::vector<Vec3> optimized_positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            optimized_positions[i] = vertices[i].m_position;
+        }
+        out_geometry.m_meshlets = BuildMeshlets(optimized_positions, indices);
+    }
+
+    constexpr float Max = std::numeric_limits<float>::max();
+    constexpr float Lowest = std::numeric_limits<float>::lowest();
+    out_geometry.m_bounds_min = Vec3{Max, Max, Max};
+    out_geometry.m_bounds_max = Vec3{Lowest, Lowest, Lowest};
+    for (auto& vertex : vertices) {
+        for (int i = 0; i < 3; i++) {
+            out_geometry.m_bounds_min[i] =
+                std::min(out_geometry.m_bounds_min[i], vertex.m_position[i]);
+            out_geometry.m_bounds_max[i] =
+                std::max(out_geometry.m_bounds_max[i], vertex.m_position[i]);
+        }
+    }
+
+    out_geometry.m_skin_vertices.clear();
+    if (skinned) {
+        out_geometry.m_skin_vertices.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            out_geometry.m_skin_vertices[i] =
+                packSkinVertex(joints[origin[i]], weights[origin[i]]);
+        }
+    }
+
+    out_geometry.m_vertex_count = vertices.size();
+    out_geometry.m_indices = std::move(indices);
+    if (config.m_quantize && !skinned) {
+        out_geometry.m_layout = VertexLayout::Quantized;
+        out_geometry.m_vertices.resize(vertices.size() *
+                                       sizeof(GLTFQuantizedVertex));
+        auto dst = (GLTFQuantizedVertex*)out_geometry.m_vertices.data();
+        for (size_t i = 0; i < vertices.size(); i++) {
+            dst[i] = QuantizeVertex(vertices[i]);
+        }
+    } else {
+        out_geometry.m_layout = VertexLayout::Float;
+        out_geometry.m_vertices.resize(vertices.size() * sizeof(GLTFVertex));
+        memcpy(out_geometry.m_vertices.data(), vertices.data(),
+               out_geometry.m_vertices.size());
+    }
+    return true;
+}
+
+void AppendPrimitiveGeometry(const GLTFPrimitiveGeometry& geometry,
+                             std::vector<unsigned char>& vertex_buffer,
+                             std::vector<unsigned char>& index_buffer,
+                             Primitive& out_prim) {
+    // keep every stream aligned for vertex/index buffer binding offsets
+    auto append = [](std::vector<unsigned char>& dst, const void* data,
+                     size_t size, uint32_t count) {
+        dst.resize((dst.size() + 3) / 4 * 4);
+        BufferView view;
+        view.m_offset = dst.size();
+        view.m_size = size;
+        view.m_count = count;
+        dst.insert(dst.end(), (const unsigned char*)data,
+                   (const unsigned char*)data + size);
+        return view;
+    };
+
+    out_prim.m_vertex_layout = geometry.m_layout;
+    out_prim.m_vertex_buf_view =
+        append(vertex_buffer, geometry.m_vertices.data(),
+               geometry.m_vertices.size(), geometry.m_vertex_count);
+
+    bool short_indices =
+        geometry.m_vertex_count <= std::numeric_limits<uint16_t>::max();
+    auto appendIndices = [&](std::span<const uint32_t> indices) {
+        if (short_indices) {
+            std::vector<uint16_t> narrowed{indices.begin(), indices.end()};
+            return append(index_buffer, narrowed.data(),
+                          narrowed.size() * sizeof(uint16_t), narrowed.size());
+        }
+        return append(index_buffer, indices.data(),
+                      indices.size() * sizeof(uint32_t), indices.size());
+    };
+
+    out_prim.m_index_type =
+        short_indices ? IndexType::Uint16 : IndexType::Uint32;
+    out_prim.m_indices_buf_view = appendIndices(geometry.m_indices);
+    out_prim.m_lods.clear();
+    for (auto& lod : geometry.m_lods) {
+        out_prim.m_lods.push_back({appendIndices(lod.m_indices), lod.m_error});
+    }
+
+    PackMeshlets(geometry.m_meshlets, out_prim);
+
+    out_prim.m_skin_buf_view = {};
+    if (!geometry.m_skin_vertices.empty()) {
+        out_prim.m_skin_buf_view =
+            append(vertex_buffer, geometry.m_skin_vertices.data(),
+                   geometry.m_skin_vertices.size() * sizeof(GLTFSkinVertex),
+                   geometry.m_skin_vertices.size());
+    }
+
+    out_prim.m_bounds_min = geometry.m_bounds_min;
+    out_prim.m_bounds_max = geometry.m_bounds_max;
+}
+
+static Quat normalizeQuat(const Vec4& q) {
+    float length = Length(q);
+    if (length <= 0) {
+        return {};
+    }
+    return Quat(q.x / length, q.y / length, q.z / length, q.w / length);
+}
+
+static Vec4 quat2Vec(const Quat& q) {
+    return Vec4{q.v.x, q.v.y, q.v.z, q.w};
+}
+
+static Quat slerp(const Quat& a, const Quat& b, float t) {
+    Vec4 va = quat2Vec(a), vb = quat2Vec(b);
+    float cos = Dot(va, vb);
+    if (cos < 0) {
+        vb = -vb;
+        cos = -cos;
+    }
+    float wa = 1 - t, wb = t;
+    // nearly parallel, sin(theta) is too small to divide by
+    if (cos < 0.9995f) {
+        float theta = std::acos(cos);
+        float sin = std::sin(theta);
+        wa = std::sin((1 - t) * theta) / sin;
+        wb = std::sin(t * theta) / sin;
+    }
+    return normalizeQuat(va * wa + vb * wb);
+}
+
+// translation, rotation & scale of an affine matrix without shear
+static void decomposeTRS(const Mat44& m, Vec3& out_translation,
+                         Quat& out_rotation, Vec3& out_scale) {
+    out_translation = Vec3(m[3].x, m[3].y, m[3].z);
+    Vec3 c0(m[0].x, m[0].y, m[0].z), c1(m[1].x, m[1].y, m[1].z),
+        c2(m[2].x, m[2].y, m[2].z);
+    out_scale = Vec3(Length(c0), Length(c1), Length(c2));
+    c0 = c0 / out_scale.x;
+    c1 = c1 / out_scale.y;
+    c2 = c2 / out_scale.z;
+
+    float trace = c0.x + c1.y + c2.z;
+    Vec4 q;
+    if (trace > 0) {
+        float k = 0.5f / std::sqrt(trace + 1);
+        q = Vec4{(c1.z - c2.y) * k, (c2.x - c0.z) * k, (c0.y - c1.x) * k,
+                 0.25f / k};
+    } else if (c0.x > c1.y && c0.x > c2.z) {
+        float k = 2 * std::sqrt(1 + c0.x - c1.y - c2.z);
+        q = Vec4{0.25f * k, (c1.x + c0.y) / k, (c2.x + c0.z) / k,
+                 (c1.z - c2.y) / k};
+    } else if (c1.y > c2.z) {
+        float k = 2 * std::sqrt(1 + c1.y - c0.x - c2.z);
+        q = Vec4{(c1.x + c0.y) / k, 0.25f * k, (c2.y + c1.z) / k,
+                 (c2.x - c0.z) / k};
+    } else {
+        float k = 2 * std::sqrt(1 + c2.z - c0.x - c1.y);
+        q = Vec4{(c2.x + c0.z) / k, (c2.y + c1.z) / k, 0.25f * k,
+                 (c0.y - c1.x) / k};
+    }
+    out_rotation = normalizeQuat(q);
+}
+
+static void nodeTRS(const tinygltf::Node& node, Vec3& out_translation,
+                    Quat& out_rotation, Vec3& out_scale) {
+    if (!node.matrix.empty()) {
+        decomposeTRS(CalcNodeTransform(node), out_translation, out_rotation,
+                     out_scale);
+        return;
+    }
+    out_translation = node.translation.empty()
+                          ? Vec3{}
+                          : Vec3(node.translation[0], node.translation[1],
+                                 node.translation[2]);
+    out_rotation = node.rotation.empty()
+                       ? Quat{}
+                       : Quat(node.rotation[0], node.rotation[1],
+                              node.rotation[2], node.rotation[3]);
+    out_scale = node.scale.empty()
+                    ? Vec3(1, 1, 1)
+                    : Vec3(node.scale[0], node.scale[1], node.scale[2]);
+}
+
+static std::unordered_map<int, uint32_t> mapNode2Joint(
+    const tinygltf::Skin& skin) {
+    std::unordered_map<int, uint32_t> node2joint;
+    for (uint32_t i = 0; i < skin.joints.size(); i++) {
+        node2joint[skin.joints[i]] = i;
+    }
+    return node2joint;
+}
+
+Skeleton LoadSkeleton(const tinygltf::Model& model,
+                      const tinygltf::Skin& skin) {
+    uint32_t joint_count = skin.joints.size();
+    Skeleton skeleton;
+    skeleton.m_joint_names.resize(joint_count);
+    skeleton.m_parents.resize(joint_count, -1);
+    skeleton.m_inverse_bind_matrices.resize(joint_count, Mat44::Identity());
+    skeleton.m_root_transforms.resize(joint_count, Mat44::Identity());
+    skeleton.m_rest_pose.resize(GetJointGroupCount(joint_count));
+
+    if (skin.inverseBindMatrices != -1) {
+        auto matrices = readAccessor<Mat44>(model, skin.inverseBindMatrices,
+                                            TINYGLTF_TYPE_MAT4);
+        if (matrices.size() == joint_count) {
+            skeleton.m_inverse_bind_matrices = std::move(matrices);
+        } else {
+            LOGW("skin {} has {} inverse bind matrices but {} joints, use "
+                 "identity",
+                 skin.name, matrices.size(), joint_count);
+        }
+    }
+
+    std::vector<int> node_parents(model.nodes.size(), -1);
+    for (int i = 0; i < model.nodes.size(); i++) {
+        for (int child : model.nodes[i].children) {
+            node_parents[child] = i;
+        }
+    }
+
+    auto node2joint = mapNode2Joint(skin);
+    std::vector<uint32_t> depths(joint_count);
+    for (uint32_t i = 0; i < joint_count; i++) {
+        auto& node = model.nodes[skin.joints[i]];
+        skeleton.m_joint_names[i] = node.name;
+
+        Vec3 translation, scale;
+        Quat rotation;
+        nodeTRS(node, translation, rotation, scale);
+        SetJointTransform(skeleton.m_rest_pose, i, translation, rotation,
+                          scale);
+
+        Mat44 root_transform = Mat44::Identity();
+        int parent = node_parents[skin.joints[i]];
+        while (parent != -1 && !node2joint.contains(parent)) {
+            root_transform =
+                CalcNodeTransform(model.nodes[parent]) * root_transform;
+            parent = node_parents[parent];
+        }
+        if (parent == -1) {
+            skeleton.m_root_transforms[i] = root_transform;
+        } else {
+            if (root_transform != Mat44::Identity()) {
+                LOGW("non-joint node between joints of skin {} is ignored",
+                     skin.name);
+            }
+            skeleton.m_parents[i] = node2joint[parent];
+        }
+    }
+
+    for (uint32_t i = 0; i < joint_count; i++) {
+        for (int32_t parent = skeleton.m_parents[i]; parent != -1;
+             parent = skeleton.m_parents[parent]) {
+            depths[i]++;
+        }
+    }
+    skeleton.m_order.resize(joint_count);
+    std::iota(skeleton.m_order.begin(), skeleton.m_order.end(), 0);
+    std::stable_sort(
+        skeleton.m_order.begin(), skeleton.m_order.end(),
+        [&](uint32_t a, uint32_t b) { return depths[a] < depths[b]; });
+    return skeleton;
+}
+
+// evaluate a sampler at `time`, cubic spline values are
+// (in-tangent, value, out-tangent) triplets
+template <typename T, typename F>
+static T sampleChannel(std::span<const float> times, std::span<const T> values,
+                       const std::string& interpolation, float time,
+                       F&& lerp) {
+    bool cubic = interpolation == "CUBICSPLINE";
+    auto value = [&](size_t key) { return values[cubic ? key * 3 + 1 : key]; };
+
+    size_t key = std::upper_bound(times.begin(), times.end(), time) -
+                 times.begin();
+    if (key == 0) {
+        return value(0);
+    }
+    if (key == times.size()) {
+        return value(times.size() - 1);
+    }
+
+    size_t key0 = key - 1;
+    float dt = times[key] - times[key0];
+    float t = dt > 0 ? (time - times[key0]) / dt : 0;
+    if (interpolation == "STEP") {
+        return value(key0);
+    }
+    if (!cubic) {
+        return lerp(value(key0), value(key), t);
+    }
+
+    float t2 = t * t, t3 = t2 * t;
+    return value(key0) * (2 * t3 - 3 * t2 + 1) +
+           values[key0 * 3 + 2] * (dt * (t3 - 2 * t2 + t)) +
+           value(key) * (-2 * t3 + 3 * t2) +
+           values[key * 3] * (dt * (t3 - t2));
+}
+
+AnimationClip LoadAnimationClip(const tinygltf::Model& model,
+                                const tinygltf::Animation& animation,
+                                const tinygltf::Skin& skin,
+                                const Skeleton& skeleton, float sample_rate) {
+    AnimationClip clip;
+    clip.m_name = animation.name;
+    clip.m_joint_count = skeleton.GetJointCount();
+
+    for (auto& sampler : animation.samplers) {
+        auto& accessor = model.accessors[sampler.input];
+        if (!accessor.maxValues.empty()) {
+            clip.m_duration =
+                std::max<float>(clip.m_duration, accessor.maxValues[0]);
+        } else {
+            auto times =
+                readAccessor<float>(model, sampler.input, TINYGLTF_TYPE_SCALAR);
+            if (!times.empty()) {
+                clip.m_duration = std::max(clip.m_duration, times.back());
+            }
+        }
+    }
+
+    uint32_t frame_count =
+        std::max<uint32_t>(2, std::lround(clip.m_duration * sample_rate) + 1);
+    clip.m_sample_rate =
+        clip.m_duration > 0 ? (frame_count - 1) / clip.m_duration : sample_rate;
+
+    uint32_t groups = GetJointGroupCount(clip.m_joint_count);
+    clip.m_frames.reserve(frame_count * groups);
+    for (uint32_t i = 0; i < frame_count; i++) {
+        clip.m_frames.insert(clip.m_frames.end(), skeleton.m_rest_pose.begin(),
+                             skeleton.m_rest_pose.end());
+    }
+
+    auto node2joint = mapNode2Joint(skin);
+    auto lerpVec3 = [](const Vec3& a, const Vec3& b, float t) {
+        return a + (b - a) * t;
+    };
+    auto slerpVec4 = [](const Vec4& a, const Vec4& b, float t) {
+        return quat2Vec(slerp(normalizeQuat(a), normalizeQuat(b), t));
+    };
+
+    for (auto& channel : animation.channels) {
+        auto it = node2joint.find(channel.target_node);
+        if (it == node2joint.end() || channel.target_path == "weights") {
+            continue;
+        }
+        uint32_t joint = it->second;
+        auto& sampler = animation.samplers[channel.sampler];
+        auto times =
+            readAccessor<float>(model, sampler.input, TINYGLTF_TYPE_SCALAR);
+        if (times.empty()) {
+            LOGW("animation {} has empty channel", animation.name);
+            continue;
+        }
+        bool rotation = channel.target_path == "rotation";
+        std::vector<Vec3> vec3_values;
+        std::vector<Vec4> vec4_values;
+        size_t value_count;
+        if (rotation) {
+            vec4_values =
+                readAccessor<Vec4>(model, sampler.output, TINYGLTF_TYPE_VEC4);
+            value_count = vec4_values.size();
+        } else {
+            vec3_values =
+                readAccessor<Vec3>(model, sampler.output, TINYGLTF_TYPE_VEC3);
+            value_count = vec3_values.size();
+        }
+        size_t keys_per_time = sampler.interpolation == "CUBICSPLINE" ? 3 : 1;
+        if (value_count != times.size() * keys_per_time) {
+            LOGW("animation {} channel has {} values for {} keys",
+                 animation.name, value_count, times.size());
+            continue;
+        }
+
+        for (uint32_t i = 0; i < frame_count; i++) {
+            std::span frame{clip.m_frames.data() + i * groups, groups};
+            float time = std::min(i / clip.m_sample_rate, clip.m_duration);
+            Vec3 translation, scale;
+            Quat rot;
+            GetJointTransform(frame, joint, translation, rot, scale);
+            if (rotation) {
+                rot = normalizeQuat(sampleChannel<Vec4>(
+                    times, vec4_values, sampler.interpolation, time,
+                    slerpVec4));
+            } else {
+                Vec3 value =
+                    sampleChannel<Vec3>(times, vec3_values,
+                                        sampler.interpolation, time, lerpVec3);
+                (channel.target_path == "scale" ? scale : translation) = value;
+            }
+            SetJointTransform(frame, joint, translation, rot, scale);
+        }
+    }
+    return clip;
+}
+
+std::vector<GLTFSkin> LoadSkins(const tinygltf::Model& model) {
+    std::vector<GLTFSkin> skins;
+    skins.reserve(model.skins.size());
+    for (auto& skin : model.skins) {
+        GLTFSkin& result = skins.emplace_back();
+        result.m_skeleton = LoadSkeleton(model, skin);
+        for (auto& animation : model.animations) {
+            result.m_clips.push_back(LoadAnimationClip(
+                model, animation, skin, result.m_skeleton));
+        }
+    }
+    return skins;
+}
+
+static std::unique_ptr<GLTFParsedModel> parseCookedModel(
+    std::unique_ptr<GLTFParsedModel> parsed,
+    std::span<const unsigned char> data) {
+    auto& view = parsed->m_cooked_view;
+    view = CookedModelView{data};
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(nullptr, view.IsValid(),
+                                      "load cooked model {} failed",
+                                      parsed->m_filename);
+
+    Path root_dir = parsed->m_filename.ParentPath();
+    for (auto& image : view.GetImages()) {
+        // keep image indices, empty uri stays an empty filename
+        GLTFImageLoadInfo info;
+        auto uri = view.GetString(image.m_uri);
+        if (!uri.empty()) {
+            info.m_filename = root_dir / Path{uri};
+            info.m_format = image.m_is_color ? Format::R8G8B8A8_SRGB
+                                             : Format::R8G8B8A8_UNORM;
+        }
+        parsed->m_images.push_back(std::move(info));
+    }
+    return parsed;
+}
+
+std::unique_ptr<GLTFParsedModel> ParseGLTFModel(const Path& filename,
+                                                std::vector<char>&& content) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(nullptr, !content.empty(), "read ",
+                                      filename, " failed");
+
+    auto parsed = std::make_unique<GLTFParsedModel>();
+    parsed->m_filename = filename;
+    if (filename.Extension() == Path{CookedModelExtension}) {
+        parsed->m_content = std::move(content);
+        std::span data{(const unsigned char*)parsed->m_content.data(),
+                       parsed->m_content.size()};
+        return parseCookedModel(std::move(parsed), data);
+    }
+
+    tinygltf::TinyGLTF tiny_gltf_loader;
+    std::string err, warn;
+    if (!tiny_gltf_loader.LoadASCIIFromString(
+            &parsed->m_gltf_model, &err, &warn, content.data(),
+            content.size(), filename.ParentPath().ToString())) {
+        LOGE("load model from {} failed: \n\terr: {}\n\twarn: {}", filename,
+             err, warn);
+        return nullptr;
+    }
+
+    if (parsed->m_gltf_model.nodes.empty()) {
+        LOGE("load model from {} failed: no nodes", filename);
+        return nullptr;
+    }
+
+    parsed->m_images =
+        GLTFLoader{parsed->m_gltf_model}.CollectImages(filename.ParentPath());
+    return parsed;
+}
+
+std::unique_ptr<GLTFParsedModel> ParseGLTFFile(const Path& filename) {
+    if (filename.Extension() == Path{CookedModelExtension}) {
+        // upload straight from the mapped pages, read the whole file only
+        // where mapping is not possible (e.g. android apk assets)
+        MappedFile mapped_file{filename};
+        if (mapped_file) {
+            auto parsed = std::make_unique<GLTFParsedModel>();
+            parsed->m_filename = filename;
+            parsed->m_mapped_file = std::move(mapped_file);
+            auto data = parsed->m_mapped_file.GetData();
+            return parseCookedModel(std::move(parsed), data);
+        }
+    }
+    return ParseGLTFModel(filename, ReadWholeFile(filename));
+}
+
+GLTFLoader::GLTFLoader(const tinygltf::Model& model,
+                       const MeshOptimizeConfig& optimize_config)
+    : m_gltf_model{model}, m_optimize_config{optimize_config} {}
 
 GLTFLoadData GLTFLoader::Load(const Path& filename, const Adapter& adapter,
                               GLTFManagerImpl& gltf_manager) {
@@ -50,22 +875,7 @@ GLTFLoadData GLTFLoader::loadGLTF(const Path& filename, const Adapter& adapter,
         gltf_manager.m_model_resource_allocator.Allocate(&gltf_manager);
     GLTFModelResourceImpl* resource = load_data.m_resource.GetImpl();
 
-    size_t totle_buffer_size = std::accumulate(
-        m_gltf_model.buffers.begin(), m_gltf_model.buffers.end(), 0,
-        [&](size_t acc, const tinygltf::Buffer& buffer) {
-            return acc + buffer.data.size();
-        });
-    std::vector<unsigned char> buffer;
-    buffer.reserve(totle_buffer_size);
-
-    std::vector<BufferView> buffer_accessors;
-    buffer_accessors.reserve(m_gltf_model.accessors.size());
-
-    std::set<uint32_t> color_textures, metallic_roughness_textures,
-        normal_textures, occlusion_textures, emmisive_textures;
-    analyzeImageUsage(color_textures, normal_textures, occlusion_textures,
-                      metallic_roughness_textures, emmisive_textures);
-    auto textures = loadTextures(root_dir, texture_mgr, color_textures);
+    auto textures = loadTextures(CollectImages(root_dir), texture_mgr);
     auto samplers = loadSamplers(device);
 
     std::vector<Material3D::Descriptor> mtl_desces;
@@ -78,21 +888,11 @@ GLTFLoadData GLTFLoader::loadGLTF(const Path& filename, const Adapter& adapter,
 
     load_data.m_meshes.reserve(m_gltf_model.meshes.size());
 
-    std::set<uint32_t> vertex_accessors, index_accessors;
-    size_t vertex_buffer_size{}, index_buffer_size{};
-    analyzeAccessorUsage(vertex_accessors, index_accessors, vertex_buffer_size,
-                         index_buffer_size);
-    resource->m_cpu_data.vertex_buffer.reserve(vertex_buffer_size);
-    resource->m_cpu_data.indices_buffer.reserve(index_buffer_size);
-    auto accessors = loadVertexBuffer(resource->m_cpu_data.vertex_buffer,
-                                      resource->m_cpu_data.indices_buffer,
-                                      vertex_accessors, index_accessors);
-
     for (auto& m : m_gltf_model.meshes) {
         Mesh mesh =
             createMesh(m, &gltf_manager, resource->m_cpu_data.vertex_buffer,
-                       resource->m_cpu_data.indices_buffer, accessors,
-                       materials, *gltf_manager.m_default_material);
+                       resource->m_cpu_data.indices_buffer, materials,
+                       *gltf_manager.m_default_material);
         load_data.m_meshes.push_back(mesh);
     }
 
@@ -112,18 +912,43 @@ GLTFLoadData GLTFLoader::loadGLTF(const Path& filename, const Adapter& adapter,
             if (prim.m_indices_buf_view.m_size > 0) {
                 prim.m_indices_buf_view.m_buffer = gpu_index_buffer;
             }
-            prim.m_norm_buf_view.m_buffer = gpu_vertex_buffer;
-            prim.m_pos_buf_view.m_buffer = gpu_vertex_buffer;
-            prim.m_tan_buf_view.m_buffer = gpu_vertex_buffer;
-            prim.m_uv_buf_view.m_buffer = gpu_vertex_buffer;
+            for (auto& lod : prim.m_lods) {
+                lod.m_indices_buf_view.m_buffer = gpu_index_buffer;
+            }
+            prim.m_vertex_buf_view.m_buffer = gpu_vertex_buffer;
+            if (prim.m_skin_buf_view.m_size > 0) {
+                prim.m_skin_buf_view.m_buffer = gpu_vertex_buffer;
+            }
         }
     }
 
+    resource->m_skins = LoadSkins(m_gltf_model);
+
+    resource->m_gpu_size = resource->m_cpu_data.vertex_buffer.size() +
+                           resource->m_cpu_data.indices_buffer.size() +
+                           pbr_parameter_buffer.size();
     load_data.m_resource = resource;
 
     return load_data;
 }
 
+GLTFCPUData GLTFLoader::LoadCPUData() const {
+    GLTFCPUData data;
+    for (auto& mtl : m_gltf_model.materials) {
+        data.pbr_parameters.push_back(parsePBRParameters(mtl));
+    }
+
+    // same order as `createMesh`, so primitives land at the same offsets
+    for (auto& mesh : m_gltf_model.meshes) {
+        for (auto& prim : mesh.primitives) {
+            Primitive primitive;
+            recordPrimGeometry(data.vertex_buffer, data.indices_buffer, prim,
+                               primitive);
+        }
+    }
+    return data;
+}
+
 Material3D::TextureInfo GLTFLoader::parseTextureInfo(
     int idx, std::vector<Texture>& textures, ImageView& default_texture,
     std::vector<Sampler>& samplers, Sampler& default_sampler) {
@@ -131,7 +956,8 @@ Material3D::TextureInfo GLTFLoader::parseTextureInfo(
     const tinygltf::Texture* info =
         idx == -1 ? nullptr : &m_gltf_model.textures[idx];
     if (info && info->source != -1) {
-        texture_info.image = textures[info->source].GetImpl()->m_view;
+        texture_info.texture = textures[info->source];
+        texture_info.image = texture_info.texture.GetImpl()->m_view;
     } else {
         texture_info.image = default_texture;
     }
@@ -145,12 +971,7 @@ Material3D::TextureInfo GLTFLoader::parseTextureInfo(
 
 Sampler GLTFLoader::createSampler(Device device,
                                   const tinygltf::Sampler& gltfSampler) {
-    Sampler::Descriptor desc;
-    desc.m_min_filter = GLTFFilter2RHI(gltfSampler.minFilter);
-    desc.m_mag_filter = GLTFFilter2RHI(gltfSampler.magFilter);
-    desc.m_address_mode_u = GLTFWrapper2RHI(gltfSampler.wrapS);
-    desc.m_address_mode_v = GLTFWrapper2RHI(gltfSampler.wrapT);
-    return device.CreateSampler(desc);
+    return device.CreateSampler(GLTFSampler2Descriptor(gltfSampler));
 }
 
 template <typename ComponentType>
@@ -181,278 +1002,39 @@ Mesh GLTFLoader::createMesh(const tinygltf::Mesh& gltf_mesh,
                             GLTFManagerImpl* mgr,
                             std::vector<unsigned char>& vertex_buffer,
                             std::vector<unsigned char>& indices_buffer,
-                            const std::vector<BufferView>& accessors,
                             std::vector<Material3D>& materials,
                             Material3DImpl& default_material) const {
     MeshImpl* newNode = mgr->m_mesh_allocator.Allocate(mgr);
     newNode->m_name = gltf_mesh.name;
 
     for (auto& primitive : gltf_mesh.primitives) {
-        auto prim = recordPrimInfo(vertex_buffer, indices_buffer, accessors,
-                                   primitive, materials, default_material);
-        newNode->m_primitives.emplace_back(prim);
-    }
-
-    return newNode;
-}
-
-Primitive GLTFLoader::recordPrimInfo(
-    std::vector<unsigned char>& vertex_buffer,
-    std::vector<unsigned char>& indices_buffer,
-    const std::vector<BufferView>& buffer_views,
-    const tinygltf::Primitive& prim, std::vector<Material3D>& materials,
-    Material3DImpl& default_material) const {
-    Primitive primitive;
-
-    auto& attrs = prim.attributes;
-    if (auto it = attrs.find("POSITION"); it != attrs.end()) {
-        primitive.m_pos_buf_view = buffer_views[it->second];
-    }
-
-    if (prim.indices != -1) {
-        auto& accessor = m_gltf_model.accessors[prim.indices];
-
-        if (accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-            primitive.m_index_type = IndexType::Uint16;
-        } else if (accessor.componentType ==
-                   TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-            primitive.m_index_type = IndexType::Uint32;
-        } else {
-            NICKEL_CANT_REACH();
-        }
-        primitive.m_indices_buf_view = buffer_views[prim.indices];
-    }
-
-    bool has_uv = true;
-    if (auto it = attrs.find("TEXCOORD_0"); it != attrs.end()) {
-        primitive.m_uv_buf_view = buffer_views[it->second];
-    } else {
-        // some trivial data
-        primitive.m_uv_buf_view = primitive.m_pos_buf_view;
-        has_uv = false;
-    }
-
-    const BufferView& position_buffer_view = primitive.m_pos_buf_view;
-
-    if (auto it = attrs.find("NORMAL"); it != attrs.end()) {
-        primitive.m_norm_buf_view = buffer_views[it->second];
-    } else {
-        size_t old_size = vertex_buffer.size();
-        uint32_t pos_count = position_buffer_view.m_count;
-        size_t size = pos_count * sizeof(Vec3);
-        vertex_buffer.resize(vertex_buffer.size() + size, 0);
-        Vec3* norm_ptr = (Vec3*)(vertex_buffer.data() + old_size);
-
-        BufferView view;
-        view.m_count = pos_count;
-        view.m_size = size;
-        view.m_offset = old_size;
-        primitive.m_norm_buf_view = view;
-
-        auto posPtr =
-            (const Vec3*)(vertex_buffer.data() + position_buffer_view.m_offset);
-        if (primitive.m_indices_buf_view) {
-            const BufferView& indices_buffer_view =
-                primitive.m_indices_buf_view;
-            auto indices_ptr =
-                indices_buffer.data() + indices_buffer_view.m_offset;
-
-            for (int i = 0; i < indices_buffer_view.m_count / 3; i++) {
-                auto idx1 = indices_ptr[i * 3];
-                auto idx2 = indices_ptr[i * 3 + 1];
-                auto idx3 = indices_ptr[i * 3 + 2];
-
-                auto pos1 = posPtr[idx1];
-                auto pos2 = posPtr[idx2];
-                auto pos3 = posPtr[idx3];
-                auto normal = Cross(Normalize(pos2 - pos1), pos3 - pos1);
-                norm_ptr[idx1] = normal;
-                norm_ptr[idx2] = normal;
-                norm_ptr[idx3] = normal;
-            }
-        } else {
-            for (int i = 0; i < position_buffer_view.m_count / 3; i++) {
-                auto pos1 = posPtr[i * 3];
-                auto pos2 = posPtr[i * 3 + 1];
-                auto pos3 = posPtr[i * 3 + 2];
-                auto normal = Cross(Normalize(pos2 - pos1), pos3 - pos1);
-                norm_ptr[i * 3] = normal;
-                norm_ptr[i * 3 + 1] = normal;
-                norm_ptr[i * 3 + 2] = normal;
-            }
-        }
-    }
+        Primitive prim;
+        NICKEL_CONTINUE_IF_FALSE(recordPrimGeometry(
+            vertex_buffer, indices_buffer, primitive, prim));
 
-    if (auto it = attrs.find("TANGENT"); it != attrs.end()) {
-        primitive.m_tan_buf_view = buffer_views[it->second];
-    } else {
-        size_t old_size = vertex_buffer.size();
-        uint32_t pos_count = position_buffer_view.m_count;
-        size_t size = pos_count * sizeof(Vec4);
-        vertex_buffer.resize(vertex_buffer.size() + size, 0);
-
-        BufferView view;
-        view.m_count = pos_count;
-        view.m_size = size;
-        view.m_offset = old_size;
-        primitive.m_tan_buf_view = view;
-
-        const BufferView& uv_buffer_view = primitive.m_uv_buf_view;
-
-        auto posPtr =
-            (const Vec3*)(vertex_buffer.data() + position_buffer_view.m_offset);
-        auto uvPtr =
-            (const Vec2*)(vertex_buffer.data() + uv_buffer_view.m_offset);
-        auto tanPtr = (Vec4*)(vertex_buffer.data() + view.m_offset);
-
-        if (primitive.m_indices_buf_view.m_size > 0) {
-            const BufferView& indices_buffer_view =
-                primitive.m_indices_buf_view;
-            auto indicesPtr = (const uint16_t*)(indices_buffer.data() +
-                                                indices_buffer_view.m_offset);
-            NICKEL_ASSERT(indices_buffer_view.m_count % 3 == 0,
-                          "indices must be triangle list");
-            for (int i = 0; i < indices_buffer_view.m_count / 3; i++) {
-                uint32_t idx1, idx2, idx3;
-                switch (primitive.m_index_type) {
-                    case IndexType::Uint16:
-                        idx1 = *(indicesPtr + i * 3);
-                        idx2 = *(indicesPtr + i * 3 + 1);
-                        idx3 = *(indicesPtr + i * 3 + 2);
-                        break;
-                    case IndexType::Uint32:
-                        idx1 = *(indicesPtr + 2 * (i * 3));
-                        idx2 = *(indicesPtr + 2 * (i * 3 + 1));
-                        idx3 = *(indicesPtr + 2 * (i * 3 + 2));
-                        break;
-                }
-
-                auto uv1 = *(uvPtr + idx1);
-                auto uv2 = *(uvPtr + idx2);
-                auto uv3 = *(uvPtr + idx3);
-
-                auto pos1 = *(posPtr + idx1);
-                auto pos2 = *(posPtr + idx2);
-                auto pos3 = *(posPtr + idx3);
-
-                Vec4 tangent;
-
-                if (!has_uv ||
-                    (uv1 == Vec2{} && uv2 == Vec2{} && uv3 == Vec2{})) {
-                    auto t = Normalize(pos2 - pos1);
-                    tangent.x = t.x;
-                    tangent.y = t.y;
-                    tangent.z = t.z;
-                    tangent.w = 1;
-                } else {
-                    auto [tan, _] =
-                        GetNormalMapTB(pos1, pos2, pos3, uv1, uv2, uv3);
-
-                    tangent = Vec4{tan.x, tan.y, tan.z, 1};
-                }
-                *(tanPtr + idx1) = tangent;
-                *(tanPtr + idx2) = tangent;
-                *(tanPtr + idx3) = tangent;
-            }
+        if (primitive.material != -1) {
+            prim.m_material = materials[primitive.material];
         } else {
-            NICKEL_ASSERT(primitive.m_pos_buf_view.m_count % 3 == 0,
-                          "vertices must be triangle list");
-            for (int i = 0; i < primitive.m_pos_buf_view.m_count / 3; i++) {
-                uint32_t idx1 = i * 3, idx2 = i * 3 + 1, idx3 = i * 3 + 2;
-                auto uv1 = *(uvPtr + idx1);
-                auto uv2 = *(uvPtr + idx2);
-                auto uv3 = *(uvPtr + idx3);
-
-                auto pos1 = *(posPtr + idx1);
-                auto pos2 = *(posPtr + idx2);
-                auto pos3 = *(posPtr + idx3);
-
-                Vec4 tangent;
-
-                if (!has_uv ||
-                    (uv1 == Vec2{} && uv2 == Vec2{} && uv3 == Vec2{})) {
-                    auto t = Normalize(pos2 - pos1);
-                    tangent.x = t.x;
-                    tangent.y = t.y;
-                    tangent.z = t.z;
-                    tangent.w = 1;
-                } else {
-                    auto [tan, _] =
-                        GetNormalMapTB(pos1, pos2, pos3, uv1, uv2, uv3);
-
-                    tangent = Vec4{tan.x, tan.y, tan.z, 1};
-                }
-                *(tanPtr + idx1) = tangent;
-                *(tanPtr + idx2) = tangent;
-                *(tanPtr + idx3) = tangent;
-            }
+            default_material.IncRefcount();
+            prim.m_material = Material3D{&default_material};
         }
+        newNode->m_primitives.emplace_back(prim);
     }
 
-    default_material.IncRefcount();
-    Material3D mtl{&default_material};
-    primitive.m_material = prim.material != -1 ? materials[prim.material] : mtl;
-
-    return primitive;
+    return newNode;
 }
 
-void GLTFLoader::analyzeAccessorUsage(std::set<uint32_t>& out_vertex_accessors,
-                                      std::set<uint32_t>& out_index_accessors,
-                                      size_t& out_vertex_buffer_size,
-                                      size_t& out_index_buffer_size) {
-    for (auto& mesh : m_gltf_model.meshes) {
-        uint32_t vertex_count{};
-        for (auto& primitive : mesh.primitives) {
-            if (auto it = primitive.attributes.find("POSITION");
-                it != primitive.attributes.end()) {
-                out_vertex_accessors.insert(it->second);
-
-                auto& accessor = m_gltf_model.accessors[it->second];
-                vertex_count = accessor.count;
-            }
-            out_vertex_buffer_size += sizeof(Vec3) * vertex_count;
-
-            if (auto it = primitive.attributes.find("TEXCOORD_0");
-                it != primitive.attributes.end()) {
-                out_vertex_accessors.insert(it->second);
-
-                auto& accessor = m_gltf_model.accessors[it->second];
-                out_vertex_buffer_size +=
-                    accessor.count *
-                    tinygltf::GetComponentSizeInBytes(accessor.componentType) *
-                    tinygltf::GetNumComponentsInType(accessor.type);
-            }
-            out_vertex_buffer_size += sizeof(Vec2) * vertex_count;
-
-            if (auto it = primitive.attributes.find("NORMAL");
-                it != primitive.attributes.end()) {
-                out_vertex_accessors.insert(it->second);
-
-                auto& accessor = m_gltf_model.accessors[it->second];
-                out_vertex_buffer_size +=
-                    accessor.count *
-                    tinygltf::GetComponentSizeInBytes(accessor.componentType) *
-                    tinygltf::GetNumComponentsInType(accessor.type);
-            }
-            out_vertex_buffer_size += sizeof(Vec3) * vertex_count;
-
-            if (auto it = primitive.attributes.find("TANGENT");
-                it != primitive.attributes.end()) {
-                out_vertex_accessors.insert(it->second);
-            }
-            out_vertex_buffer_size += sizeof(Vec4) * vertex_count;
-
-            if (primitive.indices != -1) {
-                out_index_accessors.insert(primitive.indices);
-
-                auto& accessor = m_gltf_model.accessors[primitive.indices];
-                out_index_buffer_size +=
-                    accessor.count *
-                    tinygltf::GetNumComponentsInType(accessor.type) *
-                    tinygltf::GetComponentSizeInBytes(accessor.componentType);
-            }
-        }
+bool GLTFLoader::recordPrimGeometry(std::vector<unsigned char>& vertex_buffer,
+                                    std::vector<unsigned char>& indices_buffer,
+                                    const tinygltf::Primitive& prim,
+                                    Primitive& out_prim) const {
+    GLTFPrimitiveGeometry geometry;
+    if (!BuildPrimitiveGeometry(m_gltf_model, prim, m_optimize_config,
+                                geometry)) {
+        return false;
     }
+    AppendPrimitiveGeometry(geometry, vertex_buffer, indices_buffer, out_prim);
+    return true;
 }
 
 void GLTFLoader::analyzeImageUsage(
@@ -482,36 +1064,67 @@ void GLTFLoader::analyzeImageUsage(
     }
 }
 
-std::vector<Texture> GLTFLoader::loadTextures(
-    const Path& root_dir, TextureManager& texture_mgr,
-    const std::set<uint32_t>& color_textures) {
-    std::vector<Texture> textures;
-    textures.reserve(m_gltf_model.images.size());
+std::vector<GLTFImageLoadInfo> GLTFLoader::CollectImages(
+    const Path& root_dir) const {
+    std::set<uint32_t> color_textures, metallic_roughness_textures,
+        normal_textures, occlusion_textures, emmisive_textures;
+    analyzeImageUsage(color_textures, normal_textures, occlusion_textures,
+                      metallic_roughness_textures, emmisive_textures);
+
+    std::vector<GLTFImageLoadInfo> images;
+    images.reserve(m_gltf_model.images.size());
     for (int i = 0; i < m_gltf_model.images.size(); i++) {
-        auto& image = m_gltf_model.images[i];
-        Format fmt = Format::R8G8B8A8_UNORM;
+        GLTFImageLoadInfo info;
+        info.m_filename =
+            root_dir / Path{ParseURI2Path(m_gltf_model.images[i].uri)};
         if (color_textures.contains(i)) {
-            fmt = Format::R8G8B8A8_SRGB;
+            info.m_format = Format::R8G8B8A8_SRGB;
+        }
+        images.push_back(std::move(info));
+    }
+    return images;
+}
+
+std::vector<Texture> GLTFLoader::loadTextures(
+    std::span<const GLTFImageLoadInfo> images, TextureManager& texture_mgr) {
+    std::vector<Texture> textures;
+    textures.reserve(images.size());
+    for (auto& image : images) {
+        // may be shared with other models or loaded by `LoadAsync`
+        if (auto texture = texture_mgr.Find(image.m_filename)) {
+            textures.push_back(texture);
+        } else {
+            textures.push_back(
+                texture_mgr.Load(image.m_filename, image.m_format));
         }
-        textures.emplace_back(
-            texture_mgr.Load(root_dir / Path{ParseURI2Path(image.uri)}, fmt));
     }
     return textures;
 }
 
 std::vector<Sampler> GLTFLoader::loadSamplers(Device& device) {
+    // equal samplers of this and other models are shared by the device
     std::vector<Sampler> samplers;
     for (auto& sampler : m_gltf_model.samplers) {
-        Sampler::Descriptor desc;
-        desc.m_min_filter = GLTFFilter2RHI(sampler.minFilter);
-        desc.m_mag_filter = GLTFFilter2RHI(sampler.magFilter);
-        desc.m_address_mode_u = GLTFWrapper2RHI(sampler.wrapS);
-        desc.m_address_mode_v = GLTFWrapper2RHI(sampler.wrapT);
-        samplers.emplace_back(device.CreateSampler(desc));
+        samplers.emplace_back(createSampler(device, sampler));
     }
     return samplers;
 }
 
+PBRParameters GLTFLoader::parsePBRParameters(
+    const tinygltf::Material& mtl) const {
+    PBRParameters pbr_param;
+
+    auto& colorFactor = mtl.pbrMetallicRoughness.baseColorFactor;
+    pbr_param.m_base_color.r = colorFactor[0];
+    pbr_param.m_base_color.g = colorFactor[1];
+    pbr_param.m_base_color.b = colorFactor[2];
+    pbr_param.m_base_color.a = colorFactor[3];
+
+    pbr_param.m_metallic = mtl.pbrMetallicRoughness.metallicFactor;
+    pbr_param.m_roughness = mtl.pbrMetallicRoughness.roughnessFactor;
+    return pbr_param;
+}
+
 std::vector<Material3D> GLTFLoader::loadMaterials(
     const Adapter& adapter, GLTFManagerImpl& gltf_mgr,
     GLTFRenderPass& render_pass, std::vector<PBRParameters>& pbr_parameters,
@@ -522,33 +1135,21 @@ std::vector<Material3D> GLTFLoader::loadMaterials(
     std::vector<Material3D::Descriptor> mtl_desces;
     std::vector<Material3D> materials;
 
-    // load material
     for (auto& mtl : m_gltf_model.materials) {
-        // Material3D material;
-        auto align = adapter.GetLimits().min_uniform_buffer_offset_alignment;
-        Material3D::Descriptor desc;
+        pbr_parameters.push_back(parsePBRParameters(mtl));
+    }
+    auto pbr_parameter_offsets = PackPBRParameters(
+        pbr_parameters,
+        adapter.GetLimits().min_uniform_buffer_offset_alignment, data_buffer);
 
-        uint32_t pbr_parameter_offset =
-            std::ceil(data_buffer.size() / (float)align) * align;
-        uint32_t pbr_parameter_size = sizeof(PBRParameters);
-        data_buffer.resize(pbr_parameter_offset + pbr_parameter_size);
+    // load material
+    for (size_t i = 0; i < m_gltf_model.materials.size(); i++) {
+        auto& mtl = m_gltf_model.materials[i];
+        Material3D::Descriptor desc;
         desc.pbrParameters.m_count = 1;
-        desc.pbrParameters.m_offset = pbr_parameter_offset;
-        desc.pbrParameters.m_size = pbr_parameter_size;
-
-        PBRParameters pbr_param;
-
-        auto& colorFactor = mtl.pbrMetallicRoughness.baseColorFactor;
-        pbr_param.m_base_color.r = colorFactor[0];
-        pbr_param.m_base_color.g = colorFactor[1];
-        pbr_param.m_base_color.b = colorFactor[2];
-        pbr_param.m_base_color.a = colorFactor[3];
-
-        pbr_param.m_metallic = mtl.pbrMetallicRoughness.metallicFactor;
-        pbr_param.m_roughness = mtl.pbrMetallicRoughness.roughnessFactor;
-
-        memcpy(data_buffer.data() + pbr_parameter_offset, &pbr_param,
-               sizeof(PBRParameters));
+        desc.pbrParameters.m_offset = pbr_parameter_offsets[i];
+        desc.pbrParameters.m_size = sizeof(PBRParameters);
+        desc.pbrParameterValues = pbr_parameters[i];
 
         desc.basicTexture = parseTextureInfo(
             mtl.pbrMetallicRoughness.baseColorTexture.index, textures,
@@ -568,7 +1169,6 @@ std::vector<Material3D> GLTFLoader::loadMaterials(
             samplers, common_res.m_default_sampler);
 
         mtl_desces.push_back(std::move(desc));
-        pbr_parameters.push_back(pbr_param);
     }
 
     Buffer pbr_parameter_buffer;
@@ -581,69 +1181,12 @@ std::vector<Material3D> GLTFLoader::loadMaterials(
             desc.pbr_param_buffer = pbr_parameter_buffer;
             materials.push_back(Material3D{gltf_mgr.m_mtl_allocator.Allocate(
                 &gltf_mgr, desc, common_res.m_camera_buffer,
-                common_res.m_view_buffer, render_pass.GetBindGroupLayout())});
+                common_res.m_view_buffer, render_pass.GetBindGroupLayout(),
+                render_pass.GetBindlessTable())});
         }
     }
 
     return materials;
 }
 
-std::vector<BufferView> GLTFLoader::loadVertexBuffer(
-    std::vector<unsigned char>& out_vertex_buffer,
-    std::vector<unsigned char>& out_index_buffer,
-    const std::set<uint32_t>& vertex_accessor,
-    const std::set<uint32_t>& index_accessor) const {
-    NICKEL_ASSERT(out_vertex_buffer.empty());
-
-    std::vector<BufferView> views;
-    views.reserve(m_gltf_model.accessors.size());
-
-    for (int i = 0; i < m_gltf_model.accessors.size(); i++) {
-        std::vector<unsigned char>* buffer =
-            index_accessor.contains(i) ? &out_index_buffer : &out_vertex_buffer;
-
-        auto& accessor = m_gltf_model.accessors[i];
-        BufferView buffer_view;
-        switch (accessor.componentType) {
-            case TINYGLTF_COMPONENT_TYPE_INT:
-                buffer_view = CopyBufferFromGLTF<int>(*buffer, accessor.type,
-                                                      accessor, m_gltf_model);
-                break;
-            case TINYGLTF_COMPONENT_TYPE_BYTE:
-                buffer_view = CopyBufferFromGLTF<char>(*buffer, accessor.type,
-                                                       accessor, m_gltf_model);
-                break;
-            case TINYGLTF_COMPONENT_TYPE_FLOAT:
-                buffer_view = CopyBufferFromGLTF<float>(*buffer, accessor.type,
-                                                        accessor, m_gltf_model);
-                break;
-            case TINYGLTF_COMPONENT_TYPE_DOUBLE:
-                buffer_view = CopyBufferFromGLTF<double>(
-                    *buffer, accessor.type, accessor, m_gltf_model);
-                break;
-            case TINYGLTF_COMPONENT_TYPE_SHORT:
-                buffer_view = CopyBufferFromGLTF<short>(*buffer, accessor.type,
-                                                        accessor, m_gltf_model);
-                break;
-            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-                buffer_view = CopyBufferFromGLTF<uint32_t>(
-                    *buffer, accessor.type, accessor, m_gltf_model);
-                break;
-            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                buffer_view = CopyBufferFromGLTF<uint16_t>(
-                    *buffer, accessor.type, accessor, m_gltf_model);
-                break;
-            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                buffer_view = CopyBufferFromGLTF<uint8_t>(
-                    *buffer, accessor.type, accessor, m_gltf_model);
-                break;
-            default:
-                NICKEL_CANT_REACH();
-        }
-        views.push_back(buffer_view);
-    }
-
-    return views;
-}
-
-}  // namespace nickel::graphics
\ No newline at end of file
+}  // namespace nickel::graphics
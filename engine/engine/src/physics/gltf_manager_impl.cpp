@@ -1,26 +1,39 @@
 #include "nickel/graphics/internal/gltf_manager_impl.hpp"
 #include "nickel/common/common.hpp"
 #include "nickel/common/macro.hpp"
+#include "nickel/fs/mapped_file.hpp"
 #include "nickel/graphics/common_resource.hpp"
 #include "nickel/graphics/gltf_draw.hpp"
+#include "nickel/graphics/internal/context_impl.hpp"
 #include "nickel/graphics/internal/gltf_loader.hpp"
 #include "nickel/graphics/internal/gltf_model_impl.hpp"
 #include "nickel/graphics/internal/mesh_impl.hpp"
+#include "nickel/graphics/internal/texture_impl.hpp"
 #include "nickel/nickel.hpp"
 
 namespace nickel::graphics {
 
+static PBRParameters cookedPBRParameters(const CookedMaterial& mtl) {
+    PBRParameters param;
+    param.m_base_color = Vec4{mtl.m_base_color[0], mtl.m_base_color[1],
+                              mtl.m_base_color[2], mtl.m_base_color[3]};
+    param.m_metallic = mtl.m_metallic;
+    param.m_roughness = mtl.m_roughness;
+    return param;
+}
+
 GLTFManagerImpl::GLTFManagerImpl(Device device, CommonResource& res,
                                  GLTFRenderPass& gltf_render_pass) {
+    PBRParameters param;
+    param.m_base_color = Vec4(1, 1, 1, 1);
+    param.m_metallic = 0.3;
+    param.m_roughness = 0.3;
+
     {
         Buffer::Descriptor desc;
         desc.m_memory_type = MemoryType::GPULocal;
         desc.m_usage = Flags{BufferUsage::Uniform} | BufferUsage::CopyDst;
         desc.m_size = sizeof(PBRParameters);
-        PBRParameters param;
-        param.m_base_color = Vec4(1, 1, 1, 1);
-        param.m_metallic = 0.3;
-        param.m_roughness = 0.3;
         m_default_pbr_param_buffer = device.CreateBuffer(desc);
         m_default_pbr_param_buffer.BuffData(&param, sizeof(param), 0);
     }
@@ -39,9 +52,11 @@ GLTFManagerImpl::GLTFManagerImpl(Device device, CommonResource& res,
         desc.pbrParameters.m_offset = 0;
         desc.pbrParameters.m_size = sizeof(PBRParameters);
         desc.pbrParameters.m_count = 1;
+        desc.pbrParameterValues = param;
         m_default_material = m_mtl_allocator.Allocate(
             this, desc, res.m_camera_buffer, res.m_view_buffer,
-            gltf_render_pass.GetBindGroupLayout());
+            gltf_render_pass.GetBindGroupLayout(),
+            gltf_render_pass.GetBindlessTable());
     }
 }
 
@@ -56,34 +71,109 @@ GLTFManagerImpl::~GLTFManagerImpl() {
 
 bool GLTFManagerImpl::Load(const Path& filename,
                            const GLTFLoadConfig& load_config) {
-    auto content = ReadWholeFile(filename);
-    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(false, !content.empty(), "read ",
-                                      filename, " failed");
+    auto parsed = ParseGLTFFile(filename);
+    return parsed && loadParsed(*parsed, load_config);
+}
 
-    tinygltf::TinyGLTF tiny_gltf_loader;
-    std::string err, warn;
-    tinygltf::Model gltf_model;
-    if (!tiny_gltf_loader.LoadASCIIFromString(
-            &gltf_model, &err, &warn, content.data(), content.size(),
-            filename.ParentPath().ToString())) {
-        LOGE("load model from {} failed: \n\terr: {}\n\twarn: {}", filename,
-             err, warn);
-        return false;
+AsyncHandle<GLTFModel> GLTFManagerImpl::LoadAsync(
+    const Path& filename, const GLTFLoadConfig& load_config) {
+    for (auto& pending : m_pending_models) {
+        if (pending.m_filename == filename) {
+            return pending.m_handle;
+        }
+    }
+    if (load_config.m_combine_mesh) {
+        if (auto it = m_models.find(getModelName(filename));
+            it != m_models.end()) {
+            it->second->IncRefcount();
+            return AsyncHandle<GLTFModel>::CreateReady(GLTFModel{it->second});
+        }
     }
 
-    if (gltf_model.nodes.empty()) {
-        LOGE("load model from {} failed: no nodes", filename);
-        return false;
+    PendingModel pending;
+    pending.m_filename = filename;
+    pending.m_config = load_config;
+    pending.m_handle = AsyncHandle<GLTFModel>::CreatePending();
+    pending.m_parse_future = nickel::Context::GetInst().GetThreadPool().Submit(
+        [filename]() -> std::shared_ptr<GLTFParsedModel> {
+            return ParseGLTFFile(filename);
+        });
+    m_pending_models.push_back(std::move(pending));
+    return m_pending_models.back().m_handle;
+}
+
+void GLTFManagerImpl::Update() {
+    auto& texture_mgr = nickel::Context::GetInst().GetTextureManager();
+    for (auto it = m_pending_models.begin(); it != m_pending_models.end();) {
+        auto& pending = *it;
+        if (!pending.m_parsed) {
+            if (pending.m_parse_future.wait_for(std::chrono::seconds{0}) !=
+                std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            pending.m_parsed = pending.m_parse_future.get();
+            if (!pending.m_parsed) {
+                pending.m_handle.Fail();
+                it = m_pending_models.erase(it);
+                continue;
+            }
+
+            // images of all pending models decode in parallel
+            for (auto& image : pending.m_parsed->m_images) {
+                if (!image.m_filename.IsEmpty()) {
+                    pending.m_textures.push_back(
+                        texture_mgr.LoadAsync(image.m_filename, image.m_format));
+                }
+            }
+        }
+
+        if (std::ranges::any_of(pending.m_textures, [](auto& texture) {
+                return texture.IsPending();
+            })) {
+            ++it;
+            continue;
+        }
+
+        if (!loadParsed(*pending.m_parsed, pending.m_config)) {
+            pending.m_handle.Fail();
+        } else if (!pending.m_config.m_combine_mesh) {
+            pending.m_handle.Resolve({});
+        } else {
+            GLTFModelImpl* model = m_models[getModelName(pending.m_filename)];
+            model->IncRefcount();
+            pending.m_handle.Resolve(GLTFModel{model});
+        }
+        it = m_pending_models.erase(it);
     }
+}
+
+bool GLTFManagerImpl::HasPendingLoad() const {
+    return !m_pending_models.empty();
+}
+
+bool GLTFManagerImpl::loadParsed(const GLTFParsedModel& parsed,
+                                 const GLTFLoadConfig& load_config) {
+    return parsed.IsCooked() ? loadCooked(parsed, load_config)
+                             : loadGLTF(parsed, load_config);
+}
 
-    GLTFLoader loader(gltf_model);
+bool GLTFManagerImpl::loadGLTF(const GLTFParsedModel& parsed,
+                               const GLTFLoadConfig& load_config) {
+    auto& filename = parsed.m_filename;
+    auto& gltf_model = parsed.m_gltf_model;
+    GLTFLoader loader(gltf_model, load_config.m_mesh_optimize);
     auto load_data = loader.Load(
         filename, nickel::Context::GetInst().GetGPUAdapter(), *this);
 
-    Path pure_filename = filename.Filename().ReplaceExtension("");
-    Path parent_dir = filename.ParentPath();
-    std::string final_name = (parent_dir / pure_filename).ToString();
-    std::replace(final_name.begin(), final_name.end(), '\\', '/');
+    GLTFModelResourceImpl* resource = load_data.m_resource.GetImpl();
+    resource->m_filename = filename;
+    resource->m_mesh_optimize = load_config.m_mesh_optimize;
+    resource->ApplyCPUDataPolicy(load_config, load_data.m_meshes,
+                                 resource->m_cpu_data.vertex_buffer,
+                                 resource->m_cpu_data.indices_buffer);
+
+    std::string final_name = getModelName(filename);
     if (load_config.m_combine_mesh) {
         // NOTE: currently we only load one scene
         GLTFModelImpl* root_model_impl = m_model_allocator.Allocate(this);
@@ -113,6 +203,7 @@ bool GLTFManagerImpl::Load(const Path& filename,
             model->m_resource = load_data.m_resource;
             model->m_name = final_name + "." + node.name;
             model->m_transform = CalcNodeTransform(node);
+            model->m_skin = node.skin;
 
             if (auto it = m_models.find(model->m_name); it != m_models.end()) {
                 it->second->DecRefcount();
@@ -125,6 +216,353 @@ bool GLTFManagerImpl::Load(const Path& filename,
     return true;
 }
 
+bool GLTFManagerImpl::loadCooked(const GLTFParsedModel& parsed,
+                                 const GLTFLoadConfig& load_config) {
+    auto& filename = parsed.m_filename;
+    auto& view = parsed.m_cooked_view;
+
+    auto& ctx = nickel::Context::GetInst();
+    auto& adapter = ctx.GetGPUAdapter();
+    Device device = adapter.GetDevice();
+    auto& common_res = ctx.GetGraphicsContext().GetImpl()->GetCommonResource();
+    auto& render_pass = ctx.GetGraphicsContext().GetImpl()->GetGLTFRenderPass();
+    auto& texture_mgr = ctx.GetTextureManager();
+
+    std::vector<Texture> textures;
+    for (auto& image : parsed.m_images) {
+        if (image.m_filename.IsEmpty()) {
+            textures.emplace_back();
+        } else if (auto texture = texture_mgr.Find(image.m_filename)) {
+            textures.push_back(texture);
+        } else {
+            textures.push_back(
+                texture_mgr.Load(image.m_filename, image.m_format));
+        }
+    }
+
+    std::vector<Sampler> samplers;
+    for (auto& sampler : view.GetSamplers()) {
+        Sampler::Descriptor desc;
+        desc.m_min_filter = static_cast<Filter>(sampler.m_min_filter);
+        desc.m_mag_filter = static_cast<Filter>(sampler.m_mag_filter);
+        desc.m_mipmap_mode =
+            static_cast<SamplerMipmapMode>(sampler.m_mipmap_mode);
+        desc.m_max_lod = sampler.m_max_lod;
+        desc.m_address_mode_u =
+            static_cast<SamplerAddressMode>(sampler.m_address_mode_u);
+        desc.m_address_mode_v =
+            static_cast<SamplerAddressMode>(sampler.m_address_mode_v);
+        samplers.emplace_back(device.CreateSampler(desc));
+    }
+
+    GLTFModelResource resource = m_model_resource_allocator.Allocate(this);
+    auto& pbr_parameters = resource.GetImpl()->m_cpu_data.pbr_parameters;
+
+    auto textureInfo = [&](const CookedTextureRef& ref,
+                           ImageView& default_image) {
+        Material3D::TextureInfo info;
+        if (ref.m_image != -1 && textures[ref.m_image]) {
+            info.texture = textures[ref.m_image];
+            info.image = info.texture.GetImpl()->m_view;
+        } else {
+            info.image = default_image;
+        }
+        info.sampler = ref.m_sampler != -1 ? samplers[ref.m_sampler]
+                                           : common_res.m_default_sampler;
+        return info;
+    };
+
+    std::vector<Material3D> materials;
+    auto cooked_materials = view.GetMaterials();
+    if (!cooked_materials.empty()) {
+        for (auto& mtl : cooked_materials) {
+            pbr_parameters.push_back(cookedPBRParameters(mtl));
+        }
+        std::vector<unsigned char> pbr_param_data;
+        auto pbr_param_offsets = PackPBRParameters(
+            pbr_parameters,
+            adapter.GetLimits().min_uniform_buffer_offset_alignment,
+            pbr_param_data);
+
+        Buffer::Descriptor buffer_desc;
+        buffer_desc.m_memory_type = MemoryType::GPULocal;
+        buffer_desc.m_usage = Flags{BufferUsage::Uniform} | BufferUsage::CopyDst;
+        buffer_desc.m_size = pbr_param_data.size();
+        Buffer pbr_param_buffer = device.CreateBuffer(buffer_desc);
+        pbr_param_buffer.BuffData(pbr_param_data.data(), pbr_param_data.size(),
+                                  0);
+        resource.GetImpl()->m_gpu_size += pbr_param_data.size();
+
+        for (size_t i = 0; i < cooked_materials.size(); i++) {
+            auto& mtl = cooked_materials[i];
+            Material3D::Descriptor desc;
+            desc.pbr_param_buffer = pbr_param_buffer;
+            desc.pbrParameters.m_offset = pbr_param_offsets[i];
+            desc.pbrParameters.m_size = sizeof(PBRParameters);
+            desc.pbrParameters.m_count = 1;
+            desc.pbrParameterValues = pbr_parameters[i];
+            desc.basicTexture = textureInfo(mtl.m_base_color_texture,
+                                            common_res.m_default_image);
+            desc.metalicRoughnessTexture = textureInfo(
+                mtl.m_metallic_roughness_texture, common_res.m_white_image);
+            desc.normalTexture = textureInfo(
+                mtl.m_normal_texture, common_res.m_default_normal_image);
+            desc.occlusionTexture = textureInfo(mtl.m_occlusion_texture,
+                                                common_res.m_white_image);
+            materials.push_back(Material3D{m_mtl_allocator.Allocate(
+                this, desc, common_res.m_camera_buffer,
+                common_res.m_view_buffer, render_pass.GetBindGroupLayout(),
+                render_pass.GetBindlessTable())});
+        }
+    }
+
+    auto createGPUBuffer = [&](std::span<const unsigned char> src,
+                               BufferUsage usage) {
+        Buffer::Descriptor desc;
+        desc.m_memory_type = MemoryType::GPULocal;
+        desc.m_usage = Flags{usage} | BufferUsage::CopyDst;
+        desc.m_size = src.size();
+        Buffer buffer = device.CreateBuffer(desc);
+        buffer.BuffData((void*)src.data(), src.size(), 0);
+        return buffer;
+    };
+    Buffer vertex_buffer;
+    if (!view.GetVertexData().empty()) {
+        vertex_buffer =
+            createGPUBuffer(view.GetVertexData(), BufferUsage::Vertex);
+    }
+    Buffer index_buffer;
+    if (!view.GetIndexData().empty()) {
+        index_buffer = createGPUBuffer(view.GetIndexData(), BufferUsage::Index);
+    }
+
+    auto bufferView = [](const CookedBufferView& cooked, Buffer buffer) {
+        BufferView view;
+        if (cooked.m_size > 0) {
+            view.m_buffer = buffer;
+            view.m_offset = cooked.m_offset;
+            view.m_size = cooked.m_size;
+            view.m_count = cooked.m_count;
+        }
+        return view;
+    };
+
+    std::vector<Mesh> meshes;
+    for (auto& cooked_mesh : view.GetMeshes()) {
+        MeshImpl* mesh = m_mesh_allocator.Allocate(this);
+        mesh->m_name = view.GetString(cooked_mesh.m_name);
+        for (auto& cooked_prim : view.GetPrimitives(cooked_mesh)) {
+            Primitive prim;
+            prim.m_vertex_buf_view =
+                bufferView(cooked_prim.m_vertices, vertex_buffer);
+            prim.m_vertex_layout =
+                static_cast<VertexLayout>(cooked_prim.m_vertex_layout);
+            prim.m_indices_buf_view =
+                bufferView(cooked_prim.m_indices, index_buffer);
+            prim.m_index_type =
+                static_cast<IndexType>(cooked_prim.m_index_type);
+            for (auto& cooked_lod : view.GetPrimitiveLODs(cooked_prim)) {
+                prim.m_lods.push_back(
+                    {bufferView(cooked_lod.m_indices, index_buffer),
+                     cooked_lod.m_error});
+            }
+            std::vector<Meshlet> meshlets;
+            for (auto& cooked_meshlet : view.GetMeshlets(cooked_prim)) {
+                Meshlet meshlet;
+                meshlet.m_first_index = cooked_meshlet.m_first_index;
+                meshlet.m_index_count = cooked_meshlet.m_index_count;
+                meshlet.m_center =
+                    Vec3(cooked_meshlet.m_center[0], cooked_meshlet.m_center[1],
+                         cooked_meshlet.m_center[2]);
+                meshlet.m_radius = cooked_meshlet.m_radius;
+                meshlet.m_cone_axis = Vec3(cooked_meshlet.m_cone_axis[0],
+                                           cooked_meshlet.m_cone_axis[1],
+                                           cooked_meshlet.m_cone_axis[2]);
+                meshlet.m_cone_cutoff = cooked_meshlet.m_cone_cutoff;
+                meshlets.push_back(meshlet);
+            }
+            PackMeshlets(meshlets, prim);
+            prim.m_bounds_min =
+                Vec3(cooked_prim.m_bounds.m_min[0], cooked_prim.m_bounds.m_min[1],
+                     cooked_prim.m_bounds.m_min[2]);
+            prim.m_bounds_max =
+                Vec3(cooked_prim.m_bounds.m_max[0], cooked_prim.m_bounds.m_max[1],
+                     cooked_prim.m_bounds.m_max[2]);
+            if (cooked_prim.m_material != -1) {
+                prim.m_material = materials[cooked_prim.m_material];
+            } else {
+                m_default_material->IncRefcount();
+                prim.m_material = Material3D{m_default_material};
+            }
+            mesh->m_primitives.push_back(prim);
+        }
+        meshes.push_back(mesh);
+    }
+
+    // vertex & index data is uploaded from the package, never copied
+    resource.GetImpl()->m_filename = filename;
+    resource.GetImpl()->m_gpu_size +=
+        view.GetVertexData().size() + view.GetIndexData().size();
+    resource.GetImpl()->ApplyCPUDataPolicy(load_config, meshes,
+                                           view.GetVertexData(),
+                                           view.GetIndexData());
+
+    auto nodes = view.GetNodes();
+    if (load_config.m_combine_mesh) {
+        GLTFModelImpl* root_model_impl = m_model_allocator.Allocate(this);
+        for (auto node : view.GetRootNodes()) {
+            preorderCookedNode(view, node, resource, meshes, *root_model_impl);
+        }
+        if (root_model_impl->m_children.size() == 1) {
+            root_model_impl->DecRefcount();
+            root_model_impl = root_model_impl->m_children[0].GetImpl();
+            root_model_impl->IncRefcount();
+        }
+        m_models[getModelName(filename)] = root_model_impl;
+    } else {
+        std::string final_name = getModelName(filename);
+        for (auto node_idx : view.GetRootNodes()) {
+            auto& node = nodes[node_idx];
+            NICKEL_CONTINUE_IF_FALSE(node.m_mesh != -1);
+
+            GLTFModelImpl* model = m_model_allocator.Allocate(this);
+            model->m_mesh = meshes[node.m_mesh];
+            model->m_resource = resource;
+            model->m_name =
+                final_name + "." + std::string{view.GetString(node.m_name)};
+            memcpy(model->m_transform.Ptr(), node.m_transform, sizeof(Mat44));
+
+            if (auto it = m_models.find(model->m_name); it != m_models.end()) {
+                it->second->DecRefcount();
+                LOGE("model {} already loaded, will replace it", model->m_name);
+            }
+            m_models[model->m_name] = model;
+        }
+    }
+    return true;
+}
+
+std::string GLTFManagerImpl::getModelName(const Path& filename) {
+    Path pure_filename = filename.Filename().ReplaceExtension("");
+    Path parent_dir = filename.ParentPath();
+    std::string final_name = (parent_dir / pure_filename).ToString();
+    std::replace(final_name.begin(), final_name.end(), '\\', '/');
+    return final_name;
+}
+
+void GLTFManagerImpl::preorderCookedNode(const CookedModelView& view,
+                                         uint32_t node_idx,
+                                         const GLTFModelResource& resource,
+                                         std::span<Mesh> meshes,
+                                         GLTFModelImpl& parent_model) {
+    auto& node = view.GetNodes()[node_idx];
+    GLTFModelImpl* model = m_model_allocator.Allocate(this);
+    model->m_name = view.GetString(node.m_name);
+    memcpy(model->m_transform.Ptr(), node.m_transform, sizeof(Mat44));
+    if (node.m_mesh != -1) {
+        model->m_mesh = meshes[node.m_mesh];
+        model->m_resource = resource;
+    }
+    parent_model.m_children.push_back(model);
+
+    for (auto child : view.GetNodeChildren(node)) {
+        preorderCookedNode(view, child, resource, meshes,
+                           *parent_model.m_children.back().GetImpl());
+    }
+}
+
+GLTFModelResourceImpl* GLTFManagerImpl::findResource(
+    const GLTFModelImpl& model) {
+    if (model.m_resource) {
+        // handles share the resource, a const handle doesn't make it const
+        return const_cast<GLTFModelResourceImpl*>(model.m_resource.GetImpl());
+    }
+    // combined root without mesh, all nodes share one resource
+    for (auto& child : model.m_children) {
+        if (auto resource = findResource(*child.GetImpl())) {
+            return resource;
+        }
+    }
+    return nullptr;
+}
+
+bool GLTFManagerImpl::reloadCPUData(GLTFModelResourceImpl& resource) {
+    auto parsed = ParseGLTFFile(resource.m_filename);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, parsed,
+                                      "reload CPU data from {} failed",
+                                      resource.m_filename);
+
+    GLTFCPUData data;
+    if (parsed->IsCooked()) {
+        auto& view = parsed->m_cooked_view;
+        for (auto& mtl : view.GetMaterials()) {
+            data.pbr_parameters.push_back(cookedPBRParameters(mtl));
+        }
+        auto vertex_data = view.GetVertexData();
+        auto index_data = view.GetIndexData();
+        data.vertex_buffer.assign(vertex_data.begin(), vertex_data.end());
+        data.indices_buffer.assign(index_data.begin(), index_data.end());
+    } else {
+        data = GLTFLoader{parsed->m_gltf_model, resource.m_mesh_optimize}
+                   .LoadCPUData();
+    }
+    data.collision_meshes = std::move(resource.m_cpu_data.collision_meshes);
+    resource.m_cpu_data = std::move(data);
+    resource.m_cpu_data_released = false;
+    return true;
+}
+
+const GLTFCPUData* GLTFManagerImpl::AcquireCPUData(const GLTFModel& model) {
+    if (!model) {
+        return nullptr;
+    }
+    auto resource = findResource(*model.GetImpl());
+    if (!resource) {
+        return nullptr;
+    }
+
+    bool is_cooked =
+        resource->m_filename.Extension() == Path{CookedModelExtension};
+    if (!resource->m_cpu_data_released &&
+        !(is_cooked && resource->m_cpu_data.vertex_buffer.empty())) {
+        return &resource->m_cpu_data;
+    }
+    if (resource->m_cpu_data_policy == GLTFCPUDataPolicy::Release ||
+        !reloadCPUData(*resource)) {
+        return nullptr;
+    }
+    return &resource->m_cpu_data;
+}
+
+void GLTFManagerImpl::ReleaseCPUData(const GLTFModel& model) {
+    if (!model) {
+        return;
+    }
+    auto resource = findResource(*model.GetImpl());
+    if (!resource || resource->m_cpu_data_released) {
+        return;
+    }
+
+    bool is_cooked =
+        resource->m_filename.Extension() == Path{CookedModelExtension};
+    if (resource->m_cpu_data_policy != GLTFCPUDataPolicy::Keep || is_cooked) {
+        resource->m_cpu_data.Release();
+        resource->m_cpu_data_released = true;
+    }
+}
+
+GLTFMemoryStats GLTFManagerImpl::GetMemoryStats() const {
+    GLTFMemoryStats stats;
+    for (auto resource : m_resources) {
+        stats.m_cpu_size += resource->m_cpu_data.GetMemorySize();
+        stats.m_gpu_size += resource->m_gpu_size;
+        if (resource->m_cpu_data_released) {
+            stats.m_released_size += resource->m_released_size;
+        }
+    }
+    return stats;
+}
+
 GLTFModel GLTFManagerImpl::Find(const std::string& name) {
     if (auto it = m_models.find(name); it != m_models.end()) {
         return it->second;
@@ -180,6 +618,7 @@ void GLTFManagerImpl::preorderNode(const tinygltf::Model& gltf_model,
     if (gltf_node.mesh != -1) {
         model->m_mesh = meshes[gltf_node.mesh];
         model->m_resource = resource;
+        model->m_skin = gltf_node.skin;
     }
     parent_model.m_children.push_back(model);
 
@@ -0,0 +1,278 @@
+#include "nickel/physics/instrumentation.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/physics/internal/instrumentation_impl.hpp"
+
+#include "toml++/toml.hpp"
+
+#include <string_view>
+#include <unordered_map>
+
+namespace nickel::physics {
+
+static InstrumentationConfig parseInstrumentationConfig(
+    const toml::parse_result& parser, std::string_view source) {
+    InstrumentationConfig config;
+
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGW(
+        config, !parser.failed(),
+        "can't parse physics instrumentation config {}, instrumentation off",
+        source);
+    auto& tbl = parser.table();
+
+    if (auto mode = tbl.get_as<std::string>("mode")) {
+        const std::string& value = mode->get();
+        if (value == "off") {
+            config.m_mode = InstrumentationMode::Off;
+        } else if (value == "pvd_socket") {
+            config.m_mode = InstrumentationMode::PVDSocket;
+        } else if (value == "pvd_file") {
+            config.m_mode = InstrumentationMode::PVDFile;
+        } else if (value == "profile") {
+            config.m_mode = InstrumentationMode::Profile;
+        } else {
+            LOGW("unknown physics instrumentation mode {}, instrumentation off",
+                 value);
+        }
+    }
+
+    if (auto host = tbl.get_as<std::string>("pvd_host")) {
+        config.m_pvd_host = host->get();
+    }
+    if (auto port = tbl.get_as<int64_t>("pvd_port")) {
+        config.m_pvd_port = static_cast<uint32_t>(port->get());
+    }
+    if (auto timeout = tbl.get_as<int64_t>("pvd_timeout")) {
+        config.m_pvd_timeout = static_cast<uint32_t>(timeout->get());
+    }
+    if (auto file = tbl.get_as<std::string>("pvd_file")) {
+        config.m_pvd_file = file->get();
+    }
+    if (auto max_size = tbl.get_as<int64_t>("pvd_file_max_size")) {
+        config.m_pvd_file_max_size = static_cast<uint32_t>(max_size->get());
+    }
+    if (auto capacity = tbl.get_as<int64_t>("profile_capacity")) {
+        config.m_profile_capacity =
+            std::max<uint32_t>(static_cast<uint32_t>(capacity->get()), 1);
+    }
+    return config;
+}
+
+InstrumentationConfig InstrumentationConfig::LoadFromFile(
+    const Path& filename) {
+    return parseInstrumentationConfig(toml::parse_file(filename.ToString()),
+                                      filename.ToString());
+}
+
+InstrumentationConfig InstrumentationConfig::Parse(std::string_view content) {
+    return parseInstrumentationConfig(toml::parse(content), "content");
+}
+
+PhysicsProfiler::PhysicsProfiler(uint32_t capacity)
+    : m_records(std::max<uint32_t>(capacity, 1)) {}
+
+std::optional<PhysicsProfiler::Phase> PhysicsProfiler::classifyZone(
+    const char* name) {
+    // zone and task names of the vendored PhysX, nested zones are fine
+    static const std::unordered_map<std::string_view, Phase> zones = {
+        {"ScScene.broadPhase", Broadphase},
+        {"ScScene.broadPhaseFirstPass", Broadphase},
+        {"ScScene.broadPhaseSecondPass", Broadphase},
+        {"ScScene.updateBroadPhase", Broadphase},
+        {"ScScene.postBroadPhase", Broadphase},
+        {"ScScene.postBroadPhase2", Broadphase},
+        {"ScScene.postBroadPhase3", Broadphase},
+        {"ScScene.postBroadPhaseCont", Broadphase},
+        {"Basic.broadPhase", Broadphase},
+        {"Basic.broadPhaseFirstPass", Broadphase},
+        {"Basic.broadPhaseSecondPass", Broadphase},
+        {"Basic.updateBroadPhase", Broadphase},
+        {"Basic.postBroadPhase", Broadphase},
+        {"BroadPhaseABP - update", Broadphase},
+        {"ABP_InternalTask - update", Broadphase},
+        {"BroadPhase.SapUpdate", Broadphase},
+        {"BroadPhase.SapPostUpdate", Broadphase},
+        {"BpBroadphaseSap.batchUpdate", Broadphase},
+
+        {"ScScene.preRigidBodyNarrowPhase", Narrowphase},
+        {"ScScene.rigidBodyNarrowPhase", Narrowphase},
+        {"ScScene.secondPassNarrowPhase", Narrowphase},
+        {"ScScene.postNarrowPhase", Narrowphase},
+        {"ScScene.unblockNarrowPhase", Narrowphase},
+        {"Basic.narrowPhase", Narrowphase},
+        {"Sim.narrowPhase", Narrowphase},
+        {"Sim.queueNarrowPhase", Narrowphase},
+        {"Sim.secondPassNarrowPhase", Narrowphase},
+        {"Sim.narrowPhaseMerge", Narrowphase},
+        {"Sim.postNarrowPhaseSecondPass", Narrowphase},
+        {"PxsContext.contactManagerDiscreteUpdate", Narrowphase},
+
+        {"ScScene.rigidBodySolver", Solver},
+        {"Basic.rigidBodySolver", Solver},
+        {"Dynamics.solver", Solver},
+        {"Dynamics.solveGroup", Solver},
+        {"Dynamics.parallelSolve", Solver},
+        {"Dynamics.solverQueueTasks", Solver},
+        {"Dynamics.solverMergeResults", Solver},
+        {"Dynamics:solveIsland", Solver},
+        {"Dynamics:solveIslandParallel", Solver},
+        {"PxsDynamics.solverStart", Solver},
+        {"PxsDynamics.solverSetupSolve", Solver},
+        {"PxsDynamics.parallelSolver", Solver},
+        {"PxsDynamics.solverEnd", Solver},
+        {"SetupSolverConstraintsTask", Solver},
+        {"SetupSolverConstraintsSubTask", Solver},
+        {"SolveIslandTask", Solver},
+        {"ParallelSolveTask", Solver},
+        {"FinishSolveIslandTask", Solver},
+    };
+
+    auto it = zones.find(name);
+    if (it == zones.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+uint64_t PhysicsProfiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               Clock::now().time_since_epoch())
+        .count();
+}
+
+thread_local std::array<uint32_t, PhysicsProfiler::PhaseNum>
+    PhysicsProfiler::s_zone_depth{};
+
+void* PhysicsProfiler::zoneStart(const char* event_name, bool detached,
+                                 uint64_t) {
+    if (detached) {
+        return nullptr;
+    }
+    auto phase = classifyZone(event_name);
+    if (!phase || s_zone_depth[*phase]++ != 0) {
+        return nullptr;
+    }
+    return reinterpret_cast<void*>(now());
+}
+
+void PhysicsProfiler::zoneEnd(void* profiler_data, const char* event_name,
+                              bool detached, uint64_t) {
+    if (detached) {
+        return;
+    }
+    auto phase = classifyZone(event_name);
+    if (!phase) {
+        return;
+    }
+    s_zone_depth[*phase]--;
+    if (profiler_data) {
+        m_phase_time[*phase] +=
+            now() - reinterpret_cast<uint64_t>(profiler_data);
+    }
+}
+
+void PhysicsProfiler::BeginStep() {
+    for (auto& time : m_phase_time) {
+        time = 0;
+    }
+    m_step_begin = now();
+}
+
+void PhysicsProfiler::EndStep() {
+    constexpr float NsToMs = 1e-6f;
+
+    PhysicsStepTiming timing;
+    timing.m_step = m_step++;
+    timing.m_total = (now() - m_step_begin) * NsToMs;
+    timing.m_broadphase = m_phase_time[Broadphase] * NsToMs;
+    timing.m_narrowphase = m_phase_time[Narrowphase] * NsToMs;
+    timing.m_solver = m_phase_time[Solver] * NsToMs;
+
+    std::lock_guard lock{m_mutex};
+    m_records[m_head] = timing;
+    m_head = (m_head + 1) % m_records.size();
+    m_count = std::min<uint32_t>(m_count + 1, m_records.size());
+}
+
+void PhysicsProfiler::GetStepTimings(
+    std::vector<PhysicsStepTiming>& out) const {
+    std::lock_guard lock{m_mutex};
+    out.resize(m_count);
+    uint32_t begin = (m_head + m_records.size() - m_count) % m_records.size();
+    for (uint32_t i = 0; i < m_count; i++) {
+        out[i] = m_records[(begin + i) % m_records.size()];
+    }
+}
+
+PvdFileTransport::PvdFileTransport(const Path& filename, uint32_t max_size)
+    : m_filename{filename}, m_max_size{max_size} {}
+
+bool PvdFileTransport::connect() {
+    if (m_file.is_open()) {
+        return true;
+    }
+    // a reconnect keeps recording into the same capture
+    auto mode = std::ios::binary |
+                (m_written_size == 0 ? std::ios::trunc : std::ios::app);
+    m_file.open(m_filename.GetUnderlyingPath(), mode);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, m_file.is_open(),
+                                      "open PVD capture file {} failed",
+                                      m_filename);
+    return true;
+}
+
+void PvdFileTransport::disconnect() {
+    if (!m_file.is_open()) {
+        return;
+    }
+    m_file.close();
+    if (m_file.fail()) {
+        LOGE("write PVD capture to {} failed", m_filename);
+    } else {
+        LOGI("PVD capture written to {}", m_filename);
+    }
+}
+
+bool PvdFileTransport::isConnected() {
+    return m_file.is_open();
+}
+
+bool PvdFileTransport::write(const uint8_t* bytes, uint32_t length) {
+    if (!m_file.is_open()) {
+        return false;
+    }
+    if (m_written_size + length > m_max_size) {
+        if (!m_overflow_reported) {
+            LOGW("PVD capture exceeds {} bytes, rest of the capture dropped",
+                 m_max_size);
+            m_overflow_reported = true;
+        }
+        return true;
+    }
+    m_file.write(reinterpret_cast<const char*>(bytes), length);
+    m_written_size += length;
+    return m_file.good();
+}
+
+physx::PxPvdTransport& PvdFileTransport::lock() {
+    m_mutex.lock();
+    return *this;
+}
+
+void PvdFileTransport::unlock() {
+    m_mutex.unlock();
+}
+
+void PvdFileTransport::flush() {
+    m_file.flush();
+}
+
+uint64_t PvdFileTransport::getWrittenDataSize() {
+    return m_written_size;
+}
+
+void PvdFileTransport::release() {
+    disconnect();
+    delete this;
+}
+
+}  // namespace nickel::physics
@@ -43,6 +43,19 @@ CapsuleController Scene::CreateCapsuleController(
     return m_impl->CreateCapsuleController(desc);
 }
 
+void Scene::MoveControllers(std::span<const CCTMoveCommand> commands,
+                            std::span<Flags<CCTCollisionFlag>> out_flags) {
+    m_impl->MoveControllers(commands, out_flags);
+}
+
+void Scene::TakeSnapshot(SceneSnapshot& snapshot) const {
+    m_impl->TakeSnapshot(snapshot);
+}
+
+bool Scene::RestoreSnapshot(const SceneSnapshot& snapshot) {
+    return m_impl->RestoreSnapshot(snapshot);
+}
+
 void Scene::GC() {
     m_impl->GC();
 }
@@ -1,4 +1,5 @@
 #include "nickel/physics/internal/scene_impl.hpp"
+#include "nickel/common/macro.hpp"
 #include "nickel/physics/internal/cct_impl.hpp"
 #include "nickel/physics/internal/context_impl.hpp"
 #include "nickel/physics/internal/enum_convert.hpp"
@@ -91,8 +92,9 @@ OverlapHit HitTypeFromPhysX<OverlapHit, physx::PxOverlapHit>(
 
 SceneImpl::SceneImpl(const std::string& name, ContextImpl* ctx,
                      physx::PxScene* scene)
-    : m_scene{scene}, m_ctx{ctx} {
-    scene->setName(name.c_str());
+    : m_scene{scene}, m_ctx{ctx}, m_name{name} {
+    // PhysX keeps the pointer only
+    scene->setName(m_name.c_str());
 
     physx::PxPvdSceneClient* pvd_scene = scene->getScenePvdClient();
     if (pvd_scene) {
@@ -103,13 +105,19 @@ SceneImpl::SceneImpl(const std::string& name, ContextImpl* ctx,
     }
 
     LOGT("create cct manager");
-    m_cct_manager = PxCreateControllerManager(*scene);
+    // MoveControllers turns locking on while it moves controllers from
+    // several threads
+    m_cct_manager = PxCreateControllerManager(*scene, false);
     if (!m_cct_manager) {
         LOGE("physics cct create failed");
+    } else {
+        m_cct_batch =
+            std::make_unique<CharacterControllerBatch>(*scene, *m_cct_manager);
     }
 }
 
 SceneImpl::~SceneImpl() {
+    m_cct_batch.reset();
     m_capsule_controller_allocator.FreeAll();
 
     if (m_cct_manager) {
@@ -133,8 +141,15 @@ void SceneImpl::AddRigidActor(RigidActor& actor) {
 }
 
 void SceneImpl::Simulate(float delta_time) const {
+    PhysicsProfiler* profiler = m_ctx ? m_ctx->GetProfiler() : nullptr;
+    if (profiler) {
+        profiler->BeginStep();
+    }
     m_scene->simulate(delta_time);
     m_scene->fetchResults(true);
+    if (profiler) {
+        profiler->EndStep();
+    }
 }
 
 bool SceneImpl::Raycast(const Vec3& origin, const Vec3& unit_dir,
@@ -221,4 +236,10 @@ CapsuleController SceneImpl::CreateCapsuleController(
                                                    *this, desc);
 }
 
+void SceneImpl::MoveControllers(std::span<const CCTMoveCommand> commands,
+                                std::span<Flags<CCTCollisionFlag>> out_flags) {
+    NICKEL_RETURN_IF_FALSE_LOGE(m_cct_batch, "no cct manager in scene");
+    m_cct_batch->Move(commands, out_flags);
+}
+
 }  // namespace nickel::physics
\ No newline at end of file
@@ -0,0 +1,527 @@
+#include "nickel/common/macro.hpp"
+#include "nickel/physics/internal/context_impl.hpp"
+#include "nickel/physics/internal/scene_impl.hpp"
+#include "nickel/physics/internal/util.hpp"
+#include "nickel/physics/internal/vehicle_impl.hpp"
+
+#include <unordered_map>
+
+namespace nickel::physics {
+
+namespace {
+
+constexpr uint32_t SnapshotMagic = 0x53534b4e;  // "NKSS"
+constexpr uint32_t SnapshotVersion = 2;
+
+const physx::PxActorTypeFlags SnapshotActorTypes =
+    physx::PxActorTypeFlag::eRIGID_STATIC |
+    physx::PxActorTypeFlag::eRIGID_DYNAMIC;
+
+using SleepState =
+    std::array<float, physx::PxRigidDynamic::eNB_SLEEP_STATE_VALUES>;
+
+struct SnapshotHeader {
+    uint32_t m_magic = SnapshotMagic;
+    uint32_t m_version = SnapshotVersion;
+    uint32_t m_actor_num{};
+    uint32_t m_joint_num{};
+    uint32_t m_controller_num{};
+    uint32_t m_vehicle_num{};
+};
+
+// values are copied as raw bytes, snapshots are not meant to be persisted
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(std::vector<uint8_t>& data) : m_data{data} {
+        m_data.clear();
+    }
+
+    template <typename T>
+    void Write(const T& value) {
+        size_t offset = m_data.size();
+        m_data.resize(offset + sizeof(T));
+        memcpy(m_data.data() + offset, &value, sizeof(T));
+    }
+
+private:
+    std::vector<uint8_t>& m_data;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(std::span<const uint8_t> data) : m_data{data} {}
+
+    template <typename T>
+    bool Read(T& value) {
+        if (m_offset + sizeof(T) > m_data.size()) {
+            return false;
+        }
+        memcpy(&value, m_data.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    template <typename T>
+    T Read() {
+        T value{};
+        m_ok = m_ok && Read(value);
+        return value;
+    }
+
+    bool IsOk() const { return m_ok; }
+
+    bool IsEnd() const { return m_offset == m_data.size(); }
+
+private:
+    std::span<const uint8_t> m_data;
+    size_t m_offset{};
+    bool m_ok = true;
+};
+
+physx::PxJoint* getJoint(physx::PxConstraint& constraint) {
+    uint32_t type_id;
+    void* ref = constraint.getExternalReference(type_id);
+    if (type_id != physx::PxConstraintExtIDs::eJOINT) {
+        return nullptr;
+    }
+    return static_cast<physx::PxJoint*>(ref);
+}
+
+// objects without stable id are not created by the engine and not saved
+
+template <typename F>
+void visitSceneActors(physx::PxScene& scene, F f) {
+    constexpr uint32_t BatchSize = 64;
+    physx::PxActor* actors[BatchSize];
+    uint32_t actor_num = scene.getNbActors(SnapshotActorTypes);
+    for (uint32_t i = 0; i < actor_num; i += BatchSize) {
+        uint32_t count =
+            scene.getActors(SnapshotActorTypes, actors, BatchSize, i);
+        for (uint32_t j = 0; j < count; j++) {
+            uint32_t id = StableIDFromUserData(actors[j]->userData);
+            NICKEL_CONTINUE_IF_FALSE(id != 0);
+            f(id, *actors[j]->is<physx::PxRigidActor>());
+        }
+    }
+}
+
+template <typename F>
+void visitSceneJoints(physx::PxScene& scene, F f) {
+    constexpr uint32_t BatchSize = 64;
+    physx::PxConstraint* constraints[BatchSize];
+    uint32_t constraint_num = scene.getNbConstraints();
+    for (uint32_t i = 0; i < constraint_num; i += BatchSize) {
+        uint32_t count = scene.getConstraints(constraints, BatchSize, i);
+        for (uint32_t j = 0; j < count; j++) {
+            auto joint = getJoint(*constraints[j]);
+            NICKEL_CONTINUE_IF_FALSE(joint);
+            uint32_t id = StableIDFromUserData(joint->userData);
+            NICKEL_CONTINUE_IF_FALSE(id != 0);
+            f(id, *joint);
+        }
+    }
+}
+
+template <typename F>
+void visitSceneControllers(physx::PxControllerManager* mgr, F f) {
+    uint32_t controller_num = mgr ? mgr->getNbControllers() : 0;
+    for (uint32_t i = 0; i < controller_num; i++) {
+        auto controller = mgr->getController(i);
+        uint32_t id = StableIDFromUserData(controller->getUserData());
+        NICKEL_CONTINUE_IF_FALSE(id != 0);
+        f(id, *controller);
+    }
+}
+
+// vehicles are identified by their chassis actor
+template <typename F>
+void visitSceneVehicles(VehicleManagerImpl& mgr, const physx::PxScene& scene,
+                        F f) {
+    for (auto wheels : mgr.m_wheels) {
+        auto actor = wheels->getRigidDynamicActor();
+        NICKEL_CONTINUE_IF_FALSE(actor && actor->getScene() == &scene);
+        uint32_t id = StableIDFromUserData(actor->userData);
+        NICKEL_CONTINUE_IF_FALSE(id != 0);
+        f(id, *wheels);
+    }
+}
+
+/// scene objects by stable id, each record takes its object out so a
+/// duplicated record doesn't match twice
+template <typename T>
+class StableIDMap {
+public:
+    void Add(uint32_t id, T& object) { m_objects.emplace(id, &object); }
+
+    uint32_t Size() const { return m_objects.size(); }
+
+    T* Take(uint32_t id) {
+        auto it = m_objects.find(id);
+        if (it == m_objects.end()) {
+            return nullptr;
+        }
+        T* object = it->second;
+        m_objects.erase(it);
+        return object;
+    }
+
+private:
+    std::unordered_map<uint32_t, T*> m_objects;
+};
+
+void writeActor(SnapshotWriter& writer, physx::PxRigidActor& actor) {
+    writer.Write(actor.getConcreteType());
+    writer.Write(actor.getGlobalPose());
+
+    // shapes are shared between snapshot and scene, only save their pose
+    physx::PxShape* shapes[16];
+    uint32_t shape_num = actor.getNbShapes();
+    writer.Write(shape_num);
+    for (uint32_t i = 0; i < shape_num; i += std::size(shapes)) {
+        uint32_t count = actor.getShapes(shapes, std::size(shapes), i);
+        for (uint32_t j = 0; j < count; j++) {
+            writer.Write(shapes[j]->getLocalPose());
+        }
+    }
+
+    auto dynamic = actor.is<physx::PxRigidDynamic>();
+    if (!dynamic) {
+        return;
+    }
+
+    writer.Write(static_cast<uint32_t>(dynamic->getRigidBodyFlags()));
+    writer.Write(dynamic->getLinearVelocity());
+    writer.Write(dynamic->getAngularVelocity());
+
+    physx::PxTransform target;
+    bool has_target = dynamic->getKinematicTarget(target);
+    writer.Write(has_target);
+    if (has_target) {
+        writer.Write(target);
+    }
+
+    bool is_kinematic =
+        dynamic->getRigidBodyFlags() & physx::PxRigidBodyFlag::eKINEMATIC;
+    writer.Write(!is_kinematic && dynamic->isSleeping());
+    writer.Write(is_kinematic ? 0.0f : dynamic->getWakeCounter());
+
+    SleepState sleep_state;
+    dynamic->getSleepState(sleep_state.data());
+    writer.Write(sleep_state);
+}
+
+// read* only check the data against the scene unless `apply` is set
+bool readActor(SnapshotReader& reader, physx::PxRigidActor& actor,
+               physx::PxScene& scene, bool apply) {
+    if (reader.Read<uint16_t>() != actor.getConcreteType()) {
+        return false;
+    }
+    auto pose = reader.Read<physx::PxTransform>();
+
+    uint32_t shape_num = reader.Read<uint32_t>();
+    if (shape_num != actor.getNbShapes()) {
+        return false;
+    }
+    physx::PxShape* shapes[16];
+    for (uint32_t i = 0; i < shape_num; i += std::size(shapes)) {
+        uint32_t count = actor.getShapes(shapes, std::size(shapes), i);
+        for (uint32_t j = 0; j < count; j++) {
+            auto local_pose = reader.Read<physx::PxTransform>();
+            if (apply && !(shapes[j]->getLocalPose() == local_pose)) {
+                shapes[j]->setLocalPose(local_pose);
+            }
+        }
+    }
+
+    auto dynamic = actor.is<physx::PxRigidDynamic>();
+    if (!dynamic) {
+        if (apply && !(actor.getGlobalPose() == pose)) {
+            actor.setGlobalPose(pose);
+        }
+        return reader.IsOk();
+    }
+
+    physx::PxRigidBodyFlags flags{
+        static_cast<physx::PxU8>(reader.Read<uint32_t>())};
+    auto linear_vel = reader.Read<physx::PxVec3>();
+    auto angular_vel = reader.Read<physx::PxVec3>();
+    physx::PxTransform target;
+    bool has_target = reader.Read<bool>();
+    if (has_target) {
+        target = reader.Read<physx::PxTransform>();
+    }
+    bool is_sleeping = reader.Read<bool>();
+    float wake_counter = reader.Read<float>();
+    auto sleep_state = reader.Read<SleepState>();
+    if (!reader.IsOk() || !apply) {
+        return reader.IsOk();
+    }
+
+    dynamic->setRigidBodyFlags(flags);
+    dynamic->setGlobalPose(pose, false);
+
+    if (flags & physx::PxRigidBodyFlag::eKINEMATIC) {
+        if (has_target) {
+            dynamic->setKinematicTarget(target);
+        }
+    } else {
+        dynamic->clearForce(physx::PxForceMode::eFORCE);
+        dynamic->clearForce(physx::PxForceMode::eIMPULSE);
+        dynamic->clearTorque(physx::PxForceMode::eFORCE);
+        dynamic->clearTorque(physx::PxForceMode::eIMPULSE);
+        dynamic->setLinearVelocity(linear_vel, false);
+        dynamic->setAngularVelocity(angular_vel, false);
+        if (is_sleeping) {
+            dynamic->putToSleep();
+        } else {
+            // a zero wake counter doesn't wake a sleeping body, but the body
+            // may have been awake and ready for sleep when captured
+            if (dynamic->isSleeping()) {
+                dynamic->wakeUp();
+            }
+            dynamic->setWakeCounter(wake_counter);
+        }
+    }
+    // accumulated by the solver, decides when the body falls asleep
+    dynamic->setSleepState(sleep_state.data());
+
+    // refilter pairs of the restored pose, friction anchors of existing pairs
+    // are dropped by the pose change already
+    scene.resetFiltering(actor);
+    return true;
+}
+
+void writeController(SnapshotWriter& writer, physx::PxController& cct) {
+    writer.Write(cct.getType());
+    writer.Write(cct.getPosition());
+    writer.Write(cct.getUpDirection());
+    if (cct.getType() == physx::PxControllerShapeType::eCAPSULE) {
+        auto& capsule = static_cast<physx::PxCapsuleController&>(cct);
+        writer.Write(capsule.getRadius());
+        writer.Write(capsule.getHeight());
+    }
+}
+
+bool readController(SnapshotReader& reader, physx::PxController& cct,
+                    bool apply) {
+    if (reader.Read<physx::PxControllerShapeType::Enum>() != cct.getType()) {
+        return false;
+    }
+    auto position = reader.Read<physx::PxExtendedVec3>();
+    auto up = reader.Read<physx::PxVec3>();
+    float radius{}, height{};
+    if (cct.getType() == physx::PxControllerShapeType::eCAPSULE) {
+        radius = reader.Read<float>();
+        height = reader.Read<float>();
+    }
+    if (!reader.IsOk() || !apply) {
+        return reader.IsOk();
+    }
+
+    if (cct.getType() == physx::PxControllerShapeType::eCAPSULE) {
+        auto& capsule = static_cast<physx::PxCapsuleController&>(cct);
+        capsule.setRadius(radius);
+        capsule.setHeight(height);
+    }
+    cct.setUpDirection(up);
+    cct.setPosition(position);
+    cct.invalidateCache();
+    return true;
+}
+
+void writeVehicle(SnapshotWriter& writer, physx::PxVehicleWheels& vehicle) {
+    writer.Write(vehicle.getVehicleType());
+
+    auto& dyn = vehicle.mWheelsDynData;
+    uint32_t wheel_num = vehicle.mWheelsSimData.getNbWheels();
+    writer.Write(wheel_num);
+    for (uint32_t i = 0; i < wheel_num; i++) {
+        std::array<float, physx::PxVehicleWheelsDynData::eNB_WHEEL_STATE_VALUES>
+            state;
+        dyn.getWheelState(i, state.data());
+        writer.Write(state);
+    }
+
+    if (vehicle.getVehicleType() == physx::PxVehicleTypes::eNODRIVE) {
+        auto& no_drive = static_cast<physx::PxVehicleNoDrive&>(vehicle);
+        for (uint32_t i = 0; i < wheel_num; i++) {
+            writer.Write(no_drive.getDriveTorque(i));
+            writer.Write(no_drive.getBrakeTorque(i));
+            writer.Write(no_drive.getSteerAngle(i));
+        }
+    } else {
+        auto& drive = static_cast<physx::PxVehicleDrive&>(vehicle);
+        writer.Write(drive.mDriveDynData);
+    }
+}
+
+bool readVehicle(SnapshotReader& reader, physx::PxVehicleWheels& vehicle,
+                 bool apply) {
+    if (reader.Read<physx::PxU32>() != vehicle.getVehicleType() ||
+        reader.Read<uint32_t>() != vehicle.mWheelsSimData.getNbWheels()) {
+        return false;
+    }
+
+    auto& dyn = vehicle.mWheelsDynData;
+    uint32_t wheel_num = vehicle.mWheelsSimData.getNbWheels();
+    for (uint32_t i = 0; i < wheel_num; i++) {
+        auto state = reader.Read<std::array<
+            float, physx::PxVehicleWheelsDynData::eNB_WHEEL_STATE_VALUES>>();
+        if (apply) {
+            dyn.setWheelState(i, state.data());
+        }
+    }
+
+    if (vehicle.getVehicleType() == physx::PxVehicleTypes::eNODRIVE) {
+        auto& no_drive = static_cast<physx::PxVehicleNoDrive&>(vehicle);
+        for (uint32_t i = 0; i < wheel_num; i++) {
+            float drive = reader.Read<float>();
+            float brake = reader.Read<float>();
+            float steer = reader.Read<float>();
+            if (apply) {
+                no_drive.setDriveTorque(i, drive);
+                no_drive.setBrakeTorque(i, brake);
+                no_drive.setSteerAngle(i, steer);
+            }
+        }
+    } else {
+        auto drive_data = reader.Read<physx::PxVehicleDriveDynData>();
+        if (apply) {
+            static_cast<physx::PxVehicleDrive&>(vehicle).mDriveDynData =
+                drive_data;
+        }
+    }
+    return reader.IsOk();
+}
+
+}  // namespace
+
+void SceneImpl::TakeSnapshot(SceneSnapshot& snapshot) const {
+    auto& vehicle_mgr = *m_ctx->GetVehicleManager().m_impl;
+
+    SnapshotHeader header;
+    visitSceneActors(*m_scene, [&](uint32_t, physx::PxRigidActor&) {
+        header.m_actor_num++;
+    });
+    visitSceneJoints(*m_scene,
+                     [&](uint32_t, physx::PxJoint&) { header.m_joint_num++; });
+    visitSceneControllers(m_cct_manager, [&](uint32_t, physx::PxController&) {
+        header.m_controller_num++;
+    });
+    visitSceneVehicles(
+        vehicle_mgr, *m_scene,
+        [&](uint32_t, physx::PxVehicleWheels&) { header.m_vehicle_num++; });
+
+    SnapshotWriter writer{snapshot.m_data};
+    writer.Write(header);
+
+    visitSceneActors(*m_scene, [&](uint32_t id, physx::PxRigidActor& actor) {
+        writer.Write(id);
+        writeActor(writer, actor);
+    });
+    visitSceneJoints(*m_scene, [&](uint32_t id, physx::PxJoint& joint) {
+        writer.Write(id);
+        writer.Write(joint.getLocalPose(physx::PxJointActorIndex::eACTOR0));
+        writer.Write(joint.getLocalPose(physx::PxJointActorIndex::eACTOR1));
+    });
+    visitSceneControllers(m_cct_manager,
+                          [&](uint32_t id, physx::PxController& controller) {
+                              writer.Write(id);
+                              writeController(writer, controller);
+                          });
+    visitSceneVehicles(vehicle_mgr, *m_scene,
+                       [&](uint32_t id, physx::PxVehicleWheels& vehicle) {
+                           writer.Write(id);
+                           writeVehicle(writer, vehicle);
+                       });
+}
+
+bool SceneImpl::RestoreSnapshot(const SceneSnapshot& snapshot) {
+    // parse the whole snapshot first, a mismatch must not leave the scene
+    // half restored
+    return readSnapshot(snapshot, false) && readSnapshot(snapshot, true);
+}
+
+bool SceneImpl::readSnapshot(const SceneSnapshot& snapshot, bool apply) {
+    auto& vehicle_mgr = *m_ctx->GetVehicleManager().m_impl;
+    SnapshotReader reader{snapshot.m_data};
+
+    SnapshotHeader header;
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false,
+        reader.Read(header) && header.m_magic == SnapshotMagic &&
+            header.m_version == SnapshotVersion,
+        "invalid physics scene snapshot");
+
+    StableIDMap<physx::PxRigidActor> actors;
+    StableIDMap<physx::PxJoint> joints;
+    StableIDMap<physx::PxController> controllers;
+    StableIDMap<physx::PxVehicleWheels> vehicles;
+    visitSceneActors(*m_scene, [&](uint32_t id, physx::PxRigidActor& actor) {
+        actors.Add(id, actor);
+    });
+    visitSceneJoints(*m_scene, [&](uint32_t id, physx::PxJoint& joint) {
+        joints.Add(id, joint);
+    });
+    visitSceneControllers(m_cct_manager,
+                          [&](uint32_t id, physx::PxController& controller) {
+                              controllers.Add(id, controller);
+                          });
+    visitSceneVehicles(vehicle_mgr, *m_scene,
+                       [&](uint32_t id, physx::PxVehicleWheels& vehicle) {
+                           vehicles.Add(id, vehicle);
+                       });
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false,
+        header.m_actor_num == actors.Size() &&
+            header.m_joint_num == joints.Size() &&
+            header.m_controller_num == controllers.Size() &&
+            header.m_vehicle_num == vehicles.Size(),
+        "physics scene snapshot doesn't match scene {}", m_scene->getName());
+
+    // counts are equal, so once every record found its own object the scene
+    // has no object the snapshot doesn't know
+    for (uint32_t i = 0; i < header.m_actor_num; i++) {
+        uint32_t id = reader.Read<uint32_t>();
+        auto actor = actors.Take(id);
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false, actor && readActor(reader, *actor, *m_scene, apply),
+            "physics scene snapshot: actor {} mismatch", id);
+    }
+
+    for (uint32_t i = 0; i < header.m_joint_num; i++) {
+        uint32_t id = reader.Read<uint32_t>();
+        auto joint = joints.Take(id);
+        auto pose0 = reader.Read<physx::PxTransform>();
+        auto pose1 = reader.Read<physx::PxTransform>();
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false, joint && reader.IsOk(),
+            "physics scene snapshot: joint {} mismatch", id);
+        if (apply) {
+            joint->setLocalPose(physx::PxJointActorIndex::eACTOR0, pose0);
+            joint->setLocalPose(physx::PxJointActorIndex::eACTOR1, pose1);
+        }
+    }
+
+    for (uint32_t i = 0; i < header.m_controller_num; i++) {
+        uint32_t id = reader.Read<uint32_t>();
+        auto controller = controllers.Take(id);
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false, controller && readController(reader, *controller, apply),
+            "physics scene snapshot: controller {} mismatch", id);
+    }
+
+    for (uint32_t i = 0; i < header.m_vehicle_num; i++) {
+        uint32_t id = reader.Read<uint32_t>();
+        auto vehicle = vehicles.Take(id);
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false, vehicle && readVehicle(reader, *vehicle, apply),
+            "physics scene snapshot: vehicle {} mismatch", id);
+    }
+
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, reader.IsEnd(),
+                                      "physics scene snapshot: trailing data");
+    return true;
+}
+
+}  // namespace nickel::physics
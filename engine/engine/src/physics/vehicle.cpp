@@ -394,4 +394,42 @@ void VehicleManager::GC() {
     m_impl->GC();
 }
 
+void VehicleManager::SetTireFrictionTable(
+    const VehicleTireFrictionTable& table) {
+    m_impl->SetTireFrictionTable(table);
+}
+
+bool VehicleManager::LoadTireFrictionTable(const Path& filename) {
+    return m_impl->LoadTireFrictionTable(filename);
+}
+
+const VehicleTireFrictionTable& VehicleManager::GetTireFrictionTable() const {
+    return m_impl->GetTireFrictionTable();
+}
+
+bool VehicleManager::SetSurfaceMaterial(const Material& material,
+                                        const std::string& surface) {
+    return m_impl->SetSurfaceMaterial(material, surface);
+}
+
+std::optional<uint32_t> VehicleManager::GetSurfaceType(
+    const std::string& surface) const {
+    return m_impl->GetSurfaceType(surface);
+}
+
+std::optional<uint32_t> VehicleManager::GetTireType(
+    const std::string& tire) const {
+    return m_impl->GetTireType(tire);
+}
+
+void VehicleManager::SetTypePairFriction(uint32_t surface_type,
+                                         uint32_t tire_type, float friction) {
+    m_impl->SetTypePairFriction(surface_type, tire_type, friction);
+}
+
+float VehicleManager::GetTypePairFriction(uint32_t surface_type,
+                                          uint32_t tire_type) const {
+    return m_impl->GetTypePairFriction(surface_type, tire_type);
+}
+
 }  // namespace nickel::physics
\ No newline at end of file
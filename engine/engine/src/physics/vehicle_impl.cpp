@@ -3,7 +3,11 @@
 #include "3rdlibs/physx/physx/source/physxvehicle/src/PxVehicleSuspWheelTire4.h"
 #include "nickel/common/macro.hpp"
 #include "nickel/physics/internal/context_impl.hpp"
+#include "nickel/physics/internal/material_impl.hpp"
 #include "nickel/physics/internal/util.hpp"
+#include "nickel/refl/drefl/factory.hpp"
+#include "nickel/refl/drefl/make_any.hpp"
+#include "nickel/refl/internal/serd_backends/tomlplusplus.hpp"
 
 namespace nickel::physics {
 inline physx::PxVehicleWheelData WheelData2PhysX(
@@ -808,61 +812,66 @@ VehicleManagerImpl::VehicleManagerImpl(ContextImpl& ctx, SceneImpl& scene)
 }
 
 VehicleManagerImpl::~VehicleManagerImpl() {
+    m_vehicles.clear();
+    m_wheels.clear();
     m_tank_allocator.FreeAll();
     m_nw_allocator.FreeAll();
     m_4w_allocator.FreeAll();
+    m_no_drive_allocator.FreeAll();
+
+    if (m_batch_query) {
+        m_batch_query->release();
+    }
+    if (m_friction_pairs) {
+        m_friction_pairs->release();
+    }
 }
 
 Vehicle4WDriveImpl* VehicleManagerImpl::CreateVehicle4WDrive(
     const VehicleWheelSimDescriptor& wheel,
     const VehicleDriveSim4WDescriptor& drive, const RigidDynamic& actor) {
-    m_wheel_num += wheel.GetWheelNum();
-    auto vehicle = m_4w_allocator.Allocate(m_ctx, *this, wheel, drive, actor);
-    m_vehicles.push_back(vehicle);
-    return vehicle;
+    return registerVehicle(
+        m_4w_allocator.Allocate(m_ctx, *this, wheel, drive, actor));
 }
 
 VehicleNWDriveImpl* VehicleManagerImpl::CreateVehicleNWDrive(
     const VehicleWheelSimDescriptor& wheel,
     const VehicleDriveSimNWDescriptor& drive, const RigidDynamic& actor) {
-    m_wheel_num += wheel.GetWheelNum();
-    auto vehicle = m_nw_allocator.Allocate(m_ctx, *this, wheel, drive, actor);
-    m_vehicles.push_back(vehicle);
-    return vehicle;
+    return registerVehicle(
+        m_nw_allocator.Allocate(m_ctx, *this, wheel, drive, actor));
 }
 
 VehicleTank VehicleManagerImpl::CreateVehicleTankDrive(
     VehicleTankDriveMode drive_mode, const VehicleWheelSimDescriptor& wheel,
     const VehicleDriveSimDescriptor& drive, const RigidDynamic& actor) {
-    m_wheel_num += wheel.GetWheelNum();
-    auto vehicle = m_tank_allocator.Allocate(m_ctx, *this, drive_mode, wheel,
-                                             drive, actor);
-    m_vehicles.push_back(vehicle);
-    return vehicle;
+    return registerVehicle(m_tank_allocator.Allocate(m_ctx, *this, drive_mode,
+                                                     wheel, drive, actor));
 }
 
 VehicleNoDrive VehicleManagerImpl::CreateVehicleNoDrive(
     const VehicleWheelSimDescriptor& wheel, const RigidDynamic& actor) {
-    m_wheel_num += wheel.GetWheelNum();
-    auto vehicle = m_no_drive_allocator.Allocate(m_ctx, *this, wheel, actor);
-    m_vehicles.push_back(vehicle);
-    return vehicle;
+    return registerVehicle(
+        m_no_drive_allocator.Allocate(m_ctx, *this, wheel, actor));
 }
 
 void VehicleManagerImpl::Update(float delta_time) {
+    if (m_wheels.empty()) {
+        return;
+    }
+
     tryRecreateBatchQuery();
+    if (!m_batch_query) {
+        return;
+    }
 
-    std::vector<physx::PxVehicleWheels*> wheels;
-    wheels.reserve(m_vehicles.size());
     for (auto vehicle : m_vehicles) {
         vehicle->Update(delta_time);
-        wheels.push_back(vehicle->m_drive);
     }
-    physx::PxVehicleSuspensionRaycasts(m_batch_query, m_vehicles.size(),
-                                       wheels.data());
+    physx::PxVehicleSuspensionRaycasts(m_batch_query, m_wheels.size(),
+                                       m_wheels.data());
 
     physx::PxVehicleUpdates(delta_time, {0, -9.8, 0}, *m_friction_pairs,
-                            wheels.size(), wheels.data(), nullptr);
+                            m_wheels.size(), m_wheels.data(), nullptr);
 }
 
 void VehicleManagerImpl::GC() {
@@ -870,29 +879,66 @@ void VehicleManagerImpl::GC() {
     m_4w_allocator.GC();
     m_nw_allocator.GC();
     m_tank_allocator.GC();
+    m_no_drive_allocator.GC();
+}
+
+template <typename T>
+T* VehicleManagerImpl::registerVehicle(T* vehicle) {
+    // vehicle without underlying PhysX object must not reach
+    // PxVehicleUpdates, keep it out of the registry
+    if (!vehicle || !vehicle->m_drive) {
+        return vehicle;
+    }
+
+    clampTireTypes(*vehicle->m_drive);
+    vehicle->m_index = m_vehicles.size();
+    m_vehicles.push_back(vehicle);
+    m_wheels.push_back(vehicle->m_drive);
+    m_wheel_num += vehicle->m_drive->mWheelsSimData.getNbWheels();
+    return vehicle;
+}
+
+void VehicleManagerImpl::unregisterVehicle(VehicleDriveImpl* vehicle) {
+    uint32_t idx = vehicle->m_index;
+    if (idx == VehicleDriveImpl::InvalidIndex) {
+        return;
+    }
+
+    NICKEL_ASSERT(idx < m_vehicles.size() && m_vehicles[idx] == vehicle,
+                  "vehicle registry corrupted");
+
+    // swap-remove: move the last vehicle into the freed slot
+    VehicleDriveImpl* last = m_vehicles.back();
+    m_vehicles[idx] = last;
+    m_wheels[idx] = m_wheels.back();
+    last->m_index = idx;
+    m_vehicles.pop_back();
+    m_wheels.pop_back();
+
+    m_wheel_num -= vehicle->m_drive->mWheelsSimData.getNbWheels();
+    vehicle->m_index = VehicleDriveImpl::InvalidIndex;
 }
 
 void VehicleManagerImpl::deletePendingVehicles() {
     for (auto vehicle : m_pending_delete) {
-        auto it = std::find(m_vehicles.begin(), m_vehicles.end(), vehicle);
-        if (it != m_vehicles.end()) {
-            m_wheel_num -= vehicle->m_drive->mWheelsSimData.getNbWheels();
-            m_vehicles.erase(it);
-        }
+        unregisterVehicle(vehicle);
     }
     m_pending_delete.clear();
 }
 
 void VehicleManagerImpl::tryRecreateBatchQuery() {
-    if (m_wheel_num >= m_batch_result_num) {
-        uint32_t batch_num =
-            std::ceil(m_wheel_num / (float)BatchResultExpandStep) *
-            BatchResultExpandStep;
-        uint32_t touch_num =
-            std::ceil(m_wheel_num / (4 * (float)BatchResultExpandStep)) * 4 *
-            BatchResultExpandStep;
-        recreateBatchQuery(batch_num, touch_num);
+    if (m_batch_query && m_wheel_num <= m_batch_result_num) {
+        return;
+    }
+
+    // grow geometrically so spawning many vehicles only recreates the batch
+    // query O(log n) times. Called before raycasts are issued, so no raycast
+    // result of current frame is dropped by recreation
+    uint32_t result_num = std::max(m_batch_result_num, BatchResultInitCapacity);
+    while (result_num < m_wheel_num) {
+        result_num *= 2;
     }
+    recreateBatchQuery(result_num, result_num);
 }
 
 void VehicleManagerImpl::recreateBatchQuery(uint32_t batch_result_num,
@@ -908,26 +954,250 @@ void VehicleManagerImpl::recreateBatchQuery(uint32_t batch_result_num,
         m_batch_result_num = batch_result_num;
         m_batch_touch_num = batch_touch_num;
     } else {
+        LOGE("create vehicle batch query failed");
         m_batch_result_num = 0;
         m_batch_touch_num = 0;
     }
 }
 
+void VehicleManagerImpl::SetTireFrictionTable(
+    const VehicleTireFrictionTable& table) {
+    constexpr uint32_t MaxSurfaceNum = physx::
+        PxVehicleDrivableSurfaceToTireFrictionPairs::eMAX_NB_SURFACE_TYPES;
+
+    m_friction_table = table;
+    auto& surfaces = m_friction_table.m_surfaces;
+    auto& tires = m_friction_table.m_tires;
+    if (surfaces.empty()) {
+        LOGW("vehicle friction table has no surface, use 'default'");
+        surfaces.push_back("default");
+    }
+    if (tires.empty()) {
+        LOGW("vehicle friction table has no tire, use 'default'");
+        tires.push_back("default");
+    }
+    if (surfaces.size() > MaxSurfaceNum) {
+        LOGE("vehicle friction table has {} surfaces, only first {} are used",
+             surfaces.size(), MaxSurfaceNum);
+        surfaces.resize(MaxSurfaceNum);
+    }
+
+    const size_t tire_num = tires.size();
+    m_frictions.assign(surfaces.size() * tire_num,
+                       m_friction_table.m_default_friction);
+    for (auto& pair : m_friction_table.m_pairs) {
+        auto surface_type = GetSurfaceType(pair.m_surface);
+        auto tire_type = GetTireType(pair.m_tire);
+        if (!surface_type || !tire_type) {
+            LOGW("vehicle friction pair ({}, {}) refers unknown surface/tire, "
+                 "ignored",
+                 pair.m_surface, pair.m_tire);
+            continue;
+        }
+        m_frictions[*surface_type * tire_num + *tire_type] = pair.m_friction;
+    }
+
+    // PhysX only checks tire types in debug builds, a table with fewer tires
+    // would make live vehicles read past the friction array
+    for (auto vehicle : m_vehicles) {
+        clampTireTypes(*vehicle->m_drive);
+    }
+    applyFrictionPairs();
+}
+
+static void registVehicleTireFrictionTableReflInfo() {
+    static bool registed = false;
+    if (registed) {
+        return;
+    }
+    registed = true;
+
+    using Pair = VehicleTireFrictionTable::Pair;
+    refl::ClassFactory<Pair>::Instance()
+        .Regist("VehicleTireFrictionTable::Pair")
+        .Property("surface", &Pair::m_surface)
+        .Property("tire", &Pair::m_tire)
+        .Property("friction", &Pair::m_friction);
+    refl::ClassFactory<VehicleTireFrictionTable>::Instance()
+        .Regist("VehicleTireFrictionTable")
+        .Property("surfaces", &VehicleTireFrictionTable::m_surfaces)
+        .Property("tires", &VehicleTireFrictionTable::m_tires)
+        .Property("pairs", &VehicleTireFrictionTable::m_pairs)
+        .Property("default_friction",
+                  &VehicleTireFrictionTable::m_default_friction);
+}
+
+bool VehicleManagerImpl::LoadTireFrictionTable(const Path& filename) {
+    auto parser = toml::parse_file(filename.ToString());
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        false, !parser.failed(), "parse vehicle friction table {} failed: {}",
+        filename, parser.error().description());
+
+    registVehicleTireFrictionTableReflInfo();
+
+    VehicleTireFrictionTable table;
+    auto ref = refl::AnyMakeRef(table);
+    refl::deserialize(ref, parser.table());
+    SetTireFrictionTable(table);
+    return true;
+}
+
+const VehicleTireFrictionTable& VehicleManagerImpl::GetTireFrictionTable()
+    const {
+    return m_friction_table;
+}
+
+bool VehicleManagerImpl::SetSurfaceMaterial(const Material& material,
+                                            const std::string& surface) {
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, material,
+                                      "bind invalid material to surface {}",
+                                      surface);
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(false, GetSurfaceType(surface),
+                                      "vehicle surface {} not exists",
+                                      surface);
+
+    auto it = std::find_if(m_surface_materials.begin(),
+                           m_surface_materials.end(), [&](auto& binding) {
+                               return binding.m_material.GetImpl() ==
+                                      material.GetImpl();
+                           });
+    if (it != m_surface_materials.end()) {
+        it->m_surface = surface;
+    } else {
+        NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+            false,
+            m_surface_materials.size() <
+                physx::PxVehicleDrivableSurfaceToTireFrictionPairs::
+                    eMAX_NB_SURFACE_TYPES,
+            "too many vehicle surface materials");
+        m_surface_materials.push_back({material, surface});
+    }
+
+    applyFrictionPairs();
+    return true;
+}
+
+std::optional<uint32_t> VehicleManagerImpl::GetSurfaceType(
+    const std::string& surface) const {
+    auto& surfaces = m_friction_table.m_surfaces;
+    auto it = std::find(surfaces.begin(), surfaces.end(), surface);
+    if (it == surfaces.end()) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(it - surfaces.begin());
+}
+
+std::optional<uint32_t> VehicleManagerImpl::GetTireType(
+    const std::string& tire) const {
+    auto& tires = m_friction_table.m_tires;
+    auto it = std::find(tires.begin(), tires.end(), tire);
+    if (it == tires.end()) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(it - tires.begin());
+}
+
+void VehicleManagerImpl::SetTypePairFriction(uint32_t surface_type,
+                                             uint32_t tire_type,
+                                             float friction) {
+    const size_t tire_num = m_friction_table.m_tires.size();
+    NICKEL_RETURN_IF_FALSE_LOGE(
+        surface_type < m_friction_table.m_surfaces.size() &&
+            tire_type < tire_num,
+        "invalid vehicle friction pair ({}, {})", surface_type, tire_type);
+
+    m_frictions[surface_type * tire_num + tire_type] = friction;
+    m_friction_pairs->setTypePairFriction(surface_type, tire_type, friction);
+
+    // keep GetTireFrictionTable() in sync with the applied values
+    auto& surface = m_friction_table.m_surfaces[surface_type];
+    auto& tire = m_friction_table.m_tires[tire_type];
+    auto& pairs = m_friction_table.m_pairs;
+    auto it = std::find_if(pairs.begin(), pairs.end(), [&](auto& pair) {
+        return pair.m_surface == surface && pair.m_tire == tire;
+    });
+    if (it != pairs.end()) {
+        it->m_friction = friction;
+    } else {
+        pairs.push_back({surface, tire, friction});
+    }
+}
+
+float VehicleManagerImpl::GetTypePairFriction(uint32_t surface_type,
+                                              uint32_t tire_type) const {
+    const size_t tire_num = m_friction_table.m_tires.size();
+    NICKEL_RETURN_VALUE_IF_FALSE_LOGE(
+        0, surface_type < m_friction_table.m_surfaces.size() &&
+               tire_type < tire_num,
+        "invalid vehicle friction pair ({}, {})", surface_type, tire_type);
+    return m_frictions[surface_type * tire_num + tire_type];
+}
+
 void VehicleManagerImpl::setupFrictionPairs() {
-    physx::PxVehicleDrivableSurfaceType surface_types[1];
-    surface_types[0].mType = 0;
+    VehicleTireFrictionTable table;
+    table.m_surfaces.push_back("default");
+    table.m_tires.push_back("default");
+    SetTireFrictionTable(table);
+}
+
+void VehicleManagerImpl::clampTireTypes(physx::PxVehicleWheels& wheels) const {
+    const uint32_t tire_num = m_friction_table.m_tires.size();
+    auto& sim_data = wheels.mWheelsSimData;
+    for (uint32_t i = 0; i < sim_data.getNbWheels(); i++) {
+        auto tire = sim_data.getTireData(i);
+        NICKEL_CONTINUE_IF_FALSE(tire.mType >= tire_num);
+        LOGW("vehicle wheel {} tire type {} out of friction table ({} tires), "
+             "use tire type 0",
+             i, tire.mType, tire_num);
+        tire.mType = 0;
+        sim_data.setTireData(i, tire);
+    }
+}
+
+void VehicleManagerImpl::applyFrictionPairs() {
+    const uint32_t surface_num = m_friction_table.m_surfaces.size();
+    const uint32_t tire_num = m_friction_table.m_tires.size();
 
-    std::array<const physx::PxMaterial*, 1> surface_materials;
-    surface_materials[0] = {m_ctx.m_physics->createMaterial(0.1, 0.1, 0.1)};
+    // PhysX keeps one material entry per surface type, so pad the shorter of
+    // materials/surfaces. Padded materials are null and never match a hit
+    const uint32_t entry_num = std::max<uint32_t>(
+        surface_num, static_cast<uint32_t>(m_surface_materials.size()));
 
-    m_friction_pairs =
-        physx::PxVehicleDrivableSurfaceToTireFrictionPairs::allocate(1, 1);
+    // vehicles don't hold the table (it is passed in each update), so growing
+    // it only needs a reallocation
+    if (!m_friction_pairs ||
+        m_friction_pairs->getMaxNbSurfaceTypes() < entry_num ||
+        m_friction_pairs->getMaxNbTireTypes() < tire_num) {
+        if (m_friction_pairs) {
+            m_friction_pairs->release();
+        }
+        m_friction_pairs =
+            physx::PxVehicleDrivableSurfaceToTireFrictionPairs::allocate(
+                tire_num, entry_num);
+    }
 
-    m_friction_pairs->setup(1, 1, surface_materials.data(), surface_types);
+    std::vector<const physx::PxMaterial*> materials(entry_num, nullptr);
+    std::vector<physx::PxVehicleDrivableSurfaceType> types(entry_num);
+    for (uint32_t i = 0; i < entry_num; i++) {
+        types[i].mType = 0;
+    }
+    for (uint32_t i = 0; i < m_surface_materials.size(); i++) {
+        auto& binding = m_surface_materials[i];
+        auto mtl = binding.m_material.GetImpl()->m_mtl;
+        materials[i] = mtl;
+        types[i].mType = GetSurfaceType(binding.m_surface).value_or(0);
+
+        // our patched getSurfaceType() reads (entry index + 1) from userData
+        // so the per-wheel lookup is O(1) instead of a hash table rebuild
+        mtl->userData = reinterpret_cast<void*>(static_cast<uintptr_t>(i + 1));
+    }
 
-    for (uint32_t i = 0; i < 1; i++) {
-        for (uint32_t j = 0; j < 1; j++) {
-            m_friction_pairs->setTypePairFriction(i, j, 1.0);
+    m_friction_pairs->setup(tire_num, entry_num, materials.data(),
+                            types.data());
+    for (uint32_t i = 0; i < surface_num; i++) {
+        for (uint32_t j = 0; j < tire_num; j++) {
+            m_friction_pairs->setTypePairFriction(
+                i, j, m_frictions[i * tire_num + j]);
         }
     }
 }
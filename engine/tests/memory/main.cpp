@@ -126,6 +126,27 @@ TEST_CASE("block memory") {
         REQUIRE(gDestructCount == 2);
     }
 
+    SECTION("GC across blocks") {
+        gDestructCount = 0;
+        BlockMemoryAllocator<Num> allocator(4);
+        Num* elems[8];
+        for (int i = 0; i < 8; i++) {
+            elems[i] = allocator.Allocate(i);
+        }
+        allocator.MarkAsGarbage(elems[5]);
+        allocator.Deallocate(elems[6]);
+
+        REQUIRE(allocator.PendingDeleteCount(0) == 0);
+        REQUIRE(allocator.PendingDeleteCount(1) == 1);
+        REQUIRE(allocator.InuseCount(0) == 4);
+        REQUIRE(allocator.InuseCount(1) == 2);
+        REQUIRE(allocator.UnuseCount(1) == 1);
+
+        allocator.GC();
+        REQUIRE(allocator.UnuseCount(1) == 2);
+        REQUIRE(gDestructCount == 2);
+    }
+
     SECTION("reuse") {
         gDestructCount = 0;
         BlockMemoryAllocator<Num> allocator(4);
@@ -0,0 +1,187 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/physics/context.hpp"
+#include "nickel/physics/internal/cct_batch.hpp"
+#include "nickel/physics/internal/scene_impl.hpp"
+
+using namespace nickel;
+using namespace nickel::physics;
+
+namespace {
+
+constexpr float Radius = 0.3f;
+constexpr float Height = 1.0f;
+constexpr float DeltaTime = 1.0f / 60.0f;
+
+struct CrowdSpawner {
+    CrowdSpawner(Context& ctx, Scene scene) : m_scene{scene} {
+        m_material = ctx.CreateMaterial(0.5, 0.5, 0.1);
+
+        auto ground = ctx.CreateRigidStatic(Vec3{0, -1, 0}, {});
+        auto shape =
+            ctx.CreateShape(BoxGeometry{Vec3{500, 1, 500}}, m_material);
+        ground.AttachShape(shape);
+        m_scene.AddRigidActor(ground);
+    }
+
+    void AddPillar(Context& ctx, const Vec3& foot) {
+        auto pillar = ctx.CreateRigidStatic(foot + Vec3{0, 1, 0}, {});
+        auto shape =
+            ctx.CreateShape(BoxGeometry{Vec3{0.2, 1, 0.2}}, m_material);
+        pillar.AttachShape(shape);
+        m_scene.AddRigidActor(pillar);
+    }
+
+    CapsuleController Spawn(const Vec3& foot) {
+        CapsuleController::Descriptor desc;
+        desc.m_radius = Radius;
+        desc.m_height = Height;
+        desc.m_material = m_material;
+        desc.m_position = foot + Vec3{0, Radius + Height * 0.5f + 0.1f, 0};
+        return m_scene.CreateCapsuleController(desc);
+    }
+
+private:
+    Scene m_scene;
+    Material m_material;
+};
+
+std::vector<Vec3> MakeGrid(uint32_t side, float spacing) {
+    std::vector<Vec3> positions;
+    float half = (side - 1) * spacing * 0.5f;
+    for (uint32_t x = 0; x < side; x++) {
+        for (uint32_t z = 0; z < side; z++) {
+            positions.push_back(
+                Vec3{x * spacing - half, 0.05f, z * spacing - half});
+        }
+    }
+    return positions;
+}
+
+}  // namespace
+
+TEST_CASE("batched controller movement") {
+    Context ctx;
+
+    SECTION("matches sequential MoveAndSlide") {
+        auto batch_scene = ctx.GetMainScene();
+        auto seq_scene = ctx.CreateScene("sequential", Vec3{0, -9.8, 0});
+        CrowdSpawner batch_spawner{ctx, batch_scene};
+        CrowdSpawner seq_spawner{ctx, seq_scene};
+        batch_spawner.AddPillar(ctx, Vec3{});
+        seq_spawner.AddPillar(ctx, Vec3{});
+
+        // neighbors are closer than a cell, the crowd spans several cells and
+        // pushes into each other across cell borders
+        std::vector<CCTMoveCommand> commands;
+        std::vector<CapsuleController> seq_controllers;
+        for (auto& p : MakeGrid(12, 0.7f)) {
+            if (std::abs(p.x) < 0.8f && std::abs(p.z) < 0.8f) {
+                continue;  // around the pillar
+            }
+            CCTMoveCommand command;
+            command.m_controller = batch_spawner.Spawn(p);
+            command.m_elapsed_time = DeltaTime;
+            commands.push_back(command);
+            seq_controllers.push_back(seq_spawner.Spawn(p));
+        }
+
+        auto& batch = *batch_scene.GetImpl()->m_cct_batch;
+        std::vector<Flags<CCTCollisionFlag>> flags(commands.size());
+        uint32_t blocked_by_sides = 0;
+        for (uint32_t frame = 0; frame < 30; frame++) {
+            for (uint32_t i = 0; i < commands.size(); i++) {
+                auto p = commands[i].m_controller.GetPosition();
+                Vec3 dir{-p.x, 0, -p.z};
+                float len = Length(dir);
+                commands[i].m_disp =
+                    len > 0.01f ? dir * (0.05f / len) : Vec3{};
+                commands[i].m_disp.y = -0.2f;
+            }
+            batch_scene.MoveControllers(commands, flags);
+
+            // same order, one controller at a time
+            for (uint32_t i : batch.GetMoveOrder()) {
+                seq_controllers[i].MoveAndSlide(
+                    commands[i].m_disp, commands[i].m_min_dist, DeltaTime);
+            }
+
+            for (auto& flag : flags) {
+                if (static_cast<int>(flag & CCTCollisionFlag::Sides) != 0) {
+                    blocked_by_sides++;
+                }
+            }
+        }
+        REQUIRE(blocked_by_sides > 0);
+
+        for (uint32_t i = 0; i < commands.size(); i++) {
+            auto p1 = commands[i].m_controller.GetPosition();
+            auto p2 = seq_controllers[i].GetPosition();
+            REQUIRE(Length(p1 - p2) < 1e-4f);
+            REQUIRE(static_cast<int>(flags[i] & CCTCollisionFlag::Down) != 0);
+        }
+    }
+
+    SECTION("dense crowd does not interpenetrate") {
+        auto scene = ctx.GetMainScene();
+        CrowdSpawner spawner{ctx, scene};
+
+        std::vector<CCTMoveCommand> commands;
+        for (auto& p : MakeGrid(16, 0.9f)) {
+            CCTMoveCommand command;
+            command.m_controller = spawner.Spawn(p);
+            command.m_elapsed_time = DeltaTime;
+            commands.push_back(command);
+        }
+
+        // everyone walks towards the center
+        std::vector<Flags<CCTCollisionFlag>> flags(commands.size());
+        for (uint32_t frame = 0; frame < 60; frame++) {
+            for (auto& command : commands) {
+                auto p = command.m_controller.GetPosition();
+                Vec3 dir{-p.x, 0, -p.z};
+                float len = Length(dir);
+                command.m_disp = len > 0.01f ? dir * (0.05f / len) : Vec3{};
+                command.m_disp.y = -0.2f;
+            }
+            scene.MoveControllers(commands, flags);
+        }
+
+        for (uint32_t i = 0; i < commands.size(); i++) {
+            auto p1 = commands[i].m_controller.GetPosition();
+            for (uint32_t j = i + 1; j < commands.size(); j++) {
+                auto p2 = commands[j].m_controller.GetPosition();
+                Vec3 diff{p1.x - p2.x, 0, p1.z - p2.z};
+                REQUIRE(Length(diff) > 2 * Radius * 0.95f);
+            }
+        }
+    }
+
+    SECTION("crowd benchmark") {
+        auto scene = ctx.GetMainScene();
+        CrowdSpawner spawner{ctx, scene};
+
+        std::vector<CCTMoveCommand> commands;
+        for (auto& p : MakeGrid(45, 1.5f)) {
+            CCTMoveCommand command;
+            command.m_controller = spawner.Spawn(p);
+            command.m_elapsed_time = DeltaTime;
+            command.m_disp = Vec3{0.01f, -0.2f, 0.01f};
+            commands.push_back(command);
+        }
+        std::vector<Flags<CCTCollisionFlag>> flags(commands.size());
+
+        BENCHMARK("2025 controllers, batched") {
+            scene.MoveControllers(commands, flags);
+            return flags.size();
+        };
+
+        BENCHMARK("2025 controllers, sequential") {
+            for (auto& command : commands) {
+                flags[0] = command.m_controller.MoveAndSlide(
+                    command.m_disp, command.m_min_dist, command.m_elapsed_time);
+            }
+            return flags.size();
+        };
+    }
+}
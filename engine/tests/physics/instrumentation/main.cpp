@@ -0,0 +1,160 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/physics/context.hpp"
+#include "nickel/physics/internal/instrumentation_impl.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::physics;
+
+TEST_CASE("physics profiler ring buffer") {
+    PhysicsProfiler profiler{4};
+
+    std::vector<PhysicsStepTiming> timings;
+    profiler.GetStepTimings(timings);
+    REQUIRE(timings.empty());
+
+    for (uint32_t i = 0; i < 6; i++) {
+        profiler.BeginStep();
+        profiler.EndStep();
+    }
+
+    profiler.GetStepTimings(timings);
+    REQUIRE(timings.size() == 4);
+    for (uint32_t i = 0; i < timings.size(); i++) {
+        REQUIRE(timings[i].m_step == i + 2);
+        REQUIRE(timings[i].m_total >= 0);
+    }
+}
+
+TEST_CASE("PVD file transport streams into file") {
+    auto filename =
+        std::filesystem::temp_directory_path() / "nickel_pvd_capture.pxd2";
+    auto transport = new PvdFileTransport{filename.string(), 8};
+    REQUIRE(transport->connect());
+
+    const uint8_t bytes[] = {1, 2, 3, 4, 5, 6};
+    REQUIRE(transport->write(bytes, 6));
+    transport->flush();
+    // on disk before disconnect
+    REQUIRE(std::filesystem::file_size(filename) == 6);
+
+    // data beyond max size is dropped
+    REQUIRE(transport->write(bytes, 6));
+    REQUIRE(transport->getWrittenDataSize() == 6);
+
+    transport->release();
+    REQUIRE(std::filesystem::file_size(filename) == 6);
+    std::filesystem::remove(filename);
+}
+
+TEST_CASE("instrumentation config from file") {
+    constexpr const char* filename = "physics_instrumentation_test.toml";
+
+    SECTION("fields are parsed") {
+        {
+            std::ofstream file{filename};
+            file << "mode = \"profile\"\n"
+                    "pvd_port = 6000\n"
+                    "profile_capacity = 16\n";
+        }
+        auto config = InstrumentationConfig::LoadFromFile(filename);
+        REQUIRE(config.m_mode == InstrumentationMode::Profile);
+        REQUIRE(config.m_pvd_port == 6000);
+        REQUIRE(config.m_pvd_host == "localhost");
+        REQUIRE(config.m_profile_capacity == 16);
+    }
+
+    SECTION("unknown mode turns instrumentation off") {
+        {
+            std::ofstream file{filename};
+            file << "mode = \"everything\"\n";
+        }
+        auto config = InstrumentationConfig::LoadFromFile(filename);
+        REQUIRE(config.m_mode == InstrumentationMode::Off);
+    }
+
+    std::remove(filename);
+}
+
+TEST_CASE("instrumentation config from content") {
+    auto config = InstrumentationConfig::Parse("mode = \"pvd_file\"\n"
+                                               "pvd_file = \"capture.pxd2\"\n");
+    REQUIRE(config.m_mode == InstrumentationMode::PVDFile);
+    REQUIRE(config.m_pvd_file == Path{"capture.pxd2"});
+
+    config = InstrumentationConfig::Parse("mode = ");
+    REQUIRE(config.m_mode == InstrumentationMode::Off);
+}
+
+TEST_CASE("physics context step timings") {
+    SECTION("off by default") {
+        Context ctx;
+        REQUIRE(ctx.GetInstrumentationConfig().m_mode ==
+                InstrumentationMode::Off);
+        ctx.Update(1.0f / 60.0f);
+
+        std::vector<PhysicsStepTiming> timings;
+        ctx.GetStepTimings(timings);
+        REQUIRE(timings.empty());
+    }
+
+    SECTION("profile mode records every step") {
+        InstrumentationConfig config;
+        config.m_mode = InstrumentationMode::Profile;
+        config.m_profile_capacity = 8;
+        Context ctx{config};
+#if !defined(NICKEL_DEBUG) && !defined(NICKEL_PHYSX_PROFILE)
+        // PhysX has no profile zones, profile mode is refused
+        REQUIRE(ctx.GetInstrumentationConfig().m_mode ==
+                InstrumentationMode::Off);
+        return;
+#endif
+
+        auto material = ctx.CreateMaterial(0.5, 0.5, 0.1);
+        auto scene = ctx.GetMainScene();
+        for (uint32_t i = 0; i < 32; i++) {
+            auto box = ctx.CreateRigidDynamic(Vec3{0, 1.0f + i * 1.1f, 0}, {});
+            auto shape =
+                ctx.CreateShape(BoxGeometry{Vec3{0.5, 0.5, 0.5}}, material);
+            box.AttachShape(shape);
+            scene.AddRigidActor(box);
+        }
+
+        for (uint32_t i = 0; i < 10; i++) {
+            ctx.Update(1.0f / 60.0f);
+        }
+
+        std::vector<PhysicsStepTiming> timings;
+        ctx.GetStepTimings(timings);
+        REQUIRE(timings.size() == 8);
+        REQUIRE(timings.front().m_step == 2);
+        REQUIRE(timings.back().m_step == 9);
+        float phases = 0;
+        for (auto& timing : timings) {
+            REQUIRE(timing.m_total > 0);
+            REQUIRE(timing.m_broadphase >= 0);
+            REQUIRE(timing.m_solver >= 0);
+            phases +=
+                timing.m_broadphase + timing.m_narrowphase + timing.m_solver;
+        }
+        // zones of the PhysX profiler arrive
+        REQUIRE(phases > 0);
+    }
+
+    SECTION("profiler callback installed by someone else is kept") {
+        PhysicsProfiler other{4};
+        PxSetProfilerCallback(&other);
+
+        InstrumentationConfig config;
+        config.m_mode = InstrumentationMode::Profile;
+        {
+            Context ctx{config};
+            REQUIRE(ctx.GetInstrumentationConfig().m_mode ==
+                    InstrumentationMode::Off);
+        }
+        REQUIRE(PxGetProfilerCallback() == &other);
+        PxSetProfilerCallback(nullptr);
+    }
+}
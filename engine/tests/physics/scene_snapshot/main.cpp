@@ -0,0 +1,284 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/physics/context.hpp"
+#include "nickel/physics/internal/context_impl.hpp"
+
+#include <cmath>
+#include <cstring>
+
+using namespace nickel;
+using namespace nickel::physics;
+
+namespace {
+
+constexpr float DeltaTime = 1.0f / 60.0f;
+
+struct TestWorld {
+    explicit TestWorld(Context& ctx) : m_ctx{ctx} {
+        m_scene = ctx.GetMainScene();
+        auto material = ctx.CreateMaterial(0.5, 0.5, 0.1);
+
+        auto ground = ctx.CreateRigidStatic(Vec3{0, -1, 0}, {});
+        auto ground_shape =
+            ctx.CreateShape(BoxGeometry{Vec3{100, 1, 100}}, material);
+        ground.AttachShape(ground_shape);
+        m_scene.AddRigidActor(ground);
+
+        // a box stack, some of it collapses onto the ground
+        for (uint32_t i = 0; i < 12; i++) {
+            auto box = ctx.CreateRigidDynamic(
+                Vec3{(i % 3) * 0.9f, 0.5f + (i / 3) * 1.01f, 0}, {});
+            auto shape =
+                ctx.CreateShape(BoxGeometry{Vec3{0.5, 0.5, 0.5}}, material);
+            box.AttachShape(shape);
+            m_scene.AddRigidActor(box);
+            m_boxes.push_back(box);
+        }
+
+        // two boxes linked by a joint
+        auto link0 = ctx.CreateRigidDynamic(Vec3{-5, 3, 0}, {});
+        auto link1 = ctx.CreateRigidDynamic(Vec3{-5, 4.5, 0}, {});
+        for (auto link : {&link0, &link1}) {
+            auto shape =
+                ctx.CreateShape(BoxGeometry{Vec3{0.3, 0.5, 0.3}}, material);
+            link->AttachShape(shape);
+            m_scene.AddRigidActor(*link);
+            m_boxes.push_back(*link);
+        }
+        m_joint = ctx.GetImpl()->CreateD6Joint(link0, Vec3{0, 0.75, 0}, {},
+                                               link1, Vec3{0, -0.75, 0}, {});
+
+        CapsuleController::Descriptor desc;
+        desc.m_radius = 0.3f;
+        desc.m_height = 1.0f;
+        desc.m_material = material;
+        desc.m_position = Vec3{5, 1.5, 0};
+        m_controller = m_scene.CreateCapsuleController(desc);
+
+        VehicleWheelSim4WDescriptor wheel_desc;
+        for (uint32_t i = 0; i < 4; i++) {
+            VehicleWheelSimDescriptor::WheelDescriptor wheel;
+            wheel.m_suspension.m_sprung_mass = 250;
+            wheel.m_suspension.m_spring_strength = 35000;
+            wheel.m_suspension.m_spring_damper_rate = 4500;
+            wheel.m_wheel_centre_cm_offsets = {i % 2 ? 1.0f : -1.0f, -0.5,
+                                               i / 2 ? 1.5f : -1.5f};
+            wheel_desc.m_wheels.push_back(wheel);
+        }
+        wheel_desc.m_chassis_mass = 1000;
+        wheel_desc.m_front_left_wheel = 0;
+        wheel_desc.m_front_right_wheel = 1;
+        wheel_desc.m_rear_left_wheel = 2;
+        wheel_desc.m_rear_right_wheel = 3;
+
+        m_chassis = ctx.CreateRigidDynamic(Vec3{0, 2, 10}, {});
+        auto chassis_shape =
+            ctx.CreateShape(BoxGeometry{Vec3{1, 0.5, 2}}, material);
+        m_chassis.AttachShape(chassis_shape);
+        m_scene.AddRigidActor(m_chassis);
+        m_vehicle = ctx.GetVehicleManager().CreateVehicleNoDrive(wheel_desc,
+                                                                 m_chassis);
+    }
+
+    // deterministic input stream, a function of frame index only
+    void Step(uint32_t frame) {
+        float phase = static_cast<float>(frame % 40) / 40.0f;
+        for (uint32_t i = 0; i < 4; i++) {
+            m_vehicle.SetDriveTorque(i, phase < 0.5f ? 800.0f : -300.0f);
+            m_vehicle.SetSteerAngle(i, Radians{i < 2 ? phase - 0.5f : 0.0f});
+        }
+        if (frame % 10 == 0) {
+            m_boxes[frame / 10 % m_boxes.size()].AddForce(
+                Vec3{200, 50, 0}, ForceMode::Impulse);
+        }
+        m_controller.MoveAndSlide(
+            Vec3{phase < 0.5f ? 0.05f : -0.05f, -0.2f, 0}, 0.001f, DeltaTime);
+        m_ctx.Update(DeltaTime);
+    }
+
+    // every observable transform, in a fixed order
+    std::vector<float> CaptureState() const {
+        std::vector<float> state;
+        auto push = [&](const Vec3& v) {
+            state.insert(state.end(), {v.x, v.y, v.z});
+        };
+        for (auto& box : m_boxes) {
+            auto transform = box.GetGlobalTransform();
+            push(transform.p);
+            state.insert(state.end(), {transform.q.v.x, transform.q.v.y,
+                                       transform.q.v.z, transform.q.w});
+        }
+        auto chassis = m_chassis.GetGlobalTransform();
+        push(chassis.p);
+        push(m_chassis.GetLinearVelocity());
+        push(m_controller.GetPosition());
+        return state;
+    }
+
+    Context& m_ctx;
+    Scene m_scene;
+    std::vector<RigidDynamic> m_boxes;
+    D6Joint m_joint;
+    CapsuleController m_controller;
+    RigidDynamic m_chassis;
+    VehicleNoDrive m_vehicle;
+};
+
+bool IsBitEqual(const std::vector<float>& a, const std::vector<float>& b) {
+    return a.size() == b.size() &&
+           memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+bool IsNearlyEqual(const std::vector<float>& a, const std::vector<float>& b,
+                   float tolerance) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (std::abs(a[i] - b[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("scene snapshot") {
+    Context ctx;
+    TestWorld world{ctx};
+
+    constexpr uint32_t WarmupFrames = 30;
+    constexpr uint32_t ReplayFrames = 90;
+    for (uint32_t frame = 0; frame < WarmupFrames; frame++) {
+        world.Step(frame);
+    }
+
+    SceneSnapshot snapshot;
+    world.m_scene.TakeSnapshot(snapshot);
+    REQUIRE_FALSE(snapshot.m_data.empty());
+
+    SECTION("restore brings back captured state") {
+        auto before = world.CaptureState();
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            world.Step(WarmupFrames + frame);
+        }
+        REQUIRE_FALSE(IsNearlyEqual(before, world.CaptureState(), 1e-5f));
+
+        REQUIRE(world.m_scene.RestoreSnapshot(snapshot));
+        // PhysX normalizes restored rotations, so only nearly equal
+        auto restored = world.CaptureState();
+        REQUIRE(IsNearlyEqual(before, restored, 1e-5f));
+
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            world.Step(WarmupFrames + frame);
+        }
+        REQUIRE(world.m_scene.RestoreSnapshot(snapshot));
+        REQUIRE(IsBitEqual(restored, world.CaptureState()));
+    }
+
+    SECTION("replay after rewind follows recorded run") {
+        // restored poses are renormalized and contact caches dropped, so the
+        // recorded run starts from the restored snapshot like a rollback does
+        REQUIRE(world.m_scene.RestoreSnapshot(snapshot));
+        std::vector<std::vector<float>> recorded;
+        for (uint32_t frame = 0; frame < ReplayFrames; frame++) {
+            world.Step(WarmupFrames + frame);
+            recorded.push_back(world.CaptureState());
+        }
+
+        for (uint32_t round = 0; round < 2; round++) {
+            REQUIRE(world.m_scene.RestoreSnapshot(snapshot));
+            for (uint32_t frame = 0; frame < ReplayFrames; frame++) {
+                INFO("round " << round << " frame " << frame);
+                world.Step(WarmupFrames + frame);
+                REQUIRE(IsBitEqual(recorded[frame], world.CaptureState()));
+            }
+        }
+    }
+
+    SECTION("mismatched scene is rejected") {
+        for (uint32_t frame = 0; frame < 10; frame++) {
+            world.Step(WarmupFrames + frame);
+        }
+        auto before = world.CaptureState();
+
+        // rejected snapshots must not be partially applied
+        SceneSnapshot broken = snapshot;
+        broken.m_data.resize(broken.m_data.size() / 2);
+        REQUIRE_FALSE(world.m_scene.RestoreSnapshot(broken));
+        REQUIRE(IsBitEqual(before, world.CaptureState()));
+
+        broken = snapshot;
+        broken.m_data.resize(broken.m_data.size() - 1);
+        REQUIRE_FALSE(world.m_scene.RestoreSnapshot(broken));
+        broken = snapshot;
+        broken.m_data.push_back(0);
+        REQUIRE_FALSE(world.m_scene.RestoreSnapshot(broken));
+        REQUIRE(IsBitEqual(before, world.CaptureState()));
+
+        auto box = ctx.CreateRigidDynamic(Vec3{20, 1, 20}, {});
+        auto shape = ctx.CreateShape(BoxGeometry{Vec3{0.5, 0.5, 0.5}},
+                                     ctx.CreateMaterial(0.5, 0.5, 0.1));
+        box.AttachShape(shape);
+        world.m_scene.AddRigidActor(box);
+        REQUIRE_FALSE(world.m_scene.RestoreSnapshot(snapshot));
+    }
+
+    SECTION("rewind benchmark") {
+        BENCHMARK("take snapshot") {
+            world.m_scene.TakeSnapshot(snapshot);
+            return snapshot.m_data.size();
+        };
+        BENCHMARK("restore snapshot") {
+            return world.m_scene.RestoreSnapshot(snapshot);
+        };
+    }
+}
+
+TEST_CASE("scene snapshot replay in rebuilt scene") {
+    constexpr uint32_t WarmupFrames = 30;
+    constexpr uint32_t ReplayFrames = 90;
+
+    SceneSnapshot snapshot;
+    std::vector<std::vector<float>> recorded;
+    {
+        Context ctx;
+        TestWorld world{ctx};
+        for (uint32_t frame = 0; frame < WarmupFrames; frame++) {
+            world.Step(frame);
+        }
+        world.m_scene.TakeSnapshot(snapshot);
+        REQUIRE(world.m_scene.RestoreSnapshot(snapshot));
+        for (uint32_t frame = 0; frame < ReplayFrames; frame++) {
+            world.Step(WarmupFrames + frame);
+            recorded.push_back(world.CaptureState());
+        }
+    }
+
+    // the rebuilt scene has a different history, only the snapshot is shared
+    Context ctx;
+    TestWorld world{ctx};
+    REQUIRE(world.m_scene.RestoreSnapshot(snapshot));
+    for (uint32_t frame = 0; frame < ReplayFrames; frame++) {
+        INFO("frame " << frame);
+        world.Step(WarmupFrames + frame);
+        REQUIRE(IsBitEqual(recorded[frame], world.CaptureState()));
+    }
+}
+
+TEST_CASE("scene snapshot matches objects by id") {
+    SceneSnapshot snapshot;
+    {
+        Context ctx;
+        TestWorld world{ctx};
+        world.m_scene.TakeSnapshot(snapshot);
+    }
+
+    // same object counts, but one extra actor created before the world
+    // shifts every id
+    Context ctx;
+    auto unused = ctx.CreateRigidDynamic(Vec3{}, {});
+    TestWorld world{ctx};
+    REQUIRE_FALSE(world.m_scene.RestoreSnapshot(snapshot));
+}
@@ -0,0 +1,253 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/physics/context.hpp"
+#include "nickel/physics/internal/material_impl.hpp"
+#include "nickel/physics/internal/vehicle_impl.hpp"
+#include "vehicle/PxVehicleUtil.h"
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+#include <fstream>
+
+namespace nickel::physics {
+
+/// white-box access to PhysX friction pairs
+struct VehicleManagerTestAccess {
+    static VehicleManagerImpl& GetImpl(VehicleManager& mgr) {
+        return *mgr.m_impl;
+    }
+};
+
+}  // namespace nickel::physics
+
+using namespace nickel;
+using namespace nickel::physics;
+
+constexpr std::string_view FrictionTableToml = R"(
+surfaces = ["tarmac", "gravel", "ice"]
+tires = ["road", "offroad"]
+default_friction = 0.8
+
+[[pairs]]
+surface = "tarmac"
+tire = "road"
+friction = 1.1
+
+[[pairs]]
+surface = "ice"
+tire = "road"
+friction = 0.1
+
+[[pairs]]
+surface = "mud"
+tire = "road"
+friction = 0.3
+)";
+
+namespace {
+
+bool LoadFrictionTable(VehicleManager& mgr) {
+    auto filename =
+        std::filesystem::temp_directory_path() / "nickel_vehicle_friction.toml";
+    {
+        std::ofstream file{filename};
+        file << FrictionTableToml;
+    }
+    bool loaded = mgr.LoadTireFrictionTable(filename.string());
+    std::filesystem::remove(filename);
+    return loaded;
+}
+
+}  // namespace
+
+TEST_CASE("vehicle tire friction table") {
+    Context ctx;
+    auto& mgr = ctx.GetVehicleManager();
+    auto& impl = VehicleManagerTestAccess::GetImpl(mgr);
+    REQUIRE(LoadFrictionTable(mgr));
+
+    auto tarmac = mgr.GetSurfaceType("tarmac");
+    auto gravel = mgr.GetSurfaceType("gravel");
+    auto ice = mgr.GetSurfaceType("ice");
+    auto road = mgr.GetTireType("road");
+    auto offroad = mgr.GetTireType("offroad");
+    REQUIRE((tarmac && gravel && ice && road && offroad));
+    REQUIRE_FALSE(mgr.GetSurfaceType("mud"));
+
+    REQUIRE(mgr.GetTypePairFriction(*tarmac, *road) == 1.1f);
+    REQUIRE(mgr.GetTypePairFriction(*ice, *road) == 0.1f);
+    REQUIRE(mgr.GetTypePairFriction(*gravel, *offroad) == 0.8f);
+    REQUIRE(impl.m_friction_pairs->getTypePairFriction(*ice, *road) == 0.1f);
+
+    SECTION("material lookup") {
+        auto ice_mtl = ctx.CreateMaterial(0.1, 0.1, 0);
+        auto gravel_mtl = ctx.CreateMaterial(0.6, 0.6, 0);
+        auto unbound_mtl = ctx.CreateMaterial(0.5, 0.5, 0);
+        REQUIRE(mgr.SetSurfaceMaterial(ice_mtl, "ice"));
+        REQUIRE(mgr.SetSurfaceMaterial(gravel_mtl, "gravel"));
+        REQUIRE_FALSE(mgr.SetSurfaceMaterial(unbound_mtl, "mud"));
+
+        auto& pairs = *impl.m_friction_pairs;
+        REQUIRE(pairs.getSurfaceType(*ice_mtl.GetImpl()->m_mtl) == *ice);
+        REQUIRE(pairs.getSurfaceType(*gravel_mtl.GetImpl()->m_mtl) ==
+                *gravel);
+        REQUIRE(pairs.getSurfaceType(*unbound_mtl.GetImpl()->m_mtl) == 0);
+
+        // bound materials carry their table entry for the O(1) lookup
+        REQUIRE(ice_mtl.GetImpl()->m_mtl->userData);
+        REQUIRE_FALSE(unbound_mtl.GetImpl()->m_mtl->userData);
+
+        // rebinding moves the material to another surface
+        REQUIRE(mgr.SetSurfaceMaterial(ice_mtl, "tarmac"));
+        REQUIRE(impl.m_friction_pairs->getSurfaceType(
+                    *ice_mtl.GetImpl()->m_mtl) == *tarmac);
+    }
+
+    SECTION("update in place") {
+        auto* pairs = impl.m_friction_pairs;
+        mgr.SetTypePairFriction(*gravel, *road, 0.5f);
+        REQUIRE(impl.m_friction_pairs == pairs);
+        REQUIRE(mgr.GetTypePairFriction(*gravel, *road) == 0.5f);
+        REQUIRE(pairs->getTypePairFriction(*gravel, *road) == 0.5f);
+
+        // written through to the table, so a reload of it keeps the value
+        mgr.SetTypePairFriction(*tarmac, *road, 1.2f);
+        auto table = mgr.GetTireFrictionTable();
+        auto find_pair = [&](const std::string& surface) {
+            return std::find_if(
+                table.m_pairs.begin(), table.m_pairs.end(), [&](auto& pair) {
+                    return pair.m_surface == surface && pair.m_tire == "road";
+                });
+        };
+        REQUIRE(find_pair("gravel") != table.m_pairs.end());
+        REQUIRE(find_pair("gravel")->m_friction == 0.5f);
+        REQUIRE(find_pair("tarmac")->m_friction == 1.2f);
+        mgr.SetTireFrictionTable(table);
+        REQUIRE(mgr.GetTypePairFriction(*gravel, *road) == 0.5f);
+        REQUIRE(mgr.GetTypePairFriction(*tarmac, *road) == 1.2f);
+    }
+
+    SECTION("replace table keeps material bindings") {
+        auto ice_mtl = ctx.CreateMaterial(0.1, 0.1, 0);
+        REQUIRE(mgr.SetSurfaceMaterial(ice_mtl, "ice"));
+
+        VehicleTireFrictionTable table;
+        table.m_surfaces = {"ice", "tarmac"};
+        table.m_tires = {"road"};
+        table.m_pairs.push_back({"ice", "road", 0.05f});
+        mgr.SetTireFrictionTable(table);
+
+        REQUIRE(mgr.GetSurfaceType("ice") == 0);
+        REQUIRE(impl.m_friction_pairs->getTypePairFriction(
+                    *ice_mtl.GetImpl()->m_mtl, 0) == 0.05f);
+    }
+}
+
+TEST_CASE("vehicle wheels on two surfaces") {
+    Context ctx;
+    auto& mgr = ctx.GetVehicleManager();
+    auto& impl = VehicleManagerTestAccess::GetImpl(mgr);
+    REQUIRE(LoadFrictionTable(mgr));
+    auto tarmac = *mgr.GetSurfaceType("tarmac");
+    auto ice = *mgr.GetSurfaceType("ice");
+    auto road = *mgr.GetTireType("road");
+    auto offroad = *mgr.GetTireType("offroad");
+
+    // left half of the ground is ice, right half is tarmac
+    auto scene = ctx.GetMainScene();
+    auto ice_mtl = ctx.CreateMaterial(0.1, 0.1, 0);
+    auto tarmac_mtl = ctx.CreateMaterial(1.0, 1.0, 0);
+    REQUIRE(mgr.SetSurfaceMaterial(ice_mtl, "ice"));
+    REQUIRE(mgr.SetSurfaceMaterial(tarmac_mtl, "tarmac"));
+    for (auto& [x, mtl] : {std::pair{-20.0f, ice_mtl}, {20.0f, tarmac_mtl}}) {
+        auto ground = ctx.CreateRigidStatic(Vec3{x, -1, 0}, {});
+        auto shape = ctx.CreateShape(BoxGeometry{Vec3{20, 1, 20}}, mtl);
+        ground.AttachShape(shape);
+        scene.AddRigidActor(ground);
+    }
+
+    // wheel 0/1 are front left/right with road tires, rear wheels are offroad
+    VehicleWheelSim4WDescriptor wheel_desc;
+    for (uint32_t i = 0; i < 4; i++) {
+        VehicleWheelSimDescriptor::WheelDescriptor wheel;
+        wheel.m_suspension.m_sprung_mass = 250;
+        wheel.m_suspension.m_spring_strength = 35000;
+        wheel.m_suspension.m_spring_damper_rate = 4500;
+        wheel.m_wheel_centre_cm_offsets = {i % 2 ? 1.0f : -1.0f, -0.5,
+                                           i / 2 ? 1.5f : -1.5f};
+        wheel.m_tire.m_type = i < 2 ? road : offroad;
+        wheel_desc.m_wheels.push_back(wheel);
+    }
+    wheel_desc.m_chassis_mass = 1000;
+    wheel_desc.m_front_left_wheel = 0;
+    wheel_desc.m_front_right_wheel = 1;
+    wheel_desc.m_rear_left_wheel = 2;
+    wheel_desc.m_rear_right_wheel = 3;
+
+    auto chassis = ctx.CreateRigidDynamic(Vec3{0, 1.5, 0}, {});
+    auto chassis_shape =
+        ctx.CreateShape(BoxGeometry{Vec3{0.8, 0.3, 2}}, tarmac_mtl);
+    chassis_shape.SetCollisionGroup(CollisionGroup::VehicleChassis);
+    chassis.AttachShape(chassis_shape);
+    chassis.SetMass(wheel_desc.m_chassis_mass);
+    chassis.SetMassSpaceInertiaTensor(Vec3{1363, 1547, 243});
+    scene.AddRigidActor(chassis);
+    auto vehicle = mgr.CreateVehicleNoDrive(wheel_desc, chassis);
+    REQUIRE(vehicle);
+
+    for (uint32_t i = 0; i < 60; i++) {
+        ctx.Update(1.0f / 60.0f);
+    }
+
+    // rerun the update on the last raycast results and read back what
+    // PhysX actually applied to each wheel
+    auto query_wheels = [&] {
+        std::array<physx::PxWheelQueryResult, 4> wheels;
+        physx::PxVehicleWheelQueryResult result{wheels.data(), wheels.size()};
+        REQUIRE(impl.m_wheels.size() == 1);
+        physx::PxVehicleUpdates(1.0f / 60.0f, {0, -9.8, 0},
+                                *impl.m_friction_pairs, impl.m_wheels.size(),
+                                impl.m_wheels.data(), &result);
+        return wheels;
+    };
+
+    auto wheels = query_wheels();
+    for (auto& wheel : wheels) {
+        REQUIRE_FALSE(wheel.isInAir);
+    }
+    REQUIRE(wheels[0].tireSurfaceMaterial == ice_mtl.GetImpl()->m_mtl);
+    REQUIRE(wheels[0].tireSurfaceType == ice);
+    REQUIRE(wheels[0].tireFriction == 0.1f);
+    REQUIRE(wheels[1].tireSurfaceMaterial == tarmac_mtl.GetImpl()->m_mtl);
+    REQUIRE(wheels[1].tireSurfaceType == tarmac);
+    REQUIRE(wheels[1].tireFriction == 1.1f);
+    REQUIRE(wheels[2].tireFriction == 0.8f);
+    REQUIRE(wheels[3].tireFriction == 0.8f);
+
+    SECTION("update in place reaches the wheels") {
+        mgr.SetTypePairFriction(ice, offroad, 0.2f);
+        wheels = query_wheels();
+        REQUIRE(wheels[2].tireFriction == 0.2f);
+        REQUIRE(wheels[3].tireFriction == 0.8f);
+    }
+
+    SECTION("table with fewer tires clamps tire types") {
+        VehicleTireFrictionTable table;
+        table.m_surfaces = {"default", "ice"};
+        table.m_tires = {"road"};
+        table.m_pairs.push_back({"ice", "road", 0.05f});
+        mgr.SetTireFrictionTable(table);
+
+        auto& sim_data = impl.m_wheels[0]->mWheelsSimData;
+        for (uint32_t i = 0; i < 4; i++) {
+            REQUIRE(sim_data.getTireData(i).mType == 0);
+        }
+
+        // tarmac is gone from the table, its material falls back to type 0
+        wheels = query_wheels();
+        REQUIRE(wheels[0].tireFriction == 0.05f);
+        REQUIRE(wheels[1].tireFriction == 1.0f);
+        REQUIRE(wheels[2].tireFriction == 0.05f);
+        REQUIRE(wheels[3].tireFriction == 1.0f);
+    }
+}
@@ -0,0 +1,155 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/physics/context.hpp"
+#include "nickel/physics/internal/vehicle_impl.hpp"
+
+namespace nickel::physics {
+
+/// white-box access to registry internals
+struct VehicleManagerTestAccess {
+    static VehicleManagerImpl& GetImpl(VehicleManager& mgr) {
+        return *mgr.m_impl;
+    }
+};
+
+}  // namespace nickel::physics
+
+using namespace nickel;
+using namespace nickel::physics;
+
+namespace {
+
+struct VehicleSpawner {
+    explicit VehicleSpawner(Context& ctx) : m_ctx{ctx} {
+        m_material = ctx.CreateMaterial(0.5, 0.5, 0.1);
+
+        for (uint32_t i = 0; i < 4; i++) {
+            VehicleWheelSimDescriptor::WheelDescriptor wheel;
+            wheel.m_suspension.m_sprung_mass = 250;
+            wheel.m_suspension.m_spring_strength = 35000;
+            wheel.m_suspension.m_spring_damper_rate = 4500;
+            wheel.m_wheel_centre_cm_offsets = {i % 2 ? 1.0f : -1.0f, -0.5,
+                                               i / 2 ? 1.5f : -1.5f};
+            m_wheel_desc.m_wheels.push_back(wheel);
+        }
+        m_wheel_desc.m_chassis_mass = 1000;
+        m_wheel_desc.m_front_left_wheel = 0;
+        m_wheel_desc.m_front_right_wheel = 1;
+        m_wheel_desc.m_rear_left_wheel = 2;
+        m_wheel_desc.m_rear_right_wheel = 3;
+    }
+
+    VehicleNoDrive Spawn() {
+        auto actor = m_ctx.CreateRigidDynamic(
+            Vec3{0, 2, static_cast<float>(m_spawned++) * 5.0f}, {});
+        auto shape = m_ctx.CreateShape(BoxGeometry{Vec3{1, 0.5, 2}}, m_material);
+        actor.AttachShape(shape);
+        m_ctx.GetMainScene().AddRigidActor(actor);
+        return m_ctx.GetVehicleManager().CreateVehicleNoDrive(m_wheel_desc,
+                                                              actor);
+    }
+
+private:
+    Context& m_ctx;
+    Material m_material;
+    VehicleWheelSim4WDescriptor m_wheel_desc;
+    uint32_t m_spawned{};
+};
+
+bool IsRegistryConsistent(const VehicleManagerImpl& mgr) {
+    if (mgr.m_vehicles.size() != mgr.m_wheels.size()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < mgr.m_vehicles.size(); i++) {
+        if (mgr.m_vehicles[i]->m_index != i ||
+            mgr.m_vehicles[i]->m_drive != mgr.m_wheels[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("vehicle registry") {
+    Context ctx;
+    auto& mgr = ctx.GetVehicleManager();
+    auto& impl = VehicleManagerTestAccess::GetImpl(mgr);
+    VehicleSpawner spawner{ctx};
+
+    SECTION("swap remove") {
+        std::vector<VehicleNoDrive> vehicles;
+        for (uint32_t i = 0; i < 16; i++) {
+            vehicles.push_back(spawner.Spawn());
+        }
+        REQUIRE(impl.m_vehicles.size() == 16);
+        REQUIRE(IsRegistryConsistent(impl));
+
+        // remove from front, middle and back
+        vehicles.erase(vehicles.begin());
+        vehicles.erase(vehicles.begin() + 7);
+        vehicles.pop_back();
+        mgr.GC();
+
+        REQUIRE(impl.m_vehicles.size() == 13);
+        REQUIRE(IsRegistryConsistent(impl));
+        for (auto& vehicle : vehicles) {
+            REQUIRE(vehicle.GetImpl()->m_index !=
+                    VehicleDriveImpl::InvalidIndex);
+        }
+
+        vehicles.clear();
+        mgr.GC();
+        REQUIRE(impl.m_vehicles.empty());
+        REQUIRE(impl.m_wheels.empty());
+    }
+
+    SECTION("batch query grows geometrically") {
+        std::vector<VehicleNoDrive> vehicles;
+        uint32_t recreate_count = 0;
+        uint32_t capacity = impl.GetBatchQueryCapacity();
+        for (uint32_t i = 0; i < 1000; i++) {
+            vehicles.push_back(spawner.Spawn());
+            mgr.Update(1.0f / 60.0f);
+            if (impl.GetBatchQueryCapacity() != capacity) {
+                REQUIRE(impl.GetBatchQueryCapacity() >= 4 * (i + 1));
+                capacity = impl.GetBatchQueryCapacity();
+                recreate_count++;
+            }
+        }
+        // 4000 wheels starting from PX_MAX_NB_WHEELS capacity
+        REQUIRE(recreate_count <= 10);
+
+        // despawning never shrinks capacity
+        vehicles.resize(10);
+        mgr.GC();
+        mgr.Update(1.0f / 60.0f);
+        REQUIRE(impl.GetBatchQueryCapacity() == capacity);
+    }
+
+    SECTION("spawn/despawn benchmark") {
+        constexpr uint32_t VehicleNum = 1000;
+        constexpr uint32_t ChurnPerFrame = 10;
+
+        std::vector<VehicleNoDrive> vehicles;
+        vehicles.reserve(VehicleNum);
+        for (uint32_t i = 0; i < VehicleNum; i++) {
+            vehicles.push_back(spawner.Spawn());
+        }
+        mgr.Update(1.0f / 60.0f);
+
+        uint32_t cursor = 0;
+        BENCHMARK("1000 vehicles, 10 spawn + 10 despawn per frame") {
+            for (uint32_t i = 0; i < ChurnPerFrame; i++) {
+                vehicles[cursor] = spawner.Spawn();
+                cursor = (cursor + 7) % VehicleNum;
+            }
+            mgr.GC();
+            mgr.Update(1.0f / 60.0f);
+            return impl.m_vehicles.size();
+        };
+
+        REQUIRE(impl.m_vehicles.size() == VehicleNum);
+        REQUIRE(IsRegistryConsistent(impl));
+    }
+}
@@ -0,0 +1,264 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/common/thread_pool.hpp"
+#include "nickel/graphics/animation.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+
+#include <fstream>
+#include <future>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+std::unique_ptr<GLTFParsedModel> Parse(const Path& filename) {
+    std::ifstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    return ParseGLTFModel(filename, {std::istreambuf_iterator<char>{file},
+                                     std::istreambuf_iterator<char>{}});
+}
+
+const tinygltf::Model& CesiumMan() {
+    static auto parsed =
+        Parse("engine/assets/models/CesiumMan/CesiumMan.gltf");
+    return parsed->m_gltf_model;
+}
+
+template <typename T>
+std::vector<T> ReadAccessor(const tinygltf::Model& model, int accessor,
+                            int type) {
+    std::vector<unsigned char> buffer;
+    CopyBufferFromGLTF<float>(buffer, type, model.accessors[accessor], model);
+    std::vector<T> result(model.accessors[accessor].count);
+    memcpy(result.data(), buffer.data(), buffer.size());
+    return result;
+}
+
+bool Near(float a, float b, float epsilon = 1e-4f) {
+    return std::abs(a - b) <= epsilon;
+}
+
+bool Near(const Vec3& a, const Vec3& b, float epsilon = 1e-4f) {
+    return Length(a - b) <= epsilon;
+}
+
+Vec3 TransformPoint(const Mat44& m, const Vec3& p) {
+    Vec4 result = m * Vec4{p.x, p.y, p.z, 1};
+    return Vec3(result.x, result.y, result.z);
+}
+
+// one character: sample its clip and compute the palette
+struct Character {
+    const GLTFSkin* m_skin{};
+    float m_time{};
+    std::vector<JointTransform4> m_pose;
+    std::vector<Mat44> m_palette;
+
+    void Update(float delta_time) {
+        m_time += delta_time;
+        SampleAnimation(m_skin->m_clips[0], m_time, true, m_pose);
+        ComputeJointPalette(m_skin->m_skeleton, m_pose, m_palette);
+    }
+};
+
+}  // namespace
+
+TEST_CASE("load skeleton & clip") {
+    auto& model = CesiumMan();
+    auto skins = LoadSkins(model);
+    REQUIRE(skins.size() == 1);
+    auto& skeleton = skins[0].m_skeleton;
+    REQUIRE(skeleton.GetJointCount() == model.skins[0].joints.size());
+    REQUIRE(skeleton.m_rest_pose.size() ==
+            GetJointGroupCount(skeleton.GetJointCount()));
+
+    // parents come first
+    std::vector<bool> visited(skeleton.GetJointCount());
+    for (auto joint : skeleton.m_order) {
+        int32_t parent = skeleton.m_parents[joint];
+        REQUIRE((parent == -1 || visited[parent]));
+        visited[joint] = true;
+    }
+    REQUIRE(std::count(skeleton.m_parents.begin(), skeleton.m_parents.end(),
+                       -1) == 1);
+
+    REQUIRE(skins[0].m_clips.size() == 1);
+    auto& clip = skins[0].m_clips[0];
+    REQUIRE(Near(clip.m_duration, 2.0f));
+    REQUIRE(clip.GetFrameCount() == 61);
+    REQUIRE(clip.m_joint_count == skeleton.GetJointCount());
+}
+
+TEST_CASE("sampled poses match key frames") {
+    auto& model = CesiumMan();
+    auto skins = LoadSkins(model);
+    auto& clip = skins[0].m_clips[0];
+    auto& joints = model.skins[0].joints;
+    std::vector<JointTransform4> pose(GetJointGroupCount(clip.m_joint_count));
+
+    // keys are at 24 fps, clip at 30 fps, both hit multiples of 1/6 second
+    for (float time : {0.5f, 1.0f, 1.5f}) {
+        SampleAnimation(clip, time, false, pose);
+        for (auto& channel : model.animations[0].channels) {
+            auto joint = std::find(joints.begin(), joints.end(),
+                                   channel.target_node) -
+                         joints.begin();
+            REQUIRE(joint < joints.size());
+            auto& sampler = model.animations[0].samplers[channel.sampler];
+            auto times =
+                ReadAccessor<float>(model, sampler.input, TINYGLTF_TYPE_SCALAR);
+            auto key = std::min_element(times.begin(), times.end(),
+                                        [=](float a, float b) {
+                                            return std::abs(a - time) <
+                                                   std::abs(b - time);
+                                        }) -
+                       times.begin();
+            REQUIRE(Near(times[key], time, 1e-3f));
+
+            Vec3 translation, scale;
+            Quat rotation;
+            GetJointTransform(pose, joint, translation, rotation, scale);
+            if (channel.target_path == "rotation") {
+                auto values = ReadAccessor<Vec4>(model, sampler.output,
+                                                 TINYGLTF_TYPE_VEC4);
+                Vec4 expect = values[key];
+                // q and -q are the same rotation
+                float dot = expect.x * rotation.v.x + expect.y * rotation.v.y +
+                            expect.z * rotation.v.z + expect.w * rotation.w;
+                REQUIRE(Near(std::abs(dot), 1.0f, 1e-3f));
+            } else {
+                auto values = ReadAccessor<Vec3>(model, sampler.output,
+                                                 TINYGLTF_TYPE_VEC3);
+                Vec3 actual =
+                    channel.target_path == "scale" ? scale : translation;
+                REQUIRE(Near(actual, values[key], 1e-3f));
+            }
+        }
+    }
+}
+
+TEST_CASE("SIMD sampling equals scalar") {
+    auto skins = LoadSkins(CesiumMan());
+    auto& clip = skins[0].m_clips[0];
+    uint32_t groups = GetJointGroupCount(clip.m_joint_count);
+    std::vector<JointTransform4> pose(groups), scalar_pose(groups);
+    for (float time = -0.3f; time < 5.0f; time += 0.123f) {
+        for (bool loop : {true, false}) {
+            SampleAnimation(clip, time, loop, pose);
+            SampleAnimationScalar(clip, time, loop, scalar_pose);
+            for (uint32_t joint = 0; joint < clip.m_joint_count; joint++) {
+                Vec3 t1, s1, t2, s2;
+                Quat r1, r2;
+                GetJointTransform(pose, joint, t1, r1, s1);
+                GetJointTransform(scalar_pose, joint, t2, r2, s2);
+                REQUIRE(Near(t1, t2));
+                REQUIRE(Near(s1, s2));
+                REQUIRE(Near(r1.v, r2.v));
+                REQUIRE(Near(r1.w, r2.w));
+                REQUIRE(Near(r1.Length(), 1.0f));
+            }
+        }
+    }
+}
+
+TEST_CASE("rest pose palette reproduces bind pose mesh") {
+    auto& model = CesiumMan();
+    auto skins = LoadSkins(model);
+    auto& skeleton = skins[0].m_skeleton;
+    std::vector<Mat44> palette(skeleton.GetJointCount());
+    ComputeJointPalette(skeleton, skeleton.m_rest_pose, palette);
+
+    // mesh node is a sibling of the root joint, both under the same nodes
+    int mesh_node = -1;
+    for (int i = 0; i < model.nodes.size(); i++) {
+        if (model.nodes[i].skin == 0) {
+            mesh_node = i;
+        }
+    }
+    REQUIRE(mesh_node != -1);
+    Mat44 mesh_transform = CalcNodeTransform(model.nodes[mesh_node]);
+    for (int node = 0; node < model.nodes.size(); node++) {
+        auto& children = model.nodes[node].children;
+        if (std::find(children.begin(), children.end(), mesh_node) !=
+            children.end()) {
+            mesh_transform = CalcNodeTransform(model.nodes[node]) *
+                             mesh_transform;
+            mesh_node = node;
+            node = -1;
+        }
+    }
+
+    auto& prim = model.meshes[0].primitives[0];
+    GLTFPrimitiveGeometry geometry;
+    REQUIRE(BuildPrimitiveGeometry(model, prim, {}, geometry));
+    REQUIRE(geometry.m_layout == VertexLayout::Float);
+    REQUIRE(geometry.m_meshlets.empty());
+    REQUIRE(geometry.m_skin_vertices.size() == geometry.m_vertex_count);
+
+    auto vertices = reinterpret_cast<const GLTFVertex*>(
+        geometry.m_vertices.data());
+    for (uint32_t i = 0; i < geometry.m_vertex_count; i++) {
+        auto& skin = geometry.m_skin_vertices[i];
+        uint32_t weight_sum = 0;
+        Vec3 skinned;
+        for (int j = 0; j < 4; j++) {
+            weight_sum += skin.m_weights[j];
+            REQUIRE(skin.m_joints[j] < skeleton.GetJointCount());
+            float weight = skin.m_weights[j] / 65535.0f;
+            skinned = skinned + TransformPoint(palette[skin.m_joints[j]],
+                                               vertices[i].m_position) *
+                                    weight;
+        }
+        REQUIRE(weight_sum == 65535);
+        REQUIRE(Near(skinned,
+                     TransformPoint(mesh_transform, vertices[i].m_position),
+                     1e-3f));
+    }
+}
+
+TEST_CASE("animate 1000 characters") {
+    auto skins = LoadSkins(CesiumMan());
+    auto& skin = skins[0];
+    constexpr uint32_t CharacterCount = 1000;
+    std::vector<Character> characters(CharacterCount);
+    for (uint32_t i = 0; i < CharacterCount; i++) {
+        auto& character = characters[i];
+        character.m_skin = &skin;
+        character.m_time = i * 0.013f;
+        character.m_pose = skin.m_skeleton.m_rest_pose;
+        character.m_palette.resize(skin.m_skeleton.GetJointCount());
+    }
+
+    ThreadPool pool;
+    INFO(CharacterCount << " characters, "
+                        << skin.m_skeleton.GetJointCount() << " joints, "
+                        << pool.GetThreadNum() << " worker threads");
+
+    BENCHMARK("serial") {
+        for (auto& character : characters) {
+            character.Update(1.0f / 60.0f);
+        }
+        return characters[0].m_palette[0][3].x;
+    };
+
+    BENCHMARK("thread pool") {
+        uint32_t workers = pool.GetThreadNum() + 1;
+        size_t chunk = (characters.size() + workers - 1) / workers;
+        std::vector<std::future<void>> futures;
+        for (size_t begin = chunk; begin < characters.size(); begin += chunk) {
+            futures.push_back(pool.Submit([&, begin] {
+                size_t end = std::min(begin + chunk, characters.size());
+                for (size_t i = begin; i < end; i++) {
+                    characters[i].Update(1.0f / 60.0f);
+                }
+            }));
+        }
+        for (size_t i = 0; i < chunk; i++) {
+            characters[i].Update(1.0f / 60.0f);
+        }
+        for (auto& future : futures) {
+            future.wait();
+        }
+        return characters[0].m_palette[0][3].x;
+    };
+}
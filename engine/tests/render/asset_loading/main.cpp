@@ -0,0 +1,177 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/common/async_handle.hpp"
+#include "nickel/common/macro.hpp"
+#include "nickel/common/thread_pool.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+#include "nickel/graphics/lowlevel/common.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+constexpr const char* ModelDir = "engine/assets/models";
+
+std::vector<char> ReadFile(const Path& filename) {
+    std::ifstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    return {std::istreambuf_iterator<char>{file},
+            std::istreambuf_iterator<char>{}};
+}
+
+std::vector<Path> CollectModels() {
+    std::vector<Path> models;
+    for (auto& entry :
+         std::filesystem::recursive_directory_iterator{ModelDir}) {
+        if (entry.path().extension() == ".gltf") {
+            models.emplace_back(entry.path().string());
+        }
+    }
+    std::ranges::sort(models, [](const Path& a, const Path& b) {
+        return a.ToString() < b.ToString();
+    });
+    return models;
+}
+
+struct LoadedModel {
+    std::unique_ptr<GLTFParsedModel> m_parsed;
+    std::vector<ImageRawData> m_images;
+};
+
+// the CPU part of `GLTFManager::Load`, GPU upload is left out
+LoadedModel LoadSerial(const Path& filename) {
+    LoadedModel model;
+    model.m_parsed = ParseGLTFModel(filename, ReadFile(filename));
+    if (model.m_parsed) {
+        for (auto& image : model.m_parsed->m_images) {
+            auto content = ReadFile(image.m_filename);
+            model.m_images.emplace_back(content.data(), content.size());
+        }
+    }
+    return model;
+}
+
+// the CPU part of `GLTFManager::LoadAsync`: all models parse in parallel,
+// then all their images decode in parallel
+std::vector<LoadedModel> LoadConcurrent(ThreadPool& pool,
+                                        const std::vector<Path>& filenames) {
+    std::vector<std::future<std::unique_ptr<GLTFParsedModel>>> parse_futures;
+    for (auto& filename : filenames) {
+        parse_futures.push_back(pool.Submit([filename] {
+            return ParseGLTFModel(filename, ReadFile(filename));
+        }));
+    }
+
+    std::vector<LoadedModel> models(filenames.size());
+    std::vector<std::vector<std::future<ImageRawData>>> image_futures(
+        filenames.size());
+    for (size_t i = 0; i < filenames.size(); i++) {
+        models[i].m_parsed = parse_futures[i].get();
+        NICKEL_CONTINUE_IF_FALSE(models[i].m_parsed);
+        for (auto& image : models[i].m_parsed->m_images) {
+            image_futures[i].push_back(
+                pool.Submit([filename = image.m_filename] {
+                    auto content = ReadFile(filename);
+                    return ImageRawData{content.data(), content.size()};
+                }));
+        }
+    }
+    for (size_t i = 0; i < filenames.size(); i++) {
+        for (auto& future : image_futures[i]) {
+            models[i].m_images.push_back(future.get());
+        }
+    }
+    return models;
+}
+
+}  // namespace
+
+TEST_CASE("thread pool") {
+    ThreadPool pool{4};
+    REQUIRE(pool.GetThreadNum() == 4);
+
+    std::atomic<uint32_t> counter{};
+    std::vector<std::future<uint32_t>> futures;
+    for (uint32_t i = 0; i < 100; i++) {
+        futures.push_back(pool.Submit([i, &counter] {
+            counter++;
+            return i * 2;
+        }));
+    }
+    for (uint32_t i = 0; i < 100; i++) {
+        REQUIRE(futures[i].get() == i * 2);
+    }
+    REQUIRE(counter == 100);
+
+    SECTION("destructor finishes queued jobs") {
+        std::atomic<uint32_t> done{};
+        {
+            ThreadPool small_pool{1};
+            for (uint32_t i = 0; i < 10; i++) {
+                small_pool.Submit([&done] { done++; });
+            }
+        }
+        REQUIRE(done == 10);
+    }
+}
+
+TEST_CASE("async handle state") {
+    AsyncHandle<int> empty;
+    REQUIRE_FALSE(empty);
+    REQUIRE(empty.IsFailed());
+
+    auto handle = AsyncHandle<int>::CreatePending();
+    auto copy = handle;
+    REQUIRE(copy.IsPending());
+    REQUIRE(copy.Get() == 0);
+
+    handle.Resolve(42);
+    REQUIRE(copy.IsReady());
+    REQUIRE(copy.Get() == 42);
+
+    auto failed = AsyncHandle<int>::CreateFailed();
+    REQUIRE(failed);
+    REQUIRE(failed.GetState() == AssetLoadState::Failed);
+}
+
+TEST_CASE("load all models concurrently") {
+    auto filenames = CollectModels();
+    REQUIRE(filenames.size() >= 4);
+
+    ThreadPool pool;
+    auto concurrent = LoadConcurrent(pool, filenames);
+    REQUIRE(concurrent.size() == filenames.size());
+
+    for (size_t i = 0; i < filenames.size(); i++) {
+        INFO(filenames[i]);
+        auto serial = LoadSerial(filenames[i]);
+        REQUIRE(serial.m_parsed);
+        REQUIRE(concurrent[i].m_parsed);
+        REQUIRE(concurrent[i].m_parsed->m_gltf_model.nodes.size() ==
+                serial.m_parsed->m_gltf_model.nodes.size());
+        REQUIRE(concurrent[i].m_images.size() == serial.m_images.size());
+        // some images may be missing from checkout (e.g. git lfs pointers),
+        // both paths must agree on those as well
+        for (size_t j = 0; j < serial.m_images.size(); j++) {
+            REQUIRE(bool(concurrent[i].m_images[j]) ==
+                    bool(serial.m_images[j]));
+            REQUIRE(concurrent[i].m_images[j].GetExtent() ==
+                    serial.m_images[j].GetExtent());
+        }
+    }
+
+    BENCHMARK("serial load all models") {
+        std::vector<LoadedModel> models;
+        for (auto& filename : filenames) {
+            models.push_back(LoadSerial(filename));
+        }
+        return models.size();
+    };
+    BENCHMARK("concurrent load all models") {
+        return LoadConcurrent(pool, filenames).size();
+    };
+}
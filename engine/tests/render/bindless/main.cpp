@@ -0,0 +1,65 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/internal/bindless.hpp"
+
+#include <set>
+
+using namespace nickel::graphics;
+
+TEST_CASE("bindless slots are unique until capacity") {
+    BindlessSlotAllocator allocator{16, 2};
+    std::set<uint32_t> slots;
+    for (uint32_t i = 0; i < 16; i++) {
+        auto slot = allocator.Allocate();
+        REQUIRE(slot);
+        REQUIRE(*slot < 16);
+        slots.insert(*slot);
+    }
+    REQUIRE(slots.size() == 16);
+    REQUIRE(allocator.GetAllocatedCount() == 16);
+    REQUIRE(!allocator.Allocate());
+}
+
+TEST_CASE("freed bindless slot is reused after delay") {
+    BindlessSlotAllocator allocator{2, 2};
+    auto first = allocator.Allocate();
+    auto second = allocator.Allocate();
+    REQUIRE(first);
+    REQUIRE(second);
+
+    allocator.Free(*first);
+    REQUIRE(allocator.GetAllocatedCount() == 1);
+
+    // frames in flight may still read the slot
+    REQUIRE(!allocator.Allocate());
+    allocator.EndFrame();
+    REQUIRE(!allocator.Allocate());
+    allocator.EndFrame();
+
+    auto reused = allocator.Allocate();
+    REQUIRE(reused == first);
+    REQUIRE(allocator.GetAllocatedCount() == 2);
+}
+
+TEST_CASE("bindless slot without delay is reused at once") {
+    BindlessSlotAllocator allocator{1, 0};
+    auto slot = allocator.Allocate();
+    REQUIRE(slot);
+    allocator.Free(*slot);
+    REQUIRE(allocator.Allocate() == slot);
+}
+
+TEST_CASE("freeing unallocated bindless slot is ignored") {
+    BindlessSlotAllocator allocator{4, 1};
+    auto slot = allocator.Allocate();
+    REQUIRE(slot);
+    allocator.Free(*slot);
+    allocator.Free(*slot);
+    allocator.Free(3);
+    allocator.EndFrame();
+
+    REQUIRE(allocator.Allocate());
+    REQUIRE(allocator.Allocate());
+    REQUIRE(allocator.Allocate());
+    REQUIRE(allocator.Allocate());
+    REQUIRE(!allocator.Allocate());
+}
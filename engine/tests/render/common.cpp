@@ -34,7 +34,7 @@ void RenderTestCommonContext::EndFrame() {
     device.EndFrame();
 
     m_render_frame_index = (m_render_frame_index + 1) %
-                           device.GetSwapchainImageInfo().m_image_count;
+                           device.GetFramesInFlight();
 }
 
 uint32_t RenderTestCommonContext::CurFrameIdx() const {
@@ -44,9 +44,7 @@ uint32_t RenderTestCommonContext::CurFrameIdx() const {
 void RenderTestCommonContext::initSyncObjects() {
     auto device = nickel::Context::GetInst().GetGPUAdapter().GetDevice();
 
-    uint32_t swapchain_image_count =
-        device.GetSwapchainImageInfo().m_image_count;
-    for (uint32_t i = 0; i < swapchain_image_count; i++) {
+    for (uint32_t i = 0; i < device.GetFramesInFlight(); i++) {
         m_present_fences.push_back(device.CreateFence(true));
         m_image_avaliable_sems.push_back(device.CreateSemaphore());
         m_render_finish_sems.push_back(device.CreateSemaphore());
@@ -0,0 +1,158 @@
+#include "../gpu_test.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/common/common.hpp"
+#include "nickel/graphics/lowlevel/adapter.hpp"
+#include "nickel/graphics/lowlevel/compute_pipeline.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+constexpr const char* PrefixSumShader =
+    "tests/render/compute/prefix_sum.comp.spv";
+constexpr uint32_t LocalSize = 256;
+
+struct PrefixSumConstant {
+    uint32_t m_pass{};
+    uint32_t m_count{};
+};
+
+// engine storage needs a running context, read directly instead
+std::vector<char> ReadFile(const char* filename) {
+    std::ifstream file{filename, std::ios::binary};
+    return {std::istreambuf_iterator<char>{file},
+            std::istreambuf_iterator<char>{}};
+}
+
+Buffer CreateStorageBuffer(Device& device, uint64_t size,
+                           Flags<BufferUsage> usage = BufferUsage::Storage) {
+    Buffer::Descriptor desc;
+    desc.m_size = size;
+    desc.m_usage = usage;
+    desc.m_memory_type = MemoryType::Coherence;
+    return device.CreateBuffer(desc);
+}
+
+}  // namespace
+
+TEST_CASE("indirect command layout") {
+    static_assert(sizeof(DrawIndirectCommand) == 16);
+    static_assert(sizeof(DrawIndexedIndirectCommand) == 20);
+    static_assert(sizeof(DispatchIndirectCommand) == 12);
+
+    REQUIRE(CalcWorkgroupCount(0, 64) == 0);
+    REQUIRE(CalcWorkgroupCount(1, 64) == 1);
+    REQUIRE(CalcWorkgroupCount(64, 64) == 1);
+    REQUIRE(CalcWorkgroupCount(65, 64) == 2);
+    REQUIRE(CalcWorkgroupCount(10, 0) == 0);
+}
+
+TEST_CASE("prefix sum compute shader", "[gpu]") {
+    if (!std::filesystem::exists(PrefixSumShader)) {
+        SKIP("prefix sum shader not compiled, glslc is missing");
+    }
+
+    auto adapter = CreateGPUTestAdapter();
+    Device device = adapter->GetDevice();
+
+    constexpr uint32_t Count = 10000;
+    uint32_t block_count = CalcWorkgroupCount(Count, LocalSize);
+
+    std::vector<uint32_t> values(Count);
+    for (uint32_t i = 0; i < Count; i++) {
+        values[i] = i % 7 + 1;
+    }
+
+    Buffer data = CreateStorageBuffer(device, Count * sizeof(uint32_t));
+    Buffer sums = CreateStorageBuffer(device, LocalSize * sizeof(uint32_t));
+    Buffer dispatch = CreateStorageBuffer(device,
+                                          sizeof(DispatchIndirectCommand),
+                                          BufferUsage::Indirect);
+    data.MapAsync();
+    memcpy(data.GetMappedRange(), values.data(), Count * sizeof(uint32_t));
+    data.Unmap();
+
+    // last pass takes its size from GPU memory
+    DispatchIndirectCommand dispatch_cmd{block_count, 1, 1};
+    dispatch.MapAsync();
+    memcpy(dispatch.GetMappedRange(), &dispatch_cmd, sizeof(dispatch_cmd));
+    dispatch.Unmap();
+
+    BindGroupLayout::Descriptor layout_desc;
+    BindGroup::Descriptor group_desc;
+    Buffer buffers[] = {data, sums};
+    for (uint32_t slot = 0; slot < 2; slot++) {
+        BindGroupLayout::Entry layout_entry;
+        layout_entry.m_shader_stage = ShaderStage::Compute;
+        layout_entry.m_type = BindGroupEntryType::StorageBuffer;
+        layout_desc.m_entries[slot] = layout_entry;
+
+        BindGroup::BufferBinding binding;
+        binding.m_type = BindGroup::BufferBinding::Type::Storage;
+        binding.m_buffer = buffers[slot];
+        BindGroup::Entry entry;
+        entry.m_binding.m_entry = binding;
+        entry.m_shader_stage = ShaderStage::Compute;
+        group_desc.m_entries[slot] = entry;
+    }
+    BindGroupLayout bind_group_layout =
+        device.CreateBindGroupLayout(layout_desc);
+    BindGroup bind_group = bind_group_layout.RequireBindGroup(group_desc);
+
+    PipelineLayout::Descriptor pipeline_layout_desc;
+    pipeline_layout_desc.m_layouts.push_back(bind_group_layout);
+    PipelineLayout::Descriptor::PushConstantRange range;
+    range.m_shader_stage = ShaderStage::Compute;
+    range.m_size = sizeof(PrefixSumConstant);
+    pipeline_layout_desc.m_push_contants.push_back(range);
+
+    auto code = ReadFile(PrefixSumShader);
+    ComputePipeline::Descriptor pipeline_desc;
+    pipeline_desc.m_module =
+        device.CreateShaderModule((uint32_t*)code.data(), code.size());
+    pipeline_desc.m_layout =
+        device.CreatePipelineLayout(pipeline_layout_desc);
+    ComputePipeline pipeline = device.CreateComputePipeline(pipeline_desc);
+    REQUIRE(pipeline);
+
+    CommandEncoder encoder = device.CreateCommandEncoder();
+    ComputePassEncoder pass = encoder.BeginComputePass();
+    pass.BindComputePipeline(pipeline);
+    pass.SetBindGroup(0, bind_group);
+
+    PrefixSumConstant constant{0, Count};
+    pass.SetPushConstant(&constant, 0, sizeof(constant));
+    pass.Dispatch(block_count, 1, 1);
+
+    constant = {1, block_count};
+    pass.SetPushConstant(&constant, 0, sizeof(constant));
+    pass.Dispatch(1, 1, 1);
+
+    constant = {2, Count};
+    pass.SetPushConstant(&constant, 0, sizeof(constant));
+    pass.DispatchIndirect(dispatch, 0);
+    pass.End();
+
+    Command cmd = encoder.Finish();
+    device.Submit(cmd, {}, {}, {});
+    device.WaitIdle();
+
+    std::vector<uint32_t> result(Count);
+    data.MapAsync();
+    memcpy(result.data(), data.GetMappedRange(), Count * sizeof(uint32_t));
+    data.Unmap();
+
+    uint32_t expect = 0;
+    uint32_t mismatch = 0;
+    for (uint32_t i = 0; i < Count; i++) {
+        expect += values[i];
+        mismatch += result[i] != expect;
+    }
+    REQUIRE(mismatch == 0);
+    RequireNoValidationErrors(*adapter);
+}
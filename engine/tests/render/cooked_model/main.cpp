@@ -0,0 +1,273 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/fs/mapped_file.hpp"
+#include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/internal/cooked_model.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+constexpr const char* TruckFilename =
+    "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.gltf";
+constexpr const char* SphereFilename =
+    "engine/assets/models/unit_sphere/unit_sphere.gltf";
+
+tinygltf::Model LoadGLTF(const Path& filename) {
+    tinygltf::TinyGLTF loader;
+    tinygltf::Model model;
+    std::string err, warn;
+    REQUIRE(loader.LoadASCIIFromFile(&model, &err, &warn, filename.ToString()));
+    return model;
+}
+
+template <typename T>
+std::span<T> GetSection(std::vector<unsigned char>& data,
+                        CookedSection section) {
+    CookedModelHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    auto& range = header.m_sections[static_cast<uint32_t>(section)];
+    return {reinterpret_cast<T*>(data.data() + range.m_offset),
+            range.m_size / sizeof(T)};
+}
+
+// cooked outputs of tests stay out of the source tree
+Path TempCookedFilename(const char* name) {
+    return Path{
+        (std::filesystem::temp_directory_path() / name).generic_string()};
+}
+
+void WriteFile(const Path& filename, std::span<const unsigned char> data) {
+    std::ofstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    file.write((const char*)data.data(), data.size());
+}
+
+using Triangle = std::array<Vec3, 3>;
+
+// optimization reorders triangles and welds vertices, compare the triangle
+// sets instead of raw buffers
+std::vector<Triangle> CollectTriangles(const GLTFVertexData& data) {
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i + 2 < data.m_indices.size(); i += 3) {
+        triangles.push_back({data.m_points[data.m_indices[i]],
+                             data.m_points[data.m_indices[i + 1]],
+                             data.m_points[data.m_indices[i + 2]]});
+    }
+    auto less = [](const Vec3& a, const Vec3& b) {
+        for (int i = 0; i < 3; i++) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i];
+            }
+        }
+        return false;
+    };
+    std::sort(triangles.begin(), triangles.end(),
+              [&](const Triangle& a, const Triangle& b) {
+                  return std::lexicographical_compare(
+                      a.begin(), a.end(), b.begin(), b.end(), less);
+              });
+    return triangles;
+}
+
+}  // namespace
+
+TEST_CASE("cook glTF model") {
+    auto gltf_model = LoadGLTF(TruckFilename);
+    auto data = CookGLTFModel(gltf_model);
+    CookedModelView view{data};
+    REQUIRE(view.IsValid());
+
+    REQUIRE(view.GetNodes().size() == gltf_model.nodes.size());
+    REQUIRE(view.GetMeshes().size() == gltf_model.meshes.size());
+    REQUIRE(view.GetMaterials().size() == gltf_model.materials.size());
+    REQUIRE(view.GetImages().size() == gltf_model.images.size());
+    REQUIRE(view.GetRootNodes().size() == gltf_model.scenes[0].nodes.size());
+
+    for (size_t i = 0; i < gltf_model.nodes.size(); i++) {
+        auto& node = view.GetNodes()[i];
+        REQUIRE(view.GetString(node.m_name) == gltf_model.nodes[i].name);
+        REQUIRE(node.m_mesh == gltf_model.nodes[i].mesh);
+        REQUIRE(view.GetNodeChildren(node).size() ==
+                gltf_model.nodes[i].children.size());
+    }
+
+    auto vertex_data = view.GetVertexData();
+    auto index_data = view.GetIndexData();
+    for (auto& mesh : view.GetMeshes()) {
+        for (auto& prim : view.GetPrimitives(mesh)) {
+            uint32_t vertex_count = prim.m_vertices.m_count;
+            uint32_t stride = GetVertexStride(
+                static_cast<VertexLayout>(prim.m_vertex_layout));
+            REQUIRE(vertex_count > 0);
+            REQUIRE(prim.m_vertices.m_size == vertex_count * stride);
+            REQUIRE(prim.m_vertices.m_offset % 4 == 0);
+            REQUIRE(prim.m_indices.m_offset % 4 == 0);
+
+            for (uint32_t v = 0; v < vertex_count; v++) {
+                Vec3 p;
+                memcpy(&p,
+                       vertex_data.data() + prim.m_vertices.m_offset +
+                           v * stride,
+                       sizeof(Vec3));
+                for (int i = 0; i < 3; i++) {
+                    REQUIRE(p[i] >= prim.m_bounds.m_min[i]);
+                    REQUIRE(p[i] <= prim.m_bounds.m_max[i]);
+                    REQUIRE(p[i] >= mesh.m_bounds.m_min[i]);
+                    REQUIRE(p[i] <= mesh.m_bounds.m_max[i]);
+                }
+            }
+
+            auto indices = ReadIndices(
+                index_data.data() + prim.m_indices.m_offset,
+                prim.m_indices.m_count,
+                static_cast<IndexType>(prim.m_index_type));
+            REQUIRE(indices.size() % 3 == 0);
+            for (auto index : indices) {
+                REQUIRE(index < vertex_count);
+            }
+        }
+    }
+
+    // image uri is relative to the package, which sits beside the glTF
+    for (auto& image : view.GetImages()) {
+        Path uri{view.GetString(image.m_uri)};
+        REQUIRE(std::filesystem::exists(
+            (Path{TruckFilename}.ParentPath() / uri).GetUnderlyingPath()));
+    }
+}
+
+TEST_CASE("cooked model matches glTF vertex data") {
+    Path cooked_filename =
+        TempCookedFilename("cooked_model_test_sphere.nkmodel");
+    REQUIRE(CookGLTFFile(SphereFilename, cooked_filename));
+
+    GLTFVertexDataLoader loader;
+    auto expect = loader.Load(SphereFilename);
+    auto cooked = loader.Load(cooked_filename);
+    REQUIRE(expect.size() == cooked.size());
+    for (size_t i = 0; i < expect.size(); i++) {
+        REQUIRE(expect[i].m_name == cooked[i].m_name);
+        REQUIRE(CollectTriangles(expect[i]) == CollectTriangles(cooked[i]));
+        REQUIRE(cooked[i].m_points.size() <= expect[i].m_points.size());
+    }
+
+    std::filesystem::remove(cooked_filename.GetUnderlyingPath());
+}
+
+TEST_CASE("broken cooked model is rejected") {
+    auto data = CookGLTFModel(LoadGLTF(SphereFilename));
+    REQUIRE(CookedModelView{data}.IsValid());
+
+    SECTION("truncated") {
+        data.resize(data.size() / 2);
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+
+    SECTION("bad magic") {
+        data[0] = 'X';
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+
+    SECTION("other version") {
+        CookedModelHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+        header.m_version++;
+        memcpy(data.data(), &header, sizeof(header));
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+
+    SECTION("primitive out of range") {
+        CookedModelHeader header;
+        memcpy(&header, data.data(), sizeof(header));
+        auto& range = header.m_sections[static_cast<uint32_t>(
+            CookedSection::Primitives)];
+        auto prim = (CookedPrimitive*)(data.data() + range.m_offset);
+        prim->m_vertices.m_offset = data.size();
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+
+    SECTION("index out of range") {
+        auto& prim =
+            GetSection<CookedPrimitive>(data, CookedSection::Primitives)[0];
+        REQUIRE(prim.m_indices.m_count > 0);
+        auto index_data =
+            GetSection<unsigned char>(data, CookedSection::IndexData);
+        uint32_t index = prim.m_vertices.m_count;
+        memcpy(index_data.data() + prim.m_indices.m_offset, &index,
+               prim.m_index_type ==
+                       static_cast<uint32_t>(IndexType::Uint16)
+                   ? 2
+                   : 4);
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+}
+
+TEST_CASE("cooked model with broken references is rejected") {
+    auto data = CookGLTFModel(LoadGLTF(TruckFilename));
+    REQUIRE(CookedModelView{data}.IsValid());
+
+    SECTION("node cycle") {
+        auto nodes = GetSection<CookedNode>(data, CookedSection::Nodes);
+        auto children =
+            GetSection<uint32_t>(data, CookedSection::NodeChildren);
+        auto roots = GetSection<uint32_t>(data, CookedSection::RootNodes);
+        REQUIRE_FALSE(children.empty());
+        REQUIRE_FALSE(roots.empty());
+
+        // a child of the root points back to the root
+        auto& root = nodes[roots[0]];
+        REQUIRE(root.m_child_count > 0);
+        children[root.m_first_child] = roots[0];
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+
+    SECTION("texture below -1") {
+        auto materials =
+            GetSection<CookedMaterial>(data, CookedSection::Materials);
+        REQUIRE_FALSE(materials.empty());
+        materials[0].m_base_color_texture.m_image = -2;
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+
+    SECTION("material below -1") {
+        auto primitives =
+            GetSection<CookedPrimitive>(data, CookedSection::Primitives);
+        primitives[0].m_material = -2;
+        REQUIRE_FALSE(CookedModelView{data}.IsValid());
+    }
+}
+
+TEST_CASE("cooked model cold start benchmark") {
+    Path cooked_filename =
+        TempCookedFilename("cooked_model_test_truck.nkmodel");
+    REQUIRE(CookGLTFFile(TruckFilename, cooked_filename));
+
+    // CPU side of a model load, GPU upload is the same for both paths
+    BENCHMARK("glTF parse and convert") {
+        auto model = LoadGLTF(TruckFilename);
+        return CookGLTFModel(model).size();
+    };
+
+    BENCHMARK("cooked mmap") {
+        MappedFile file{cooked_filename};
+        CookedModelView view{file.GetData()};
+        uint64_t sum = 0;
+        // touch every page, as the upload does
+        auto vertex_data = view.GetVertexData();
+        for (size_t i = 0; i < vertex_data.size(); i += 4096) {
+            sum += vertex_data[i];
+        }
+        return sum + view.GetIndexData().size();
+    };
+
+    std::filesystem::remove(cooked_filename.GetUnderlyingPath());
+}
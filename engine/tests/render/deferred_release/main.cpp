@@ -0,0 +1,72 @@
+#include "../gpu_test.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/lowlevel/internal/device_impl.hpp"
+#include "nickel/graphics/lowlevel/internal/sampler_impl.hpp"
+
+#include <thread>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+bool IsSamplerCached(DeviceImpl& impl, const Sampler::Descriptor& desc) {
+    std::lock_guard lock{impl.m_sampler_mutex};
+    return impl.m_samplers.count(desc) != 0;
+}
+
+}  // namespace
+
+TEST_CASE("sampler dedupe with deferred release", "[gpu]") {
+    auto adapter = CreateGPUTestAdapter();
+    Device device = adapter->GetDevice();
+    DeviceImpl& impl = device.Impl();
+    Sampler::Descriptor desc;
+
+    SECTION("equal descriptors share one sampler") {
+        Sampler a = device.CreateSampler(desc);
+        Sampler b = device.CreateSampler(desc);
+        REQUIRE(a.GetImpl() == b.GetImpl());
+        REQUIRE(a.GetImpl()->Refcount() == 2);
+
+        Sampler::Descriptor nearest_desc;
+        nearest_desc.m_mag_filter = Filter::Nearest;
+        REQUIRE(device.CreateSampler(nearest_desc).GetImpl() != a.GetImpl());
+    }
+
+    SECTION("last reference dropped on a worker thread") {
+        Sampler sampler = device.CreateSampler(desc);
+        SamplerImpl* old = sampler.GetImpl();
+        std::thread{[s = std::move(sampler)]() mutable { s = Sampler{}; }}
+            .join();
+
+        // unreachable by the map at once, while the handle is kept until
+        // GPU finished the frames in flight
+        REQUIRE_FALSE(IsSamplerCached(impl, desc));
+        REQUIRE(old->m_sampler != VK_NULL_HANDLE);
+
+        Sampler again = device.CreateSampler(desc);
+        REQUIRE(again.GetImpl() != old);
+        REQUIRE(again.GetImpl()->Refcount() == 1);
+    }
+
+    SECTION("create and drop on many threads") {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 4; i++) {
+            threads.emplace_back([&] {
+                for (int j = 0; j < 1000; j++) {
+                    Sampler sampler = device.CreateSampler(desc);
+                    Sampler copy = sampler;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE_FALSE(IsSamplerCached(impl, desc));
+    }
+
+    device.WaitIdle();
+    impl.ReleaseAllGarbage();
+    RequireNoValidationErrors(*adapter);
+}
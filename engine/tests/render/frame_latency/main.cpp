@@ -0,0 +1,70 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/frame_latency.hpp"
+
+#include <cmath>
+
+using namespace nickel::graphics;
+
+namespace {
+
+constexpr uint64_t Ms = 1'000'000;
+
+bool Near(double a, double b, double epsilon = 1e-4) {
+    return std::abs(a - b) < epsilon;
+}
+
+}  // namespace
+
+TEST_CASE("latency of one frame") {
+    FrameLatencyTracker tracker;
+    REQUIRE(tracker.GetStats().m_samples == 0);
+
+    SECTION("frame without input") {
+        tracker.BeginFrame(100 * Ms);
+        tracker.Present(116 * Ms);
+        REQUIRE(tracker.GetHistory().size() == 1);
+        REQUIRE(Near(tracker.GetHistory()[0], 16));
+    }
+
+    SECTION("earliest input event") {
+        tracker.RecordInput(95 * Ms);
+        tracker.RecordInput(90 * Ms);
+        tracker.RecordInput(98 * Ms);
+        tracker.BeginFrame(100 * Ms);
+        tracker.Present(120 * Ms);
+        REQUIRE(Near(tracker.GetStats().m_last_ms, 30));
+
+        // input is consumed by the frame
+        tracker.BeginFrame(120 * Ms);
+        tracker.Present(125 * Ms);
+        REQUIRE(Near(tracker.GetStats().m_last_ms, 5));
+    }
+
+    SECTION("present without frame") {
+        tracker.Present(10 * Ms);
+        tracker.BeginFrame(20 * Ms);
+        tracker.Present(30 * Ms);
+        tracker.Present(40 * Ms);
+        REQUIRE(tracker.GetHistory().size() == 1);
+    }
+}
+
+TEST_CASE("latency stats") {
+    FrameLatencyTracker tracker{20};
+    uint64_t time = 0;
+    for (uint32_t i = 1; i <= 30; i++) {
+        tracker.BeginFrame(time);
+        time += i * Ms;
+        tracker.Present(time);
+    }
+
+    // only the last 20 frames, 11..30 ms
+    auto stats = tracker.GetStats();
+    REQUIRE(tracker.GetHistory().size() == 20);
+    REQUIRE(Near(tracker.GetHistory().front(), 11));
+    REQUIRE(stats.m_samples == 20);
+    REQUIRE(Near(stats.m_last_ms, 30));
+    REQUIRE(Near(stats.m_average_ms, 20.5));
+    REQUIRE(Near(stats.m_p95_ms, 29));
+    REQUIRE(Near(stats.m_max_ms, 30));
+}
@@ -0,0 +1,74 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/lowlevel/gpu_profiler.hpp"
+
+#include <cmath>
+
+using namespace nickel::graphics;
+
+namespace {
+
+bool Near(double a, double b, double epsilon = 1e-6) {
+    return std::abs(a - b) < epsilon;
+}
+
+GPUFrameProfile MakeProfile(uint64_t frame, float scene, float imgui) {
+    GPUFrameProfile profile;
+    profile.m_frame = frame;
+    profile.m_scopes.push_back({"scene", 0, scene});
+    profile.m_scopes.push_back({"gltf", 1, scene / 2});
+    if (imgui > 0) {
+        profile.m_scopes.push_back({"imgui", 0, imgui});
+    }
+    return profile;
+}
+
+}  // namespace
+
+TEST_CASE("timestamps to milliseconds") {
+    REQUIRE(Near(TimestampsToMilliseconds(1000, 3000, 1.0f, 64), 0.002));
+    REQUIRE(Near(TimestampsToMilliseconds(0, 1'000'000, 2.5f, 64), 2.5));
+
+    // 32-bit counter wrapped between the two timestamps
+    REQUIRE(Near(TimestampsToMilliseconds(0xFFFFFF00ull, 0x100ull, 1.0f, 32),
+                 0.000512));
+}
+
+TEST_CASE("frame profile") {
+    auto profile = MakeProfile(3, 2.0f, 0.5f);
+    REQUIRE(Near(profile.GetTotalTime(), 2.5));
+    REQUIRE(profile.Find("gltf"));
+    REQUIRE(profile.Find("gltf")->m_depth == 1);
+    REQUIRE_FALSE(profile.Find("shadow"));
+    REQUIRE(GPUFrameProfile{}.GetTotalTime() == 0);
+}
+
+TEST_CASE("profile history") {
+    GPUProfileHistory history{3};
+    REQUIRE(history.GetTimes("scene").empty());
+
+    history.Push(MakeProfile(0, 1.0f, 0));
+    history.Push(MakeProfile(1, 2.0f, 0.5f));
+
+    // nested scopes are part of their parent
+    REQUIRE(history.GetScopeNames().size() == 2);
+    REQUIRE(history.GetTimes("gltf").empty());
+
+    auto imgui = history.GetTimes("imgui");
+    REQUIRE(imgui.size() == 2);
+    REQUIRE(imgui[0] == 0);
+    REQUIRE(Near(imgui[1], 0.5));
+
+    history.Push(MakeProfile(2, 3.0f, 0));
+    history.Push(MakeProfile(3, 4.0f, 1.0f));
+
+    auto scene = history.GetTimes("scene");
+    REQUIRE(scene.size() == 3);
+    REQUIRE(Near(scene[0], 2.0));
+    REQUIRE(Near(scene[2], 4.0));
+
+    auto frames = history.GetFrameTimes();
+    REQUIRE(frames.size() == 3);
+    REQUIRE(Near(frames[0], 2.5));
+    REQUIRE(Near(frames[1], 3.0));
+    REQUIRE(Near(frames[2], 5.0));
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/lowlevel/adapter.hpp"
+#include "nickel/graphics/lowlevel/device.hpp"
+
+#include <memory>
+
+// helpers of test cases tagged [gpu], they run as their own ctest entry
+// which is reported as skipped without a vulkan device, see
+// `mark_as_gpu_test`
+
+/// @brief headless adapter with the validation layer on, skips the test
+/// case without a vulkan device
+inline std::unique_ptr<nickel::graphics::Adapter> CreateGPUTestAdapter(
+    nickel::graphics::Adapter::HeadlessDescriptor desc = {}) {
+    if (!nickel::graphics::Adapter::IsSupported()) {
+        SKIP("no vulkan device");
+    }
+    desc.m_validation = true;
+    auto adapter = std::make_unique<nickel::graphics::Adapter>(desc);
+    if (!adapter->IsValidationEnabled()) {
+        WARN("VK_LAYER_KHRONOS_validation not found, running without it");
+    }
+    return adapter;
+}
+
+/// @brief render pass clearing its render area, attachment layouts are left
+/// to the render graph like `CommonResource` does
+inline nickel::graphics::RenderPass CreateClearRenderPass(
+    nickel::graphics::Device& device, nickel::graphics::Format format) {
+    using namespace nickel::graphics;
+    RenderPass::Descriptor desc;
+    RenderPass::Descriptor::AttachmentDescription attachment;
+    attachment.m_samples = SampleCount::Count1;
+    attachment.m_initial_layout = ImageLayout::ColorAttachmentOptimal;
+    attachment.m_final_layout = ImageLayout::ColorAttachmentOptimal;
+    attachment.m_load_op = AttachmentLoadOp::Clear;
+    attachment.m_store_op = AttachmentStoreOp::Store;
+    attachment.m_stencil_load_op = AttachmentLoadOp::DontCare;
+    attachment.m_stencil_store_op = AttachmentStoreOp::DontCare;
+    attachment.m_format = format;
+    desc.m_attachments.push_back(attachment);
+
+    RenderPass::Descriptor::SubpassDescription subpass;
+    RenderPass::Descriptor::AttachmentReference ref;
+    ref.m_attachment = 0;
+    ref.m_layout = ImageLayout::ColorAttachmentOptimal;
+    subpass.m_color_attachments.push_back(ref);
+    desc.m_subpasses.push_back(subpass);
+    return device.CreateRenderPass(desc);
+}
+
+inline void RequireNoValidationErrors(
+    const nickel::graphics::Adapter& adapter) {
+    REQUIRE(adapter.GetValidationErrorCount() == 0);
+}
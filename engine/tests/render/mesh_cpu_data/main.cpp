@@ -0,0 +1,141 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+constexpr const char* TruckFilename =
+    "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.gltf";
+constexpr const char* BoxFilename =
+    "engine/assets/models/unit_box/unit_box.gltf";
+
+std::unique_ptr<GLTFParsedModel> Parse(const Path& filename) {
+    std::ifstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    return ParseGLTFModel(filename, {std::istreambuf_iterator<char>{file},
+                                     std::istreambuf_iterator<char>{}});
+}
+
+template <typename T>
+void Append(std::vector<unsigned char>& buffer, std::span<const T> elems) {
+    auto bytes = std::as_bytes(elems);
+    buffer.insert(buffer.end(), (const unsigned char*)bytes.data(),
+                  (const unsigned char*)bytes.data() + bytes.size());
+}
+
+BufferView MakeView(uint32_t offset, uint64_t size, uint32_t count) {
+    BufferView view;
+    view.m_offset = offset;
+    view.m_size = size;
+    view.m_count = count;
+    return view;
+}
+
+}  // namespace
+
+TEST_CASE("load CPU data without GPU") {
+    auto parsed = Parse(TruckFilename);
+    REQUIRE(parsed);
+    GLTFLoader loader{parsed->m_gltf_model};
+    auto data = loader.LoadCPUData();
+    REQUIRE(!data.vertex_buffer.empty());
+    REQUIRE(!data.indices_buffer.empty());
+    REQUIRE(data.pbr_parameters.size() ==
+            parsed->m_gltf_model.materials.size());
+
+    // re-read data must match what was uploaded before release
+    auto reloaded = loader.LoadCPUData();
+    REQUIRE(reloaded.vertex_buffer == data.vertex_buffer);
+    REQUIRE(reloaded.indices_buffer == data.indices_buffer);
+
+    uint64_t size = data.GetMemorySize();
+    INFO("CesiumMilkTruck CPU mesh data: " << size / 1024
+                                           << " KiB released after upload");
+    REQUIRE(size >= data.vertex_buffer.size() + data.indices_buffer.size());
+    data.Release();
+    REQUIRE(data.GetMemorySize() == 0);
+}
+
+TEST_CASE("extract collision data from CPU buffers") {
+    // two primitives: indexed uint16 triangle pair & non-indexed triangle
+    std::vector<Vec3> quad{Vec3(0, 0, 0), Vec3(1, 0, 0), Vec3(1, 1, 0),
+                           Vec3(0, 1, 0)};
+    std::vector<uint16_t> quad_indices{0, 1, 2, 0, 2, 3};
+    std::vector<Vec3> triangle{Vec3(0, 0, 1), Vec3(1, 0, 1), Vec3(0, 1, 1)};
+
+    auto toVertices = [](std::span<const Vec3> points) {
+        std::vector<GLTFVertex> vertices(points.size());
+        for (size_t i = 0; i < points.size(); i++) {
+            vertices[i].m_position = points[i];
+            vertices[i].m_normal = Vec3{0, 0, 1};
+        }
+        return vertices;
+    };
+
+    std::vector<unsigned char> vertex_data, index_data;
+    Append<GLTFVertex>(vertex_data, toVertices(quad));
+    Append<GLTFVertex>(vertex_data, toVertices(triangle));
+    Append<uint16_t>(index_data, quad_indices);
+
+    Primitive prims[2];
+    prims[0].m_vertex_buf_view =
+        MakeView(0, quad.size() * sizeof(GLTFVertex), 4);
+    prims[0].m_indices_buf_view =
+        MakeView(0, quad_indices.size() * sizeof(uint16_t), 6);
+    prims[0].m_index_type = IndexType::Uint16;
+    prims[1].m_vertex_buf_view =
+        MakeView(quad.size() * sizeof(GLTFVertex),
+                 triangle.size() * sizeof(GLTFVertex), 3);
+
+    auto data = ExtractVertexData("ground", prims, vertex_data, index_data);
+    REQUIRE(data.m_name == "ground");
+    REQUIRE(data.m_points.size() == 7);
+    REQUIRE(data.m_points[4] == triangle[0]);
+    REQUIRE(data.m_indices ==
+            std::vector<uint32_t>{0, 1, 2, 0, 2, 3, 4, 5, 6});
+
+    SECTION("views out of range are skipped") {
+        std::vector<unsigned char> truncated(
+            vertex_data.begin(), vertex_data.begin() + sizeof(GLTFVertex));
+        auto skipped = ExtractVertexData("ground", prims, truncated, {});
+        REQUIRE(skipped.m_points.empty());
+        REQUIRE(skipped.m_indices.empty());
+    }
+}
+
+TEST_CASE("collision data survives release") {
+    GLTFCPUData data;
+    data.vertex_buffer.resize(1024);
+    data.indices_buffer.resize(256);
+    data.pbr_parameters.resize(2);
+
+    GLTFVertexData collision;
+    collision.m_name = "box";
+    collision.m_points.resize(8);
+    collision.m_indices.resize(36);
+    data.collision_meshes.push_back(collision);
+
+    uint64_t collision_size = 8 * sizeof(Vec3) + 36 * sizeof(uint32_t);
+    REQUIRE(data.GetMemorySize() >=
+            1024 + 256 + 2 * sizeof(PBRParameters) + collision_size);
+    data.Release();
+    REQUIRE(data.vertex_buffer.capacity() == 0);
+    REQUIRE(data.GetMemorySize() == collision_size);
+    REQUIRE(data.collision_meshes.size() == 1);
+}
+
+TEST_CASE("default load config keeps CPU data") {
+    GLTFLoadConfig config;
+    REQUIRE(config.m_cpu_data_policy == GLTFCPUDataPolicy::Keep);
+    REQUIRE(config.m_collision_meshes.empty());
+
+    auto parsed = Parse(BoxFilename);
+    REQUIRE(parsed);
+    auto data = GLTFLoader{parsed->m_gltf_model}.LoadCPUData();
+    REQUIRE(!data.vertex_buffer.empty());
+}
@@ -0,0 +1,306 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/gltf_draw.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+
+#include <cmath>
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+constexpr const char* TruckFilename =
+    "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.gltf";
+
+std::unique_ptr<GLTFParsedModel> Parse(const Path& filename) {
+    std::ifstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    return ParseGLTFModel(filename, {std::istreambuf_iterator<char>{file},
+                                     std::istreambuf_iterator<char>{}});
+}
+
+std::vector<Primitive> LoadPrimitives(const Path& filename,
+                                      const MeshOptimizeConfig& config) {
+    auto parsed = Parse(filename);
+    REQUIRE(parsed);
+    auto& model = parsed->m_gltf_model;
+    std::vector<unsigned char> vertex_buffer, index_buffer;
+    std::vector<Primitive> prims;
+    for (auto& mesh : model.meshes) {
+        for (auto& gltf_prim : mesh.primitives) {
+            GLTFPrimitiveGeometry geometry;
+            if (BuildPrimitiveGeometry(model, gltf_prim, config, geometry)) {
+                AppendPrimitiveGeometry(geometry, vertex_buffer, index_buffer,
+                                        prims.emplace_back());
+            }
+        }
+    }
+    return prims;
+}
+
+uint32_t TriangleCount(const Primitive& prim, uint32_t level) {
+    auto& view = level == 0 ? prim.m_indices_buf_view
+                            : prim.m_lods[level - 1].m_indices_buf_view;
+    return view.m_count / 3;
+}
+
+// flat row by row grid in XY plane
+void MakeGrid(uint32_t size, std::vector<GLTFVertex>& vertices,
+              std::vector<uint32_t>& indices) {
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            GLTFVertex vertex;
+            vertex.m_position = Vec3(x, y, 0);
+            vertex.m_normal = Vec3{0, 0, 1};
+            vertices.push_back(vertex);
+        }
+    }
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t i = y * (size + 1) + x;
+            uint32_t quad[] = {i, i + 1, i + size + 2, i, i + size + 2,
+                               i + size + 1};
+            indices.insert(indices.end(), std::begin(quad), std::end(quad));
+        }
+    }
+}
+
+// smooth uv sphere, the first column is duplicated as uv seam
+void MakeSphere(uint32_t segments, uint32_t rings,
+                std::vector<GLTFVertex>& vertices,
+                std::vector<uint32_t>& indices) {
+    constexpr float Pi = 3.14159265f;
+    for (uint32_t r = 0; r <= rings; r++) {
+        for (uint32_t s = 0; s <= segments; s++) {
+            float theta = Pi * r / rings, phi = 2 * Pi * (s % segments) / segments;
+            GLTFVertex vertex;
+            vertex.m_normal =
+                Vec3{std::sin(theta) * std::cos(phi), std::cos(theta),
+                     std::sin(theta) * std::sin(phi)};
+            vertex.m_position = vertex.m_normal;
+            vertex.m_uv = Vec2(s / float(segments), r / float(rings));
+            vertices.push_back(vertex);
+        }
+    }
+    for (uint32_t r = 0; r < rings; r++) {
+        for (uint32_t s = 0; s < segments; s++) {
+            uint32_t i = r * (segments + 1) + s, j = i + segments + 1;
+            if (r != 0) {
+                indices.insert(indices.end(), {i, i + 1, j});
+            }
+            if (r != rings - 1) {
+                indices.insert(indices.end(), {i + 1, j + 1, j});
+            }
+        }
+    }
+}
+
+// grid of trucks, camera flies low over it & back out. Each truck keeps its
+// own LOD state like a game object
+struct Flythrough {
+    uint64_t m_triangles{};
+    uint32_t m_switches{};
+};
+
+Flythrough Fly(std::span<const Primitive> prims,
+               const LODSelectConfig& config) {
+    constexpr int GridSize = 16;
+    constexpr float Spacing = 20.0f;
+    constexpr int Frames = 600;
+    // 45 degree vertical fov at 720p
+    const float screen_scale = 1.0f / std::tan(0.3927f) * 720 * 0.5f;
+
+    std::vector<LODState> states(GridSize * GridSize);
+    Flythrough result;
+    for (int frame = 0; frame < Frames; frame++) {
+        float t = frame / float(Frames - 1);
+        Vec3 camera{t * GridSize * Spacing, 2.0f + 60.0f * std::abs(t - 0.5f),
+                    GridSize * Spacing * 0.5f +
+                        20.0f * std::sin(t * 12.0f)};
+        for (int x = 0; x < GridSize; x++) {
+            for (int z = 0; z < GridSize; z++) {
+                Mat44 model_mat = Mat44::Identity();
+                model_mat[3] = Vec4{x * Spacing, 0, z * Spacing, 1};
+                auto& state = states[x * GridSize + z];
+                for (uint32_t i = 0; i < prims.size(); i++) {
+                    uint32_t old_level =
+                        i < state.m_levels.size() ? state.m_levels[i] : 0;
+                    float screen_size = CalcProjectedSize(
+                        prims[i], model_mat, camera, screen_scale);
+                    uint32_t level = SelectLODLevel(state, i, prims[i],
+                                                    screen_size, config);
+                    result.m_switches += level != old_level;
+                    result.m_triangles += TriangleCount(prims[i], level);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE("simplify flat grid") {
+    std::vector<GLTFVertex> vertices;
+    std::vector<uint32_t> indices;
+    MakeGrid(32, vertices, indices);
+
+    float error = 1;
+    auto simplified =
+        SimplifyMesh(vertices, indices, indices.size() / 10, 0.01f, &error);
+    REQUIRE(simplified.size() <= indices.size() / 10);
+    REQUIRE(simplified.size() % 3 == 0);
+    REQUIRE(error < 1e-3f);
+
+    // border stays in place, so the area is kept
+    float area = 0;
+    for (size_t i = 0; i < simplified.size(); i += 3) {
+        Vec3 p0 = vertices[simplified[i]].m_position,
+             p1 = vertices[simplified[i + 1]].m_position,
+             p2 = vertices[simplified[i + 2]].m_position;
+        Vec3 normal = Cross(p1 - p0, p2 - p0);
+        REQUIRE(normal.z > 0);
+        area += normal.z * 0.5f;
+    }
+    REQUIRE(std::abs(area - 32.0f * 32.0f) < 1e-2f);
+
+    SECTION("corners are kept") {
+        auto quad = SimplifyMesh(vertices, indices, 0, 0.01f);
+        REQUIRE(quad.size() == 6);
+    }
+}
+
+TEST_CASE("generate LOD chain") {
+    std::vector<GLTFVertex> vertices;
+    std::vector<uint32_t> indices;
+    MakeSphere(64, 32, vertices, indices);
+    MeshOptimizeConfig config;
+    auto lods = GenerateLODs(vertices, indices, config);
+    REQUIRE(lods.size() == config.m_lod_count);
+
+    size_t index_count = indices.size();
+    float error = 0;
+    for (auto& lod : lods) {
+        INFO("sphere LOD " << lod.m_indices.size() / 3
+                           << " triangles, error " << lod.m_error);
+        REQUIRE(lod.m_indices.size() <= index_count * 0.6f);
+        REQUIRE(lod.m_error >= error);
+        REQUIRE(lod.m_error <= config.m_lod_max_error);
+        // vertices are shared with the full mesh
+        for (auto index : lod.m_indices) {
+            REQUIRE(index < vertices.size());
+        }
+        index_count = lod.m_indices.size();
+        error = lod.m_error;
+    }
+
+    SECTION("uv seam is kept") {
+        // seam wedges only map onto other seam wedges
+        for (auto& lod : lods) {
+            for (size_t i = 0; i < lod.m_indices.size(); i += 3) {
+                float u_min = 1, u_max = 0;
+                for (int j = 0; j < 3; j++) {
+                    float u = vertices[lod.m_indices[i + j]].m_uv.x;
+                    u_min = std::min(u_min, u);
+                    u_max = std::max(u_max, u);
+                }
+                REQUIRE(u_max - u_min < 0.5f);
+            }
+        }
+    }
+
+    SECTION("stored in primitive buffer views") {
+        auto prims = LoadPrimitives(TruckFilename, config);
+        bool has_lod = false;
+        for (auto& prim : prims) {
+            for (auto& lod : prim.m_lods) {
+                has_lod = true;
+                REQUIRE(lod.m_indices_buf_view.m_offset % 4 == 0);
+                REQUIRE(lod.m_indices_buf_view.m_count % 3 == 0);
+            }
+        }
+        REQUIRE(has_lod);
+
+        config.m_lod_count = 0;
+        for (auto& prim : LoadPrimitives(TruckFilename, config)) {
+            REQUIRE(prim.m_lods.empty());
+        }
+    }
+}
+
+TEST_CASE("select LOD level by screen size") {
+    Primitive prim;
+    prim.m_lods.resize(3);
+    prim.m_lods[0].m_error = 0.001f;
+    prim.m_lods[1].m_error = 0.01f;
+    prim.m_lods[2].m_error = 0.1f;
+
+    LODSelectConfig config;
+    config.m_hysteresis = 0;
+    REQUIRE(SelectLODLevel(prim, 2000.0f, 0, config) == 0);
+    REQUIRE(SelectLODLevel(prim, 500.0f, 0, config) == 1);
+    REQUIRE(SelectLODLevel(prim, 50.0f, 0, config) == 2);
+    REQUIRE(SelectLODLevel(prim, 5.0f, 0, config) == 3);
+    REQUIRE(SelectLODLevel(prim, std::numeric_limits<float>::max(), 3,
+                           config) == 0);
+
+    config.m_enable = false;
+    REQUIRE(SelectLODLevel(prim, 5.0f, 0, config) == 0);
+
+    SECTION("hysteresis keeps level near threshold") {
+        config.m_enable = true;
+        config.m_hysteresis = 0.25f;
+        // level 2 error is exactly 1 pixel at size 100
+        REQUIRE(SelectLODLevel(prim, 95.0f, 1, config) == 1);
+        REQUIRE(SelectLODLevel(prim, 70.0f, 1, config) == 2);
+        REQUIRE(SelectLODLevel(prim, 105.0f, 2, config) == 2);
+        REQUIRE(SelectLODLevel(prim, 130.0f, 2, config) == 1);
+    }
+
+    SECTION("instances keep their own levels") {
+        config.m_enable = true;
+        config.m_hysteresis = 0.25f;
+        LODState near, far;
+        REQUIRE(SelectLODLevel(near, 1, prim, 2000.0f, config) == 0);
+        REQUIRE(SelectLODLevel(far, 1, prim, 70.0f, config) == 2);
+        REQUIRE(near.m_levels == std::vector<uint32_t>{0, 0});
+
+        // hysteresis of each instance starts from its own level
+        REQUIRE(SelectLODLevel(near, 1, prim, 95.0f, config) == 1);
+        REQUIRE(SelectLODLevel(far, 1, prim, 105.0f, config) == 2);
+    }
+}
+
+TEST_CASE("LOD flythrough triangle count") {
+    auto prims = LoadPrimitives(TruckFilename, {});
+    REQUIRE(!prims.empty());
+    for (auto& prim : prims) {
+        UNSCOPED_INFO("truck primitive: " << TriangleCount(prim, 0)
+                                          << " triangles");
+        for (uint32_t level = 1; level <= prim.m_lods.size(); level++) {
+            UNSCOPED_INFO("  LOD " << level << ": "
+                                   << TriangleCount(prim, level)
+                                   << " triangles, error "
+                                   << prim.m_lods[level - 1].m_error);
+        }
+    }
+
+    LODSelectConfig disabled;
+    disabled.m_enable = false;
+    LODSelectConfig no_hysteresis;
+    no_hysteresis.m_hysteresis = 0;
+    auto full = Fly(prims, disabled);
+    auto lod = Fly(prims, {});
+    auto popping = Fly(prims, no_hysteresis);
+
+    INFO("flythrough submitted triangles: "
+         << full.m_triangles << " -> " << lod.m_triangles << " with LOD ("
+         << lod.m_triangles * 100 / full.m_triangles << "%), "
+         << lod.m_switches << " LOD switches, " << popping.m_switches
+         << " without hysteresis");
+    REQUIRE(full.m_switches == 0);
+    REQUIRE(lod.m_triangles < full.m_triangles);
+    REQUIRE(lod.m_switches <= popping.m_switches);
+}
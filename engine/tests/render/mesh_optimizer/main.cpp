@@ -0,0 +1,237 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+using Triangle = std::array<uint32_t, 3>;
+
+std::unique_ptr<GLTFParsedModel> Parse(const Path& filename) {
+    std::ifstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    return ParseGLTFModel(filename, {std::istreambuf_iterator<char>{file},
+                                     std::istreambuf_iterator<char>{}});
+}
+
+// triangles rotated to start with the smallest index, then sorted
+std::vector<Triangle> SortedTriangles(std::span<const uint32_t> indices) {
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        Triangle t{indices[i], indices[i + 1], indices[i + 2]};
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// row by row grid, the usual worst case of exporters for cache reuse
+void MakeGrid(uint32_t size, std::vector<GLTFVertex>& vertices,
+              std::vector<uint32_t>& indices) {
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            GLTFVertex vertex;
+            vertex.m_position = Vec3(x, y, 0);
+            vertex.m_uv = Vec2(x / float(size), y / float(size));
+            vertex.m_normal = Vec3{0, 0, 1};
+            vertex.m_tangent = Vec4{1, 0, 0, 1};
+            vertices.push_back(vertex);
+        }
+    }
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t i = y * (size + 1) + x;
+            uint32_t quad[] = {i, i + 1, i + size + 2, i, i + size + 2,
+                               i + size + 1};
+            indices.insert(indices.end(), std::begin(quad), std::end(quad));
+        }
+    }
+}
+
+struct GeometryStats {
+    uint32_t m_vs_invocations{};
+    uint64_t m_vertex_bytes{};
+    uint64_t m_index_bytes{};
+
+    GeometryStats& operator+=(const GeometryStats& o) {
+        m_vs_invocations += o.m_vs_invocations;
+        m_vertex_bytes += o.m_vertex_bytes;
+        m_index_bytes += o.m_index_bytes;
+        return *this;
+    }
+};
+
+GeometryStats MeasureModel(const tinygltf::Model& model,
+                           const MeshOptimizeConfig& config) {
+    GeometryStats stats;
+    for (auto& mesh : model.meshes) {
+        for (auto& prim : mesh.primitives) {
+            GLTFPrimitiveGeometry geometry;
+            if (!BuildPrimitiveGeometry(model, prim, config, geometry)) {
+                continue;
+            }
+            stats.m_vs_invocations +=
+                AnalyzeVertexCache(geometry.m_indices, geometry.m_vertex_count)
+                    .m_vertices_transformed;
+
+            std::vector<unsigned char> vertex_buffer, index_buffer;
+            Primitive out;
+            AppendPrimitiveGeometry(geometry, vertex_buffer, index_buffer, out);
+            stats.m_vertex_bytes += out.m_vertex_buf_view.m_size;
+            stats.m_index_bytes += out.m_indices_buf_view.m_size;
+        }
+    }
+    return stats;
+}
+
+}  // namespace
+
+TEST_CASE("half float round trip") {
+    for (float value : {0.0f, 1.0f, -2.0f, 0.5f, 0.333f, 65504.0f}) {
+        float decoded = HalfToFloat(FloatToHalf(value));
+        REQUIRE(std::abs(decoded - value) <= std::abs(value) * 1e-3f);
+    }
+    REQUIRE(std::isinf(HalfToFloat(FloatToHalf(1e6f))));
+    REQUIRE(HalfToFloat(FloatToHalf(1e-6f)) > 0.0f);
+}
+
+TEST_CASE("octahedral normal round trip") {
+    Vec3 normals[] = {Vec3{0, 0, 1},          Vec3{0, 0, -1},
+                      Vec3{1, 0, 0},          Vec3{0, -1, 0},
+                      Normalize(Vec3{1, 2, 3}), Normalize(Vec3{-1, 0.5, -2})};
+    for (auto& n : normals) {
+        auto decoded = DecodeOctahedral(EncodeOctahedral(n));
+        REQUIRE(Length(decoded - n) < 1e-4f);
+
+        GLTFVertex vertex;
+        vertex.m_normal = n;
+        auto quantized = QuantizeVertex(vertex);
+        Vec2 e{quantized.m_normal[0] / 32767.0f,
+               quantized.m_normal[1] / 32767.0f};
+        REQUIRE(Dot(DecodeOctahedral(e), n) > 0.9999f);
+    }
+}
+
+TEST_CASE("deduplicate vertices") {
+    std::vector<GLTFVertex> vertices(6);
+    for (uint32_t i = 0; i < 6; i++) {
+        vertices[i].m_position = Vec3(i % 3, 0, 0);
+    }
+    std::vector<uint32_t> indices{0, 1, 2, 3, 4, 5};
+    DeduplicateVertices(vertices, indices);
+    REQUIRE(vertices.size() == 3);
+    REQUIRE(indices == std::vector<uint32_t>{0, 1, 2, 0, 1, 2});
+}
+
+TEST_CASE("optimize grid") {
+    std::vector<GLTFVertex> vertices;
+    std::vector<uint32_t> indices;
+    MakeGrid(64, vertices, indices);
+    auto origin_triangles = SortedTriangles(indices);
+    auto before = AnalyzeVertexCache(indices, vertices.size());
+
+    OptimizeVertexCache(indices, vertices.size());
+    REQUIRE(SortedTriangles(indices) == origin_triangles);
+    auto after = AnalyzeVertexCache(indices, vertices.size());
+    INFO("grid ACMR " << before.m_acmr << " -> " << after.m_acmr);
+    REQUIRE(after.m_vertices_transformed < before.m_vertices_transformed);
+    REQUIRE(after.m_acmr < 0.8f);
+
+    SECTION("overdraw keeps triangles within threshold") {
+        OptimizeOverdraw(indices, vertices, 1.05f);
+        REQUIRE(SortedTriangles(indices) == origin_triangles);
+        REQUIRE(AnalyzeVertexCache(indices, vertices.size())
+                    .m_vertices_transformed <=
+                after.m_vertices_transformed * 1.05f);
+    }
+
+    SECTION("vertex fetch follows index order") {
+        auto positions = [&] {
+            std::vector<Vec3> result;
+            for (auto index : indices) {
+                result.push_back(vertices[index].m_position);
+            }
+            return result;
+        };
+        auto expect = positions();
+        vertices.push_back({});  // unused vertex is dropped
+        OptimizeVertexFetch(vertices, indices);
+        REQUIRE(vertices.size() == 65 * 65);
+        REQUIRE(positions() == expect);
+
+        uint32_t next = 0;
+        for (auto index : indices) {
+            REQUIRE(index <= next);
+            next = std::max(next, index + 1);
+        }
+    }
+}
+
+TEST_CASE("optimize bundled models") {
+    const char* filenames[] = {
+        "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.gltf",
+        "engine/assets/models/CesiumMan/CesiumMan.gltf",
+        "engine/assets/models/ReciprocatingSaw/ReciprocatingSaw.gltf",
+        "engine/assets/models/unit_box/unit_box.gltf",
+        "engine/assets/models/unit_sphere/unit_sphere.gltf",
+        "engine/assets/models/unit_cylinder/cylinder.gltf",
+        "engine/assets/models/unit_semi_sphere/semi_sphere.gltf",
+    };
+
+    MeshOptimizeConfig raw_config;
+    raw_config.m_deduplicate = false;
+    raw_config.m_optimize_vertex_cache = false;
+    raw_config.m_optimize_overdraw = false;
+    raw_config.m_optimize_vertex_fetch = false;
+    MeshOptimizeConfig optimize_config;
+    MeshOptimizeConfig quantize_config;
+    quantize_config.m_quantize = true;
+
+    GeometryStats raw_total, optimized_total, quantized_total;
+    for (auto filename : filenames) {
+        auto parsed = Parse(filename);
+        REQUIRE(parsed);
+        auto& model = parsed->m_gltf_model;
+
+        auto raw = MeasureModel(model, raw_config);
+        auto optimized = MeasureModel(model, optimize_config);
+        auto quantized = MeasureModel(model, quantize_config);
+        INFO(Path{filename}.Filename()
+             << ": VS invocations " << raw.m_vs_invocations << " -> "
+             << optimized.m_vs_invocations << ", vertex bytes "
+             << raw.m_vertex_bytes << " -> " << optimized.m_vertex_bytes
+             << " (quantized " << quantized.m_vertex_bytes
+             << "), index bytes " << raw.m_index_bytes << " -> "
+             << optimized.m_index_bytes);
+
+        REQUIRE(optimized.m_vs_invocations <= raw.m_vs_invocations);
+        REQUIRE(optimized.m_vertex_bytes <= raw.m_vertex_bytes);
+        REQUIRE(optimized.m_index_bytes <= raw.m_index_bytes);
+        // skinned primitives keep the float layout
+        if (model.skins.empty()) {
+            REQUIRE(quantized.m_vertex_bytes * 2 == optimized.m_vertex_bytes);
+        } else {
+            REQUIRE(quantized.m_vertex_bytes == optimized.m_vertex_bytes);
+        }
+
+        raw_total += raw;
+        optimized_total += optimized;
+        quantized_total += quantized;
+    }
+
+    INFO("total: VS invocations "
+         << raw_total.m_vs_invocations << " -> "
+         << optimized_total.m_vs_invocations << ", vertex bytes "
+         << raw_total.m_vertex_bytes << " -> "
+         << optimized_total.m_vertex_bytes << " (quantized "
+         << quantized_total.m_vertex_bytes << ")");
+    REQUIRE(optimized_total.m_vs_invocations < raw_total.m_vs_invocations);
+}
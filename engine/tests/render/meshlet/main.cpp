@@ -0,0 +1,221 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/camera.hpp"
+#include "nickel/graphics/internal/mesh_optimizer.hpp"
+#include "nickel/graphics/internal/meshlet.hpp"
+
+#include <set>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+// row by row grid in XY plane facing +Z
+void MakeGrid(uint32_t size, std::vector<Vec3>& positions,
+              std::vector<uint32_t>& indices) {
+    for (uint32_t y = 0; y <= size; y++) {
+        for (uint32_t x = 0; x <= size; x++) {
+            positions.push_back(Vec3(x, y, 0));
+        }
+    }
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t i = y * (size + 1) + x;
+            indices.insert(indices.end(), {i, i + 1, i + size + 2, i,
+                                           i + size + 2, i + size + 1});
+        }
+    }
+}
+
+Primitive MakePrimitive(std::span<const Vec3> positions,
+                        std::span<const uint32_t> indices) {
+    Primitive prim;
+    prim.m_indices_buf_view.m_count = indices.size();
+    PackMeshlets(BuildMeshlets(positions, indices), prim);
+    return prim;
+}
+
+Mat44 ViewProject(const FlyCamera& camera) {
+    return camera.GetProject() * camera.GetView();
+}
+
+FlyCamera MakeCamera(const Vec3& position, Radians yaw = Radians{0}) {
+    FlyCamera camera{Degrees{45}, 16.0f / 9.0f, 0.1f, 1000.0f};
+    camera.MoveTo(position);
+    camera.SetYaw(yaw);
+    return camera;
+}
+
+uint32_t MeshletCount(const Primitive& prim) {
+    return prim.m_meshlet_offsets.size() - 1;
+}
+
+}  // namespace
+
+TEST_CASE("build meshlets") {
+    std::vector<Vec3> positions;
+    std::vector<uint32_t> indices;
+    MakeGrid(64, positions, indices);
+    OptimizeVertexCache(indices, positions.size());
+
+    auto meshlets = BuildMeshlets(positions, indices);
+    REQUIRE(!meshlets.empty());
+    uint32_t next_index = 0;
+    for (auto& meshlet : meshlets) {
+        REQUIRE(meshlet.m_first_index == next_index);
+        REQUIRE(meshlet.m_index_count % 3 == 0);
+        REQUIRE(meshlet.m_index_count / 3 <= MeshletMaxTriangles);
+        next_index += meshlet.m_index_count;
+
+        std::set<uint32_t> unique{
+            indices.begin() + meshlet.m_first_index,
+            indices.begin() + meshlet.m_first_index + meshlet.m_index_count};
+        REQUIRE(unique.size() <= MeshletMaxVertices);
+        for (auto index : unique) {
+            REQUIRE(Length(positions[index] - meshlet.m_center) <=
+                    meshlet.m_radius + 1e-4f);
+        }
+
+        // flat grid, every triangle faces +Z
+        REQUIRE(meshlet.m_cone_axis.z > 0.999f);
+        REQUIRE(meshlet.m_cone_cutoff < 0.01f);
+    }
+    REQUIRE(next_index == indices.size());
+    INFO(meshlets.size() << " meshlets for " << indices.size() / 3
+                         << " triangles");
+
+    SECTION("packed") {
+        Primitive prim;
+        PackMeshlets(meshlets, prim);
+        REQUIRE(MeshletCount(prim) == meshlets.size());
+        REQUIRE(prim.m_meshlet_bounds.size() == (meshlets.size() + 3) / 4);
+        REQUIRE(prim.m_meshlet_offsets.back() == indices.size());
+        REQUIRE(prim.m_meshlet_bounds[1].m_radius[2] == meshlets[6].m_radius);
+    }
+}
+
+TEST_CASE("cull meshlets") {
+    std::vector<Vec3> positions;
+    std::vector<uint32_t> indices;
+    MakeGrid(64, positions, indices);
+    OptimizeVertexCache(indices, positions.size());
+    auto prim = MakePrimitive(positions, indices);
+    std::vector<uint32_t> visible, scalar_visible;
+
+    SECTION("front facing, all in view") {
+        auto camera = MakeCamera(Vec3(32, 32, 100));
+        auto params = MakeMeshletCullParams(ViewProject(camera),
+                                            Mat44::Identity(),
+                                            camera.GetPosition());
+        REQUIRE(CullMeshlets(prim, params, visible) == MeshletCount(prim));
+    }
+
+    SECTION("back facing clusters are culled by cone") {
+        auto camera = MakeCamera(Vec3(32, 32, -100), Radians{PI});
+        auto params = MakeMeshletCullParams(ViewProject(camera),
+                                            Mat44::Identity(),
+                                            camera.GetPosition());
+        REQUIRE(CullMeshlets(prim, params, visible) == 0);
+        REQUIRE(CullMeshletsScalar(prim, params, scalar_visible) == 0);
+
+        // mirrored transform flips winding, cone culling is skipped
+        Mat44 mirror = Mat44::Identity();
+        mirror[0].x = -1;
+        mirror[3] = Vec4{64, 0, 0, 1};
+        params = MakeMeshletCullParams(ViewProject(camera), mirror,
+                                       camera.GetPosition());
+        REQUIRE(!params.m_cone_culling);
+        REQUIRE(CullMeshlets(prim, params, visible) == MeshletCount(prim));
+    }
+
+    SECTION("outside frustum, conservative") {
+        auto camera = MakeCamera(Vec3(10, 12, 6));
+        Mat44 model = Mat44::Identity();
+        model[3] = Vec4{-3, 2, 0, 1};
+        Mat44 view_project = ViewProject(camera);
+        auto params =
+            MakeMeshletCullParams(view_project, model, camera.GetPosition());
+        uint32_t count = CullMeshlets(prim, params, visible);
+        REQUIRE(count > 0);
+        REQUIRE(count < MeshletCount(prim) / 4);
+        REQUIRE(CullMeshletsScalar(prim, params, scalar_visible) == count);
+        REQUIRE(visible == scalar_visible);
+
+        // every triangle with a vertex on screen belongs to a visible meshlet
+        Mat44 mvp = view_project * model;
+        std::set<uint32_t> visible_set{visible.begin(), visible.end()};
+        for (uint32_t meshlet = 0; meshlet < MeshletCount(prim); meshlet++) {
+            for (uint32_t i = prim.m_meshlet_offsets[meshlet];
+                 i < prim.m_meshlet_offsets[meshlet + 1]; i++) {
+                auto& p = positions[indices[i]];
+                Vec4 clip = mvp * Vec4{p.x, p.y, p.z, 1};
+                if (clip.w > 0 && std::abs(clip.x) < clip.w &&
+                    std::abs(clip.y) < clip.w) {
+                    REQUIRE(visible_set.contains(meshlet));
+                }
+            }
+        }
+
+        std::vector<MeshletDrawRange> ranges;
+        CompactMeshletRanges(prim, visible, ranges);
+        REQUIRE(!ranges.empty());
+        REQUIRE(ranges.size() <= visible.size());
+        uint32_t range_indices = 0;
+        for (auto& range : ranges) {
+            range_indices += range.m_index_count;
+        }
+        uint32_t visible_indices = 0;
+        for (auto meshlet : visible) {
+            visible_indices += prim.m_meshlet_offsets[meshlet + 1] -
+                               prim.m_meshlet_offsets[meshlet];
+        }
+        REQUIRE(range_indices == visible_indices);
+    }
+}
+
+TEST_CASE("adjacent visible meshlets merge into one draw") {
+    Primitive prim;
+    prim.m_meshlet_offsets = {0, 30, 60, 90, 120};
+    std::vector<MeshletDrawRange> ranges;
+    std::vector<uint32_t> visible{0, 1, 3};
+    CompactMeshletRanges(prim, visible, ranges);
+    REQUIRE(ranges.size() == 2);
+    REQUIRE(ranges[0].m_first_index == 0);
+    REQUIRE(ranges[0].m_index_count == 60);
+    REQUIRE(ranges[1].m_first_index == 90);
+    REQUIRE(ranges[1].m_index_count == 30);
+}
+
+TEST_CASE("meshlet culling benchmark") {
+    // ~1M triangles
+    std::vector<Vec3> positions;
+    std::vector<uint32_t> indices;
+    MakeGrid(708, positions, indices);
+    OptimizeVertexCache(indices, positions.size());
+    auto prim = MakePrimitive(positions, indices);
+
+    auto camera = MakeCamera(Vec3(300, 200, 150), Radians{0.3f});
+    auto params = MakeMeshletCullParams(ViewProject(camera), Mat44::Identity(),
+                                        camera.GetPosition());
+    std::vector<uint32_t> visible;
+    uint32_t count = CullMeshlets(prim, params, visible);
+    uint64_t visible_triangles = 0;
+    for (auto meshlet : visible) {
+        visible_triangles += (prim.m_meshlet_offsets[meshlet + 1] -
+                              prim.m_meshlet_offsets[meshlet]) /
+                             3;
+    }
+    INFO(indices.size() / 3 << " triangles, " << MeshletCount(prim)
+                            << " meshlets, " << count << " visible ("
+                            << visible_triangles << " triangles)");
+    REQUIRE(count < MeshletCount(prim));
+
+    BENCHMARK("cull SIMD") {
+        return CullMeshlets(prim, params, visible);
+    };
+
+    BENCHMARK("cull scalar") {
+        return CullMeshletsScalar(prim, params, visible);
+    };
+}
@@ -0,0 +1,226 @@
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/camera.hpp"
+#include "nickel/graphics/occlusion_culling.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <random>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+// at (0, 0, 10) looking at -Z
+Mat44 ViewProject(const Vec3& position = Vec3(0, 0, 10)) {
+    FlyCamera camera{Degrees{60}, 2.0f, 0.1f, 1000.0f};
+    camera.MoveTo(position);
+    return camera.GetProject() * camera.GetView();
+}
+
+Mat44 Translation(const Vec3& offset) {
+    Mat44 model = Mat44::Identity();
+    model[3] = Vec4{offset.x, offset.y, offset.z, 1};
+    return model;
+}
+
+// quad in XY plane, `half` along X & Y
+OccluderMesh MakeWall(float half_width, float half_height) {
+    OccluderMesh mesh;
+    mesh.m_points = {Vec3(-half_width, -half_height, 0),
+                     Vec3(half_width, -half_height, 0),
+                     Vec3(half_width, half_height, 0),
+                     Vec3(-half_width, half_height, 0)};
+    mesh.m_indices = {0, 1, 2, 0, 2, 3};
+    return mesh;
+}
+
+OccludeeBounds MakeBox(float half) {
+    return {Vec3(-half, -half, -half), Vec3(half, half, half)};
+}
+
+}  // namespace
+
+TEST_CASE("wall occludes boxes behind it") {
+    OcclusionCuller culler;
+    culler.BeginFrame(ViewProject());
+
+    SECTION("nothing rasterized") {
+        culler.RasterizeOccluders();
+        REQUIRE(!culler.IsOccluded(MakeBox(0.5f), Translation(Vec3(0, 0, -5))));
+    }
+
+    culler.AddOccluder(MakeWall(5, 5), Mat44::Identity());
+    culler.RasterizeOccluders();
+    REQUIRE(culler.GetStats().m_occluder_triangles == 2);
+    REQUIRE(culler.GetStats().m_skipped_triangles == 0);
+
+    SECTION("behind") {
+        REQUIRE(culler.IsOccluded(MakeBox(0.5f), Translation(Vec3(0, 0, -5))));
+        REQUIRE(culler.IsOccluded(MakeBox(2), Translation(Vec3(1, 1, -20))));
+    }
+
+    SECTION("in front") {
+        REQUIRE(!culler.IsOccluded(MakeBox(0.5f), Translation(Vec3(0, 0, 5))));
+    }
+
+    SECTION("intersecting the wall") {
+        REQUIRE(!culler.IsOccluded(MakeBox(0.5f), Translation(Vec3(0, 0, 0))));
+    }
+
+    SECTION("peeking out beside the wall") {
+        REQUIRE(!culler.IsOccluded(MakeBox(1), Translation(Vec3(5, 0, -2))));
+    }
+
+    SECTION("crossing camera plane") {
+        REQUIRE(!culler.IsOccluded(MakeBox(1), Translation(Vec3(0, 0, 10))));
+    }
+
+    SECTION("outside screen") {
+        REQUIRE(!culler.IsOccluded(MakeBox(1), Translation(Vec3(500, 0, 0))));
+    }
+
+    auto& stats = culler.GetStats();
+    REQUIRE(stats.m_rejected <= stats.m_tested);
+}
+
+TEST_CASE("occluder crossing camera plane is skipped") {
+    OcclusionCuller culler;
+    culler.BeginFrame(ViewProject());
+
+    // floor from behind the camera to far away
+    OccluderMesh floor;
+    floor.m_points = {Vec3(-50, -1, 50), Vec3(50, -1, 50), Vec3(50, -1, -50),
+                      Vec3(-50, -1, -50)};
+    floor.m_indices = {0, 1, 2, 0, 2, 3};
+    culler.AddOccluder(floor, Mat44::Identity());
+    culler.RasterizeOccluders();
+
+    REQUIRE(culler.GetStats().m_skipped_triangles == 2);
+    auto depth = culler.GetDepthBuffer();
+    REQUIRE(std::all_of(depth.begin(), depth.end(), [](float value) {
+        return value == std::numeric_limits<float>::lowest();
+    }));
+}
+
+TEST_CASE("depth keeps nearest occluder") {
+    OcclusionCuller culler;
+    culler.BeginFrame(ViewProject());
+    culler.AddOccluder(MakeWall(20, 20), Translation(Vec3(0, 0, -10)));
+    culler.AddOccluder(MakeWall(2, 2), Mat44::Identity());
+    culler.RasterizeOccluders();
+
+    uint32_t w = culler.GetWidth(), h = culler.GetHeight();
+    auto depth = culler.GetDepthBuffer();
+    float center = depth[h / 2 * w + w / 2];
+    float border = depth[h / 2 * w + w / 8];
+
+    // greater is nearer, both covered
+    REQUIRE(border > std::numeric_limits<float>::lowest());
+    REQUIRE(center > border);
+
+    // small box between the walls is hidden by the near one only
+    REQUIRE(culler.IsOccluded(MakeBox(0.5f), Translation(Vec3(0, 0, -5))));
+    REQUIRE(!culler.IsOccluded(MakeBox(0.5f), Translation(Vec3(6, 0, -5))));
+    REQUIRE(culler.IsOccluded(MakeBox(0.5f), Translation(Vec3(6, 0, -15))));
+}
+
+TEST_CASE("rasterization is independent of thread count") {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> position{-30, 30};
+    std::uniform_real_distribution<float> distance{-80, -5};
+
+    OccluderMesh mesh;
+    for (uint32_t i = 0; i < 300; i++) {
+        Vec3 center(position(random), position(random), distance(random));
+        for (int v = 0; v < 3; v++) {
+            mesh.m_points.push_back(center + Vec3(position(random),
+                                                  position(random),
+                                                  position(random)) *
+                                                 0.2f);
+            mesh.m_indices.push_back(i * 3 + v);
+        }
+    }
+
+    OcclusionCuller::Descriptor desc;
+    desc.m_width = 250;
+    desc.m_band_height = 7;
+    OcclusionCuller serial{desc}, parallel{desc};
+    REQUIRE(serial.GetWidth() == 252);
+
+    serial.BeginFrame(ViewProject());
+    serial.AddOccluder(mesh, Mat44::Identity());
+    serial.RasterizeOccluders();
+
+    ThreadPool pool{4};
+    parallel.BeginFrame(ViewProject());
+    parallel.AddOccluder(mesh, Mat44::Identity());
+    parallel.RasterizeOccluders(&pool);
+
+    auto serial_depth = serial.GetDepthBuffer();
+    auto parallel_depth = parallel.GetDepthBuffer();
+    REQUIRE(std::equal(serial_depth.begin(), serial_depth.end(),
+                       parallel_depth.begin(), parallel_depth.end()));
+
+    uint32_t covered = std::count_if(
+        serial_depth.begin(), serial_depth.end(), [](float depth) {
+            return depth > std::numeric_limits<float>::lowest();
+        });
+    REQUIRE(covered > 0);
+    REQUIRE(covered < serial_depth.size());
+}
+
+TEST_CASE("occlusion culling benchmark") {
+    // rows of walls along X with crates scattered between them
+    OccluderMesh wall = MakeWall(8, 4);
+    std::vector<Mat44> walls;
+    for (int row = 0; row < 8; row++) {
+        for (int col = -4; col <= 4; col++) {
+            walls.push_back(
+                Translation(Vec3(col * 16.5f, 0, -10 - row * 20.0f)));
+        }
+    }
+
+    std::mt19937 random{7};
+    std::uniform_real_distribution<float> x{-70, 70};
+    std::uniform_real_distribution<float> y{-3, 3};
+    std::uniform_real_distribution<float> z{-170, 5};
+    std::vector<Mat44> crates;
+    for (int i = 0; i < 10000; i++) {
+        crates.push_back(Translation(Vec3(x(random), y(random), z(random))));
+    }
+    OccludeeBounds crate = MakeBox(0.5f);
+
+    ThreadPool pool;
+    OcclusionCuller culler;
+    Mat44 view_project = ViewProject(Vec3(0, 0, 15));
+    auto cull = [&](ThreadPool* pool) {
+        culler.BeginFrame(view_project);
+        for (auto& model : walls) {
+            culler.AddOccluder(wall, model);
+        }
+        culler.RasterizeOccluders(pool);
+        uint32_t rejected = 0;
+        for (auto& model : crates) {
+            rejected += culler.IsOccluded(crate, model);
+        }
+        return rejected;
+    };
+
+    uint32_t rejected = cull(&pool);
+    INFO(walls.size() * 2 << " occluder triangles, " << crates.size()
+                          << " occludees, " << rejected << " rejected ("
+                          << rejected * 100.0f / crates.size() << "%)");
+    REQUIRE(rejected > 0);
+    REQUIRE(rejected < crates.size());
+    REQUIRE(cull(nullptr) == rejected);
+
+    BENCHMARK("cull serial") {
+        return cull(nullptr);
+    };
+
+    BENCHMARK("cull on thread pool") {
+        return cull(&pool);
+    };
+}
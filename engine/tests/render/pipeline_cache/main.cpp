@@ -0,0 +1,103 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/lowlevel/internal/pipeline_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace nickel::graphics;
+
+namespace {
+
+PipelineCacheDeviceInfo MakeDevice() {
+    PipelineCacheDeviceInfo device;
+    device.m_vendor_id = 0x10005;
+    device.m_device_id = 0x42;
+    device.m_driver_version = 7;
+    for (uint8_t i = 0; i < device.m_uuid.size(); i++) {
+        device.m_uuid[i] = i;
+    }
+    return device;
+}
+
+// driver cache data: `VkPipelineCacheHeaderVersionOne` followed by some
+// pipeline bytes
+std::vector<char> MakeDriverData(const PipelineCacheDeviceInfo& device) {
+    constexpr uint32_t HeaderSize = 32;
+    uint32_t header[4] = {HeaderSize, 1, device.m_vendor_id,
+                          device.m_device_id};
+
+    std::vector<char> data(HeaderSize + 100);
+    memcpy(data.data(), header, sizeof(header));
+    memcpy(data.data() + sizeof(header), device.m_uuid.data(),
+           device.m_uuid.size());
+    for (size_t i = HeaderSize; i < data.size(); i++) {
+        data[i] = static_cast<char>(i * 7);
+    }
+    return data;
+}
+
+}  // namespace
+
+TEST_CASE("pipeline cache round trip") {
+    auto device = MakeDevice();
+    auto driver_data = MakeDriverData(device);
+    auto file = PackPipelineCacheData(device, driver_data);
+    REQUIRE(file.size() ==
+            sizeof(PipelineCacheFileHeader) + driver_data.size());
+
+    auto data = UnpackPipelineCacheData(device, file);
+    REQUIRE(std::equal(data.begin(), data.end(), driver_data.begin(),
+                       driver_data.end()));
+}
+
+TEST_CASE("pipeline cache of other device is rejected") {
+    auto device = MakeDevice();
+    auto file = PackPipelineCacheData(device, MakeDriverData(device));
+
+    SECTION("driver update") {
+        device.m_driver_version++;
+    }
+    SECTION("other GPU") {
+        device.m_device_id++;
+    }
+    SECTION("cache UUID") {
+        device.m_uuid[3] ^= 1;
+    }
+    REQUIRE(UnpackPipelineCacheData(device, file).empty());
+}
+
+TEST_CASE("corrupted pipeline cache is rejected") {
+    auto device = MakeDevice();
+    auto file = PackPipelineCacheData(device, MakeDriverData(device));
+
+    SECTION("empty") {
+        file.clear();
+    }
+    SECTION("truncated header") {
+        file.resize(sizeof(PipelineCacheFileHeader) - 1);
+    }
+    SECTION("truncated data") {
+        file.pop_back();
+    }
+    SECTION("flipped bit in data") {
+        file[file.size() - 10] ^= 0x10;
+    }
+    SECTION("not a cache file") {
+        file[0] = 'x';
+    }
+    REQUIRE(UnpackPipelineCacheData(device, file).empty());
+}
+
+TEST_CASE("driver header must match device") {
+    auto device = MakeDevice();
+    auto other = device;
+    other.m_device_id++;
+
+    // file header of this device wrapping data of another one
+    auto file = PackPipelineCacheData(device, MakeDriverData(other));
+    REQUIRE(UnpackPipelineCacheData(device, file).empty());
+
+    // too small for a driver header
+    file = PackPipelineCacheData(device, std::vector<char>(8));
+    REQUIRE(UnpackPipelineCacheData(device, file).empty());
+}
@@ -0,0 +1,175 @@
+#include "../gpu_test.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/lowlevel/cmd_encoder.hpp"
+#include "nickel/graphics/lowlevel/readback.hpp"
+#include "nickel/graphics/render_graph.hpp"
+
+#include <filesystem>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+// red, green / blue, white quadrants of 32x32
+constexpr const char* ClearQuadrantsGolden =
+    "tests/render/readback/golden/clear_quadrants.png";
+
+ReadbackImage MakeGradient(uint32_t w, uint32_t h) {
+    ReadbackImage image;
+    image.m_extent = {w, h};
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            image.m_pixels.push_back(x * 255 / w);
+            image.m_pixels.push_back(y * 255 / h);
+            image.m_pixels.push_back(128);
+            image.m_pixels.push_back(255);
+        }
+    }
+    return image;
+}
+
+}  // namespace
+
+TEST_CASE("compare images") {
+    auto golden = MakeGradient(16, 8);
+    REQUIRE(golden);
+    REQUIRE(CompareImages(golden, golden).Passed());
+
+    SECTION("tolerance") {
+        auto image = golden;
+        image.m_pixels[0] += 2;
+        image.m_pixels[4 * 5 + 1] += 1;
+
+        auto diff = CompareImages(image, golden);
+        REQUIRE_FALSE(diff.Passed());
+        REQUIRE(diff.m_same_extent);
+        REQUIRE(diff.m_max_channel_diff == 2);
+        REQUIRE(diff.m_mismatched_pixels == 2);
+
+        diff = CompareImages(image, golden, 1);
+        REQUIRE(diff.m_mismatched_pixels == 1);
+        REQUIRE(CompareImages(image, golden, 2).Passed());
+    }
+
+    SECTION("extent mismatch") {
+        auto diff = CompareImages(MakeGradient(8, 16), golden);
+        REQUIRE_FALSE(diff.m_same_extent);
+        REQUIRE_FALSE(diff.Passed());
+        REQUIRE_FALSE(MakeDiffImage(MakeGradient(8, 16), golden));
+    }
+
+    SECTION("diff image") {
+        auto image = golden;
+        image.m_pixels[2] = 138;
+        auto diff = MakeDiffImage(image, golden);
+        REQUIRE(diff);
+        REQUIRE(diff.m_pixels[0] == 0);
+        REQUIRE(diff.m_pixels[2] == 10);
+        REQUIRE(diff.m_pixels[3] == 255);
+        REQUIRE(diff.m_pixels[6] == 0);
+    }
+}
+
+TEST_CASE("png round trip") {
+    auto image = MakeGradient(13, 7);
+    Path filename =
+        (std::filesystem::temp_directory_path() / "nickel_readback_test.png")
+            .string();
+    REQUIRE(SaveImagePNG(image, filename));
+
+    auto loaded = LoadImagePNG(filename);
+    REQUIRE(loaded);
+    REQUIRE(loaded.m_extent == image.m_extent);
+    REQUIRE(CompareImages(loaded, image).Passed());
+    std::filesystem::remove(filename.GetUnderlyingPath());
+
+    REQUIRE_FALSE(SaveImagePNG(ReadbackImage{}, filename));
+    REQUIRE_FALSE(LoadImagePNG("not_exists/nickel_readback_test.png"));
+}
+
+TEST_CASE("golden images load") {
+    auto golden = LoadImagePNG(ClearQuadrantsGolden);
+    REQUIRE(golden);
+    REQUIRE(golden.m_extent == SVector<uint32_t, 2>{32, 32});
+}
+
+TEST_CASE("headless clears match golden image", "[gpu]") {
+    Adapter::HeadlessDescriptor adapter_desc;
+    adapter_desc.m_size = {32, 32};
+    adapter_desc.m_image_count = 1;
+    adapter_desc.m_frames_in_flight = 2;
+    auto adapter = CreateGPUTestAdapter(adapter_desc);
+    Device device = adapter->GetDevice();
+    auto& image_info = device.GetSwapchainImageInfo();
+
+    // raised so an image is never reused before the fence of its frame
+    REQUIRE(image_info.m_image_count == device.GetFramesInFlight());
+
+    auto views = device.GetSwapchainImageViews();
+    RenderPass render_pass =
+        CreateClearRenderPass(device, image_info.m_surface_format.format);
+    Fence fence = device.CreateFence(true);
+    Semaphore image_avaliable_sem = device.CreateSemaphore();
+    Semaphore render_finish_sem = device.CreateSemaphore();
+
+    uint32_t image_index = device.WaitAndAcquireSwapchainImageIndex(
+        image_avaliable_sem, std::span{&fence, 1});
+    Framebuffer::Descriptor fbo_desc;
+    fbo_desc.m_views = {views[image_index]};
+    fbo_desc.m_extent = {image_info.m_extent.w, image_info.m_extent.h, 1};
+    fbo_desc.m_render_pass = render_pass;
+    Framebuffer fbo = device.CreateFramebuffer(fbo_desc);
+
+    CommandEncoder encoder = device.CreateCommandEncoder();
+    RenderGraph graph;
+    std::vector<ImageView> images{views[image_index]};
+    auto backbuffer = graph.ImportImage("backbuffer", ImageLayout::Undefined);
+    float half_w = image_info.m_extent.w / 2.0f;
+    float half_h = image_info.m_extent.h / 2.0f;
+    std::array<ClearValue, 4> colors = {
+        ClearValue{1.0f, 0.0f, 0.0f, 1.0f},
+        ClearValue{0.0f, 1.0f, 0.0f, 1.0f},
+        ClearValue{0.0f, 0.0f, 1.0f, 1.0f},
+        ClearValue{1.0f, 1.0f, 1.0f, 1.0f},
+    };
+    for (uint32_t i = 0; i < colors.size(); i++) {
+        Rect area{(i % 2) * half_w, (i / 2) * half_h, half_w, half_h};
+        graph
+            .AddPass("quadrant",
+                     [&, area, i] {
+                         auto pass = encoder.BeginRenderPass(
+                             render_pass, fbo, area,
+                             std::span{&colors[i], 1});
+                         pass.End();
+                     })
+            .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+    }
+    graph.Compile();
+    graph.Execute([&](RenderGraph::PassHandle,
+                      std::span<const RenderGraphBarrier> barriers) {
+        RecordRenderGraphBarriers(encoder, barriers, images);
+    });
+
+    Command cmd = encoder.Finish();
+    device.Submit(cmd, std::span{&image_avaliable_sem, 1},
+                  std::span{&render_finish_sem, 1}, fence);
+    device.Present(std::span{&render_finish_sem, 1});
+    device.EndFrame();
+    device.WaitIdle();
+
+    auto image = device.Readback(views[image_index].GetImage());
+    auto golden = LoadImagePNG(ClearQuadrantsGolden);
+    REQUIRE(image);
+    REQUIRE(golden);
+    auto diff = CompareImages(image, golden);
+    if (!diff.Passed()) {
+        auto dir = std::filesystem::temp_directory_path();
+        SaveImagePNG(image, (dir / "clear_quadrants.png").string());
+        SaveImagePNG(MakeDiffImage(image, golden),
+                     (dir / "clear_quadrants_diff.png").string());
+        INFO("result & diff image saved to " << dir.string());
+        REQUIRE(diff.Passed());
+    }
+    RequireNoValidationErrors(*adapter);
+}
@@ -0,0 +1,280 @@
+#include "../gpu_test.hpp"
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/lowlevel/cmd_encoder.hpp"
+#include "nickel/graphics/lowlevel/device.hpp"
+#include "nickel/graphics/render_graph.hpp"
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+RenderGraph::TransientDesc Transient(uint64_t size, uint64_t alignment = 1) {
+    return {size, alignment};
+}
+
+void RequirePixel(const ReadbackImage& image, uint32_t x, uint32_t y,
+                  std::array<unsigned char, 4> color) {
+    auto pixel = image.m_pixels.data() + (y * image.m_extent.w + x) * 4;
+    INFO("pixel " << x << ", " << y);
+    REQUIRE(std::equal(color.begin(), color.end(), pixel));
+}
+
+}  // namespace
+
+TEST_CASE("passes without consumers are culled") {
+    RenderGraph graph;
+    auto backbuffer = graph.ImportImage("backbuffer", ImageLayout::Undefined,
+                                        ImageLayout::PresentSrcKHR);
+    auto gbuffer = graph.CreateTransient("gbuffer", Transient(1024));
+    auto debug = graph.CreateTransient("debug", Transient(512));
+    auto debug_blur = graph.CreateTransient("debug_blur", Transient(512));
+
+    graph.AddPass("geometry").Write(gbuffer,
+                                    RenderGraphAccess::ColorAttachment);
+    graph.AddPass("debug_view")
+        .Read(gbuffer, RenderGraphAccess::ShaderRead)
+        .Write(debug, RenderGraphAccess::ColorAttachment);
+    graph.AddPass("debug_blur")
+        .Read(debug, RenderGraphAccess::ShaderRead)
+        .Write(debug_blur, RenderGraphAccess::ColorAttachment);
+    graph.AddPass("lighting")
+        .Read(gbuffer, RenderGraphAccess::ShaderRead)
+        .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+    graph.Compile();
+
+    REQUIRE(!graph.IsPassCulled(0));
+    REQUIRE(graph.IsPassCulled(1));
+    REQUIRE(graph.IsPassCulled(2));
+    REQUIRE(!graph.IsPassCulled(3));
+    REQUIRE(graph.GetExecutionOrder().size() == 2);
+    REQUIRE(graph.GetMemoryBlock(debug) == RenderGraph::NoMemoryBlock);
+
+    SECTION("side effect keeps a pass") {
+        RenderGraph graph;
+        auto readback = graph.CreateTransient("readback", Transient(64));
+        graph.AddPass("copy")
+            .Write(readback, RenderGraphAccess::TransferDst)
+            .SideEffect();
+        graph.Compile();
+        REQUIRE(!graph.IsPassCulled(0));
+    }
+}
+
+TEST_CASE("barriers follow accesses") {
+    RenderGraph graph;
+    auto backbuffer = graph.ImportImage("backbuffer", ImageLayout::Undefined,
+                                        ImageLayout::PresentSrcKHR);
+    auto shadow = graph.CreateTransient("shadow", Transient(2048));
+
+    std::vector<std::string> executed;
+    graph.AddPass("shadow", [&] { executed.push_back("shadow"); })
+        .Write(shadow, RenderGraphAccess::DepthStencilAttachment);
+    graph.AddPass("opaque", [&] { executed.push_back("opaque"); })
+        .Read(shadow, RenderGraphAccess::ShaderRead)
+        .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+    graph.AddPass("transparent", [&] { executed.push_back("transparent"); })
+        .Read(shadow, RenderGraphAccess::ShaderRead)
+        .Read(backbuffer, RenderGraphAccess::ColorAttachment)
+        .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+    graph.Compile();
+
+    auto shadow_barriers = graph.GetBarriers(0);
+    REQUIRE(shadow_barriers.size() == 1);
+    REQUIRE(shadow_barriers[0].m_old_layout == ImageLayout::Undefined);
+    REQUIRE(shadow_barriers[0].m_new_layout ==
+            ImageLayout::DepthStencilAttachmentOptimal);
+
+    auto opaque_barriers = graph.GetBarriers(1);
+    REQUIRE(opaque_barriers.size() == 2);
+    REQUIRE(opaque_barriers[0].m_resource == shadow);
+    REQUIRE(opaque_barriers[0].m_new_layout ==
+            ImageLayout::ShaderReadOnlyOptimal);
+    REQUIRE(opaque_barriers[0].m_src_access ==
+            RenderGraphAccess::DepthStencilAttachment);
+
+    // read after read in same layout needs no barrier, read-modify-write of
+    // backbuffer needs one
+    auto transparent_barriers = graph.GetBarriers(2);
+    REQUIRE(transparent_barriers.size() == 1);
+    REQUIRE(transparent_barriers[0].m_resource == backbuffer);
+    REQUIRE(transparent_barriers[0].m_old_layout ==
+            ImageLayout::ColorAttachmentOptimal);
+
+    auto final_barriers = graph.GetFinalBarriers();
+    REQUIRE(final_barriers.size() == 1);
+    REQUIRE(final_barriers[0].m_new_layout == ImageLayout::PresentSrcKHR);
+
+    std::vector<RenderGraph::PassHandle> barrier_passes;
+    graph.Execute([&](RenderGraph::PassHandle pass,
+                      std::span<const RenderGraphBarrier> barriers) {
+        barrier_passes.push_back(pass);
+        REQUIRE(!barriers.empty());
+    });
+    // final barriers come after the last pass
+    REQUIRE(barrier_passes == std::vector<RenderGraph::PassHandle>{
+                                  0, 1, 2, RenderGraph::NoPass});
+    REQUIRE(executed ==
+            std::vector<std::string>{"shadow", "opaque", "transparent"});
+}
+
+TEST_CASE("transients with disjoint lifetimes alias") {
+    RenderGraph graph;
+    auto backbuffer = graph.ImportImage("backbuffer", ImageLayout::Undefined);
+    auto a = graph.CreateTransient("a", Transient(1000, 256));
+    auto b = graph.CreateTransient("b", Transient(400, 256));
+    auto c = graph.CreateTransient("c", Transient(800, 256));
+    auto d = graph.CreateTransient("d", Transient(300, 256));
+
+    graph.AddPass("p0").Write(a, RenderGraphAccess::ColorAttachment);
+    graph.AddPass("p1")
+        .Read(a, RenderGraphAccess::ShaderRead)
+        .Write(b, RenderGraphAccess::ColorAttachment);
+    graph.AddPass("p2")
+        .Read(b, RenderGraphAccess::ShaderRead)
+        .Write(c, RenderGraphAccess::ColorAttachment);
+    graph.AddPass("p3")
+        .Read(c, RenderGraphAccess::ShaderRead)
+        .Write(d, RenderGraphAccess::ColorAttachment);
+    graph.AddPass("p4")
+        .Read(d, RenderGraphAccess::ShaderRead)
+        .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+    graph.Compile();
+
+    // a & c never live at the same time, neither do b & d
+    REQUIRE(graph.GetMemoryBlock(a) == graph.GetMemoryBlock(c));
+    REQUIRE(graph.GetMemoryBlock(b) == graph.GetMemoryBlock(d));
+    REQUIRE(graph.GetMemoryBlock(a) != graph.GetMemoryBlock(b));
+    REQUIRE(graph.GetMemoryOffset(b) % 256 == 0);
+    REQUIRE(graph.GetUnaliasedMemorySize() == 2500);
+    REQUIRE(graph.GetTransientMemorySize() == 1024 + 400);
+
+    // aliased resource starts with undefined content
+    auto c_barriers = graph.GetBarriers(2);
+    REQUIRE(c_barriers[1].m_resource == c);
+    REQUIRE(c_barriers[1].m_old_layout == ImageLayout::Undefined);
+}
+
+TEST_CASE("dump compiled graph") {
+    RenderGraph graph;
+    auto backbuffer = graph.ImportImage("backbuffer", ImageLayout::Undefined,
+                                        ImageLayout::PresentSrcKHR);
+    auto depth = graph.CreateTransient("depth", Transient(128));
+    graph.AddPass("scene")
+        .Write(backbuffer, RenderGraphAccess::ColorAttachment)
+        .Write(depth, RenderGraphAccess::DepthStencilAttachment);
+    graph.AddPass("unused").Read(depth, RenderGraphAccess::ShaderRead);
+    graph.Compile();
+
+    std::string dump = graph.Dump();
+    REQUIRE(dump ==
+            "pass scene\n"
+            "  write backbuffer color_attachment\n"
+            "  write depth depth_stencil_attachment\n"
+            "  barrier backbuffer undefined -> color_attachment\n"
+            "  barrier depth undefined -> depth_stencil_attachment\n"
+            "pass unused (culled)\n"
+            "  read depth shader_read\n"
+            "final\n"
+            "  barrier backbuffer color_attachment -> present_src\n"
+            "resource backbuffer imported\n"
+            "resource depth block 0 offset 0 size 128\n"
+            "transient memory 128 / 128\n");
+
+    REQUIRE(graph.DumpGraphviz() ==
+            "digraph RenderGraph {\n"
+            "  pass0 [label=\"scene\", shape=box];\n"
+            "  pass1 [label=\"unused\", shape=box, style=dashed];\n"
+            "  res0 [label=\"backbuffer\", shape=ellipse, style=bold];\n"
+            "  res1 [label=\"depth\", shape=ellipse];\n"
+            "  pass0 -> res0 [label=\"color_attachment\"];\n"
+            "  pass0 -> res1 [label=\"depth_stencil_attachment\"];\n"
+            "  res1 -> pass1 [label=\"shader_read\"];\n"
+            "}\n");
+}
+
+TEST_CASE("headless frames through the render graph", "[gpu]") {
+    Adapter::HeadlessDescriptor adapter_desc;
+    adapter_desc.m_size = {64, 64};
+    adapter_desc.m_image_count = 3;
+    adapter_desc.m_frames_in_flight = 2;
+    auto adapter = CreateGPUTestAdapter(adapter_desc);
+    Device device = adapter->GetDevice();
+    auto& image_info = device.GetSwapchainImageInfo();
+    auto views = device.GetSwapchainImageViews();
+
+    RenderPass render_pass =
+        CreateClearRenderPass(device, image_info.m_surface_format.format);
+    std::vector<Framebuffer> fbos;
+    std::vector<Semaphore> render_finish_sems;
+    for (auto& view : views) {
+        Framebuffer::Descriptor desc;
+        desc.m_views = {view};
+        desc.m_extent = {image_info.m_extent.w, image_info.m_extent.h, 1};
+        desc.m_render_pass = render_pass;
+        fbos.push_back(device.CreateFramebuffer(desc));
+        render_finish_sems.push_back(device.CreateSemaphore());
+    }
+    std::vector<Fence> fences;
+    std::vector<Semaphore> image_avaliable_sems;
+    for (uint32_t i = 0; i < device.GetFramesInFlight(); i++) {
+        fences.push_back(device.CreateFence(true));
+        image_avaliable_sems.push_back(device.CreateSemaphore());
+    }
+
+    // same frame loop as `ContextImpl`, two passes writing the backbuffer
+    // with every transition recorded from the graph
+    RenderGraph graph;
+    uint32_t image_index{};
+    for (uint32_t frame = 0; frame < 8; frame++) {
+        uint32_t frame_index = device.GetCurrentFrameIndex();
+        image_index = device.WaitAndAcquireSwapchainImageIndex(
+            image_avaliable_sems[frame_index],
+            std::span{&fences[frame_index], 1});
+
+        CommandEncoder encoder = device.CreateCommandEncoder();
+        auto clear = [&](const Rect& area, const ClearValue& value) {
+            ClearValue clear_value = value;
+            auto pass = encoder.BeginRenderPass(
+                render_pass, fbos[image_index], area,
+                std::span{&clear_value, 1});
+            pass.End();
+        };
+        float w = image_info.m_extent.w, h = image_info.m_extent.h;
+
+        graph.Clear();
+        std::vector<ImageView> images{views[image_index]};
+        auto backbuffer =
+            graph.ImportImage("backbuffer", ImageLayout::Undefined);
+        graph
+            .AddPass("background",
+                     [&] { clear({0, 0, w, h}, {1.0f, 0.0f, 0.0f, 1.0f}); })
+            .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+        graph
+            .AddPass(
+                "overlay",
+                [&] { clear({0, 0, w / 2, h / 2}, {0.0f, 1.0f, 0.0f, 1.0f}); })
+            .Write(backbuffer, RenderGraphAccess::ColorAttachment);
+        graph.Compile();
+        REQUIRE(graph.GetBarriers(1).size() == 1);
+        graph.Execute([&](RenderGraph::PassHandle,
+                          std::span<const RenderGraphBarrier> barriers) {
+            RecordRenderGraphBarriers(encoder, barriers, images);
+        });
+
+        Command cmd = encoder.Finish();
+        device.Submit(cmd, std::span{&image_avaliable_sems[frame_index], 1},
+                      std::span{&render_finish_sems[image_index], 1},
+                      fences[frame_index]);
+        device.Present(std::span{&render_finish_sems[image_index], 1});
+        device.EndFrame();
+    }
+    device.WaitIdle();
+
+    auto image = device.Readback(views[image_index].GetImage());
+    REQUIRE(image);
+    RequirePixel(image, 0, 0, {0, 255, 0, 255});
+    RequirePixel(image, 63, 0, {255, 0, 0, 255});
+    RequirePixel(image, 63, 63, {255, 0, 0, 255});
+    RequireNoValidationErrors(*adapter);
+}
@@ -0,0 +1,123 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/common/hash.hpp"
+#include "nickel/graphics/gltf.hpp"
+#include "nickel/graphics/internal/gltf_loader.hpp"
+#include "nickel/graphics/internal/texture_impl.hpp"
+
+#include <fstream>
+#include <unordered_set>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+std::unique_ptr<GLTFParsedModel> Parse(const Path& filename) {
+    std::ifstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    return ParseGLTFModel(filename, {std::istreambuf_iterator<char>{file},
+                                     std::istreambuf_iterator<char>{}});
+}
+
+const std::vector<Path> Models{
+    "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.gltf",
+    "engine/assets/models/CesiumMan/CesiumMan.gltf",
+    "engine/assets/models/ReciprocatingSaw/ReciprocatingSaw.gltf",
+    "engine/assets/models/unit_box/unit_box.gltf",
+    "engine/assets/models/unit_cylinder/cylinder.gltf",
+    "engine/assets/models/unit_semi_sphere/semi_sphere.gltf",
+    "engine/assets/models/unit_sphere/unit_sphere.gltf",
+};
+
+}  // namespace
+
+TEST_CASE("hash bytes") {
+    std::string a = "nickel engine content hash";
+    std::string b = a;
+    auto bytes = [](const std::string& s) {
+        return std::span{reinterpret_cast<const unsigned char*>(s.data()),
+                         s.size()};
+    };
+    REQUIRE(HashBytes(bytes(a)) == HashBytes(bytes(b)));
+    b.back() = 'H';
+    REQUIRE(HashBytes(bytes(a)) != HashBytes(bytes(b)));
+    // length is part of the hash
+    REQUIRE(HashBytes(bytes(a)) != HashBytes(bytes(a + '\0')));
+}
+
+TEST_CASE("sampler descriptor key") {
+    Sampler::Descriptor a, b;
+    REQUIRE(a == b);
+    REQUIRE(std::hash<Sampler::Descriptor>{}(a) ==
+            std::hash<Sampler::Descriptor>{}(b));
+
+    b.m_address_mode_u = SamplerAddressMode::ClampToEdge;
+    REQUIRE(a != b);
+    REQUIRE(std::hash<Sampler::Descriptor>{}(a) !=
+            std::hash<Sampler::Descriptor>{}(b));
+}
+
+TEST_CASE("pack PBR parameters") {
+    PBRParameters red{Vec4{1, 0, 0, 1}, 0.0f, 0.5f};
+    PBRParameters green{Vec4{0, 1, 0, 1}, 0.0f, 0.5f};
+    std::vector<PBRParameters> params{red, green, red, red, green};
+
+    std::vector<unsigned char> data;
+    auto offsets = PackPBRParameters(params, 256, data);
+    REQUIRE(offsets.size() == params.size());
+    REQUIRE(data.size() == 256 + sizeof(PBRParameters));
+    REQUIRE(offsets == std::vector<uint32_t>{0, 256, 0, 0, 256});
+
+    PBRParameters unpacked;
+    memcpy(&unpacked, data.data() + 256, sizeof(unpacked));
+    REQUIRE(unpacked == green);
+}
+
+TEST_CASE("texture content key") {
+    Path truck = "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.jpg";
+    auto key = ComputeTextureContentKey(truck, Format::R8G8B8A8_SRGB);
+    REQUIRE(key);
+    REQUIRE(key == ComputeTextureContentKey(truck, Format::R8G8B8A8_SRGB));
+    // same bytes decoded differently are different textures
+    REQUIRE(key != ComputeTextureContentKey(truck, Format::R8G8B8A8_UNORM));
+}
+
+TEST_CASE("duplicates in bundled models") {
+    uint32_t samplers = 0, textures = 0, materials = 0;
+    uint32_t unique_materials = 0;
+    std::unordered_set<Sampler::Descriptor> unique_samplers;
+    std::unordered_set<TextureContentKey> unique_textures;
+    for (auto& filename : Models) {
+        auto parsed = Parse(filename);
+        REQUIRE(parsed);
+        auto& model = parsed->m_gltf_model;
+
+        for (auto& sampler : model.samplers) {
+            unique_samplers.insert(GLTFSampler2Descriptor(sampler));
+        }
+        samplers += model.samplers.size();
+
+        GLTFLoader loader{model};
+        for (auto& image : loader.CollectImages(filename.ParentPath())) {
+            auto key =
+                ComputeTextureContentKey(image.m_filename, image.m_format);
+            REQUIRE(key);
+            unique_textures.insert(*key);
+            textures++;
+        }
+
+        auto cpu_data = loader.LoadCPUData();
+        std::vector<unsigned char> data;
+        auto offsets = PackPBRParameters(cpu_data.pbr_parameters, 256, data);
+        std::unordered_set<uint32_t> blocks{offsets.begin(), offsets.end()};
+        materials += offsets.size();
+        unique_materials += blocks.size();
+    }
+
+    INFO("samplers: " << samplers << " -> " << unique_samplers.size()
+                      << ", textures: " << textures << " -> "
+                      << unique_textures.size() << ", parameter blocks: "
+                      << materials << " -> " << unique_materials);
+    REQUIRE(unique_samplers.size() <= samplers);
+    REQUIRE(unique_textures.size() <= textures);
+    REQUIRE(unique_materials <= materials);
+}
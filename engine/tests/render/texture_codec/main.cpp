@@ -0,0 +1,200 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/fs/mapped_file.hpp"
+#include "nickel/graphics/internal/ktx2.hpp"
+#include "nickel/graphics/internal/texture_impl.hpp"
+
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+// smooth gradient, roughly what block compression meets in real textures
+std::vector<unsigned char> MakeImage(uint32_t w, uint32_t h, bool alpha) {
+    std::vector<unsigned char> pixels(w * h * 4);
+    for (uint32_t y = 0; y < h; y++) {
+        for (uint32_t x = 0; x < w; x++) {
+            unsigned char* p = &pixels[(y * w + x) * 4];
+            p[0] = x * 255 / (w - 1);
+            p[1] = y * 255 / (h - 1);
+            p[2] = (x + y) * 255 / (w + h - 2);
+            p[3] = alpha ? 255 - x * 255 / (w - 1) : 255;
+        }
+    }
+    return pixels;
+}
+
+// uncompressed 32bit top-left TGA, readable by stb_image
+void WriteTGA(const Path& filename, uint32_t w, uint32_t h,
+              const std::vector<unsigned char>& rgba) {
+    unsigned char header[18]{};
+    header[2] = 2;
+    header[12] = w & 0xFF;
+    header[13] = w >> 8;
+    header[14] = h & 0xFF;
+    header[15] = h >> 8;
+    header[16] = 32;
+    header[17] = 0x28;
+    std::ofstream file{filename.GetUnderlyingPath(), std::ios::binary};
+    file.write((const char*)header, sizeof(header));
+    for (size_t i = 0; i < rgba.size(); i += 4) {
+        char bgra[4] = {(char)rgba[i + 2], (char)rgba[i + 1], (char)rgba[i],
+                        (char)rgba[i + 3]};
+        file.write(bgra, 4);
+    }
+}
+
+double MeanAbsError(std::span<const unsigned char> a,
+                    std::span<const unsigned char> b) {
+    REQUIRE(a.size() == b.size());
+    uint64_t sum = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        sum += std::abs(a[i] - b[i]);
+    }
+    return double(sum) / a.size();
+}
+
+}  // namespace
+
+TEST_CASE("mip chain generation") {
+    auto pixels = MakeImage(64, 32, false);
+    auto texture = GenerateMipChain(pixels.data(), 64, 32, false);
+    REQUIRE(texture.m_format == Format::R8G8B8A8_UNORM);
+    REQUIRE(texture.m_levels.size() == 7);
+    REQUIRE(CalcMipLevelCount(64, 32) == 7);
+    REQUIRE(texture.m_levels[1].m_extent == SVector<uint32_t, 2>{32, 16});
+    REQUIRE(texture.m_levels[6].m_extent == SVector<uint32_t, 2>{1, 1});
+    REQUIRE(texture.m_data.size() ==
+            CalcTextureSize(Format::R8G8B8A8_UNORM, 64, 32, 7));
+
+    SECTION("sRGB texels are averaged in linear space") {
+        // half black, half white
+        std::vector<unsigned char> checker{0,   0,   0,   255, 255, 255,
+                                           255, 255, 0,   0,   0,   255,
+                                           255, 255, 255, 255};
+        auto linear = GenerateMipChain(checker.data(), 2, 2, false);
+        auto srgb = GenerateMipChain(checker.data(), 2, 2, true);
+        REQUIRE(linear.GetLevelData(1)[0] == 128);
+        REQUIRE(srgb.GetLevelData(1)[0] == 188);
+        REQUIRE(srgb.GetLevelData(1)[3] == 255);
+    }
+
+    SECTION("odd extent") {
+        auto odd = GenerateMipChain(pixels.data(), 5, 3, false);
+        REQUIRE(odd.m_levels.size() == 3);
+        REQUIRE(odd.m_levels[1].m_extent == SVector<uint32_t, 2>{2, 1});
+    }
+}
+
+TEST_CASE("BC block compression round trip") {
+    constexpr uint32_t Size = 64;
+    auto opaque = MakeImage(Size, Size, false);
+    auto translucent = MakeImage(Size, Size, true);
+
+    auto bc1 = CompressTexture(
+        GenerateMipChain(opaque.data(), Size, Size, false),
+        Format::BC1_RGB_UNORM_BLOCK);
+    auto bc3 = CompressTexture(
+        GenerateMipChain(translucent.data(), Size, Size, false),
+        Format::BC3_UNORM_BLOCK);
+    REQUIRE(bc1.m_levels.size() == 7);
+    REQUIRE(bc1.m_data.size() ==
+            CalcTextureSize(Format::BC1_RGB_UNORM_BLOCK, Size, Size, 7));
+    REQUIRE(bc3.m_data.size() ==
+            CalcTextureSize(Format::BC3_UNORM_BLOCK, Size, Size, 7));
+
+    // 4bpp and 8bpp against 32bpp
+    REQUIRE(bc1.GetLevelData(0).size() * 8 == opaque.size());
+    REQUIRE(bc3.GetLevelData(0).size() * 4 == translucent.size());
+
+    auto bc1_decoded = DecompressTexture(bc1);
+    auto bc3_decoded = DecompressTexture(bc3);
+    REQUIRE(bc1_decoded.m_format == Format::R8G8B8A8_UNORM);
+    REQUIRE(bc1_decoded.m_levels.size() == 7);
+    CHECK(MeanAbsError(bc1_decoded.GetLevelData(0), opaque) < 3.0);
+    CHECK(MeanAbsError(bc3_decoded.GetLevelData(0), translucent) < 3.0);
+
+    SECTION("solid block is lossless") {
+        unsigned char texels[16 * 4];
+        for (uint32_t i = 0; i < 16; i++) {
+            texels[i * 4] = 255;
+            texels[i * 4 + 1] = 0;
+            texels[i * 4 + 2] = 255;
+            texels[i * 4 + 3] = 100;
+        }
+        unsigned char block[16], decoded[16 * 4];
+        CompressBC3Block(texels, block);
+        DecompressBC3Block(block, decoded);
+        REQUIRE(memcmp(texels, decoded, sizeof(texels)) == 0);
+    }
+}
+
+TEST_CASE("KTX2 write and parse") {
+    auto pixels = MakeImage(32, 32, false);
+    auto texture = CompressTexture(
+        GenerateMipChain(pixels.data(), 32, 32, true),
+        Format::BC1_RGB_SRGB_BLOCK);
+    auto data = WriteKTX2(texture);
+
+    KTX2View view{data};
+    REQUIRE(view.IsValid());
+    REQUIRE(view.GetFormat() == Format::BC1_RGB_SRGB_BLOCK);
+    REQUIRE(view.GetExtent() == SVector<uint32_t, 2>{32, 32});
+    REQUIRE(view.GetLevelCount() == 6);
+    auto parsed = view.ToTextureData();
+    REQUIRE(parsed.m_data == texture.m_data);
+    for (uint32_t i = 0; i < view.GetLevelCount(); i++) {
+        // level data aligned to block size
+        REQUIRE((view.GetLevelData(i).data() - data.data()) % 8 == 0);
+    }
+
+    SECTION("truncated file") {
+        data.resize(data.size() - 1);
+        REQUIRE_FALSE(KTX2View{data}.IsValid());
+    }
+
+    SECTION("bad identifier") {
+        data[1] = 'X';
+        REQUIRE_FALSE(KTX2View{data}.IsValid());
+    }
+
+    SECTION("supercompression") {
+        KTX2Header header;
+        memcpy(&header, data.data(), sizeof(header));
+        header.m_supercompression_scheme = 2;  // zstd
+        memcpy(data.data(), &header, sizeof(header));
+        REQUIRE_FALSE(KTX2View{data}.IsValid());
+    }
+}
+
+TEST_CASE("cook texture and load by device features") {
+    Path image_filename = "texture_codec_test.tga";
+    Path cooked_filename = "texture_codec_test.ktx2";
+    constexpr uint32_t Size = 256;
+    WriteTGA(image_filename, Size, Size, MakeImage(Size, Size, false));
+    REQUIRE(CookTextureFile(image_filename, true));
+
+    Adapter::Features bc_features;
+    bc_features.texture_compression_bc = true;
+    auto compressed = LoadTextureData(cooked_filename,
+                                      Format::R8G8B8A8_SRGB, bc_features);
+    REQUIRE(compressed.m_format == Format::BC1_RGB_SRGB_BLOCK);
+    REQUIRE(compressed.m_levels.size() == 9);
+
+    // no BC support: decompressed on CPU, mips kept
+    auto fallback = LoadTextureData(cooked_filename, Format::R8G8B8A8_SRGB,
+                                    Adapter::Features{});
+    REQUIRE(fallback.m_format == Format::R8G8B8A8_SRGB);
+    REQUIRE(fallback.m_levels.size() == 9);
+
+    uint64_t raw_size = CalcLevelSize(Format::R8G8B8A8_SRGB, Size, Size);
+    INFO("VRAM of " << Size << "x" << Size << " texture: RGBA8 no mips "
+                    << raw_size / 1024 << " KiB, RGBA8 mips "
+                    << fallback.m_data.size() / 1024 << " KiB, BC1 mips "
+                    << compressed.m_data.size() / 1024 << " KiB");
+    REQUIRE(compressed.m_data.size() * 8 < raw_size * 2);
+
+    std::filesystem::remove(image_filename.GetUnderlyingPath());
+    std::filesystem::remove(cooked_filename.GetUnderlyingPath());
+}
@@ -0,0 +1,301 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/common/math/math.hpp"
+#include "nickel/graphics/internal/texture_codec.hpp"
+#include "nickel/graphics/internal/texture_streamer.hpp"
+
+#include <cmath>
+#include <deque>
+#include <fstream>
+
+using namespace nickel;
+using namespace nickel::graphics;
+
+namespace {
+
+constexpr uint64_t MiB = 1024 * 1024;
+
+struct VirtualTexture {
+    TextureStreamer::ID m_id;
+    Vec3 m_position;
+    uint32_t m_size;
+};
+
+struct InFlight {
+    TextureStreamer::ID m_id;
+    uint32_t m_finish_frame;
+};
+
+/**
+ * grid of textured quads, the camera moves along `path` and requests levels
+ * by projected size. Stream-ins finish after `latency` frames like reads on
+ * worker threads.
+ */
+class Scene {
+public:
+    Scene(const TextureStreamer::Config& config, uint32_t latency)
+        : m_streamer{config}, m_latency{latency} {
+        constexpr uint32_t Sizes[] = {256, 512, 1024, 2048};
+        for (int x = 0; x < 8; x++) {
+            for (int z = 0; z < 8; z++) {
+                uint32_t size = Sizes[(x * 3 + z) % 4];
+                auto id = m_streamer.Register(Format::R8G8B8A8_UNORM,
+                                              {size, size},
+                                              CalcMipLevelCount(size, size));
+                m_textures.push_back(
+                    {id, Vec3(x * 10.0f, 0.0f, z * 10.0f), size});
+                m_resident[id] = m_streamer.GetTailLevel(id);
+            }
+        }
+    }
+
+    void Step(const Vec3& camera) {
+        for (auto& texture : m_textures) {
+            float distance = Length(texture.m_position - camera);
+            if (distance > m_view_distance) {
+                continue;
+            }
+            // 2 units quad, 1000 pixels per unit at unit distance
+            float screen_size = 2000.0f / std::max(distance, 0.1f);
+            m_streamer.RequestLevel(
+                texture.m_id,
+                CalcDesiredMipLevel({texture.m_size, texture.m_size},
+                                    screen_size,
+                                    CalcMipLevelCount(texture.m_size,
+                                                      texture.m_size)));
+        }
+
+        for (auto& action : m_streamer.Update()) {
+            if (action.m_type == TextureStreamer::Action::Type::Evict) {
+                REQUIRE(action.m_level == m_streamer.GetTailLevel(action.m_id));
+                m_resident[action.m_id] = action.m_level;
+                m_evict_count++;
+            } else {
+                REQUIRE(action.m_level < m_resident[action.m_id]);
+                m_in_flight.push_back({action.m_id, m_frame + m_latency});
+                m_stream_in_count++;
+            }
+        }
+
+        while (!m_in_flight.empty() &&
+               m_in_flight.front().m_finish_frame <= m_frame) {
+            auto id = m_in_flight.front().m_id;
+            m_streamer.FinishStreamIn(id);
+            m_resident[id] = m_streamer.GetResidentLevel(id);
+            m_in_flight.pop_front();
+        }
+
+        m_max_used = std::max(m_max_used, m_streamer.GetUsedSize());
+        REQUIRE(m_streamer.GetUsedSize() <= m_streamer.GetConfig().m_budget);
+        checkAccounting();
+        m_frame++;
+    }
+
+    void Flush() {
+        for (auto& in_flight : m_in_flight) {
+            m_streamer.FinishStreamIn(in_flight.m_id);
+            m_resident[in_flight.m_id] =
+                m_streamer.GetResidentLevel(in_flight.m_id);
+        }
+        m_in_flight.clear();
+    }
+
+    TextureStreamer m_streamer;
+    std::vector<VirtualTexture> m_textures;
+    uint64_t m_max_used{};
+    uint32_t m_evict_count{};
+    uint32_t m_stream_in_count{};
+
+private:
+    uint32_t m_latency;
+    uint32_t m_frame{};
+    float m_view_distance = 30.0f;
+    std::unordered_map<TextureStreamer::ID, uint32_t> m_resident;
+    std::deque<InFlight> m_in_flight;
+
+    // used size is resident levels plus reservations of in-flight stream-ins
+    void checkAccounting() {
+        uint64_t expect = 0;
+        for (auto& texture : m_textures) {
+            REQUIRE(m_streamer.GetResidentLevel(texture.m_id) ==
+                    m_resident[texture.m_id]);
+            REQUIRE(m_resident[texture.m_id] <=
+                    m_streamer.GetTailLevel(texture.m_id));
+            expect += m_streamer.GetLevelsSize(texture.m_id,
+                                               m_resident[texture.m_id]);
+        }
+        uint64_t reserved = m_streamer.GetUsedSize() - expect;
+        if (m_in_flight.empty()) {
+            REQUIRE(reserved == 0);
+        }
+    }
+};
+
+}  // namespace
+
+TEST_CASE("desired mip level by screen size") {
+    REQUIRE(CalcDesiredMipLevel({1024, 1024}, 2048.0f, 11) == 0);
+    REQUIRE(CalcDesiredMipLevel({1024, 1024}, 1024.0f, 11) == 0);
+    REQUIRE(CalcDesiredMipLevel({1024, 1024}, 512.0f, 11) == 1);
+    REQUIRE(CalcDesiredMipLevel({1024, 1024}, 300.0f, 11) == 1);
+    REQUIRE(CalcDesiredMipLevel({1024, 512}, 100.0f, 11) == 3);
+    REQUIRE(CalcDesiredMipLevel({1024, 1024}, 0.0f, 11) == 10);
+    REQUIRE(CalcDesiredMipLevel({1024, 1024}, 1.0f, 4) == 3);
+}
+
+TEST_CASE("mip tail stays resident") {
+    TextureStreamer::Config config;
+    config.m_mip_tail_size = 64;
+    TextureStreamer streamer{config};
+
+    auto big = streamer.Register(Format::R8G8B8A8_UNORM, {1024, 512}, 11);
+    auto small = streamer.Register(Format::R8G8B8A8_UNORM, {32, 32}, 6);
+    REQUIRE(streamer.GetTailLevel(big) == 4);
+    REQUIRE(streamer.GetResidentLevel(big) == 4);
+    REQUIRE(streamer.GetTailLevel(small) == 0);
+    REQUIRE(streamer.GetUsedSize() ==
+            CalcTextureSize(Format::R8G8B8A8_UNORM, 64, 32, 7) +
+                CalcTextureSize(Format::R8G8B8A8_UNORM, 32, 32, 6));
+
+    streamer.Unregister(big);
+    streamer.Unregister(small);
+    REQUIRE(streamer.GetUsedSize() == 0);
+}
+
+TEST_CASE("evict least recently used texture") {
+    TextureStreamer::Config config;
+    config.m_mip_tail_size = 64;
+    config.m_max_stream_in_per_frame = 1;
+    TextureStreamer probe{config};
+    auto probe_id = probe.Register(Format::R8G8B8A8_UNORM, {256, 256}, 9);
+    uint64_t tail = probe.GetUsedSize();
+    uint64_t full = probe.GetLevelsSize(probe_id, 0);
+    // room for two of three textures at full detail
+    config.m_budget = tail + 2 * full;
+    TextureStreamer streamer{config};
+
+    TextureStreamer::ID ids[3];
+    for (auto& id : ids) {
+        id = streamer.Register(Format::R8G8B8A8_UNORM, {256, 256}, 9);
+    }
+
+    auto stream = [&](TextureStreamer::ID id) {
+        streamer.RequestLevel(id, 0);
+        auto actions = streamer.Update();
+        REQUIRE(!actions.empty());
+        REQUIRE(actions.back().m_type == TextureStreamer::Action::Type::StreamIn);
+        streamer.FinishStreamIn(id);
+        return actions;
+    };
+
+    stream(ids[0]);
+    stream(ids[1]);
+    // touch 0 again, so 1 is the least recently used
+    streamer.RequestLevel(ids[0], 0);
+    REQUIRE(streamer.Update().empty());
+
+    auto actions = stream(ids[2]);
+    REQUIRE(actions.size() == 2);
+    REQUIRE(actions[0].m_type == TextureStreamer::Action::Type::Evict);
+    REQUIRE(actions[0].m_id == ids[1]);
+    REQUIRE(streamer.GetResidentLevel(ids[0]) == 0);
+    REQUIRE(streamer.GetResidentLevel(ids[1]) == streamer.GetTailLevel(ids[1]));
+    REQUIRE(streamer.GetResidentLevel(ids[2]) == 0);
+    REQUIRE(streamer.GetUsedSize() <= config.m_budget);
+
+    SECTION("textures in use at desired level are not evicted") {
+        // 0 & 2 fill the budget and are still wanted, 1 has to wait
+        streamer.RequestLevel(ids[0], 0);
+        streamer.RequestLevel(ids[1], 0);
+        streamer.RequestLevel(ids[2], 0);
+        REQUIRE(streamer.Update().empty());
+        REQUIRE(streamer.GetResidentLevel(ids[0]) == 0);
+        REQUIRE(streamer.GetResidentLevel(ids[2]) == 0);
+    }
+
+    SECTION("cancel releases reservation") {
+        streamer.Unregister(ids[2]);
+        uint64_t used = streamer.GetUsedSize();
+        streamer.RequestLevel(ids[0], 0);
+        streamer.RequestLevel(ids[1], 0);
+        auto actions = streamer.Update();
+        REQUIRE(actions.size() == 1);
+        REQUIRE(actions[0].m_type == TextureStreamer::Action::Type::StreamIn);
+        REQUIRE(streamer.GetUsedSize() == used + full - tail);
+        streamer.CancelStreamIn(ids[1]);
+        REQUIRE(streamer.GetUsedSize() == used);
+        REQUIRE(streamer.GetResidentLevel(ids[1]) ==
+                streamer.GetTailLevel(ids[1]));
+    }
+}
+
+TEST_CASE("camera paths never exceed budget") {
+    TextureStreamer::Config config;
+    config.m_enable = true;
+    config.m_budget = 12 * MiB;
+    config.m_mip_tail_size = 64;
+    config.m_max_stream_in_per_frame = 4;
+
+    SECTION("fly through grid") {
+        Scene scene{config, 3};
+        for (int frame = 0; frame < 400; frame++) {
+            float t = frame / 400.0f;
+            scene.Step(Vec3(t * 80.0f - 5.0f, 2.0f, t * 70.0f));
+        }
+        INFO("fly through: " << scene.m_stream_in_count << " stream-ins, "
+                             << scene.m_evict_count << " evictions, peak "
+                             << scene.m_max_used / 1024 << " KiB of "
+                             << config.m_budget / 1024 << " KiB");
+        REQUIRE(scene.m_stream_in_count > 0);
+        REQUIRE(scene.m_evict_count > 0);
+    }
+
+    SECTION("orbit with teleports") {
+        Scene scene{config, 5};
+        for (int frame = 0; frame < 600; frame++) {
+            float angle = frame * 0.05f;
+            Vec3 center = frame % 150 < 75 ? Vec3(20.0f, 3.0f, 20.0f)
+                                            : Vec3(55.0f, 3.0f, 50.0f);
+            scene.Step(center +
+                       Vec3(std::cos(angle) * 15.0f, 0.0f,
+                            std::sin(angle) * 15.0f));
+        }
+        REQUIRE(scene.m_evict_count > 0);
+    }
+
+    SECTION("tight budget only keeps tails plus little") {
+        config.m_budget = 2 * MiB;
+        Scene scene{config, 1};
+        for (int frame = 0; frame < 200; frame++) {
+            scene.Step(Vec3(frame * 0.4f, 1.0f, 35.0f));
+        }
+    }
+
+    SECTION("standing still reaches full detail nearby") {
+        Scene scene{config, 2};
+        Vec3 camera(30.0f, 0.5f, 30.5f);
+        for (int frame = 0; frame < 30; frame++) {
+            scene.Step(camera);
+        }
+        scene.Flush();
+        for (auto& texture : scene.m_textures) {
+            if (Length(texture.m_position - camera) < 1.0f) {
+                REQUIRE(scene.m_streamer.GetResidentLevel(texture.m_id) == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("streaming config from toml") {
+    Path filename = "texture_streaming_test.toml";
+    {
+        std::ofstream file{filename.GetUnderlyingPath()};
+        file << "enable = true\nbudget_mb = 64\nmip_tail_size = 128\n";
+    }
+    auto config = TextureStreamingConfig::LoadFromFile(filename);
+    REQUIRE(config.m_enable);
+    REQUIRE(config.m_budget == 64 * MiB);
+    REQUIRE(config.m_mip_tail_size == 128);
+    REQUIRE(config.m_max_stream_in_per_frame ==
+            TextureStreamingConfig{}.m_max_stream_in_per_frame);
+    std::filesystem::remove(filename.GetUnderlyingPath());
+}
@@ -0,0 +1,72 @@
+#include "catch2/catch_test_macros.hpp"
+#include "nickel/graphics/uniform_ring.hpp"
+
+#include <set>
+
+using namespace nickel::graphics;
+
+TEST_CASE("ring allocations are aligned in one page") {
+    RingPageAllocator allocator{1024, 256, 2};
+    allocator.BeginFrame(0);
+
+    auto a = allocator.Allocate(64);
+    auto b = allocator.Allocate(300);
+    auto c = allocator.Allocate(1);
+    REQUIRE(a);
+    REQUIRE(b);
+    REQUIRE(c);
+    REQUIRE(a->m_offset == 0);
+    REQUIRE(b->m_offset == 256);
+    REQUIRE(c->m_offset == 768);
+    REQUIRE(a->m_page == b->m_page);
+    REQUIRE(b->m_page == c->m_page);
+    REQUIRE(allocator.GetPageCount() == 1);
+}
+
+TEST_CASE("full ring page chains another one") {
+    RingPageAllocator allocator{512, 256, 2};
+    allocator.BeginFrame(0);
+
+    std::set<uint32_t> pages;
+    for (int i = 0; i < 5; i++) {
+        auto allocation = allocator.Allocate(200);
+        REQUIRE(allocation);
+        REQUIRE(allocation->m_offset + 200 <= 512);
+        pages.insert(allocation->m_page);
+    }
+    REQUIRE(pages.size() == 3);
+    REQUIRE(allocator.GetFramePageCount() == 3);
+
+    REQUIRE_FALSE(allocator.Allocate(513));
+    auto whole = allocator.Allocate(512);
+    REQUIRE(whole);
+    REQUIRE(whole->m_offset == 0);
+    REQUIRE(allocator.GetPageCount() == 4);
+}
+
+TEST_CASE("ring pages are recycled per frame in flight") {
+    RingPageAllocator allocator{256, 256, 2};
+
+    allocator.BeginFrame(0);
+    auto frame0_a = allocator.Allocate(256);
+    auto frame0_b = allocator.Allocate(256);
+
+    // frame 0 may still be on GPU, frame 1 gets its own pages
+    allocator.BeginFrame(1);
+    auto frame1 = allocator.Allocate(16);
+    REQUIRE(frame1->m_page != frame0_a->m_page);
+    REQUIRE(frame1->m_page != frame0_b->m_page);
+    REQUIRE(allocator.GetPageCount() == 3);
+
+    // frame 0's fence is signaled now, its chain is reused in order
+    allocator.BeginFrame(0);
+    auto reused_a = allocator.Allocate(256);
+    auto reused_b = allocator.Allocate(256);
+    REQUIRE(reused_a->m_page == frame0_a->m_page);
+    REQUIRE(reused_b->m_page == frame0_b->m_page);
+    REQUIRE(allocator.GetPageCount() == 3);
+
+    allocator.BeginFrame(1);
+    REQUIRE(allocator.Allocate(16)->m_page == frame1->m_page);
+    REQUIRE(allocator.GetFramePageCount() == 1);
+}
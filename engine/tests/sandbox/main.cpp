@@ -20,10 +20,6 @@ public:
         auto engine_relative_path = ctx.GetEngineRelativePath();
 
         auto& mgr = ctx.GetGLTFManager();
-        mgr.Load(engine_relative_path /
-                 "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.gltf");
-        mgr.Load(engine_relative_path /
-                 "engine/assets/models/CesiumMan/CesiumMan.gltf");
         mgr.Load(engine_relative_path /
                  "engine/assets/models/unit_box/unit_box.gltf");
         mgr.Load(engine_relative_path /
@@ -36,10 +32,9 @@ public:
         {
             nickel::GameObject go;
             go.m_name = "car";
-            go.m_model = mgr.Find(
-                (engine_relative_path /
-                 "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck")
-                    .ToString());
+            go.m_pending_model = mgr.LoadAsync(
+                engine_relative_path /
+                "engine/assets/models/CesiumMilkTruck/CesiumMilkTruck.gltf");
             go.m_rigid_actor =
                 nickel::physics::RigidActor{physics_ctx.CreateRigidDynamic(
                     nickel::Vec3{3, 0, 0}, nickel::Quat{})};
@@ -73,9 +68,9 @@ public:
         {
             nickel::GameObject go;
             go.m_name = "saw";
-            go.m_model = mgr.Find((engine_relative_path /
-                                   "engine/assets/models/CesiumMan/CesiumMan")
-                                      .ToString());
+            go.m_pending_model = mgr.LoadAsync(
+                engine_relative_path /
+                "engine/assets/models/CesiumMan/CesiumMan.gltf");
             go.m_transform.scale = nickel::Vec3{0.7};
 
             nickel::physics::CapsuleController::Descriptor desc;
@@ -0,0 +1,39 @@
+#include "nickel/common/log.hpp"
+#include "nickel/graphics/internal/cooked_model.hpp"
+
+#include <iostream>
+
+int main(int argc, char** argv) {
+    nickel::graphics::MeshOptimizeConfig optimize_config;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--quantize") {
+            optimize_config.m_quantize = true;
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.size() != 1 && args.size() != 2) {
+        std::cout << "usage: gltf_cooker [--quantize] <model.gltf|model.glb> "
+                     "[output.nkmodel]"
+                  << std::endl;
+        return 1;
+    }
+
+    nickel::Path src{args[0]};
+    nickel::Path dst = src;
+    if (args.size() == 2) {
+        dst = args[1];
+    } else {
+        dst.ReplaceExtension(
+            nickel::Path{nickel::graphics::CookedModelExtension});
+    }
+
+    if (!nickel::graphics::CookGLTFFile(src, dst, optimize_config)) {
+        return 1;
+    }
+    LOGI("cooked {} -> {}", src, dst);
+    return 0;
+}